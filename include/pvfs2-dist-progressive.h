@@ -0,0 +1,51 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+#ifndef __PVFS2_DIST_PROGRESSIVE_H
+#define __PVFS2_DIST_PROGRESSIVE_H
+
+#include "pvfs2-types.h"
+
+/* Identifier to use when looking up this distribution */
+#define PVFS_DIST_PROGRESSIVE_NAME "progressive_stripe"
+#define PVFS_DIST_PROGRESSIVE_NAME_SIZE 19
+
+#define PVFS_DIST_PROGRESSIVE_DEFAULT_STRIP_SIZE 65536
+#define PVFS_DIST_PROGRESSIVE_DEFAULT_MAX_STRIP_SIZE 1048576
+#define PVFS_DIST_PROGRESSIVE_DEFAULT_INITIAL_SERVERS 1
+#define PVFS_DIST_PROGRESSIVE_DEFAULT_GROWTH_FACTOR 2
+#define PVFS_DIST_PROGRESSIVE_DEFAULT_REGION_STRIPES 4
+
+/* progressive stripe distribution parameters
+ *
+ * The file is laid out in regions.  The first region is striped over
+ * initial_servers datafiles with strips of strip_size bytes.  Each
+ * following region stripes over growth_factor times as many datafiles
+ * (up to all of them) with strips growth_factor times as large (up to
+ * max_strip_size).  Every region holds region_stripes full stripes,
+ * except the last, which begins once the width and strip size stop
+ * growing and covers the rest of the file.
+ */
+struct PVFS_progressive_params_s
+{
+    PVFS_size strip_size;       /* strip size of the first region */
+    PVFS_size max_strip_size;   /* strips stop growing here */
+    uint32_t initial_servers;   /* datafiles in the first region */
+    uint32_t growth_factor;     /* width and strip size multiplier */
+    uint32_t region_stripes;    /* stripes in each region but the last */
+};
+typedef struct PVFS_progressive_params_s PVFS_progressive_params;
+
+#endif
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
@@ -27,6 +27,8 @@
 #define PVFS_HINT_LOCAL_UID_NAME     "pvfs.hint.local_uid"
 /* owner gid for file creation */
 #define PVFS_HINT_OWNER_GID_NAME     "pvfs.hint.owner_gid"
+/* readdir pages a server may read ahead of the client (uint32_t) */
+#define PVFS_HINT_READDIR_STREAM_NAME "pvfs.hint.readdir_stream"
 
 typedef struct PVFS_hint_s *PVFS_hint;
 
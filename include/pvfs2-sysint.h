@@ -191,6 +191,11 @@ struct PVFS_sysresp_readdirplus_s
 };
 typedef struct PVFS_sysresp_readdirplus_s PVFS_sysresp_readdirplus;
 
+/** State of a streaming read of a whole directory; see
+ *  PVFS_sys_readdir_stream_open().
+ */
+typedef struct PVFS_sys_readdir_stream_s *PVFS_sys_readdir_stream;
+
 
 /* truncate */
 /* no data returned in truncate response */
@@ -364,6 +369,27 @@ PVFS_error PVFS_sys_readdir(
     PVFS_sysresp_readdir *resp,
     PVFS_hint hints);
 
+PVFS_error PVFS_sys_readdir_stream_open(
+    PVFS_object_ref ref,
+    const PVFS_credential *credential,
+    int32_t window,
+    PVFS_sys_readdir_stream *stream);
+
+PVFS_error PVFS_isys_readdir_stream_next(
+    PVFS_sys_readdir_stream stream,
+    PVFS_sysresp_readdir *resp,
+    PVFS_sys_op_id *op_id,
+    PVFS_hint hints,
+    void *user_ptr);
+
+PVFS_error PVFS_sys_readdir_stream_next(
+    PVFS_sys_readdir_stream stream,
+    PVFS_sysresp_readdir *resp,
+    PVFS_hint hints);
+
+void PVFS_sys_readdir_stream_close(
+    PVFS_sys_readdir_stream stream);
+
 PVFS_error PVFS_isys_readdirplus(
     PVFS_object_ref ref,
     PVFS_ds_position token,
@@ -406,6 +432,33 @@ PVFS_error PVFS_sys_create(
     PVFS_sys_layout *layout,
     PVFS_hint hints);
 
+PVFS_error PVFS_isys_create_with_data(
+    char *entry_name,
+    PVFS_object_ref ref,
+    PVFS_sys_attr attr,
+    const PVFS_credential *credential,
+    PVFS_sys_dist *dist,
+    PVFS_sys_layout *layout,
+    void *buffer,
+    PVFS_size size,
+    PVFS_size *stored,
+    PVFS_sysresp_create *resp,
+    PVFS_sys_op_id *op_id,
+    PVFS_hint hints,
+    void *user_ptr);
+
+PVFS_error PVFS_sys_create_with_data(
+    char *entry_name,
+    PVFS_object_ref ref,
+    PVFS_sys_attr attr,
+    const PVFS_credential *credential,
+    PVFS_sys_dist *dist,
+    PVFS_sys_layout *layout,
+    void *buffer,
+    PVFS_size size,
+    PVFS_sysresp_create *resp,
+    PVFS_hint hints);
+
 PVFS_error PVFS_isys_remove(
     char *entry_name,
     PVFS_object_ref ref,
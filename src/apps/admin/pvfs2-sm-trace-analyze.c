@@ -0,0 +1,669 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* Offline analysis of state machine trace dumps written by
+ * pvfs2-sm-trace.  Prints a latency histogram for every state and the
+ * critical path of the slowest requests: each state a request passed
+ * through, how long its action ran, and how long the request then
+ * waited and on what kind of job.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <getopt.h>
+
+#include "pvfs2.h"
+#include "pint-sm-trace.h"
+
+#ifndef PVFS2_VERSION
+#define PVFS2_VERSION "Unknown"
+#endif
+
+#define HIST_BUCKETS 24     /* powers of two microseconds */
+#define MAX_PATH_STEPS 256
+
+/* values of the SM_ACTION_* return codes and job types as recorded */
+#define TRACE_ACTION_DEFERRED 0
+static const char *job_type_names[] =
+{
+    "none", "bmi", "bmi_unexp", "trove", "flow", "req_sched",
+    "dev_unexp", "timer", "precreate_pool", "null"
+};
+#define NUM_JOB_TYPES \
+    ((int) (sizeof(job_type_names) / sizeof(job_type_names[0])))
+
+struct state_info
+{
+    uint64_t addr;
+    char *name;                 /* machine:state */
+    uint64_t count;
+    uint64_t run_ns;            /* time spent in the action */
+    uint64_t total_ns;          /* action plus the wait that followed */
+    uint64_t max_ns;
+    uint64_t hist[HIST_BUCKETS];
+};
+
+struct path_step
+{
+    struct state_info *state;
+    uint64_t enter_ns;
+    uint64_t run_ns;
+    uint64_t wait_ns;
+    int job_type;
+};
+
+struct request
+{
+    uint64_t smcb;
+    uint64_t parent;
+    struct state_info *machine; /* outermost state, names the machine */
+    int32_t op;
+    int complete;               /* saw both start and terminate */
+    int error;
+    uint64_t start_ns;
+    uint64_t end_ns;
+    int nsteps;
+    int truncated;
+    struct path_step steps[MAX_PATH_STEPS];
+    /* state of the step in progress */
+    uint64_t action_ns;
+    int deferred;
+    int last_job_type;
+    struct request *next_active;
+};
+
+struct options
+{
+    int slowest;
+    int hist;
+    int paths;
+    const char *machine;
+    char **files;
+    int nfiles;
+};
+
+static struct state_info *states = NULL;
+static int nstates = 0;
+static struct request **done = NULL;
+static int ndone = 0, done_size = 0;
+static struct request *active = NULL;
+
+static struct options *parse_args(int argc, char *argv[]);
+static void usage(int argc, char **argv);
+static int load_file(const char *path, struct PINT_sm_trace_rec **recs,
+                     uint64_t *nrecs);
+static int state_cmp(const void *a, const void *b);
+static struct state_info *find_state(uint64_t addr);
+static void process(struct PINT_sm_trace_rec *recs, uint64_t nrecs);
+static void print_histograms(const struct options *opts);
+static void print_paths(const struct options *opts);
+
+int main(int argc, char **argv)
+{
+    struct options *user_opts;
+    struct PINT_sm_trace_rec *recs;
+    uint64_t nrecs;
+    int i;
+
+    user_opts = parse_args(argc, argv);
+    if (!user_opts)
+    {
+        usage(argc, argv);
+        return 1;
+    }
+
+    /* each dump comes from a different server, so analyze them apart */
+    for (i = 0; i < user_opts->nfiles; i++)
+    {
+        if (load_file(user_opts->files[i], &recs, &nrecs) < 0)
+        {
+            return 1;
+        }
+        printf("# %s: %llu records, %d states\n", user_opts->files[i],
+               (unsigned long long) nrecs, nstates);
+        process(recs, nrecs);
+        if (user_opts->hist)
+        {
+            print_histograms(user_opts);
+        }
+        if (user_opts->paths)
+        {
+            print_paths(user_opts);
+        }
+        free(recs);
+    }
+
+    return 0;
+}
+
+static int rec_cmp(const void *a, const void *b)
+{
+    const struct PINT_sm_trace_rec *ra = a, *rb = b;
+
+    if (ra->ns != rb->ns)
+    {
+        return (ra->ns < rb->ns) ? -1 : 1;
+    }
+    return 0;
+}
+
+static int load_file(const char *path, struct PINT_sm_trace_rec **recs,
+                     uint64_t *nrecs)
+{
+    struct PINT_sm_trace_file_header hdr;
+    FILE *fp;
+    uint64_t i, addr;
+    uint16_t mlen, slen;
+
+    fp = fopen(path, "r");
+    if (!fp)
+    {
+        perror(path);
+        return -1;
+    }
+    if (fread(&hdr, sizeof(hdr), 1, fp) != 1 ||
+        memcmp(hdr.magic, PINT_SM_TRACE_MAGIC, sizeof(hdr.magic)) ||
+        hdr.version != PINT_SM_TRACE_VERSION)
+    {
+        fprintf(stderr, "%s: not a state machine trace dump\n", path);
+        fclose(fp);
+        return -1;
+    }
+
+    *nrecs = hdr.nrecords;
+    *recs = malloc((hdr.nrecords ? hdr.nrecords : 1) * sizeof(**recs));
+    if (!*recs)
+    {
+        perror("malloc");
+        fclose(fp);
+        return -1;
+    }
+    if (fread(*recs, sizeof(**recs), hdr.nrecords, fp) != hdr.nrecords)
+    {
+        fprintf(stderr, "%s: truncated trace\n", path);
+        goto error;
+    }
+
+    for (i = 0; i < nstates; i++)
+    {
+        free(states[i].name);
+    }
+    free(states);
+    nstates = 0;
+    states = calloc(hdr.nstates ? hdr.nstates : 1, sizeof(*states));
+    if (!states)
+    {
+        perror("calloc");
+        goto error;
+    }
+    for (i = 0; i < hdr.nstates; i++)
+    {
+        if (fread(&addr, sizeof(addr), 1, fp) != 1 ||
+            fread(&mlen, sizeof(mlen), 1, fp) != 1 ||
+            fread(&slen, sizeof(slen), 1, fp) != 1)
+        {
+            fprintf(stderr, "%s: truncated state table\n", path);
+            goto error;
+        }
+        states[i].addr = addr;
+        states[i].name = malloc(mlen + slen + 2);
+        if (!states[i].name ||
+            fread(states[i].name, 1, mlen, fp) != mlen ||
+            fread(states[i].name + mlen + 1, 1, slen, fp) != slen)
+        {
+            fprintf(stderr, "%s: truncated state table\n", path);
+            goto error;
+        }
+        states[i].name[mlen] = ':';
+        states[i].name[mlen + slen + 1] = '\0';
+        nstates++;
+    }
+    fclose(fp);
+
+    qsort(states, nstates, sizeof(*states), state_cmp);
+    qsort(*recs, *nrecs, sizeof(**recs), rec_cmp);
+    return 0;
+
+error:
+    free(*recs);
+    fclose(fp);
+    return -1;
+}
+
+static int state_cmp(const void *a, const void *b)
+{
+    const struct state_info *sa = a, *sb = b;
+
+    if (sa->addr != sb->addr)
+    {
+        return (sa->addr < sb->addr) ? -1 : 1;
+    }
+    return 0;
+}
+
+static struct state_info *find_state(uint64_t addr)
+{
+    struct state_info key;
+
+    key.addr = addr;
+    return bsearch(&key, states, nstates, sizeof(*states), state_cmp);
+}
+
+static int hist_bucket(uint64_t ns)
+{
+    uint64_t us = ns / 1000;
+    int b = 0;
+
+    while (us > 0 && b < HIST_BUCKETS - 1)
+    {
+        us >>= 1;
+        b++;
+    }
+    return b;
+}
+
+static struct request *find_active(uint64_t smcb, int unlink)
+{
+    struct request **pp, *req;
+
+    for (pp = &active; *pp; pp = &(*pp)->next_active)
+    {
+        if ((*pp)->smcb == smcb)
+        {
+            req = *pp;
+            if (unlink)
+            {
+                *pp = req->next_active;
+            }
+            return req;
+        }
+    }
+    return NULL;
+}
+
+/* closes the step in progress: its latency runs from entering the
+ * state until the next state is entered or the machine terminates
+ */
+static void finish_step(struct request *req, uint64_t now)
+{
+    struct path_step *step;
+    uint64_t total;
+
+    if (req->nsteps == 0)
+    {
+        return;
+    }
+    step = &req->steps[req->nsteps - 1];
+    if (req->action_ns == 0 || !step->state)
+    {
+        return;
+    }
+    step->run_ns = req->action_ns - step->enter_ns;
+    if (req->deferred)
+    {
+        step->wait_ns = now - req->action_ns;
+        step->job_type = req->last_job_type;
+    }
+    total = step->run_ns + step->wait_ns;
+
+    step->state->count++;
+    step->state->run_ns += step->run_ns;
+    step->state->total_ns += total;
+    if (total > step->state->max_ns)
+    {
+        step->state->max_ns = total;
+    }
+    step->state->hist[hist_bucket(total)]++;
+
+    req->action_ns = 0;
+    req->deferred = 0;
+    req->last_job_type = 0;
+}
+
+static void retire(struct request *req)
+{
+    struct request **tmp;
+
+    if (!req->complete)
+    {
+        free(req);
+        return;
+    }
+    if (ndone == done_size)
+    {
+        done_size = done_size ? done_size * 2 : 1024;
+        tmp = realloc(done, done_size * sizeof(*done));
+        if (!tmp)
+        {
+            perror("realloc");
+            exit(1);
+        }
+        done = tmp;
+    }
+    done[ndone++] = req;
+}
+
+static struct request *new_request(const struct PINT_sm_trace_rec *rec)
+{
+    struct request *req;
+
+    req = calloc(1, sizeof(*req));
+    if (!req)
+    {
+        perror("calloc");
+        exit(1);
+    }
+    req->smcb = rec->smcb;
+    req->op = rec->op;
+    req->start_ns = rec->ns;
+    req->next_active = active;
+    active = req;
+    return req;
+}
+
+static void process(struct PINT_sm_trace_rec *recs, uint64_t nrecs)
+{
+    struct PINT_sm_trace_rec *rec;
+    struct request *req;
+    struct path_step *step;
+    uint64_t i;
+
+    for (i = 0; i < nrecs; i++)
+    {
+        rec = &recs[i];
+        switch (rec->kind)
+        {
+            case PINT_SM_TRACE_START:
+                req = find_active(rec->smcb, 1);
+                if (req)
+                {
+                    /* smcb reused before we saw it terminate */
+                    req->complete = 0;
+                    retire(req);
+                }
+                req = new_request(rec);
+                req->machine = find_state(rec->arg);
+                req->complete = 1;
+                break;
+
+            case PINT_SM_TRACE_CHILD:
+                req = find_active(rec->smcb, 0);
+                if (req)
+                {
+                    req->parent = rec->arg;
+                }
+                break;
+
+            case PINT_SM_TRACE_STATE:
+                req = find_active(rec->smcb, 0);
+                if (!req)
+                {
+                    /* started before the oldest record we have */
+                    req = new_request(rec);
+                }
+                finish_step(req, rec->ns);
+                if (req->nsteps == MAX_PATH_STEPS)
+                {
+                    req->truncated = 1;
+                    req->nsteps--;
+                }
+                step = &req->steps[req->nsteps++];
+                memset(step, 0, sizeof(*step));
+                step->state = find_state(rec->arg);
+                step->enter_ns = rec->ns;
+                break;
+
+            case PINT_SM_TRACE_ACTION:
+                req = find_active(rec->smcb, 0);
+                if (req && req->nsteps)
+                {
+                    req->action_ns = rec->ns;
+                    req->deferred = (rec->value == TRACE_ACTION_DEFERRED);
+                }
+                break;
+
+            case PINT_SM_TRACE_JOB:
+                req = find_active(rec->smcb, 0);
+                if (req)
+                {
+                    req->last_job_type = rec->value;
+                }
+                break;
+
+            case PINT_SM_TRACE_TERM:
+                req = find_active(rec->smcb, 1);
+                if (req)
+                {
+                    finish_step(req, rec->ns);
+                    req->end_ns = rec->ns;
+                    req->error = (int) (int64_t) rec->arg;
+                    retire(req);
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    /* requests still running at dump time are not reported */
+    while (active)
+    {
+        req = active;
+        active = req->next_active;
+        free(req);
+    }
+}
+
+static int machine_match(const struct options *opts, const char *name)
+{
+    return !opts->machine || strstr(name, opts->machine) != NULL;
+}
+
+static void print_histograms(const struct options *opts)
+{
+    struct state_info *st;
+    int i, b, last;
+
+    printf("\n# state latency (action plus following wait)\n");
+    printf("# %-48s %9s %11s %11s %11s\n", "state", "count", "mean us",
+           "run us", "max us");
+    for (i = 0; i < nstates; i++)
+    {
+        st = &states[i];
+        if (st->count == 0 || !machine_match(opts, st->name))
+        {
+            continue;
+        }
+        printf("%-50s %9llu %11.1f %11.1f %11.1f\n", st->name,
+               (unsigned long long) st->count,
+               (double) st->total_ns / st->count / 1000.0,
+               (double) st->run_ns / st->count / 1000.0,
+               (double) st->max_ns / 1000.0);
+
+        for (last = HIST_BUCKETS - 1; last > 0 && !st->hist[last]; last--)
+            ;
+        printf("   ");
+        for (b = 0; b <= last; b++)
+        {
+            if (b == 0)
+            {
+                printf(" <1us:%llu", (unsigned long long) st->hist[b]);
+            }
+            else
+            {
+                printf(" <%lluus:%llu", 1ULL << b,
+                       (unsigned long long) st->hist[b]);
+            }
+        }
+        printf("\n");
+    }
+}
+
+static int duration_cmp(const void *a, const void *b)
+{
+    const struct request *ra = *(struct request * const *) a;
+    const struct request *rb = *(struct request * const *) b;
+    uint64_t da = ra->end_ns - ra->start_ns;
+    uint64_t db = rb->end_ns - rb->start_ns;
+
+    if (da != db)
+    {
+        return (da > db) ? -1 : 1;
+    }
+    return 0;
+}
+
+static void print_request(const struct request *req, int depth)
+{
+    const struct path_step *step;
+    const struct request *child;
+    const char *machine = "?";
+    int i, j, len = 1;
+
+    if (req->machine)
+    {
+        machine = req->machine->name;
+        len = strcspn(machine, ":");
+    }
+    printf("%*s%.*s op %d smcb 0x%llx: %.1f us, %d states%s, error %d\n",
+           depth * 4, "", len, machine, req->op,
+           (unsigned long long) req->smcb,
+           (req->end_ns - req->start_ns) / 1000.0, req->nsteps,
+           req->truncated ? " (truncated)" : "", req->error);
+
+    for (i = 0; i < req->nsteps; i++)
+    {
+        step = &req->steps[i];
+        printf("%*s  +%9.1f %-44s run %9.1f", depth * 4, "",
+               (step->enter_ns - req->start_ns) / 1000.0,
+               step->state ? step->state->name : "?",
+               step->run_ns / 1000.0);
+        if (step->wait_ns)
+        {
+            printf(" wait %9.1f (%s)", step->wait_ns / 1000.0,
+                   (step->job_type > 0 && step->job_type < NUM_JOB_TYPES) ?
+                   job_type_names[step->job_type] : "children");
+        }
+        printf("\n");
+
+        /* child machines started from this state */
+        for (j = 0; j < ndone; j++)
+        {
+            child = done[j];
+            if (child->parent == req->smcb &&
+                child->start_ns >= step->enter_ns &&
+                (i + 1 == req->nsteps ||
+                 child->start_ns < req->steps[i + 1].enter_ns) &&
+                depth < 4)
+            {
+                print_request(child, depth + 1);
+            }
+        }
+    }
+}
+
+static void print_paths(const struct options *opts)
+{
+    int i, printed = 0;
+
+    qsort(done, ndone, sizeof(*done), duration_cmp);
+
+    printf("\n# critical paths of the %d slowest of %d completed requests\n",
+           opts->slowest, ndone);
+    for (i = 0; i < ndone && printed < opts->slowest; i++)
+    {
+        if (done[i]->parent || !done[i]->machine ||
+            !machine_match(opts, done[i]->machine->name))
+        {
+            continue;
+        }
+        print_request(done[i], 0);
+        printf("\n");
+        printed++;
+    }
+
+    for (i = 0; i < ndone; i++)
+    {
+        free(done[i]);
+    }
+    ndone = 0;
+}
+
+static struct options *parse_args(int argc, char *argv[])
+{
+    char flags[] = "vn:m:HP";
+    int one_opt = 0;
+    struct options *tmp_opts;
+
+    tmp_opts = calloc(1, sizeof(*tmp_opts));
+    if (!tmp_opts)
+    {
+        return NULL;
+    }
+    tmp_opts->slowest = 10;
+    tmp_opts->hist = 1;
+    tmp_opts->paths = 1;
+
+    while ((one_opt = getopt(argc, argv, flags)) != -1)
+    {
+        switch (one_opt)
+        {
+            case ('v'):
+                printf("%s\n", PVFS2_VERSION);
+                exit(0);
+            case ('n'):
+                tmp_opts->slowest = atoi(optarg);
+                break;
+            case ('m'):
+                tmp_opts->machine = optarg;
+                break;
+            case ('H'):
+                tmp_opts->paths = 0;
+                break;
+            case ('P'):
+                tmp_opts->hist = 0;
+                break;
+            default:
+                free(tmp_opts);
+                return NULL;
+        }
+    }
+
+    if (optind >= argc)
+    {
+        free(tmp_opts);
+        return NULL;
+    }
+    tmp_opts->files = &argv[optind];
+    tmp_opts->nfiles = argc - optind;
+
+    return tmp_opts;
+}
+
+static void usage(int argc, char **argv)
+{
+    fprintf(stderr, "\n");
+    fprintf(stderr,
+            "Usage  : %s [-n slowest] [-m machine] [-H | -P] dump...\n",
+            argv[0]);
+    fprintf(stderr, "  -n  number of slowest requests to show (default 10)\n");
+    fprintf(stderr, "  -m  only report machines whose name contains this\n");
+    fprintf(stderr, "  -H  only print state latency histograms\n");
+    fprintf(stderr, "  -P  only print critical paths\n");
+    fprintf(stderr, "Example: %s /tmp/smtrace.server1\n", argv[0]);
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
@@ -0,0 +1,215 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* Turns state machine tracing on or off on every server of a file
+ * system, or asks each server to dump its trace rings to
+ * <StateMachineTraceDir>/<name>.<server alias> for
+ * pvfs2-sm-trace-analyze.  Both require administrator credentials.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#include "pvfs2.h"
+#include "pvfs2-mgmt.h"
+
+#ifndef PVFS2_VERSION
+#define PVFS2_VERSION "Unknown"
+#endif
+
+struct options
+{
+    char *mnt_point;
+    int records;        /* > 0 enable, 0 disable, -1 leave alone */
+    char *dump_name;
+};
+
+static struct options *parse_args(int argc, char *argv[]);
+static void usage(int argc, char **argv);
+
+int main(int argc, char **argv)
+{
+    int ret = -1;
+    PVFS_fs_id cur_fs;
+    struct options *user_opts = NULL;
+    char pvfs_path[PVFS_NAME_MAX] = {0};
+    PVFS_credential creds;
+    struct PVFS_mgmt_setparam_value param_value;
+
+    user_opts = parse_args(argc, argv);
+    if (!user_opts)
+    {
+        usage(argc, argv);
+        return(-1);
+    }
+
+    ret = PVFS_util_init_defaults();
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_util_init_defaults", ret);
+        return(-1);
+    }
+
+    ret = PVFS_util_resolve(user_opts->mnt_point,
+                            &cur_fs,
+                            pvfs_path,
+                            PVFS_NAME_MAX);
+    if (ret < 0)
+    {
+        fprintf(stderr,
+                "Error: could not find filesystem for %s in pvfstab\n",
+                user_opts->mnt_point);
+        return(-1);
+    }
+
+    ret = PVFS_util_gen_credential_defaults(&creds);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_util_gen_credential_defaults", ret);
+        return(-1);
+    }
+
+    /* dump before changing the recording state so that "-d x -e 0"
+     * captures the trace that was just stopped
+     */
+    if (user_opts->dump_name)
+    {
+        param_value.type = PVFS_MGMT_PARAM_TYPE_STRING;
+        param_value.u.string_value = user_opts->dump_name;
+        ret = PVFS_mgmt_setparam_all(cur_fs,
+                                     &creds,
+                                     PVFS_SERV_PARAM_SM_TRACE_DUMP,
+                                     &param_value,
+                                     NULL, /* status details */
+                                     NULL  /* hints */);
+        if (ret < 0)
+        {
+            PVFS_perror("PVFS_mgmt_setparam_all", ret);
+            goto out;
+        }
+        printf("State machine traces written to "
+               "<StateMachineTraceDir>/%s.<server alias> on each server.\n",
+               user_opts->dump_name);
+    }
+
+    if (user_opts->records >= 0)
+    {
+        param_value.type = PVFS_MGMT_PARAM_TYPE_UINT64;
+        param_value.u.value = user_opts->records;
+        ret = PVFS_mgmt_setparam_all(cur_fs,
+                                     &creds,
+                                     PVFS_SERV_PARAM_SM_TRACE,
+                                     &param_value,
+                                     NULL, /* status details */
+                                     NULL  /* hints */);
+        if (ret < 0)
+        {
+            PVFS_perror("PVFS_mgmt_setparam_all", ret);
+            goto out;
+        }
+    }
+
+out:
+    PVFS_sys_finalize();
+    return(ret);
+}
+
+/* parse_args()
+ *
+ * parses command line arguments
+ *
+ * returns pointer to options structure on success, NULL on failure
+ */
+static struct options *parse_args(int argc, char *argv[])
+{
+    char flags[] = "vm:e:d:";
+    int one_opt = 0;
+    struct options *tmp_opts = NULL;
+
+    tmp_opts = (struct options *) calloc(1, sizeof(struct options));
+    if (!tmp_opts)
+    {
+        return(NULL);
+    }
+    tmp_opts->records = -1;
+
+    while ((one_opt = getopt(argc, argv, flags)) != -1)
+    {
+        switch (one_opt)
+        {
+            case('v'):
+                printf("%s\n", PVFS2_VERSION);
+                exit(0);
+            case('m'):
+                /* leave room for the trailing slash */
+                tmp_opts->mnt_point = malloc(strlen(optarg) + 2);
+                if (!tmp_opts->mnt_point)
+                {
+                    free(tmp_opts);
+                    return(NULL);
+                }
+                sprintf(tmp_opts->mnt_point, "%s/", optarg);
+                break;
+            case('e'):
+                tmp_opts->records = atoi(optarg);
+                if (tmp_opts->records < 0)
+                {
+                    tmp_opts->records = 0;
+                }
+                break;
+            case('d'):
+                /* the servers only accept a plain file name */
+                if (strchr(optarg, '/') || strstr(optarg, ".."))
+                {
+                    fprintf(stderr, "Error: -d takes a file name, not a "
+                            "path\n");
+                    free(tmp_opts->mnt_point);
+                    free(tmp_opts);
+                    return(NULL);
+                }
+                tmp_opts->dump_name = optarg;
+                break;
+            default:
+                free(tmp_opts->mnt_point);
+                free(tmp_opts);
+                return(NULL);
+        }
+    }
+
+    if (!tmp_opts->mnt_point ||
+        (tmp_opts->records < 0 && !tmp_opts->dump_name))
+    {
+        free(tmp_opts->mnt_point);
+        free(tmp_opts);
+        return(NULL);
+    }
+
+    return(tmp_opts);
+}
+
+static void usage(int argc, char **argv)
+{
+    fprintf(stderr, "\n");
+    fprintf(stderr,
+            "Usage  : %s -m <fs mount point> [-e records] [-d name]\n",
+            argv[0]);
+    fprintf(stderr, "  -e  records per thread to trace; 0 stops tracing\n");
+    fprintf(stderr, "  -d  dump traces to <StateMachineTraceDir>/<name>."
+            "<server alias>\n      on each server\n");
+    fprintf(stderr, "Example: %s -m /mnt/pvfs2 -e 65536\n", argv[0]);
+    fprintf(stderr, "         %s -m /mnt/pvfs2 -d smtrace\n", argv[0]);
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
@@ -42,6 +42,8 @@
 struct options 
 {
     char *srcfile;
+    int show_layout;
+    PVFS_size layout_size;  /* -1 for the file's own size */
 };
 
 enum object_type { 
@@ -61,6 +63,7 @@ typedef struct pvfs2_file_object_s {
 typedef struct unix_file_object_s {
     int fd;
     int mode;
+    PVFS_size size;
     char path[NAME_MAX];
     PVFS_fs_id fs_id;
 } unix_file_object;
@@ -80,6 +83,7 @@ static int resolve_filename(file_object *obj, char *filename);
 static int generic_open(file_object *obj, PVFS_credential *credentials);
 static int generic_server_location(file_object *obj, PVFS_credential *creds,
         char **servers, PVFS_handle *handles, int *nservers);
+static void print_layout(PINT_dist *dist, int nservers, PVFS_size size);
 
 /* metafile distribution */
 #define DIST_KEY "system.pvfs2." METAFILE_DIST_KEYSTR
@@ -263,7 +267,6 @@ int main(int argc, char ** argv)
     PINT_dist_decode(&dist, dist_buf);
     printf("dist_name = %s\n", dist->dist_name);
     printf("dist_params:\n%s\n", dist->methods->params_string(dist->params));
-    PINT_dist_free(dist);
 
 
     ret = PINT_cached_config_get_server_name(metadataserver, 256,
@@ -271,6 +274,7 @@ int main(int argc, char ** argv)
     if( ret != 0)
     {
         fprintf(stderr, "Error, could not get metadataserver name\n");
+        PINT_dist_free(dist);
         return (-1);
     }
     printf("Metadataserver: %s\n", metadataserver);
@@ -282,6 +286,15 @@ int main(int argc, char ** argv)
             llu(handles[i]), llu(handles[i]));
         free(servers[i]);
     }
+
+    if (user_opts->show_layout)
+    {
+        print_layout(dist, nservers,
+                     user_opts->layout_size >= 0 ? user_opts->layout_size :
+                     src.fs_type == UNIX_FILE ? src.u.ufs.size :
+                     src.u.pvfs2.attr.size);
+    }
+    PINT_dist_free(dist);
 main_out:
     PVFS_sys_finalize();
     free(user_opts);
@@ -296,7 +309,8 @@ main_out:
  */
 static struct options* parse_args(int argc, char* argv[])
 {
-    char flags[] = "vf:";
+    char flags[] = "vf:ls:";
+    long long size;
     int one_opt = 0;
 
     struct options* tmp_opts = NULL;
@@ -307,6 +321,7 @@ static struct options* parse_args(int argc, char* argv[])
 	return(NULL);
     }
     memset(tmp_opts, 0, sizeof(struct options));
+    tmp_opts->layout_size = -1;
 
     /* look at command line arguments */
     while((one_opt = getopt(argc, argv, flags)) != EOF)
@@ -318,6 +333,18 @@ static struct options* parse_args(int argc, char* argv[])
             case('f'):
                 tmp_opts->srcfile = optarg;
                 break;
+            case('l'):
+                tmp_opts->show_layout = 1;
+                break;
+            case('s'):
+                if (sscanf(optarg, "%lld", &size) != 1 || size < 0)
+                {
+                    usage(argc, argv);
+                    exit(EXIT_FAILURE);
+                }
+                tmp_opts->layout_size = size;
+                tmp_opts->show_layout = 1;
+                break;
 	    case('?'):
 		usage(argc, argv);
 		exit(EXIT_FAILURE);
@@ -337,10 +364,41 @@ static void usage(int argc, char** argv)
 	"Usage: %s ARGS \n", argv[0]);
     fprintf(stderr, "Where ARGS is one or more of"
 	"\n-f <file name>\t\t\tPVFS2 file pathname"
+	"\n-l\t\t\t\tshow where the file's data lives on each datafile"
+	"\n-s <size>\t\t\tshow the layout for a file of this size"
 	"\n-v\t\t\t\tprint version number and exit\n");
     return;
 }
 
+/* print_layout:
+ *  for a file of the given size, shows the first logical offset each
+ *  datafile holds and how many bytes it holds, using the distribution's
+ *  own mapping.  Distributions that widen with file size, such as
+ *  progressive_stripe, show which datafiles a file of this size reaches.
+ */
+static void print_layout(PINT_dist *dist, int nservers, PVFS_size size)
+{
+    PINT_request_file_data fd;
+    PVFS_offset first;
+    PVFS_size bytes;
+    int i;
+
+    memset(&fd, 0, sizeof(fd));
+    fd.server_ct = nservers;
+    fd.dist = dist;
+
+    printf("Layout of %lld bytes:\n", lld(size));
+    for (i = 0; i < nservers; i++)
+    {
+        fd.server_nr = i;
+        first = dist->methods->next_mapped_offset(dist->params, &fd, 0);
+        bytes = dist->methods->logical_to_physical_offset(dist->params,
+                                                          &fd, size);
+        printf("Datafile %d - first byte at offset %lld, holds %lld bytes\n",
+               i, lld(first), lld(bytes));
+    }
+}
+
 /* resolve_filename:
  *  given 'filename', find the PVFS2 fs_id and relative pvfs_path.  In case of
  *  error, assume 'filename' is a unix file.
@@ -386,6 +444,7 @@ static int generic_open(file_object *obj, PVFS_credential *credentials)
         }
         obj->u.ufs.fd = open(obj->u.ufs.path, O_RDONLY);
         obj->u.ufs.mode = (int)stat_buf.st_mode;
+        obj->u.ufs.size = (PVFS_size)stat_buf.st_size;
 	if (obj->u.ufs.fd < 0)
 	{
 	    perror("open");
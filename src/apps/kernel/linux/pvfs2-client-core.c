@@ -30,6 +30,7 @@
 #include "acache.h"
 #include "ncache.h"
 #include "client-capcache.h"
+#include "wbcache.h"
 #include "tcache.h"
 #include "pint-dev-shared.h"
 #include "pvfs2-dev-proto.h"
@@ -60,13 +61,16 @@
 /* only relevant if USE_RA_CACHE is on */
 
 /*
-  an arbitrary limit to the max number of operations we'll support in
-  flight at once, and the max number of items we can write into the
-  device file as a response
+  the default and an upper limit for the number of operations we'll
+  support in flight at once (see --max-ops), the max number of
+  completions collected by one test call, and the max number of items
+  we can write into the device file as a response
 */
-#define MAX_NUM_OPS                 64
-#define MAX_LIST_SIZE      MAX_NUM_OPS
-#define IOX_HINDEXED_COUNT          64
+#define PVFS2_CLIENT_DEFAULT_MAX_OPS      64
+#define PVFS2_CLIENT_MAX_OPS_LIMIT      1024
+#define MAX_TEST_OPS                      64
+#define MAX_LIST_SIZE                     64
+#define IOX_HINDEXED_COUNT                64
 
 #define REMOUNT_PENDING     0xFFEEFF33
 #define OP_IN_PROGRESS      0xFFEEFF34
@@ -90,6 +94,31 @@
 
 #define DEFAULT_LOGFILE "/tmp/pvfs2-client.log"
 
+/*
+  worker lanes: the main thread only receives upcalls and hands them to
+  worker threads by class of operation, so that a burst of bulk I/O
+  cannot hold metadata operations back.  every worker posts and tests
+  its own sysint operations.  lanes need the threaded sysint and are not
+  used with the readahead cache, which expects to see every completion
+  in one place.
+*/
+#if defined(__GEN_POSIX_LOCKING__) && !defined(USE_RA_CACHE)
+#define CLIENT_CORE_WORKER_LANES
+#endif
+
+enum client_core_lane_type
+{
+    LANE_META = 0,
+    LANE_SMALL_IO = 1,
+    LANE_BULK_IO = 2,
+    NUM_LANES = 3
+};
+
+#define PVFS2_CLIENT_MAX_LANE_THREADS        32
+#define PVFS2_CLIENT_DEFAULT_SMALL_IO_SIZE   (64 * 1024)
+/* new requests a worker takes from its lane at a time */
+#define LANE_WORKER_BATCH                    16
+
 typedef struct
 {
     /* client side attribute cache timeout; 0 is effectively disabled */
@@ -143,6 +172,11 @@ typedef struct
     int readahead_readcnt;
     int readahead_pinned;
     char *bmi_opts;
+    unsigned int max_ops;
+    unsigned int lane_threads[NUM_LANES];
+    unsigned int small_io_size;
+    char *record_file;
+    char *replay_file;
 } options_t;
 
 /*
@@ -169,6 +203,8 @@ char *iotype = NULL;
 /* used for generating unique dynamic mount point names */
 static int dynamic_mount_id = 1;
 
+struct lane_worker;
+
 typedef struct
 {
     int is_dev_unexp;
@@ -208,6 +244,12 @@ typedef struct
 
     struct qlist_head hash_link;
 
+    /* device read posted directly on the job layer (lanes only) */
+    job_id_t unexp_job_id;
+    /* link in a lane or replay queue, and the worker posting the op */
+    struct qlist_head queue_link;
+    struct lane_worker *worker;
+
 #ifdef CLIENT_CORE_OP_TIMING
     PINT_time_marker start;
     PINT_time_marker end;
@@ -259,15 +301,84 @@ static struct PINT_dev_params s_desc_params[NUM_MAP_DESC];
 /* static char hostname[100]; */
 
 /* used only for deleting all allocated vfs_request objects */
-vfs_request_t *s_vfs_request_array[MAX_NUM_OPS] = {NULL};
+static vfs_request_t **s_vfs_request_array = NULL;
 
 static struct PINT_tcache *credential_cache = NULL;
+static pthread_mutex_t credential_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 /* this hashtable is used to keep track of operations in progress */
 #define DEFAULT_OPS_IN_PROGRESS_HTABLE_SIZE 67
 static int hash_key(const void *key, int table_size);
 static int hash_key_compare(const void *key, struct qlist_head *link);
 static struct qhash_table *s_ops_in_progress_table = NULL;
+static pthread_mutex_t s_ops_in_progress_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+#ifdef CLIENT_CORE_WORKER_LANES
+struct client_core_lane;
+
+struct lane_worker
+{
+    struct client_core_lane *lane;
+    int index;
+    pthread_t thread;
+    /* requests only this worker may handle: cancellations of its own
+     * operations and, on the first metadata worker, mounts and other
+     * requests serviced inline */
+    struct qlist_head private_queue;
+    vfs_request_t **in_flight;
+    int in_flight_count;
+    PVFS_sys_op_id *op_ids;
+    int op_ids_size;
+    uint64_t completed;
+};
+
+struct client_core_lane
+{
+    const char *name;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    struct qlist_head queue;
+    int queue_depth;
+    int max_queue_depth;
+    uint64_t dispatched;
+    int worker_count;
+    struct lane_worker *workers;
+};
+
+static int s_lanes_enabled = 0;
+static int s_lanes_stopping = 0;
+static struct client_core_lane s_lanes[NUM_LANES];
+static job_context_id s_client_unexp_context;
+#endif
+
+/* upcalls received from the device are appended to this file */
+static struct
+{
+    FILE *file;
+    pthread_mutex_t mutex;
+    uint64_t upcalls;
+} s_record = {NULL, PTHREAD_MUTEX_INITIALIZER, 0};
+
+/* a recorded upcall stream replayed instead of reading the device */
+static struct
+{
+    FILE *file;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    /* replay: requests waiting for the next recorded upcall */
+    struct qlist_head idle;
+    int idle_count;
+    /* replay: next record, read ahead to look at its type */
+    char *next;
+    struct PINT_dev_upcall_record next_record;
+    int eof;
+    int exclusive;
+    uint64_t upcalls;
+    uint64_t downcalls;
+    uint64_t errors;
+    struct timeval start;
+    struct timeval end;
+} s_replay;
 
 static void parse_args(int argc, char **argv, options_t *opts);
 static void print_help(char *progname);
@@ -324,6 +435,8 @@ static PVFS_error write_downcall(vfs_request_t *vfs_request);
 
 static PVFS_error repost_unexp_vfs_request(vfs_request_t *v, char *s);
 
+static PVFS_error post_dev_unexp(vfs_request_t *vfs_request);
+
 #define write_inlined_device_response(vfs_request)                           \
 do {                                                                         \
     void *buffer_list[MAX_LIST_SIZE];                                        \
@@ -461,9 +574,11 @@ static PVFS_error add_op_to_ops_in_progress_table(
 
     if (vfs_request)
     {
+        pthread_mutex_lock(&s_ops_in_progress_mutex);
         qhash_add(s_ops_in_progress_table,
                   (void *)(&vfs_request->info.tag),
                   &vfs_request->hash_link);
+        pthread_mutex_unlock(&s_ops_in_progress_mutex);
         ret = 0;
     }
     return ret;
@@ -481,6 +596,10 @@ static PVFS_error cancel_op_in_progress(PVFS_id_gen_t tag)
     gossip_debug(GOSSIP_CLIENTCORE_DEBUG,
                  "cancel_op_in_progress called\n");
 
+    /* held until the cancellation is posted, so the op cannot complete
+     * and be reposted underneath us
+     */
+    pthread_mutex_lock(&s_ops_in_progress_mutex);
     hash_link = qhash_search( s_ops_in_progress_table, (void *)(&tag));
     if (hash_link)
     {
@@ -520,6 +639,7 @@ static PVFS_error cancel_op_in_progress(PVFS_id_gen_t tag)
         gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "op in progress cannot "
                      "be found (tag = %lld)\n", lld(tag));
     }
+    pthread_mutex_unlock(&s_ops_in_progress_mutex);
     return ret;
 }
 
@@ -534,6 +654,7 @@ static int is_op_in_progress(vfs_request_t *vfs_request)
     gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "is_op_in_progress called on "
                  "tag %lld\n", lld(vfs_request->info.tag));
 
+    pthread_mutex_lock(&s_ops_in_progress_mutex);
     hash_link = qhash_search( s_ops_in_progress_table, 
                               (void *)(&vfs_request->info.tag));
     if (hash_link)
@@ -545,6 +666,7 @@ static int is_op_in_progress(vfs_request_t *vfs_request)
                     (tmp_request->in_upcall.type ==
                      vfs_request->in_upcall.type));
     }
+    pthread_mutex_unlock(&s_ops_in_progress_mutex);
     return op_found;
 }
 
@@ -557,8 +679,10 @@ static PVFS_error remove_op_from_ops_in_progress_table(
 
     if (vfs_request)
     {
+        pthread_mutex_lock(&s_ops_in_progress_mutex);
         hash_link = qhash_search_and_remove(s_ops_in_progress_table,
                                             (void *)(&vfs_request->info.tag));
+        pthread_mutex_unlock(&s_ops_in_progress_mutex);
         if (hash_link)
         {
             tmp_vfs_request = qhash_entry(hash_link,
@@ -1756,6 +1880,40 @@ static PVFS_error service_perf_count_request(vfs_request_t *vfs_request)
                 vfs_request->out_downcall.status = 0;
             }
             break;
+
+        case PVFS2_PERF_COUNT_REQUEST_WBCACHE:
+            tmp_str = PINT_perf_generate_text(PINT_wbcache_get_pc(),
+                PERF_COUNT_BUF_SIZE);
+            if(!tmp_str)
+            {
+                vfs_request->out_downcall.status = -PVFS_EINVAL;
+            }
+            else
+            {
+                strncpy(vfs_request->out_downcall.resp.perf_count.buffer,
+                    tmp_str, PERF_COUNT_BUF_SIZE);
+                free(tmp_str);
+                vfs_request->out_downcall.status = 0;
+            }
+            break;
+
+#ifdef USE_RA_CACHE
+        case PVFS2_PERF_COUNT_REQUEST_RACACHE:
+            tmp_str = PINT_perf_generate_text(pint_racache_get_pc(),
+                PERF_COUNT_BUF_SIZE);
+            if(!tmp_str)
+            {
+                vfs_request->out_downcall.status = -PVFS_EINVAL;
+            }
+            else
+            {
+                strncpy(vfs_request->out_downcall.resp.perf_count.buffer,
+                    tmp_str, PERF_COUNT_BUF_SIZE);
+                free(tmp_str);
+                vfs_request->out_downcall.status = 0;
+            }
+            break;
+#endif
            
         default:
             /* unsupported request, didn't match anything in case statement */
@@ -2113,8 +2271,10 @@ static PVFS_error service_param_request(vfs_request_t *vfs_request)
         }
         else if (tmp_subsystem == CCACHE)
         {
+            pthread_mutex_lock(&credential_cache_mutex);
             vfs_request->out_downcall.status = 
                 PINT_tcache_get_info(credential_cache, tmp_param, &val);
+            pthread_mutex_unlock(&credential_cache_mutex);
             if (vfs_request->in_upcall.req.param.op == 
                 PVFS2_PARAM_REQUEST_OP_CCACHE_TIMEOUT_SECS)
             {
@@ -2155,8 +2315,10 @@ static PVFS_error service_param_request(vfs_request_t *vfs_request)
             {
                 val *= 1000;
             }
+            pthread_mutex_lock(&credential_cache_mutex);
             vfs_request->out_downcall.status = 
                 PINT_tcache_set_info(credential_cache, tmp_param, val);
+            pthread_mutex_unlock(&credential_cache_mutex);
         }
         else /* CAPCACHE */
         {
@@ -2415,6 +2577,7 @@ static PVFS_error check_for_speculative(vfs_request_t *vfs_request,
     racache_buffer_t *rabuff = NULL; /* new buffer we will read */
     vfs_request_t *rareq = NULL; /* phantom request */
     PVFS_object_ref refn;
+    PVFS_size ra_offset;
     int amt_returned;
     int b;
 
@@ -2467,18 +2630,18 @@ static PVFS_error check_for_speculative(vfs_request_t *vfs_request,
         return ret;
     }
 
-    /* The first read was the original buffer
-     * so potentially issue prev_buff->readcnt - 1 more
+    /* The first read was the original buffer so potentially issue
+     * one more per buffer in the file's readahead window - the cache
+     * picks the offsets from the access pattern it has seen
      */
-    gossip_debug(GOSSIP_RACACHE_DEBUG,
-              "--- check_for_speculative issue %d more reads\n",
-              (int)(prev_buff->readcnt - 1));
-    for(b = 1; b < prev_buff->readcnt; b++)
+    for(b = 1; (ra_offset = pint_racache_ra_offset(prev_buff, b)) >= 0; b++)
     {
+        gossip_debug(GOSSIP_RACACHE_DEBUG,
+                     "--- check_for_speculative readahead %d at %lld\n",
+                     b, lld(ra_offset));
 
         /* select the desired buffer */
-        rareq->in_upcall.req.io.offset = prev_buff->file_offset +
-                                         (b * prev_buff->buff_sz);
+        rareq->in_upcall.req.io.offset = ra_offset;
         /* find a buffer */
         rareq->racache_status = pint_racache_get_block(
                                             refn,
@@ -2832,6 +2995,32 @@ static PVFS_error post_io_request(vfs_request_t *vfs_request)
 
     iotype = (vfs_request->in_upcall.req.io.io_type == PVFS_IO_READ) ?
              ior : iow;
+    /* a small write may be held in the write-behind cache, in which
+     * case it completes right here like a readahead cache hit */
+    if ((vfs_request->in_upcall.req.io.io_type == PVFS_IO_WRITE) &&
+        PINT_wbcache_write(refn,
+                           vfs_request->file_req,
+                           vfs_request->in_upcall.req.io.offset,
+                           vfs_request->io_kernel_mapped_buf,
+                           vfs_request->mem_req,
+                           credential,
+                           &vfs_request->response.io))
+    {
+        gossip_debug(GOSSIP_CLIENTCORE_DEBUG,
+                     "write of %ld buffered for tag %Ld\n",
+                     (unsigned long)vfs_request->in_upcall.req.io.count,
+                     lld(vfs_request->info.tag));
+        if (credential)
+        {
+            PINT_cleanup_credential(credential);
+            free(credential);
+        }
+        vfs_request->out_downcall.type = PVFS2_VFS_OP_FILE_IO;
+        vfs_request->out_downcall.status = 0;
+        vfs_request->op_id = -1;
+        return 0;
+    }
+
     gossip_debug(GOSSIP_RACACHE_DEBUG,
                  "Posting regular IO vfs_request = %p%s", vfs_request, iotype);
     ret = PVFS_isys_io(refn,
@@ -3235,6 +3424,22 @@ PVFS_error write_device_response(
                  "error code: %d\n",
                  __func__, llu(tag), jstat->error_code);
 
+    if (s_replay.file && buffer_list)
+    {
+        /* nobody to answer when replaying; just keep score */
+        pvfs2_downcall_t *downcall = ((void **)buffer_list)[0];
+
+        pthread_mutex_lock(&s_replay.mutex);
+        s_replay.downcalls++;
+        if (downcall->status != 0)
+        {
+            s_replay.errors++;
+        }
+        pthread_mutex_unlock(&s_replay.mutex);
+        jstat->error_code = 0;
+        return 0;
+    }
+
     if (buffer_list && size_list && list_size &&
         total_size && (list_size < MAX_LIST_SIZE))
     {
@@ -3704,6 +3909,23 @@ static inline void package_downcall_members(vfs_request_t *vfs_request,
 
                     free(attr->link_target);
                 }
+#ifdef USE_RA_CACHE
+                /* readahead windows end on strip boundaries */
+                if ((attr->objtype == PVFS_TYPE_METAFILE) &&
+                    (attr->mask & PVFS_ATTR_SYS_BLKSIZE))
+                {
+                    PVFS_object_ref refn;
+
+                    refn.handle = pvfs2_khandle_to_ino(
+                        &(vfs_request->in_upcall.req.getattr.refn.khandle));
+                    refn.fs_id = vfs_request->in_upcall.req.getattr.refn.fs_id;
+                    /* blksize covers the whole stripe */
+                    pint_racache_set_strip_size(refn,
+                        (attr->dfile_count > 0) ?
+                            attr->blksize / attr->dfile_count :
+                            attr->blksize);
+                }
+#endif
             }
             break;
         case PVFS2_VFS_OP_SETATTR:
@@ -4198,6 +4420,177 @@ static inline void package_downcall_members(vfs_request_t *vfs_request,
 
 }
 
+/* appends the upcall just received to the stream being recorded */
+static void record_upcall(vfs_request_t *vfs_request)
+{
+    struct PINT_dev_upcall_record record;
+
+    memset(&record, 0, sizeof(record));
+    record.tag = vfs_request->info.tag;
+    record.size = vfs_request->info.size;
+
+    pthread_mutex_lock(&s_record.mutex);
+    if (s_record.file)
+    {
+        if ((fwrite(&record, sizeof(record), 1, s_record.file) != 1) ||
+            (fwrite(vfs_request->info.buffer, vfs_request->info.size, 1,
+                    s_record.file) != 1))
+        {
+            gossip_err("Failed to record upcall (tag=%lld); no longer "
+                       "recording\n", lld(vfs_request->info.tag));
+            fclose(s_record.file);
+            s_record.file = NULL;
+        }
+        else
+        {
+            s_record.upcalls++;
+        }
+    }
+    pthread_mutex_unlock(&s_record.mutex);
+}
+
+static int start_recording_upcalls(const char *path)
+{
+    struct PINT_dev_upcall_stream header;
+
+    s_record.file = fopen(path, "w");
+    if (!s_record.file)
+    {
+        gossip_err("Failed to open %s to record upcalls: %s\n",
+                   path, strerror(errno));
+        return -PVFS_EINVAL;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PINT_DEV_UPCALL_STREAM_MAGIC, sizeof(header.magic));
+    header.version = PINT_DEV_UPCALL_STREAM_VERSION;
+    header.upcall_size = sizeof(pvfs2_upcall_t);
+    if (fwrite(&header, sizeof(header), 1, s_record.file) != 1)
+    {
+        gossip_err("Failed to write %s: %s\n", path, strerror(errno));
+        fclose(s_record.file);
+        s_record.file = NULL;
+        return -PVFS_EIO;
+    }
+    return 0;
+}
+
+static int start_replaying_upcalls(const char *path)
+{
+    struct PINT_dev_upcall_stream header;
+
+    s_replay.file = fopen(path, "r");
+    if (!s_replay.file)
+    {
+        gossip_err("Failed to open recorded upcalls %s: %s\n",
+                   path, strerror(errno));
+        return -PVFS_EINVAL;
+    }
+
+    if ((fread(&header, sizeof(header), 1, s_replay.file) != 1) ||
+        memcmp(header.magic, PINT_DEV_UPCALL_STREAM_MAGIC,
+               sizeof(header.magic)) ||
+        (header.version != PINT_DEV_UPCALL_STREAM_VERSION) ||
+        (header.upcall_size != sizeof(pvfs2_upcall_t)))
+    {
+        gossip_err("%s is not an upcall stream recorded by this "
+                   "client\n", path);
+        fclose(s_replay.file);
+        s_replay.file = NULL;
+        return -PVFS_EINVAL;
+    }
+
+    pthread_mutex_init(&s_replay.mutex, NULL);
+    pthread_cond_init(&s_replay.cond, NULL);
+    INIT_QLIST_HEAD(&s_replay.idle);
+    return 0;
+}
+
+/*
+  reads the next recorded upcall into s_replay.next, behind room for the
+  header PINT_dev_release_unexpected() expects.  caller holds
+  s_replay.mutex.
+*/
+static void replay_read_record(void)
+{
+    struct PINT_dev_upcall_record *record = &s_replay.next_record;
+
+    if (fread(record, sizeof(*record), 1, s_replay.file) != 1)
+    {
+        if (ferror(s_replay.file))
+        {
+            gossip_err("Error reading recorded upcalls\n");
+        }
+        s_replay.eof = 1;
+        return;
+    }
+
+    if (record->size < sizeof(pvfs2_upcall_t) ||
+        record->size > PVFS2_BUFMAP_MAX_TOTAL_SIZE)
+    {
+        gossip_err("Recorded upcall with bad size %u\n", record->size);
+        s_replay.eof = 1;
+        return;
+    }
+
+    s_replay.next = malloc(PINT_DEV_UNEXP_HEADER_SIZE + record->size);
+    if (!s_replay.next)
+    {
+        gossip_err("Out of memory reading recorded upcalls\n");
+        s_replay.eof = 1;
+        return;
+    }
+
+    if (fread(s_replay.next + PINT_DEV_UNEXP_HEADER_SIZE, record->size, 1,
+              s_replay.file) != 1)
+    {
+        gossip_err("Recorded upcall stream is truncated\n");
+        free(s_replay.next);
+        s_replay.next = NULL;
+        s_replay.eof = 1;
+    }
+}
+
+/*
+  posts a read for the next upcall on vfs_request: from the device
+  through the sysint, from the device directly on the job layer when
+  worker lanes are running, or from the stream being replayed
+*/
+static PVFS_error post_dev_unexp(vfs_request_t *vfs_request)
+{
+    PVFS_error ret = -PVFS_EINVAL;
+
+    if (s_replay.file)
+    {
+        pthread_mutex_lock(&s_replay.mutex);
+        qlist_add_tail(&vfs_request->queue_link, &s_replay.idle);
+        s_replay.idle_count++;
+        pthread_cond_signal(&s_replay.cond);
+        pthread_mutex_unlock(&s_replay.mutex);
+        return 0;
+    }
+
+#ifdef CLIENT_CORE_WORKER_LANES
+    if (s_lanes_enabled)
+    {
+        /* keep PINT_sys_release() away from the job id */
+        vfs_request->op_id = -1;
+        ret = job_dev_unexp(&vfs_request->info, vfs_request, 0,
+                            &vfs_request->jstat, &vfs_request->unexp_job_id,
+                            JOB_NO_IMMED_COMPLETE, s_client_unexp_context);
+        if (ret == 1)
+        {
+            ret = vfs_request->jstat.error_code;
+        }
+        return ret;
+    }
+#endif
+
+    ret = PINT_sys_dev_unexp(&vfs_request->info, &vfs_request->jstat,
+                             &vfs_request->op_id, vfs_request);
+    return ret;
+}
+
 static inline PVFS_error repost_unexp_vfs_request(
     vfs_request_t *vfs_request, char *completion_handle_desc)
 {
@@ -4232,11 +4625,10 @@ static inline PVFS_error repost_unexp_vfs_request(
 
     vfs_request->is_dev_unexp = 1;
 
-    ret = PINT_sys_dev_unexp(&vfs_request->info, &vfs_request->jstat,
-                             &vfs_request->op_id, vfs_request);
+    ret = post_dev_unexp(vfs_request);
     if (ret < 0)
     {
-        PVFS_perror_gossip("PINT_sys_dev_unexp()", ret);
+        PVFS_perror_gossip("post_dev_unexp()", ret);
     }
     else
     {
@@ -4247,12 +4639,22 @@ static inline PVFS_error repost_unexp_vfs_request(
     return ret;
 }
 
-static inline PVFS_error handle_unexp_vfs_request(vfs_request_t *vfs_request)
+/*
+  posted is set if the request is now in progress as a nonblocking
+  operation; otherwise it has been answered and reposted
+*/
+static inline PVFS_error handle_unexp_vfs_request(vfs_request_t *vfs_request,
+                                                  int *posted)
 {
     PVFS_error ret = -PVFS_EINVAL;
 
     assert(vfs_request);
 
+    if (posted)
+    {
+        *posted = 0;
+    }
+
     if (vfs_request->jstat.error_code)
     {
         PVFS_perror_gossip("job error code",
@@ -4272,6 +4674,10 @@ static inline PVFS_error handle_unexp_vfs_request(vfs_request_t *vfs_request)
         memcpy(&vfs_request->in_upcall,
                vfs_request->info.buffer,
                sizeof(pvfs2_upcall_t));
+        if (s_record.file)
+        {
+            record_upcall(vfs_request);
+        }
     }
     else
     {
@@ -4520,6 +4926,10 @@ repost_op:
                  * to the ops in progress table
                  */
                 vfs_request->is_dev_unexp = 0;
+                if (posted)
+                {
+                    *posted = 1;
+                }
                 /* never put a speculative op in the in progress table
                  * just manages to much things up and noon will be
                  * searching for it anyway.  Spec_ops should really
@@ -4581,91 +4991,739 @@ static PVFS_error write_downcall(vfs_request_t *vfs_request)
     return ret;
 }
 
-static PVFS_error process_vfs_requests(void)
+/* allocates the vfs requests and posts a read for an upcall on each */
+static PVFS_error post_initial_vfs_requests(void)
 {
-    PVFS_error ret = 0; 
-    int op_count = 0, i = 0;
+    PVFS_error ret = 0;
     vfs_request_t *vfs_request = NULL;
-    vfs_request_t *vfs_request_array[MAX_NUM_OPS] = {NULL};
-    PVFS_sys_op_id op_id_array[MAX_NUM_OPS];
-    int error_code_array[MAX_NUM_OPS] = {0};
-#ifdef USE_RA_CACHE
-    struct qlist_head *link = NULL;
-    gen_link_t *glink = NULL;
-    racache_buffer_t *buff = NULL;
-    vfs_request_t *vl = NULL;
-#endif
-
+    int i = 0;
 
-    gossip_debug(GOSSIP_CLIENTCORE_DEBUG,
-                 "process_vfs_requests called\n");
+    s_vfs_request_array = (vfs_request_t **)calloc(
+        s_opts.max_ops, sizeof(vfs_request_t *));
+    if (!s_vfs_request_array)
+    {
+        return -PVFS_ENOMEM;
+    }
 
-    gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "Post Initial Unexp Requests\n");
-    /* allocate and post all of our initial unexpected vfs requests */
-    for(i = 0; i < MAX_NUM_OPS; i++)
+    for(i = 0; i < s_opts.max_ops; i++)
     {
         vfs_request = (vfs_request_t *)malloc(sizeof(vfs_request_t));
-        assert(vfs_request);
-
+        if (!vfs_request)
+        {
+            return -PVFS_ENOMEM;
+        }
         s_vfs_request_array[i] = vfs_request;
 
         memset(vfs_request, 0, sizeof(vfs_request_t));
         vfs_request->is_dev_unexp = 1;
 
-        ret = PINT_sys_dev_unexp(&vfs_request->info,
-                                 &vfs_request->jstat,
-                                 &vfs_request->op_id,
-                                 vfs_request);
-
+        ret = post_dev_unexp(vfs_request);
         if (ret < 0)
         {
-	    PVFS_perror_gossip("PINT_sys_dev_unexp()", ret);
+            PVFS_perror_gossip("post_dev_unexp()", ret);
             return -PVFS_ENOMEM;
         }
     }
+    return 0;
+}
 
-    /*
-      signal the remount thread to go ahead with the remount attempts
-      since we're ready to handle requests now
-    */
-    pthread_mutex_unlock(&remount_mutex);
+#ifdef CLIENT_CORE_WORKER_LANES
+static void lane_dispatch(vfs_request_t *vfs_request);
+#endif
 
-    gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "Start Processing Loop\n");
-    while(s_client_is_processing)
-    {
-        op_count = MAX_NUM_OPS;
-        memset(error_code_array, 0, (MAX_NUM_OPS * sizeof(int)));
-        memset(vfs_request_array, 0, (MAX_NUM_OPS * sizeof(vfs_request_t *)));
+/* hands a newly received upcall to whoever handles it */
+static void dispatch_unexp_vfs_request(vfs_request_t *vfs_request)
+{
+    PVFS_error ret = 0;
 
-#if 0
-        /* generates too much logging, but useful sometimes */
-        gossip_debug(GOSSIP_CLIENTCORE_DEBUG,
-                 "Calling PVFS_sys_testany for new requests\n");
+#ifdef CLIENT_CORE_WORKER_LANES
+    if (s_lanes_enabled)
+    {
+        lane_dispatch(vfs_request);
+        return;
+    }
 #endif
+    ret = handle_unexp_vfs_request(vfs_request, NULL);
+    if (ret != 0)
+    {
+        gossip_err("error returned from handle_unexp_vfs_request "
+                   "probably unknown request code = %d\n", ret);
+    }
+}
 
-        /* gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "PVFS_sys_testany\n"); */
-        ret = PVFS_sys_testany(op_id_array,
-                               &op_count,
-                               (void *)vfs_request_array,
-                               error_code_array,
-                               PVFS2_CLIENT_DEFAULT_TEST_TIMEOUT_MS);
+/* mounts and unmounts are replayed alone, as the kernel would not
+ * issue anything else on a file system before its mount completed */
+static int replay_is_exclusive(const char *message)
+{
+    const pvfs2_upcall_t *upcall = (const pvfs2_upcall_t *)message;
 
-        /* gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "Process Request Array\n"); */
-        for(i = 0; i < op_count; i++)
+    return ((upcall->type == PVFS2_VFS_OP_FS_MOUNT) ||
+            (upcall->type == PVFS2_VFS_OP_FS_UMOUNT));
+}
+
+/*
+  hands recorded upcalls to idle requests, waiting up to timeout_ms for
+  a request to become idle.  processing stops once every upcall has
+  been replayed and answered.
+*/
+static void replay_dispatch(int timeout_ms)
+{
+    vfs_request_t *vfs_request = NULL;
+    struct qlist_head *link = NULL;
+    struct timeval now;
+    struct timespec deadline;
+    int all_idle = 0;
+
+    gettimeofday(&now, NULL);
+    now.tv_usec += timeout_ms * 1000;
+    deadline.tv_sec = now.tv_sec + now.tv_usec / 1000000;
+    deadline.tv_nsec = (now.tv_usec % 1000000) * 1000;
+
+    pthread_mutex_lock(&s_replay.mutex);
+    while (s_client_is_processing)
+    {
+        if (!s_replay.next && !s_replay.eof)
         {
-            gossip_debug(GOSSIP_CLIENTCORE_DEBUG,
-                         "Process Request Array(%d)\n",i);
-            vfs_request = vfs_request_array[i];
-            gossip_debug(GOSSIP_CLIENTCORE_DEBUG,
-                         "*** New vfs_request = %p\n", vfs_request);
+            replay_read_record();
+        }
 
-            assert(vfs_request);
-/*             assert(vfs_request->op_id == op_id_array[i]); */
-            if (vfs_request->num_ops == 1 &&
-                    vfs_request->op_id != op_id_array[i])
+        all_idle = (s_replay.idle_count == s_opts.max_ops);
+        if (all_idle)
+        {
+            s_replay.exclusive = 0;
+            if (!s_replay.next)
             {
-                gossip_err("op_id %Ld != completed op id %Ld\n",
-                        lld(vfs_request->op_id), lld(op_id_array[i]));
+                gettimeofday(&s_replay.end, NULL);
+                s_client_is_processing = 0;
+                break;
+            }
+        }
+
+        if (s_replay.next && s_replay.idle_count > 0 &&
+            (all_idle || (!s_replay.exclusive &&
+                          !replay_is_exclusive(s_replay.next +
+                                               PINT_DEV_UNEXP_HEADER_SIZE))))
+        {
+            link = qlist_pop(&s_replay.idle);
+            s_replay.idle_count--;
+            vfs_request = qlist_entry(link, vfs_request_t, queue_link);
+
+            vfs_request->info.buffer =
+                s_replay.next + PINT_DEV_UNEXP_HEADER_SIZE;
+            vfs_request->info.size = s_replay.next_record.size;
+            vfs_request->info.tag = s_replay.next_record.tag;
+            s_replay.exclusive = replay_is_exclusive(vfs_request->info.buffer);
+            s_replay.next = NULL;
+            if (s_replay.upcalls++ == 0)
+            {
+                gettimeofday(&s_replay.start, NULL);
+            }
+
+            pthread_mutex_unlock(&s_replay.mutex);
+            dispatch_unexp_vfs_request(vfs_request);
+            pthread_mutex_lock(&s_replay.mutex);
+            continue;
+        }
+
+        if ((timeout_ms <= 0) ||
+            (pthread_cond_timedwait(&s_replay.cond, &s_replay.mutex,
+                                    &deadline) == ETIMEDOUT))
+        {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s_replay.mutex);
+}
+
+static void report_replay(void)
+{
+    double elapsed = (s_replay.end.tv_sec - s_replay.start.tv_sec) +
+        (s_replay.end.tv_usec - s_replay.start.tv_usec) / 1e6;
+#ifdef CLIENT_CORE_WORKER_LANES
+    int i = 0;
+#endif
+
+    printf("replayed %llu upcalls: %llu downcalls, %llu errors, "
+           "%.3f s, %.1f ops/s\n",
+           llu(s_replay.upcalls), llu(s_replay.downcalls),
+           llu(s_replay.errors), elapsed,
+           (elapsed > 0) ? s_replay.upcalls / elapsed : 0.0);
+#ifdef CLIENT_CORE_WORKER_LANES
+    for (i = 0; s_lanes_enabled && i < NUM_LANES; i++)
+    {
+        printf("  %-10s lane: %d threads, %llu dispatched, "
+               "max queue depth %d\n", s_lanes[i].name,
+               s_lanes[i].worker_count, llu(s_lanes[i].dispatched),
+               s_lanes[i].max_queue_depth);
+    }
+#endif
+}
+
+#ifdef CLIENT_CORE_WORKER_LANES
+/*
+  picks the lane for a new upcall.  owner is set when only one worker
+  may handle it: a cancellation goes to the worker that posted the
+  operation, and requests that change client wide state all go to the
+  first metadata worker.
+*/
+static struct client_core_lane *lane_for_upcall(
+    vfs_request_t *vfs_request, struct lane_worker **owner)
+{
+    pvfs2_upcall_t *upcall = (pvfs2_upcall_t *)vfs_request->info.buffer;
+    struct qlist_head *hash_link = NULL;
+    vfs_request_t *target = NULL;
+    PVFS_id_gen_t tag = 0;
+    int lane = LANE_META;
+    int64_t count = -1;
+
+    *owner = NULL;
+
+    /* errors and short reads are reposted by any metadata worker */
+    if (vfs_request->jstat.error_code ||
+        (vfs_request->info.size < sizeof(pvfs2_upcall_t)))
+    {
+        return &s_lanes[LANE_META];
+    }
+
+    switch(upcall->type)
+    {
+        case PVFS2_VFS_OP_FILE_IO:
+            count = upcall->req.io.count;
+            break;
+        case PVFS2_VFS_OP_FILE_IOX:
+            count = upcall->req.iox.count;
+            break;
+        case PVFS2_VFS_OP_CANCEL:
+            tag = (PVFS_id_gen_t)upcall->req.cancel.op_tag;
+            pthread_mutex_lock(&s_ops_in_progress_mutex);
+            hash_link = qhash_search(s_ops_in_progress_table, (void *)&tag);
+            if (hash_link)
+            {
+                target = qhash_entry(hash_link, vfs_request_t, hash_link);
+                *owner = target->worker;
+            }
+            pthread_mutex_unlock(&s_ops_in_progress_mutex);
+            break;
+        case PVFS2_VFS_OP_FS_MOUNT:
+        case PVFS2_VFS_OP_FS_UMOUNT:
+        case PVFS2_VFS_OP_PARAM:
+        case PVFS2_VFS_OP_PERF_COUNT:
+        case PVFS2_VFS_OP_FSKEY:
+        case PVFS2_VFS_OP_FEATURES:
+            *owner = &s_lanes[LANE_META].workers[0];
+            break;
+        default:
+            break;
+    }
+
+    if (*owner)
+    {
+        return (*owner)->lane;
+    }
+    if (count >= 0)
+    {
+        lane = (count <= s_opts.small_io_size) ? LANE_SMALL_IO : LANE_BULK_IO;
+        if (s_lanes[lane].worker_count == 0)
+        {
+            lane = LANE_META;
+        }
+    }
+    return &s_lanes[lane];
+}
+
+static void lane_dispatch(vfs_request_t *vfs_request)
+{
+    struct lane_worker *owner = NULL;
+    struct client_core_lane *lane = lane_for_upcall(vfs_request, &owner);
+
+    pthread_mutex_lock(&lane->mutex);
+    if (owner)
+    {
+        qlist_add_tail(&vfs_request->queue_link, &owner->private_queue);
+        /* the workers of a lane share one condition */
+        pthread_cond_broadcast(&lane->cond);
+    }
+    else
+    {
+        qlist_add_tail(&vfs_request->queue_link, &lane->queue);
+        if (++lane->queue_depth > lane->max_queue_depth)
+        {
+            lane->max_queue_depth = lane->queue_depth;
+        }
+        pthread_cond_signal(&lane->cond);
+    }
+    lane->dispatched++;
+    pthread_mutex_unlock(&lane->mutex);
+}
+
+/*
+  accounts for a completed sysint operation of a request posted by a
+  lane worker.  returns 1 once the whole request has been answered and
+  reposted.
+*/
+static int complete_lane_op(vfs_request_t *vfs_request,
+                            PVFS_sys_op_id op_id,
+                            int *error_code)
+{
+    PVFS_error ret = 0;
+    int j = 0;
+
+    if (vfs_request->num_ops == 1 && vfs_request->op_id != op_id)
+    {
+        gossip_err("op_id %lld != completed op id %lld\n",
+                   lld(vfs_request->op_id), lld(op_id));
+        return 0;
+    }
+    else if (vfs_request->num_ops > 1)
+    {
+        for (j = 0; j < vfs_request->num_ops; j++)
+        {
+            if (op_id == vfs_request->op_ids[j])
+            {
+                break;
+            }
+        }
+        if (j == vfs_request->num_ops)
+        {
+            gossip_err("completed op id (%lld) is weird\n", lld(op_id));
+            return 0;
+        }
+    }
+
+    vfs_request->num_incomplete_ops--;
+    if (vfs_request->num_incomplete_ops != 0)
+    {
+        return 0;
+    }
+    log_operation_timing(vfs_request);
+
+    ret = remove_op_from_ops_in_progress_table(vfs_request);
+    if (ret)
+    {
+        PVFS_perror_gossip("Failed to remove op in progress from table", ret);
+        repost_unexp_vfs_request(vfs_request, "error completion");
+        return 1;
+    }
+
+    package_downcall_members(vfs_request, error_code);
+
+    /* cancelled I/O is not answered; the kernel has given up on it */
+    if (!vfs_request->was_cancelled_io)
+    {
+        write_downcall(vfs_request);
+        repost_unexp_vfs_request(vfs_request, "normal_completion");
+    }
+    else
+    {
+        repost_unexp_vfs_request(vfs_request, "cancellation");
+    }
+    return 1;
+}
+
+/* collects the ids of every sysint operation the worker has in flight */
+static int lane_worker_op_ids(struct lane_worker *worker)
+{
+    vfs_request_t *vfs_request = NULL;
+    PVFS_sys_op_id *op_ids = NULL;
+    int count = 0, n = 0, i = 0;
+
+    for (i = 0; i < worker->in_flight_count; i++)
+    {
+        vfs_request = worker->in_flight[i];
+        n = (vfs_request->num_ops > 1) ? vfs_request->num_ops : 1;
+        if (count + n > worker->op_ids_size)
+        {
+            op_ids = realloc(worker->op_ids,
+                             2 * (count + n) * sizeof(PVFS_sys_op_id));
+            if (!op_ids)
+            {
+                gossip_lerr("out of memory\n");
+                break;
+            }
+            worker->op_ids = op_ids;
+            worker->op_ids_size = 2 * (count + n);
+        }
+        if (n == 1)
+        {
+            worker->op_ids[count] = vfs_request->op_id;
+        }
+        else
+        {
+            memcpy(&worker->op_ids[count], vfs_request->op_ids,
+                   n * sizeof(PVFS_sys_op_id));
+        }
+        count += n;
+    }
+    return count;
+}
+
+static void *lane_worker_main(void *arg)
+{
+    struct lane_worker *worker = (struct lane_worker *)arg;
+    struct client_core_lane *lane = worker->lane;
+    struct qlist_head new_requests;
+    struct qlist_head *link = NULL;
+    vfs_request_t *vfs_request = NULL;
+    vfs_request_t *vfs_request_array[MAX_TEST_OPS];
+    PVFS_sys_op_id op_id_array[MAX_TEST_OPS];
+    int error_code_array[MAX_TEST_OPS];
+    int op_count = 0, id_count = 0, offset = 0, taken = 0;
+    int posted = 0, timeout_ms = 0, i = 0, j = 0;
+    PVFS_error ret = 0;
+
+    while (!s_lanes_stopping)
+    {
+        INIT_QLIST_HEAD(&new_requests);
+
+        pthread_mutex_lock(&lane->mutex);
+        while (!s_lanes_stopping && (worker->in_flight_count == 0) &&
+               qlist_empty(&worker->private_queue) &&
+               qlist_empty(&lane->queue))
+        {
+            pthread_cond_wait(&lane->cond, &lane->mutex);
+        }
+        while ((link = qlist_pop(&worker->private_queue)))
+        {
+            qlist_add_tail(link, &new_requests);
+        }
+        /* leave the rest of a burst to the other workers of the lane */
+        for (taken = 0; taken < LANE_WORKER_BATCH; taken++)
+        {
+            if (!(link = qlist_pop(&lane->queue)))
+            {
+                break;
+            }
+            lane->queue_depth--;
+            qlist_add_tail(link, &new_requests);
+        }
+        timeout_ms = (qlist_empty(&lane->queue) ?
+                      PVFS2_CLIENT_DEFAULT_TEST_TIMEOUT_MS : 0);
+        pthread_mutex_unlock(&lane->mutex);
+
+        while ((link = qlist_pop(&new_requests)))
+        {
+            vfs_request = qlist_entry(link, vfs_request_t, queue_link);
+            vfs_request->worker = worker;
+
+            /* our sysint operations are posted on our own context */
+            ret = handle_unexp_vfs_request(vfs_request, &posted);
+            if (ret != 0)
+            {
+                gossip_err("error returned from handle_unexp_vfs_request "
+                           "probably unknown request code = %d\n", ret);
+            }
+            if (posted)
+            {
+                worker->in_flight[worker->in_flight_count++] = vfs_request;
+            }
+        }
+
+        id_count = lane_worker_op_ids(worker);
+        for (offset = 0; offset < id_count; offset += MAX_TEST_OPS)
+        {
+            op_count = id_count - offset;
+            if (op_count > MAX_TEST_OPS)
+            {
+                op_count = MAX_TEST_OPS;
+            }
+            memcpy(op_id_array, &worker->op_ids[offset],
+                   op_count * sizeof(PVFS_sys_op_id));
+
+            /* only the first call waits; it makes progress on all of
+             * our operations */
+            ret = PVFS_sys_testsome(op_id_array, &op_count,
+                                    (void **)vfs_request_array,
+                                    error_code_array,
+                                    (offset == 0) ? timeout_ms : 0);
+            if (ret < 0)
+            {
+                PVFS_perror_gossip("PVFS_sys_testsome()", ret);
+                break;
+            }
+
+            for (i = 0; i < op_count; i++)
+            {
+                vfs_request = vfs_request_array[i];
+                assert(vfs_request);
+
+                if (!complete_lane_op(vfs_request, op_id_array[i],
+                                      &error_code_array[i]))
+                {
+                    continue;
+                }
+                worker->completed++;
+                for (j = 0; j < worker->in_flight_count; j++)
+                {
+                    if (worker->in_flight[j] == vfs_request)
+                    {
+                        worker->in_flight[j] =
+                            worker->in_flight[--worker->in_flight_count];
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+static int start_lanes(void)
+{
+    static const char *lane_names[NUM_LANES] =
+        { "metadata", "small I/O", "bulk I/O" };
+    struct client_core_lane *lane = NULL;
+    struct lane_worker *worker = NULL;
+    int i = 0, j = 0;
+
+    for (i = 0; i < NUM_LANES; i++)
+    {
+        lane = &s_lanes[i];
+        memset(lane, 0, sizeof(*lane));
+        lane->name = lane_names[i];
+        pthread_mutex_init(&lane->mutex, NULL);
+        pthread_cond_init(&lane->cond, NULL);
+        INIT_QLIST_HEAD(&lane->queue);
+
+        lane->worker_count = s_opts.lane_threads[i];
+        if (lane->worker_count == 0)
+        {
+            continue;
+        }
+        lane->workers = calloc(lane->worker_count,
+                               sizeof(struct lane_worker));
+        if (!lane->workers)
+        {
+            return -PVFS_ENOMEM;
+        }
+        for (j = 0; j < lane->worker_count; j++)
+        {
+            worker = &lane->workers[j];
+            worker->lane = lane;
+            worker->index = j;
+            INIT_QLIST_HEAD(&worker->private_queue);
+            worker->in_flight = malloc(s_opts.max_ops *
+                                       sizeof(vfs_request_t *));
+            if (!worker->in_flight)
+            {
+                return -PVFS_ENOMEM;
+            }
+        }
+    }
+
+    /* every lane must be set up before the first worker runs */
+    for (i = 0; i < NUM_LANES; i++)
+    {
+        for (j = 0; j < s_lanes[i].worker_count; j++)
+        {
+            worker = &s_lanes[i].workers[j];
+            if (pthread_create(&worker->thread, NULL,
+                               lane_worker_main, worker))
+            {
+                gossip_err("Cannot create %s worker thread!\n",
+                           s_lanes[i].name);
+                s_lanes[i].worker_count = j;
+                return -PVFS_ENOMEM;
+            }
+        }
+        gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "started %d %s workers\n",
+                     s_lanes[i].worker_count, s_lanes[i].name);
+    }
+    return 0;
+}
+
+static void stop_lanes(void)
+{
+    struct lane_worker *worker = NULL;
+    int i = 0, j = 0;
+
+    s_lanes_stopping = 1;
+    for (i = 0; i < NUM_LANES; i++)
+    {
+        pthread_mutex_lock(&s_lanes[i].mutex);
+        pthread_cond_broadcast(&s_lanes[i].cond);
+        pthread_mutex_unlock(&s_lanes[i].mutex);
+    }
+
+    for (i = 0; i < NUM_LANES; i++)
+    {
+        for (j = 0; j < s_lanes[i].worker_count; j++)
+        {
+            worker = &s_lanes[i].workers[j];
+            pthread_join(worker->thread, NULL);
+            gossip_debug(GOSSIP_CLIENTCORE_DEBUG,
+                         "%s worker %d completed %llu requests\n",
+                         s_lanes[i].name, j, llu(worker->completed));
+            free(worker->in_flight);
+            free(worker->op_ids);
+        }
+        gossip_debug(GOSSIP_CLIENTCORE_DEBUG,
+                     "%s lane: %llu dispatched, max queue depth %d\n",
+                     s_lanes[i].name, llu(s_lanes[i].dispatched),
+                     s_lanes[i].max_queue_depth);
+        free(s_lanes[i].workers);
+        s_lanes[i].workers = NULL;
+    }
+}
+
+/*
+  the main thread's loop when worker lanes are enabled: wait for
+  upcalls from the device (or the stream being replayed) and pass them
+  on to the lanes
+*/
+static PVFS_error process_vfs_requests_in_lanes(void)
+{
+    PVFS_error ret = 0;
+    int count = 0, i = 0;
+    job_id_t job_id_array[MAX_TEST_OPS];
+    job_status_s job_status_array[MAX_TEST_OPS];
+    vfs_request_t *vfs_request_array[MAX_TEST_OPS];
+
+    ret = start_lanes();
+    if (ret == 0)
+    {
+        ret = post_initial_vfs_requests();
+    }
+    if (ret < 0)
+    {
+        stop_lanes();
+        return ret;
+    }
+
+    if (!s_replay.file)
+    {
+        pthread_mutex_unlock(&remount_mutex);
+    }
+
+    while(s_client_is_processing)
+    {
+        /* write out small writes that have been held too long */
+        PINT_wbcache_flush_expired();
+
+        if (s_replay.file)
+        {
+            replay_dispatch(PVFS2_CLIENT_DEFAULT_TEST_TIMEOUT_MS);
+            continue;
+        }
+
+        count = MAX_TEST_OPS;
+        ret = job_testcontext(job_id_array, &count,
+                              (void **)vfs_request_array, job_status_array,
+                              PVFS2_CLIENT_DEFAULT_TEST_TIMEOUT_MS,
+                              s_client_unexp_context);
+        if (ret < 0)
+        {
+            PVFS_perror_gossip("job_testcontext()", ret);
+            break;
+        }
+
+        for (i = 0; i < count; i++)
+        {
+            vfs_request_array[i]->jstat = job_status_array[i];
+            dispatch_unexp_vfs_request(vfs_request_array[i]);
+        }
+
+        /* see process_vfs_requests() */
+        if (remount_complete == REMOUNT_FAILED)
+        {
+            gossip_debug(GOSSIP_CLIENTCORE_DEBUG,
+                         "%s: remount not completed successfully, no longer "
+                         "handling requests.\n", __func__);
+            ret = -PVFS_EAGAIN;
+            break;
+        }
+    }
+
+    stop_lanes();
+    if (s_client_signal)
+    {
+        gossip_err("Client Core Caught Signal %d - Halt Processing\n",
+                   s_client_signal);
+    }
+    return ret;
+}
+#endif /* CLIENT_CORE_WORKER_LANES */
+
+static PVFS_error process_vfs_requests(void)
+{
+    PVFS_error ret = 0; 
+    int op_count = 0, i = 0;
+    vfs_request_t *vfs_request = NULL;
+    vfs_request_t *vfs_request_array[MAX_TEST_OPS] = {NULL};
+    PVFS_sys_op_id op_id_array[MAX_TEST_OPS];
+    int error_code_array[MAX_TEST_OPS] = {0};
+#ifdef USE_RA_CACHE
+    struct qlist_head *link = NULL;
+    gen_link_t *glink = NULL;
+    racache_buffer_t *buff = NULL;
+    vfs_request_t *vl = NULL;
+#endif
+
+
+    gossip_debug(GOSSIP_CLIENTCORE_DEBUG,
+                 "process_vfs_requests called\n");
+
+    gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "Post Initial Unexp Requests\n");
+    /* allocate and post all of our initial unexpected vfs requests */
+    ret = post_initial_vfs_requests();
+    if (ret < 0)
+    {
+        return ret;
+    }
+
+    /*
+      signal the remount thread to go ahead with the remount attempts
+      since we're ready to handle requests now
+    */
+    if (!s_replay.file)
+    {
+        pthread_mutex_unlock(&remount_mutex);
+    }
+
+    gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "Start Processing Loop\n");
+    while(s_client_is_processing)
+    {
+        /* write out small writes that have been held too long */
+        PINT_wbcache_flush_expired();
+
+        if (s_replay.file)
+        {
+            /* completions are tested below, so never wait here */
+            replay_dispatch(0);
+        }
+
+        op_count = MAX_TEST_OPS;
+        memset(error_code_array, 0, (MAX_TEST_OPS * sizeof(int)));
+        memset(vfs_request_array, 0, (MAX_TEST_OPS * sizeof(vfs_request_t *)));
+
+#if 0
+        /* generates too much logging, but useful sometimes */
+        gossip_debug(GOSSIP_CLIENTCORE_DEBUG,
+                 "Calling PVFS_sys_testany for new requests\n");
+#endif
+
+        /* gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "PVFS_sys_testany\n"); */
+        ret = PVFS_sys_testany(op_id_array,
+                               &op_count,
+                               (void *)vfs_request_array,
+                               error_code_array,
+                               PVFS2_CLIENT_DEFAULT_TEST_TIMEOUT_MS);
+
+        /* gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "Process Request Array\n"); */
+        for(i = 0; i < op_count; i++)
+        {
+            gossip_debug(GOSSIP_CLIENTCORE_DEBUG,
+                         "Process Request Array(%d)\n",i);
+            vfs_request = vfs_request_array[i];
+            gossip_debug(GOSSIP_CLIENTCORE_DEBUG,
+                         "*** New vfs_request = %p\n", vfs_request);
+
+            assert(vfs_request);
+/*             assert(vfs_request->op_id == op_id_array[i]); */
+            if (vfs_request->num_ops == 1 &&
+                    vfs_request->op_id != op_id_array[i])
+            {
+                gossip_err("op_id %Ld != completed op id %Ld\n",
+                        lld(vfs_request->op_id), lld(op_id_array[i]));
 #ifdef USE_RA_CACHE
                 if (vfs_request->is_readahead_speculative)
                 {
@@ -4714,7 +5772,7 @@ static PVFS_error process_vfs_requests(void)
                              " returned unexp vfs_request %p, tag: %llu\n",
                              vfs_request,
                              llu(vfs_request->info.tag));
-                ret = handle_unexp_vfs_request(vfs_request);
+                ret = handle_unexp_vfs_request(vfs_request, NULL);
                 if (ret != 0)
                 {
                     /* assert(ret == 0); */
@@ -5079,6 +6137,30 @@ int main(int argc, char **argv)
 #endif
     parse_args(argc, argv, &s_opts);
 
+    if (s_opts.lane_threads[LANE_META] + s_opts.lane_threads[LANE_SMALL_IO] +
+        s_opts.lane_threads[LANE_BULK_IO] > 0)
+    {
+#ifdef CLIENT_CORE_WORKER_LANES
+        char contexts[16];
+
+        s_lanes_enabled = 1;
+        /* requests serviced inline run on the first metadata worker */
+        if (s_opts.lane_threads[LANE_META] == 0)
+        {
+            s_opts.lane_threads[LANE_META] = 1;
+        }
+        /* a sysint context per worker, as far as the sysint allows */
+        snprintf(contexts, sizeof(contexts), "%u",
+                 s_opts.lane_threads[LANE_META] +
+                 s_opts.lane_threads[LANE_SMALL_IO] +
+                 s_opts.lane_threads[LANE_BULK_IO]);
+        setenv("PVFS2_CLIENT_SM_CONTEXTS", contexts, 0);
+#else
+        gossip_err("Worker threads need the threaded client core without "
+                   "the readahead cache; ignoring them.\n");
+#endif
+    }
+
     signal(SIGHUP,  client_core_sig_handler);
     signal(SIGINT,  client_core_sig_handler);
     signal(SIGPIPE, client_core_sig_handler);
@@ -5156,13 +6238,16 @@ int main(int argc, char **argv)
         return(-PVFS_EINVAL);
     }
 
-    /* get rid of stdout/stderr/stdin */
+    /* get rid of stdout/stderr/stdin; a replay reports on stdout */
     if(!freopen("/dev/null", "r", stdin))
         gossip_err("Error: failed to reopen stdin.\n");
-    if(!freopen("/dev/null", "w", stdout))
-        gossip_err("Error: failed to reopen stdout.\n");
-    if(!freopen("/dev/null", "w", stderr))
-        gossip_err("Error: failed to reopen stderr.\n");
+    if(!s_opts.replay_file)
+    {
+        if(!freopen("/dev/null", "w", stdout))
+            gossip_err("Error: failed to reopen stdout.\n");
+        if(!freopen("/dev/null", "w", stderr))
+            gossip_err("Error: failed to reopen stderr.\n");
+    }
 
     start_time = time(NULL);
     local_time = localtime(&start_time);
@@ -5303,13 +6388,36 @@ int main(int argc, char **argv)
         return ret;
     }   
 
-    gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "Initialize Device\n");
-    ret = PINT_dev_initialize("/dev/pvfs2-req", 0);
-    if (ret < 0)
+    if (s_opts.replay_file)
     {
-        PVFS_perror_gossip("PINT_dev_initialize", ret);
-        //finalize_perf_items(3, acache_smcb, ncache_smcb, capcache_smcb);
-        return -PVFS_EDEVINIT;
+        gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "Open Recorded Upcalls\n");
+        ret = start_replaying_upcalls(s_opts.replay_file);
+        if (ret < 0)
+        {
+            return ret;
+        }
+        /* nothing to remount; the stream carries its own mount upcalls */
+        remount_complete = REMOUNT_COMPLETED;
+    }
+    else
+    {
+        gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "Initialize Device\n");
+        ret = PINT_dev_initialize("/dev/pvfs2-req", 0);
+        if (ret < 0)
+        {
+            PVFS_perror_gossip("PINT_dev_initialize", ret);
+            //finalize_perf_items(3, acache_smcb, ncache_smcb, capcache_smcb);
+            return -PVFS_EDEVINIT;
+        }
+    }
+
+    if (s_opts.record_file)
+    {
+        ret = start_recording_upcalls(s_opts.record_file);
+        if (ret < 0)
+        {
+            return ret;
+        }
     }
 
     /* setup a mapped region for I/O transfers */
@@ -5332,22 +6440,44 @@ int main(int argc, char **argv)
         return ret;
     }
 
-    /*
-      lock the remount mutex to make sure the remount isn't started
-      until we're ready
-    */
-    pthread_mutex_lock(&remount_mutex);
+#ifdef CLIENT_CORE_WORKER_LANES
+    if (s_lanes_enabled)
+    {
+        ret = job_open_context(&s_client_unexp_context);
+        if (ret < 0)
+        {
+            PVFS_perror_gossip("unexp job_open_context failed", ret);
+            return ret;
+        }
+    }
+#endif
 
-    gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "Create Remount Thread\n");
-    if (pthread_create(&remount_thread, NULL, exec_remount, NULL))
+    if (!s_opts.replay_file)
     {
-        gossip_err("Cannot create remount thread!");
-        //finalize_perf_items(3, acache_smcb, ncache_smcb, capcache_smcb);
-        return -1;
+        /*
+          lock the remount mutex to make sure the remount isn't started
+          until we're ready
+        */
+        pthread_mutex_lock(&remount_mutex);
+
+        gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "Create Remount Thread\n");
+        if (pthread_create(&remount_thread, NULL, exec_remount, NULL))
+        {
+            gossip_err("Cannot create remount thread!");
+            //finalize_perf_items(3, acache_smcb, ncache_smcb, capcache_smcb);
+            return -1;
+        }
     }
 
     /******************** Start Processing *************************/
     gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "Start Processing Requests\n");
+#ifdef CLIENT_CORE_WORKER_LANES
+    if (s_lanes_enabled)
+    {
+        ret = process_vfs_requests_in_lanes();
+    }
+    else
+#endif
     ret = process_vfs_requests();
     if (ret)
     {
@@ -5357,7 +6487,12 @@ int main(int argc, char **argv)
 
     gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "Shutting Down\n");
     /* join remount thread; should be long done by now */
-    if (remount_complete == REMOUNT_COMPLETED )
+    if (s_opts.replay_file)
+    {
+        report_replay();
+        fclose(s_replay.file);
+    }
+    else if (remount_complete == REMOUNT_COMPLETED )
     {
         pthread_join(remount_thread, NULL);
     }
@@ -5366,20 +6501,41 @@ int main(int argc, char **argv)
         pthread_cancel(remount_thread);
     }
 
+    if (s_record.file)
+    {
+        pthread_mutex_lock(&s_record.mutex);
+        gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "Recorded %llu upcalls\n",
+                     llu(s_record.upcalls));
+        fclose(s_record.file);
+        s_record.file = NULL;
+        pthread_mutex_unlock(&s_record.mutex);
+    }
+
     gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "Finalize Ops In Progress\n");
     finalize_ops_in_progress_table();
 
     gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "Freeing Allocated Resources\n");
     /* free all allocated resources */
-    for(i = 0; i < MAX_NUM_OPS; i++)
+    for(i = 0; s_vfs_request_array && i < s_opts.max_ops; i++)
     {
-        PINT_dev_release_unexpected(&s_vfs_request_array[i]->info);
-        PINT_sys_release(s_vfs_request_array[i]->op_id);
-        free(s_vfs_request_array[i]);
+        if (s_vfs_request_array[i])
+        {
+            PINT_dev_release_unexpected(&s_vfs_request_array[i]->info);
+            PINT_sys_release(s_vfs_request_array[i]->op_id);
+            free(s_vfs_request_array[i]);
+        }
     }
+    free(s_vfs_request_array);
+    s_vfs_request_array = NULL;
 
     gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "Close Job Context\n");
     job_close_context(s_client_dev_context);
+#ifdef CLIENT_CORE_WORKER_LANES
+    if (s_lanes_enabled)
+    {
+        job_close_context(s_client_unexp_context);
+    }
+#endif
 
     gossip_debug(GOSSIP_CLIENTCORE_DEBUG, "Finalize Tcache\n");
     PINT_tcache_finalize(credential_cache);
@@ -5482,6 +6638,20 @@ static void print_help(char *progname)
     printf("--desc-count=VALUE            overrides the default # of kernel buffer descriptors\n");
     printf("--desc-size=VALUE             overrides the default size of each kernel buffer descriptor\n");
     printf("--events=EVENT_LIST           specify the events to enable\n");
+    printf("--max-ops=VALUE               max # of operations in flight "
+           "(default is %d)\n", PVFS2_CLIENT_DEFAULT_MAX_OPS);
+#ifdef CLIENT_CORE_WORKER_LANES
+    printf("--meta-threads=VALUE          # of worker threads for metadata "
+           "operations\n");
+    printf("--small-io-threads=VALUE      # of worker threads for small I/O\n");
+    printf("--bulk-io-threads=VALUE       # of worker threads for bulk I/O\n");
+    printf("--small-io-size=BYTES         largest I/O handled as small I/O "
+           "(default is %d)\n", PVFS2_CLIENT_DEFAULT_SMALL_IO_SIZE);
+#endif
+    printf("--record-upcalls=FILE         append every upcall received to FILE\n");
+    printf("--replay-upcalls=FILE         replay the upcalls recorded in FILE "
+           "instead of\n"
+           "                              reading the device, then exit\n");
 }
 
 static void parse_args(int argc, char **argv, options_t *opts)
@@ -5525,12 +6695,21 @@ static void parse_args(int argc, char **argv, options_t *opts)
         {"events",1,0,0},
         {"keypath",1,0,0},
         {"bmi-opts",1,0,0},
+        {"max-ops",1,0,0},
+        {"meta-threads",1,0,0},
+        {"small-io-threads",1,0,0},
+        {"bulk-io-threads",1,0,0},
+        {"small-io-size",1,0,0},
+        {"record-upcalls",1,0,0},
+        {"replay-upcalls",1,0,0},
         {0,0,0,0}
     };
 
     assert(opts);
     opts->perf_time_interval_secs = PERF_DEFAULT_UPDATE_INTERVAL / 1000;
     opts->perf_history_size = PERF_DEFAULT_HISTORY_SIZE;
+    opts->max_ops = PVFS2_CLIENT_DEFAULT_MAX_OPS;
+    opts->small_io_size = PVFS2_CLIENT_DEFAULT_SMALL_IO_SIZE;
 
     while((ret = getopt_long(argc, argv, "ha:n:c:L:b:",
                              long_opts, &option_index)) != -1)
@@ -5831,6 +7010,54 @@ static void parse_args(int argc, char **argv, options_t *opts)
                 {
                     opts->bmi_opts = optarg;
                 }
+                else if (strcmp("max-ops", cur_option) == 0)
+                {
+                    ret = sscanf(optarg, "%u", &opts->max_ops);
+                    if(ret != 1 || opts->max_ops < 1 ||
+                       opts->max_ops > PVFS2_CLIENT_MAX_OPS_LIMIT)
+                    {
+                        gossip_err(
+                            "Error: invalid max-ops value (1 to %d).\n",
+                            PVFS2_CLIENT_MAX_OPS_LIMIT);
+                        exit(EXIT_FAILURE);
+                    }
+                }
+                else if ((strcmp("meta-threads", cur_option) == 0) ||
+                         (strcmp("small-io-threads", cur_option) == 0) ||
+                         (strcmp("bulk-io-threads", cur_option) == 0))
+                {
+                    int lane = (cur_option[0] == 'm') ? LANE_META :
+                               ((cur_option[0] == 's') ? LANE_SMALL_IO :
+                                LANE_BULK_IO);
+
+                    ret = sscanf(optarg, "%u", &opts->lane_threads[lane]);
+                    if(ret != 1 ||
+                       opts->lane_threads[lane] > PVFS2_CLIENT_MAX_LANE_THREADS)
+                    {
+                        gossip_err(
+                            "Error: invalid %s value (0 to %d).\n",
+                            cur_option, PVFS2_CLIENT_MAX_LANE_THREADS);
+                        exit(EXIT_FAILURE);
+                    }
+                }
+                else if (strcmp("small-io-size", cur_option) == 0)
+                {
+                    ret = sscanf(optarg, "%u", &opts->small_io_size);
+                    if(ret != 1)
+                    {
+                        gossip_err(
+                            "Error: invalid small-io-size value.\n");
+                        exit(EXIT_FAILURE);
+                    }
+                }
+                else if (strcmp("record-upcalls", cur_option) == 0)
+                {
+                    opts->record_file = optarg;
+                }
+                else if (strcmp("replay-upcalls", cur_option) == 0)
+                {
+                    opts->replay_file = optarg;
+                }
                 break;
             case 'h':
           do_help:
@@ -6480,7 +7707,8 @@ static PVFS_credential *generate_credential(PVFS_uid uid, PVFS_gid gid)
 
 #define CRED_TIMEOUT_BUFFER 5
 
-static PVFS_credential *lookup_credential(PVFS_uid uid, PVFS_gid gid)
+/* caller holds credential_cache_mutex */
+static PVFS_credential *lookup_credential_locked(PVFS_uid uid, PVFS_gid gid)
 {
     struct credential_key ckey;
     struct credential_payload *cpayload;
@@ -6571,6 +7799,17 @@ static PVFS_credential *lookup_credential(PVFS_uid uid, PVFS_gid gid)
     return credential;
 }
 
+static PVFS_credential *lookup_credential(PVFS_uid uid, PVFS_gid gid)
+{
+    PVFS_credential *credential;
+
+    pthread_mutex_lock(&credential_cache_mutex);
+    credential = lookup_credential_locked(uid, gid);
+    pthread_mutex_unlock(&credential_cache_mutex);
+
+    return credential;
+}
+
 /* remove credential from cache */
 void remove_credential(PVFS_uid uid,
                        PVFS_gid gid)
@@ -6586,6 +7825,7 @@ void remove_credential(PVFS_uid uid,
     ckey.gid = gid;
 
     /* lookup credential */
+    pthread_mutex_lock(&credential_cache_mutex);
     ret = PINT_tcache_lookup(credential_cache, &ckey, &entry, &status);
 
     if (ret == 0)
@@ -6599,6 +7839,7 @@ void remove_credential(PVFS_uid uid,
         gossip_debug(GOSSIP_SECURITY_DEBUG, "... cache lookup returned %d\n", 
                      ret);
     }
+    pthread_mutex_unlock(&credential_cache_mutex);
 
 }
 
@@ -77,6 +77,12 @@ typedef struct
     char *readahead_readcnt;
     char *readahead_pinned;
     char *bmi_opts;
+    char *max_ops;
+    char *meta_threads;
+    char *small_io_threads;
+    char *bulk_io_threads;
+    char *small_io_size;
+    char *record_upcalls;
 } options_t;
 
 static void client_sig_handler(int signum);
@@ -529,6 +535,42 @@ static int monitor_pvfs2_client(options_t *opts)
                 arg_list[arg_index+1] = opts->bmi_opts;
                 arg_index+=2;
             }
+            if (opts->max_ops)
+            {
+                arg_list[arg_index] = "--max-ops";
+                arg_list[arg_index+1] = opts->max_ops;
+                arg_index+=2;
+            }
+            if (opts->meta_threads)
+            {
+                arg_list[arg_index] = "--meta-threads";
+                arg_list[arg_index+1] = opts->meta_threads;
+                arg_index+=2;
+            }
+            if (opts->small_io_threads)
+            {
+                arg_list[arg_index] = "--small-io-threads";
+                arg_list[arg_index+1] = opts->small_io_threads;
+                arg_index+=2;
+            }
+            if (opts->bulk_io_threads)
+            {
+                arg_list[arg_index] = "--bulk-io-threads";
+                arg_list[arg_index+1] = opts->bulk_io_threads;
+                arg_index+=2;
+            }
+            if (opts->small_io_size)
+            {
+                arg_list[arg_index] = "--small-io-size";
+                arg_list[arg_index+1] = opts->small_io_size;
+                arg_index+=2;
+            }
+            if (opts->record_upcalls)
+            {
+                arg_list[arg_index] = "--record-upcalls";
+                arg_list[arg_index+1] = opts->record_upcalls;
+                arg_index+=2;
+            }
 
             if(opts->verbose)
             {
@@ -600,6 +642,12 @@ static void print_help(char *progname)
     printf("--events=EVENTS               enable tracing of certain EVENTS\n");
     printf("--keypath=PATH                path to credential key file\n");
     printf("--bmi-opts=\"OPTIONS\"          comma-seperated options string to pass to bmi\n");
+    printf("--max-ops=VALUE               max # of operations in flight in the client core\n");
+    printf("--meta-threads=VALUE          # of client core worker threads for metadata\n");
+    printf("--small-io-threads=VALUE      # of client core worker threads for small I/O\n");
+    printf("--bulk-io-threads=VALUE       # of client core worker threads for bulk I/O\n");
+    printf("--small-io-size=BYTES         largest I/O handled as small I/O\n");
+    printf("--record-upcalls=FILE         record every upcall to FILE for later replay\n");
 }
 
 static void parse_args(int argc, char **argv, options_t *opts)
@@ -646,6 +694,12 @@ static void parse_args(int argc, char **argv, options_t *opts)
         {"events",1,0,0},
         {"keypath",1,0,0},
         {"bmi-opts",1,0,0},
+        {"max-ops",1,0,0},
+        {"meta-threads",1,0,0},
+        {"small-io-threads",1,0,0},
+        {"bulk-io-threads",1,0,0},
+        {"small-io-size",1,0,0},
+        {"record-upcalls",1,0,0},
         {0,0,0,0}
     };
 
@@ -805,6 +859,30 @@ static void parse_args(int argc, char **argv, options_t *opts)
                 {
                     opts->bmi_opts = optarg;
                 }
+                else if (strcmp("max-ops", cur_option) == 0)
+                {
+                    opts->max_ops = optarg;
+                }
+                else if (strcmp("meta-threads", cur_option) == 0)
+                {
+                    opts->meta_threads = optarg;
+                }
+                else if (strcmp("small-io-threads", cur_option) == 0)
+                {
+                    opts->small_io_threads = optarg;
+                }
+                else if (strcmp("bulk-io-threads", cur_option) == 0)
+                {
+                    opts->bulk_io_threads = optarg;
+                }
+                else if (strcmp("small-io-size", cur_option) == 0)
+                {
+                    opts->small_io_size = optarg;
+                }
+                else if (strcmp("record-upcalls", cur_option) == 0)
+                {
+                    opts->record_upcalls = optarg;
+                }
 
                 break;
             case 'h':
@@ -14,6 +14,8 @@
 #include "str-utils.h"
 #include "pvfs2.h"
 #include "gossip.h"
+#include "gen-locks.h"
+#include "security-util.h"
 
 
 /* GLOBALS */
@@ -502,7 +504,7 @@ int orangefs_create_h(OrangeFS_fsid *fs_id, OrangeFS_credential *cred, OrangeFS_
     if (name[strlen(name)-1] == '/')
         return -1;
 
-	parent_ref.fs_id = (PVFS_fs_id) fs_id;
+	parent_ref.fs_id = *fs_id;
     parent_ref.handle = (PVFS_handle) parent_handle;
 
 	/* create file */
@@ -552,7 +554,7 @@ int orangefs_remove(OrangeFS_fsid *fs_id, OrangeFS_credential *cred, char *path)
     if (ret != 0)
         goto remove_exit;
 
-	parent_ref.fs_id = (PVFS_fs_id) fs_id;
+	parent_ref.fs_id = *fs_id;
     parent_ref.handle = resp_lookup.ref.handle;
 
     ret = PVFS_sys_remove(entry_name, parent_ref, (PVFS_credential *) cred, NULL);
@@ -573,7 +575,7 @@ int orangefs_remove_h(OrangeFS_fsid *fs_id, OrangeFS_credential *cred, OrangeFS_
 		return -1;
 
 	parent_ref.handle = (PVFS_handle) handle;
-	parent_ref.fs_id = (PVFS_fs_id) fs_id;
+	parent_ref.fs_id = *fs_id;
 
     ret = PVFS_sys_remove(name, parent_ref, (PVFS_credential *) cred, NULL);
 
@@ -801,6 +803,395 @@ flush_exit:
     return ret;
 }
 
+/* Handle-based I/O
+ *
+ * orangefs_open() resolves a path once and keeps the object ref, the
+ * attributes (including the distribution) and a copy of the credential
+ * in a descriptor table slot.  The orangefs_p* and orangefs_iio calls
+ * then go straight to PVFS_isys_io without a lookup per call.
+ */
+struct orangefs_open_file
+{
+    int in_use;
+    PVFS_object_ref ref;
+    OrangeFS_attr attr;
+    PVFS_credential *cred;
+};
+
+struct orangefs_io_op_s
+{
+    PVFS_sys_op_id op_id;
+    PVFS_Request mem_req;
+    PVFS_sysresp_io resp_io;
+    OrangeFS_fd fd;
+    enum ORANGEFS_io_type io_type;
+    uint64_t offset;
+    int done;
+    int error;
+};
+
+static struct orangefs_open_file open_files[ORANGEFS_OPEN_MAX];
+static gen_mutex_t open_files_mutex = GEN_MUTEX_INITIALIZER;
+
+static struct orangefs_open_file *get_open_file(OrangeFS_fd fd)
+{
+    if (fd < 0 || fd >= ORANGEFS_OPEN_MAX || !open_files[fd].in_use)
+        return NULL;
+
+    return &open_files[fd];
+}
+
+/* copies the ref and the credential out of the slot under
+   open_files_mutex, so the call using them does not hold the lock;
+   the caller releases *cred with put_open_file_cred() */
+static int get_open_file_ref(OrangeFS_fd fd, PVFS_object_ref *ref, PVFS_credential **cred)
+{
+    struct orangefs_open_file *file;
+
+    gen_mutex_lock(&open_files_mutex);
+    file = get_open_file(fd);
+    if (file == NULL)
+    {
+        gen_mutex_unlock(&open_files_mutex);
+        return -PVFS_EBADF;
+    }
+    *ref = file->ref;
+    *cred = PINT_dup_credential(file->cred);
+    gen_mutex_unlock(&open_files_mutex);
+
+    if (*cred == NULL)
+        return -PVFS_ENOMEM;
+
+    return 0;
+}
+
+static void put_open_file_cred(PVFS_credential *cred)
+{
+    PINT_cleanup_credential(cred);
+    free(cred);
+}
+
+int orangefs_open(OrangeFS_fsid *fs_id, OrangeFS_credential *cred, char *fs_path, OrangeFS_fd *fd)
+{
+    PVFS_sysresp_lookup resp_lookup;
+    OrangeFS_attr attr;
+    PVFS_credential *dup_cred;
+    int ret, i;
+
+    if (fs_path == NULL || strlen(fs_path) == 0 ||
+        fd == NULL || cred == NULL)
+        return -1;
+
+    /* lookup file - follow links; attributes are kept for the
+       life of the descriptor */
+    memset(&attr, 0, sizeof(attr));
+    ret = orangefs_lookup_follow_links(*fs_id, cred, fs_path, (OrangeFS_sysresp_lookup *) &resp_lookup, &attr);
+    if (ret != 0)
+        return ret;
+
+    dup_cred = PINT_dup_credential((PVFS_credential *) cred);
+    if (dup_cred == NULL)
+    {
+        PVFS_util_release_sys_attr((PVFS_sys_attr *) &attr);
+        return -PVFS_ENOMEM;
+    }
+
+    gen_mutex_lock(&open_files_mutex);
+    for (i = 0; i < ORANGEFS_OPEN_MAX; i++)
+    {
+        if (!open_files[i].in_use)
+            break;
+    }
+    if (i == ORANGEFS_OPEN_MAX)
+    {
+        gen_mutex_unlock(&open_files_mutex);
+        PINT_cleanup_credential(dup_cred);
+        free(dup_cred);
+        PVFS_util_release_sys_attr((PVFS_sys_attr *) &attr);
+        return -PVFS_EMFILE;
+    }
+    open_files[i].in_use = 1;
+    open_files[i].ref = resp_lookup.ref;
+    open_files[i].attr = attr;
+    open_files[i].cred = dup_cred;
+    gen_mutex_unlock(&open_files_mutex);
+
+    *fd = i;
+
+    return 0;
+}
+
+/* all I/O started on fd must be complete before it is closed */
+int orangefs_close(OrangeFS_fd fd)
+{
+    struct orangefs_open_file *file;
+
+    gen_mutex_lock(&open_files_mutex);
+    file = get_open_file(fd);
+    if (file == NULL)
+    {
+        gen_mutex_unlock(&open_files_mutex);
+        return -PVFS_EBADF;
+    }
+    PVFS_util_release_sys_attr((PVFS_sys_attr *) &file->attr);
+    PINT_cleanup_credential(file->cred);
+    free(file->cred);
+    memset(file, 0, sizeof(*file));
+    gen_mutex_unlock(&open_files_mutex);
+
+    return 0;
+}
+
+/* returns the attributes cached at open, with the size advanced by any
+   writes made through the descriptor; string fields are not returned */
+int orangefs_fgetattr(OrangeFS_fd fd, OrangeFS_attr *attr)
+{
+    struct orangefs_open_file *file;
+
+    if (attr == NULL)
+        return -1;
+
+    gen_mutex_lock(&open_files_mutex);
+    file = get_open_file(fd);
+    if (file == NULL)
+    {
+        gen_mutex_unlock(&open_files_mutex);
+        return -PVFS_EBADF;
+    }
+    memcpy(attr, &file->attr, sizeof(OrangeFS_attr));
+    gen_mutex_unlock(&open_files_mutex);
+
+    attr->link_target = NULL;
+    attr->dist_name = NULL;
+    attr->dist_params = NULL;
+
+    return 0;
+}
+
+int orangefs_fflush(OrangeFS_fd fd)
+{
+    PVFS_object_ref ref;
+    PVFS_credential *cred;
+    int ret;
+
+    ret = get_open_file_ref(fd, &ref, &cred);
+    if (ret != 0)
+        return ret;
+
+    ret = PVFS_sys_flush(ref, cred, NULL);
+    put_open_file_cred(cred);
+
+    return ret;
+}
+
+/* describe the iovec as one memory request relative to its lowest
+   address */
+static int iovec_to_request(OrangeFS_iovec *iov, int iovcnt, char **base, PVFS_Request *mem_req)
+{
+    int32_t *lengths;
+    PVFS_size *displacements;
+    char *lowest;
+    int ret, i;
+
+    if (iovcnt == 1)
+    {
+        *base = (char *) iov[0].base;
+        return PVFS_Request_contiguous((int32_t) iov[0].len, PVFS_BYTE, mem_req);
+    }
+
+    lengths = (int32_t *) malloc(iovcnt * sizeof(int32_t));
+    displacements = (PVFS_size *) malloc(iovcnt * sizeof(PVFS_size));
+    if (lengths == NULL || displacements == NULL)
+    {
+        free(lengths);
+        free(displacements);
+        return -PVFS_ENOMEM;
+    }
+
+    lowest = (char *) iov[0].base;
+    for (i = 1; i < iovcnt; i++)
+    {
+        if ((char *) iov[i].base < lowest)
+            lowest = (char *) iov[i].base;
+    }
+    for (i = 0; i < iovcnt; i++)
+    {
+        lengths[i] = (int32_t) iov[i].len;
+        displacements[i] = (char *) iov[i].base - lowest;
+    }
+
+    ret = PVFS_Request_hindexed(iovcnt, lengths, displacements, PVFS_BYTE, mem_req);
+    *base = lowest;
+
+    free(displacements);
+    free(lengths);
+
+    return ret;
+}
+
+static void io_op_complete(struct orangefs_io_op_s *io_op, int error)
+{
+    struct orangefs_open_file *file;
+    uint64_t end;
+
+    io_op->done = 1;
+    io_op->error = error;
+    PVFS_Request_free(&io_op->mem_req);
+
+    /* keep the cached size current for readers of orangefs_fgetattr */
+    if (error == 0 && io_op->io_type == ORANGEFS_IO_WRITE)
+    {
+        end = io_op->offset + io_op->resp_io.total_completed;
+        gen_mutex_lock(&open_files_mutex);
+        file = get_open_file(io_op->fd);
+        if (file != NULL && end > file->attr.size)
+            file->attr.size = end;
+        gen_mutex_unlock(&open_files_mutex);
+    }
+}
+
+int orangefs_iio(OrangeFS_fd fd, enum ORANGEFS_io_type io_type, OrangeFS_iovec *iov, int iovcnt, uint64_t offset, OrangeFS_io_op *op)
+{
+    struct orangefs_io_op_s *io_op;
+    PVFS_object_ref ref;
+    PVFS_credential *cred;
+    char *base;
+    int ret;
+
+    if (iov == NULL || iovcnt < 1 || op == NULL)
+        return -1;
+
+    ret = get_open_file_ref(fd, &ref, &cred);
+    if (ret != 0)
+        return ret;
+
+    io_op = (struct orangefs_io_op_s *) calloc(1, sizeof(*io_op));
+    if (io_op == NULL)
+    {
+        put_open_file_cred(cred);
+        return -PVFS_ENOMEM;
+    }
+    io_op->fd = fd;
+    io_op->io_type = io_type;
+    io_op->offset = offset;
+
+    ret = iovec_to_request(iov, iovcnt, &base, &io_op->mem_req);
+    if (ret != 0)
+    {
+        put_open_file_cred(cred);
+        free(io_op);
+        return ret;
+    }
+
+    /* the posted op keeps its own copy of the credential */
+    ret = PVFS_isys_io(ref, PVFS_BYTE, offset, base, io_op->mem_req, cred,
+                       &io_op->resp_io, (enum PVFS_io_type) io_type, &io_op->op_id,
+                       NULL, io_op);
+    put_open_file_cred(cred);
+    if (ret != 0)
+    {
+        PVFS_Request_free(&io_op->mem_req);
+        free(io_op);
+        return ret;
+    }
+
+    /* an op_id of -1 means the I/O ran to completion while posting */
+    if (io_op->op_id == -1)
+        io_op_complete(io_op, 0);
+
+    *op = (OrangeFS_io_op) io_op;
+
+    return 0;
+}
+
+/* sets *done when the I/O has finished; a finished op is freed and
+   its result returned, after which op must not be used again */
+int orangefs_io_test(OrangeFS_io_op op, int *done, OrangeFS_size *op_len)
+{
+    struct orangefs_io_op_s *io_op = (struct orangefs_io_op_s *) op;
+    PVFS_sys_op_id op_id;
+    void *user_ptr = NULL;
+    int count = 1, error = 0, ret;
+
+    if (io_op == NULL || done == NULL)
+        return -1;
+
+    if (!io_op->done)
+    {
+        op_id = io_op->op_id;
+        ret = PVFS_sys_testsome(&op_id, &count, &user_ptr, &error, 0);
+        if (ret != 0)
+            return ret;
+        if (count == 1)
+            io_op_complete(io_op, error);
+    }
+
+    *done = io_op->done;
+    if (!io_op->done)
+        return 0;
+
+    ret = io_op->error;
+    if (ret == 0 && op_len != NULL)
+        *op_len = io_op->resp_io.total_completed;
+    free(io_op);
+
+    return ret;
+}
+
+int orangefs_io_wait(OrangeFS_io_op op, OrangeFS_size *op_len)
+{
+    struct orangefs_io_op_s *io_op = (struct orangefs_io_op_s *) op;
+    PVFS_sys_op_id op_id;
+    void *user_ptr = NULL;
+    int count, error = 0, ret;
+
+    if (io_op == NULL)
+        return -1;
+
+    while (!io_op->done)
+    {
+        op_id = io_op->op_id;
+        count = 1;
+        ret = PVFS_sys_testsome(&op_id, &count, &user_ptr, &error, 10);
+        if (ret != 0)
+            return ret;
+        if (count == 1)
+            io_op_complete(io_op, error);
+    }
+
+    ret = io_op->error;
+    if (ret == 0 && op_len != NULL)
+        *op_len = io_op->resp_io.total_completed;
+    free(io_op);
+
+    return ret;
+}
+
+int orangefs_piov(OrangeFS_fd fd, enum ORANGEFS_io_type io_type, OrangeFS_iovec *iov, int iovcnt, uint64_t offset, OrangeFS_size *op_len)
+{
+    OrangeFS_io_op op;
+    int ret;
+
+    ret = orangefs_iio(fd, io_type, iov, iovcnt, offset, &op);
+    if (ret != 0)
+        return ret;
+
+    return orangefs_io_wait(op, op_len);
+}
+
+int orangefs_pio(OrangeFS_fd fd, enum ORANGEFS_io_type io_type, void *buffer, size_t buffer_len, uint64_t offset, OrangeFS_size *op_len)
+{
+    OrangeFS_iovec iov;
+
+    if (buffer == NULL)
+        return -1;
+
+    iov.base = buffer;
+    iov.len = buffer_len;
+
+    return orangefs_piov(fd, io_type, &iov, 1, offset, op_len);
+}
+
 int orangefs_find_files(OrangeFS_fsid *fs_id, OrangeFS_credential *cred, char *fs_path, OrangeFS_ds_position *token, int32_t incount, int32_t *outcount, char **filename_array, OrangeFS_attr *attr_array)
 {
     int ret, i;
@@ -275,7 +275,8 @@ typedef struct
     char *mnt_opts;		/**< full option list */
 }OrangeFS_mntent;
 
-/** Describes attributes for a file, directory, or symlink. */
+/** Describes attributes for a file, directory, or symlink; keeps the
+ *  layout of PVFS_sys_attr, which the library copies into it. */
 typedef struct 
 {
     OrangeFS_uid owner;
@@ -287,6 +288,9 @@ typedef struct
     OrangeFS_size size;
     ORANGEFS_ALIGN_VAR(char *, link_target);/**< NOTE: caller must free if valid */
     ORANGEFS_ALIGN_VAR(int32_t, dfile_count); /* Changed to int32_t so that size of structure does not change */
+    ORANGEFS_ALIGN_VAR(int32_t, distr_dir_servers_initial);
+    ORANGEFS_ALIGN_VAR(int32_t, distr_dir_servers_max);
+    ORANGEFS_ALIGN_VAR(int32_t, distr_dir_split_size);
     ORANGEFS_ALIGN_VAR(uint32_t, mirror_copies_count);
     ORANGEFS_ALIGN_VAR(char*, dist_name);   /**< NOTE: caller must free if valid */
     ORANGEFS_ALIGN_VAR(char*, dist_params); /**< NOTE: caller must free if valid */
@@ -297,6 +301,22 @@ typedef struct
     OrangeFS_size blksize;
 }OrangeFS_attr;
 
+/** Descriptor returned by orangefs_open() for handle-based I/O. */
+typedef int32_t OrangeFS_fd;
+
+/** Maximum number of descriptors open at once. */
+#define ORANGEFS_OPEN_MAX 1024
+
+/** One segment of a vectored read or write. */
+typedef struct
+{
+    void *base;
+    OrangeFS_size len;
+}OrangeFS_iovec;
+
+/** In-flight nonblocking I/O started by orangefs_iio(). */
+typedef void* OrangeFS_io_op;
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -316,6 +336,15 @@ int DLL_CODE orangefs_setattr(OrangeFS_fsid *fs_id, OrangeFS_credential *cred, c
 int DLL_CODE orangefs_mkdir(OrangeFS_fsid *fs_id, OrangeFS_credential *cred, char *fs_path, OrangeFS_handle *handle, unsigned perms);
 int DLL_CODE orangefs_io(OrangeFS_fsid *fs_id, OrangeFS_credential *cred, enum ORANGEFS_io_type io_type, char *fs_path, void *buffer, size_t buffer_len, uint64_t offset, OrangeFS_size *op_len);
 int DLL_CODE orangefs_flush(OrangeFS_fsid *fs_id, OrangeFS_credential *cred, char *fs_path);
+int DLL_CODE orangefs_open(OrangeFS_fsid *fs_id, OrangeFS_credential *cred, char *fs_path, OrangeFS_fd *fd);
+int DLL_CODE orangefs_close(OrangeFS_fd fd);
+int DLL_CODE orangefs_fgetattr(OrangeFS_fd fd, OrangeFS_attr *attr);
+int DLL_CODE orangefs_fflush(OrangeFS_fd fd);
+int DLL_CODE orangefs_pio(OrangeFS_fd fd, enum ORANGEFS_io_type io_type, void *buffer, size_t buffer_len, uint64_t offset, OrangeFS_size *op_len);
+int DLL_CODE orangefs_piov(OrangeFS_fd fd, enum ORANGEFS_io_type io_type, OrangeFS_iovec *iov, int iovcnt, uint64_t offset, OrangeFS_size *op_len);
+int DLL_CODE orangefs_iio(OrangeFS_fd fd, enum ORANGEFS_io_type io_type, OrangeFS_iovec *iov, int iovcnt, uint64_t offset, OrangeFS_io_op *op);
+int DLL_CODE orangefs_io_test(OrangeFS_io_op op, int *done, OrangeFS_size *op_len);
+int DLL_CODE orangefs_io_wait(OrangeFS_io_op op, OrangeFS_size *op_len);
 int DLL_CODE orangefs_find_files(OrangeFS_fsid *fs_id, OrangeFS_credential *cred, char *fs_path, OrangeFS_ds_position *token, int32_t incount, int32_t *outcount, char **filename_array, OrangeFS_attr *attr_array);
 int DLL_CODE orangefs_get_diskfreespace(OrangeFS_fsid *fs_id, OrangeFS_credential *cred, OrangeFS_size *free_bytes, OrangeFS_size *total_bytes);
 int DLL_CODE orangefs_finalize();
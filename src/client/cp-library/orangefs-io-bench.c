@@ -0,0 +1,202 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* Compares the path-based orangefs_io() call with the handle-based
+ * orangefs_pio() and pipelined orangefs_iio() calls for many small reads
+ * of one file.  The file is written first through the handle API.
+ *
+ * usage: orangefs-io-bench <tabfile> <fs path> <reads> <bytes> [depth]
+ */
+
+#ifdef WIN32
+#include <Windows.h>
+#else
+#include <sys/time.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "orangefs-client.h"
+
+static double wtime(void)
+{
+#ifdef WIN32
+    LARGE_INTEGER freq, count;
+
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (double) count.QuadPart / (double) freq.QuadPart;
+#else
+    struct timeval t;
+
+    gettimeofday(&t, NULL);
+    return (double) t.tv_sec + (double) t.tv_usec / 1000000;
+#endif
+}
+
+static void report(const char *name, int reads, int bytes, double elapsed)
+{
+    printf("%-28s %10.1f reads/sec %10.2f MB/sec\n", name,
+           reads / elapsed, (double) reads * bytes / elapsed / (1024 * 1024));
+}
+
+int main(int argc, char **argv)
+{
+    OrangeFS_fsid fsid = 0;
+    OrangeFS_credential cred;
+    OrangeFS_mntent mntent;
+    OrangeFS_handle handle;
+    OrangeFS_fd fd;
+    OrangeFS_size op_len;
+    OrangeFS_io_op *ops;
+    OrangeFS_iovec iov;
+    char error_msg[256];
+    char *path, *buffer;
+    int reads, bytes, depth = 8;
+    double start;
+    int ret, i, j;
+
+    if (argc < 5 || argc > 6)
+    {
+        fprintf(stderr, "usage: %s <tabfile> <fs path> <reads> <bytes> [depth]\n",
+                argv[0]);
+        return 1;
+    }
+    path = argv[2];
+    reads = atoi(argv[3]);
+    bytes = atoi(argv[4]);
+    if (argc == 6)
+        depth = atoi(argv[5]);
+    if (reads < 1 || bytes < 1 || depth < 1)
+    {
+        fprintf(stderr, "invalid arguments\n");
+        return 1;
+    }
+
+    buffer = (char *) malloc((size_t) bytes * depth);
+    ops = (OrangeFS_io_op *) malloc(depth * sizeof(OrangeFS_io_op));
+    if (buffer == NULL || ops == NULL)
+        return 1;
+    memset(buffer, 'a', (size_t) bytes * depth);
+
+    memset(&mntent, 0, sizeof(mntent));
+    ret = orangefs_initialize(&fsid, &cred, &mntent, error_msg,
+                              sizeof(error_msg), argv[1],
+                              OrangeFS_DEBUG_STDERR, NULL);
+    if (ret != 0)
+    {
+        fprintf(stderr, "orangefs_initialize failed: %s\n", error_msg);
+        return 1;
+    }
+    fsid = mntent.fs_id;
+
+    orangefs_credential_init(&cred);
+    orangefs_credential_set_user(&cred, 0);
+    orangefs_credential_add_group(&cred, 0);
+    orangefs_credential_set_timeout(&cred, ORANGEFS_DEFAULT_CREDENTIAL_TIMEOUT);
+
+    ret = orangefs_create(&fsid, &cred, path, OrangeFS_USER_ALL, &handle);
+    if (ret != 0)
+    {
+        fprintf(stderr, "orangefs_create failed: %d\n", ret);
+        return 1;
+    }
+
+    ret = orangefs_open(&fsid, &cred, path, &fd);
+    if (ret != 0)
+    {
+        fprintf(stderr, "orangefs_open failed: %d\n", ret);
+        return 1;
+    }
+
+    /* lay down the data being read back */
+    for (i = 0; i < reads; i += depth)
+    {
+        ret = orangefs_pio(fd, ORANGEFS_IO_WRITE, buffer, (size_t) bytes * depth,
+                           (uint64_t) i * bytes, &op_len);
+        if (ret != 0)
+        {
+            fprintf(stderr, "orangefs_pio write failed: %d\n", ret);
+            return 1;
+        }
+    }
+
+    printf("%d reads of %d bytes\n", reads, bytes);
+
+    start = wtime();
+    for (i = 0; i < reads; i++)
+    {
+        ret = orangefs_io(&fsid, &cred, ORANGEFS_IO_READ, path, buffer, bytes,
+                          (uint64_t) i * bytes, &op_len);
+        if (ret != 0)
+        {
+            fprintf(stderr, "orangefs_io failed: %d\n", ret);
+            return 1;
+        }
+    }
+    report("orangefs_io (by path)", reads, bytes, wtime() - start);
+
+    start = wtime();
+    for (i = 0; i < reads; i++)
+    {
+        ret = orangefs_pio(fd, ORANGEFS_IO_READ, buffer, bytes,
+                           (uint64_t) i * bytes, &op_len);
+        if (ret != 0)
+        {
+            fprintf(stderr, "orangefs_pio failed: %d\n", ret);
+            return 1;
+        }
+    }
+    report("orangefs_pio (by handle)", reads, bytes, wtime() - start);
+
+    start = wtime();
+    for (i = 0; i < reads; i += depth)
+    {
+        for (j = 0; j < depth && i + j < reads; j++)
+        {
+            iov.base = buffer + (size_t) j * bytes;
+            iov.len = bytes;
+            ret = orangefs_iio(fd, ORANGEFS_IO_READ, &iov, 1,
+                               (uint64_t) (i + j) * bytes, &ops[j]);
+            if (ret != 0)
+            {
+                fprintf(stderr, "orangefs_iio failed: %d\n", ret);
+                return 1;
+            }
+        }
+        while (j-- > 0)
+        {
+            ret = orangefs_io_wait(ops[j], &op_len);
+            if (ret != 0)
+            {
+                fprintf(stderr, "orangefs_io_wait failed: %d\n", ret);
+                return 1;
+            }
+        }
+    }
+    printf("depth %d:\n", depth);
+    report("orangefs_iio (pipelined)", reads, bytes, wtime() - start);
+
+    orangefs_close(fd);
+    orangefs_remove(&fsid, &cred, path);
+    orangefs_cleanup_credentials(&cred);
+    orangefs_finalize();
+
+    free(ops);
+    free(buffer);
+
+    return 0;
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
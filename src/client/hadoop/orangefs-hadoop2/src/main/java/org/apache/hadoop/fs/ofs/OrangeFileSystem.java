@@ -15,6 +15,7 @@ import java.util.EnumSet;
 import org.apache.commons.logging.Log;
 import org.apache.commons.logging.LogFactory;
 import org.apache.hadoop.conf.Configuration;
+import org.apache.hadoop.fs.BlockLocation;
 import org.apache.hadoop.fs.CreateFlag;
 import org.apache.hadoop.fs.FSDataInputStream;
 import org.apache.hadoop.fs.FSDataOutputStream;
@@ -283,6 +284,55 @@ public class OrangeFileSystem extends FileSystem {
         return true;
     }
 
+    /*
+     * Return one BlockLocation per block of the file in [start, start + len).
+     * The hosts of a block are the servers holding its strips, taken from the
+     * datafile handles and strip size of the file, so the scheduler can run
+     * tasks next to the data.
+     */
+    @Override
+    public BlockLocation[] getFileBlockLocations(FileStatus file, long start,
+            long len)
+            throws IOException {
+        OrangeFileSystemDistribution dist;
+        ArrayList<BlockLocation> locations;
+        long blockSize;
+        long offset;
+        long end;
+
+        if (file == null) {
+            return null;
+        }
+        if (start < 0 || len < 0) {
+            throw new IllegalArgumentException(
+                    "Invalid start or len parameter");
+        }
+        if (file.getLen() <= start) {
+            return new BlockLocation[0];
+        }
+        statistics.incrementReadOps(1);
+        dist = orange.posix.getDistribution(getOFSPathName(file.getPath()));
+        if (dist == null || dist.servers == null || dist.servers.length == 0) {
+            OFSLOG.debug("getDistribution(" + file.getPath()
+                    + ") failed, using default block locations");
+            return super.getFileBlockLocations(file, start, len);
+        }
+        OFSLOG.debug(dist.toString());
+        blockSize = file.getBlockSize();
+        if (blockSize <= 0) {
+            blockSize = ofsBlockSize;
+        }
+        end = Math.min(start + len, file.getLen());
+        locations = new ArrayList<BlockLocation>();
+        for (offset = (start / blockSize) * blockSize; offset < end;
+                offset += blockSize) {
+            long length = Math.min(blockSize, file.getLen() - offset);
+            String[] hosts = dist.getServers(offset, length);
+            locations.add(new BlockLocation(hosts, hosts, offset, length));
+        }
+        return locations.toArray(new BlockLocation[locations.size()]);
+    }
+
     /* Return a file status object that represents the path. */
     @Override
     public FileStatus getFileStatus(Path f)
@@ -7,16 +7,19 @@ package org.apache.hadoop.fs.ofs;
 
 import java.io.Closeable;
 import java.io.IOException;
+import java.nio.ByteBuffer;
 
 import org.apache.commons.logging.Log;
 import org.apache.commons.logging.LogFactory;
+import org.apache.hadoop.fs.ByteBufferReadable;
 import org.apache.hadoop.fs.FileSystem;
 import org.apache.hadoop.fs.PositionedReadable;
 import org.apache.hadoop.fs.Seekable;
 import org.orangefs.usrint.OrangeFileSystemInputStream;
 
 public class OrangeFileSystemFSInputStream extends OrangeFileSystemInputStream
-        implements Closeable, Seekable, PositionedReadable {
+        implements Closeable, Seekable, PositionedReadable,
+        ByteBufferReadable {
     private FileSystem.Statistics statistics;
     public static final Log OFSLOG = LogFactory
             .getLog(OrangeFileSystemFSInputStream.class);
@@ -91,14 +94,36 @@ public class OrangeFileSystemFSInputStream extends OrangeFileSystemInputStream
         return ret;
     }
 
-    /* This method has an implementation in abstract class FSInputStream */
+    /*
+     * ByteBufferReadable: a direct buffer is filled by the native layer with
+     * no intermediate copy.
+     */
+    @Override
+    public synchronized int read(ByteBuffer buf)
+            throws IOException {
+        statistics.incrementReadOps(1);
+        int ret = super.read(buf);
+        if (ret > 0) {
+            statistics.incrementBytesRead(ret);
+        }
+        return ret;
+    }
+
+    /*
+     * Positional reads use pread, so they neither move the stream position
+     * nor reset the readahead of sequential reads on the same stream.
+     */
     @Override
     public int read(long position, byte[] buffer, int offset, int length)
             throws IOException {
-        long oldPos = getPos();
-        seek(position);
-        int ret = read(buffer, offset, length);
-        seek(oldPos);
+        statistics.incrementReadOps(1);
+        if (length == 0) {
+            return 0;
+        }
+        int ret = super.read(position, buffer, offset, length);
+        if (ret > 0) {
+            statistics.incrementBytesRead(ret);
+        }
         return ret;
     }
 
@@ -106,26 +131,17 @@ public class OrangeFileSystemFSInputStream extends OrangeFileSystemInputStream
     @Override
     public void readFully(long position, byte[] buffer)
             throws IOException {
-        long oldPos = getPos();
-        seek(position);
-        int ret = read(buffer);
-        if (ret < buffer.length) {
-            throw new IOException("readFully read < buffer.length bytes.");
-        }
-        seek(oldPos);
+        readFully(position, buffer, 0, buffer.length);
     }
 
     /* This method has an implementation in abstract class FSInputStream */
     @Override
     public void readFully(long position, byte[] buffer, int offset, int length)
             throws IOException {
-        long oldPos = getPos();
-        seek(position);
-        int ret = read(buffer, offset, length);
+        int ret = read(position, buffer, offset, length);
         if (ret < length) {
             throw new IOException("readFully read < buffer.length bytes.");
         }
-        seek(oldPos);
     }
 
     /* *** This method declared abstract in FSInputStream *** */
@@ -1,6 +1,9 @@
 package org.apache.hadoop.hcfs.test.unit;
 
+import org.apache.hadoop.fs.BlockLocation;
+import org.apache.hadoop.fs.FSDataInputStream;
 import org.apache.hadoop.fs.FSDataOutputStream;
+import org.apache.hadoop.fs.FileStatus;
 import org.apache.hadoop.fs.FileSystem;
 import org.apache.hadoop.fs.Path;
 import org.apache.hadoop.fs.ofs.OrangeFileSystem;
@@ -11,6 +14,7 @@ import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
 
 import java.io.IOException;
+import java.nio.ByteBuffer;
 
 import static org.apache.hadoop.fs.FileSystemTestHelper.getTestRootPath;
 
@@ -21,6 +25,8 @@ import static org.apache.hadoop.fs.FileSystemTestHelper.getTestRootPath;
  * - Read buffering
  * - Object caching / File lookup caching.
  * - Seeking
+ * - Direct ByteBuffer and positional reads
+ * - Block locations
  */
 public class HCFSPerformanceIOTests {
     
@@ -88,4 +94,82 @@ public class HCFSPerformanceIOTests {
 
         os.close();
     }
+
+    /**
+     * Writes a file larger than the read buffer, so reads go through several
+     * readahead refills, then reads it back into a direct ByteBuffer and with
+     * positional reads, checking every byte.
+     */
+    @Test
+    public void testDirectByteBufferRead() throws Exception {
+        int size = 3 * OrangeFileSystem.DEFAULT_OFS_FILE_BUFFER_SIZE + 4321;
+        byte[] data = new byte[size];
+        for (int i = 0; i < size; i++) {
+            data[i] = (byte) (i % 251);
+        }
+        FSDataOutputStream os = fs.create(bufferoutpath());
+        os.write(data);
+        os.close();
+
+        FSDataInputStream is = fs.open(bufferoutpath());
+        ByteBuffer buf = ByteBuffer.allocateDirect(size);
+        int ret;
+        while (buf.hasRemaining() && (ret = is.read(buf)) > 0) {
+            Assert.assertTrue(ret <= size);
+        }
+        Assert.assertEquals("whole file read into direct buffer", size,
+                buf.position());
+        buf.flip();
+        for (int i = 0; i < size; i++) {
+            Assert.assertEquals("byte " + i, data[i], buf.get(i));
+        }
+        Assert.assertEquals(-1, is.read(ByteBuffer.allocateDirect(1)));
+
+        /* positional reads must not move the stream position */
+        is.seek(17);
+        byte[] chunk = new byte[4096];
+        long[] offsets = {0, size / 2, size - chunk.length};
+        for (long offset : offsets) {
+            is.readFully(offset, chunk);
+            for (int i = 0; i < chunk.length; i++) {
+                Assert.assertEquals(data[(int) offset + i], chunk[i]);
+            }
+        }
+        Assert.assertEquals(17, is.getPos());
+        Assert.assertEquals(data[17], (byte) is.read());
+        is.close();
+    }
+
+    /**
+     * Block locations must cover the requested range with contiguous blocks
+     * and name at least one server for every block.
+     */
+    @Test
+    public void testFileBlockLocations() throws Exception {
+        int size = 2 * OrangeFileSystem.DEFAULT_OFS_FILE_BUFFER_SIZE;
+        FSDataOutputStream os = fs.create(bufferoutpath());
+        os.write(new byte[size]);
+        os.close();
+
+        FileStatus status = fs.getFileStatus(bufferoutpath());
+        BlockLocation[] locations = fs.getFileBlockLocations(status, 0, size);
+        Assert.assertNotNull(locations);
+        Assert.assertTrue(locations.length > 0);
+        long expected = 0;
+        for (BlockLocation location : locations) {
+            log.info(location.toString());
+            Assert.assertEquals(expected, location.getOffset());
+            Assert.assertTrue(location.getLength() > 0);
+            Assert.assertTrue(location.getHosts().length > 0);
+            for (String host : location.getHosts()) {
+                Assert.assertFalse(host.isEmpty());
+            }
+            expected += location.getLength();
+        }
+        Assert.assertEquals(size, expected);
+
+        /* a range past EOF has no blocks */
+        Assert.assertEquals(0,
+                fs.getFileBlockLocations(status, size, 10).length);
+    }
 }
@@ -8,8 +8,10 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <pvfs2-hint.h>
+#include <pvfs2-mgmt.h>
 #include <pvfs2-types.h>
 #include <pvfs2-usrint.h>
+#include <pvfs2-util.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -26,10 +28,15 @@
 #include <sys/xattr.h>
 #include <unistd.h>
 #include <utime.h>
+#include <usrint.h>
+#include <openfile-util.h>
+#include <iocommon.h>
 #include "org_orangefs_usrint_PVFS2POSIXJNI.h"
 
 /* Forward Declarations */
 static int fill_stat(JNIEnv *env, struct stat *ptr, jobject *inst);
+static int fill_distribution(JNIEnv *env, PVFS_fs_id fs_id,
+        PVFS_sys_attr *attr, PVFS_handle *dfile_array, jobject *inst);
 //static int fill_statfs(JNIEnv *env, struct statfs *ptr, jobject *inst);
 
 /* Convert allocated struct to an instance of our Stat Class */
@@ -134,6 +141,101 @@ static int fill_statfs(JNIEnv *env, struct statfs *ptr, jobject *inst)
     return 0;
 }
 
+/* Convert the attributes and datafile handles of a file to an instance of
+ * our OrangeFileSystemDistribution Class.  Server addresses are reduced to
+ * their host names so they can be compared with the hosts of a cluster.
+ */
+static int fill_distribution(JNIEnv *env, PVFS_fs_id fs_id,
+        PVFS_sys_attr *attr, PVFS_handle *dfile_array, jobject *inst)
+{
+    char *cls_name = "org/orangefs/usrint/OrangeFileSystemDistribution";
+    jclass cls;
+    jclass str_cls;
+    jfieldID strip_fid, size_fid, servers_fid;
+    jobjectArray servers;
+    PVFS_BMI_addr_t addr;
+    const char *server;
+    char host[PVFS_MAX_SERVER_ADDR_LEN];
+    char *ptr;
+    int server_type;
+    int i;
+
+    cls = (*env)->FindClass(env, cls_name);
+    str_cls = (*env)->FindClass(env, "java/lang/String");
+    if (!cls || !str_cls)
+    {
+        JNI_ERROR("invalid class: %s\n", cls_name);
+        return -1;
+    }
+    strip_fid = (*env)->GetFieldID(env, cls, "stripSize", "J");
+    size_fid = (*env)->GetFieldID(env, cls, "fileSize", "J");
+    servers_fid = (*env)->GetFieldID(env, cls, "servers",
+            "[Ljava/lang/String;");
+    if (!strip_fid || !size_fid || !servers_fid)
+    {
+        JNI_ERROR("invalid field requested in %s\n", cls_name);
+        return -1;
+    }
+    servers = (*env)->NewObjectArray(env, attr->dfile_count, str_cls, NULL);
+    if (!servers)
+    {
+        return -1;
+    }
+    for (i = 0; i < attr->dfile_count; i++)
+    {
+        host[0] = '\0';
+        if (PVFS_mgmt_map_handle(fs_id, dfile_array[i], &addr) == 0 &&
+            (server = PVFS_mgmt_map_addr(fs_id, addr, &server_type)) != NULL)
+        {
+            /* tcp://host:port[,...] -> host */
+            ptr = strstr(server, "://");
+            strncpy(host, ptr ? ptr + 3 : server, sizeof(host) - 1);
+            host[sizeof(host) - 1] = '\0';
+            host[strcspn(host, ":,")] = '\0';
+        }
+        (*env)->SetObjectArrayElement(env, servers, i,
+                (*env)->NewStringUTF(env, host));
+    }
+    *inst = (*env)->AllocObject(env, cls);
+    /* for the simple stripe distribution blksize covers one full stripe */
+    (*env)->SetLongField(env, *inst, strip_fid,
+            attr->blksize / attr->dfile_count);
+    (*env)->SetLongField(env, *inst, size_fid, attr->size);
+    (*env)->SetObjectField(env, *inst, servers_fid, servers);
+    return 0;
+}
+
+/* allocAlignedBuffer
+ * Returns a direct ByteBuffer over memory aligned to alignment bytes, so the
+ * client can hand it to the system interface without copying.  The memory
+ * is not owned by the JVM and must be returned with freeAlignedBuffer.
+ */
+JNIEXPORT jobject JNICALL
+Java_org_orangefs_usrint_PVFS2POSIXJNI_allocAlignedBuffer(JNIEnv *env,
+        jobject obj, jlong alignment, jlong size)
+{
+    JNI_PFI();
+    void *buf_addr = NULL;
+    jobject buf;
+    JNI_PRINT("\talignment = %ld\n\tsize = %ld\n", (int64_t) alignment,
+            (int64_t) size);
+    if (size <= 0 || posix_memalign(&buf_addr, (size_t) alignment,
+            (size_t) size) != 0)
+    {
+        JNI_ERROR("posix_memalign failed: alignment = %ld, size = %ld\n",
+                (int64_t) alignment, (int64_t) size);
+        return NULL_JOBJECT;
+    }
+    buf = (*env)->NewDirectByteBuffer(env, buf_addr, size);
+    if (!buf)
+    {
+        JNI_ERROR("NewDirectByteBuffer failed\n");
+        free(buf_addr);
+        return NULL_JOBJECT;
+    }
+    return buf;
+}
+
 /* access */
 JNIEXPORT jint JNICALL
 Java_org_orangefs_usrint_PVFS2POSIXJNI_access(JNIEnv *env, jobject obj,
@@ -589,6 +691,19 @@ Java_org_orangefs_usrint_PVFS2POSIXJNI_flock(JNIEnv *env, jobject obj, int fd,
     return ret;
 }
 
+/* freeAlignedBuffer */
+JNIEXPORT void JNICALL
+Java_org_orangefs_usrint_PVFS2POSIXJNI_freeAlignedBuffer(JNIEnv *env,
+        jobject obj, jobject buf)
+{
+    JNI_PFI();
+    void *buf_addr = (*env)->GetDirectBufferAddress(env, buf);
+    if (buf_addr)
+    {
+        free(buf_addr);
+    }
+}
+
 /* fremovexattr */
 JNIEXPORT jint JNICALL
 Java_org_orangefs_usrint_PVFS2POSIXJNI_fremovexattr(JNIEnv *env, jobject obj,
@@ -789,6 +904,78 @@ Java_org_orangefs_usrint_PVFS2POSIXJNI_futimesat(JNIEnv *env, jobject obj,
     return 0;
 }
 
+/* getDistribution
+ * Describes how the data of an OrangeFS file is striped: the strip size
+ * and, in strip order, the host of the server holding each datafile.
+ */
+JNIEXPORT jobject JNICALL
+Java_org_orangefs_usrint_PVFS2POSIXJNI_getDistribution(JNIEnv *env,
+        jobject obj, jstring path)
+{
+    JNI_PFI();
+    int fd;
+    int ret;
+    pvfs_descriptor *pd;
+    PVFS_credential *cred;
+    PVFS_sysresp_getattr resp;
+    PVFS_handle *dfile_array = NULL;
+    jobject dist_obj = NULL_JOBJECT;
+    int cpath_len = (*env)->GetStringLength(env, path);
+    char cpath[cpath_len + 1];
+    (*env)->GetStringUTFRegion(env, path, 0, cpath_len, cpath);
+    JNI_PRINT("\tpath = %s\n", cpath);
+    fd = open(cpath, O_RDONLY);
+    if (fd < 0)
+    {
+        JNI_PERROR();
+        return NULL_JOBJECT;
+    }
+    pd = pvfs_find_descriptor(fd);
+    if (!pd || pd->is_in_use != PVFS_FS || !pd->s)
+    {
+        JNI_ERROR("%s is not an OrangeFS file\n", cpath);
+        close(fd);
+        return NULL_JOBJECT;
+    }
+    if (iocommon_cred(&cred) != 0)
+    {
+        JNI_ERROR("could not get a credential\n");
+        close(fd);
+        return NULL_JOBJECT;
+    }
+    memset(&resp, 0, sizeof(resp));
+    ret = PVFS_sys_getattr(pd->s->pvfs_ref, PVFS_ATTR_SYS_ALL_NOHINT, cred,
+            &resp, NULL);
+    if (ret < 0)
+    {
+        JNI_ERROR("PVFS_sys_getattr failed: %d\n", ret);
+        close(fd);
+        return NULL_JOBJECT;
+    }
+    if (resp.attr.dfile_count > 0)
+    {
+        dfile_array = calloc(resp.attr.dfile_count, sizeof(PVFS_handle));
+        if (dfile_array)
+        {
+            ret = PVFS_mgmt_get_dfile_array(pd->s->pvfs_ref, cred,
+                    dfile_array, resp.attr.dfile_count, NULL);
+            if (ret < 0)
+            {
+                JNI_ERROR("PVFS_mgmt_get_dfile_array failed: %d\n", ret);
+            }
+            else if (fill_distribution(env, pd->s->pvfs_ref.fs_id,
+                    &resp.attr, dfile_array, &dist_obj) != 0)
+            {
+                dist_obj = NULL_JOBJECT;
+            }
+            free(dfile_array);
+        }
+    }
+    PVFS_util_release_sys_attr(&resp.attr);
+    close(fd);
+    return dist_obj;
+}
+
 /* getdtablesize */
 JNIEXPORT jint JNICALL
 Java_org_orangefs_usrint_PVFS2POSIXJNI_getdtablesize(JNIEnv *env, jobject obj)
@@ -1235,19 +1422,53 @@ Java_org_orangefs_usrint_PVFS2POSIXJNI_openat(JNIEnv *env, jobject obj,
 /* pread */
 JNIEXPORT jlong JNICALL
 Java_org_orangefs_usrint_PVFS2POSIXJNI_pread(JNIEnv *env, jobject obj, int fd,
-        jbyteArray buf, jlong count, jlong offset)
+        jobject buf, jlong count, jlong offset)
 {
-    /* TODO */
-    return -1;
+    JNI_PFI();
+    jlong ret = 0;
+    void * buf_addr = 0;
+    JNI_PRINT("\tfd = %d\n\tcount = %lu\n\toffset = %ld\n", fd,
+            (uint64_t) count, (int64_t) offset);
+    buf_addr = (*env)->GetDirectBufferAddress(env, buf);
+    if (!buf_addr)
+    {
+        JNI_ERROR("buf_addr returned by GetDirectBufferAddress is NULL\n");
+        ret = -1;
+        return ret;
+    }
+    ret = (jlong) pread(fd, buf_addr, (size_t) count, (off_t) offset);
+    if (ret < 0)
+    {
+        JNI_PERROR();
+        ret = -1;
+    }
+    return ret;
 }
 
 /* pwrite */
 JNIEXPORT jlong JNICALL
 Java_org_orangefs_usrint_PVFS2POSIXJNI_pwrite(JNIEnv *env, jobject obj, int fd,
-        jbyteArray buf, jlong count, jlong offset)
+        jobject buf, jlong count, jlong offset)
 {
-    /* TODO */
-    return -1;
+    JNI_PFI();
+    jlong ret = 0;
+    void * buf_addr = 0;
+    JNI_PRINT("\tfd = %d\n\tcount = %lu\n\toffset = %ld\n", fd,
+            (uint64_t) count, (int64_t) offset);
+    buf_addr = (*env)->GetDirectBufferAddress(env, buf);
+    if (!buf_addr)
+    {
+        JNI_ERROR("buf_addr returned by GetDirectBufferAddress is NULL\n");
+        ret = -1;
+        return ret;
+    }
+    ret = (jlong) pwrite(fd, buf_addr, (size_t) count, (off_t) offset);
+    if (ret < 0)
+    {
+        JNI_PERROR();
+        ret = -1;
+    }
+    return ret;
 }
 
 /*
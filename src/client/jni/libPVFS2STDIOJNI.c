@@ -629,6 +629,29 @@ Java_org_orangefs_usrint_PVFS2STDIOJNI_fread(JNIEnv *env, jobject obj,
     return ret;
 }
 
+/* freadDirect */
+JNIEXPORT jlong JNICALL
+Java_org_orangefs_usrint_PVFS2STDIOJNI_freadDirect(JNIEnv *env, jobject obj,
+        jobject ptr, jlong size, jlong nmemb, jlong stream)
+{
+    JNI_PFI();
+    jlong ret = 0;
+    void * buf_addr = 0;
+    JNI_PRINT("size = %llu\nnmemb = %llu\nstream = %llu\n",
+            (long long unsigned int ) size, (long long unsigned int ) nmemb,
+            (long long unsigned int ) stream);
+    buf_addr = (*env)->GetDirectBufferAddress(env, ptr);
+    if (!buf_addr)
+    {
+        JNI_ERROR("buf_addr returned by GetDirectBufferAddress is NULL\n");
+        return ret;
+    }
+    ret = (jlong) fread(buf_addr, (size_t) size, (size_t) nmemb,
+            (FILE *) stream);
+    JNI_PRINT("\tfread %llu items\n", (long long unsigned int ) ret);
+    return ret;
+}
+
 /* fread_unlocked */
 JNIEXPORT jlong JNICALL
 Java_org_orangefs_usrint_PVFS2STDIOJNI_freadUnlocked(JNIEnv *env, jobject obj,
@@ -800,6 +823,29 @@ Java_org_orangefs_usrint_PVFS2STDIOJNI_fwrite(JNIEnv *env, jobject obj,
     return ret;
 }
 
+/* fwriteDirect */
+JNIEXPORT jlong JNICALL
+Java_org_orangefs_usrint_PVFS2STDIOJNI_fwriteDirect(JNIEnv *env, jobject obj,
+        jobject ptr, jlong size, jlong nmemb, jlong stream)
+{
+    JNI_PFI();
+    jlong ret = 0;
+    void * buf_addr = 0;
+    JNI_PRINT("size = %llu\nnmemb = %llu\nstream = %llu\n",
+            (long long unsigned int ) size, (long long unsigned int ) nmemb,
+            (long long unsigned int ) stream);
+    buf_addr = (*env)->GetDirectBufferAddress(env, ptr);
+    if (!buf_addr)
+    {
+        JNI_ERROR("buf_addr returned by GetDirectBufferAddress is NULL\n");
+        return ret;
+    }
+    ret = (jlong) fwrite(buf_addr, (size_t) size, (size_t) nmemb,
+            (FILE *) stream);
+    JNI_PRINT("\tfwrite %llu items\n", (long long unsigned int ) ret);
+    return ret;
+}
+
 /* fwrite_unlocked */
 JNIEXPORT jlong JNICALL
 Java_org_orangefs_usrint_PVFS2STDIOJNI_fwriteUnlocked(JNIEnv *env, jobject obj,
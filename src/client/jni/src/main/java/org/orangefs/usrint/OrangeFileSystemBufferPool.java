@@ -0,0 +1,127 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See LICENSE in src/client/jni directory.
+ */
+package org.orangefs.usrint;
+
+import org.apache.commons.logging.Log;
+import org.apache.commons.logging.LogFactory;
+
+import java.nio.ByteBuffer;
+import java.util.ArrayDeque;
+
+/*
+ * Process wide pool of page aligned native buffers used by the channels.
+ * Buffers come from PVFS2POSIXJNI.allocAlignedBuffer, so they are never
+ * moved or copied by the JVM and are handed straight to the system
+ * interface. Sizes are rounded up to a power of two and each size class
+ * keeps at most MAX_PER_CLASS free buffers; anything beyond that, or larger
+ * than MAX_POOLED_SIZE, goes back to native memory on release.
+ */
+public class OrangeFileSystemBufferPool {
+    public static final int ALIGNMENT = 4096;
+    public static final int MIN_POOLED_SIZE = 4096;
+    public static final int MAX_POOLED_SIZE = 64 * 1024 * 1024;
+    public static final int MAX_PER_CLASS = 8;
+    private static final int NUM_CLASSES = Integer
+            .numberOfTrailingZeros(MAX_POOLED_SIZE)
+            - Integer.numberOfTrailingZeros(MIN_POOLED_SIZE) + 1;
+    private static final Log OFSLOG = LogFactory
+            .getLog(OrangeFileSystemBufferPool.class);
+
+    private static class PoolHolder {
+        public static final OrangeFileSystemBufferPool INSTANCE =
+                new OrangeFileSystemBufferPool();
+    }
+
+    private Orange orange;
+    private ArrayDeque<ByteBuffer>[] free;
+    /* statistics */
+    private long allocated;
+    private long reused;
+
+    public static OrangeFileSystemBufferPool getInstance() {
+        return PoolHolder.INSTANCE;
+    }
+
+    @SuppressWarnings("unchecked")
+    private OrangeFileSystemBufferPool() {
+        orange = Orange.getInstance();
+        free = new ArrayDeque[NUM_CLASSES];
+        for (int i = 0; i < NUM_CLASSES; i++) {
+            free[i] = new ArrayDeque<ByteBuffer>();
+        }
+    }
+
+    /* Returns the size class index of size, or -1 if it isn't pooled. */
+    private static int sizeClass(int size) {
+        if (size > MAX_POOLED_SIZE) {
+            return -1;
+        }
+        if (size <= MIN_POOLED_SIZE) {
+            return 0;
+        }
+        return 32 - Integer.numberOfLeadingZeros(size - 1)
+                - Integer.numberOfTrailingZeros(MIN_POOLED_SIZE);
+    }
+
+    /*
+     * Returns a cleared direct buffer with a limit of size bytes. The
+     * capacity may be larger.
+     */
+    public ByteBuffer acquire(int size) {
+        int index = sizeClass(size);
+        ByteBuffer buf = null;
+        if (index >= 0) {
+            synchronized (this) {
+                buf = free[index].pollFirst();
+                if (buf != null) {
+                    reused++;
+                }
+            }
+        }
+        if (buf == null) {
+            int capacity = index >= 0 ? MIN_POOLED_SIZE << index : size;
+            buf = orange.posix.allocAlignedBuffer(ALIGNMENT, capacity);
+            if (buf == null) {
+                OFSLOG.error("allocAlignedBuffer failed, size = " + capacity);
+                throw new OutOfMemoryError("allocAlignedBuffer failed");
+            }
+            synchronized (this) {
+                allocated++;
+            }
+        }
+        buf.clear();
+        buf.limit(size);
+        return buf;
+    }
+
+    /* Returns a buffer obtained from acquire to the pool. */
+    public void release(ByteBuffer buf) {
+        if (buf == null) {
+            return;
+        }
+        int capacity = buf.capacity();
+        int index = sizeClass(capacity);
+        if (index >= 0 && capacity == MIN_POOLED_SIZE << index) {
+            synchronized (this) {
+                if (free[index].size() < MAX_PER_CLASS) {
+                    free[index].addFirst(buf);
+                    return;
+                }
+            }
+        }
+        orange.posix.freeAlignedBuffer(buf);
+    }
+
+    /* Number of buffers that had to be allocated from native memory. */
+    public synchronized long getAllocated() {
+        return allocated;
+    }
+
+    /* Number of acquires satisfied from the pool. */
+    public synchronized long getReused() {
+        return reused;
+    }
+}
@@ -0,0 +1,74 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See LICENSE in src/client/jni directory.
+ */
+package org.orangefs.usrint;
+
+import java.lang.reflect.Field;
+import java.util.LinkedHashSet;
+
+/*
+ * How the data of an OrangeFS file is spread over its servers. Strip i of
+ * the file (bytes i * stripSize up to (i + 1) * stripSize) lives on
+ * servers[i % servers.length].
+ */
+public class OrangeFileSystemDistribution {
+    public long stripSize;
+    public long fileSize;
+    public String[] servers;
+
+    /* Initialized by PVFS2POSIXJNI.getDistribution. */
+    OrangeFileSystemDistribution() {}
+
+    /* Host of the server holding the byte at offset. */
+    public String getServer(long offset) {
+        if (servers == null || servers.length == 0 || stripSize <= 0) {
+            return null;
+        }
+        return servers[(int) ((offset / stripSize) % servers.length)];
+    }
+
+    /*
+     * Distinct hosts holding the bytes in [offset, offset + length), in
+     * strip order.
+     */
+    public String[] getServers(long offset, long length) {
+        LinkedHashSet<String> hosts = new LinkedHashSet<String>();
+        if (servers == null || servers.length == 0 || stripSize <= 0
+                || length <= 0) {
+            return new String[0];
+        }
+        long first = offset / stripSize;
+        long last = (offset + length - 1) / stripSize;
+        for (long strip = first; strip <= last
+                && hosts.size() < servers.length; strip++) {
+            hosts.add(servers[(int) (strip % servers.length)]);
+        }
+        return hosts.toArray(new String[hosts.size()]);
+    }
+
+    /* Generic Object Dump to String */
+    @Override
+    public String toString() {
+        StringBuilder result = new StringBuilder();
+        String newLine = System.getProperty("line.separator");
+        result.append(this.getClass().getName());
+        result.append(" Object {");
+        result.append(newLine);
+        Field[] fields = this.getClass().getDeclaredFields();
+        for (Field field : fields) {
+            result.append("  ");
+            try {
+                result.append(field.getName());
+                result.append(": ");
+                result.append(field.get(this));
+            } catch (IllegalAccessException ex) {
+                System.out.println(ex);
+            }
+            result.append(newLine);
+        }
+        result.append("}");
+        return result.toString();
+    }
+}
@@ -12,25 +12,46 @@ import java.io.IOException;
 import java.nio.ByteBuffer;
 import java.nio.channels.ReadableByteChannel;
 
-/* Seekable OrangeFS channel for reading bytes. */
+/*
+ * Seekable OrangeFS channel for reading bytes.
+ *
+ * The channel buffer comes from OrangeFileSystemBufferPool. While the file
+ * is read sequentially each refill doubles the amount read, from bufferSize
+ * up to readaheadMax, so large scans are served by few large requests that
+ * span several strips; a seek drops back to bufferSize. Reads into a direct
+ * ByteBuffer at least as large as the next refill bypass the channel buffer.
+ */
 public class OrangeFileSystemInputChannel implements ReadableByteChannel {
+    /* Default readaheadMax as a multiple of bufferSize */
+    public static final int DEFAULT_READAHEAD_FACTOR = 4;
     /* Interface Related Fields */
     private Orange orange;
     private PVFS2POSIXJNIFlags pf;
+    private OrangeFileSystemBufferPool pool;
     /* Channel Related Fields */
     private int fd;
     private int bufferSize;
+    private int readSize;
+    private int readaheadMax;
     private ByteBuffer channelBuffer;
     /* OFSLOG for logging */
     public static final Log OFSLOG = LogFactory
             .getLog(OrangeFileSystemInputChannel.class);
 
     public OrangeFileSystemInputChannel(int fd, int bufferSize) {
+        this(fd, bufferSize, bufferSize * DEFAULT_READAHEAD_FACTOR);
+    }
+
+    public OrangeFileSystemInputChannel(int fd, int bufferSize,
+            int readaheadMax) {
         this.orange = Orange.getInstance();
         pf = orange.posix.f;
+        pool = OrangeFileSystemBufferPool.getInstance();
         this.fd = fd;
         this.bufferSize = bufferSize;
-        channelBuffer = ByteBuffer.allocateDirect(bufferSize);
+        this.readSize = bufferSize;
+        this.readaheadMax = Math.max(bufferSize, readaheadMax);
+        channelBuffer = pool.acquire(bufferSize);
         channelBuffer.flip();
     }
 
@@ -46,7 +67,7 @@ public class OrangeFileSystemInputChannel implements ReadableByteChannel {
         }
         fd = -1;
         pf = null;
-        channelBuffer.clear();
+        pool.release(channelBuffer);
         channelBuffer = null;
     }
 
@@ -62,6 +83,7 @@ public class OrangeFileSystemInputChannel implements ReadableByteChannel {
                 orange = null;
                 fd = -1;
                 pf = null;
+                pool.release(channelBuffer);
                 channelBuffer = null;
             }
         } finally {
@@ -90,6 +112,19 @@ public class OrangeFileSystemInputChannel implements ReadableByteChannel {
         /* Put bytes from channelBuffer into dst */
         while (dst.hasRemaining()) {
             dstRemaining = dst.remaining();
+            /* Read large requests for direct buffers straight into dst */
+            if (!channelBuffer.hasRemaining() && dst.isDirect()
+                    && dstRemaining >= readSize) {
+                long ret = orange.posix.read(fd, dst.slice(), dstRemaining);
+                if (ret < 0) {
+                    throw new IOException("orange.posix.read failed.");
+                }
+                if (ret == 0) {
+                    break;
+                }
+                dst.position(dst.position() + (int) ret);
+                continue;
+            }
             /* Read from OrangeFS if channelBuffer is empty */
             if (!channelBuffer.hasRemaining()) {
                 /* clear buffer then readOFS */
@@ -173,6 +208,59 @@ public class OrangeFileSystemInputChannel implements ReadableByteChannel {
         }
     }
 
+    /*
+     * Reads into dst starting at position in the file, without moving the
+     * file offset or disturbing the channel buffer. Returns the number of
+     * bytes read, or -1 at EOF.
+     */
+    public int pread(ByteBuffer dst, long position)
+            throws IOException {
+        int fd = this.fd;
+        if (fd < 0) {
+            throw new IOException("file descriptor isn't open.");
+        }
+        int initialDstRemaining = dst.remaining();
+        ByteBuffer buf = dst;
+        if (!dst.isDirect()) {
+            buf = pool.acquire(Math.min(initialDstRemaining, readaheadMax));
+        }
+        try {
+            while (dst.hasRemaining()) {
+                ByteBuffer target = buf;
+                if (buf == dst) {
+                    target = dst.slice();
+                } else {
+                    buf.clear();
+                    buf.limit(Math.min(buf.limit(), dst.remaining()));
+                }
+                long ret = orange.posix.pread(fd, target, target.remaining(),
+                        position);
+                if (ret < 0) {
+                    throw new IOException("orange.posix.pread failed.");
+                }
+                if (ret == 0) {
+                    break;
+                }
+                if (buf == dst) {
+                    dst.position(dst.position() + (int) ret);
+                } else {
+                    buf.limit((int) ret);
+                    dst.put(buf);
+                }
+                position += ret;
+            }
+        } finally {
+            if (buf != dst) {
+                pool.release(buf);
+            }
+        }
+        int bytesRead = initialDstRemaining - dst.remaining();
+        if (initialDstRemaining == 0 || bytesRead > 0) {
+            return bytesRead;
+        }
+        return -1;
+    }
+
     /*
      * When this method is called, the position should equal 0, and the limit
      * should equal the capacity, via clear().
@@ -182,13 +270,23 @@ public class OrangeFileSystemInputChannel implements ReadableByteChannel {
         if (fd < 0) {
             throw new IOException("file descriptor isn't open.");
         }
-        /* Attempt read of bufferSize bytes from OrangeFS into channelBuffer. */
-        long ret = orange.posix.read(fd, channelBuffer, bufferSize);
+        /* Grow the channel buffer to the readahead size if needed. */
+        if (channelBuffer.capacity() < readSize) {
+            pool.release(channelBuffer);
+            channelBuffer = pool.acquire(readSize);
+        }
+        channelBuffer.clear();
+        /* Attempt read of readSize bytes from OrangeFS into channelBuffer. */
+        long ret = orange.posix.read(fd, channelBuffer, readSize);
         if (ret < 0) {
             throw new IOException("orange.posix.read failed.");
         }
         /* Set the position to the number of bytes read. */
         channelBuffer.position((int) ret);
+        /* Still sequential: read further ahead next time. */
+        if (ret == readSize && readSize < readaheadMax) {
+            readSize = (int) Math.min((long) readSize * 2, readaheadMax);
+        }
     }
 
     public synchronized void seek(long pos)
@@ -196,8 +294,9 @@ public class OrangeFileSystemInputChannel implements ReadableByteChannel {
         if (fd < 0) {
             throw new IOException("file descriptor isn't open.");
         }
-        /* Reset the channelBuffer since we are seeking */
+        /* Reset the channelBuffer and readahead since we are seeking */
         channelBuffer.position(0).limit(0);
+        readSize = bufferSize;
         long ret = orange.posix.lseek(fd, pos, pf.SEEK_SET);
         if (ret < 0 || ret != pos) {
             throw new IOException("seek error:" + " pos = " + pos + ", ret = "
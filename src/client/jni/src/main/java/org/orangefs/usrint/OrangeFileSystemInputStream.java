@@ -114,6 +114,39 @@ public class OrangeFileSystemInputStream extends InputStream implements
         return ret;
     }
 
+    /* Read into buf, which may be direct, at the current position. */
+    public synchronized int read(ByteBuffer buf)
+            throws IOException {
+        if (inChannel == null) {
+            throw new IOException("InputChannel is null.");
+        }
+        if (!buf.hasRemaining()) {
+            return 0;
+        }
+        return inChannel.read(buf);
+    }
+
+    /*
+     * Positional read: fills buf from position in the file without moving
+     * the stream position, so it need not be synchronized with other reads.
+     */
+    public int read(long position, ByteBuffer buf)
+            throws IOException {
+        OrangeFileSystemInputChannel channel = inChannel;
+        if (channel == null) {
+            throw new IOException("InputChannel is null.");
+        }
+        if (!buf.hasRemaining()) {
+            return 0;
+        }
+        return channel.pread(buf, position);
+    }
+
+    public int read(long position, byte[] b, int off, int len)
+            throws IOException {
+        return read(position, ByteBuffer.wrap(b, off, len));
+    }
+
     @Override
     public void reset()
             throws IOException {
@@ -12,10 +12,16 @@ import java.io.IOException;
 import java.nio.ByteBuffer;
 import java.nio.channels.WritableByteChannel;
 
+/*
+ * OrangeFS channel for writing bytes. The channel buffer comes from
+ * OrangeFileSystemBufferPool, and writes from a direct ByteBuffer that would
+ * fill the channel buffer on their own go straight to the file system.
+ */
 public class OrangeFileSystemOutputChannel implements WritableByteChannel {
     /* Interface Related Fields */
     private Orange orange;
     private PVFS2POSIXJNIFlags pf;
+    private OrangeFileSystemBufferPool pool;
     /* Channel Related Fields */
     private int fd;
     private ByteBuffer channelBuffer;
@@ -26,8 +32,9 @@ public class OrangeFileSystemOutputChannel implements WritableByteChannel {
     public OrangeFileSystemOutputChannel(int fd, int bufferSize) {
         this.orange = Orange.getInstance();
         pf = orange.posix.f;
+        pool = OrangeFileSystemBufferPool.getInstance();
         this.fd = fd;
-        channelBuffer = ByteBuffer.allocateDirect(bufferSize);
+        channelBuffer = pool.acquire(bufferSize);
     }
 
     /* Flush the outChannel and close the file */
@@ -39,6 +46,8 @@ public class OrangeFileSystemOutputChannel implements WritableByteChannel {
         }
         flush();
         int ret = orange.posix.close(fd);
+        fd = -1;
+        pool.release(channelBuffer);
         channelBuffer = null;
         if (ret < 0) {
             throw new IOException("close failed");
@@ -57,6 +66,7 @@ public class OrangeFileSystemOutputChannel implements WritableByteChannel {
                 orange.posix.close(fd);
                 orange = null;
                 fd = -1;
+                pool.release(channelBuffer);
                 channelBuffer = null;
             }
         } finally {
@@ -141,6 +151,16 @@ public class OrangeFileSystemOutputChannel implements WritableByteChannel {
         while (src.hasRemaining()) {
             srcRemaining = src.remaining();
             srcPosition = src.position();
+            /* Write large direct buffers without copying them. */
+            if (src.isDirect() && srcRemaining >= channelBuffer.capacity()) {
+                flush();
+                long ret = orange.posix.write(fd, src.slice(), srcRemaining);
+                if (ret < 0) {
+                    throw new IOException("write error");
+                }
+                src.position(srcPosition + (int) ret);
+                continue;
+            }
             // Write to OrangeFS if channelBuffer is full
             if (!channelBuffer.hasRemaining()) {
                 flush();
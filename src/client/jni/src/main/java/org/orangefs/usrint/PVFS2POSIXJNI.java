@@ -49,6 +49,12 @@ public class PVFS2POSIXJNI {
 
     public native int access(String path, long mode);
 
+    /*
+     * Returns a direct ByteBuffer over native memory aligned to alignment
+     * bytes, or null. The memory must be returned with freeAlignedBuffer.
+     */
+    public native ByteBuffer allocAlignedBuffer(long alignment, long size);
+
     public native int chdir(String path);
 
     public native int chmod(String path, long mode);
@@ -88,6 +94,8 @@ public class PVFS2POSIXJNI {
 
     public native int flock(int fd, long op);
 
+    public native void freeAlignedBuffer(ByteBuffer buf);
+
     public native int fremovexattr(int fd, String name);
 
     public native Stat fstat(int fd);
@@ -106,6 +114,9 @@ public class PVFS2POSIXJNI {
     public native int futimesat(int dirfd, String path, long actime_usec,
             long modtime_usec);
 
+    /* Strip size and datafile servers of an OrangeFS file, or null. */
+    public native OrangeFileSystemDistribution getDistribution(String path);
+
     public native int getdtablesize();
 
     public native long getumask();
@@ -148,9 +159,13 @@ public class PVFS2POSIXJNI {
 
     public native int openat(int dirfd, String path, long flags, long mode);
 
-    public native long pread(int fd, byte[] buf, long count, long offset);
+    /*
+     * Positional I/O on a direct ByteBuffer. The file offset is left alone,
+     * so these may be used concurrently with read and write.
+     */
+    public native long pread(int fd, ByteBuffer buf, long count, long offset);
 
-    public native long pwrite(int fd, byte[] buf, long count, long offset);
+    public native long pwrite(int fd, ByteBuffer buf, long count, long offset);
 
     public native long read(int fd, ByteBuffer buf, long count);
 
@@ -6,6 +6,7 @@
 package org.orangefs.usrint;
 
 import java.lang.reflect.Field;
+import java.nio.ByteBuffer;
 import java.util.ArrayList;
 
 public class PVFS2STDIOJNI {
@@ -101,6 +102,10 @@ public class PVFS2STDIOJNI {
 
     public native long fread(byte[] ptr, long size, long nmemb, long stream);
 
+    /* fread into a direct ByteBuffer, avoiding the copy of a byte[] */
+    public native long freadDirect(ByteBuffer ptr, long size, long nmemb,
+            long stream);
+
     public native long freadUnlocked(byte[] ptr, long size, long nmemb,
             long stream);
 
@@ -118,6 +123,10 @@ public class PVFS2STDIOJNI {
 
     public native long fwrite(byte[] ptr, long size, long nmemb, long stream);
 
+    /* fwrite from a direct ByteBuffer, avoiding the copy of a byte[] */
+    public native long fwriteDirect(ByteBuffer ptr, long size, long nmemb,
+            long stream);
+
     public native long fwriteUnlocked(byte[] ptr, long size, long nmemb,
             long stream);
 
@@ -29,8 +29,18 @@
 #include "pint-hint.h"
 #include "security-util.h"
 
+#ifdef __GEN_POSIX_LOCKING__
+#include <pthread.h>
+#endif
+
 #define MAX_RETURNED_JOBS   256
 
+/* upper bound on the number of job contexts the client state machines
+ * are spread across; see PINT_client_state_machine_initialize()
+ */
+#define CLIENT_SM_CONTEXTS_MAX 8
+
+/* context of the first shard, kept for code that predates sharding */
 job_context_id pint_client_sm_context = -1;
 
 extern int pint_client_pid;
@@ -40,37 +50,318 @@ extern PINT_event_id PINT_client_sys_event_id;
 /*
  * used for locally storing completed operations from test() call so
  * that we can retrieve them in testsome() while still making progress
- * (and possible completing operations in the test() call
+ * (and possible completing operations in the test() call.  The list
+ * grows as needed, so the number of operations a caller keeps in
+ * flight is not bounded by the size of one testsome() batch.
  */
 static int s_completion_list_index = 0;
-static PINT_smcb *s_completion_list[MAX_RETURNED_JOBS] = {NULL};
+static int s_completion_list_size = 0;
+static PINT_smcb **s_completion_list = NULL;
 static gen_mutex_t s_completion_list_mutex = GEN_MUTEX_INITIALIZER;
-static gen_mutex_t test_mutex = GEN_MUTEX_INITIALIZER;
+
+/*
+ * Each shard pairs a job context with the mutex that serializes the
+ * state machines whose jobs complete there.  A state machine stays on
+ * the shard it was posted on for its whole life, so threads posting to
+ * different shards start, advance and test their operations without
+ * contending for one lock.  With a single shard this is the old
+ * behavior of one context guarded by one test mutex.
+ */
+struct client_sm_shard
+{
+    job_context_id context;
+    gen_mutex_t mutex;
+};
+
+static struct client_sm_shard s_shards[CLIENT_SM_CONTEXTS_MAX];
+static int s_shard_count = 0;
+
+#ifdef __GEN_POSIX_LOCKING__
+/* per-thread shard assignment; "driving" is the shard whose state
+ * machines this thread is currently advancing (-1 if none), so that
+ * jobs posted from inside a state action land on that state machine's
+ * context rather than on the thread's own
+ */
+struct client_sm_thread
+{
+    int shard;
+    int driving;
+};
+
+static pthread_key_t s_thread_key;
+static int s_thread_key_created = 0;
+static int s_next_shard = 0;
+#endif
 
 static void PINT_sys_release_smcb(PINT_smcb *smcb);
 
 #define CLIENT_SM_ASSERT_INITIALIZED()  \
-do { assert(pint_client_sm_context != -1); } while(0)
+do { assert(s_shard_count > 0); } while(0)
+
+#ifdef __GEN_POSIX_LOCKING__
+static void client_sm_thread_exit(void *ptr)
+{
+    free(ptr);
+}
+
+static struct client_sm_thread *client_sm_thread_get(void)
+{
+    struct client_sm_thread *thread;
+
+    thread = pthread_getspecific(s_thread_key);
+    if (!thread)
+    {
+        thread = malloc(sizeof(*thread));
+        if (!thread)
+        {
+            return NULL;
+        }
+        thread->shard = __atomic_fetch_add(&s_next_shard, 1,
+                                           __ATOMIC_RELAXED) % s_shard_count;
+        thread->driving = -1;
+        pthread_setspecific(s_thread_key, thread);
+    }
+    return thread;
+}
+#endif
 
+/* returns the shard new operations from the calling thread are posted on */
+static int client_sm_thread_shard(void)
+{
+#ifdef __GEN_POSIX_LOCKING__
+    struct client_sm_thread *thread;
+
+    if (s_shard_count > 1 && (thread = client_sm_thread_get()))
+    {
+        return thread->shard;
+    }
+#endif
+    return 0;
+}
+
+/* records which shard the calling thread is advancing; returns the
+ * previous value so nested calls can restore it
+ */
+static int client_sm_set_driving(int shard)
+{
+#ifdef __GEN_POSIX_LOCKING__
+    struct client_sm_thread *thread;
+    int old;
+
+    if (s_shard_count > 1 && (thread = client_sm_thread_get()))
+    {
+        old = thread->driving;
+        thread->driving = shard;
+        return old;
+    }
+#endif
+    return -1;
+}
+
+static int client_sm_context_shard(job_context_id context)
+{
+    int i;
+
+    for (i = 0; i < s_shard_count; i++)
+    {
+        if (s_shards[i].context == context)
+        {
+            return i;
+        }
+    }
+    return 0;
+}
+
+/** Opens the job contexts the client state machines run on.  The
+ *  number of contexts is taken from PVFS2_CLIENT_SM_CONTEXTS and
+ *  defaults to one; threads are assigned to contexts round robin the
+ *  first time they post an operation.
+ */
 int PINT_client_state_machine_initialize(void)
 {
-    return job_open_context(&pint_client_sm_context);
+    char *count_str;
+    int count = 1;
+    int ret;
+    int i;
+
+    count_str = getenv("PVFS2_CLIENT_SM_CONTEXTS");
+    if (count_str != NULL)
+    {
+        count = atoi(count_str);
+        if (count < 1)
+        {
+            count = 1;
+        }
+        if (count > CLIENT_SM_CONTEXTS_MAX)
+        {
+            count = CLIENT_SM_CONTEXTS_MAX;
+        }
+    }
+
+#ifdef __GEN_POSIX_LOCKING__
+    if (count > 1 && !s_thread_key_created)
+    {
+        if (pthread_key_create(&s_thread_key, client_sm_thread_exit) != 0)
+        {
+            return -PVFS_ENOMEM;
+        }
+        s_thread_key_created = 1;
+    }
+#else
+    count = 1;
+#endif
+
+    for (i = 0; i < count; i++)
+    {
+        gen_mutex_init(&s_shards[i].mutex);
+        ret = job_open_context(&s_shards[i].context);
+        if (ret < 0)
+        {
+            while (i-- > 0)
+            {
+                job_close_context(s_shards[i].context);
+            }
+            return ret;
+        }
+    }
+    pint_client_sm_context = s_shards[0].context;
+    s_shard_count = count;
+
+    gossip_debug(GOSSIP_CLIENT_DEBUG,
+                 "client state machines using %d job context(s)\n", count);
+    return 0;
 }
 
 void PINT_client_state_machine_finalize(void)
 {
-    job_close_context(pint_client_sm_context);
+    int i;
+
+    for (i = 0; i < s_shard_count; i++)
+    {
+        job_close_context(s_shards[i].context);
+    }
+    s_shard_count = 0;
+    pint_client_sm_context = -1;
+
+    gen_mutex_lock(&s_completion_list_mutex);
+    free(s_completion_list);
+    s_completion_list = NULL;
+    s_completion_list_size = 0;
+    s_completion_list_index = 0;
+    gen_mutex_unlock(&s_completion_list_mutex);
 }
 
+/** Returns the job context that jobs posted by the calling thread
+ *  should complete on: the context of the state machine being advanced
+ *  if called from inside a state action, otherwise the calling
+ *  thread's own context.
+ */
 job_context_id PINT_client_get_sm_context(void)
 {
+#ifdef __GEN_POSIX_LOCKING__
+    struct client_sm_thread *thread;
+
+    if (s_shard_count > 1 && (thread = client_sm_thread_get()))
+    {
+        if (thread->driving >= 0)
+        {
+            return s_shards[thread->driving].context;
+        }
+        return s_shards[thread->shard].context;
+    }
+#endif
     return pint_client_sm_context;
 }
 
+/* progress the state machines of one shard, which the caller has
+ * locked; returns the number of jobs that completed
+ */
+static int client_sm_progress(int shard, int timeout_ms)
+{
+    int i = 0, job_count = MAX_RETURNED_JOBS;
+    int old_driving;
+    PVFS_error ret;
+    PINT_smcb *smcb = NULL;
+    job_id_t job_id_array[MAX_RETURNED_JOBS];
+    job_status_s job_status_array[MAX_RETURNED_JOBS];
+    void *smcb_p_array[MAX_RETURNED_JOBS] = {NULL};
+
+    ret = job_testcontext(job_id_array,
+                          &job_count, /* in/out parameter */
+                          smcb_p_array,
+                          job_status_array,
+                          timeout_ms,
+                          s_shards[shard].context);
+    assert(ret > -1); /* this assert is wrong
+                       * should at least test for
+                       * ETIMEDOUT
+                       */
+
+    old_driving = client_sm_set_driving(shard);
+
+    /* do as much as we can on every job that has completed */
+    for(i = 0; i < job_count; i++)
+    {
+        smcb = (PINT_smcb *)smcb_p_array[i];
+        assert(smcb);
+
+        if (PINT_smcb_invalid_op(smcb))
+        {
+            gossip_err("Invalid sm control block op %d\n", PINT_smcb_op(smcb));
+            continue;
+        }
+        gossip_debug(GOSSIP_CLIENT_DEBUG, "sm control op %d\n", PINT_smcb_op(smcb));
+
+        if (!PINT_smcb_complete(smcb))
+        {
+            /* (ret < 0) indicates a problem from the job system
+             * itself; the return value of the underlying operation is
+             * kept in the job status structure.
+             */
+            PINT_state_machine_continue(smcb, &job_status_array[i]);
+        }
+    }
+
+    client_sm_set_driving(old_driving);
+    return job_count;
+}
+
+/* makes non-blocking progress on every shard other than skip that no
+ * other thread is currently servicing; this keeps operations moving
+ * whose posting thread has stopped testing (the job timer, for one)
+ */
+static void client_sm_progress_others(int skip)
+{
+    int i;
+
+    for (i = 0; i < s_shard_count; i++)
+    {
+        if (i == skip || gen_mutex_trylock(&s_shards[i].mutex) != 0)
+        {
+            continue;
+        }
+        client_sm_progress(i, 0);
+        gen_mutex_unlock(&s_shards[i].mutex);
+    }
+}
+
 static PVFS_error add_sm_to_completion_list(PINT_smcb *smcb)
 {
     gen_mutex_lock(&s_completion_list_mutex);
-    assert(s_completion_list_index < MAX_RETURNED_JOBS);
+    if (s_completion_list_index == s_completion_list_size)
+    {
+        int new_size = (s_completion_list_size ?
+                        s_completion_list_size * 2 : MAX_RETURNED_JOBS);
+        PINT_smcb **new_list = realloc(s_completion_list,
+                                       new_size * sizeof(PINT_smcb *));
+        if (!new_list)
+        {
+            gen_mutex_unlock(&s_completion_list_mutex);
+            return -PVFS_ENOMEM;
+        }
+        s_completion_list = new_list;
+        s_completion_list_size = new_size;
+    }
     if (!smcb->op_completed)
     {
         smcb->op_completed = 1;
@@ -127,18 +418,14 @@ static PVFS_error completion_list_retrieve_any_completed(
    int limit,                   /* in  */
    int *out_count)              /* what exactly is this supposed to return */
 {
-   int i = 0, new_list_index = 0;
+   int i = 0, new_list_index = 0, found = 0;
    PINT_smcb *smcb = NULL;
-   PINT_smcb *tmp_completion_list[MAX_RETURNED_JOBS] = {NULL};
    PINT_client_sm *sm_p;
  
    assert(op_id_array);
    assert(error_code_array);
    assert(out_count);
  
-   memset(tmp_completion_list, 0,
-          (MAX_RETURNED_JOBS * sizeof(PINT_smcb *)));
- 
    gen_mutex_lock(&s_completion_list_mutex);
    for(i = 0; i < s_completion_list_index; i++)
    {
@@ -150,11 +437,11 @@ static PVFS_error completion_list_retrieve_any_completed(
        smcb = s_completion_list[i];
        assert(smcb);
  
-       if (i < limit)
+       if (found < limit)
        {
            sm_p = PINT_sm_frame(smcb, PINT_FRAME_CURRENT);
-           op_id_array[i] = sm_p->sys_op_id;
-           error_code_array[i] = sm_p->error_code;
+           op_id_array[found] = sm_p->sys_op_id;
+           error_code_array[found] = sm_p->error_code;
  
            if (user_ptr_array)
            {
@@ -174,28 +461,27 @@ static PVFS_error completion_list_retrieve_any_completed(
                                 "PVFS_SYS_IO user_ptr from sm_base_p(%p), "
                                 "user_ptr(%p)\n", __func__, sm_base_p,
                                 sm_base_p->user_ptr);
-                   user_ptr_array[i] = sm_base_p->user_ptr;
+                   user_ptr_array[found] = sm_base_p->user_ptr;
                }
                else
                {
-                   user_ptr_array[i] = (void *)sm_p->user_ptr;
+                   user_ptr_array[found] = (void *)sm_p->user_ptr;
                }
            }
-           s_completion_list[i] = NULL;
+           found++;
  
            PINT_sys_release(sm_p->sys_op_id);
        }
        else
        {
-           tmp_completion_list[new_list_index++] = smcb;
+           /* keep it; entries only ever move toward the front */
+           s_completion_list[new_list_index++] = smcb;
        }
    }
-   *out_count = PVFS_util_min(i, limit);
+   *out_count = found;
  
    /* clean up and adjust the list and it's book keeping */
    s_completion_list_index = new_list_index;
-   memcpy(s_completion_list, tmp_completion_list,
-          (MAX_RETURNED_JOBS * sizeof(struct PINT_smcb *)));
    
    gen_mutex_unlock(&s_completion_list_mutex);
    return 0;
@@ -217,7 +503,6 @@ static PVFS_error completion_list_retrieve_some_completed(
     int out_op_count = 0;
     int found;
     PINT_smcb *smcb = NULL;
-    PINT_smcb *tmp_completion_list[MAX_RETURNED_JOBS] = {NULL};
     PINT_client_sm *sm_p;
     PVFS_sys_op_id out_ops[MAX_RETURNED_JOBS] = {0};
 
@@ -225,9 +510,6 @@ static PVFS_error completion_list_retrieve_some_completed(
     assert(error_code_array);
     assert(out_count);
 
-    memset(tmp_completion_list, 0,
-           (MAX_RETURNED_JOBS * sizeof(PINT_smcb *)));
-
     gen_mutex_lock(&s_completion_list_mutex);
     for(i = 0; i < s_completion_list_index; i++)
     {
@@ -282,22 +564,19 @@ static PVFS_error completion_list_retrieve_some_completed(
                     user_ptr_array[out_op_count] = (void *)sm_p->user_ptr;
                 }
             }
-            s_completion_list[i] = NULL;
             out_op_count++;
 
             PINT_sys_release(sm_p->sys_op_id);
         }
         else
         {
-            tmp_completion_list[new_list_index++] = smcb;
+            s_completion_list[new_list_index++] = smcb;
         }
     }
     *out_count = out_op_count;
 
     /* clean up and adjust the list and it's book keeping */
     s_completion_list_index = new_list_index;
-    memcpy(s_completion_list, tmp_completion_list,
-           (MAX_RETURNED_JOBS * sizeof(struct PINT_smcb *)));
     gossip_debug(GOSSIP_CLIENT_DEBUG, "%s has %d items left on completed list\n", __func__, new_list_index);    
     /* return only the op_ids that were found in the input list */
     memcpy(op_id_array, out_ops, (out_op_count * sizeof(PVFS_sys_op_id)));
@@ -364,7 +643,8 @@ struct PINT_client_op_entry_s PINT_client_sm_sys_table[] =
     {&pvfs2_client_statfs_sm},
     {&pvfs2_fs_add_sm},
     {&pvfs2_client_readdirplus_sm},
-    {&pvfs2_client_atomic_eattr_sm}
+    {&pvfs2_client_atomic_eattr_sm},
+    {&pvfs2_client_readdir_stream_sm}
 };
 
 struct PINT_client_op_entry_s PINT_client_sm_mgmt_table[] =
@@ -522,6 +802,7 @@ PVFS_error PINT_client_state_machine_post(
     job_status_s js;
     int pvfs_sys_op = PINT_smcb_op(smcb);
     PINT_client_sm *sm_p = PINT_sm_frame(smcb, PINT_FRAME_CURRENT);
+    int shard, old_driving;
 
     PVFS_hint_add_internal(&sm_p->hints,
                            PINT_HINT_OP_ID,
@@ -556,18 +837,24 @@ PVFS_error PINT_client_state_machine_post(
     /* save operation type; mark operation as unfinished */
     sm_p->user_ptr = user_ptr;
 
-    gen_mutex_lock(&test_mutex);
+    /* the state machine lives on the posting thread's shard */
+    shard = client_sm_thread_shard();
+    smcb->context = s_shards[shard].context;
+
+    gen_mutex_lock(&s_shards[shard].mutex);
     /*
       start state machine and continue advancing while we're getting
       immediate completions
     */
+    old_driving = client_sm_set_driving(shard);
     sm_ret = PINT_state_machine_start(smcb, &js);
+    client_sm_set_driving(old_driving);
     assert(SM_ACTION_ISVALID(sm_ret));
 
     if(sm_ret < 0)
     {
         /* state machine code failed */
-        gen_mutex_unlock(&test_mutex);
+        gen_mutex_unlock(&s_shards[shard].mutex);
 
         /* give back the hint added above */
         PVFS_hint_free( &sm_p->hints );
@@ -615,7 +902,7 @@ PVFS_error PINT_client_state_machine_post(
                     lld((op_id ? *op_id : -1)),
                     ret);
     }
-    gen_mutex_unlock(&test_mutex);
+    gen_mutex_unlock(&s_shards[shard].mutex);
     return js.error_code;
 }
 
@@ -723,7 +1010,7 @@ PVFS_error PINT_client_io_cancel(PVFS_sys_op_id id)
                          "(Request)\n",i);
 
             ret = job_bmi_cancel(cur_ctx->msg.send_id,
-                                 pint_client_sm_context);
+                                 smcb->context);
             if (ret < 0)
             {
                 PVFS_perror_gossip("job_bmi_cancel failed", ret);
@@ -739,7 +1026,7 @@ PVFS_error PINT_client_io_cancel(PVFS_sys_op_id id)
                          "(Response)\n",i);
 
             ret = job_bmi_cancel(cur_ctx->msg.recv_id,
-                                 pint_client_sm_context);
+                                 smcb->context);
             if (ret < 0)
             {
                 PVFS_perror_gossip("job_bmi_cancel failed", ret);
@@ -754,7 +1041,7 @@ PVFS_error PINT_client_io_cancel(PVFS_sys_op_id id)
                          "[%d] Posting cancellation of type: FLOW\n",i);
 
             ret = job_flow_cancel(
-                cur_ctx->flow_job_id, pint_client_sm_context);
+                cur_ctx->flow_job_id, smcb->context);
             if (ret < 0)
             {
                 PVFS_perror_gossip("job_flow_cancel failed", ret);
@@ -770,7 +1057,7 @@ PVFS_error PINT_client_io_cancel(PVFS_sys_op_id id)
                          "(Write Ack)\n",i);
 
             ret = job_bmi_cancel(cur_ctx->write_ack.recv_id,
-                                 pint_client_sm_context);
+                                 smcb->context);
             if (ret < 0)
             {
                 PVFS_perror_gossip("job_bmi_cancel failed", ret);
@@ -794,83 +1081,51 @@ PVFS_error PINT_client_state_machine_test(
     PVFS_sys_op_id op_id,
     int *error_code)
 {
-    int i = 0, job_count = 0;
+    int shard = 0, job_count = 0;
     PVFS_error ret = -PVFS_EINVAL;
-    PINT_smcb *smcb, *tmp_smcb = NULL;
+    PINT_smcb *smcb;
     PINT_client_sm *sm_p = NULL;
-    job_id_t job_id_array[MAX_RETURNED_JOBS];
-    job_status_s job_status_array[MAX_RETURNED_JOBS];
-    void *smcb_p_array[MAX_RETURNED_JOBS] = {NULL};
 
     gossip_debug(GOSSIP_STATE_MACHINE_DEBUG,
                  "PINT_client_state_machine_test id %lld\n",lld(op_id));
 
-    gen_mutex_lock(&test_mutex);
-
     CLIENT_SM_ASSERT_INITIALIZED();
 
-    job_count = MAX_RETURNED_JOBS;
-
     if (!error_code)
     {
-        gen_mutex_unlock(&test_mutex);
         return ret;
     }
 
     smcb = PINT_id_gen_safe_lookup(op_id);
     if (!smcb)
     {
-        gen_mutex_unlock(&test_mutex);
         return ret;
     }
 
+    shard = client_sm_context_shard(smcb->context);
+    gen_mutex_lock(&s_shards[shard].mutex);
+
     if (PINT_smcb_complete(smcb))
     {
         sm_p = PINT_sm_frame(smcb, PINT_FRAME_CURRENT);
         *error_code = sm_p->error_code;
-        gen_mutex_unlock(&test_mutex);
+        gen_mutex_unlock(&s_shards[shard].mutex);
         return 0;
     }
 
-    ret = job_testcontext(job_id_array,
-			  &job_count, /* in/out parameter */
-			  smcb_p_array,
-			  job_status_array,
-			  10,
-			  pint_client_sm_context);
-    assert(ret > -1);
-
-    /* do as much as we can on every job that has completed */
-    for(i = 0; i < job_count; i++)
-    {
-	tmp_smcb = (PINT_smcb *)smcb_p_array[i];
-        assert(tmp_smcb);
-
-        if (PINT_smcb_invalid_op(tmp_smcb))
-        {
-            gossip_err("Invalid sm control block op %d\n", PINT_smcb_op(tmp_smcb));
-            continue;
-        }
-        gossip_debug(GOSSIP_CLIENT_DEBUG, "sm control op %d\n", PINT_smcb_op(tmp_smcb));
-
-        if (!PINT_smcb_complete(tmp_smcb))
-        {
-            ret = PINT_state_machine_continue(tmp_smcb, &job_status_array[i]);
-
-            if (ret != SM_ACTION_DEFERRED &&
-                    ret != SM_ACTION_TERMINATE); /* ret == 0 */
-            {
-                continue;
-            }
-        }
-    }
+    job_count = client_sm_progress(shard, 10);
 
     if (PINT_smcb_complete(smcb))
     {
         sm_p = PINT_sm_frame(smcb, PINT_FRAME_CURRENT);
         *error_code = sm_p->error_code;
     }
-    gen_mutex_unlock(&test_mutex);
+    gen_mutex_unlock(&s_shards[shard].mutex);
+
+    if (job_count == 0)
+    {
+        client_sm_progress_others(shard);
+    }
     return 0;
 }
 
@@ -888,31 +1143,22 @@ PVFS_error PINT_client_state_machine_testany(
    int timeout_ms)
 {
    PVFS_error ret = -PVFS_EINVAL;
-   int i = 0, limit = 0, job_count = 0;
-   PINT_smcb *smcb = NULL;
-   job_id_t job_id_array[MAX_RETURNED_JOBS];
-   job_status_s job_status_array[MAX_RETURNED_JOBS];
-   void *smcb_p_array[MAX_RETURNED_JOBS] = {NULL};
- 
-   gen_mutex_lock(&test_mutex);
+   int limit = 0, shard = 0;
  
    CLIENT_SM_ASSERT_INITIALIZED();
  
    if (!op_id_array || !op_count || !error_code_array)
    {
        PVFS_perror_gossip("PINT_client_state_machine_testany", ret);
-       gen_mutex_unlock(&test_mutex);
        return ret;
    }
  
    if ((*op_count < 1) || (*op_count > MAX_RETURNED_JOBS))
    {
        PVFS_perror_gossip("testany() got invalid op_count", ret);
-       gen_mutex_unlock(&test_mutex);
        return ret;
    }
  
-   job_count = MAX_RETURNED_JOBS;
    limit = *op_count;
    *op_count = 0;
  
@@ -926,44 +1172,17 @@ PVFS_error PINT_client_state_machine_testany(
    /* return them if found */
    if ((ret == 0) && (*op_count > 0))
    {
-       gen_mutex_unlock(&test_mutex);
        return ret;
    }
  
-   /* see if there are requests ready to make progress */
-   ret = job_testcontext(job_id_array,
-                          &job_count, /* in/out parameter */
-                          smcb_p_array,
-                          job_status_array,
-                          timeout_ms,
-                          pint_client_sm_context);
- 
-   assert(ret > -1); /* this assert is wrong
-                       * should at least test for
-                       * ETIMEDOUT
-                       */
- 
-   /* do as much as we can on every job that has completed */
-   for(i = 0; i < job_count; i++)
-   {
-        smcb = (PINT_smcb *)smcb_p_array[i];
-       assert(smcb);
- 
-       if (!PINT_smcb_complete(smcb))
-       {
-           ret = PINT_state_machine_continue(smcb, &job_status_array[i]);
- 
-           /* (ret < 0) indicates a problem from the job system
-             * itself; the return value of the underlying operation is
-             * kept in the job status structure.
-             */
-           if (ret != SM_ACTION_DEFERRED &&
-                   ret != SM_ACTION_TERMINATE)
-           {
-               continue;
-           }
-       }
-   }
+   /* see if there are requests ready to make progress, waiting on this
+    * thread's own shard and sweeping the rest
+    */
+   shard = client_sm_thread_shard();
+   gen_mutex_lock(&s_shards[shard].mutex);
+   client_sm_progress(shard, timeout_ms);
+   gen_mutex_unlock(&s_shards[shard].mutex);
+   client_sm_progress_others(shard);
  
    /* terminated SMs have added themselves to the completion list */
    ret = completion_list_retrieve_any_completed(op_id_array,
@@ -971,7 +1190,6 @@ PVFS_error PINT_client_state_machine_testany(
                                                 error_code_array,
                                                 limit,
                                                 op_count);
-   gen_mutex_unlock(&test_mutex);
    return(ret);
 }
 
@@ -989,32 +1207,30 @@ PVFS_error PINT_client_state_machine_testsome(
     int timeout_ms)
 {
     PVFS_error ret = -PVFS_EINVAL;
-    int i = 0, limit = 0, job_count = 0;
+    int limit = 0, shard = 0;
     PINT_smcb *smcb = NULL;
-    job_id_t job_id_array[MAX_RETURNED_JOBS];
-    job_status_s job_status_array[MAX_RETURNED_JOBS];
-    void *smcb_p_array[MAX_RETURNED_JOBS] = {NULL};
-
-    gen_mutex_lock(&test_mutex);
 
     CLIENT_SM_ASSERT_INITIALIZED();
 
     if (!op_id_array || !op_count || !error_code_array)
     {
         PVFS_perror_gossip("PINT_client_state_machine_testsome", ret);
-        gen_mutex_unlock(&test_mutex);
         return ret;
     }
 
     if ((*op_count < 1) || (*op_count > MAX_RETURNED_JOBS))
     {
         PVFS_perror_gossip("testsome() got invalid op_count", ret);
-        gen_mutex_unlock(&test_mutex);
         return ret;
     }
 
-    job_count = MAX_RETURNED_JOBS;
     limit = *op_count;
+
+    /* wait on the shard of the first operation asked about */
+    smcb = PINT_id_gen_safe_lookup(op_id_array[0]);
+    shard = (smcb ? client_sm_context_shard(smcb->context) :
+             client_sm_thread_shard());
+
     *op_count = 0;
 
     /* check for requests completed previously */
@@ -1027,44 +1243,14 @@ PVFS_error PINT_client_state_machine_testsome(
     /* return them if found */
     if ((ret == 0) && (*op_count > 0))
     {
-        gen_mutex_unlock(&test_mutex);
         return ret;
     }
 
     /* see if there are requests ready to make progress */
-    ret = job_testcontext(job_id_array,
-			  &job_count, /* in/out parameter */
-			  smcb_p_array,
-			  job_status_array,
-			  timeout_ms,
-			  pint_client_sm_context);
-
-    assert(ret > -1); /* this assert is wrong
-                       * should at least test for
-                       * ETIMEDOUT
-                       */
-
-    /* do as much as we can on every job that has completed */
-    for(i = 0; i < job_count; i++)
-    {
-	smcb = (PINT_smcb *)smcb_p_array[i];
-        assert(smcb);
-
-        if (!PINT_smcb_complete(smcb))
-        {
-            ret = PINT_state_machine_continue(smcb, &job_status_array[i]);
-
-            /* (ret < 0) indicates a problem from the job system
-             * itself; the return value of the underlying operation is
-             * kept in the job status structure.
-             */
-            if (ret != SM_ACTION_DEFERRED &&
-                    ret != SM_ACTION_TERMINATE)
-            {
-                continue;
-            }
-        }
-    }
+    gen_mutex_lock(&s_shards[shard].mutex);
+    client_sm_progress(shard, timeout_ms);
+    gen_mutex_unlock(&s_shards[shard].mutex);
+    client_sm_progress_others(shard);
 
     /* terminated SMs have added themselves to the completion list */
     ret = completion_list_retrieve_some_completed(op_id_array,
@@ -1072,7 +1258,6 @@ PVFS_error PINT_client_state_machine_testsome(
                                                   error_code_array,
                                                   limit,
                                                   op_count);
-    gen_mutex_unlock(&test_mutex);
     return(ret);
 }
 
@@ -1235,6 +1420,7 @@ const char *PINT_client_get_name_str(int op_type)
         { PVFS_SYS_GETEATTR, "PVFS_SYS_GETEATTR" },
         { PVFS_SYS_SETEATTR, "PVFS_SYS_SETEATTR" },
         { PVFS_SYS_ATOMICEATTR, "PVFS_SYS_ATOMICEATTR" },
+        { PVFS_SYS_READDIR_STREAM, "PVFS_SYS_READDIR_STREAM" },
         { PVFS_SYS_DELEATTR, "PVFS_SYS_DELEATTR" },
         { PVFS_SYS_LISTEATTR, "PVFS_SYS_LISTEATTR" },
         { PVFS_SERVER_GET_CONFIG, "PVFS_SERVER_GET_CONFIG" },
@@ -204,6 +204,11 @@ struct PINT_client_create_sm
 
     PVFS_handle handles[2];
 
+    void *data;                       /* initial file contents, or NULL */
+    PVFS_size data_size;              /* input parameter */
+    PVFS_size *stored;                /* out: bytes written with the create */
+    int separate;                     /* compound create_file not possible */
+
     struct PVFS_servresp_create server_resp; /* data returned from the server request */
 };
 
@@ -371,6 +376,26 @@ struct PINT_client_readdir_sm
     int num_dirdata_needed; /* tmp parameter */
 };
 
+/* state kept between calls of PVFS_sys_readdir_stream_next() */
+struct PVFS_sys_readdir_stream_s
+{
+    PVFS_object_ref ref;
+    PVFS_credential *credential;
+    int32_t window;             /* pages each server may read ahead */
+    int32_t page_size;          /* entries asked of a server at a time */
+    int server_count;           /* dirdata servers, 0 before first call */
+    PVFS_ds_position *tokens;   /* next position on each server */
+    int remaining;              /* servers not yet at the end */
+};
+
+struct PINT_client_readdir_stream_sm
+{
+    PVFS_sys_readdir_stream stream;
+    PVFS_sysresp_readdir *resp;
+    int *server_index;          /* dirdata server of each msgpair */
+    int capacity;               /* entries resp->dirent_array holds */
+};
+
 struct handle_to_index {
     PVFS_handle handle;
     int         handle_index;/* This is the index into the dirent array itself */
@@ -703,6 +728,7 @@ typedef struct PINT_client_sm
         struct PINT_client_io_sm io;
         struct PINT_client_flush_sm flush;
         struct PINT_client_readdirplus_sm readdirplus;
+        struct PINT_client_readdir_stream_sm readdir_stream;
         struct PINT_client_lookup_sm lookup;
         struct PINT_client_rename_sm rename;
         struct PINT_client_mgmt_setparam_list_sm setparam_list;
@@ -814,6 +840,7 @@ enum
     PVFS_SYS_FS_ADD                = 19,
     PVFS_SYS_READDIRPLUS           = 20,
     PVFS_SYS_ATOMICEATTR           = 21,
+    PVFS_SYS_READDIR_STREAM        = 22,
     PVFS_MGMT_SETPARAM_LIST        = 70,
     PVFS_MGMT_NOOP                 = 71,
     PVFS_MGMT_STATFS_LIST          = 72,
@@ -834,13 +861,25 @@ enum
     PVFS_DEV_UNEXPECTED            = 400
 };
 
-#define PVFS_OP_SYS_MAXVALID  22
+#define PVFS_OP_SYS_MAXVALID  23
 #define PVFS_OP_SYS_MAXVAL 69
 #define PVFS_OP_MGMT_MAXVALID 84
 #define PVFS_OP_MGMT_MAXVAL 199
 
 int PINT_client_io_cancel(job_id_t id);
 
+PVFS_error PINT_client_io_post(PVFS_object_ref ref,
+                               PVFS_Request file_req,
+                               PVFS_offset file_req_offset,
+                               void *buffer,
+                               PVFS_Request mem_req,
+                               const PVFS_credential *credential,
+                               PVFS_sysresp_io *resp_p,
+                               enum PVFS_io_type io_type,
+                               PVFS_sys_op_id *op_id,
+                               PVFS_hint hints,
+                               void *user_ptr);
+
 /* internal non-blocking helper methods */
 int PINT_client_wait_internal(
     PVFS_sys_op_id op_id,
@@ -858,14 +897,14 @@ do {                                                          \
     if (user_cred_p == NULL)                                  \
     {                                                         \
         gossip_err("Invalid user credentials! (nil)\n");      \
-        free(sm_p);                                           \
+        PINT_smcb_free(smcb);                                 \
         return -PVFS_EACCES;                                  \
     }                                                         \
     sm_p_cred_p = PINT_dup_credential(user_cred_p);           \
     if (!sm_p_cred_p)                                         \
     {                                                         \
         gossip_err("Failed to copy user credentials\n");      \
-        free(sm_p);                                           \
+        PINT_smcb_free(smcb);                                 \
         return -PVFS_ENOMEM;                                  \
     }                                                         \
 } while(0)
@@ -875,7 +914,7 @@ do {                                                                \
     PINT_sm_msgpair_params *mpp = &client_sm_p->msgarray_op.params; \
     struct server_configuration_s *server_config =                  \
         PINT_get_server_config_struct(__fsid);                      \
-    mpp->job_context = pint_client_sm_context;                      \
+    mpp->job_context = PINT_client_get_sm_context();                      \
     if (server_config)                                              \
     {                                                               \
         mpp->job_timeout = server_config->client_job_bmi_timeout;   \
@@ -914,6 +953,7 @@ extern struct PINT_state_machine_s pvfs2_client_flush_sm;
 extern struct PINT_state_machine_s pvfs2_client_sysint_readdir_sm;
 extern struct PINT_state_machine_s pvfs2_client_readdir_sm;
 extern struct PINT_state_machine_s pvfs2_client_readdirplus_sm;
+extern struct PINT_state_machine_s pvfs2_client_readdir_stream_sm;
 extern struct PINT_state_machine_s pvfs2_client_lookup_sm;
 extern struct PINT_state_machine_s pvfs2_client_rename_sm;
 extern struct PINT_state_machine_s pvfs2_client_truncate_sm;
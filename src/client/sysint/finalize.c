@@ -13,6 +13,7 @@
 #include "pint-sysint-utils.h"
 #include "acache.h"
 #include "ncache.h"
+#include "wbcache.h"
 #include "client-capcache.h"
 #include "gen-locks.h"
 #include "pint-cached-config.h"
@@ -92,8 +93,17 @@ int PVFS_sys_finalize()
                 __func__,
                 PINT_perf_generate_text(PINT_client_capcache_get_pc(), 4096));
         }
+        if(PINT_wbcache_get_pc() &&
+           strstr(perf_counters_to_display, "wbcache"))
+        {
+            gossip_err("%s: DISPLAYING PERF COUNTERS FOR WBCACHE\n%s",
+                __func__,
+                PINT_perf_generate_text(PINT_wbcache_get_pc(), 4096));
+        }
     }
 
+    /* buffered writes go out while everything below is still running */
+    PINT_wbcache_finalize();
     PINT_client_capcache_finalize();
     PINT_ncache_finalize();
     PINT_acache_finalize();
@@ -104,7 +114,7 @@ int PVFS_sys_finalize()
 
     /* finalize the I/O interfaces */
     job_time_mgr_finalize();
-    job_close_context(pint_client_sm_context);
+    PINT_client_state_machine_finalize();
     job_finalize();
 
     PINT_flow_finalize();
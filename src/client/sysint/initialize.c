@@ -19,6 +19,7 @@
 #include "acache.h"
 #include "ncache.h"
 #include "client-capcache.h"
+#include "wbcache.h"
 #include "pint-cached-config.h"
 #include "pvfs2-sysint.h"
 #include "pvfs2-util.h"
@@ -68,7 +69,8 @@ typedef enum
     CLIENT_JOB_TIME_MGR_INIT = (1 << 9),
     CLIENT_DIST_INIT         = (1 << 10),
     CLIENT_SECURITY_INIT     = (1 << 11),
-    CLIENT_CAPCACHE_INIT     = (1 << 12)
+    CLIENT_CAPCACHE_INIT     = (1 << 12),
+    CLIENT_WBCACHE_INIT      = (1 << 13)
 } PINT_client_status_flag;
 
 /* PVFS_sys_initialize()
@@ -303,6 +305,15 @@ int PVFS_sys_initialize(uint64_t default_debug_mask)
     }        
     client_status_flag |= CLIENT_NCACHE_INIT;
 
+    /* initialize the write-behind cache (off unless configured) */
+    ret = PINT_wbcache_initialize();
+    if (ret < 0)
+    {
+        gossip_lerr("Error initializing write-behind cache\n");
+        goto error_exit;
+    }
+    client_status_flag |= CLIENT_WBCACHE_INIT;
+
     /* initialize the server configuration manager */
     ret = PINT_server_config_mgr_initialize();
     if (ret < 0)
@@ -326,7 +337,7 @@ int PVFS_sys_initialize(uint64_t default_debug_mask)
                     sizeof(struct PINT_client_sm),
                     client_op_state_get_machine,
                     NULL,
-                    pint_client_sm_context);
+                    PINT_client_get_sm_context());
     if(!smcb)
     {
 	ret = (-PVFS_ENOMEM);
@@ -349,6 +360,11 @@ error_exit:
 
     id_gen_safe_finalize();
 
+    if (client_status_flag & CLIENT_WBCACHE_INIT)
+    {
+        PINT_wbcache_finalize();
+    }
+
     if (client_status_flag & CLIENT_CAPCACHE_INIT)
     {
         PINT_client_capcache_finalize();
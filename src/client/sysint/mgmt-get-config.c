@@ -56,7 +56,7 @@ int PVFS_mgmt_get_config(
                     sizeof(struct PINT_client_sm),
                     client_op_state_get_machine,
                     client_state_machine_terminate,
-                    pint_client_sm_context);
+                    PINT_client_get_sm_context());
     if(smcb == NULL)
     {
         return -PVFS_ENOMEM;
@@ -408,7 +408,7 @@ int client_perf_start_rollover(struct PINT_perf_counter *pc,
                     sizeof(struct PINT_client_sm),
                     client_op_state_get_machine,
                     client_state_machine_terminate,
-                    pint_client_sm_context);
+                    PINT_client_get_sm_context());
     if (!pc->smcb)
     {
         return(-PVFS_ENOMEM);
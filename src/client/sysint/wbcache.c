@@ -0,0 +1,876 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/** \file
+ *  \ingroup wbcache
+ *
+ * Implementation of the Write-behind Cache (wbcache) component.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "pvfs2-internal.h"
+#include "client-state-machine.h"
+#include "pint-request.h"
+#include "pint-distribution.h"
+#include "pint-util.h"
+#include "security-util.h"
+#include "gen-locks.h"
+#include "gossip.h"
+#include "quicklist.h"
+#include "quickhash.h"
+#include "acache.h"
+#include "wbcache.h"
+
+#define WBCACHE_DEFAULT_TIMEOUT_MSECS 1000
+#define WBCACHE_DEFAULT_MAX_FILES     64
+#define WBCACHE_DEFAULT_MAX_WRITE     (64 * 1024)
+#define WBCACHE_MAX_EXTENTS           64
+#define WBCACHE_TABLE_SIZE            67
+
+/* a dirty byte range, relative to the start of the window */
+struct wbcache_extent
+{
+    PVFS_size start;
+    PVFS_size len;
+};
+
+/* one per file written through the cache */
+struct wbcache_entry
+{
+    struct qlist_head hash_link;
+    struct qlist_head lru_link;    /* least recently written first */
+    PVFS_object_ref refn;
+    PVFS_credential *credential;   /* of the writes now buffered */
+    char *buffer;                  /* mirrors [window, window + size) */
+    PVFS_size size;                /* usable bytes of buffer */
+    PVFS_offset window;            /* file offset of buffer[0], -1 if none */
+    PVFS_size strip_size;          /* 0 if the distribution is not known */
+    struct wbcache_extent extent[WBCACHE_MAX_EXTENTS];
+    int extent_count;
+    int writes;                    /* writes buffered since the last flush */
+    PVFS_time dirtied;             /* ms time of the first of those */
+    PVFS_error error;              /* from a flush nobody waited on */
+    int flushing;                  /* buffer is being written out */
+};
+
+static gen_mutex_t wbcache_mutex = GEN_MUTEX_INITIALIZER;
+static gen_cond_t wbcache_cond = GEN_COND_INITIALIZER;
+static struct qhash_table *wbcache_table = NULL;
+static QLIST_HEAD(wbcache_lru);
+static int wbcache_entries = 0;
+static int wbcache_dirty = 0;
+static struct PINT_perf_counter *wbcache_pc = NULL;
+
+static unsigned int wbcache_buffer_size = 0;
+static unsigned int wbcache_timeout_msecs = WBCACHE_DEFAULT_TIMEOUT_MSECS;
+static unsigned int wbcache_max_files = WBCACHE_DEFAULT_MAX_FILES;
+static unsigned int wbcache_max_write = WBCACHE_DEFAULT_MAX_WRITE;
+
+/* totals behind the aggregation counter */
+static int64_t wbcache_total_writes = 0;
+static int64_t wbcache_total_flushes = 0;
+
+static struct PINT_perf_key wbcache_keys[] =
+{
+    {"WBCACHE_WRITES", PERF_WBCACHE_WRITES, 0},
+    {"WBCACHE_BYPASSED", PERF_WBCACHE_BYPASSED, 0},
+    {"WBCACHE_FLUSHES", PERF_WBCACHE_FLUSHES, 0},
+    {"WBCACHE_FLUSH_BYTES", PERF_WBCACHE_FLUSH_BYTES, 0},
+    {"WBCACHE_FLUSH_SYNC", PERF_WBCACHE_FLUSH_SYNC, 0},
+    {"WBCACHE_FLUSH_ATTR", PERF_WBCACHE_FLUSH_ATTR, 0},
+    {"WBCACHE_FLUSH_CONFLICT", PERF_WBCACHE_FLUSH_CONFLICT, 0},
+    {"WBCACHE_FLUSH_PRESSURE", PERF_WBCACHE_FLUSH_PRESSURE, 0},
+    {"WBCACHE_FLUSH_TIMER", PERF_WBCACHE_FLUSH_TIMER, 0},
+    {"WBCACHE_DIRTY_FILES", PERF_WBCACHE_DIRTY_FILES, PINT_PERF_PRESERVE},
+    {"WBCACHE_AGGREGATION", PERF_WBCACHE_AGGREGATION, PINT_PERF_PRESERVE},
+    {NULL, 0, 0},
+};
+
+static int wbcache_hash_key(const void *key, int table_size);
+static int wbcache_compare_key_entry(const void *key, struct qlist_head *link);
+static struct wbcache_entry *wbcache_lookup(PVFS_object_ref refn);
+static struct wbcache_entry *wbcache_lookup_idle(PVFS_object_ref refn);
+static struct wbcache_entry *wbcache_oldest_idle(void);
+static struct wbcache_entry *wbcache_entry_create(PVFS_object_ref refn);
+static void wbcache_entry_destroy(struct wbcache_entry *entry);
+static void wbcache_set_window(struct wbcache_entry *entry,
+                               PVFS_offset offset);
+static int wbcache_add_extent(struct wbcache_entry *entry,
+                              PVFS_size start,
+                              PVFS_size len);
+static int wbcache_flush_entry(struct wbcache_entry *entry,
+                               enum PINT_wbcache_flush_reason reason);
+static int wbcache_is_contiguous(PVFS_Request req);
+static int wbcache_same_writer(const PVFS_credential *a,
+                               const PVFS_credential *b);
+
+/**
+ * Initializes the wbcache
+ * \return 0 on success, -PVFS_error on failure
+ */
+int PINT_wbcache_initialize(void)
+{
+    char *env;
+
+    gen_mutex_lock(&wbcache_mutex);
+
+    wbcache_table = qhash_init(wbcache_compare_key_entry,
+                               wbcache_hash_key,
+                               WBCACHE_TABLE_SIZE);
+    if (!wbcache_table)
+    {
+        gen_mutex_unlock(&wbcache_mutex);
+        return -PVFS_ENOMEM;
+    }
+
+    env = getenv("PVFS2_WBCACHE_SIZE");
+    if (env)
+    {
+        wbcache_buffer_size = (unsigned int)strtoul(env, NULL, 0);
+    }
+    env = getenv("PVFS2_WBCACHE_TIMEOUT");
+    if (env)
+    {
+        wbcache_timeout_msecs = (unsigned int)strtoul(env, NULL, 0);
+    }
+
+    /* the client never rolls counters over, so these are totals */
+    wbcache_pc = PINT_perf_initialize(PINT_PERF_COUNTER, wbcache_keys, NULL);
+    if (!wbcache_pc)
+    {
+        gossip_err("%s: Error: PINT_perf_initialize failure.\n", __func__);
+        qhash_finalize(wbcache_table);
+        wbcache_table = NULL;
+        gen_mutex_unlock(&wbcache_mutex);
+        return -PVFS_ENOMEM;
+    }
+
+    gen_mutex_unlock(&wbcache_mutex);
+    return 0;
+}
+
+/** Writes out everything still buffered and destroys the wbcache */
+void PINT_wbcache_finalize(void)
+{
+    struct wbcache_entry *entry;
+
+    gen_mutex_lock(&wbcache_mutex);
+    if (!wbcache_table)
+    {
+        gen_mutex_unlock(&wbcache_mutex);
+        return;
+    }
+    while ((entry = wbcache_oldest_idle()) != NULL)
+    {
+        wbcache_flush_entry(entry, WBCACHE_FLUSH_SYNC);
+        if (entry->error)
+        {
+            gossip_err("%s: buffered writes lost: %d\n",
+                       __func__, entry->error);
+        }
+        wbcache_entry_destroy(entry);
+    }
+    qhash_finalize(wbcache_table);
+    wbcache_table = NULL;
+
+    PINT_perf_finalize(wbcache_pc);
+    wbcache_pc = NULL;
+    gen_mutex_unlock(&wbcache_mutex);
+}
+
+/**
+ * Retrieves a wbcache setting
+ * \return 0 on success, -PVFS_error on failure
+ */
+int PINT_wbcache_get_info(enum PINT_wbcache_options option,
+                          unsigned int *arg)
+{
+    switch (option)
+    {
+    case WBCACHE_BUFFER_SIZE:
+        *arg = wbcache_buffer_size;
+        return 0;
+    case WBCACHE_TIMEOUT_MSECS:
+        *arg = wbcache_timeout_msecs;
+        return 0;
+    case WBCACHE_MAX_FILES:
+        *arg = wbcache_max_files;
+        return 0;
+    case WBCACHE_MAX_WRITE:
+        *arg = wbcache_max_write;
+        return 0;
+    }
+    return -PVFS_EINVAL;
+}
+
+/**
+ * Changes a wbcache setting.  Changing the buffer size writes out
+ * everything buffered so far.
+ * \return 0 on success, -PVFS_error on failure
+ */
+int PINT_wbcache_set_info(enum PINT_wbcache_options option,
+                          unsigned int arg)
+{
+    struct wbcache_entry *entry;
+    int ret = 0;
+
+    gen_mutex_lock(&wbcache_mutex);
+    switch (option)
+    {
+    case WBCACHE_BUFFER_SIZE:
+        while ((entry = wbcache_oldest_idle()) != NULL)
+        {
+            wbcache_flush_entry(entry, WBCACHE_FLUSH_SYNC);
+            wbcache_entry_destroy(entry);
+        }
+        wbcache_buffer_size = arg;
+        break;
+    case WBCACHE_TIMEOUT_MSECS:
+        wbcache_timeout_msecs = arg;
+        break;
+    case WBCACHE_MAX_FILES:
+        wbcache_max_files = (arg > 0) ? arg : 1;
+        break;
+    case WBCACHE_MAX_WRITE:
+        wbcache_max_write = arg;
+        break;
+    default:
+        ret = -PVFS_EINVAL;
+    }
+    gen_mutex_unlock(&wbcache_mutex);
+    return ret;
+}
+
+/**
+ * Buffers a write if it is small and contiguous in both memory and
+ * the file.  Data is copied, so the caller may reuse its buffer.
+ * \return 1 if the write was buffered and resp_p filled in, 0 if the
+ * caller must do the write itself
+ */
+int PINT_wbcache_write(PVFS_object_ref ref,
+                       PVFS_Request file_req,
+                       PVFS_offset file_req_offset,
+                       void *buffer,
+                       PVFS_Request mem_req,
+                       const PVFS_credential *credential,
+                       PVFS_sysresp_io *resp_p)
+{
+    struct wbcache_entry *entry;
+    struct wbcache_entry *oldest;
+    PVFS_size total;
+    PVFS_size done = 0;
+    PVFS_size chunk;
+    PVFS_offset offset;
+    PVFS_credential *cred;
+
+    if (wbcache_buffer_size == 0 || !wbcache_table)
+    {
+        return 0;
+    }
+
+    total = PINT_REQUEST_TOTAL_BYTES(mem_req);
+    if (total <= 0 || total > wbcache_max_write ||
+        total > wbcache_buffer_size ||
+        !wbcache_is_contiguous(mem_req) ||
+        !wbcache_is_contiguous(file_req))
+    {
+        PINT_perf_count(wbcache_pc, PERF_WBCACHE_BYPASSED, 1, PINT_PERF_ADD);
+        return 0;
+    }
+
+    cred = PINT_dup_credential(credential);
+    if (!cred)
+    {
+        return 0;
+    }
+
+    gen_mutex_lock(&wbcache_mutex);
+    while ((entry = wbcache_lookup_idle(ref)) == NULL)
+    {
+        if (wbcache_entries < wbcache_max_files)
+        {
+            entry = wbcache_entry_create(ref);
+            break;
+        }
+
+        /* make room by writing out the least recently written file */
+        oldest = wbcache_oldest_idle();
+        if (!oldest)
+        {
+            continue;
+        }
+        if (wbcache_flush_entry(oldest, WBCACHE_FLUSH_PRESSURE) < 0 ||
+            oldest->error)
+        {
+            /* the entry keeps its error for the next sync, so there is
+             * no room; try another file next time and write this one
+             * directly */
+            qlist_del(&oldest->lru_link);
+            qlist_add_tail(&oldest->lru_link, &wbcache_lru);
+            break;
+        }
+        wbcache_entry_destroy(oldest);
+    }
+    if (!entry)
+    {
+        PINT_perf_count(wbcache_pc, PERF_WBCACHE_BYPASSED, 1, PINT_PERF_ADD);
+        gen_mutex_unlock(&wbcache_mutex);
+        PINT_cleanup_credential(cred);
+        free(cred);
+        return 0;
+    }
+
+    /* buffered data goes out under the credential it was written with */
+    if (entry->extent_count && entry->credential &&
+        !wbcache_same_writer(entry->credential, cred))
+    {
+        wbcache_flush_entry(entry, WBCACHE_FLUSH_CONFLICT);
+    }
+    if (entry->credential)
+    {
+        PINT_cleanup_credential(entry->credential);
+        free(entry->credential);
+    }
+    entry->credential = cred;
+
+    /* a write may straddle the end of the window; the part that does
+     * not fit goes into the next window after this one is written out
+     */
+    offset = file_req_offset + file_req->lb;
+    while (done < total)
+    {
+        if (entry->window < 0 ||
+            offset + done < entry->window ||
+            offset + done >= entry->window + entry->size)
+        {
+            wbcache_flush_entry(entry, WBCACHE_FLUSH_PRESSURE);
+            wbcache_set_window(entry, offset + done);
+        }
+        chunk = entry->window + entry->size - (offset + done);
+        if (chunk > total - done)
+        {
+            chunk = total - done;
+        }
+        if (wbcache_add_extent(entry, offset + done - entry->window,
+                               chunk) < 0)
+        {
+            /* out of extents - write out what we have and retry */
+            wbcache_flush_entry(entry, WBCACHE_FLUSH_PRESSURE);
+            wbcache_add_extent(entry, offset + done - entry->window, chunk);
+        }
+        memcpy(entry->buffer + (offset + done - entry->window),
+               (char *)buffer + mem_req->lb + done,
+               chunk);
+        done += chunk;
+    }
+
+    if (entry->writes++ == 0)
+    {
+        entry->dirtied = PINT_util_get_time_ms();
+        wbcache_dirty++;
+        PINT_perf_count(wbcache_pc, PERF_WBCACHE_DIRTY_FILES,
+                        wbcache_dirty, PINT_PERF_SET);
+    }
+    qlist_del(&entry->lru_link);
+    qlist_add_tail(&entry->lru_link, &wbcache_lru);
+
+    wbcache_total_writes++;
+    PINT_perf_count(wbcache_pc, PERF_WBCACHE_WRITES, 1, PINT_PERF_ADD);
+    gen_mutex_unlock(&wbcache_mutex);
+
+    resp_p->total_completed = total;
+    return 1;
+}
+
+/**
+ * Writes out buffered data that overlaps an I/O about to be posted,
+ * so a read sees it and a later unbuffered write lands on top of it.
+ */
+void PINT_wbcache_conflict(PVFS_object_ref ref,
+                           PVFS_Request file_req,
+                           PVFS_offset file_req_offset,
+                           PVFS_Request mem_req)
+{
+    struct wbcache_entry *entry;
+    PVFS_offset lo, hi;
+    PVFS_size tiles;
+    int i;
+
+    if (!wbcache_dirty || !wbcache_table)
+    {
+        return;
+    }
+
+    /* the file request tiles until the memory request is used up */
+    tiles = 1;
+    if (PINT_REQUEST_TOTAL_BYTES(file_req) > 0)
+    {
+        tiles = (PINT_REQUEST_TOTAL_BYTES(mem_req) +
+                 PINT_REQUEST_TOTAL_BYTES(file_req) - 1) /
+                PINT_REQUEST_TOTAL_BYTES(file_req);
+    }
+    lo = file_req_offset + file_req->lb;
+    hi = lo + tiles * (file_req->ub - file_req->lb);
+
+    gen_mutex_lock(&wbcache_mutex);
+    entry = wbcache_lookup_idle(ref);
+    if (entry && entry->extent_count)
+    {
+        for (i = 0; i < entry->extent_count; i++)
+        {
+            if (entry->window + entry->extent[i].start < hi &&
+                entry->window + entry->extent[i].start +
+                    entry->extent[i].len > lo)
+            {
+                wbcache_flush_entry(entry, WBCACHE_FLUSH_CONFLICT);
+                break;
+            }
+        }
+    }
+    gen_mutex_unlock(&wbcache_mutex);
+}
+
+/**
+ * Writes out a file's buffered data and waits for it.
+ * \return for WBCACHE_FLUSH_SYNC the first error of any flush of this
+ * file since the last sync, which is then cleared; 0 otherwise
+ */
+int PINT_wbcache_flush(PVFS_object_ref ref,
+                       enum PINT_wbcache_flush_reason reason)
+{
+    struct wbcache_entry *entry;
+    int ret = 0;
+
+    if (!wbcache_table || (!wbcache_dirty && !wbcache_entries))
+    {
+        return 0;
+    }
+
+    gen_mutex_lock(&wbcache_mutex);
+    entry = wbcache_lookup_idle(ref);
+    if (entry)
+    {
+        wbcache_flush_entry(entry, reason);
+        if (reason == WBCACHE_FLUSH_SYNC)
+        {
+            ret = entry->error;
+            entry->error = 0;
+        }
+    }
+    gen_mutex_unlock(&wbcache_mutex);
+    return ret;
+}
+
+/** Writes out any file whose data has been held past the timeout */
+void PINT_wbcache_flush_expired(void)
+{
+    struct wbcache_entry *entry;
+    struct wbcache_entry *expired;
+    PVFS_time now;
+
+    if (!wbcache_dirty || !wbcache_table)
+    {
+        return;
+    }
+
+    now = PINT_util_get_time_ms();
+    gen_mutex_lock(&wbcache_mutex);
+    /* a flush drops the mutex, so rescan the list after each one */
+    do
+    {
+        expired = NULL;
+        qlist_for_each_entry(entry, &wbcache_lru, lru_link)
+        {
+            if (!entry->flushing && entry->writes &&
+                now - entry->dirtied >= (PVFS_time)wbcache_timeout_msecs)
+            {
+                expired = entry;
+                break;
+            }
+        }
+        if (expired)
+        {
+            wbcache_flush_entry(expired, WBCACHE_FLUSH_TIMER);
+        }
+    } while (expired);
+    gen_mutex_unlock(&wbcache_mutex);
+}
+
+struct PINT_perf_counter *PINT_wbcache_get_pc(void)
+{
+    return wbcache_pc;
+}
+
+/* wbcache_flush_entry()
+ *
+ * posts one write covering every extent of the entry and waits for
+ * it.  caller holds the wbcache mutex and an idle entry; the mutex is
+ * dropped for the write, and the entry is marked flushing meanwhile so
+ * nobody else changes or destroys it.  the write goes through
+ * PINT_client_io_post() so it does not come back into the cache.
+ */
+static int wbcache_flush_entry(struct wbcache_entry *entry,
+                               enum PINT_wbcache_flush_reason reason)
+{
+    int32_t blocklengths[WBCACHE_MAX_EXTENTS];
+    PVFS_size displacements[WBCACHE_MAX_EXTENTS];
+    PVFS_size file_displacements[WBCACHE_MAX_EXTENTS];
+    PVFS_Request file_req = NULL;
+    PVFS_Request mem_req = NULL;
+    PVFS_sysresp_io resp;
+    PVFS_sys_op_id op_id;
+    PVFS_size bytes = 0;
+    int error = 0;
+    int ret;
+    int i;
+
+    if (entry->extent_count == 0)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < entry->extent_count; i++)
+    {
+        blocklengths[i] = (int32_t)entry->extent[i].len;
+        displacements[i] = entry->extent[i].start;
+        file_displacements[i] = entry->window + entry->extent[i].start;
+        bytes += entry->extent[i].len;
+    }
+
+    entry->flushing = 1;
+    gen_mutex_unlock(&wbcache_mutex);
+
+    /* the buffer mirrors the window, so memory and file share a shape.
+     * the file side is given absolute offsets: a noncontiguous file
+     * request posted at a nonzero file_req_offset loses data here. */
+    ret = PVFS_Request_hindexed(entry->extent_count, blocklengths,
+                                file_displacements, PVFS_BYTE, &file_req);
+    if (ret == 0)
+    {
+        ret = PVFS_Request_hindexed(entry->extent_count, blocklengths,
+                                    displacements, PVFS_BYTE, &mem_req);
+    }
+    if (ret == 0)
+    {
+        memset(&resp, 0, sizeof(resp));
+        ret = PINT_client_io_post(entry->refn, file_req, 0,
+                                  entry->buffer, mem_req, entry->credential,
+                                  &resp, PVFS_IO_WRITE, &op_id,
+                                  PVFS_HINT_NULL, NULL);
+        if (ret == 0 && op_id != -1)
+        {
+            ret = PVFS_sys_wait(op_id, "io", &error);
+            if (ret == 0)
+            {
+                ret = error;
+            }
+            PINT_sys_release(op_id);
+        }
+        if (ret == 0 && resp.total_completed != bytes)
+        {
+            ret = -PVFS_EIO;
+        }
+    }
+    if (file_req)
+    {
+        PVFS_Request_free(&file_req);
+    }
+    if (mem_req)
+    {
+        PVFS_Request_free(&mem_req);
+    }
+
+    gen_mutex_lock(&wbcache_mutex);
+    entry->flushing = 0;
+    gen_cond_broadcast(&wbcache_cond);
+
+    if (ret < 0)
+    {
+        PVFS_perror_gossip("wbcache flush failed", ret);
+        if (!entry->error)
+        {
+            entry->error = ret;
+        }
+    }
+
+    gossip_debug(GOSSIP_CLIENT_DEBUG,
+                 "wbcache: flushed %d writes in %d extents (%lld bytes) "
+                 "of %llu at %lld, reason %d\n",
+                 entry->writes, entry->extent_count, lld(bytes),
+                 llu(entry->refn.handle), lld(entry->window), reason);
+
+    wbcache_total_flushes++;
+    PINT_perf_count(wbcache_pc, PERF_WBCACHE_FLUSHES, 1, PINT_PERF_ADD);
+    PINT_perf_count(wbcache_pc, PERF_WBCACHE_FLUSH_BYTES, bytes,
+                    PINT_PERF_ADD);
+    PINT_perf_count(wbcache_pc, PERF_WBCACHE_FLUSH_SYNC + reason, 1,
+                    PINT_PERF_ADD);
+    PINT_perf_count(wbcache_pc, PERF_WBCACHE_AGGREGATION,
+                    (wbcache_total_writes * 100) / wbcache_total_flushes,
+                    PINT_PERF_SET);
+
+    entry->extent_count = 0;
+    if (entry->writes)
+    {
+        entry->writes = 0;
+        wbcache_dirty--;
+        PINT_perf_count(wbcache_pc, PERF_WBCACHE_DIRTY_FILES,
+                        wbcache_dirty, PINT_PERF_SET);
+    }
+    return ret;
+}
+
+/* wbcache_set_window()
+ *
+ * moves an empty entry's window to cover offset.  windows are a whole
+ * number of strips when the strip is smaller than the buffer, and
+ * start on a multiple of their own size, which with the usual power
+ * of two sizes is also a strip boundary.
+ */
+static void wbcache_set_window(struct wbcache_entry *entry,
+                               PVFS_offset offset)
+{
+    entry->size = wbcache_buffer_size;
+    if (entry->strip_size > 0 && entry->strip_size < wbcache_buffer_size)
+    {
+        entry->size -= wbcache_buffer_size % entry->strip_size;
+    }
+    entry->window = offset - (offset % entry->size);
+}
+
+/* wbcache_add_extent()
+ *
+ * records [start, start + len) as dirty, merging it with any extents
+ * it touches.  returns -1 if a new extent is needed and none are left.
+ */
+static int wbcache_add_extent(struct wbcache_entry *entry,
+                              PVFS_size start,
+                              PVFS_size len)
+{
+    PVFS_size end = start + len;
+    int first, last, i;
+
+    /* extents are sorted and never touch each other */
+    for (first = 0; first < entry->extent_count; first++)
+    {
+        if (entry->extent[first].start + entry->extent[first].len >= start)
+        {
+            break;
+        }
+    }
+    for (last = first; last < entry->extent_count; last++)
+    {
+        if (entry->extent[last].start > end)
+        {
+            break;
+        }
+    }
+
+    if (first == last)
+    {
+        /* touches nothing - insert a new extent at first */
+        if (entry->extent_count == WBCACHE_MAX_EXTENTS)
+        {
+            return -1;
+        }
+        memmove(&entry->extent[first + 1], &entry->extent[first],
+                (entry->extent_count - first) *
+                    sizeof(struct wbcache_extent));
+        entry->extent[first].start = start;
+        entry->extent[first].len = len;
+        entry->extent_count++;
+        return 0;
+    }
+
+    /* merge extents first .. last - 1 with the new range */
+    if (entry->extent[first].start < start)
+    {
+        start = entry->extent[first].start;
+    }
+    if (entry->extent[last - 1].start + entry->extent[last - 1].len > end)
+    {
+        end = entry->extent[last - 1].start + entry->extent[last - 1].len;
+    }
+    entry->extent[first].start = start;
+    entry->extent[first].len = end - start;
+    if (last - first > 1)
+    {
+        for (i = first + 1; last < entry->extent_count; i++, last++)
+        {
+            entry->extent[i] = entry->extent[last];
+        }
+        entry->extent_count = i;
+    }
+    return 0;
+}
+
+/* returns 1 if a request is one contiguous run of bytes from its lb */
+static int wbcache_is_contiguous(PVFS_Request req)
+{
+    return (PINT_REQUEST_NUM_CONTIG(req) == 1 &&
+            req->ub - req->lb == PINT_REQUEST_TOTAL_BYTES(req));
+}
+
+/* returns 1 if two credentials are for the same user and groups */
+static int wbcache_same_writer(const PVFS_credential *a,
+                               const PVFS_credential *b)
+{
+    if (a->userid != b->userid || a->num_groups != b->num_groups)
+    {
+        return 0;
+    }
+    if (a->num_groups &&
+        memcmp(a->group_array, b->group_array,
+               a->num_groups * sizeof(PVFS_gid)) != 0)
+    {
+        return 0;
+    }
+    if (a->issuer && b->issuer)
+    {
+        return (strcmp(a->issuer, b->issuer) == 0);
+    }
+    return (a->issuer == b->issuer);
+}
+
+static struct wbcache_entry *wbcache_lookup(PVFS_object_ref refn)
+{
+    struct qlist_head *link;
+
+    link = qhash_search(wbcache_table, &refn);
+    if (!link)
+    {
+        return NULL;
+    }
+    return qhash_entry(link, struct wbcache_entry, hash_link);
+}
+
+/* wbcache_lookup_idle()
+ *
+ * finds a file's entry once no flush of it is in progress.  the wbcache
+ * mutex is dropped while waiting, so the entry may be gone by then.
+ */
+static struct wbcache_entry *wbcache_lookup_idle(PVFS_object_ref refn)
+{
+    struct wbcache_entry *entry;
+
+    while ((entry = wbcache_lookup(refn)) != NULL && entry->flushing)
+    {
+        gen_cond_wait(&wbcache_cond, &wbcache_mutex);
+    }
+    return entry;
+}
+
+/* wbcache_oldest_idle()
+ *
+ * returns the least recently written entry not being flushed, waiting
+ * for a flush to finish if every entry is.  NULL if there are none.
+ */
+static struct wbcache_entry *wbcache_oldest_idle(void)
+{
+    struct wbcache_entry *entry;
+
+    while (!qlist_empty(&wbcache_lru))
+    {
+        qlist_for_each_entry(entry, &wbcache_lru, lru_link)
+        {
+            if (!entry->flushing)
+            {
+                return entry;
+            }
+        }
+        gen_cond_wait(&wbcache_cond, &wbcache_mutex);
+    }
+    return NULL;
+}
+
+static struct wbcache_entry *wbcache_entry_create(PVFS_object_ref refn)
+{
+    struct wbcache_entry *entry;
+    PVFS_object_attr attr;
+    int attr_status, size_status;
+    PVFS_size size;
+
+    entry = (struct wbcache_entry *)malloc(sizeof(*entry));
+    if (!entry)
+    {
+        return NULL;
+    }
+    memset(entry, 0, sizeof(*entry));
+    entry->buffer = (char *)malloc(wbcache_buffer_size);
+    if (!entry->buffer)
+    {
+        free(entry);
+        return NULL;
+    }
+    entry->refn = refn;
+    entry->window = -1;
+
+    /* the strip size comes from whatever attributes are cached; it is
+     * only a hint, so a miss just means windows are buffer aligned */
+    memset(&attr, 0, sizeof(attr));
+    if (PINT_acache_get_cached_entry(refn, &attr, &attr_status,
+                                     &size, &size_status) == 0)
+    {
+        if ((attr.mask & PVFS_ATTR_META_DIST) &&
+            (attr.mask & PVFS_ATTR_META_DFILES) &&
+            attr.u.meta.dist)
+        {
+            entry->strip_size = attr.u.meta.dist->methods->get_blksize(
+                attr.u.meta.dist->params, attr.u.meta.dfile_count);
+        }
+        PINT_free_object_attr(&attr);
+    }
+
+    qhash_add(wbcache_table, &entry->refn, &entry->hash_link);
+    qlist_add_tail(&entry->lru_link, &wbcache_lru);
+    wbcache_entries++;
+    return entry;
+}
+
+/* caller has flushed the entry */
+static void wbcache_entry_destroy(struct wbcache_entry *entry)
+{
+    qhash_del(&entry->hash_link);
+    qlist_del(&entry->lru_link);
+    if (entry->credential)
+    {
+        PINT_cleanup_credential(entry->credential);
+        free(entry->credential);
+    }
+    free(entry->buffer);
+    free(entry);
+    wbcache_entries--;
+}
+
+static int wbcache_hash_key(const void *key, int table_size)
+{
+    const PVFS_object_ref *refn = (const PVFS_object_ref *)key;
+    unsigned long tmp = 0;
+
+    tmp += ((refn->handle << 2) | (refn->fs_id));
+    return (int)(tmp % table_size);
+}
+
+static int wbcache_compare_key_entry(const void *key, struct qlist_head *link)
+{
+    const PVFS_object_ref *refn = (const PVFS_object_ref *)key;
+    struct wbcache_entry *entry;
+
+    entry = qlist_entry(link, struct wbcache_entry, hash_link);
+    return ((entry->refn.handle == refn->handle) &&
+            (entry->refn.fs_id == refn->fs_id));
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
@@ -0,0 +1,120 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+#ifndef __WBCACHE_H
+#define __WBCACHE_H
+
+#include "pvfs2-types.h"
+#include "pvfs2-request.h"
+#include "pvfs2-sysint.h"
+#include "pint-perf-counter.h"
+
+/** \defgroup wbcache Write-behind Cache (wbcache)
+ *
+ * The wbcache holds small contiguous writes in a per-file buffer and
+ * sends them to the servers later as one noncontiguous write.  Each
+ * file buffer mirrors a window of the file that starts on a strip
+ * boundary, so a flush touches as few servers as the data allows.
+ *
+ * Writes are only buffered by the blocking PVFS_sys_io() and by
+ * callers that use PINT_wbcache_write() directly.  Buffered data is
+ * written out:
+ * - on PVFS_sys_flush() or an explicit PINT_wbcache_flush()
+ * - before a getattr that asks for the size, and before a truncate
+ * - before any read or unbuffered write that overlaps it
+ * - when a file runs out of extents or too many files are dirty
+ * - when it has been held longer than the timeout
+ * - at PVFS_sys_finalize()
+ * .
+ *
+ * Errors from flushes that nobody waited on are kept with the file and
+ * returned by the next PVFS_sys_flush().
+ *
+ * The cache is off unless a buffer size is set, either with the
+ * PVFS2_WBCACHE_SIZE environment variable or PINT_wbcache_set_info().
+ *
+ * @{
+ */
+
+/** \file
+ * Declarations for the Write-behind Cache (wbcache) component.
+ */
+
+enum PINT_wbcache_options
+{
+    WBCACHE_BUFFER_SIZE = 1,   /**< bytes buffered per file, 0 disables */
+    WBCACHE_TIMEOUT_MSECS = 2, /**< longest time data is held */
+    WBCACHE_MAX_FILES = 3,     /**< files with buffered data */
+    WBCACHE_MAX_WRITE = 4,     /**< largest write that is buffered */
+};
+
+/** why a file's buffered writes are being sent */
+enum PINT_wbcache_flush_reason
+{
+    WBCACHE_FLUSH_SYNC = 0,     /**< fsync, close or finalize */
+    WBCACHE_FLUSH_ATTR = 1,     /**< getattr of the size or truncate */
+    WBCACHE_FLUSH_CONFLICT = 2, /**< overlapping I/O or another user writes */
+    WBCACHE_FLUSH_PRESSURE = 3, /**< out of extents, window or files */
+    WBCACHE_FLUSH_TIMER = 4,    /**< held longer than the timeout */
+};
+
+enum
+{
+    PERF_WBCACHE_WRITES = 0,
+    PERF_WBCACHE_BYPASSED = 1,
+    PERF_WBCACHE_FLUSHES = 2,
+    PERF_WBCACHE_FLUSH_BYTES = 3,
+    PERF_WBCACHE_FLUSH_SYNC = 4,
+    PERF_WBCACHE_FLUSH_ATTR = 5,
+    PERF_WBCACHE_FLUSH_CONFLICT = 6,
+    PERF_WBCACHE_FLUSH_PRESSURE = 7,
+    PERF_WBCACHE_FLUSH_TIMER = 8,
+    PERF_WBCACHE_DIRTY_FILES = 9,
+    PERF_WBCACHE_AGGREGATION = 10
+};
+
+int PINT_wbcache_initialize(void);
+
+void PINT_wbcache_finalize(void);
+
+int PINT_wbcache_get_info(enum PINT_wbcache_options option,
+                          unsigned int *arg);
+
+int PINT_wbcache_set_info(enum PINT_wbcache_options option,
+                          unsigned int arg);
+
+int PINT_wbcache_write(PVFS_object_ref ref,
+                       PVFS_Request file_req,
+                       PVFS_offset file_req_offset,
+                       void *buffer,
+                       PVFS_Request mem_req,
+                       const PVFS_credential *credential,
+                       PVFS_sysresp_io *resp_p);
+
+void PINT_wbcache_conflict(PVFS_object_ref ref,
+                           PVFS_Request file_req,
+                           PVFS_offset file_req_offset,
+                           PVFS_Request mem_req);
+
+int PINT_wbcache_flush(PVFS_object_ref ref,
+                       enum PINT_wbcache_flush_reason reason);
+
+void PINT_wbcache_flush_expired(void);
+
+struct PINT_perf_counter *PINT_wbcache_get_pc(void);
+
+/** @} */
+
+#endif /* __WBCACHE_H */
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
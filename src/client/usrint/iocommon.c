@@ -21,6 +21,7 @@
 #endif
 #include <errno.h>
 #include <pint-cached-config.h>
+#include <wbcache.h>
 
 /** this is a global analog of errno for pvfs specific
  *  errors errno is set to EIO and this is set to the
@@ -94,6 +95,28 @@ errorout:
     return rc;
 }
 
+/**
+ * Send writes held in the sysint write-behind cache to the servers
+ * without asking them to sync, as on close
+ */
+int iocommon_flush_buffered(pvfs_descriptor *pd)
+{
+    int rc = 0;
+    int orig_errno = errno;
+
+    if (!pd || pd->is_in_use != PVFS_FS)
+    {
+        errno = EBADF;
+        return -1;
+    }
+    errno = 0;
+    rc = PINT_wbcache_flush(pd->s->pvfs_ref, WBCACHE_FLUSH_SYNC);
+    IOCOMMON_CHECK_ERR(rc);
+
+errorout:
+    return rc;
+}
+
 /**
  * Find the PVFS handle to an object (file, dir sym) 
  * assumes an absoluate path
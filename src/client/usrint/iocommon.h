@@ -83,6 +83,8 @@ unsigned char read_full_block_into_ucache( pvfs_descriptor *pd,
 
 extern int iocommon_fsync(pvfs_descriptor *pvfs_info);
 
+extern int iocommon_flush_buffered(pvfs_descriptor *pvfs_info);
+
 int iocommon_expand_path (PVFS_path_t *Ppath,
                           int follow_flag, 
                           int flags,
@@ -1004,6 +1004,19 @@ int pvfs_close(int fd)
             }
             iocommon_chmod(pd, mode);
         }
+        /* writes held back by the client are written out (not synced) */
+        if (S_ISREG(pd->s->mode))
+        {
+            rc = iocommon_flush_buffered(pd);
+            if (rc < 0)
+            {
+                /* the descriptor is released anyway, as close(2) does */
+                int flush_errno = errno;
+                pvfs_free_descriptor(pd->fd);
+                errno = flush_errno;
+                return -1;
+            }
+        }
     }
 
     /* free descriptor */
@@ -47,6 +47,7 @@
 #include <apr_optional.h>
 #include <apr_strings.h>
 #include <apr_md5.h>
+#include <apr_general.h>
 #include <apr_lib.h>
 #include <apr_base64.h>
 #include <apr_want.h>
@@ -205,6 +206,7 @@ const char *EXT_ATTR_S3_OWNER_ID           = "user.s3.owner.id";
 const char *EXT_ATTR_S3_OWNER_DISPLAY_NAME = "user.s3.owner.display-name";
 const char *EXT_ATTR_S3_ENTITY_TAG         = "user.s3.entity-tag";
 const char *EXT_ATTR_S3_SIZE               = "user.s3.size";
+const char *EXT_ATTR_S3_UPLOAD_KEY         = "user.s3.upload.key";
 
 const int PERM_S3_FULL_CONTROL 	= 1;
 const int PERM_S3_WRITE		= 2;
@@ -440,9 +442,302 @@ static char * orangefs_s3_bin_to_hex(apr_pool_t *pool,
   return hexstr;
 }
 
+/*
+   Object data moves between OrangeFS and the connection in buffers that
+   hold one strip from every datafile (a full stripe), so each request
+   keeps all the servers of a file busy.  The size is clamped to these
+   bounds.  Two buffers are used per transfer: while one is being sent to
+   the client (or filled from it) the other is being read from (or written
+   to) OrangeFS with PVFS_isys_io.
+ */
+#define S3_IO_BUFFER_MIN (64 * 1024)
+#define S3_IO_BUFFER_MAX (8 * 1024 * 1024)
+
+/* number of chunks copied at once when a multipart upload is completed */
+#define S3_MULTIPART_PARALLEL 4
+
+/* one nonblocking I/O on a transfer buffer */
+typedef struct {
+  char *buffer;
+  PVFS_size len;
+  PVFS_offset offset;
+  PVFS_Request mem_req;
+  PVFS_sysresp_io resp_io;
+  PVFS_sys_op_id op_id;
+  int posted;
+} orangefs_s3_io;
+
+/*
+   Returns the transfer buffer size for an object: a whole stripe, clamped
+   to S3_IO_BUFFER_MIN..S3_IO_BUFFER_MAX.  If size is not NULL it is set
+   to the size of the object.
+ */
+static PVFS_size orangefs_s3_io_buffer_size(orangefs_s3_request *req,
+                                            PVFS_object_ref *ref,
+                                            PVFS_size *size)
+{
+  PVFS_sysresp_getattr resp_getattr;
+  PVFS_size bufsize = S3_IO_BUFFER_MIN;
+  PVFS_size strip;
+  int rc;
+
+  memset(&resp_getattr, 0, sizeof(PVFS_sysresp_getattr));
+  rc = PVFS_sys_getattr(*ref, PVFS_ATTR_SYS_ALL_NOHINT, req->credentials,
+                        &resp_getattr, NULL);
+  if (rc < 0) {
+    ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL,
+                 "PVFS_sys_getattr returned %d.", rc);
+    return -1;
+  }
+
+  if (size) {
+    *size = resp_getattr.attr.size;
+  }
+
+  if (resp_getattr.attr.blksize > 0) {
+    bufsize = resp_getattr.attr.blksize;
+    /* round down to whole strips when clamping */
+    strip = bufsize;
+    if (resp_getattr.attr.dfile_count > 0) {
+      strip = bufsize / resp_getattr.attr.dfile_count;
+    }
+    if (bufsize > S3_IO_BUFFER_MAX) {
+      bufsize = (strip > 0 && strip <= S3_IO_BUFFER_MAX) ?
+                (S3_IO_BUFFER_MAX / strip) * strip : S3_IO_BUFFER_MAX;
+    }
+    if (bufsize < S3_IO_BUFFER_MIN) {
+      bufsize = S3_IO_BUFFER_MIN;
+    }
+  }
+  PVFS_util_release_sys_attr(&resp_getattr.attr);
+
+  return bufsize;
+}
+
+/* Posts a nonblocking read or write of io->len bytes at io->offset. */
+static int orangefs_s3_io_post(orangefs_s3_request *req,
+                               PVFS_object_ref *ref,
+                               orangefs_s3_io *io,
+                               enum PVFS_io_type type,
+                               PVFS_hint hints)
+{
+  int rc;
+
+  rc = PVFS_Request_contiguous(io->len, PVFS_BYTE, &io->mem_req);
+  if (rc < 0) {
+    ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL,
+                 "PVFS_Request_contiguous returned rc %d.", rc);
+    return rc;
+  }
+
+  memset(&io->resp_io, 0, sizeof(PVFS_sysresp_io));
+  io->op_id = -1;
+  rc = PVFS_isys_io(*ref, PVFS_BYTE, io->offset, io->buffer, io->mem_req,
+                    req->credentials, &io->resp_io, type, &io->op_id,
+                    hints, NULL);
+  if (rc < 0) {
+    ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL,
+                 "PVFS_isys_io returned rc %d.", rc);
+    PVFS_Request_free(&io->mem_req);
+    return rc;
+  }
+  if (rc == 1) {
+    /* completed while posting */
+    io->op_id = -1;
+  }
+  io->posted = 1;
+
+  return 0;
+}
+
+/*
+   Waits for an I/O posted by orangefs_s3_io_post.  Returns the error of
+   the I/O; io->resp_io.total_completed holds the bytes moved.
+ */
+static int orangefs_s3_io_wait(orangefs_s3_io *io)
+{
+  PVFS_sys_op_id op_id;
+  void *user_ptr = NULL;
+  int count, error = 0, rc = 0;
+
+  if (!io->posted) {
+    return 0;
+  }
+
+  while (io->op_id != -1) {
+    op_id = io->op_id;
+    count = 1;
+    rc = PVFS_sys_testsome(&op_id, &count, &user_ptr, &error, 10);
+    if (rc < 0) {
+      error = rc;
+      break;
+    }
+    if (count == 1) {
+      io->op_id = -1;
+    }
+  }
+
+  PVFS_Request_free(&io->mem_req);
+  io->posted = 0;
+
+  if (error < 0) {
+    ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL,
+                 "PVFS_isys_io completed with rc %d.", error);
+  }
+
+  return error;
+}
+
+/*
+   Streams length bytes of an object starting at start to the client.
+   The read of the next buffer is posted before the current one is
+   written to the connection, so the two overlap.  Only the strips
+   covering the requested range are read.
+ */
+static int orangefs_s3_stream_object(orangefs_s3_request *req,
+                                     PVFS_object_ref *ref,
+                                     PVFS_hint hints,
+                                     PVFS_size bufsize,
+                                     PVFS_offset start,
+                                     PVFS_size length)
+{
+  orangefs_s3_io io[2];
+  PVFS_offset next = start;
+  PVFS_offset end = start + length;
+  int cur = 0;
+  int rc = 0;
+
+  if (length <= 0) {
+    return OK;
+  }
+
+  memset(io, 0, sizeof(io));
+  io[0].buffer = apr_palloc(req->pool, bufsize);
+  io[1].buffer = apr_palloc(req->pool, bufsize);
+
+  /* prime the pipeline */
+  io[cur].offset = next;
+  io[cur].len = (end - next < bufsize) ? end - next : bufsize;
+  next += io[cur].len;
+  if (orangefs_s3_io_post(req, ref, &io[cur], PVFS_IO_READ, hints) < 0) {
+    return HTTP_INTERNAL_SERVER_ERROR;
+  }
+
+  while (io[cur].posted) {
+    if (orangefs_s3_io_wait(&io[cur]) < 0) {
+      rc = HTTP_INTERNAL_SERVER_ERROR;
+      break;
+    }
+
+    /* start on the next buffer before sending this one */
+    if (next < end && io[cur].resp_io.total_completed == io[cur].len) {
+      orangefs_s3_io *nio = &io[1 - cur];
+
+      nio->offset = next;
+      nio->len = (end - next < bufsize) ? end - next : bufsize;
+      next += nio->len;
+      if (orangefs_s3_io_post(req, ref, nio, PVFS_IO_READ, hints) < 0) {
+        rc = HTTP_INTERNAL_SERVER_ERROR;
+        break;
+      }
+    }
+
+    if (io[cur].resp_io.total_completed > 0 &&
+        ap_rwrite(io[cur].buffer, io[cur].resp_io.total_completed,
+                  req->r) < 0) {
+      /* the client went away */
+      ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL,
+                   "ap_rwrite failed at offset %lld.",
+                   (long long)io[cur].offset);
+      break;
+    }
+
+    cur = 1 - cur;
+  }
+
+  /* never leave an I/O running into a buffer we are about to drop */
+  orangefs_s3_io_wait(&io[0]);
+  orangefs_s3_io_wait(&io[1]);
+
+  return rc == 0 ? OK : rc;
+}
+
+/*
+   Parses a single "bytes=first-last", "bytes=first-" or "bytes=-suffix"
+   Range header against an object of size bytes.  Returns 1 and sets
+   start/length for a satisfiable range, 0 if the header should be ignored
+   (malformed or multiple ranges; the whole object is sent) and -1 if the
+   range cannot be satisfied.
+ */
+static int orangefs_s3_parse_range(const char *range,
+                                   PVFS_size size,
+                                   PVFS_offset *start,
+                                   PVFS_size *length)
+{
+  const char *ptr;
+  char *endp;
+  long long first = -1, last = -1;
+
+  if (range == NULL || strncasecmp(range, "bytes=", 6) != 0) {
+    return 0;
+  }
+  ptr = range + 6;
+  if (strchr(ptr, ',')) {
+    return 0;
+  }
+
+  while (apr_isspace(*ptr)) {
+    ptr++;
+  }
+  if (*ptr != '-') {
+    first = strtoll(ptr, &endp, 10);
+    if (endp == ptr || first < 0) {
+      return 0;
+    }
+    ptr = endp;
+  }
+  if (*ptr++ != '-') {
+    return 0;
+  }
+  if (*ptr) {
+    last = strtoll(ptr, &endp, 10);
+    if (endp == ptr || last < 0 || *endp) {
+      return 0;
+    }
+  }
+
+  if (first < 0) {
+    /* suffix range: the last "last" bytes */
+    if (last <= 0) {
+      return last == 0 ? -1 : 0;
+    }
+    first = (last >= size) ? 0 : size - last;
+    last = size - 1;
+  } else {
+    if (last >= 0 && last < first) {
+      return 0;
+    }
+    if (last < 0 || last >= size) {
+      last = size - 1;
+    }
+  }
+
+  if (first >= size) {
+    return -1;
+  }
+
+  *start = first;
+  *length = last - first + 1;
+  return 1;
+}
+
 /*
    This routine will write the contents of the POST data to a PVFS2 object and
    return the contents MD5 sum.
+
+   Incoming data is gathered into one of two stripe sized buffers.  When a
+   buffer fills, a nonblocking write of it is posted and the connection is
+   read into the other buffer while the write runs.
  */
 static int orangefs_s3_write_post_data_ref(orangefs_s3_request *req, 
                                            PVFS_object_ref *ref, 
@@ -452,21 +747,31 @@ static int orangefs_s3_write_post_data_ref(orangefs_s3_request *req,
 {
   apr_status_t status;
   int end = 0;
-  apr_size_t bytes;
+  apr_size_t bytes, chunk;
   const char *buf;
   apr_bucket *b;
   apr_bucket_brigade *bb;
-  PVFS_Request mem_req, file_req;
-  PVFS_sysresp_io resp_io;
+  orangefs_s3_io io[2];
+  PVFS_size bufsize;
   size_t offset = 0;
   apr_md5_ctx_t md5_ctx;
-  int rc;
+  int cur = 0;
+  int rc = 0;
 
   if (debug_orangefs_s3) {
     ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL,
                  "orangefs_s3_write_post_data_ref:");
   }
 
+  bufsize = orangefs_s3_io_buffer_size(req, ref, NULL);
+  if (bufsize < 0) {
+    return -1;
+  }
+
+  memset(io, 0, sizeof(io));
+  io[0].buffer = apr_palloc(req->pool, bufsize);
+  io[1].buffer = apr_palloc(req->pool, bufsize);
+
   /* initialize the bucket brigade from the request */
   bb = apr_brigade_create(req->r->pool, req->r->connection->bucket_alloc);
 
@@ -475,10 +780,10 @@ static int orangefs_s3_write_post_data_ref(orangefs_s3_request *req,
   /* loop over each bucket until we get an EOS */
   do {
     status = ap_get_brigade(req->r->input_filters, bb, AP_MODE_READBYTES,
-                            APR_BLOCK_READ, 4096);
+                            APR_BLOCK_READ, bufsize);
     if (status == APR_SUCCESS) {
       for (b = APR_BRIGADE_FIRST(bb);
-           b!= APR_BRIGADE_SENTINEL(bb);
+           b!= APR_BRIGADE_SENTINEL(bb) && rc == 0;
            b = APR_BUCKET_NEXT(b)) {
 
         /* check for EOS */
@@ -492,37 +797,70 @@ static int orangefs_s3_write_post_data_ref(orangefs_s3_request *req,
 
         /* read into buf */
         status = apr_bucket_read(b, &buf, &bytes, APR_BLOCK_READ);
-        if (status == APR_SUCCESS) {
-          file_req = PVFS_BYTE;
-          rc = PVFS_Request_contiguous(bytes, PVFS_BYTE, &mem_req);
-          if (rc < 0) {
-            ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
-                         "PVFS_sys_resolve returned %d.", rc);
-            return -1;
-          }
-
-          rc = PVFS_sys_write(*ref, file_req, offset, (void *)buf, mem_req,
-                              req->credentials, &resp_io, hints);
-
-          offset += bytes;
-
-          PVFS_Request_free(&mem_req);
+        if (status != APR_SUCCESS) {
+          rc = -1;
+          break;
+        }
 
-          apr_md5_update(&md5_ctx, buf, bytes);
+        apr_md5_update(&md5_ctx, buf, bytes);
 
-        } else {
-          return -1;
+        while (bytes > 0) {
+          chunk = bufsize - io[cur].len;
+          if (chunk > bytes) {
+            chunk = bytes;
+          }
+          memcpy(io[cur].buffer + io[cur].len, buf, chunk);
+          io[cur].len += chunk;
+          buf += chunk;
+          bytes -= chunk;
+
+          if (io[cur].len == bufsize) {
+            /* the other buffer must be written before we refill it */
+            if (orangefs_s3_io_wait(&io[1 - cur]) < 0) {
+              rc = -1;
+              break;
+            }
+            io[cur].offset = offset;
+            offset += io[cur].len;
+            if (orangefs_s3_io_post(req, ref, &io[cur], PVFS_IO_WRITE,
+                                    hints) < 0) {
+              rc = -1;
+              break;
+            }
+            cur = 1 - cur;
+            io[cur].len = 0;
+          }
         }
       }
     }
 
     apr_brigade_cleanup(bb);
-  } while (!end && (status == APR_SUCCESS));
+  } while (!end && (status == APR_SUCCESS) && rc == 0);
+
+  /* write what is left in the current buffer */
+  if (rc == 0 && io[cur].len > 0) {
+    if (orangefs_s3_io_wait(&io[1 - cur]) < 0) {
+      rc = -1;
+    } else {
+      io[cur].offset = offset;
+      offset += io[cur].len;
+      if (orangefs_s3_io_post(req, ref, &io[cur], PVFS_IO_WRITE,
+                              hints) < 0) {
+        rc = -1;
+      }
+    }
+  }
+  if (orangefs_s3_io_wait(&io[0]) < 0 || orangefs_s3_io_wait(&io[1]) < 0) {
+    rc = -1;
+  }
+  if (status != APR_SUCCESS) {
+    rc = -1;
+  }
 
   apr_md5_final(md5, &md5_ctx);
   *size = offset;
 
-  return 0;
+  return rc;
 }
 
 /*
@@ -696,291 +1034,867 @@ static PVFS_object_ref * orangefs_s3_mkdir_p(orangefs_s3_request *req,
   sprintf(val.buffer, "%d", req->credentials->userid);
   val.buffer_sz = strlen(val.buffer) + 1;
 
-  rc = PVFS_sys_seteattr(mkdir_response.ref, req->credentials, 
-                         &key, &val, 0, NULL);
-  if (rc < 0) {
-    ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
-                 "PVFS_sys_seteattr() for owner id returned rc %d.", rc);
+  rc = PVFS_sys_seteattr(mkdir_response.ref, req->credentials, 
+                         &key, &val, 0, NULL);
+  if (rc < 0) {
+    ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
+                 "PVFS_sys_seteattr() for owner id returned rc %d.", rc);
+  }
+
+  key.buffer = (void*)EXT_ATTR_S3_OWNER_DISPLAY_NAME;
+  key.buffer_sz = strlen(key.buffer) + 1;
+  val.buffer = req->cn;
+  val.buffer_sz = strlen(val.buffer) + 1;
+
+  rc = PVFS_sys_seteattr(mkdir_response.ref, req->credentials, 
+                         &key, &val, 0, NULL);
+  if (rc < 0) {
+    ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
+                 "PVFS_sys_seteattr() for owner display name returned rc %d.", 
+                 rc);
+  }
+
+  rc = PVFS_sys_lookup(fsid, path, req->credentials, resp_lookup, 
+                       PVFS2_LOOKUP_LINK_NO_FOLLOW, NULL);
+  if (rc == 0) {
+    return &resp_lookup->ref;
+  }
+
+  return NULL;
+}
+
+/*
+   Looks up the object at path in bucket, creating it (and any parent
+   directories) if it does not exist.  An existing object is truncated,
+   since it is about to be replaced.
+ */
+static int orangefs_s3_create_object(orangefs_s3_request *req, 
+                                     char *bucket, 
+                                     char *path,
+                                     PVFS_hint hints,
+                                     PVFS_object_ref *ref)
+{
+  char *entry_name, *parent_path, *entry_path;
+  PVFS_sysresp_lookup resp_lookup;
+  PVFS_sysresp_create resp_create;
+  PVFS_object_ref *parent_ref;
+  PVFS_sys_dist *new_dist = NULL;
+  PVFS_sys_attr attr;
+  char *ptr;
+  int rc;
+
+  entry_path = apr_pstrcat(req->pool, req->conf->pvfs_path, "/", 
+                           bucket, path, NULL);
+
+  memset(&resp_lookup, 0, sizeof(PVFS_sysresp_lookup));
+  rc = PVFS_sys_lookup(req->conf->fsid, entry_path, req->credentials, 
+                       &resp_lookup, PVFS2_LOOKUP_LINK_NO_FOLLOW, NULL);
+  if (rc == 0) {
+    /* file already exists */
+    *ref = resp_lookup.ref;
+    rc = PVFS_sys_truncate(*ref, 0, req->credentials, hints);
+    if (rc < 0) {
+      ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
+                   "PVFS_sys_truncate returned %d.", rc);
+      return HTTP_INTERNAL_SERVER_ERROR;
+    }
+    return OK;
+  }
+
+  /* does not exist, need to create it */
+
+  /* fill out our attr */
+  attr.owner = req->credentials->userid;
+  attr.group = req->credentials->group_array[0];
+  attr.perms = 256;
+  attr.mask = (PVFS_ATTR_SYS_ALL_SETABLE);
+  attr.dfile_count = 0;
+
+  parent_path = 
+    apr_pstrcat(req->pool, req->conf->pvfs_path, "/", bucket, NULL);
+
+  /* walk backwards from the end to find the last '/' */
+  for (ptr = path + strlen(path) -1; (ptr > path) && (*ptr != '/'); ptr--);
+
+  if (ptr > path) {
+    entry_name = apr_pstrdup(req->pool, ptr + 1);
+    parent_path = apr_pstrcat(req->pool, parent_path, 
+                              apr_pstrndup(req->pool, path, 
+                              (ptr - path)), NULL);
+  } else {
+    entry_name = apr_pstrdup(req->pool, path + 1);
+  }
+  
+  parent_ref = orangefs_s3_mkdir_p(req, req->conf->fsid, parent_path);
+  if (parent_ref == NULL) {
+    ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
+                 "Unable to get or create parent directory %s", parent_path);
+    return HTTP_INTERNAL_SERVER_ERROR;
+  }
+
+  /* need to create the entry */
+  rc = PVFS_sys_create(entry_name, *parent_ref, attr, req->credentials, 
+                       new_dist, &resp_create, NULL, hints);
+  if (rc < 0) {
+    ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
+                 "PVFS_sys_create returned %d.", rc);
+    return HTTP_INTERNAL_SERVER_ERROR;
+  }
+
+  *ref = resp_create.ref;
+
+  return OK;
+}
+
+/* Records the S3 entity tag, size and owner of an object. */
+static void orangefs_s3_set_object_attrs(orangefs_s3_request *req, 
+                                         PVFS_object_ref *ref, 
+                                         char *etag, 
+                                         size_t size)
+{
+  PVFS_ds_keyval key, val;
+  char tmp[64];
+  int rc;
+
+  key.buffer = (void*)EXT_ATTR_S3_ENTITY_TAG;
+  key.buffer_sz = strlen(key.buffer) + 1;
+  val.buffer = etag;
+  val.buffer_sz = strlen(val.buffer) + 1;
+
+  rc = PVFS_sys_seteattr(*ref, req->credentials, &key, &val, 0, NULL);
+  if (rc < 0) {
+
+  }
+ 
+  /* write out etag response header */
+  apr_table_setn(req->r->headers_out, "ETag", 
+                 apr_pstrcat(req->r->pool, "\"", etag, "\"", NULL));
+
+  key.buffer = (void*)EXT_ATTR_S3_SIZE;
+  key.buffer_sz = strlen(key.buffer) + 1;
+  sprintf(tmp, "%lu", size);
+  val.buffer = tmp;
+  val.buffer_sz = strlen(val.buffer) + 1;
+
+  rc = PVFS_sys_seteattr(*ref, req->credentials, &key, &val, 0, NULL);
+  if (rc < 0) {
+
+  }
+
+  key.buffer = (void*)EXT_ATTR_S3_OWNER_ID;
+  key.buffer_sz = strlen(key.buffer) + 1;
+  val.buffer = apr_pcalloc(req->pool, BUFSIZ);
+  sprintf(val.buffer, "%d", req->credentials->userid);
+  val.buffer_sz = strlen(val.buffer) + 1;
+
+  rc = PVFS_sys_seteattr(*ref, req->credentials, &key, &val, 0, NULL);
+  if (rc < 0) {
+
+  }
+
+  key.buffer = (void*)EXT_ATTR_S3_OWNER_DISPLAY_NAME;
+  key.buffer_sz = strlen(key.buffer) + 1;
+  val.buffer = req->cn;
+  val.buffer_sz = strlen(val.buffer) + 1;
+
+  rc = PVFS_sys_seteattr(*ref, req->credentials, &key, &val, 0, NULL);
+  if (rc < 0) {
+
+  }
+}
+
+static int orangefs_s3_put_object(orangefs_s3_request *req, 
+                                  char *bucket, 
+                                  char *path)
+{
+  PVFS_object_ref ref;
+  PVFS_hint hints = NULL;
+  unsigned char md5[APR_MD5_DIGESTSIZE];
+  size_t size = 0;
+  int rc;
+
+  if (debug_orangefs_s3) {
+    ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
+                 "orangefs_s3_put_object for bucket %s path %s.", bucket, path);
+  }
+
+  PVFS_hint_import_env(&hints);
+
+  rc = orangefs_s3_create_object(req, bucket, path, hints, &ref);
+  if (rc != OK) {
+    return rc;
+  }
+
+  /* now we need to write the PUT/POST data */
+  memset(md5, 0, APR_MD5_DIGESTSIZE);
+  rc = orangefs_s3_write_post_data_ref(req, &ref, hints, &size, md5);
+  if (rc < 0) {
+    ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
+                 "Writing the data of %s%s failed.", bucket, path);
+    return HTTP_INTERNAL_SERVER_ERROR;
+  }
+
+  orangefs_s3_set_object_attrs(req, &ref, 
+    orangefs_s3_bin_to_hex(req->pool, md5, APR_MD5_DIGESTSIZE), size);
+
+  return OK;
+}
+
+static int orangefs_s3_get_object(orangefs_s3_request *req, 
+                                  char *bucket, 
+                                  char *path)
+{
+  char *entry_path;
+  PVFS_sysresp_lookup resp_lookup;
+  PVFS_object_ref *ref;
+  PVFS_hint hints = NULL;
+  PVFS_ds_keyval k, v;
+  PVFS_size bufsize, size = 0, length;
+  PVFS_offset start = 0;
+  char buffer[4096];
+  char buffer2[256];
+  int rc;
+
+  if (debug_orangefs_s3) {
+    ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
+                 "orangefs_s3_get_object for bucket %s path %s.", bucket, path);
+  }
+
+  if (req->params) {
+    apr_array_header_t *arr;
+
+    arr = apr_hash_get(req->params, "acl", APR_HASH_KEY_STRING);
+    if (arr) {
+    }
+
+    arr = apr_hash_get(req->params, "torrent", APR_HASH_KEY_STRING);
+    if (arr) {
+    }
+  }
+
+  entry_path = apr_pstrcat(req->pool, req->conf->pvfs_path, "/", 
+                           bucket, path, NULL);
+
+  memset(&resp_lookup, 0, sizeof(PVFS_sysresp_lookup));
+  rc = PVFS_sys_lookup(req->conf->fsid, entry_path, req->root, 
+                       &resp_lookup, PVFS2_LOOKUP_LINK_NO_FOLLOW, NULL);
+
+  if (rc < 0) {
+    /* no such file */
+    ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
+                 "PVFS_sys_lookup for %s returned %d.", entry_path, rc);
+    return HTTP_NOT_FOUND;
+  }
+
+  ref = &resp_lookup.ref;
+  PVFS_hint_import_env(&hints);
+
+  k.buffer = (void*)EXT_ATTR_S3_ENTITY_TAG;
+  k.buffer_sz = strlen(k.buffer) + 1;
+  v.buffer = buffer;
+  v.buffer_sz = 4096;
+
+  memset(buffer, 0, 4096);
+  rc = PVFS_sys_geteattr(resp_lookup.ref, req->credentials, &k, &v, NULL);
+  if (rc >= 0) {
+    memset(buffer2, 0, 256);
+    memcpy(buffer2, buffer, v.read_sz);
+    apr_table_setn(req->r->headers_out, "ETag", 
+                   apr_pstrcat(req->r->pool, "\"", (char*)buffer2, "\"", 
+                               NULL));
+  }
+
+  /* the object size and stripe come from the file itself */
+  bufsize = orangefs_s3_io_buffer_size(req, ref, &size);
+  if (bufsize < 0) {
+    return HTTP_INTERNAL_SERVER_ERROR;
+  }
+
+  apr_table_setn(req->r->headers_out, "Accept-Ranges", "bytes");
+
+  length = size;
+  rc = orangefs_s3_parse_range(apr_table_get(req->r->headers_in, "Range"),
+                               size, &start, &length);
+  if (rc < 0) {
+    apr_table_setn(req->r->err_headers_out, "Content-Range",
+                   apr_psprintf(req->r->pool, "bytes */%lld", 
+                                (long long)size));
+    return HTTP_RANGE_NOT_SATISFIABLE;
+  } else if (rc > 0) {
+    req->r->status = HTTP_PARTIAL_CONTENT;
+    apr_table_setn(req->r->headers_out, "Content-Range",
+                   apr_psprintf(req->r->pool, "bytes %lld-%lld/%lld", 
+                                (long long)start, 
+                                (long long)(start + length - 1),
+                                (long long)size));
+  }
+  ap_set_content_length(req->r, length);
+
+  /* if it's a HEAD request, return without content */
+  if (strcmp(req->r->method, "HEAD") == 0) {
+    return OK;
+  }
+
+  return orangefs_s3_stream_object(req, ref, hints, bufsize, start, length);
+}
+
+/*
+   Multipart uploads.  Each upload gets a staging directory,
+   <BucketRoot>/.s3-uploads/<bucket>/<upload id>, that holds one file per
+   uploaded part.  Completing the upload copies the listed parts into the
+   object, several chunks at a time, and removes the staging directory.
+ */
+#define S3_UPLOAD_DIR ".s3-uploads"
+#define S3_MULTIPART_MAX_PARTS 10000
+
+/* Returns the first value of query parameter name, or NULL. */
+static const char *orangefs_s3_param(orangefs_s3_request *req, 
+                                     const char *name)
+{
+  apr_array_header_t *arr;
+
+  if (req->params == NULL) {
+    return NULL;
+  }
+  arr = apr_hash_get(req->params, name, APR_HASH_KEY_STRING);
+  if (arr == NULL || arr->nelts < 1) {
+    return NULL;
+  }
+  return ((const char **)arr->elts)[0];
+}
+
+static char *orangefs_s3_upload_path(orangefs_s3_request *req, 
+                                     char *bucket, 
+                                     const char *upload_id)
+{
+  return apr_pstrcat(req->pool, req->conf->pvfs_path, "/", S3_UPLOAD_DIR, 
+                     "/", bucket, "/", upload_id, NULL);
+}
+
+/*
+   Looks up the staging directory of an upload and checks that it belongs
+   to the object at path.
+ */
+static int orangefs_s3_lookup_upload(orangefs_s3_request *req, 
+                                     char *bucket, 
+                                     char *path,
+                                     const char *upload_id,
+                                     PVFS_object_ref *ref)
+{
+  PVFS_sysresp_lookup resp_lookup;
+  PVFS_ds_keyval key, val;
+  int rc;
+
+  if (upload_id == NULL || *upload_id == '\0' || strchr(upload_id, '/')) {
+    return HTTP_NOT_FOUND;
+  }
+
+  memset(&resp_lookup, 0, sizeof(PVFS_sysresp_lookup));
+  rc = PVFS_sys_lookup(req->conf->fsid, 
+                       orangefs_s3_upload_path(req, bucket, upload_id), 
+                       req->credentials, &resp_lookup, 
+                       PVFS2_LOOKUP_LINK_NO_FOLLOW, NULL);
+  if (rc < 0) {
+    return HTTP_NOT_FOUND;
+  }
+
+  key.buffer = (void*)EXT_ATTR_S3_UPLOAD_KEY;
+  key.buffer_sz = strlen(key.buffer) + 1;
+  val.buffer = apr_pcalloc(req->pool, PVFS_NAME_MAX + 1);
+  val.buffer_sz = PVFS_NAME_MAX;
+  rc = PVFS_sys_geteattr(resp_lookup.ref, req->credentials, &key, &val, NULL);
+  if (rc < 0 || strcmp((char*)val.buffer, path) != 0) {
+    return HTTP_NOT_FOUND;
+  }
+
+  *ref = resp_lookup.ref;
+  return OK;
+}
+
+/* Removes all the part files of an upload and its staging directory. */
+static void orangefs_s3_remove_upload(orangefs_s3_request *req, 
+                                      char *bucket, 
+                                      const char *upload_id,
+                                      PVFS_object_ref *ref)
+{
+  PVFS_sysresp_lookup resp_lookup;
+  PVFS_sysresp_readdir resp_readdir;
+  PVFS_ds_position token = PVFS_READDIR_START;
+  char *parent_path;
+  int rc, i;
+
+  do {
+    memset(&resp_readdir, 0, sizeof(PVFS_sysresp_readdir));
+    rc = PVFS_sys_readdir(*ref, token, 60, req->credentials, 
+                          &resp_readdir, NULL);
+    if (rc < 0) {
+      ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
+                   "PVFS_sys_readdir returned %d.", rc);
+      return;
+    }
+    for (i = 0; i < resp_readdir.pvfs_dirent_outcount; i++) {
+      rc = PVFS_sys_remove(resp_readdir.dirent_array[i].d_name, *ref, 
+                           req->credentials, NULL);
+      if (rc < 0) {
+        break;
+      }
+    }
+    if (rc < 0) {
+      /* the entry would come back on every pass; leave the upload */
+      ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
+                   "Unable to remove part %s of upload %s: %d.", 
+                   resp_readdir.dirent_array[i].d_name, upload_id, rc);
+      free(resp_readdir.dirent_array);
+      return;
+    }
+    if (resp_readdir.dirent_array) {
+      free(resp_readdir.dirent_array);
+    }
+    /* the entries are gone, so always restart from the beginning */
+  } while (resp_readdir.pvfs_dirent_outcount > 0);
+
+  parent_path = apr_pstrcat(req->pool, req->conf->pvfs_path, "/", 
+                            S3_UPLOAD_DIR, "/", bucket, NULL);
+  memset(&resp_lookup, 0, sizeof(PVFS_sysresp_lookup));
+  rc = PVFS_sys_lookup(req->conf->fsid, parent_path, req->credentials, 
+                       &resp_lookup, PVFS2_LOOKUP_LINK_NO_FOLLOW, NULL);
+  if (rc == 0) {
+    rc = PVFS_sys_remove((char*)upload_id, resp_lookup.ref, 
+                         req->credentials, NULL);
+  }
+  if (rc < 0) {
+    ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
+                 "Unable to remove upload %s: %d.", upload_id, rc);
+  }
+}
+
+/* POST /object?uploads */
+static int orangefs_s3_initiate_multipart(orangefs_s3_request *req, 
+                                          char *bucket, 
+                                          char *path)
+{
+  unsigned char id[16];
+  char *upload_id;
+  PVFS_object_ref *ref;
+  PVFS_ds_keyval key, val;
+  int rc;
+
+  if (debug_orangefs_s3) {
+    ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
+                 "orangefs_s3_initiate_multipart for bucket %s path %s.", 
+                 bucket, path);
+  }
+
+  if (apr_generate_random_bytes(id, sizeof(id)) != APR_SUCCESS) {
+    return HTTP_INTERNAL_SERVER_ERROR;
+  }
+  upload_id = orangefs_s3_bin_to_hex(req->pool, id, sizeof(id));
+
+  ref = orangefs_s3_mkdir_p(req, req->conf->fsid, 
+                            orangefs_s3_upload_path(req, bucket, upload_id));
+  if (ref == NULL) {
+    return HTTP_INTERNAL_SERVER_ERROR;
   }
 
-  key.buffer = (void*)EXT_ATTR_S3_OWNER_DISPLAY_NAME;
+  key.buffer = (void*)EXT_ATTR_S3_UPLOAD_KEY;
   key.buffer_sz = strlen(key.buffer) + 1;
-  val.buffer = req->cn;
-  val.buffer_sz = strlen(val.buffer) + 1;
-
-  rc = PVFS_sys_seteattr(mkdir_response.ref, req->credentials, 
-                         &key, &val, 0, NULL);
+  val.buffer = path;
+  val.buffer_sz = strlen(path) + 1;
+  rc = PVFS_sys_seteattr(*ref, req->credentials, &key, &val, 0, NULL);
   if (rc < 0) {
     ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
-                 "PVFS_sys_seteattr() for owner display name returned rc %d.", 
-                 rc);
+                 "PVFS_sys_seteattr() for upload key returned rc %d.", rc);
+    return HTTP_INTERNAL_SERVER_ERROR;
   }
 
-  rc = PVFS_sys_lookup(fsid, path, req->credentials, resp_lookup, 
-                       PVFS2_LOOKUP_LINK_NO_FOLLOW, NULL);
-  if (rc == 0) {
-    return &resp_lookup->ref;
-  }
+  ap_rprintf(req->r, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>");
+  ap_rprintf(req->r, "<InitiateMultipartUploadResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">");
+  ap_rprintf(req->r,   "<Bucket>%s</Bucket>", bucket);
+  ap_rprintf(req->r,   "<Key>%s</Key>", path + 1);
+  ap_rprintf(req->r,   "<UploadId>%s</UploadId>", upload_id);
+  ap_rprintf(req->r, "</InitiateMultipartUploadResult>");
 
-  return NULL;
+  return OK;
 }
 
-static int orangefs_s3_put_object(orangefs_s3_request *req, 
-                                  char *bucket, 
-                                  char *path)
+/* PUT /object?partNumber=N&uploadId=ID */
+static int orangefs_s3_upload_part(orangefs_s3_request *req, 
+                                   char *bucket, 
+                                   char *path,
+                                   const char *upload_id,
+                                   int part_number)
 {
-  char *entry_name, *parent_path, *entry_path;
-  PVFS_sysresp_lookup resp_lookup;
+  PVFS_object_ref upload_ref;
   PVFS_sysresp_create resp_create;
-  PVFS_object_ref *parent_ref;
-  PVFS_object_ref *ref;
-  PVFS_ds_keyval key, val;
-  PVFS_sys_dist *new_dist = NULL;
   PVFS_sys_attr attr;
   PVFS_hint hints = NULL;
   unsigned char md5[APR_MD5_DIGESTSIZE];
-  char tmp[1024];
+  PVFS_ds_keyval key, val;
+  char *part_name, *etag;
   size_t size = 0;
-  char *ptr;
-  int rc, i;
+  int rc;
 
   if (debug_orangefs_s3) {
     ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
-                 "orangefs_s3_put_object for bucket %s path %s.", bucket, path);
+                 "orangefs_s3_upload_part %d of upload %s.", 
+                 part_number, upload_id);
   }
 
-  PVFS_hint_import_env(&hints);
+  if (part_number < 1 || part_number > S3_MULTIPART_MAX_PARTS) {
+    return HTTP_BAD_REQUEST;
+  }
 
-  entry_path = apr_pstrcat(req->pool, req->conf->pvfs_path, "/", 
-                           bucket, path, NULL);
+  rc = orangefs_s3_lookup_upload(req, bucket, path, upload_id, &upload_ref);
+  if (rc != OK) {
+    return rc;
+  }
 
-  memset(&resp_lookup, 0, sizeof(PVFS_sysresp_lookup));
-  rc = PVFS_sys_lookup(req->conf->fsid, entry_path, req->credentials, 
-                       &resp_lookup, PVFS2_LOOKUP_LINK_NO_FOLLOW, NULL);
-  if (rc == 0) {
-    /* file already exists */
-    ref = &resp_lookup.ref;
-  } else {
-    /* does not exist, need to create it */
-    entry_name = apr_pstrdup(req->pool, path);
-    entry_name++;
-
-    /* fill out our attr */
-    attr.owner = req->credentials->userid;
-    attr.group = req->credentials->group_array[0];
-    attr.perms = 256;
-    attr.mask = (PVFS_ATTR_SYS_ALL_SETABLE);
-    attr.dfile_count = 0;
-
-    parent_path = 
-      apr_pstrcat(req->pool, req->conf->pvfs_path, "/", bucket, NULL);
-
-    /* walk backwards from the end to find the last '/' */
-    for (ptr = path + strlen(path) -1; (ptr > path) && (*ptr != '/'); ptr--);
-
-    if (ptr > path) {
-      entry_name = apr_pstrdup(req->pool, ptr + 1);
-      parent_path = apr_pstrcat(req->pool, parent_path, 
-                                apr_pstrndup(req->pool, path, 
-                                (ptr - path)), NULL);
-    } else {
-      entry_name = apr_pstrdup(req->pool, path + 1);
-    }
-    
-    parent_ref = orangefs_s3_mkdir_p(req, req->conf->fsid, parent_path);
-    if (parent_ref == NULL) {
-      ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
-                   "Unable to get or create parent directory %s", parent_path);
-      return HTTP_INTERNAL_SERVER_ERROR;
-    }
+  PVFS_hint_import_env(&hints);
 
-    /* need to create the entry */
-    rc = PVFS_sys_create(entry_name, *parent_ref, attr, req->credentials, 
-                         new_dist, &resp_create, NULL, hints);
-    if (rc < 0) {
-      ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
-                   "PVFS_sys_create returned %d.", rc);
-      return HTTP_INTERNAL_SERVER_ERROR;
-    }
+  /* a part uploaded again replaces the earlier one */
+  part_name = apr_psprintf(req->pool, "part.%05d", part_number);
+  PVFS_sys_remove(part_name, upload_ref, req->credentials, NULL);
+
+  attr.owner = req->credentials->userid;
+  attr.group = req->credentials->group_array[0];
+  attr.perms = 384;
+  attr.mask = (PVFS_ATTR_SYS_ALL_SETABLE);
+  attr.dfile_count = 0;
 
-    ref = &resp_create.ref;
+  rc = PVFS_sys_create(part_name, upload_ref, attr, req->credentials, 
+                       NULL, &resp_create, NULL, hints);
+  if (rc < 0) {
+    ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
+                 "PVFS_sys_create returned %d.", rc);
+    return HTTP_INTERNAL_SERVER_ERROR;
   }
 
-  /* now we need to write the PUT/POST data */
   memset(md5, 0, APR_MD5_DIGESTSIZE);
-  rc = orangefs_s3_write_post_data_ref(req, ref, hints, &size, md5);
-
-  /* convert md5sum to hex string */
-  {
-    char hexval[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 
-                        'a', 'b', 'c', 'd', 'e', 'f' };
-  
-    memset(tmp, 0, APR_MD5_DIGESTSIZE*2+1); 
-    for (i = 0; i < APR_MD5_DIGESTSIZE; i++) {
-      tmp[i*2] = hexval[(md5[i] >> 4) & 0xf];
-      tmp[(i*2)+1] = hexval[md5[i] & 0x0f];
-    }
+  rc = orangefs_s3_write_post_data_ref(req, &resp_create.ref, hints, 
+                                       &size, md5);
+  if (rc < 0) {
+    return HTTP_INTERNAL_SERVER_ERROR;
   }
 
+  etag = orangefs_s3_bin_to_hex(req->pool, md5, APR_MD5_DIGESTSIZE);
   key.buffer = (void*)EXT_ATTR_S3_ENTITY_TAG;
   key.buffer_sz = strlen(key.buffer) + 1;
-  val.buffer = tmp;
-  val.buffer_sz = strlen(val.buffer) + 1;
-
-  rc = PVFS_sys_seteattr(*ref, req->credentials, &key, &val, 0, NULL);
+  val.buffer = etag;
+  val.buffer_sz = strlen(etag) + 1;
+  rc = PVFS_sys_seteattr(resp_create.ref, req->credentials, &key, &val, 
+                         0, NULL);
   if (rc < 0) {
-
+    return HTTP_INTERNAL_SERVER_ERROR;
   }
- 
-  /* write out etag response header */
+
   apr_table_setn(req->r->headers_out, "ETag", 
-                 apr_pstrcat(req->pool, "\"", tmp, "\"", NULL));
+                 apr_pstrcat(req->r->pool, "\"", etag, "\"", NULL));
 
-  key.buffer = (void*)EXT_ATTR_S3_SIZE;
-  key.buffer_sz = strlen(key.buffer) + 1;
-  sprintf(tmp, "%lu", size);
-  val.buffer = tmp;
-  val.buffer_sz = strlen(val.buffer) + 1;
+  return OK;
+}
 
-  rc = PVFS_sys_seteattr(*ref, req->credentials, &key, &val, 0, NULL);
-  if (rc < 0) {
+/*
+   Reads the part numbers, in order, out of a CompleteMultipartUpload
+   request body.
+ */
+static apr_array_header_t *orangefs_s3_parse_part_list(orangefs_s3_request *req,
+                                                       char *data, 
+                                                       apr_size_t sz)
+{
+  apr_array_header_t *parts;
+  xmlTextReaderPtr reader;
+  const xmlChar *name;
+  xmlChar *value;
+  int in_part_number = 0;
+  int rc;
 
+  parts = apr_array_make(req->pool, 16, sizeof(int));
+
+  reader = xmlReaderForMemory(data, (int)sz, NULL, NULL, 0);
+  if (reader == NULL) {
+    return NULL;
   }
 
-  key.buffer = (void*)EXT_ATTR_S3_OWNER_ID;
-  key.buffer_sz = strlen(key.buffer) + 1;
-  val.buffer = apr_pcalloc(req->pool, BUFSIZ);
-  sprintf(val.buffer, "%d", req->credentials->userid);
-  val.buffer_sz = strlen(val.buffer) + 1;
+  while ((rc = xmlTextReaderRead(reader)) == 1) {
+    name = xmlTextReaderConstLocalName(reader);
+    switch (xmlTextReaderNodeType(reader)) {
+    case XML_READER_TYPE_ELEMENT:
+      in_part_number = (name && xmlStrcmp(name, BAD_CAST "PartNumber") == 0);
+      break;
+    case XML_READER_TYPE_TEXT:
+      if (in_part_number) {
+        value = xmlTextReaderValue(reader);
+        *(int*)apr_array_push(parts) = atoi((char*)value);
+        xmlFree(value);
+      }
+      break;
+    case XML_READER_TYPE_END_ELEMENT:
+      in_part_number = 0;
+      break;
+    default:
+      break;
+    }
+  }
+  xmlFreeTextReader(reader);
 
-  rc = PVFS_sys_seteattr(*ref, req->credentials, &key, &val, 0, NULL);
-  if (rc < 0) {
+  return (rc == 0) ? parts : NULL;
+}
 
-  }
+/* a chunk of a part being copied into the completed object */
+typedef struct {
+  PVFS_object_ref src;
+  PVFS_offset src_offset;
+  orangefs_s3_io io;
+} orangefs_s3_copy;
 
-  key.buffer = (void*)EXT_ATTR_S3_OWNER_DISPLAY_NAME;
-  key.buffer_sz = strlen(key.buffer) + 1;
-  val.buffer = req->cn;
-  val.buffer_sz = strlen(val.buffer) + 1;
+/*
+   Copies a batch of up to S3_MULTIPART_PARALLEL chunks into dst.  Each
+   slot holds the part and offset to read from and, in io.offset, where
+   the chunk goes in dst.  All the reads are posted together, then all
+   the writes, so every server of the file is kept busy.
+ */
+static int orangefs_s3_copy_chunks(orangefs_s3_request *req,
+                                   PVFS_object_ref *dst,
+                                   PVFS_hint hints,
+                                   orangefs_s3_copy *slots,
+                                   int count)
+{
+  int rc = 0, i;
 
-  rc = PVFS_sys_seteattr(*ref, req->credentials, &key, &val, 0, NULL);
+  for (i = 0; i < count; i++) {
+    PVFS_offset dst_offset = slots[i].io.offset;
+
+    slots[i].io.offset = slots[i].src_offset;
+    if (orangefs_s3_io_post(req, &slots[i].src, &slots[i].io, 
+                            PVFS_IO_READ, hints) < 0) {
+      rc = -1;
+    }
+    slots[i].io.offset = dst_offset;
+  }
+  for (i = 0; i < count; i++) {
+    if (orangefs_s3_io_wait(&slots[i].io) < 0 ||
+        slots[i].io.resp_io.total_completed != slots[i].io.len) {
+      rc = -1;
+    }
+  }
   if (rc < 0) {
+    return rc;
+  }
 
+  for (i = 0; i < count; i++) {
+    if (orangefs_s3_io_post(req, dst, &slots[i].io, PVFS_IO_WRITE, 
+                            hints) < 0) {
+      rc = -1;
+    }
+  }
+  for (i = 0; i < count; i++) {
+    if (orangefs_s3_io_wait(&slots[i].io) < 0) {
+      rc = -1;
+    }
   }
 
-  return OK;
+  return rc;
 }
 
-static int orangefs_s3_get_object(orangefs_s3_request *req, 
-                                  char *bucket, 
-                                  char *path)
+/* POST /object?uploadId=ID */
+static int orangefs_s3_complete_multipart(orangefs_s3_request *req, 
+                                          char *bucket, 
+                                          char *path,
+                                          const char *upload_id)
 {
-  char *entry_path;
+  PVFS_object_ref upload_ref, ref;
   PVFS_sysresp_lookup resp_lookup;
-  PVFS_Request mem_req, file_req;
-  PVFS_sysresp_io resp_io;
-  PVFS_object_ref *ref;
+  PVFS_sysresp_getattr resp_getattr;
+  PVFS_ds_keyval key, val;
   PVFS_hint hints = NULL;
-  PVFS_ds_keyval k, v;
-  char buffer[4096];
-  char buffer2[256];
-  size_t offset = 0;
-  int rc;
+  PVFS_size bufsize, part_size;
+  PVFS_offset offset = 0, part_offset;
+  apr_array_header_t *parts;
+  orangefs_s3_copy *slots;
+  apr_md5_ctx_t md5_ctx;
+  unsigned char md5[APR_MD5_DIGESTSIZE];
+  unsigned char part_md5[APR_MD5_DIGESTSIZE];
+  char *data, *part_name, *etag;
+  apr_size_t sz;
+  int count = 0;
+  int rc, i, j;
 
   if (debug_orangefs_s3) {
     ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
-                 "orangefs_s3_get_object for bucket %s path %s.", bucket, path);
+                 "orangefs_s3_complete_multipart of upload %s.", upload_id);
   }
 
-  if (req->params) {
-    apr_array_header_t *arr;
-
-    arr = apr_hash_get(req->params, "acl", APR_HASH_KEY_STRING);
-    if (arr) {
-    }
-
-    arr = apr_hash_get(req->params, "torrent", APR_HASH_KEY_STRING);
-    if (arr) {
-    }
+  rc = orangefs_s3_lookup_upload(req, bucket, path, upload_id, &upload_ref);
+  if (rc != OK) {
+    return rc;
   }
 
-  entry_path = apr_pstrcat(req->pool, req->conf->pvfs_path, "/", 
-                           bucket, path, NULL);
-
-  memset(&resp_lookup, 0, sizeof(PVFS_sysresp_lookup));
-  rc = PVFS_sys_lookup(req->conf->fsid, entry_path, req->root, 
-                       &resp_lookup, PVFS2_LOOKUP_LINK_NO_FOLLOW, NULL);
-
-  if (rc < 0) {
-    /* no such file */
-    ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
-                 "PVFS_sys_lookup for %s returned %d.", entry_path, rc);
-    return HTTP_NOT_FOUND;
+  if (!orangefs_s3_load_post_data(req->r, &data, &sz) || data == NULL) {
+    return HTTP_BAD_REQUEST;
+  }
+  parts = orangefs_s3_parse_part_list(req, data, sz);
+  if (parts == NULL || parts->nelts < 1) {
+    return HTTP_BAD_REQUEST;
+  }
+  for (i = 1; i < parts->nelts; i++) {
+    if (((int*)parts->elts)[i] <= ((int*)parts->elts)[i - 1]) {
+      /* InvalidPartOrder */
+      return HTTP_BAD_REQUEST;
+    }
   }
 
-  ref = &resp_lookup.ref;
   PVFS_hint_import_env(&hints);
 
-  k.buffer = (void*)EXT_ATTR_S3_SIZE;
-  k.buffer_sz = strlen(k.buffer) + 1;
-  v.buffer = buffer;
-  v.buffer_sz = 4096;
-
-  memset(buffer, 0, 4096);
-  rc = PVFS_sys_geteattr(resp_lookup.ref, req->credentials, &k, &v, NULL);
-  if (rc >= 0) {
-    memset(buffer2, 0, 256);
-    memcpy(buffer2, buffer, v.read_sz);
-    apr_table_setn(req->r->headers_out, "Content-Length", 
-                   apr_pstrdup(req->pool, (char*)buffer2));
+  rc = orangefs_s3_create_object(req, bucket, path, hints, &ref);
+  if (rc != OK) {
+    return rc;
   }
-
-  k.buffer = (void*)EXT_ATTR_S3_ENTITY_TAG;
-  k.buffer_sz = strlen(k.buffer) + 1;
-  v.buffer = buffer;
-  v.buffer_sz = 4096;
-
-  memset(buffer, 0, 4096);
-  rc = PVFS_sys_geteattr(resp_lookup.ref, req->credentials, &k, &v, NULL);
-  if (rc >= 0) {
-    memset(buffer2, 0, 256);
-    memcpy(buffer2, buffer, v.read_sz);
-    apr_table_setn(req->r->headers_out, "ETag", 
-                   apr_pstrcat(req->pool, "\"", (char*)buffer2, "\"", NULL));
+  bufsize = orangefs_s3_io_buffer_size(req, &ref, NULL);
+  if (bufsize < 0) {
+    return HTTP_INTERNAL_SERVER_ERROR;
   }
 
-  /* if it's a HEAD request, return without content */
-  if (strcmp(req->r->method, "HEAD") == 0) {
-    return OK;
+  slots = apr_pcalloc(req->pool, 
+                      S3_MULTIPART_PARALLEL * sizeof(orangefs_s3_copy));
+  for (i = 0; i < S3_MULTIPART_PARALLEL; i++) {
+    slots[i].io.buffer = apr_palloc(req->pool, bufsize);
   }
 
-  do {
-    file_req = PVFS_BYTE;
-    rc = PVFS_Request_contiguous(4096, PVFS_BYTE, &mem_req);
+  /* the entity tag of a multipart object is the MD5 of the part MD5s */
+  apr_md5_init(&md5_ctx);
+
+  for (i = 0; i < parts->nelts; i++) {
+    part_name = apr_psprintf(req->pool, "%s/part.%05d", 
+                             orangefs_s3_upload_path(req, bucket, upload_id),
+                             ((int*)parts->elts)[i]);
+    memset(&resp_lookup, 0, sizeof(PVFS_sysresp_lookup));
+    rc = PVFS_sys_lookup(req->conf->fsid, part_name, req->credentials, 
+                         &resp_lookup, PVFS2_LOOKUP_LINK_NO_FOLLOW, NULL);
     if (rc < 0) {
+      /* InvalidPart */
       ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
-                   "PVFS_Request_contiguous returned rc %d.", rc);
-      return HTTP_INTERNAL_SERVER_ERROR;
+                   "Part %s of upload %s is missing.", part_name, upload_id);
+      return HTTP_BAD_REQUEST;
     }
 
-    rc = PVFS_sys_read(*ref, file_req, offset, buffer, mem_req, 
-                       req->credentials, &resp_io, hints);
+    memset(&resp_getattr, 0, sizeof(PVFS_sysresp_getattr));
+    rc = PVFS_sys_getattr(resp_lookup.ref, PVFS_ATTR_SYS_SIZE, 
+                          req->credentials, &resp_getattr, NULL);
     if (rc < 0) {
-      ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
-                   "PVFS_sys_read returned rc %d.", rc);
       return HTTP_INTERNAL_SERVER_ERROR;
     }
+    part_size = resp_getattr.attr.size;
+    PVFS_util_release_sys_attr(&resp_getattr.attr);
+
+    key.buffer = (void*)EXT_ATTR_S3_ENTITY_TAG;
+    key.buffer_sz = strlen(key.buffer) + 1;
+    val.buffer = apr_pcalloc(req->pool, 64);
+    val.buffer_sz = 63;
+    rc = PVFS_sys_geteattr(resp_lookup.ref, req->credentials, &key, &val, 
+                           NULL);
+    if (rc < 0 || strlen((char*)val.buffer) != APR_MD5_DIGESTSIZE * 2) {
+      return HTTP_INTERNAL_SERVER_ERROR;
+    }
+    for (j = 0; j < APR_MD5_DIGESTSIZE; j++) {
+      char hex[3] = { ((char*)val.buffer)[j*2], 
+                      ((char*)val.buffer)[j*2 + 1], '\0' };
+      part_md5[j] = (unsigned char)strtol(hex, NULL, 16);
+    }
+    apr_md5_update(&md5_ctx, part_md5, APR_MD5_DIGESTSIZE);
+
+    /* queue the chunks of this part */
+    for (part_offset = 0; part_offset < part_size; part_offset += bufsize) {
+      slots[count].src = resp_lookup.ref;
+      slots[count].src_offset = part_offset;
+      slots[count].io.offset = offset + part_offset;
+      slots[count].io.len = (part_size - part_offset < bufsize) ?
+                            part_size - part_offset : bufsize;
+      if (++count == S3_MULTIPART_PARALLEL) {
+        if (orangefs_s3_copy_chunks(req, &ref, hints, slots, count) < 0) {
+          return HTTP_INTERNAL_SERVER_ERROR;
+        }
+        count = 0;
+      }
+    }
+    offset += part_size;
+  }
+  if (count > 0 && 
+      orangefs_s3_copy_chunks(req, &ref, hints, slots, count) < 0) {
+    return HTTP_INTERNAL_SERVER_ERROR;
+  }
+
+  apr_md5_final(md5, &md5_ctx);
+  etag = apr_psprintf(req->pool, "%s-%d", 
+                      orangefs_s3_bin_to_hex(req->pool, md5, 
+                                             APR_MD5_DIGESTSIZE), 
+                      parts->nelts);
+  orangefs_s3_set_object_attrs(req, &ref, etag, (size_t)offset);
+
+  orangefs_s3_remove_upload(req, bucket, upload_id, &upload_ref);
+
+  ap_rprintf(req->r, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>");
+  ap_rprintf(req->r, "<CompleteMultipartUploadResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">");
+  ap_rprintf(req->r,   "<Location>http://%s%s</Location>", 
+             req->r->hostname, req->r->uri);
+  ap_rprintf(req->r,   "<Bucket>%s</Bucket>", bucket);
+  ap_rprintf(req->r,   "<Key>%s</Key>", path + 1);
+  ap_rprintf(req->r,   "<ETag>\"%s\"</ETag>", etag);
+  ap_rprintf(req->r, "</CompleteMultipartUploadResult>");
+
+  return OK;
+}
+
+/* DELETE /object?uploadId=ID */
+static int orangefs_s3_abort_multipart(orangefs_s3_request *req, 
+                                       char *bucket, 
+                                       char *path,
+                                       const char *upload_id)
+{
+  PVFS_object_ref upload_ref;
+  int rc;
 
-    offset += resp_io.total_completed;
+  if (debug_orangefs_s3) {
+    ap_log_error(APLOG_MARK,APLOG_ERR,0,NULL, 
+                 "orangefs_s3_abort_multipart of upload %s.", upload_id);
+  }
 
-    ap_rwrite(buffer, resp_io.total_completed, req->r);
-  } while (resp_io.total_completed > 0);
+  rc = orangefs_s3_lookup_upload(req, bucket, path, upload_id, &upload_ref);
+  if (rc != OK) {
+    return rc;
+  }
 
-  PVFS_Request_free(&mem_req);
+  orangefs_s3_remove_upload(req, bucket, upload_id, &upload_ref);
 
   return OK;
 }
 
+/*
+   Handles the multipart upload requests on an object.  Returns DECLINED
+   if the request is not part of a multipart upload.
+ */
+static int orangefs_s3_multipart(orangefs_s3_request *req, 
+                                 char *bucket, 
+                                 char *path)
+{
+  const char *upload_id = orangefs_s3_param(req, "uploadId");
+  const char *part_number = orangefs_s3_param(req, "partNumber");
+
+  if (req->r->method_number == M_POST) {
+    if (orangefs_s3_param(req, "uploads")) {
+      return orangefs_s3_initiate_multipart(req, bucket, path);
+    } else if (upload_id) {
+      return orangefs_s3_complete_multipart(req, bucket, path, upload_id);
+    }
+  } else if (req->r->method_number == M_PUT && upload_id && part_number) {
+    return orangefs_s3_upload_part(req, bucket, path, upload_id, 
+                                   atoi(part_number));
+  } else if (req->r->method_number == M_DELETE && upload_id) {
+    return orangefs_s3_abort_multipart(req, bucket, path, upload_id);
+  }
+
+  return DECLINED;
+}
+
 static int orangefs_s3_get_bucket_acl(orangefs_s3_request *req, char *bucket)
 {
   if (debug_orangefs_s3) {
@@ -1580,6 +2494,12 @@ static int orangefs_s3_get_service(orangefs_s3_request *req)
 
   for (i = 0; i < resp_readdir.pvfs_dirent_outcount; i++) {
     char *name = resp_readdir.dirent_array[i].d_name;
+
+    /* skip internal directories, such as the multipart upload staging */
+    if (name[0] == '.') {
+      continue;
+    }
+
     entry.fs_id = req->conf->fsid;
     entry.handle = resp_readdir.dirent_array[i].handle; 
 
@@ -1699,7 +2619,10 @@ static int orangefs_s3(orangefs_s3_request *req)
                      "Processing s3 object request for bucket %s, object %s.", 
                      bucket, path);
 
-        if (req->r->method_number == M_GET) {
+        rc = orangefs_s3_multipart(req, bucket, path);
+        if (rc != DECLINED) {
+          /* multipart upload request, handled */
+        } else if (req->r->method_number == M_GET) {
           rc = orangefs_s3_get_object(req, bucket, path);
         } else if (req->r->method_number == M_PUT) {
           rc = orangefs_s3_put_object(req, bucket, path);
@@ -1739,7 +2662,10 @@ static int orangefs_s3(orangefs_s3_request *req)
                    "Processing s3 object request for bucket %s, object %s.", 
                    bucket, req->r->uri);
 
-      if (req->r->method_number == M_GET) {
+      rc = orangefs_s3_multipart(req, bucket, req->r->uri);
+      if (rc != DECLINED) {
+        /* multipart upload request, handled */
+      } else if (req->r->method_number == M_GET) {
         rc = orangefs_s3_get_object(req, bucket, req->r->uri);
       } else if (req->r->method_number == M_PUT) {
         /* check if this a PUT/copy or just a PUT by checking the 
@@ -1997,6 +2923,38 @@ static char * orangefs_s3_get_signature_data(request_rec *r)
   }
   data = apr_pstrcat(r->pool, data, r->uri, NULL);
 
+  /* sub-resources, sorted, with their values if any */
+  if (r->args) {
+    static const char *subresources[] = {
+      "acl", "lifecycle", "location", "logging", "notification", 
+      "partNumber", "policy", "requestPayment", "torrent", "uploadId", 
+      "uploads", "versionId", "versioning", "versions", "website", NULL
+    };
+    char *args = apr_pstrdup(r->pool, r->args);
+    char *pair, *last, *eq;
+    char sep = '?';
+    int j;
+
+    for (j = 0; subresources[j]; j++) {
+      strcpy(args, r->args);
+      for (pair = apr_strtok(args, "&", &last); 
+           pair != NULL; 
+           pair = apr_strtok(NULL, "&", &last)) 
+      {
+        eq = strchr(pair, '=');
+        if (eq) {
+          *eq++ = '\0';
+        }
+        if (strcmp(pair, subresources[j]) == 0) {
+          data = apr_pstrcat(r->pool, data, (sep == '?') ? "?" : "&", 
+                             pair, eq ? "=" : "", eq ? eq : "", NULL);
+          sep = '&';
+          break;
+        }
+      }
+    }
+  }
+
   return data;
 }
 
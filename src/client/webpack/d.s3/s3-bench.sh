@@ -0,0 +1,137 @@
+#!/bin/sh
+#
+# (C) 2026 Clemson University and Omnibond Systems, LLC
+#
+# See COPYING in top-level directory.
+#
+# Measures the throughput of the S3 gateway: a single PUT, a full GET,
+# ranged GETs and a multipart upload with parts sent in parallel.
+#
+# usage: s3-bench.sh -u URL -b BUCKET -a ACCESS_ID -s SECRET
+#                    [-m SIZE_MB] [-p PART_MB] [-j JOBS]
+#
+# Requires curl, openssl and dd.  Requests are signed with AWS signature
+# version 2, as the gateway expects.
+
+URL=""
+BUCKET=""
+ACCESS=""
+SECRET=""
+SIZE_MB=256
+PART_MB=16
+JOBS=4
+
+while getopts "u:b:a:s:m:p:j:" opt; do
+  case $opt in
+    u) URL=$OPTARG ;;
+    b) BUCKET=$OPTARG ;;
+    a) ACCESS=$OPTARG ;;
+    s) SECRET=$OPTARG ;;
+    m) SIZE_MB=$OPTARG ;;
+    p) PART_MB=$OPTARG ;;
+    j) JOBS=$OPTARG ;;
+    *) sed -n 9,10p $0; exit 1 ;;
+  esac
+done
+
+if [ -z "$URL" ] || [ -z "$BUCKET" ] || [ -z "$ACCESS" ] || [ -z "$SECRET" ]
+then
+  sed -n 9,10p $0
+  exit 1
+fi
+
+TMP=`mktemp -d /tmp/s3-bench.XXXXXX`
+trap 'rm -rf $TMP' EXIT
+
+# s3 VERB RESOURCE [curl args...]
+# RESOURCE is /bucket/key[?subresource]
+s3() {
+  verb=$1
+  resource=$2
+  shift 2
+  date=`date -u +"%a, %d %b %Y %H:%M:%S GMT"`
+  ctype="application/octet-stream"
+  sig=`printf "%s\n\n%s\n%s\n%s" "$verb" "$ctype" "$date" "$resource" | \
+       openssl dgst -sha1 -hmac "$SECRET" -binary | openssl base64`
+  curl -s -f -X $verb -H "Date: $date" -H "Content-Type: $ctype" \
+       -H "Authorization: AWS $ACCESS:$sig" "$@" "$URL$resource"
+}
+
+now() {
+  date +%s.%N
+}
+
+# report LABEL MB START END
+report() {
+  echo "$1 $2 $3 $4" | \
+    awk '{ t = $4 - $3; printf "%-24s %8.1f MB in %7.3f s  %8.1f MB/s\n", \
+           $1, $2, t, (t > 0) ? $2 / t : 0 }'
+}
+
+echo "creating ${SIZE_MB} MB test object"
+dd if=/dev/urandom of=$TMP/object bs=1048576 count=$SIZE_MB 2>/dev/null
+
+s3 PUT /$BUCKET > /dev/null 2>&1
+
+start=`now`
+s3 PUT /$BUCKET/bench-object -T $TMP/object > /dev/null || exit 1
+end=`now`
+report PUT $SIZE_MB $start $end
+
+start=`now`
+s3 GET /$BUCKET/bench-object -o $TMP/read || exit 1
+end=`now`
+report GET $SIZE_MB $start $end
+cmp -s $TMP/object $TMP/read || echo "GET returned different data"
+
+# ranged reads of PART_MB each, JOBS at a time
+start=`now`
+i=0
+nparts=$((SIZE_MB / PART_MB))
+while [ $i -lt $nparts ]; do
+  first=$((i * PART_MB * 1048576))
+  last=$((first + PART_MB * 1048576 - 1))
+  s3 GET /$BUCKET/bench-object -H "Range: bytes=$first-$last" \
+     -o $TMP/range.$i &
+  i=$((i + 1))
+  if [ $((i % JOBS)) -eq 0 ]; then
+    wait
+  fi
+done
+wait
+end=`now`
+report "GET range x$JOBS" $((nparts * PART_MB)) $start $end
+
+# multipart upload, JOBS parts in flight
+split -b ${PART_MB}m -d -a 5 $TMP/object $TMP/part.
+start=`now`
+upload=`s3 POST "/$BUCKET/bench-multipart?uploads" | \
+        sed -n 's/.*<UploadId>\(.*\)<\/UploadId>.*/\1/p'`
+if [ -z "$upload" ]; then
+  echo "multipart upload could not be started"
+  exit 1
+fi
+n=0
+list=""
+for part in $TMP/part.*; do
+  n=$((n + 1))
+  s3 PUT "/$BUCKET/bench-multipart?partNumber=$n&uploadId=$upload" \
+     -T $part > /dev/null &
+  list="$list<Part><PartNumber>$n</PartNumber></Part>"
+  if [ $((n % JOBS)) -eq 0 ]; then
+    wait
+  fi
+done
+wait
+echo "<CompleteMultipartUpload>$list</CompleteMultipartUpload>" > \
+  $TMP/complete.xml
+s3 POST "/$BUCKET/bench-multipart?uploadId=$upload" \
+   --data-binary @$TMP/complete.xml > /dev/null || exit 1
+end=`now`
+report "multipart x$JOBS" $SIZE_MB $start $end
+
+s3 GET /$BUCKET/bench-multipart -o $TMP/read || exit 1
+cmp -s $TMP/object $TMP/read || echo "multipart object has different data"
+
+s3 DELETE /$BUCKET/bench-object > /dev/null
+s3 DELETE /$BUCKET/bench-multipart > /dev/null
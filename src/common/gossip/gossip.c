@@ -16,6 +16,7 @@
 #include <stdio.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 #ifdef WIN32
@@ -62,6 +63,65 @@ static int internal_syslog_priority = LOG_INFO;
 /* what type of timestamp to put on logs */
 static enum gossip_logstamp internal_logstamp = GOSSIP_LOGSTAMP_DEFAULT;
 
+/* per-thread ring size while async logging is on, 0 otherwise */
+static int gossip_async_size = 0;
+/* how long a full ring waits for the writer; 0 drops at once */
+static int gossip_async_wait_msecs = 0;
+
+#ifdef __GEN_POSIX_LOCKING__
+#include <pthread.h>
+#include <sched.h>
+
+/* Asynchronous debug logging.  Each logging thread formats its message
+ * into a private single-producer ring and returns; one background thread
+ * drains all rings, adds the timestamp prefix, writes and flushes once per
+ * pass.  A message that arrives while its ring is full is dropped and
+ * counted, so logging never blocks the caller.  If the caller asked for
+ * it in gossip_enable_async(), a full ring instead waits a bounded time
+ * for the writer before dropping.  The message body is formatted by the
+ * caller because %s arguments are not guaranteed to outlive the
+ * gossip_debug() call.
+ */
+#define GOSSIP_ASYNC_DEFAULT_SIZE (256 * 1024)
+#define GOSSIP_ASYNC_POLL_MSECS 10
+#define GOSSIP_ASYNC_ALIGN(__n) (((__n) + 7) & ~((uint64_t)7))
+
+struct gossip_async_rec
+{
+    uint32_t size;          /* record bytes, header included */
+    uint32_t len;           /* message bytes following the header */
+    uint64_t ns;            /* CLOCK_REALTIME at the gossip_debug() call */
+    unsigned long tid;
+    char prefix;
+    char is_pad;            /* skip to the end of the ring */
+};
+
+struct gossip_async_ring
+{
+    uint64_t head __attribute__ ((aligned(64)));   /* consumer position */
+    uint64_t tail __attribute__ ((aligned(64)));   /* producer position */
+    uint64_t drops;
+    uint64_t size;          /* power of two */
+    int orphaned;           /* owning thread exited */
+    int posting;            /* owning thread is inside gossip_async_post() */
+    char *buf;
+    struct gossip_async_ring *next;
+};
+
+static int gossip_async_on = 0;
+static pthread_t gossip_async_thread;
+static pthread_key_t gossip_async_key;
+static int gossip_async_key_created = 0;
+static pthread_mutex_t gossip_async_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t gossip_async_cond = PTHREAD_COND_INITIALIZER;
+static struct gossip_async_ring *gossip_async_rings = NULL;
+static uint64_t gossip_async_drops_reported = 0;
+static uint64_t gossip_async_drops_retired = 0;   /* from freed rings */
+
+static int gossip_async_post(char prefix, const char *format, va_list ap);
+static void *gossip_async_thread_fn(void *arg);
+#endif /* __GEN_POSIX_LOCKING__ */
+
 /*****************************************************************
  * prototypes
  */
@@ -70,6 +130,8 @@ static int gossip_disable_file(void);
 
 static int gossip_debug_fp_va(FILE *fp, char prefix, const char *format, va_list ap, enum
 gossip_logstamp ts);
+static int gossip_format_stamp(char *bptr, char prefix, struct timeval *tv,
+    unsigned long tid, enum gossip_logstamp ts);
 static int gossip_debug_syslog(
     char prefix,
     const char *format,
@@ -108,6 +170,7 @@ int gossip_enable_syslog(
     /* keep up with the existing logging settings */
     int tmp_debug_on = gossip_debug_on;
     uint64_t tmp_debug_mask = gossip_debug_mask;
+    int tmp_async_size = gossip_async_size;
 
     /* turn off any running facility */
     gossip_disable();
@@ -120,6 +183,10 @@ int gossip_enable_syslog(
     /* restore the logging settings */
     gossip_debug_on = tmp_debug_on;
     gossip_debug_mask = tmp_debug_mask;
+    if (tmp_async_size)
+    {
+        gossip_enable_async(tmp_async_size, gossip_async_wait_msecs);
+    }
 
     return 0;
 }
@@ -136,6 +203,7 @@ int gossip_enable_stderr(
     /* keep up with the existing logging settings */
     int tmp_debug_on = gossip_debug_on;
     uint64_t tmp_debug_mask = gossip_debug_mask;
+    int tmp_async_size = gossip_async_size;
 
     /* turn off any running facility */
     gossip_disable();
@@ -145,6 +213,10 @@ int gossip_enable_stderr(
     /* restore the logging settings */
     gossip_debug_on = tmp_debug_on;
     gossip_debug_mask = tmp_debug_mask;
+    if (tmp_async_size)
+    {
+        gossip_enable_async(tmp_async_size, gossip_async_wait_msecs);
+    }
 
     return 0;
 }
@@ -163,6 +235,7 @@ int gossip_enable_file(
     /* keep up with the existing logging settings */
     int tmp_debug_on = gossip_debug_on;
     uint64_t tmp_debug_mask = gossip_debug_mask;
+    int tmp_async_size = gossip_async_size;
 
     /* turn off any running facility */
     gossip_disable();
@@ -178,6 +251,10 @@ int gossip_enable_file(
     /* restore the logging settings */
     gossip_debug_on = tmp_debug_on;
     gossip_debug_mask = tmp_debug_mask;
+    if (tmp_async_size)
+    {
+        gossip_enable_async(tmp_async_size, gossip_async_wait_msecs);
+    }
 
     return 0;
 }
@@ -186,16 +263,27 @@ int gossip_reopen_file(
     const char *filename,
     const char *mode)
 {
+    int tmp_async_size = gossip_async_size;
+
     if( gossip_facility != GOSSIP_FILE )
     {
         return -EINVAL;
     }
 
+    /* the async writer must not touch the file while it is swapped;
+     * gossip_enable_file() restarts it
+     */
+    gossip_disable_async();
+
     /* close the file */
     gossip_disable_file();
 
     /* open the file */
     gossip_enable_file( filename, mode );
+    if (tmp_async_size)
+    {
+        gossip_enable_async(tmp_async_size, gossip_async_wait_msecs);
+    }
     return 0;
 }
 
@@ -208,6 +296,9 @@ int gossip_disable(
 {
     int ret = -EINVAL;
 
+    /* drain queued messages while the facility is still open */
+    gossip_disable_async();
+
     switch (gossip_facility)
     {
     case GOSSIP_STDERR:
@@ -276,6 +367,135 @@ int gossip_set_logstamp(
     return(0);
 }
 
+#ifdef __GEN_POSIX_LOCKING__
+static void gossip_async_ring_orphan(void *arg)
+{
+    struct gossip_async_ring *ring = arg;
+
+    __atomic_store_n(&ring->orphaned, 1, __ATOMIC_RELEASE);
+}
+
+/** Moves debug message output to a background thread.  Each logging
+ *  thread gets a private ring of buffer_size bytes (rounded up to a
+ *  power of two; 0 selects a default).  A message that arrives while
+ *  the ring is full is dropped and counted, unless wait_msecs is
+ *  positive, in which case the thread first waits up to that long for
+ *  the writer to make room.  gossip_err() output stays synchronous.
+ *
+ *  \return 0 on success, -errno on failure.
+ */
+int gossip_enable_async(
+    int buffer_size,
+    int wait_msecs)
+{
+    uint64_t size = 4096;
+    int ret;
+
+    if (gossip_async_on)
+    {
+        return 0;
+    }
+
+    if (buffer_size <= 0)
+    {
+        buffer_size = GOSSIP_ASYNC_DEFAULT_SIZE;
+    }
+    /* a ring must hold at least a few maximum-size messages */
+    while (size < (uint64_t) buffer_size || size < 4 * GOSSIP_BUF_SIZE)
+    {
+        size <<= 1;
+    }
+
+    if (!gossip_async_key_created)
+    {
+        ret = pthread_key_create(&gossip_async_key, gossip_async_ring_orphan);
+        if (ret != 0)
+        {
+            return -ret;
+        }
+        gossip_async_key_created = 1;
+    }
+
+    gossip_async_size = (int) size;
+    gossip_async_wait_msecs = (wait_msecs > 0) ? wait_msecs : 0;
+    __atomic_store_n(&gossip_async_on, 1, __ATOMIC_RELEASE);
+
+    ret = pthread_create(&gossip_async_thread, NULL,
+                         gossip_async_thread_fn, NULL);
+    if (ret != 0)
+    {
+        gossip_async_on = 0;
+        gossip_async_size = 0;
+        return -ret;
+    }
+
+    return 0;
+}
+
+/** Stops the background log writer after it has written every queued
+ *  message; later debug messages are written synchronously again.
+ *
+ *  \return 0 on success, -errno on failure.
+ */
+int gossip_disable_async(
+    void)
+{
+    if (!gossip_async_on)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&gossip_async_mutex);
+    __atomic_store_n(&gossip_async_on, 0, __ATOMIC_RELEASE);
+    pthread_cond_signal(&gossip_async_cond);
+    pthread_mutex_unlock(&gossip_async_mutex);
+
+    pthread_join(gossip_async_thread, NULL);
+    gossip_async_size = 0;
+
+    return 0;
+}
+
+/** Returns the number of debug messages dropped because a thread's
+ *  async ring was full.
+ */
+uint64_t gossip_get_async_drops(
+    void)
+{
+    struct gossip_async_ring *ring;
+    uint64_t drops;
+
+    pthread_mutex_lock(&gossip_async_mutex);
+    drops = gossip_async_drops_retired;
+    for (ring = gossip_async_rings; ring; ring = ring->next)
+    {
+        drops += __atomic_load_n(&ring->drops, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&gossip_async_mutex);
+
+    return drops;
+}
+#else
+int gossip_enable_async(
+    int buffer_size,
+    int wait_msecs)
+{
+    return -ENOSYS;
+}
+
+int gossip_disable_async(
+    void)
+{
+    return 0;
+}
+
+uint64_t gossip_get_async_drops(
+    void)
+{
+    return 0;
+}
+#endif /* __GEN_POSIX_LOCKING__ */
+
 #ifndef __GNUC__
 /* __gossip_debug_stub()
  * 
@@ -346,6 +566,18 @@ int __gossip_debug_va(
         prefix = 'D';
     }
 
+#ifdef __GEN_POSIX_LOCKING__
+    if (__atomic_load_n(&gossip_async_on, __ATOMIC_ACQUIRE))
+    {
+        ret = gossip_async_post(prefix, format, ap);
+        if (ret != -EAGAIN)
+        {
+            return ret;
+        }
+        /* async logging was turned off meanwhile; write it here */
+    }
+#endif
+
     switch (gossip_facility)
     {
     case GOSSIP_STDERR:
@@ -520,81 +752,487 @@ static int gossip_debug_fp_va(FILE *fp, char prefix,
     char buffer[GOSSIP_BUF_SIZE], *bptr = buffer;
     int bsize = sizeof(buffer), temp_size;
     int ret = -EINVAL;
-    struct timeval tv;
-    time_t tp;
+    struct timeval tv = {0, 0};
+    unsigned long tid;
+
+    if (ts != GOSSIP_LOGSTAMP_NONE)
+    {
+        gettimeofday(&tv, 0);
+    }
+#ifdef WIN32
+    tid = (unsigned long) GetThreadId(GetCurrentThread());
+#else
+    tid = (unsigned long) gen_thread_self();
+#endif
+
+    temp_size = gossip_format_stamp(bptr, prefix, &tv, tid, ts);
+    bptr += temp_size;
+    bsize -= temp_size;
+    
+#ifndef WIN32
+    ret = vsnprintf(bptr, bsize, format, ap);
+    if (ret < 0)
+    {
+        return -errno;
+    }
+#else
+    ret = vsnprintf_s(bptr, bsize, _TRUNCATE, format, ap);
+    if (ret == -1 && errno != 0)
+    {
+        return -errno;
+    }
+#endif
+
+    ret = fprintf(fp, "%s", buffer);
+    if (ret < 0)
+    {
+        return -errno;
+    }
+    fflush(fp);
+
+    return 0;
+}
+
+/* gossip_format_stamp()
+ *
+ * Writes the "[prefix timestamp] " header of a log line into bptr, which
+ * must have room for at least 64 bytes.
+ *
+ * returns the number of bytes written
+ */
+static int gossip_format_stamp(char *bptr, char prefix, struct timeval *tv,
+    unsigned long tid, enum gossip_logstamp ts)
+{
+    char *start = bptr;
+    time_t tp = tv->tv_sec;
+    struct tm tm;
+
+    /* localtime() rereads the time zone on every call and is not thread
+     * safe; the reentrant form does neither
+     */
+#ifdef WIN32
+    localtime_s(&tm, &tp);
+#else
+    localtime_r(&tp, &tm);
+#endif
 
     sprintf(bptr, "[%c ", prefix);
     bptr += 3;
-    bsize -= 3;
 
     switch(ts)
     {
         case GOSSIP_LOGSTAMP_USEC:
-            gettimeofday(&tv, 0);
-            tp = tv.tv_sec;
-            strftime(bptr, 9, "%H:%M:%S", localtime(&tp));
-            sprintf(bptr+8, ".%06ld] ", (long)tv.tv_usec);
+            strftime(bptr, 9, "%H:%M:%S", &tm);
+            sprintf(bptr+8, ".%06ld] ", (long)tv->tv_usec);
             bptr += 17;
-            bsize -= 17;
             break;
         case GOSSIP_LOGSTAMP_DATETIME:
-            gettimeofday(&tv, 0);
-            tp = tv.tv_sec;
-            strftime(bptr, 22, "%m/%d/%Y %H:%M:%S] ", localtime(&tp));
+            strftime(bptr, 22, "%m/%d/%Y %H:%M:%S] ", &tm);
             bptr += 21;
-            bsize -= 21;
             break;
         case GOSSIP_LOGSTAMP_THREAD:
-            gettimeofday(&tv, 0);
-            tp = tv.tv_sec;
-            strftime(bptr, 9, "%H:%M:%S", localtime(&tp));
+            strftime(bptr, 9, "%H:%M:%S", &tm);
             bptr += 8;
-            bsize -= 8;
 #ifdef WIN32
-            temp_size = sprintf(bptr, ".%03ld (%4ld)] ", (long)tv.tv_usec / 1000,
-                           GetThreadId(GetCurrentThread()));
+            bptr += sprintf(bptr, ".%03ld (%4ld)] ", (long)tv->tv_usec / 1000,
+                            (long)tid);
 #else
-            temp_size = sprintf(bptr, ".%06ld (%ld)] ", (long)tv.tv_usec, 
-                           (long int)gen_thread_self());
+            bptr += sprintf(bptr, ".%06ld (%ld)] ", (long)tv->tv_usec,
+                            (long)tid);
 #endif
-            bptr += temp_size;
-            bsize -= temp_size;
             break;
 
         case GOSSIP_LOGSTAMP_NONE:
             bptr--;
             sprintf(bptr, "] ");
             bptr += 2;
-            bsize++;
             break;
         default:
             break;
     }
-    
-#ifndef WIN32
-    ret = vsnprintf(bptr, bsize, format, ap);
-    if (ret < 0)
+
+    return (int)(bptr - start);
+}
+
+#ifdef __GEN_POSIX_LOCKING__
+/* gossip_async_get_ring()
+ *
+ * returns the calling thread's ring, creating and registering it on first
+ * use, or NULL if it could not be allocated
+ */
+static struct gossip_async_ring *gossip_async_get_ring(void)
+{
+    struct gossip_async_ring *ring;
+    int size;
+
+    ring = pthread_getspecific(gossip_async_key);
+    if (ring)
     {
-        return -errno;
+        return ring;
     }
-#else
-    ret = vsnprintf_s(bptr, bsize, _TRUNCATE, format, ap);
-    if (ret == -1 && errno != 0)
+
+    size = __atomic_load_n(&gossip_async_size, __ATOMIC_ACQUIRE);
+    if (size == 0)
     {
-        return -errno;
+        return NULL;
+    }
+    ring = calloc(1, sizeof(*ring));
+    if (!ring)
+    {
+        return NULL;
+    }
+    ring->size = size;
+    ring->buf = malloc(ring->size);
+    if (!ring->buf)
+    {
+        free(ring);
+        return NULL;
     }
-#endif
 
-    ret = fprintf(fp, "%s", buffer);
-    if (ret < 0)
+    pthread_mutex_lock(&gossip_async_mutex);
+    ring->next = gossip_async_rings;
+    gossip_async_rings = ring;
+    pthread_mutex_unlock(&gossip_async_mutex);
+
+    pthread_setspecific(gossip_async_key, ring);
+    return ring;
+}
+
+/* gossip_async_wait()
+ *
+ * Wakes the writer and waits until ring's consumer position reaches
+ * head, or gossip_async_wait_msecs have passed.
+ *
+ * returns the consumer position last seen
+ */
+static uint64_t gossip_async_wait(struct gossip_async_ring *ring,
+    uint64_t head)
+{
+    struct timespec pause = {0, 20000};
+    struct timespec start, now;
+    uint64_t cur;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (;;)
     {
-        return -errno;
+        pthread_cond_signal(&gossip_async_cond);
+        nanosleep(&pause, NULL);
+
+        cur = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if (cur >= head)
+        {
+            return cur;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if ((now.tv_sec - start.tv_sec) * 1000 +
+            (now.tv_nsec - start.tv_nsec) / 1000000 >=
+            gossip_async_wait_msecs)
+        {
+            return cur;
+        }
+    }
+}
+
+/* gossip_async_post()
+ *
+ * Formats a debug message into the calling thread's ring.  If the ring
+ * is full the message is counted as dropped, after waiting for the
+ * writer first when gossip_async_wait_msecs is set.
+ *
+ * returns 0 once the message is queued or dropped, -EAGAIN if async
+ * logging has been turned off and the caller should write it itself
+ */
+static int gossip_async_post(char prefix, const char *format, va_list ap)
+{
+    struct gossip_async_ring *ring;
+    struct gossip_async_rec *rec;
+    struct timespec now;
+    uint64_t head, tail, off, contig, skip = 0, need;
+    int len;
+
+    ring = gossip_async_get_ring();
+    if (!ring)
+    {
+        return __atomic_load_n(&gossip_async_size, __ATOMIC_ACQUIRE) ?
+            -ENOMEM : -EAGAIN;
     }
-    fflush(fp);
 
+    /* pairs with gossip_async_thread_fn(): either the writer sees this
+     * thread posting and drains after it, or this thread sees async
+     * logging off and writes synchronously
+     */
+    __atomic_store_n(&ring->posting, 1, __ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&gossip_async_on, __ATOMIC_SEQ_CST))
+    {
+        __atomic_store_n(&ring->posting, 0, __ATOMIC_RELEASE);
+        return -EAGAIN;
+    }
+
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    tail = ring->tail;
+    head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    off = tail & (ring->size - 1);
+    contig = ring->size - off;
+
+    /* format straight into the ring when the message fits; the length
+     * is only known afterwards, so reserve room for a maximal message
+     */
+    need = GOSSIP_ASYNC_ALIGN(sizeof(*rec) + GOSSIP_BUF_SIZE);
+    if (contig < need)
+    {
+        skip = contig;
+    }
+    if (tail + skip + need - head > ring->size)
+    {
+        /* wake the writer; it may be sleeping out its poll interval */
+        pthread_cond_signal(&gossip_async_cond);
+        if (gossip_async_wait_msecs > 0)
+        {
+            head = gossip_async_wait(ring, tail + skip + need - ring->size);
+        }
+        if (tail + skip + need - head > ring->size)
+        {
+            __atomic_add_fetch(&ring->drops, 1, __ATOMIC_RELAXED);
+            __atomic_store_n(&ring->posting, 0, __ATOMIC_RELEASE);
+            return 0;
+        }
+    }
+
+    if (skip)
+    {
+        if (contig >= sizeof(*rec))
+        {
+            rec = (struct gossip_async_rec *)(ring->buf + off);
+            rec->size = (uint32_t) contig;
+            rec->is_pad = 1;
+        }
+        tail += skip;
+        off = 0;
+    }
+
+    rec = (struct gossip_async_rec *)(ring->buf + off);
+    len = vsnprintf((char *)(rec + 1), GOSSIP_BUF_SIZE, format, ap);
+    if (len < 0)
+    {
+        len = 0;
+    }
+    else if (len >= GOSSIP_BUF_SIZE)
+    {
+        len = GOSSIP_BUF_SIZE - 1;
+    }
+
+    rec->len = (uint32_t) len;
+    rec->size = (uint32_t) GOSSIP_ASYNC_ALIGN(sizeof(*rec) + len);
+    rec->ns = (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec;
+    rec->tid = (unsigned long) gen_thread_self();
+    rec->prefix = prefix;
+    rec->is_pad = 0;
+
+    __atomic_store_n(&ring->tail, tail + rec->size, __ATOMIC_RELEASE);
+
+    /* wake the writer early rather than wait for its poll interval once
+     * the ring is half full; a lost wakeup only costs latency
+     */
+    if (tail + rec->size - head > ring->size / 2)
+    {
+        pthread_cond_signal(&gossip_async_cond);
+    }
+
+    __atomic_store_n(&ring->posting, 0, __ATOMIC_RELEASE);
     return 0;
 }
 
+/* gossip_async_peek()
+ *
+ * Skips padding and returns the next unread record in ring, or NULL if
+ * the ring is empty.
+ */
+static struct gossip_async_rec *gossip_async_peek(
+    struct gossip_async_ring *ring)
+{
+    struct gossip_async_rec *rec;
+    uint64_t head, tail, off, contig;
+
+    head = ring->head;
+    tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    while (head != tail)
+    {
+        off = head & (ring->size - 1);
+        contig = ring->size - off;
+        rec = (struct gossip_async_rec *)(ring->buf + off);
+        if (contig < sizeof(*rec) || rec->is_pad)
+        {
+            head += contig;
+            __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+            continue;
+        }
+        return rec;
+    }
+
+    return NULL;
+}
+
+/* gossip_async_write()
+ *
+ * Writes one message to the active facility from the background thread.
+ */
+static void gossip_async_write(char prefix, uint64_t ns, unsigned long tid,
+    const char *text, int len)
+{
+    char stamp[128];
+    struct timeval tv;
+    int stamp_len;
+    FILE *fp = (gossip_facility == GOSSIP_FILE) ? internal_log_file : stderr;
+
+    if (gossip_facility == GOSSIP_SYSLOG)
+    {
+        syslog(internal_syslog_priority, "[%c] %.*s", prefix, len, text);
+        return;
+    }
+
+    if (!fp)
+    {
+        return;
+    }
+
+    tv.tv_sec = (time_t)(ns / 1000000000ULL);
+    tv.tv_usec = (long)((ns % 1000000000ULL) / 1000);
+
+    stamp_len = gossip_format_stamp(stamp, prefix, &tv, tid,
+                                    internal_logstamp);
+    fwrite(stamp, 1, stamp_len, fp);
+    fwrite(text, 1, len, fp);
+}
+
+/* gossip_async_drain()
+ *
+ * Writes every queued record, merging the per-thread rings in timestamp
+ * order, and releases rings whose threads have exited.  Called with
+ * gossip_async_mutex held.
+ */
+static void gossip_async_drain(void)
+{
+    struct gossip_async_ring *ring, *oldest_ring, **prev;
+    struct gossip_async_rec *rec, *oldest;
+    struct timespec now;
+    uint64_t drops = gossip_async_drops_retired;
+    char msg[96];
+    int written = 0;
+
+    for (;;)
+    {
+        oldest = NULL;
+        oldest_ring = NULL;
+        for (ring = gossip_async_rings; ring; ring = ring->next)
+        {
+            rec = gossip_async_peek(ring);
+            if (rec && (!oldest || rec->ns < oldest->ns))
+            {
+                oldest = rec;
+                oldest_ring = ring;
+            }
+        }
+        if (!oldest)
+        {
+            break;
+        }
+
+        gossip_async_write(oldest->prefix, oldest->ns, oldest->tid,
+                           (char *)(oldest + 1), (int) oldest->len);
+        __atomic_store_n(&oldest_ring->head,
+                         oldest_ring->head + oldest->size, __ATOMIC_RELEASE);
+        written++;
+    }
+
+    prev = &gossip_async_rings;
+    while ((ring = *prev) != NULL)
+    {
+        drops += __atomic_load_n(&ring->drops, __ATOMIC_RELAXED);
+        if (__atomic_load_n(&ring->orphaned, __ATOMIC_ACQUIRE) &&
+            !gossip_async_peek(ring))
+        {
+            gossip_async_drops_retired += ring->drops;
+            *prev = ring->next;
+            free(ring->buf);
+            free(ring);
+            continue;
+        }
+        prev = &ring->next;
+    }
+
+    if (drops > gossip_async_drops_reported)
+    {
+        clock_gettime(CLOCK_REALTIME, &now);
+        snprintf(msg, sizeof(msg), "gossip: %llu debug messages dropped "
+                 "(async ring full)\n",
+                 (unsigned long long)(drops - gossip_async_drops_reported));
+        gossip_async_drops_reported = drops;
+
+        gossip_async_write('W',
+            (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec,
+            (unsigned long) gen_thread_self(), msg, (int) strlen(msg));
+        written++;
+    }
+
+    if (written && gossip_facility != GOSSIP_SYSLOG)
+    {
+        fflush((gossip_facility == GOSSIP_FILE) ? internal_log_file : stderr);
+    }
+}
+
+/* gossip_async_thread_fn()
+ *
+ * Background writer: drains the rings every GOSSIP_ASYNC_POLL_MSECS until
+ * async logging is disabled, then drains until no thread is still posting
+ * and exits.
+ */
+static void *gossip_async_thread_fn(void *arg)
+{
+    struct gossip_async_ring *ring;
+    struct timespec deadline;
+    int busy;
+
+    pthread_mutex_lock(&gossip_async_mutex);
+    while (__atomic_load_n(&gossip_async_on, __ATOMIC_ACQUIRE))
+    {
+        gossip_async_drain();
+
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += GOSSIP_ASYNC_POLL_MSECS * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&gossip_async_cond, &gossip_async_mutex,
+                               &deadline);
+    }
+
+    /* a thread that saw async logging on may still be filling its ring;
+     * keep draining (it may be waiting for room) until none is
+     */
+    do
+    {
+        gossip_async_drain();
+        busy = 0;
+        for (ring = gossip_async_rings; ring; ring = ring->next)
+        {
+            busy |= __atomic_load_n(&ring->posting, __ATOMIC_SEQ_CST);
+        }
+        if (busy)
+        {
+            sched_yield();
+        }
+    } while (busy);
+    gossip_async_drain();
+    pthread_mutex_unlock(&gossip_async_mutex);
+
+    return NULL;
+}
+#endif /* __GEN_POSIX_LOCKING__ */
+
 /* gossip_err_syslog()
  * 
  * error message function for the syslog logging facility
@@ -95,6 +95,9 @@ int gossip_disable(void);
 int gossip_set_debug_mask(int debug_on, uint64_t mask);
 int gossip_get_debug_mask(int *debug_on, uint64_t *mask);
 int gossip_set_logstamp(enum gossip_logstamp ts);
+int gossip_enable_async(int buffer_size, int wait_msecs);
+int gossip_disable_async(void);
+uint64_t gossip_get_async_drops(void);
 
 void gossip_backtrace(void);
 
@@ -15,6 +15,7 @@
 #include "quickhash.h"
 #include "gen-locks.h"
 #include "pvfs2-internal.h"
+#include "pint-slab.h"
 
 #define DEFAULT_ID_GEN_SAFE_TABLE_SIZE 997
 
@@ -60,7 +61,7 @@ int id_gen_safe_finalize()
     if(s_id_gen_safe_init_count == 0 && ID_GEN_SAFE_INITIALIZED())
     {
         gen_mutex_lock(&s_id_gen_safe_mutex);
-        qhash_destroy_and_finalize(s_id_gen_safe_table, id_gen_safe_t, hash_link, free);
+        qhash_destroy_and_finalize(s_id_gen_safe_table, id_gen_safe_t, hash_link, PINT_slab_free);
         s_id_gen_safe_table = NULL;
         gen_mutex_unlock(&s_id_gen_safe_mutex);
     }
@@ -80,14 +81,14 @@ int id_gen_safe_register(
 	return -EINVAL;
     }
 
-    gen_mutex_lock(&s_id_gen_safe_mutex);
-
-    id_elem = (id_gen_safe_t *)malloc(sizeof(id_gen_safe_t));
+    id_elem = (id_gen_safe_t *)PINT_slab_alloc(sizeof(id_gen_safe_t));
     if (!id_elem)
     {
         return -ENOMEM;
     }
 
+    gen_mutex_lock(&s_id_gen_safe_mutex);
+
     id_elem->id = ++s_id_gen_safe_tag;
     if(id_elem->id == 0)
     {
@@ -147,7 +148,7 @@ int id_gen_safe_unregister(BMI_id_gen_t new_id)
             assert(id_elem);
 
             id_elem->item = NULL;
-            free(id_elem);
+            PINT_slab_free(id_elem);
             ret = 0;
         }
         gen_mutex_unlock(&s_id_gen_safe_mutex);
@@ -26,6 +26,7 @@
 #include "gossip.h"
 #include "quicklist.h"
 #include "gen-locks.h"
+#include "pint-perf-counter.h"
 #include "mmap-ra-cache.h"
 
 static int racache_buf_init(racache_t *racache);
@@ -42,6 +43,10 @@ static int hash_key_compare(const void *key, struct qlist_head *link);
 static void racache_init_buff(racache_buffer_t *buff);
 static void racache_init_file(racache_file_t *file);
 static void racache_buf_cull(racache_t *racache);
+static void racache_file_track(racache_file_t *file,
+                               PVFS_size offset,
+                               PVFS_size len);
+static void racache_count(int key, int64_t value);
 
 /* This represents the entire readahead cache */
 static struct racache_s racache =
@@ -58,7 +63,28 @@ static struct racache_s racache =
     NULL,  /* oldarray */
     0,     /* oldarray_cnt */
     0,     /* oldarray_rem */
-    0      /* oldarray_sz */
+    0,     /* oldarray_sz */
+    NULL,  /* pc */
+    0,     /* hits */
+    0,     /* misses */
+    0,     /* prefetched */
+    0      /* wasted */
+};
+
+static struct PINT_perf_key racache_keys[] =
+{
+    {"RACACHE_HITS", PERF_RACACHE_HITS, 0},
+    {"RACACHE_WAITS", PERF_RACACHE_WAITS, 0},
+    {"RACACHE_MISSES", PERF_RACACHE_MISSES, 0},
+    {"RACACHE_PREFETCHED", PERF_RACACHE_PREFETCHED, 0},
+    {"RACACHE_PREFETCH_USED", PERF_RACACHE_PREFETCH_USED, 0},
+    {"RACACHE_PREFETCH_WASTED", PERF_RACACHE_PREFETCH_WASTED, 0},
+    {"RACACHE_WINDOW_GROW", PERF_RACACHE_WINDOW_GROW, 0},
+    {"RACACHE_WINDOW_SHRINK", PERF_RACACHE_WINDOW_SHRINK, 0},
+    {"RACACHE_STRIDED", PERF_RACACHE_STRIDED, 0},
+    {"RACACHE_HIT_PCT", PERF_RACACHE_HIT_PCT, PINT_PERF_PRESERVE},
+    {"RACACHE_WASTE_PCT", PERF_RACACHE_WASTE_PCT, PINT_PERF_PRESERVE},
+    {NULL, 0, 0},
 };
 
 #define RACACHE_INITIALIZED() (racache.hash_table)
@@ -153,6 +179,18 @@ int pint_racache_initialize(int bufcnt, int bufsz, int readcnt, int pinned)
             return -1;
         }
 
+        /* the client never rolls its counters over, so the totals
+         * run for the life of the client-core
+         */
+        racache.pc = PINT_perf_initialize(PINT_PERF_COUNTER,
+                                          racache_keys,
+                                          NULL);
+        if (!racache.pc)
+        {
+            gossip_err("%s: Error: PINT_perf_initialize failure.\n",
+                       __func__);
+        }
+
         gossip_debug(GOSSIP_RACACHE_DEBUG,
                      "ra_cache_initialized\n");
         ret = 0;
@@ -171,8 +209,14 @@ static void racache_init_file(racache_file_t *file)
 {
     memset(&file->refn, 0, sizeof(PVFS_object_ref));
 
-    /* eventually want a way to pass this in from the file */
+    /* the window starts at the configured read count and adapts
+     * to the stream from there */
     file->readcnt = racache.readcnt;
+    file->last_offset = 0;
+    file->last_end = -1;
+    file->stride = 0;
+    file->strip_size = 0;
+    file->pattern = RACACHE_PATTERN_NONE;
 
     INIT_QLIST_HEAD(&file->hash_link);
     INIT_QLIST_HEAD(&file->buff_list);
@@ -187,6 +231,7 @@ static void racache_init_buff(racache_buffer_t *buff)
     buff->being_freed = 0;
     buff->resizing = 0;
     buff->vfs_cnt = 0;
+    buff->speculative = 0;
     buff->file_offset = 0;
     buff->data_sz = 0;
     buff->file = NULL;
@@ -456,6 +501,17 @@ static racache_buffer_t *racache_buf_get(racache_file_t *racache_file)
         }
         /* remove from prev file's buffer list */
         qlist_del(&buff->buff_link);
+        if (buff->speculative)
+        {
+            /* read ahead and never used - that stream is reading
+             * ahead further than it can consume */
+            racache_count(PERF_RACACHE_PREFETCH_WASTED, 1);
+            if (buff->file && buff->file->readcnt > 1)
+            {
+                buff->file->readcnt /= 2;
+                racache_count(PERF_RACACHE_WINDOW_SHRINK, 1);
+            }
+        }
     }
     else /* can't find a usable buffer */
     {
@@ -525,6 +581,12 @@ int pint_racache_get_block(PVFS_object_ref refn,
                                        hash_link);
             assert(racache_file);
 
+            /* only reads from the vfs say anything about the stream */
+            if (!readahead_speculative)
+            {
+                racache_file_track(racache_file, offset, len);
+            }
+
             /* found the file, now search for a buffer */
             qlist_for_each_entry(buff, &racache_file->buff_list, buff_link)
             {
@@ -534,6 +596,18 @@ int pint_racache_get_block(PVFS_object_ref refn,
                 {
                     /* data in cache - reset lru and set up return */
                     racache_buf_lru(buff);
+                    if (!readahead_speculative)
+                    {
+                        if (buff->speculative)
+                        {
+                            racache_count(PERF_RACACHE_PREFETCH_USED, 1);
+                            buff->speculative = 0;
+                        }
+                        /* readahead from here uses the current window */
+                        buff->readcnt = racache_file->readcnt;
+                        racache_count(buff->valid ? PERF_RACACHE_HITS :
+                                                    PERF_RACACHE_WAITS, 1);
+                    }
                     /* found a matching buffer */
                     if (buff->valid)
                     {
@@ -615,6 +689,15 @@ int pint_racache_get_block(PVFS_object_ref refn,
             }
             buff->file = racache_file;
             buff->file_offset = pint_racache_buff_offset(offset);
+            if (readahead_speculative)
+            {
+                buff->speculative = 1;
+                racache_count(PERF_RACACHE_PREFETCHED, 1);
+            }
+            else
+            {
+                racache_count(PERF_RACACHE_MISSES, 1);
+            }
             gossip_debug(GOSSIP_RACACHE_DEBUG,
                          "racache_get_block offset %llu(%llu) size %llu\n",
                          llu(offset), llu(buff->file_offset),
@@ -661,6 +744,10 @@ int pint_racache_get_block(PVFS_object_ref refn,
             }
             racache_init_file(rcfile);
             rcfile->refn = refn;
+            if (!readahead_speculative)
+            {
+                racache_file_track(rcfile, offset, len);
+            }
             gossip_debug(GOSSIP_RACACHE_DEBUG, "racache_get_block "
                          "adding new file rec to hash table\n");
             qhash_add(racache.hash_table, &refn, &rcfile->hash_link);
@@ -681,6 +768,15 @@ int pint_racache_get_block(PVFS_object_ref refn,
             buff->file = rcfile;
             buff->file_offset = pint_racache_buff_offset(offset);
             buff->data_sz = 0;
+            if (readahead_speculative)
+            {
+                buff->speculative = 1;
+                racache_count(PERF_RACACHE_PREFETCHED, 1);
+            }
+            else
+            {
+                racache_count(PERF_RACACHE_MISSES, 1);
+            }
 
             /* add request to waiting list */
             glink = (gen_link_t *)malloc(sizeof(gen_link_t));
@@ -747,6 +843,11 @@ int pint_racache_flush(PVFS_object_ref refn)
                 qlist_del(&buff->buff_lru);
                 /* clear reference to file record */
                 buff->file = NULL;
+                if (buff->speculative)
+                {
+                    racache_count(PERF_RACACHE_PREFETCH_WASTED, 1);
+                    buff->speculative = 0;
+                }
                 /* check for active requests */
                 if (!buff->valid ||
                     !qlist_empty(&buff->vfs_link))
@@ -870,6 +971,8 @@ int pint_racache_finalize(void)
             free(racache.oldarray);
         }
         racache.hash_table = NULL; /* is this properly freed? */
+        PINT_perf_finalize(racache.pc);
+        racache.pc = NULL;
         gen_mutex_unlock(&racache.mutex);
 
         /* FIXME: race condition here */
@@ -879,6 +982,191 @@ int pint_racache_finalize(void)
     return ret;
 }
 
+PVFS_size pint_racache_ra_offset(racache_buffer_t *buff, int b)
+{
+    racache_file_t *file;
+    PVFS_size window;
+    PVFS_size base;
+    PVFS_size step;
+    PVFS_size end;
+    PVFS_size offset = -1;
+
+    gen_mutex_lock(&racache.mutex);
+    window = buff->readcnt;
+    base = buff->file_offset;
+    step = buff->buff_sz;
+    file = buff->file;
+    if (file)
+    {
+        window = file->readcnt;
+        if (file->pattern == RACACHE_PATTERN_STRIDED)
+        {
+            /* step from the last read by the stride, not by buffers */
+            base = file->last_offset;
+            step = file->stride;
+        }
+        else if (file->strip_size > buff->buff_sz)
+        {
+            /* stretch the window to finish on a strip boundary so the
+             * last readahead does not leave a partial strip behind
+             * for a later small read to fetch from the same server */
+            end = buff->file_offset + window * buff->buff_sz;
+            end += file->strip_size - 1;
+            end -= end % file->strip_size;
+            window = (end - buff->file_offset + buff->buff_sz - 1) /
+                     buff->buff_sz;
+            if (window > PVFS2_MAX_RACACHE_READCNT)
+            {
+                window = PVFS2_MAX_RACACHE_READCNT;
+            }
+        }
+    }
+    if (b < window && base + b * step >= 0)
+    {
+        offset = pint_racache_buff_offset(base + b * step);
+    }
+    gen_mutex_unlock(&racache.mutex);
+    return offset;
+}
+
+void pint_racache_set_strip_size(PVFS_object_ref refn, PVFS_size strip_size)
+{
+    struct qlist_head *hash_link = NULL;
+    racache_file_t *racache_file = NULL;
+
+    if (RACACHE_INITIALIZED())
+    {
+        gen_mutex_lock(&racache.mutex);
+        /* don't create a record - most getattrs are not for files
+         * that are being read through the cache */
+        hash_link = qhash_search(racache.hash_table, &refn);
+        if (hash_link)
+        {
+            racache_file = qhash_entry(hash_link, racache_file_t, hash_link);
+            racache_file->strip_size = strip_size;
+        }
+        gen_mutex_unlock(&racache.mutex);
+    }
+}
+
+struct PINT_perf_counter *pint_racache_get_pc(void)
+{
+    return racache.pc;
+}
+
+/* racache_file_track()
+ *
+ * updates the access stream of a file with a read from the vfs and
+ * adapts its readahead window: reads that carry on where the last
+ * one left off, or repeat the last stride, double the window each
+ * time they move into a new buffer; anything else halves it.
+ * caller holds the racache mutex.
+ */
+static void racache_file_track(racache_file_t *file,
+                               PVFS_size offset,
+                               PVFS_size len)
+{
+    PVFS_size stride;
+    int grow = 0;
+
+    if (file->last_end < 0)
+    {
+        /* first read - nothing to compare against yet */
+        file->last_offset = offset;
+        file->last_end = offset + len;
+        return;
+    }
+
+    stride = offset - file->last_offset;
+    if (offset >= file->last_offset &&
+        offset - file->last_end < racache.bufsz)
+    {
+        /* forward, and close enough that the buffers cover any gap */
+        file->pattern = RACACHE_PATTERN_SEQUENTIAL;
+        grow = (pint_racache_buff_offset(offset) !=
+                pint_racache_buff_offset(file->last_offset));
+    }
+    else if (stride == file->stride)
+    {
+        if (file->pattern != RACACHE_PATTERN_STRIDED)
+        {
+            racache_count(PERF_RACACHE_STRIDED, 1);
+        }
+        file->pattern = RACACHE_PATTERN_STRIDED;
+        grow = 1;
+    }
+    else
+    {
+        file->pattern = RACACHE_PATTERN_NONE;
+        if (file->readcnt > 1)
+        {
+            file->readcnt /= 2;
+            racache_count(PERF_RACACHE_WINDOW_SHRINK, 1);
+        }
+    }
+
+    if (grow && file->readcnt < PVFS2_MAX_RACACHE_READCNT)
+    {
+        file->readcnt *= 2;
+        if (file->readcnt < 2)
+        {
+            file->readcnt = 2;
+        }
+        if (file->readcnt > PVFS2_MAX_RACACHE_READCNT)
+        {
+            file->readcnt = PVFS2_MAX_RACACHE_READCNT;
+        }
+        racache_count(PERF_RACACHE_WINDOW_GROW, 1);
+    }
+
+    file->stride = stride;
+    file->last_offset = offset;
+    file->last_end = offset + len;
+}
+
+/* racache_count()
+ *
+ * adds to a racache counter and refreshes the hit and waste
+ * percentages.  caller holds the racache mutex.
+ */
+static void racache_count(int key, int64_t value)
+{
+    switch (key)
+    {
+    case PERF_RACACHE_HITS:
+    case PERF_RACACHE_WAITS:
+        racache.hits += value;
+        break;
+    case PERF_RACACHE_MISSES:
+        racache.misses += value;
+        break;
+    case PERF_RACACHE_PREFETCHED:
+        racache.prefetched += value;
+        break;
+    case PERF_RACACHE_PREFETCH_WASTED:
+        racache.wasted += value;
+        break;
+    }
+    if (!racache.pc)
+    {
+        return;
+    }
+    PINT_perf_count(racache.pc, key, value, PINT_PERF_ADD);
+    if (racache.hits + racache.misses > 0)
+    {
+        PINT_perf_count(racache.pc, PERF_RACACHE_HIT_PCT,
+                        (racache.hits * 100) /
+                        (racache.hits + racache.misses),
+                        PINT_PERF_SET);
+    }
+    if (racache.prefetched > 0)
+    {
+        PINT_perf_count(racache.pc, PERF_RACACHE_WASTE_PCT,
+                        (racache.wasted * 100) / racache.prefetched,
+                        PINT_PERF_SET);
+    }
+}
+
 /* hash_key()
  *
  * hash function for pinode_refns added to table
@@ -30,6 +30,29 @@
 #define RACACHE_READ          3 /* miss - read a new buffer */
 #define RACACHE_POSTED        4 /* miss - read of new buffer POSTED */
 
+/* access pattern detected for a file's stream of demand reads */
+#define RACACHE_PATTERN_NONE       0 /* random or not enough history */
+#define RACACHE_PATTERN_SEQUENTIAL 1 /* each read starts where last ended */
+#define RACACHE_PATTERN_STRIDED    2 /* constant gap larger than a buffer */
+
+/* racache performance counter keys */
+enum
+{
+    PERF_RACACHE_HITS = 0,
+    PERF_RACACHE_WAITS = 1,
+    PERF_RACACHE_MISSES = 2,
+    PERF_RACACHE_PREFETCHED = 3,
+    PERF_RACACHE_PREFETCH_USED = 4,
+    PERF_RACACHE_PREFETCH_WASTED = 5,
+    PERF_RACACHE_WINDOW_GROW = 6,
+    PERF_RACACHE_WINDOW_SHRINK = 7,
+    PERF_RACACHE_STRIDED = 8,
+    PERF_RACACHE_HIT_PCT = 9,
+    PERF_RACACHE_WASTE_PCT = 10
+};
+
+struct PINT_perf_counter;
+
 typedef struct gen_link_s
 {
     struct qlist_head link;
@@ -42,7 +65,12 @@ typedef struct racache_file_s
     struct qlist_head hash_link; /* hash table link */
     PVFS_object_ref refn;
     struct qlist_head buff_list; /* list of buffers for this file in cache */
-    PVFS_size readcnt;
+    PVFS_size readcnt;           /* current readahead window in buffers */
+    PVFS_size last_offset;       /* offset of the last demand read */
+    PVFS_size last_end;          /* end of the last demand read, -1 if none */
+    PVFS_size stride;            /* gap between the last two demand reads */
+    PVFS_size strip_size;        /* dist strip size, 0 if unknown */
+    int pattern;                 /* RACACHE_PATTERN_* */
 } racache_file_t;
 
 /* one for each buffer in cache */
@@ -56,6 +84,7 @@ typedef struct racache_buffer_s
     int resizing;                /* non zero if buffers are resizing */
     int buff_id;
     int vfs_cnt;
+    int speculative;             /* read ahead and not yet used by a read */
     PVFS_size file_offset;
     PVFS_size data_sz;
     PVFS_size buff_sz;
@@ -80,6 +109,11 @@ typedef struct racache_s
     int    oldarray_cnt;               /* count of original bufs in oldarray */
     int    oldarray_rem;               /* number of busy bufs in oldarray */
     int    oldarray_sz;                /* size of busy bufs in oldarray */
+    struct PINT_perf_counter *pc;      /* hit/waste statistics */
+    int64_t hits;                      /* totals behind the ratio counters */
+    int64_t misses;
+    int64_t prefetched;
+    int64_t wasted;
 } racache_t;
 
 
@@ -144,6 +178,19 @@ int pint_racache_finalize(void);
 
 void pint_racache_make_free(racache_buffer_t *buff);
 
+/*
+ * returns the file offset of the b'th buffer to read ahead after buff
+ * (b starts at 1), following the pattern seen on the buffer's file and
+ * stretched to the next strip boundary when the strip size is known.
+ * returns -1 when b is past the current readahead window.
+ */
+PVFS_size pint_racache_ra_offset(racache_buffer_t *buff, int b);
+
+/* record the distribution strip size of a file with cached buffers */
+void pint_racache_set_strip_size(PVFS_object_ref refn, PVFS_size strip_size);
+
+struct PINT_perf_counter *pint_racache_get_pc(void);
+
 #endif /* __MMAP_RA_CACHE_H */
 
 /*
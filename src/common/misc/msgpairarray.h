@@ -12,6 +12,7 @@
 #include "pvfs2-req-proto.h"
 #include "PINT-reqproto-encode.h"
 #include "job.h"
+#include "pint-slab.h"
 
 
 extern struct PINT_state_machine_s pvfs2_msgpairarray_sm;
@@ -82,6 +83,12 @@ typedef struct PINT_sm_msgpair_state_s
     */
     int complete;
 
+    /* when the request was last posted and when its response arrived,
+     * in microseconds
+     */
+    PVFS_time post_us;
+    PVFS_time done_us;
+
 } PINT_sm_msgpair_state;
 
 /* used to pass in parameters that apply to every entry in a msgpair array */
@@ -111,7 +118,7 @@ typedef struct
         memset(&(op)->msgpair, 0, sizeof(PINT_sm_msgpair_state)); \
         if((op)->msgarray != &(op)->msgpair)                      \
         {                                                         \
-            free((op)->msgarray);                                 \
+            PINT_slab_free((op)->msgarray);                       \
             (op)->msgarray = NULL;                                \
         }                                                         \
         (op)->count = 1;                                          \
@@ -169,7 +176,7 @@ do {                                                           \
     memset(__msg_p, 0, sizeof(PINT_sm_msgpair_state));           \
     if (__sm_p->msgarray && (__sm_p->msgarray != &(__sm_p->msgpair)))\
     {                                                          \
-        free(__sm_p->msgarray);                                  \
+        PINT_slab_free(__sm_p->msgarray);                        \
         __sm_p->msgarray = NULL;                                 \
     }                                                          \
     __sm_p->msgarray = __msg_p;                                    \
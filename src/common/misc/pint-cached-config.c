@@ -32,6 +32,8 @@
 #include "server-config.h"
 #include "quickhash.h"
 #include "extent-utils.h"
+#include "gen-locks.h"
+#include "pint-util.h"
 #include "pint-cached-config.h"
 
 /* really old linux distributions (jazz's RHEL 3) don't have this(!?) */
@@ -75,6 +77,13 @@ struct config_fs_cache_s
 
     struct handle_lookup_entry* handle_lookup_table;
     int handle_lookup_table_size;
+
+    /* statistics of the servers in fs->data_handle_ranges, in list
+     * order, for load-aware datafile placement
+     */
+    struct PINT_server_load_stats *data_server_stats;
+    int data_server_stats_count;
+    gen_mutex_t data_server_stats_mutex;
 };
 
 struct qhash_table *PINT_fsid_config_cache_table = NULL;
@@ -90,6 +99,11 @@ static const struct handle_lookup_entry* find_handle_lookup_entry(
                                                      PVFS_fs_id fsid);
 static int load_handle_lookup_table(
                        struct config_fs_cache_s *cur_config_fs_cache);
+static int map_servers_load_aware(
+                       struct config_fs_cache_s *cur_config_cache,
+                       int *inout_num_datafiles,
+                       PVFS_BMI_addr_t *addr_array,
+                       PVFS_handle_extent_array *handle_extent_array);
 
 /* removed by WBL when selection algorithm rewritten 
 static int meta_randomized = 0;
@@ -235,6 +249,9 @@ int PINT_cached_config_finalize(void)
                 }
 
                 free(cur_config_cache->handle_lookup_table);
+                free(cur_config_cache->data_server_stats);
+                gen_mutex_destroy(
+                    &cur_config_cache->data_server_stats_mutex);
 
                 free(cur_config_cache);
             }
@@ -332,6 +349,23 @@ int PINT_cached_config_handle_load_mapping(
             return(ret);
         }
 
+        /* no statistics until the first refresh; see
+         * PINT_cached_config_update_server_space()
+         */
+        cur_config_fs_cache->data_server_stats_count =
+                        PINT_llist_count(fs->data_handle_ranges);
+        cur_config_fs_cache->data_server_stats = (struct
+            PINT_server_load_stats *)calloc(
+                        cur_config_fs_cache->data_server_stats_count,
+                        sizeof(struct PINT_server_load_stats));
+        if(!cur_config_fs_cache->data_server_stats)
+        {
+            free(cur_config_fs_cache->handle_lookup_table);
+            free(cur_config_fs_cache);
+            return(-PVFS_ENOMEM);
+        }
+        gen_mutex_init(&cur_config_fs_cache->data_server_stats_mutex);
+
         qhash_add(PINT_fsid_config_cache_table,
                   &(cur_config_fs_cache->fs->coll_id),
                   &(cur_config_fs_cache->hash_link));
@@ -445,6 +479,7 @@ int PINT_cached_config_get_next_meta(PVFS_fs_id fsid,
     struct host_handle_mapping_s *cur_mapping = NULL;
     struct qlist_head *hash_link = NULL;
     struct config_fs_cache_s *cur_config_cache = NULL;
+    PINT_llist *cursor = NULL;
 
     if (!ext_array)
     {
@@ -471,29 +506,28 @@ int PINT_cached_config_get_next_meta(PVFS_fs_id fsid,
 
     randsrv = (rand() % num_meta_servers);
 
-    /* set cursor at beginning of list */
-    cur_config_cache->meta_server_cursor =
-                    cur_config_cache->fs->meta_handle_ranges;
+    /* set cursor at beginning of list; the walk uses a local cursor so
+     * that concurrent callers do not move each other's position
+     */
+    cursor = cur_config_cache->fs->meta_handle_ranges;
 
     while(randsrv--)
     {
-        cur_config_cache->meta_server_cursor =
-                        PINT_llist_next(cur_config_cache->meta_server_cursor);
-        if (!cur_config_cache->meta_server_cursor)
+        cursor = PINT_llist_next(cursor);
+        if (!cursor)
         {
             /* found end of list before we should have */
             gossip_err("Found end of list of metaservers "
                        "before expected in "
                        "PINT_cached_config_get_next_meta\n");
             /* return first metaserver */
-            cur_config_cache->meta_server_cursor =
-                            cur_config_cache->fs->meta_handle_ranges;
+            cursor = cur_config_cache->fs->meta_handle_ranges;
             break;
         }
 
     }
 
-    cur_mapping = PINT_llist_head(cur_config_cache->meta_server_cursor);
+    cur_mapping = PINT_llist_head(cursor);
 
     meta_server_bmi_str = cur_mapping->alias_mapping->bmi_address;
 
@@ -606,6 +640,25 @@ int PINT_cached_config_map_servers(
     server_list_head = cur_config_cache->fs->data_handle_ranges;
     num_io_servers = PINT_llist_count(server_list_head);
 
+    /* the layouts that leave the choice of servers to us follow the
+     * file system's placement policy
+     */
+    if(cur_config_cache->fs->data_placement ==
+                                        PINT_DATA_PLACEMENT_LOAD_AWARE &&
+       (layout->algorithm == PVFS_SYS_LAYOUT_ROUND_ROBIN ||
+        layout->algorithm == PVFS_SYS_LAYOUT_RANDOM))
+    {
+        ret = map_servers_load_aware(cur_config_cache,
+                                     inout_num_datafiles,
+                                     addr_array,
+                                     handle_extent_array);
+        if(ret != -PVFS_EAGAIN)
+        {
+            return ret;
+        }
+        /* no statistics yet; place as the layout says */
+    }
+
     switch(layout->algorithm)
     {
     case PVFS_SYS_LAYOUT_LIST:
@@ -832,6 +885,410 @@ int PINT_cached_config_map_servers(
     return 0;
 }
 
+/* find_data_server_stats()
+ *
+ * calls fn on the statistics of each I/O server of the file system
+ * whose address is addr, with the statistics lock held
+ *
+ * returns 0 on success, -PVFS_error on failure
+ */
+static int find_data_server_stats(
+    PVFS_fs_id fsid,
+    PVFS_BMI_addr_t addr,
+    void (*fn)(struct PINT_server_load_stats *stats, void *arg),
+    void *arg)
+{
+    struct qhash_head *hash_link = NULL;
+    struct config_fs_cache_s *cur_config_cache = NULL;
+    struct host_handle_mapping_s *sv = NULL;
+    PINT_llist *server_list = NULL;
+    PVFS_BMI_addr_t sv_addr;
+    int i, found = 0;
+
+    hash_link = qhash_search(PINT_fsid_config_cache_table, &(fsid));
+    if(!hash_link)
+    {
+        return -PVFS_EINVAL;
+    }
+    cur_config_cache = qlist_entry(hash_link,
+                                   struct config_fs_cache_s,
+                                   hash_link);
+    assert(cur_config_cache->fs);
+
+    gen_mutex_lock(&cur_config_cache->data_server_stats_mutex);
+    server_list = cur_config_cache->fs->data_handle_ranges;
+    for(i = 0; i < cur_config_cache->data_server_stats_count &&
+               (sv = PINT_llist_head(server_list)); i++)
+    {
+        if(BMI_addr_lookup(&sv_addr, sv->alias_mapping->bmi_address,
+                           NULL) == 0 && sv_addr == addr)
+        {
+            fn(&cur_config_cache->data_server_stats[i], arg);
+            found = 1;
+        }
+        server_list = PINT_llist_next(server_list);
+    }
+    gen_mutex_unlock(&cur_config_cache->data_server_stats_mutex);
+
+    return(found ? 0 : -PVFS_ENOENT);
+}
+
+static void set_server_space(struct PINT_server_load_stats *stats,
+                             void *arg)
+{
+    const PVFS_statfs *stat = arg;
+
+    stats->bytes_available = stat->bytes_available;
+    stats->bytes_total = stat->bytes_total;
+    stats->load_1 = stat->load_1;
+    stats->space_time_ms = PINT_util_get_time_ms();
+}
+
+/* PINT_cached_config_update_server_space()
+ *
+ * records the free space and load average an I/O server reported
+ * through statfs, for load-aware datafile placement
+ *
+ * returns 0 on success, -PVFS_error on failure
+ */
+int PINT_cached_config_update_server_space(PVFS_fs_id fsid,
+                                           PVFS_BMI_addr_t addr,
+                                           const PVFS_statfs *stat)
+{
+    return find_data_server_stats(fsid, addr, set_server_space,
+                                  (void *)stat);
+}
+
+struct server_load_sample
+{
+    int64_t io_bytes;
+    int64_t active_requests;
+};
+
+static void set_server_load(struct PINT_server_load_stats *stats,
+                            void *arg)
+{
+    struct server_load_sample *sample = arg;
+    uint64_t now = PINT_util_get_time_ms();
+
+    /* the counters only ever grow while the server runs; a smaller value
+     * means it restarted, and the rate is unknown until the next sample
+     */
+    if(stats->perf_time_ms && now > stats->perf_time_ms &&
+       sample->io_bytes >= stats->io_bytes)
+    {
+        stats->io_rate = (double)(sample->io_bytes - stats->io_bytes) *
+                         1000.0 / (double)(now - stats->perf_time_ms);
+    }
+    else
+    {
+        stats->io_rate = 0;
+    }
+    stats->io_bytes = sample->io_bytes;
+    stats->active_requests = sample->active_requests;
+    stats->perf_time_ms = now;
+}
+
+/* PINT_cached_config_update_server_load()
+ *
+ * records an I/O server's perf-mon counters: the total bytes it has
+ * read and written, from which the recent I/O rate is derived, and
+ * the number of requests it is working on
+ *
+ * returns 0 on success, -PVFS_error on failure
+ */
+int PINT_cached_config_update_server_load(PVFS_fs_id fsid,
+                                          PVFS_BMI_addr_t addr,
+                                          int64_t io_bytes,
+                                          int64_t active_requests)
+{
+    struct server_load_sample sample;
+
+    sample.io_bytes = io_bytes;
+    sample.active_requests = active_requests;
+    return find_data_server_stats(fsid, addr, set_server_load, &sample);
+}
+
+/* PINT_cached_config_pick_load_aware()
+ *
+ * chooses count distinct servers out of server_count, at random with
+ * each server weighted by its free space and discounted by its load
+ * relative to the average of the others.  Servers whose statistics are
+ * older than max_age_ms get the average weight; nearly full servers
+ * (see PINT_PLACEMENT_MIN_FREE) are only chosen, most free first, when
+ * no other server is left.  The indexes chosen are stored in picks in
+ * the order they should hold datafiles.
+ *
+ * returns 0 on success, -PVFS_EAGAIN if no server has current
+ * statistics, -PVFS_error on other failure
+ */
+int PINT_cached_config_pick_load_aware(
+    int server_count,
+    const struct PINT_server_load_stats *stats,
+    uint64_t now_ms,
+    uint64_t max_age_ms,
+    int count,
+    int *picks)
+{
+    double *weights;
+    char *space_fresh, *perf_fresh;
+    double rate_sum = 0, active_sum = 0, load_sum = 0, weight_sum = 0;
+    double busy, total, r, free_frac, best_free;
+    int perf_count = 0, space_count = 0, weight_count = 0, parts;
+    int i, k, best;
+
+    if(server_count < 1 || count < 1 || count > server_count)
+    {
+        return -PVFS_EINVAL;
+    }
+
+    weights = (double *)malloc(server_count * sizeof(double));
+    space_fresh = (char *)malloc(2 * server_count);
+    if(!weights || !space_fresh)
+    {
+        free(weights);
+        free(space_fresh);
+        return -PVFS_ENOMEM;
+    }
+    perf_fresh = space_fresh + server_count;
+
+    for(i = 0; i < server_count; i++)
+    {
+        space_fresh[i] = (stats[i].space_time_ms &&
+                          stats[i].bytes_total > 0 &&
+                          now_ms - stats[i].space_time_ms <= max_age_ms);
+        perf_fresh[i] = (stats[i].perf_time_ms &&
+                         now_ms - stats[i].perf_time_ms <= max_age_ms);
+        if(space_fresh[i])
+        {
+            space_count++;
+            load_sum += (double)stats[i].load_1;
+        }
+        if(perf_fresh[i])
+        {
+            perf_count++;
+            rate_sum += stats[i].io_rate;
+            active_sum += (double)stats[i].active_requests;
+        }
+    }
+    if(space_count == 0)
+    {
+        free(weights);
+        free(space_fresh);
+        return -PVFS_EAGAIN;
+    }
+
+    for(i = 0; i < server_count; i++)
+    {
+        weights[i] = 0;
+        if(!space_fresh[i] ||
+           stats[i].bytes_available <
+               PINT_PLACEMENT_MIN_FREE * (double)stats[i].bytes_total)
+        {
+            continue;
+        }
+
+        /* each load measure is relative to its average; the discount
+         * is squared so that a server as busy as the rest keeps a
+         * quarter of its weight, an idle one all of it, and one that
+         * is much busier very little
+         */
+        busy = 0;
+        parts = 0;
+        if(perf_fresh[i] && rate_sum > 0)
+        {
+            busy += stats[i].io_rate * perf_count / rate_sum;
+            parts++;
+        }
+        if(perf_fresh[i] && active_sum > 0)
+        {
+            busy += (double)stats[i].active_requests * perf_count /
+                    active_sum;
+            parts++;
+        }
+        if(load_sum > 0)
+        {
+            busy += (double)stats[i].load_1 * space_count / load_sum;
+            parts++;
+        }
+        if(parts)
+        {
+            busy /= parts;
+        }
+
+        /* free space times the fraction free keeps servers that are
+         * equally full equally likely in proportion to their size, and
+         * lets emptier ones catch up
+         */
+        weights[i] = (double)stats[i].bytes_available *
+                     (double)stats[i].bytes_available /
+                     (double)stats[i].bytes_total /
+                     ((1.0 + busy) * (1.0 + busy));
+        weight_sum += weights[i];
+        weight_count++;
+    }
+
+    /* servers we know nothing current about are treated as average */
+    for(i = 0; i < server_count; i++)
+    {
+        if(!space_fresh[i] && weight_count)
+        {
+            weights[i] = weight_sum / weight_count;
+        }
+    }
+
+    for(k = 0; k < count; k++)
+    {
+        total = 0;
+        for(i = 0; i < server_count; i++)
+        {
+            total += weights[i];
+        }
+
+        best = -1;
+        if(total > 0)
+        {
+            r = ((double)rand() / ((double)RAND_MAX + 1.0)) * total;
+            for(i = 0; i < server_count; i++)
+            {
+                if(weights[i] <= 0)
+                {
+                    continue;
+                }
+                best = i;
+                r -= weights[i];
+                if(r < 0)
+                {
+                    break;
+                }
+            }
+        }
+        else
+        {
+            /* only full servers are left; take the emptiest */
+            best_free = -1;
+            for(i = 0; i < server_count; i++)
+            {
+                if(weights[i] < 0)
+                {
+                    continue;
+                }
+                free_frac = space_fresh[i] ?
+                    (double)stats[i].bytes_available /
+                    (double)stats[i].bytes_total : 0;
+                if(free_frac > best_free)
+                {
+                    best_free = free_frac;
+                    best = i;
+                }
+            }
+        }
+
+        assert(best >= 0);
+        picks[k] = best;
+        /* chosen servers are marked so neither pass considers them */
+        weights[best] = -1;
+    }
+
+    free(weights);
+    free(space_fresh);
+    return 0;
+}
+
+/* map_servers_load_aware()
+ *
+ * the load-aware placement policy of PINT_cached_config_map_servers()
+ *
+ * returns 0 on success, -PVFS_EAGAIN if there are no current server
+ * statistics to place by, -PVFS_error on other failure
+ */
+static int map_servers_load_aware(
+    struct config_fs_cache_s *cur_config_cache,
+    int *inout_num_datafiles,
+    PVFS_BMI_addr_t *addr_array,
+    PVFS_handle_extent_array *handle_extent_array)
+{
+    struct host_handle_mapping_s **servers = NULL;
+    struct PINT_server_load_stats *stats = NULL;
+    PINT_llist *server_list = NULL;
+    uint64_t max_age_ms;
+    int *picks = NULL;
+    int num_io_servers, i, df, ret;
+
+    num_io_servers = cur_config_cache->data_server_stats_count;
+    if(num_io_servers < 1)
+    {
+        return -PVFS_EAGAIN;
+    }
+    if(num_io_servers < *inout_num_datafiles)
+    {
+        *inout_num_datafiles = num_io_servers;
+    }
+
+    servers = (struct host_handle_mapping_s **)malloc(
+                                    num_io_servers * sizeof(*servers));
+    stats = (struct PINT_server_load_stats *)malloc(
+                                    num_io_servers * sizeof(*stats));
+    picks = (int *)malloc(num_io_servers * sizeof(int));
+    if(!servers || !stats || !picks)
+    {
+        ret = -PVFS_ENOMEM;
+        goto out;
+    }
+
+    server_list = cur_config_cache->fs->data_handle_ranges;
+    for(i = 0; i < num_io_servers; i++)
+    {
+        servers[i] = PINT_llist_head(server_list);
+        assert(servers[i]);
+        server_list = PINT_llist_next(server_list);
+    }
+
+    gen_mutex_lock(&cur_config_cache->data_server_stats_mutex);
+    memcpy(stats, cur_config_cache->data_server_stats,
+           num_io_servers * sizeof(*stats));
+    gen_mutex_unlock(&cur_config_cache->data_server_stats_mutex);
+
+    /* a server missing a few refreshes in a row is no longer trusted */
+    max_age_ms = 3000 *
+        (uint64_t)cur_config_cache->fs->data_placement_refresh_secs;
+    ret = PINT_cached_config_pick_load_aware(num_io_servers,
+                                             stats,
+                                             PINT_util_get_time_ms(),
+                                             max_age_ms,
+                                             *inout_num_datafiles,
+                                             picks);
+    if(ret < 0)
+    {
+        goto out;
+    }
+
+    for(df = 0; df < *inout_num_datafiles; df++)
+    {
+        ret = BMI_addr_lookup(&addr_array[df],
+                              servers[picks[df]]->alias_mapping->bmi_address,
+                              NULL);
+        if(ret)
+        {
+            goto out;
+        }
+        if(handle_extent_array)
+        {
+            handle_extent_array[df].extent_count =
+                servers[picks[df]]->handle_extent_array.extent_count;
+            handle_extent_array[df].extent_array =
+                servers[picks[df]]->handle_extent_array.extent_array;
+        }
+    }
+    ret = 0;
+
+out:
+    free(servers);
+    free(stats);
+    free(picks);
+    return ret;
+}
+
 /* THIS APPEARS TO BE SUPERCEDED BY THE PREVIOUS FUNCTION*/
 #if 0
 /* PINT_cached_config_get_next_io()
@@ -19,6 +19,28 @@
 #define PINT_SERVER_TYPE_META                        PVFS_MGMT_META_SERVER
 #define PINT_SERVER_TYPE_ALL   (PINT_SERVER_TYPE_META|PINT_SERVER_TYPE_IO)
 
+/* what load-aware datafile placement knows about one I/O server; the
+ * space fields come from statfs and the load fields from the server's
+ * perf-mon counters, each stamped with the time they were refreshed
+ */
+struct PINT_server_load_stats
+{
+    PVFS_size bytes_available;
+    PVFS_size bytes_total;
+    uint64_t load_1;            /* 1 minute load average, as sysinfo */
+    uint64_t space_time_ms;
+
+    int64_t io_bytes;           /* bytes read and written, cumulative */
+    double io_rate;             /* bytes/s over the last refresh */
+    int64_t active_requests;    /* requests in the request scheduler */
+    uint64_t perf_time_ms;
+};
+
+/* servers with less than this fraction of their space free get no new
+ * datafiles under load-aware placement while others can take them
+ */
+#define PINT_PLACEMENT_MIN_FREE 0.05
+
 /* This is the interface to the cached_config management component of
  * the system interface.  It is responsible for caching information
  * gathered from the various server configurations and providing an
@@ -91,6 +113,25 @@ int PINT_cached_config_map_servers(
     PVFS_BMI_addr_t *addr_array,
     PVFS_handle_extent_array *handle_extent_array);
 
+int PINT_cached_config_update_server_space(
+    PVFS_fs_id fsid,
+    PVFS_BMI_addr_t addr,
+    const PVFS_statfs *stat);
+
+int PINT_cached_config_update_server_load(
+    PVFS_fs_id fsid,
+    PVFS_BMI_addr_t addr,
+    int64_t io_bytes,
+    int64_t active_requests);
+
+int PINT_cached_config_pick_load_aware(
+    int server_count,
+    const struct PINT_server_load_stats *stats,
+    uint64_t now_ms,
+    uint64_t max_age_ms,
+    int count,
+    int *picks);
+
 int PINT_cached_config_get_num_dfiles(
     PVFS_fs_id fsid,
     PINT_dist *dist,
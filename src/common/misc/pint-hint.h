@@ -39,7 +39,8 @@ enum PINT_hint_type
     PINT_HINT_CACHE,
     PINT_HINT_LOCAL_UID,
     PINT_HINT_OWNER_GID,
-    PINT_HINT_DISTRIBUTION_PV
+    PINT_HINT_DISTRIBUTION_PV,
+    PINT_HINT_READDIR_STREAM
 };
 
 typedef struct PVFS_hint_s
@@ -106,6 +107,10 @@ int PVFS_hint_replace_internal(
     PINT_hint_get_value_by_type(hints, PINT_HINT_OWNER_GID, NULL) ? \
     *(PVFS_gid *)PINT_hint_get_value_by_type(hints, PINT_HINT_OWNER_GID, NULL) : -1
 
+#define PINT_HINT_GET_READDIR_STREAM(hints) \
+    PINT_hint_get_value_by_type(hints, PINT_HINT_READDIR_STREAM, NULL) ? \
+    *(uint32_t *)PINT_hint_get_value_by_type(hints, PINT_HINT_READDIR_STREAM, NULL) : 0
+
 #endif /* __PINT_HINT_H__ */
 
 /*
@@ -0,0 +1,691 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* I/O buffer pool.
+ *
+ * Direct I/O bounce buffers and BMI buffers (and through BMI_memalloc the
+ * flow buffers) are allocated and freed once per operation.  Most of
+ * them are large enough that malloc hands them to mmap, so each one costs
+ * a map, a page fault per page, and an unmap.  This pool keeps them
+ * instead.  It is off until PINT_mem_pool_enable() is called, which the
+ * server does; until then, and in clients, allocations go straight to
+ * posix_memalign.
+ *
+ * Requests are rounded up to one of MEM_POOL_CLASS_COUNT size classes.
+ * Those below a page, 256 B to 2 KiB for message headers and eager
+ * messages, double and are aligned to their size.  From 4 KiB to 4 MiB
+ * there are four to each doubling so at most a fifth of a buffer is
+ * unused, and all are page aligned for direct I/O.  Larger requests fall
+ * back to posix_memalign with the same alignment.  Buffers are
+ * cut from regions of at least one huge page, each serving one class on
+ * one NUMA node and keeping its own free list.  Regions are aligned to a
+ * huge page and marked for transparent huge pages; their pages are
+ * faulted in as buffers are first used.
+ *
+ * A region whose buffers have all come back is unmapped at once if its
+ * class already keeps an idle region, and otherwise once it has been
+ * idle for MEM_POOL_IDLE_SECS.  When the pool would grow past
+ * MEM_POOL_MAX_BYTES, all idle regions of every class are unmapped
+ * first, and only if that is not enough does the request fall back to
+ * posix_memalign.
+ *
+ * PINT_mem_pool_free() finds the region of a buffer from its address, so
+ * it takes any pointer from PINT_mem_pool_alloc(), pooled or not.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "pvfs2-types.h"
+#include "pvfs2-internal.h"
+#include "gen-locks.h"
+#include "gossip.h"
+#include "quicklist.h"
+#include "pint-mem-pool.h"
+
+#define MEM_POOL_MIN_SIZE 256
+#define MEM_POOL_MAX_SIZE (4UL * 1024 * 1024)
+/* 256 B to 2 KiB by doubling, 4, 8 and 12 KiB, four classes for each
+ * doubling from 16 KiB to 4 MiB, and 4 MiB itself */
+#define MEM_POOL_CLASS_COUNT 40
+#define MEM_POOL_MAX_NODES 8
+#define MEM_POOL_HUGE_SHIFT 21
+#define MEM_POOL_HUGE_SIZE (1UL << MEM_POOL_HUGE_SHIFT)
+#define MEM_POOL_MAX_BYTES (512UL * 1024 * 1024)
+#define MEM_POOL_MAX_REGIONS (MEM_POOL_MAX_BYTES / MEM_POOL_HUGE_SIZE)
+/* one slot per huge page of pool memory, with room to spare */
+#define MEM_POOL_CHUNK_SLOTS (4 * MEM_POOL_MAX_REGIONS)
+#define MEM_POOL_IDLE_SECS 5
+
+struct mem_pool_region
+{
+    struct qlist_head link;   /* on its class list */
+    char *base;
+    size_t len;
+    int cls;
+    int node;
+    int used;                 /* slot in regions[] taken */
+    void *free_list;          /* linked through the first word */
+    char *carve_next;
+    char *carve_end;
+    int live;                 /* buffers handed out */
+    time_t idle_since;        /* when live last dropped to 0 */
+};
+
+/* the regions of one class on one node, those with room first */
+struct mem_pool_class
+{
+    gen_mutex_t mutex;
+    struct qlist_head regions;
+    int idle_regions;
+    uint64_t hits;
+    uint64_t carves;
+    uint64_t frees;
+};
+
+static size_t class_sizes[MEM_POOL_CLASS_COUNT];
+static struct mem_pool_class classes[MEM_POOL_MAX_NODES][MEM_POOL_CLASS_COUNT];
+static struct mem_pool_region regions[MEM_POOL_MAX_REGIONS];
+static int region_count = 0;
+static size_t bytes_mapped = 0;
+static uint64_t regions_released = 0;
+static uint64_t fallbacks = 0;
+static gen_mutex_t region_mutex = GEN_MUTEX_INITIALIZER;
+static int pool_enabled = 0;
+static time_t last_sweep = 0;
+
+/* maps a huge page sized piece of pool memory to its region.  Each slot
+ * holds the address shifted by MEM_POOL_HUGE_SHIFT, shifted up again by
+ * 16, with the region index plus one in the low 16 bits; 0 marks a free
+ * slot.  Slots change under region_mutex only, one word at a time, so a
+ * lookup that finds its key has the right region without the lock.  One
+ * that does not may have raced with a removal, and looks again under
+ * the lock.
+ */
+static uint64_t chunk_slots[MEM_POOL_CHUNK_SLOTS];
+
+#define CHUNK_KEY(__slot) ((__slot) >> 16)
+#define CHUNK_REGION(__slot) ((int)((__slot) & 0xffff) - 1)
+
+/* PINT_mem_pool_enable()
+ *
+ * turns the pool on for this process.  Call before the first
+ * PINT_mem_pool_alloc(); buffers allocated earlier are still freed
+ * correctly.
+ *
+ * no return value
+ */
+void PINT_mem_pool_enable(void)
+{
+    size_t size;
+    int i, j, cls = 0;
+
+    gen_mutex_lock(&region_mutex);
+    if(!pool_enabled)
+    {
+        for(size = MEM_POOL_MIN_SIZE; size < 4096; size *= 2)
+        {
+            class_sizes[cls++] = size;
+        }
+        class_sizes[cls++] = 4096;
+        class_sizes[cls++] = 8192;
+        class_sizes[cls++] = 12288;
+        for(size = 16384; size < MEM_POOL_MAX_SIZE; size *= 2)
+        {
+            for(i = 0; i < 4; i++)
+            {
+                class_sizes[cls++] = size + i * (size / 4);
+            }
+        }
+        class_sizes[cls++] = MEM_POOL_MAX_SIZE;
+        assert(cls == MEM_POOL_CLASS_COUNT);
+
+        for(i = 0; i < MEM_POOL_MAX_NODES; i++)
+        {
+            for(j = 0; j < MEM_POOL_CLASS_COUNT; j++)
+            {
+                gen_mutex_init(&classes[i][j].mutex);
+                INIT_QLIST_HEAD(&classes[i][j].regions);
+            }
+        }
+        last_sweep = time(NULL);
+        __atomic_store_n(&pool_enabled, 1, __ATOMIC_RELEASE);
+    }
+    gen_mutex_unlock(&region_mutex);
+}
+
+/* returns the smallest class that holds size, or -1 if none does */
+static int mem_pool_class_of(size_t size)
+{
+    int low = 0, high = MEM_POOL_CLASS_COUNT - 1, mid;
+
+    if(size > MEM_POOL_MAX_SIZE)
+    {
+        return -1;
+    }
+    while(low < high)
+    {
+        mid = (low + high) / 2;
+        if(class_sizes[mid] < size)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/* returns the NUMA node the calling thread is running on */
+static int mem_pool_node(void)
+{
+#ifdef SYS_getcpu
+    unsigned int cpu, node;
+
+    if(syscall(SYS_getcpu, &cpu, &node, NULL) == 0)
+    {
+        return node % MEM_POOL_MAX_NODES;
+    }
+#endif
+    return 0;
+}
+
+static int mem_pool_chunk_home(uint64_t key)
+{
+    return (int)((key * 0x9e3779b97f4a7c15ULL) >> 40) %
+        MEM_POOL_CHUNK_SLOTS;
+}
+
+/* looks key up; returns its slot and sets *entry to what it holds, or
+ * returns -1 */
+static int mem_pool_chunk_find(uint64_t key, uint64_t *entry)
+{
+    uint64_t cur;
+    int slot, n;
+
+    slot = mem_pool_chunk_home(key);
+    for(n = 0; n < MEM_POOL_CHUNK_SLOTS; n++)
+    {
+        cur = __atomic_load_n(&chunk_slots[slot], __ATOMIC_ACQUIRE);
+        if(cur == 0)
+        {
+            return -1;
+        }
+        if(CHUNK_KEY(cur) == key)
+        {
+            *entry = cur;
+            return slot;
+        }
+        slot = (slot + 1) % MEM_POOL_CHUNK_SLOTS;
+    }
+    return -1;
+}
+
+/* adds key for region idx; region_mutex held */
+static void mem_pool_chunk_add(uint64_t key, int idx)
+{
+    int slot = mem_pool_chunk_home(key);
+
+    while(chunk_slots[slot] != 0)
+    {
+        slot = (slot + 1) % MEM_POOL_CHUNK_SLOTS;
+    }
+    __atomic_store_n(&chunk_slots[slot], (key << 16) | (idx + 1),
+                     __ATOMIC_RELEASE);
+}
+
+/* removes key, moving back the entries after it that would otherwise be
+ * cut off from their home slot; region_mutex held */
+static void mem_pool_chunk_del(uint64_t key)
+{
+    uint64_t entry;
+    int hole, slot, home;
+
+    hole = mem_pool_chunk_find(key, &entry);
+    if(hole < 0)
+    {
+        return;
+    }
+    slot = hole;
+    for(;;)
+    {
+        slot = (slot + 1) % MEM_POOL_CHUNK_SLOTS;
+        if(chunk_slots[slot] == 0)
+        {
+            break;
+        }
+        home = mem_pool_chunk_home(CHUNK_KEY(chunk_slots[slot]));
+        /* leave it if its home lies cyclically in (hole, slot] */
+        if(hole <= slot ? (hole < home && home <= slot) :
+                          (hole < home || home <= slot))
+        {
+            continue;
+        }
+        __atomic_store_n(&chunk_slots[hole], chunk_slots[slot],
+                         __ATOMIC_RELEASE);
+        hole = slot;
+    }
+    __atomic_store_n(&chunk_slots[hole], 0, __ATOMIC_RELEASE);
+}
+
+static struct mem_pool_region *mem_pool_find_region(void *ptr)
+{
+    uint64_t key = (uintptr_t)ptr >> MEM_POOL_HUGE_SHIFT;
+    uint64_t entry;
+    int found;
+
+    found = mem_pool_chunk_find(key, &entry);
+    if(found < 0)
+    {
+        gen_mutex_lock(&region_mutex);
+        found = mem_pool_chunk_find(key, &entry);
+        gen_mutex_unlock(&region_mutex);
+    }
+    return found < 0 ? NULL : &regions[CHUNK_REGION(entry)];
+}
+
+/* maps len bytes aligned to a huge page */
+static char *mem_pool_map(size_t len)
+{
+    char *p, *aligned;
+    size_t head, tail;
+
+    /* map one extra huge page so the region can start on a huge page
+     * boundary, which transparent huge pages need */
+    p = mmap(NULL, len + MEM_POOL_HUGE_SIZE, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(p == MAP_FAILED)
+    {
+        return NULL;
+    }
+    aligned = (char *)(((uintptr_t)p + MEM_POOL_HUGE_SIZE - 1) &
+                       ~(uintptr_t)(MEM_POOL_HUGE_SIZE - 1));
+    head = aligned - p;
+    tail = MEM_POOL_HUGE_SIZE - head;
+    if(head)
+    {
+        munmap(p, head);
+    }
+    if(tail)
+    {
+        munmap(aligned + len, tail);
+    }
+#ifdef MADV_HUGEPAGE
+    madvise(aligned, len, MADV_HUGEPAGE);
+#endif
+    return aligned;
+}
+
+/* unmaps a region that has left its class list */
+static void mem_pool_release_region(struct mem_pool_region *region)
+{
+    uint64_t key;
+
+    gen_mutex_lock(&region_mutex);
+    for(key = (uintptr_t)region->base >> MEM_POOL_HUGE_SHIFT;
+        key < ((uintptr_t)region->base + region->len) >> MEM_POOL_HUGE_SHIFT;
+        key++)
+    {
+        mem_pool_chunk_del(key);
+    }
+    munmap(region->base, region->len);
+    bytes_mapped -= region->len;
+    region_count--;
+    regions_released++;
+    region->used = 0;
+    gen_mutex_unlock(&region_mutex);
+}
+
+/* unmaps the idle regions of every class, or with all set every empty
+ * one however briefly it has been idle */
+static void mem_pool_sweep(int all)
+{
+    struct mem_pool_class *pc;
+    struct mem_pool_region *region, *tmp;
+    QLIST_HEAD(released);
+    time_t now = time(NULL);
+    int i, j;
+
+    for(i = 0; i < MEM_POOL_MAX_NODES; i++)
+    {
+        for(j = 0; j < MEM_POOL_CLASS_COUNT; j++)
+        {
+            pc = &classes[i][j];
+            gen_mutex_lock(&pc->mutex);
+            if(pc->idle_regions > 0)
+            {
+                qlist_for_each_entry_safe(region, tmp, &pc->regions, link)
+                {
+                    if(region->live == 0 &&
+                       (all || now - region->idle_since >= MEM_POOL_IDLE_SECS))
+                    {
+                        qlist_del(&region->link);
+                        qlist_add(&region->link, &released);
+                        pc->idle_regions--;
+                    }
+                }
+            }
+            gen_mutex_unlock(&pc->mutex);
+        }
+    }
+
+    qlist_for_each_entry_safe(region, tmp, &released, link)
+    {
+        qlist_del(&region->link);
+        mem_pool_release_region(region);
+    }
+}
+
+/* sweeps out idle regions, at most once a second */
+static void mem_pool_maybe_sweep(void)
+{
+    time_t now = time(NULL);
+    time_t last = __atomic_load_n(&last_sweep, __ATOMIC_RELAXED);
+
+    if(now - last >= 1 &&
+       __atomic_compare_exchange_n(&last_sweep, &last, now, 0,
+                                   __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+        mem_pool_sweep(0);
+    }
+}
+
+/* maps a new region for class cls on node.  Returns NULL if the pool is
+ * full even without its idle regions, or if mmap fails.
+ */
+static struct mem_pool_region *mem_pool_add_region(int cls, int node)
+{
+    struct mem_pool_region *region;
+    size_t len = MEM_POOL_HUGE_SIZE;
+    uint64_t key;
+    char *base;
+    int idx;
+
+    if(len < 2 * class_sizes[cls])
+    {
+        len = (2 * class_sizes[cls] + MEM_POOL_HUGE_SIZE - 1) &
+            ~(MEM_POOL_HUGE_SIZE - 1);
+    }
+
+    gen_mutex_lock(&region_mutex);
+    if(bytes_mapped + len > MEM_POOL_MAX_BYTES)
+    {
+        gen_mutex_unlock(&region_mutex);
+        mem_pool_sweep(1);
+        gen_mutex_lock(&region_mutex);
+        if(bytes_mapped + len > MEM_POOL_MAX_BYTES)
+        {
+            gen_mutex_unlock(&region_mutex);
+            return NULL;
+        }
+    }
+    for(idx = 0; idx < MEM_POOL_MAX_REGIONS && regions[idx].used; idx++)
+    {
+    }
+    assert(idx < MEM_POOL_MAX_REGIONS);
+    base = mem_pool_map(len);
+    if(!base)
+    {
+        gen_mutex_unlock(&region_mutex);
+        gossip_err("%s: failed to map %zu byte region: %s\n",
+                   __func__, len, strerror(errno));
+        return NULL;
+    }
+
+    region = &regions[idx];
+    memset(region, 0, sizeof(*region));
+    region->used = 1;
+    region->base = base;
+    region->len = len;
+    region->cls = cls;
+    region->node = node;
+    region->carve_next = base;
+    region->carve_end = base + (len / class_sizes[cls]) * class_sizes[cls];
+    for(key = (uintptr_t)base >> MEM_POOL_HUGE_SHIFT;
+        key < ((uintptr_t)base + len) >> MEM_POOL_HUGE_SHIFT; key++)
+    {
+        mem_pool_chunk_add(key, idx);
+    }
+    region_count++;
+    bytes_mapped += len;
+    gen_mutex_unlock(&region_mutex);
+
+    return region;
+}
+
+static int mem_pool_region_has_room(struct mem_pool_region *region)
+{
+    return region->free_list || region->carve_next < region->carve_end;
+}
+
+/* takes a buffer from the first region of pc; pc->mutex held */
+static void *mem_pool_take(struct mem_pool_class *pc, int cls)
+{
+    struct mem_pool_region *region;
+    void *ptr;
+
+    if(qlist_empty(&pc->regions))
+    {
+        return NULL;
+    }
+    region = qlist_entry(pc->regions.next, struct mem_pool_region, link);
+    if(!mem_pool_region_has_room(region))
+    {
+        return NULL;
+    }
+
+    if(region->free_list)
+    {
+        ptr = region->free_list;
+        region->free_list = *(void **)ptr;
+        pc->hits++;
+    }
+    else
+    {
+        ptr = region->carve_next;
+        region->carve_next += class_sizes[cls];
+        pc->carves++;
+    }
+    if(region->live++ == 0)
+    {
+        pc->idle_regions--;
+    }
+    if(!mem_pool_region_has_room(region))
+    {
+        /* full regions go to the back */
+        qlist_del(&region->link);
+        qlist_add_tail(&region->link, &pc->regions);
+    }
+    return ptr;
+}
+
+/* PINT_mem_pool_alignment()
+ *
+ * returns the alignment PINT_mem_pool_alloc() gives a buffer of size
+ * bytes: PINT_MEM_POOL_ALIGNMENT from that size up, otherwise the
+ * smallest power of two that holds size.  Pool classes below a page are
+ * powers of two carved from huge page aligned regions, so their buffers
+ * are aligned to their class size, which is at least this.
+ */
+size_t PINT_mem_pool_alignment(size_t size)
+{
+    size_t align = sizeof(void *);
+
+    while(align < size && align < PINT_MEM_POOL_ALIGNMENT)
+    {
+        align *= 2;
+    }
+    return align;
+}
+
+/* PINT_mem_pool_alloc()
+ *
+ * allocates a buffer of at least size bytes, aligned as
+ * PINT_mem_pool_alignment() says, from the pool if it is enabled and
+ * can.  The buffer must be released with PINT_mem_pool_free().
+ *
+ * returns pointer to memory on success, NULL on failure
+ */
+void *PINT_mem_pool_alloc(size_t size)
+{
+    struct mem_pool_class *pc;
+    struct mem_pool_region *region;
+    void *ptr = NULL;
+    int cls, node;
+
+    if(__atomic_load_n(&pool_enabled, __ATOMIC_ACQUIRE) &&
+       (cls = mem_pool_class_of(size)) >= 0)
+    {
+        mem_pool_maybe_sweep();
+        node = mem_pool_node();
+        pc = &classes[node][cls];
+
+        gen_mutex_lock(&pc->mutex);
+        ptr = mem_pool_take(pc, cls);
+        gen_mutex_unlock(&pc->mutex);
+
+        if(!ptr)
+        {
+            /* mapped without the class lock; the sweep a full pool
+             * does takes every class lock */
+            region = mem_pool_add_region(cls, node);
+            if(region)
+            {
+                gen_mutex_lock(&pc->mutex);
+                qlist_add(&region->link, &pc->regions);
+                pc->idle_regions++;
+                ptr = mem_pool_take(pc, cls);
+                gen_mutex_unlock(&pc->mutex);
+            }
+        }
+
+        if(ptr)
+        {
+            return ptr;
+        }
+    }
+
+    __atomic_fetch_add(&fallbacks, 1, __ATOMIC_RELAXED);
+    if(posix_memalign(&ptr, PINT_mem_pool_alignment(size),
+                      size ? size : 1) != 0)
+    {
+        return NULL;
+    }
+    return ptr;
+}
+
+/* PINT_mem_pool_free()
+ *
+ * releases a buffer from PINT_mem_pool_alloc()
+ *
+ * no return value
+ */
+void PINT_mem_pool_free(void *ptr)
+{
+    struct mem_pool_region *region;
+    struct mem_pool_class *pc;
+    int release = 0;
+
+    if(!ptr)
+    {
+        return;
+    }
+
+    if(!__atomic_load_n(&pool_enabled, __ATOMIC_ACQUIRE) ||
+       !(region = mem_pool_find_region(ptr)))
+    {
+        /* a fallback allocation */
+        free(ptr);
+        return;
+    }
+
+    pc = &classes[region->node][region->cls];
+    gen_mutex_lock(&pc->mutex);
+    if(!mem_pool_region_has_room(region))
+    {
+        qlist_del(&region->link);
+        qlist_add(&region->link, &pc->regions);
+    }
+    *(void **)ptr = region->free_list;
+    region->free_list = ptr;
+    pc->frees++;
+    if(--region->live == 0)
+    {
+        if(pc->idle_regions > 0)
+        {
+            /* the class keeps one idle region at most */
+            qlist_del(&region->link);
+            release = 1;
+        }
+        else
+        {
+            pc->idle_regions++;
+            region->idle_since = time(NULL);
+        }
+    }
+    gen_mutex_unlock(&pc->mutex);
+
+    if(release)
+    {
+        mem_pool_release_region(region);
+    }
+    mem_pool_maybe_sweep();
+}
+
+/* PINT_mem_pool_get_stats()
+ *
+ * fills in stats with the pool counters since the process started
+ *
+ * no return value
+ */
+void PINT_mem_pool_get_stats(struct PINT_mem_pool_stats *stats)
+{
+    struct mem_pool_class *pc;
+    int i, j;
+
+    memset(stats, 0, sizeof(*stats));
+    stats->fallbacks = __atomic_load_n(&fallbacks, __ATOMIC_RELAXED);
+    if(!__atomic_load_n(&pool_enabled, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    for(i = 0; i < MEM_POOL_MAX_NODES; i++)
+    {
+        for(j = 0; j < MEM_POOL_CLASS_COUNT; j++)
+        {
+            pc = &classes[i][j];
+            gen_mutex_lock(&pc->mutex);
+            stats->hits += pc->hits;
+            stats->carves += pc->carves;
+            stats->frees += pc->frees;
+            gen_mutex_unlock(&pc->mutex);
+        }
+    }
+
+    gen_mutex_lock(&region_mutex);
+    stats->regions = region_count;
+    stats->regions_released = regions_released;
+    stats->bytes_mapped = bytes_mapped;
+    gen_mutex_unlock(&region_mutex);
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
@@ -0,0 +1,45 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+#ifndef __PINT_MEM_POOL_H
+#define __PINT_MEM_POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* buffers of at least this size are aligned to it, pooled or not;
+ * smaller ones to the smallest power of two that holds them (see
+ * PINT_mem_pool_alignment()) */
+#define PINT_MEM_POOL_ALIGNMENT 4096
+
+/* counters kept by the I/O buffer pool */
+struct PINT_mem_pool_stats
+{
+    uint64_t hits;            /* allocations served from a free list */
+    uint64_t carves;          /* allocations cut from unused region space */
+    uint64_t fallbacks;       /* allocations that went to posix_memalign */
+    uint64_t frees;           /* buffers returned to the pool */
+    uint64_t regions;         /* regions mapped now */
+    uint64_t regions_released;/* regions unmapped again once idle */
+    uint64_t bytes_mapped;    /* size of the regions mapped now */
+};
+
+void PINT_mem_pool_enable(void);
+size_t PINT_mem_pool_alignment(size_t size);
+void *PINT_mem_pool_alloc(size_t size);
+void PINT_mem_pool_free(void *ptr);
+void PINT_mem_pool_get_stats(struct PINT_mem_pool_stats *stats);
+
+#endif /* __PINT_MEM_POOL_H */
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
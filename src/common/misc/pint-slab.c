@@ -0,0 +1,659 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* Slab caches for small fixed size objects.
+ *
+ * State machine control blocks, their frames, server ops, msgpair arrays
+ * and job descriptors are allocated and freed once or more per request.
+ * This keeps them instead of handing them back to malloc.
+ *
+ * Requests are rounded up to one of a set of size classes, four per
+ * power of two from 64 bytes to PINT_SLAB_MAX_SIZE, so an object is at
+ * most a quarter larger than what it holds.  Each thread keeps a free list per
+ * class and needs no lock to allocate from or free to it.  A thread list
+ * that runs dry takes a batch from the class depot, a list that grows
+ * past two batches gives one back, and a thread that exits gives back
+ * everything.  A depot that runs dry is refilled with a new block.
+ *
+ * Blocks are SLAB_BLOCK_SIZE bytes, aligned to their size, and hold
+ * objects of one class.  They are cut from regions mapped
+ * SLAB_REGION_SIZE at a time and are never returned.  PINT_slab_free()
+ * finds the block of an object from its address, so it takes any
+ * pointer from PINT_slab_alloc() and also anything from malloc(), which
+ * it passes to free().  Requests larger than PINT_SLAB_MAX_SIZE, and any
+ * once SLAB_MAX_BYTES are mapped, go to malloc.  Setting
+ * PVFS2_SLAB_DISABLE in the environment sends everything to malloc, for
+ * use with memory checkers.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pvfs2-types.h"
+#include "pvfs2-internal.h"
+#include "gen-locks.h"
+#include "gossip.h"
+#include "pint-slab.h"
+
+#ifdef __GEN_POSIX_LOCKING__
+
+#include <pthread.h>
+#include <sys/mman.h>
+
+#define SLAB_MIN_SHIFT 6            /* smallest class is 64 bytes */
+#define SLAB_CLASS_COUNT 33         /* largest class is 16 KiB */
+#define SLAB_BLOCK_SHIFT 16
+#define SLAB_BLOCK_SIZE (1UL << SLAB_BLOCK_SHIFT)
+#define SLAB_REGION_SIZE (16 * SLAB_BLOCK_SIZE)
+#define SLAB_MAX_BYTES (256UL * 1024 * 1024)
+#define SLAB_MAX_BLOCKS (SLAB_MAX_BYTES / SLAB_BLOCK_SIZE)
+/* one slot per block, with room to spare */
+#define SLAB_BLOCK_SLOTS (4 * SLAB_MAX_BLOCKS)
+/* bytes moved between a thread cache and a depot at a time */
+#define SLAB_BATCH_BYTES (32 * 1024)
+
+/* stores a counter only its own thread updates, so that stats can read
+ * it while the thread runs */
+#define SLAB_COUNT(__c) \
+    __atomic_store_n(&(__c), (__c) + 1, __ATOMIC_RELAXED)
+
+struct slab_list
+{
+    void *head;               /* linked through the first word */
+    int count;
+};
+
+/* a thread's free lists */
+struct slab_thread_cache
+{
+    struct slab_list lists[SLAB_CLASS_COUNT];
+    uint64_t allocs;
+    uint64_t frees;
+    uint64_t refills;
+    uint64_t drains;
+    struct slab_thread_cache *next;
+};
+
+/* objects of one class not held by any thread */
+struct slab_depot
+{
+    gen_mutex_t mutex;
+    struct slab_list list;
+};
+
+static struct slab_depot depots[SLAB_CLASS_COUNT];
+static gen_mutex_t slab_mutex = GEN_MUTEX_INITIALIZER;
+static pthread_key_t slab_key;
+static int slab_ready = 0;
+static int slab_enabled = 1;
+
+/* under slab_mutex */
+static struct slab_thread_cache *slab_caches = NULL;
+static struct PINT_slab_stats slab_retired;  /* from exited threads */
+static char *carve_next = NULL;
+static char *carve_end = NULL;
+static uint64_t block_count = 0;
+static uint64_t region_count = 0;
+static size_t bytes_mapped = 0;
+
+static uint64_t fallbacks = 0;
+static uint64_t fallback_frees = 0;
+
+/* maps a block to its class.  Keys are the address shifted by
+ * SLAB_BLOCK_SHIFT, 0 marks a free slot.  Slots are only ever filled,
+ * so lookups need no lock.
+ */
+static uintptr_t block_keys[SLAB_BLOCK_SLOTS];
+static int block_classes[SLAB_BLOCK_SLOTS];
+
+static void slab_thread_exit(void *arg);
+
+static void slab_initialize(void)
+{
+    int i;
+
+    gen_mutex_lock(&slab_mutex);
+    if(!slab_ready)
+    {
+        for(i = 0; i < SLAB_CLASS_COUNT; i++)
+        {
+            gen_mutex_init(&depots[i].mutex);
+        }
+        if(pthread_key_create(&slab_key, slab_thread_exit) != 0 ||
+           getenv("PVFS2_SLAB_DISABLE"))
+        {
+            slab_enabled = 0;
+        }
+        __atomic_store_n(&slab_ready, 1, __ATOMIC_RELEASE);
+    }
+    gen_mutex_unlock(&slab_mutex);
+}
+
+static size_t slab_class_size(int cls)
+{
+    size_t base;
+
+    if(cls == 0)
+    {
+        return 1UL << SLAB_MIN_SHIFT;
+    }
+    base = 1UL << (SLAB_MIN_SHIFT + (cls - 1) / 4);
+    return base + ((cls - 1) % 4 + 1) * (base / 4);
+}
+
+/* returns the smallest class that holds size, or -1 if none does */
+static int slab_class_of(size_t size)
+{
+    int shift;
+
+    if(size <= (1UL << SLAB_MIN_SHIFT))
+    {
+        return 0;
+    }
+    if(size > PINT_SLAB_MAX_SIZE)
+    {
+        return -1;
+    }
+    /* size - 1 lies in [2^shift, 2^(shift + 1)) */
+    shift = (int)(8 * sizeof(unsigned long)) - 1 -
+        __builtin_clzl((unsigned long)(size - 1));
+    return (shift - SLAB_MIN_SHIFT) * 4 + 1 +
+        (int)((size - 1 - (1UL << shift)) >> (shift - 2));
+}
+
+static int slab_batch(int cls)
+{
+    int batch = SLAB_BATCH_BYTES / slab_class_size(cls);
+
+    return batch < 4 ? 4 : (batch > 64 ? 64 : batch);
+}
+
+static int slab_block_slot(uintptr_t key)
+{
+    return (int)((key * 0x9e3779b97f4a7c15ULL) >> 40) % SLAB_BLOCK_SLOTS;
+}
+
+/* returns the class of the block ptr is in, or -1 if it is not in one */
+static int slab_find_class(void *ptr)
+{
+    uintptr_t key = (uintptr_t)ptr >> SLAB_BLOCK_SHIFT;
+    uintptr_t cur;
+    int slot, n;
+
+    if(key == 0)
+    {
+        return -1;
+    }
+    slot = slab_block_slot(key);
+    for(n = 0; n < SLAB_BLOCK_SLOTS; n++)
+    {
+        cur = __atomic_load_n(&block_keys[slot], __ATOMIC_ACQUIRE);
+        if(cur == key)
+        {
+            return block_classes[slot];
+        }
+        if(cur == 0)
+        {
+            return -1;
+        }
+        slot = (slot + 1) % SLAB_BLOCK_SLOTS;
+    }
+    return -1;
+}
+
+/* maps a region aligned to SLAB_BLOCK_SIZE; called with slab_mutex held */
+static int slab_map_region(void)
+{
+    char *p, *aligned;
+    size_t head, tail;
+
+    if(bytes_mapped + SLAB_REGION_SIZE > SLAB_MAX_BYTES)
+    {
+        return -PVFS_ENOMEM;
+    }
+    p = mmap(NULL, SLAB_REGION_SIZE + SLAB_BLOCK_SIZE,
+             PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(p == MAP_FAILED)
+    {
+        gossip_err("%s: failed to map %lu byte region: %s\n",
+                   __func__, (unsigned long)SLAB_REGION_SIZE,
+                   strerror(errno));
+        return -PVFS_ENOMEM;
+    }
+    aligned = (char *)(((uintptr_t)p + SLAB_BLOCK_SIZE - 1) &
+                       ~(uintptr_t)(SLAB_BLOCK_SIZE - 1));
+    head = aligned - p;
+    tail = SLAB_BLOCK_SIZE - head;
+    if(head)
+    {
+        munmap(p, head);
+    }
+    if(tail)
+    {
+        munmap(aligned + SLAB_REGION_SIZE, tail);
+    }
+    carve_next = aligned;
+    carve_end = aligned + SLAB_REGION_SIZE;
+    region_count++;
+    bytes_mapped += SLAB_REGION_SIZE;
+    return 0;
+}
+
+/* cuts a new block for the depot of cls; called with its mutex held.
+ * Returns 0 on success, -PVFS_ENOMEM if the caches are full.
+ */
+static int slab_add_block(struct slab_depot *depot, int cls)
+{
+    size_t size = slab_class_size(cls);
+    uintptr_t key;
+    char *block, *obj;
+    int slot;
+
+    gen_mutex_lock(&slab_mutex);
+    if(carve_next == carve_end && slab_map_region() < 0)
+    {
+        gen_mutex_unlock(&slab_mutex);
+        return -PVFS_ENOMEM;
+    }
+    block = carve_next;
+    carve_next += SLAB_BLOCK_SIZE;
+
+    key = (uintptr_t)block >> SLAB_BLOCK_SHIFT;
+    slot = slab_block_slot(key);
+    while(block_keys[slot] != 0)
+    {
+        slot = (slot + 1) % SLAB_BLOCK_SLOTS;
+    }
+    block_classes[slot] = cls;
+    __atomic_store_n(&block_keys[slot], key, __ATOMIC_RELEASE);
+    block_count++;
+    gen_mutex_unlock(&slab_mutex);
+
+    for(obj = block; obj + size <= block + SLAB_BLOCK_SIZE; obj += size)
+    {
+        *(void **)obj = depot->list.head;
+        depot->list.head = obj;
+        depot->list.count++;
+    }
+    return 0;
+}
+
+/* moves up to count objects from the head of one list to another */
+static void slab_move(struct slab_list *from, struct slab_list *to,
+                      int count)
+{
+    void *obj;
+
+    while(count-- > 0 && from->head)
+    {
+        obj = from->head;
+        from->head = *(void **)obj;
+        from->count--;
+        *(void **)obj = to->head;
+        to->head = obj;
+        to->count++;
+    }
+}
+
+static struct slab_thread_cache *slab_get_cache(void)
+{
+    struct slab_thread_cache *tc;
+
+    tc = pthread_getspecific(slab_key);
+    if(tc)
+    {
+        return tc;
+    }
+    tc = calloc(1, sizeof(*tc));
+    if(!tc)
+    {
+        return NULL;
+    }
+    gen_mutex_lock(&slab_mutex);
+    tc->next = slab_caches;
+    slab_caches = tc;
+    gen_mutex_unlock(&slab_mutex);
+    pthread_setspecific(slab_key, tc);
+    return tc;
+}
+
+/* gives everything an exiting thread holds back to the depots */
+static void slab_thread_exit(void *arg)
+{
+    struct slab_thread_cache *tc = arg, **p;
+    int cls;
+
+    for(cls = 0; cls < SLAB_CLASS_COUNT; cls++)
+    {
+        if(tc->lists[cls].count)
+        {
+            gen_mutex_lock(&depots[cls].mutex);
+            slab_move(&tc->lists[cls], &depots[cls].list,
+                      tc->lists[cls].count);
+            gen_mutex_unlock(&depots[cls].mutex);
+        }
+    }
+
+    gen_mutex_lock(&slab_mutex);
+    for(p = &slab_caches; *p; p = &(*p)->next)
+    {
+        if(*p == tc)
+        {
+            *p = tc->next;
+            break;
+        }
+    }
+    slab_retired.allocs += tc->allocs;
+    slab_retired.frees += tc->frees;
+    slab_retired.refills += tc->refills;
+    slab_retired.drains += tc->drains;
+    gen_mutex_unlock(&slab_mutex);
+    free(tc);
+}
+
+/* PINT_slab_alloc()
+ *
+ * allocates at least size bytes, aligned to 16, from the calling
+ * thread's cache if it can.  The memory is not zeroed and must be
+ * released with PINT_slab_free().
+ *
+ * returns pointer to memory on success, NULL on failure
+ */
+void *PINT_slab_alloc(size_t size)
+{
+    struct slab_thread_cache *tc;
+    struct slab_list *list;
+    struct slab_depot *depot;
+    void *ptr;
+    int cls;
+
+    if(!__atomic_load_n(&slab_ready, __ATOMIC_ACQUIRE))
+    {
+        slab_initialize();
+    }
+
+    cls = slab_class_of(size);
+    if(cls >= 0 && __atomic_load_n(&slab_enabled, __ATOMIC_RELAXED) &&
+       (tc = slab_get_cache()) != NULL)
+    {
+        list = &tc->lists[cls];
+        if(!list->head)
+        {
+            depot = &depots[cls];
+            gen_mutex_lock(&depot->mutex);
+            if(depot->list.head || slab_add_block(depot, cls) == 0)
+            {
+                slab_move(&depot->list, list, slab_batch(cls));
+                SLAB_COUNT(tc->refills);
+            }
+            gen_mutex_unlock(&depot->mutex);
+        }
+        if(list->head)
+        {
+            ptr = list->head;
+            list->head = *(void **)ptr;
+            list->count--;
+            SLAB_COUNT(tc->allocs);
+            return ptr;
+        }
+    }
+
+    __atomic_fetch_add(&fallbacks, 1, __ATOMIC_RELAXED);
+    return malloc(size ? size : 1);
+}
+
+/* PINT_slab_zalloc()
+ *
+ * PINT_slab_alloc(), with the memory zeroed
+ */
+void *PINT_slab_zalloc(size_t size)
+{
+    void *ptr = PINT_slab_alloc(size);
+
+    if(ptr)
+    {
+        memset(ptr, 0, size);
+    }
+    return ptr;
+}
+
+/* PINT_slab_free()
+ *
+ * releases memory from PINT_slab_alloc() or malloc()
+ *
+ * no return value
+ */
+void PINT_slab_free(void *ptr)
+{
+    struct slab_thread_cache *tc;
+    struct slab_list *list;
+    struct slab_depot *depot;
+    int cls, batch;
+
+    if(!ptr)
+    {
+        return;
+    }
+
+    cls = slab_find_class(ptr);
+    if(cls < 0)
+    {
+        __atomic_fetch_add(&fallback_frees, 1, __ATOMIC_RELAXED);
+        free(ptr);
+        return;
+    }
+
+    tc = slab_get_cache();
+    if(!tc)
+    {
+        /* no cache for this thread; give it straight to the depot */
+        depot = &depots[cls];
+        gen_mutex_lock(&depot->mutex);
+        *(void **)ptr = depot->list.head;
+        depot->list.head = ptr;
+        depot->list.count++;
+        gen_mutex_unlock(&depot->mutex);
+        return;
+    }
+
+    list = &tc->lists[cls];
+    *(void **)ptr = list->head;
+    list->head = ptr;
+    list->count++;
+    SLAB_COUNT(tc->frees);
+
+    batch = slab_batch(cls);
+    if(list->count > 2 * batch)
+    {
+        depot = &depots[cls];
+        gen_mutex_lock(&depot->mutex);
+        slab_move(list, &depot->list, batch);
+        gen_mutex_unlock(&depot->mutex);
+        SLAB_COUNT(tc->drains);
+    }
+}
+
+/* PINT_slab_enable()
+ *
+ * turns the caches on or off.  While they are off every allocation goes
+ * to malloc; memory already handed out may still be freed either way.
+ *
+ * no return value
+ */
+void PINT_slab_enable(int enabled)
+{
+    if(!__atomic_load_n(&slab_ready, __ATOMIC_ACQUIRE))
+    {
+        slab_initialize();
+    }
+    __atomic_store_n(&slab_enabled, enabled ? 1 : 0, __ATOMIC_RELAXED);
+}
+
+/* PINT_slab_get_stats()
+ *
+ * fills in stats with the slab counters since the process started
+ *
+ * no return value
+ */
+void PINT_slab_get_stats(struct PINT_slab_stats *stats)
+{
+    struct slab_thread_cache *tc;
+
+    memset(stats, 0, sizeof(*stats));
+    stats->fallbacks = __atomic_load_n(&fallbacks, __ATOMIC_RELAXED);
+    stats->fallback_frees =
+        __atomic_load_n(&fallback_frees, __ATOMIC_RELAXED);
+    if(!__atomic_load_n(&slab_ready, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    gen_mutex_lock(&slab_mutex);
+    stats->allocs = slab_retired.allocs;
+    stats->frees = slab_retired.frees;
+    stats->refills = slab_retired.refills;
+    stats->drains = slab_retired.drains;
+    for(tc = slab_caches; tc; tc = tc->next)
+    {
+        stats->allocs += __atomic_load_n(&tc->allocs, __ATOMIC_RELAXED);
+        stats->frees += __atomic_load_n(&tc->frees, __ATOMIC_RELAXED);
+        stats->refills += __atomic_load_n(&tc->refills, __ATOMIC_RELAXED);
+        stats->drains += __atomic_load_n(&tc->drains, __ATOMIC_RELAXED);
+    }
+    stats->blocks = block_count;
+    stats->regions = region_count;
+    stats->bytes_mapped = bytes_mapped;
+    gen_mutex_unlock(&slab_mutex);
+}
+
+#else /* __GEN_POSIX_LOCKING__ */
+
+static uint64_t fallbacks = 0;
+static uint64_t fallback_frees = 0;
+
+void *PINT_slab_alloc(size_t size)
+{
+    fallbacks++;
+    return malloc(size ? size : 1);
+}
+
+void *PINT_slab_zalloc(size_t size)
+{
+    fallbacks++;
+    return calloc(1, size ? size : 1);
+}
+
+void PINT_slab_free(void *ptr)
+{
+    if(ptr)
+    {
+        fallback_frees++;
+        free(ptr);
+    }
+}
+
+void PINT_slab_enable(int enabled)
+{
+}
+
+void PINT_slab_get_stats(struct PINT_slab_stats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->fallbacks = fallbacks;
+    stats->fallback_frees = fallback_frees;
+}
+
+#endif /* __GEN_POSIX_LOCKING__ */
+
+/* arena chunks hold at least this much, header included */
+#define SLAB_ARENA_CHUNK 4096
+
+struct PINT_slab_arena
+{
+    struct PINT_slab_arena *next;   /* chunk carved before this one */
+    size_t used;
+    size_t size;
+};
+
+#define SLAB_ARENA_HEADER \
+    ((sizeof(struct PINT_slab_arena) + 15) & ~(size_t)15)
+
+/* PINT_slab_arena_alloc()
+ *
+ * carves size bytes, aligned to 16 and zeroed, from the arena, adding
+ * a chunk to it if the newest one is full.  *arena must start out NULL.
+ * The memory stays valid until PINT_slab_arena_release().
+ *
+ * returns pointer to memory on success, NULL on failure
+ */
+void *PINT_slab_arena_alloc(struct PINT_slab_arena **arena, size_t size)
+{
+    struct PINT_slab_arena *chunk = *arena;
+    size_t len;
+    char *ptr;
+
+    size = (size + 15) & ~(size_t)15;
+    if(!chunk || chunk->size - chunk->used < size)
+    {
+        len = SLAB_ARENA_HEADER + size;
+        if(len < SLAB_ARENA_CHUNK)
+        {
+            len = SLAB_ARENA_CHUNK;
+        }
+        chunk = PINT_slab_alloc(len);
+        if(!chunk)
+        {
+            return NULL;
+        }
+        chunk->used = 0;
+        chunk->size = len - SLAB_ARENA_HEADER;
+        if(*arena && (*arena)->size - (*arena)->used >
+           chunk->size - size)
+        {
+            /* a large buffer; keep carving from the chunk before it */
+            chunk->next = (*arena)->next;
+            (*arena)->next = chunk;
+        }
+        else
+        {
+            chunk->next = *arena;
+            *arena = chunk;
+        }
+    }
+
+    ptr = (char *)chunk + SLAB_ARENA_HEADER + chunk->used;
+    chunk->used += size;
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+/* PINT_slab_arena_release()
+ *
+ * frees every chunk of the arena and sets *arena to NULL
+ *
+ * no return value
+ */
+void PINT_slab_arena_release(struct PINT_slab_arena **arena)
+{
+    struct PINT_slab_arena *chunk, *next;
+
+    for(chunk = *arena; chunk; chunk = next)
+    {
+        next = chunk->next;
+        PINT_slab_free(chunk);
+    }
+    *arena = NULL;
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
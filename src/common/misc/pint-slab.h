@@ -0,0 +1,56 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+#ifndef __PINT_SLAB_H
+#define __PINT_SLAB_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* largest request served from a slab; larger ones go to malloc */
+#define PINT_SLAB_MAX_SIZE 16384
+
+/* counters kept by the slab caches.  blocks, fallbacks and
+ * fallback_frees are the calls the caches made into the system
+ * allocator.
+ */
+struct PINT_slab_stats
+{
+    uint64_t allocs;          /* objects handed out from a thread cache */
+    uint64_t frees;           /* objects returned to a thread cache */
+    uint64_t refills;         /* thread caches refilled from a depot */
+    uint64_t drains;          /* thread caches drained to a depot */
+    uint64_t blocks;          /* slab blocks carved from mapped memory */
+    uint64_t regions;         /* regions mapped for blocks */
+    uint64_t fallbacks;       /* allocations passed to malloc */
+    uint64_t fallback_frees;  /* frees passed to free */
+    uint64_t bytes_mapped;    /* total size of all regions */
+};
+
+void *PINT_slab_alloc(size_t size);
+void *PINT_slab_zalloc(size_t size);
+void PINT_slab_free(void *ptr);
+void PINT_slab_enable(int enabled);
+void PINT_slab_get_stats(struct PINT_slab_stats *stats);
+
+/* a per-request arena: buffers are carved from slab chunks and all of
+ * them are released together by PINT_slab_arena_release()
+ */
+struct PINT_slab_arena;
+
+void *PINT_slab_arena_alloc(struct PINT_slab_arena **arena, size_t size);
+void PINT_slab_arena_release(struct PINT_slab_arena **arena);
+
+#endif /* __PINT_SLAB_H */
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
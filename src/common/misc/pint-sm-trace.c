@@ -0,0 +1,503 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* State machine transition tracer; see pint-sm-trace.h. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "pvfs2-types.h"
+#include "pvfs2-internal.h"
+#include "gossip.h"
+#include "pvfs2-debug.h"
+#include "gen-locks.h"
+#include "state-machine.h"
+#include "pint-sm-trace.h"
+
+int PINT_sm_trace_on = 0;
+
+#ifdef __GEN_POSIX_LOCKING__
+
+#include <pthread.h>
+
+/* per-thread ring of trace records.  Only the owning thread writes
+ * records and advances head.  Each record is guarded by its seq: the
+ * record at ring position pos has seq 2 * pos + 1 while it is written
+ * and 2 * pos + 2 once complete, so a dump keeps a copy only if seq
+ * held the completed value for that position both before and after it
+ * was copied.
+ */
+struct sm_trace_ring
+{
+    uint64_t head;              /* total records ever written */
+    uint32_t mask;              /* ring size - 1 */
+    int orphaned;               /* owning thread has exited */
+    struct PINT_sm_trace_rec *recs;
+    struct sm_trace_ring *next;
+};
+
+static gen_mutex_t sm_trace_mutex = GEN_MUTEX_INITIALIZER;
+static struct sm_trace_ring *sm_trace_rings = NULL;
+static uint32_t sm_trace_ring_size = 0;
+static pthread_key_t sm_trace_key;
+static int sm_trace_key_created = 0;
+
+/* names of the states seen by the tracer, copied when a state is first
+ * recorded.  Slots are only ever added, so lookups take no lock; addr is
+ * published last.  A full table leaves later states unnamed in dumps.
+ */
+#define SM_TRACE_NAMES_SIZE 8192
+
+struct sm_trace_name
+{
+    uint64_t addr;
+    char *machine;
+    char *state;
+};
+
+static struct sm_trace_name sm_trace_names[SM_TRACE_NAMES_SIZE];
+static uint64_t sm_trace_name_count = 0;
+
+static void sm_trace_thread_exit(void *arg);
+static struct sm_trace_ring *sm_trace_get_ring(void);
+static void sm_trace_name_state(const struct PINT_state_s *state);
+
+/* PINT_sm_trace_enable()
+ *
+ * starts recording state machine transitions.  records is the number of
+ * records kept per thread and is rounded up to a power of two, up to
+ * PINT_SM_TRACE_MAX_RECORDS.  The ring size is fixed by the first call;
+ * later calls only turn recording back on.
+ *
+ * returns 0 on success, -PVFS_error on failure
+ */
+int PINT_sm_trace_enable(int records)
+{
+    uint32_t size = 1;
+
+    if (records <= 0)
+    {
+        return -PVFS_EINVAL;
+    }
+
+    gen_mutex_lock(&sm_trace_mutex);
+    if (!sm_trace_key_created)
+    {
+        if (pthread_key_create(&sm_trace_key, sm_trace_thread_exit) != 0)
+        {
+            gen_mutex_unlock(&sm_trace_mutex);
+            return -PVFS_ENOMEM;
+        }
+        sm_trace_key_created = 1;
+    }
+    if (sm_trace_ring_size == 0)
+    {
+        while (size < (uint32_t) records && size < PINT_SM_TRACE_MAX_RECORDS)
+        {
+            size <<= 1;
+        }
+        sm_trace_ring_size = size;
+    }
+    gen_mutex_unlock(&sm_trace_mutex);
+
+    gossip_debug(GOSSIP_STATE_MACHINE_DEBUG,
+                 "state machine tracing enabled, %u records per thread\n",
+                 sm_trace_ring_size);
+    __atomic_store_n(&PINT_sm_trace_on, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/* PINT_sm_trace_disable()
+ *
+ * stops recording; rings and their contents are kept for later dumps
+ */
+void PINT_sm_trace_disable(void)
+{
+    __atomic_store_n(&PINT_sm_trace_on, 0, __ATOMIC_RELEASE);
+}
+
+/* PINT_sm_trace_finalize()
+ *
+ * stops recording and releases every ring.  Must only be called once
+ * no other thread can be driving a state machine.
+ */
+void PINT_sm_trace_finalize(void)
+{
+    struct sm_trace_ring *ring, *next;
+    int i;
+
+    PINT_sm_trace_disable();
+
+    gen_mutex_lock(&sm_trace_mutex);
+    for (ring = sm_trace_rings; ring; ring = next)
+    {
+        next = ring->next;
+        free(ring->recs);
+        free(ring);
+    }
+    sm_trace_rings = NULL;
+    sm_trace_ring_size = 0;
+    for (i = 0; i < SM_TRACE_NAMES_SIZE; i++)
+    {
+        if (sm_trace_names[i].addr)
+        {
+            free(sm_trace_names[i].machine);
+            free(sm_trace_names[i].state);
+            memset(&sm_trace_names[i], 0, sizeof(sm_trace_names[i]));
+        }
+    }
+    sm_trace_name_count = 0;
+    if (sm_trace_key_created)
+    {
+        pthread_setspecific(sm_trace_key, NULL);
+        pthread_key_delete(sm_trace_key);
+        sm_trace_key_created = 0;
+    }
+    gen_mutex_unlock(&sm_trace_mutex);
+}
+
+uint64_t PINT_sm_trace_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void PINT_sm_trace_record(int kind, const void *smcb, uint64_t arg,
+                          int32_t op, int value)
+{
+    struct sm_trace_ring *ring;
+    struct PINT_sm_trace_rec *rec;
+    uint64_t pos;
+
+    ring = pthread_getspecific(sm_trace_key);
+    if (!ring)
+    {
+        ring = sm_trace_get_ring();
+        if (!ring)
+        {
+            return;
+        }
+    }
+
+    if (kind == PINT_SM_TRACE_START || kind == PINT_SM_TRACE_STATE ||
+        kind == PINT_SM_TRACE_ACTION)
+    {
+        sm_trace_name_state((const struct PINT_state_s *) (uintptr_t) arg);
+    }
+
+    pos = ring->head;
+    rec = &ring->recs[pos & ring->mask];
+    __atomic_store_n(&rec->seq, 2 * pos + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    rec->ns = PINT_sm_trace_now();
+    rec->smcb = (uint64_t) (uintptr_t) smcb;
+    rec->arg = arg;
+    rec->op = op;
+    rec->kind = (uint16_t) kind;
+    rec->value = (int16_t) value;
+    __atomic_store_n(&rec->seq, 2 * pos + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->head, pos + 1, __ATOMIC_RELEASE);
+}
+
+/* sm_trace_name_state()
+ *
+ * copies the machine and state names of state into the name table the
+ * first time state is recorded
+ */
+static void sm_trace_name_state(const struct PINT_state_s *state)
+{
+    uint64_t addr = (uint64_t) (uintptr_t) state;
+    uint64_t i, start, cur;
+    const char *mname;
+
+    if (!state)
+    {
+        return;
+    }
+
+    start = (addr >> 4) & (SM_TRACE_NAMES_SIZE - 1);
+    i = start;
+    do
+    {
+        cur = __atomic_load_n(&sm_trace_names[i].addr, __ATOMIC_ACQUIRE);
+        if (cur == addr)
+        {
+            return;
+        }
+        if (cur == 0)
+        {
+            break;
+        }
+        i = (i + 1) & (SM_TRACE_NAMES_SIZE - 1);
+    } while (i != start);
+
+    gen_mutex_lock(&sm_trace_mutex);
+    /* another thread may have claimed the slot or named the state */
+    for (i = start; ; i = (i + 1) & (SM_TRACE_NAMES_SIZE - 1))
+    {
+        if (sm_trace_names[i].addr == addr ||
+            sm_trace_name_count + 1 >= SM_TRACE_NAMES_SIZE)
+        {
+            break;
+        }
+        if (sm_trace_names[i].addr == 0)
+        {
+            mname = (state->parent_machine && state->parent_machine->name) ?
+                state->parent_machine->name : "";
+            sm_trace_names[i].machine = strdup(mname);
+            sm_trace_names[i].state =
+                strdup(state->state_name ? state->state_name : "");
+            if (!sm_trace_names[i].machine || !sm_trace_names[i].state)
+            {
+                free(sm_trace_names[i].machine);
+                free(sm_trace_names[i].state);
+                sm_trace_names[i].machine = NULL;
+                sm_trace_names[i].state = NULL;
+                break;
+            }
+            sm_trace_name_count++;
+            __atomic_store_n(&sm_trace_names[i].addr, addr, __ATOMIC_RELEASE);
+            break;
+        }
+    }
+    gen_mutex_unlock(&sm_trace_mutex);
+}
+
+/* the ring of an exiting thread is kept for dumps and handed to the
+ * next thread that needs one
+ */
+static void sm_trace_thread_exit(void *arg)
+{
+    struct sm_trace_ring *ring = arg;
+
+    gen_mutex_lock(&sm_trace_mutex);
+    ring->orphaned = 1;
+    gen_mutex_unlock(&sm_trace_mutex);
+}
+
+static struct sm_trace_ring *sm_trace_get_ring(void)
+{
+    struct sm_trace_ring *ring;
+
+    gen_mutex_lock(&sm_trace_mutex);
+    if (sm_trace_ring_size == 0)
+    {
+        gen_mutex_unlock(&sm_trace_mutex);
+        return NULL;
+    }
+
+    for (ring = sm_trace_rings; ring; ring = ring->next)
+    {
+        if (ring->orphaned)
+        {
+            ring->orphaned = 0;
+            break;
+        }
+    }
+    if (!ring)
+    {
+        ring = calloc(1, sizeof(*ring));
+        if (ring)
+        {
+            ring->recs = calloc(sm_trace_ring_size, sizeof(*ring->recs));
+            if (!ring->recs)
+            {
+                free(ring);
+                ring = NULL;
+            }
+        }
+        if (!ring)
+        {
+            gen_mutex_unlock(&sm_trace_mutex);
+            return NULL;
+        }
+        ring->mask = sm_trace_ring_size - 1;
+        ring->next = sm_trace_rings;
+        sm_trace_rings = ring;
+    }
+    pthread_setspecific(sm_trace_key, ring);
+    gen_mutex_unlock(&sm_trace_mutex);
+
+    return ring;
+}
+
+/* PINT_sm_trace_dump()
+ *
+ * writes the contents of every ring to the given file, which must not
+ * already exist.  Rings are copied while their threads keep recording;
+ * a record that changed while it was copied is left out.
+ *
+ * returns 0 on success, -PVFS_error on failure
+ */
+int PINT_sm_trace_dump(const char *path)
+{
+    struct PINT_sm_trace_file_header hdr;
+    struct sm_trace_ring *ring;
+    struct PINT_sm_trace_rec *recs = NULL, *rec, *src;
+    struct timeval tv;
+    uint64_t head, n, i, seq, total = 0;
+    uint16_t mlen, slen;
+    FILE *fp;
+    int ret = 0;
+    int fd;
+
+    memset(&hdr, 0, sizeof(hdr));
+
+    fd = open(path, O_WRONLY | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+    {
+        return -PVFS_errno_to_error(errno);
+    }
+    fp = fdopen(fd, "w");
+    if (!fp)
+    {
+        close(fd);
+        return -PVFS_ENOMEM;
+    }
+
+    gen_mutex_lock(&sm_trace_mutex);
+    for (ring = sm_trace_rings; ring; ring = ring->next)
+    {
+        hdr.nthreads++;
+        total += ring->mask + 1;
+    }
+    if (total)
+    {
+        recs = malloc(total * sizeof(*recs));
+        if (!recs)
+        {
+            ret = -PVFS_ENOMEM;
+            goto out;
+        }
+    }
+
+    /* copy the live part of each ring, oldest record first */
+    for (ring = sm_trace_rings; ring; ring = ring->next)
+    {
+        head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        n = (head > ring->mask + 1) ? ring->mask + 1 : head;
+        for (i = head - n; i < head; i++)
+        {
+            src = &ring->recs[i & ring->mask];
+            rec = &recs[hdr.nrecords];
+
+            seq = __atomic_load_n(&src->seq, __ATOMIC_ACQUIRE);
+            if (seq != 2 * i + 2)
+            {
+                /* being written, or already overwritten by a later lap */
+                continue;
+            }
+            *rec = *src;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&src->seq, __ATOMIC_RELAXED) != seq ||
+                rec->kind == PINT_SM_TRACE_INVALID)
+            {
+                continue;
+            }
+            hdr.nrecords++;
+        }
+    }
+
+    /* the lock is held until the names are written so that no state is
+     * named after nstates is counted
+     */
+    hdr.nstates = sm_trace_name_count;
+
+    memcpy(hdr.magic, PINT_SM_TRACE_MAGIC, sizeof(hdr.magic));
+    hdr.version = PINT_SM_TRACE_VERSION;
+    gettimeofday(&tv, NULL);
+    hdr.wall_ns = (uint64_t) tv.tv_sec * 1000000000ULL + tv.tv_usec * 1000;
+    hdr.mono_ns = PINT_sm_trace_now();
+
+    if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1 ||
+        (hdr.nrecords &&
+         fwrite(recs, sizeof(*recs), hdr.nrecords, fp) != hdr.nrecords))
+    {
+        ret = -PVFS_EIO;
+        goto out;
+    }
+
+    for (i = 0; i < SM_TRACE_NAMES_SIZE; i++)
+    {
+        if (!sm_trace_names[i].addr)
+        {
+            continue;
+        }
+        mlen = strlen(sm_trace_names[i].machine);
+        slen = strlen(sm_trace_names[i].state);
+        if (fwrite(&sm_trace_names[i].addr, sizeof(uint64_t), 1, fp) != 1 ||
+            fwrite(&mlen, sizeof(mlen), 1, fp) != 1 ||
+            fwrite(&slen, sizeof(slen), 1, fp) != 1 ||
+            fwrite(sm_trace_names[i].machine, 1, mlen, fp) != mlen ||
+            fwrite(sm_trace_names[i].state, 1, slen, fp) != slen)
+        {
+            ret = -PVFS_EIO;
+            goto out;
+        }
+    }
+
+    gossip_debug(GOSSIP_STATE_MACHINE_DEBUG,
+                 "dumped %llu state machine trace records from %u threads "
+                 "to %s\n", llu(hdr.nrecords), hdr.nthreads, path);
+
+out:
+    gen_mutex_unlock(&sm_trace_mutex);
+    if (fclose(fp) != 0 && ret == 0)
+    {
+        ret = -PVFS_EIO;
+    }
+    free(recs);
+    return ret;
+}
+
+#else /* __GEN_POSIX_LOCKING__ */
+
+int PINT_sm_trace_enable(int records)
+{
+    return -PVFS_ENOSYS;
+}
+
+void PINT_sm_trace_disable(void)
+{
+}
+
+int PINT_sm_trace_dump(const char *path)
+{
+    return -PVFS_ENOSYS;
+}
+
+void PINT_sm_trace_finalize(void)
+{
+}
+
+uint64_t PINT_sm_trace_now(void)
+{
+    return 0;
+}
+
+void PINT_sm_trace_record(int kind, const void *smcb, uint64_t arg,
+                          int32_t op, int value)
+{
+}
+
+#endif /* __GEN_POSIX_LOCKING__ */
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
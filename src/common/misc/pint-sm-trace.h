@@ -0,0 +1,103 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* State machine transition tracer.
+ *
+ * Every thread that drives a state machine records fixed size binary
+ * records into its own ring: one when a state machine starts (plus one
+ * naming the parent of a child machine), one each time a state action
+ * is entered and returns, one when a job handed back to a state
+ * machine completes, and one when the machine terminates.  Recording is
+ * compiled in unconditionally; when tracing is disabled the hooks cost a
+ * single branch.  Rings overwrite their
+ * oldest records, so a dump always holds the most recent history.
+ *
+ * PINT_sm_trace_dump() writes the rings, together with a table that
+ * maps state addresses to machine and state names, to a file that is
+ * read by pvfs2-sm-trace-analyze.  The names are copied when a state is
+ * first recorded, so a dump never follows an address found in a record.
+ */
+
+#ifndef __PINT_SM_TRACE_H
+#define __PINT_SM_TRACE_H
+
+#include <stdint.h>
+
+#define PINT_SM_TRACE_MAGIC "PVFSSMT1"
+#define PINT_SM_TRACE_VERSION 2
+
+/* largest ring, in records, a thread may be given */
+#define PINT_SM_TRACE_MAX_RECORDS (1 << 20)
+
+enum PINT_sm_trace_kind
+{
+    PINT_SM_TRACE_INVALID = 0,
+    PINT_SM_TRACE_START = 1,    /* arg = outermost state */
+    PINT_SM_TRACE_STATE = 2,    /* arg = state entered */
+    PINT_SM_TRACE_ACTION = 3,   /* arg = state, value = PINT_sm_action */
+    PINT_SM_TRACE_JOB = 4,      /* arg = post time, value = job type */
+    PINT_SM_TRACE_TERM = 5,     /* arg = error code */
+    PINT_SM_TRACE_CHILD = 6     /* arg = parent smcb */
+};
+
+/* one trace record; also the on-disk record format */
+struct PINT_sm_trace_rec
+{
+    uint64_t seq;       /* odd while being written; see pint-sm-trace.c */
+    uint64_t ns;        /* CLOCK_MONOTONIC nanoseconds */
+    uint64_t smcb;      /* address of the state machine control block */
+    uint64_t arg;       /* meaning depends on kind */
+    int32_t op;         /* smcb->op */
+    uint16_t kind;      /* enum PINT_sm_trace_kind */
+    int16_t value;      /* meaning depends on kind */
+};
+
+/* dump file header; followed by nrecords records, then nstates
+ * entries of { uint64_t addr; uint16_t machine_len; uint16_t state_len;
+ * machine name; state name } with names not NUL terminated.
+ */
+struct PINT_sm_trace_file_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t nthreads;
+    uint64_t nrecords;
+    uint64_t nstates;
+    uint64_t wall_ns;   /* wall clock at dump time */
+    uint64_t mono_ns;   /* monotonic clock at dump time */
+};
+
+extern int PINT_sm_trace_on;
+
+int PINT_sm_trace_enable(int records);
+void PINT_sm_trace_disable(void);
+int PINT_sm_trace_dump(const char *path);
+void PINT_sm_trace_finalize(void);
+
+uint64_t PINT_sm_trace_now(void);
+void PINT_sm_trace_record(int kind, const void *smcb, uint64_t arg,
+                          int32_t op, int value);
+
+#define PINT_SM_TRACE(__kind, __smcb, __arg, __op, __value)        \
+do {                                                               \
+    if (PINT_sm_trace_on)                                          \
+    {                                                              \
+        PINT_sm_trace_record((__kind), (__smcb),                   \
+                             (uint64_t) (uintptr_t) (__arg),       \
+                             (__op), (__value));                   \
+    }                                                              \
+} while (0)
+
+#endif /* __PINT_SM_TRACE_H */
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
@@ -44,6 +44,10 @@
 static const char * replace_old_keystring(const char * oldkey);
 
 static DOTCONF_CB(get_logstamp);
+static DOTCONF_CB(get_async_log_buffer_size);
+static DOTCONF_CB(get_async_log_wait_msecs);
+static DOTCONF_CB(get_sm_trace_records);
+static DOTCONF_CB(get_sm_trace_dir);
 static DOTCONF_CB(get_storage_path);
 static DOTCONF_CB(get_data_path);
 static DOTCONF_CB(get_meta_path);
@@ -107,6 +111,8 @@ static DOTCONF_CB(get_attr_cache_max_num_elems);
 static DOTCONF_CB(get_trove_sync_meta);
 static DOTCONF_CB(get_trove_sync_data);
 static DOTCONF_CB(get_file_stuffing);
+static DOTCONF_CB(get_data_placement);
+static DOTCONF_CB(get_data_placement_refresh_secs);
 static DOTCONF_CB(get_trove_max_concurrent_io);
 /* Berkeley DB */
 static DOTCONF_CB(get_db_cache_size_bytes);
@@ -126,6 +132,8 @@ static DOTCONF_CB(get_precreate_low_threshold);
 static DOTCONF_CB(get_client_retry_limit);
 static DOTCONF_CB(get_client_retry_delay);
 static DOTCONF_CB(get_secret_key);
+static DOTCONF_CB(get_capability_mode);
+static DOTCONF_CB(get_capability_secret_file);
 static DOTCONF_CB(get_coalescing_high_watermark);
 static DOTCONF_CB(get_coalescing_low_watermark);
 static DOTCONF_CB(get_trove_method);
@@ -161,6 +169,7 @@ static DOTCONF_CB(get_ldap_search_timeout);
 
 static DOTCONF_CB(tree_width);
 static DOTCONF_CB(tree_threshold);
+static DOTCONF_CB(tree_adaptive);
 static DOTCONF_CB(distr_dir_servers_initial);
 static DOTCONF_CB(distr_dir_servers_max);
 static DOTCONF_CB(distr_dir_split_size);
@@ -868,6 +877,21 @@ static const configoption_t options[] =
     {"FileStuffing",ARG_STR, get_file_stuffing, NULL, 
         CTX_FILESYSTEM,"yes"},
 
+    /* Specifies how servers are chosen for the datafiles of new files.
+     * "roundrobin" walks the static server list.  "loadaware" favors
+     * servers with more free space and less load, using statistics each
+     * metadata server refreshes periodically from the I/O servers.  Files
+     * created with an explicit layout are placed as requested either way.
+     */
+    {"DataPlacement",ARG_STR, get_data_placement, NULL,
+        CTX_FILESYSTEM,"roundrobin"},
+
+    /* Specifies how often, in seconds, the server statistics used by
+     * "loadaware" data placement are refreshed.
+     */
+    {"DataPlacementRefreshSecs",ARG_INT, get_data_placement_refresh_secs,
+        NULL, CTX_FILESYSTEM,"10"},
+
      /* This specifies the number of samples
       * that performance monitor should keep
       *
@@ -904,11 +928,30 @@ static const configoption_t options[] =
 
     /* Specifies an options string to be passed to BMI upon initialization.
      * The format of the string is a comma-separated list of options.
-     * Currently, the only available option is:
+     * The available options are:
      *
      * <c>ib_port=N</c>, where <c>N</c> is the IB device port to use for
      * communication (default port is <c>1</c> if not specified).
      *
+     * <c>tcp_stripes=N</c>, where <c>N</c> (1 to 16, default <c>1</c>) is
+     * the number of TCP connections opened to each peer.  Messages of at
+     * least <c>tcp_stripe_min</c> bytes (default 1MB) are split across
+     * them.  Clients set the same options with <c>bmi_opts="..."</c> in
+     * the tab file; both ends must be new enough to understand them.
+     *
+     * <c>tcp_zerocopy=N</c> sends TCP messages of at least <c>N</c> bytes
+     * with MSG_ZEROCOPY (Linux 4.14 and later).  A connection goes back
+     * to copying if the kernel reports that it copied anyway, as it
+     * does over loopback.
+     *
+     * <c>tcp_busy_poll=N</c> spins on the TCP sockets for up to <c>N</c>
+     * microseconds before sleeping in them, and sets SO_BUSY_POLL on
+     * them.  It trades CPU time for latency.
+     *
+     * <c>tcp_coalesce=N</c> lets small TCP messages to a peer wait up to
+     * <c>N</c> microseconds to be written together with the ones posted
+     * after them.  They also go out as soon as BMI is tested.
+     *
      * For example:
      *
      * <c>BMIOpts ib_port=2</c>
@@ -954,6 +997,45 @@ static const configoption_t options[] =
     {"LogStamp",ARG_STR, get_logstamp,NULL,
         CTX_DEFAULTS|CTX_SERVER_OPTIONS,"usec"},
 
+    /* When non-zero, debug messages are handed to a background thread
+     * instead of being timestamped and written by the thread that logs
+     * them.  The value is the size in bytes of each logging thread's
+     * message ring.  Messages that arrive while a ring is full are
+     * dropped and the number dropped is reported in the log.  Error
+     * messages are always written immediately.  The default of 0 keeps
+     * all logging synchronous.
+     */
+    {"AsyncLogBufferSize",ARG_INT, get_async_log_buffer_size,NULL,
+        CTX_DEFAULTS|CTX_SERVER_OPTIONS,"0"},
+
+    /* With AsyncLogBufferSize set, a thread whose ring is full normally
+     * drops the message at once.  A non-zero value makes the thread wait
+     * up to this many milliseconds for the writer to make room first,
+     * which loses fewer messages at the cost of stalling the thread.
+     * The default is 0.
+     */
+    {"AsyncLogWaitMsecs",ARG_INT, get_async_log_wait_msecs,NULL,
+        CTX_DEFAULTS|CTX_SERVER_OPTIONS,"0"},
+
+    /* When non-zero, every thread that runs state machines records each
+     * state transition and job completion into a ring holding this many
+     * records (rounded up to a power of two, at most 1048576).  The
+     * rings can be dumped with pvfs2-sm-trace and examined with
+     * pvfs2-sm-trace-analyze.  Tracing can also be turned on and off at
+     * run time with pvfs2-sm-trace.  The default of 0 leaves tracing off
+     * at startup.
+     */
+    {"StateMachineTraceRecords",ARG_INT, get_sm_trace_records,NULL,
+        CTX_DEFAULTS|CTX_SERVER_OPTIONS,"0"},
+
+    /* Directory the server writes state machine trace dumps into.
+     * pvfs2-sm-trace only supplies a file name, which may not contain
+     * '/' or "..", and the dump is created as
+     * <StateMachineTraceDir>/<name>.<server alias>.
+     */
+    {"StateMachineTraceDir",ARG_STR, get_sm_trace_dir,NULL,
+        CTX_DEFAULTS|CTX_SERVER_OPTIONS,"/tmp"},
+
     /* buffer size to use for bulk data transfers */
     {"FlowBufferSizeBytes", ARG_INT,
          get_flow_buffer_size_bytes, NULL, CTX_FILESYSTEM,"262144"},
@@ -1067,6 +1149,13 @@ static const configoption_t options[] =
      * of the above values.  For example:
      *
      * <c>AttrCacheKeywords dh,md,de,st</c>
+     *
+     * Any other attribute key may be listed as well, up to eight keys in
+     * all.  A read that finds a listed key missing is remembered too, so
+     * keys that are usually absent are worth listing, such as <c>nd</c>
+     * (read on every file getattr to tell whether the file is still
+     * stuffed) or an extended attribute name like
+     * <c>user.pvfs2.dist_name</c>.
      */
     {"AttrCacheKeywords",ARG_LIST, get_attr_cache_keywords_list,NULL,
         CTX_STORAGEHINTS, 
@@ -1201,6 +1290,25 @@ static const configoption_t options[] =
      */
     {"SecretKey",ARG_STR, get_secret_key,NULL,CTX_FILESYSTEM,NULL},
 
+    /* Specifies how capabilities for this file system are signed when
+     * key-based or certificate-based security is enabled.  May be
+     * <c>publickey</c>, where each server signs with its private key, or
+     * <c>hmac</c>, where servers sign and verify with a secret shared
+     * among all servers of the file system (see
+     * <a href="#CapabilitySecretFile">CapabilitySecretFile</a>).  HMAC
+     * capabilities are much cheaper to verify.
+     */
+    {"CapabilityMode",ARG_STR, get_capability_mode,NULL,
+        CTX_FILESYSTEM,"publickey"},
+
+    /* Path to a file holding the secret used for HMAC capabilities.  The
+     * file must be identical on every server of the file system and
+     * should be readable only by the server.  The secret itself is never
+     * sent to clients.
+     */
+    {"CapabilitySecretFile",ARG_STR, get_capability_secret_file,NULL,
+        CTX_FILESYSTEM,NULL},
+
     /* Specifies the size of the small file transition point */
     {"SmallFileSize", ARG_INT, get_small_file_size, NULL, CTX_FILESYSTEM, NULL},
 
@@ -1227,6 +1335,17 @@ static const configoption_t options[] =
     {"TreeThreshold", ARG_INT, tree_threshold, NULL,
         CTX_FILESYSTEM, "2"},
 
+    /* When set to yes, each server chooses the width of tree communication
+     * from the number of servers involved and the round trip times and
+     * outstanding requests it has measured for them, picks the fastest
+     * servers to head subtrees, and resends the handles of a stalled
+     * getattr, get-file-size or setattr subtree directly to the servers
+     * that own them.  Removes are never resent.  TreeWidth and
+     * TreeThreshold are only used when this is set to no, the default.
+     */
+    {"TreeAdaptive", ARG_STR, tree_adaptive, NULL,
+        CTX_FILESYSTEM, "no"},
+
     /* Specifies the default for initial number of servers to hold directory entries. Note that this number cannot exceed 65535 (max value of a 16-bit unsigned integer). */
     {"DistrDirServersInitial", ARG_INT, distr_dir_servers_initial, NULL,
         CTX_FILESYSTEM, "1"},
@@ -1629,6 +1748,8 @@ DOTCONF_CB(enter_filesystem_context)
     fs_conf->fp_buffer_size = -1;
     fs_conf->fp_buffers_per_flow = -1;
     fs_conf->file_stuffing = 1;
+    fs_conf->data_placement = PINT_DATA_PLACEMENT_ROUND_ROBIN;
+    fs_conf->data_placement_refresh_secs = 10;
 
     if (!config_s->file_systems)
     {
@@ -2065,6 +2186,82 @@ DOTCONF_CB(get_logfile)
     return NULL;
 }
 
+DOTCONF_CB(get_async_log_buffer_size)
+{
+    struct server_configuration_s *config_s = 
+                    (struct server_configuration_s *)cmd->context;
+
+    if(config_s->configuration_context == CTX_SERVER_OPTIONS &&
+       config_s->my_server_options == 0)
+    {
+        return NULL;
+    }
+    if (cmd->data.value < 0)
+    {
+        return("AsyncLogBufferSize must not be negative.\n");
+    }
+    config_s->async_log_buffer_size = (int)cmd->data.value;
+    return NULL;
+}
+
+DOTCONF_CB(get_async_log_wait_msecs)
+{
+    struct server_configuration_s *config_s = 
+                    (struct server_configuration_s *)cmd->context;
+
+    if(config_s->configuration_context == CTX_SERVER_OPTIONS &&
+       config_s->my_server_options == 0)
+    {
+        return NULL;
+    }
+    if (cmd->data.value < 0)
+    {
+        return("AsyncLogWaitMsecs must not be negative.\n");
+    }
+    config_s->async_log_wait_msecs = (int)cmd->data.value;
+    return NULL;
+}
+
+DOTCONF_CB(get_sm_trace_records)
+{
+    struct server_configuration_s *config_s = 
+                    (struct server_configuration_s *)cmd->context;
+
+    if(config_s->configuration_context == CTX_SERVER_OPTIONS &&
+       config_s->my_server_options == 0)
+    {
+        return NULL;
+    }
+    if (cmd->data.value < 0)
+    {
+        return("StateMachineTraceRecords must not be negative.\n");
+    }
+    config_s->sm_trace_records = (int)cmd->data.value;
+    return NULL;
+}
+
+DOTCONF_CB(get_sm_trace_dir)
+{
+    struct server_configuration_s *config_s = 
+                    (struct server_configuration_s *)cmd->context;
+
+    if(config_s->configuration_context == CTX_SERVER_OPTIONS &&
+       config_s->my_server_options == 0)
+    {
+        return NULL;
+    }
+    if (!cmd->data.str || cmd->data.str[0] != '/')
+    {
+        return("StateMachineTraceDir must be an absolute path.\n");
+    }
+    if (config_s->sm_trace_dir)
+    {
+        free(config_s->sm_trace_dir);
+    }
+    config_s->sm_trace_dir = strdup(cmd->data.str);
+    return NULL;
+}
+
 DOTCONF_CB(get_logtype)
 {
     struct server_configuration_s *config_s = 
@@ -2828,6 +3025,51 @@ DOTCONF_CB(get_file_stuffing)
     return NULL;
 }
 
+DOTCONF_CB(get_data_placement)
+{
+    struct filesystem_configuration_s *fs_conf = NULL;
+    struct server_configuration_s *config_s = 
+                 (struct server_configuration_s *)cmd->context;
+
+    fs_conf = (struct filesystem_configuration_s *)
+                    PINT_llist_head(config_s->file_systems);
+    assert(fs_conf);
+
+    if(strcasecmp(cmd->data.str, "roundrobin") == 0)
+    {
+        fs_conf->data_placement = PINT_DATA_PLACEMENT_ROUND_ROBIN;
+    }
+    else if(strcasecmp(cmd->data.str, "loadaware") == 0)
+    {
+        fs_conf->data_placement = PINT_DATA_PLACEMENT_LOAD_AWARE;
+    }
+    else
+    {
+        return("DataPlacement value must be 'roundrobin' or "
+               "'loadaware'.\n");
+    }
+
+    return NULL;
+}
+
+DOTCONF_CB(get_data_placement_refresh_secs)
+{
+    struct filesystem_configuration_s *fs_conf = NULL;
+    struct server_configuration_s *config_s = 
+                 (struct server_configuration_s *)cmd->context;
+
+    fs_conf = (struct filesystem_configuration_s *)
+                    PINT_llist_head(config_s->file_systems);
+    assert(fs_conf);
+
+    if(cmd->data.value < 1)
+    {
+        return("DataPlacementRefreshSecs must be at least 1.\n");
+    }
+    fs_conf->data_placement_refresh_secs = (int)cmd->data.value;
+    return NULL;
+}
+
 
 DOTCONF_CB(get_trove_sync_meta)
 {
@@ -3298,6 +3540,49 @@ DOTCONF_CB(get_secret_key)
     return NULL;
 }
 
+DOTCONF_CB(get_capability_mode)
+{
+    struct server_configuration_s *config_s =
+        (struct server_configuration_s *)cmd->context;
+    struct filesystem_configuration_s *fs_conf = NULL;
+
+    fs_conf = (struct filesystem_configuration_s *)
+        PINT_llist_head(config_s->file_systems);
+    assert(fs_conf);
+
+    if (strcasecmp(cmd->data.str, "publickey") == 0)
+    {
+        fs_conf->capability_mode = PINT_CAP_MODE_PUBKEY;
+    }
+    else if (strcasecmp(cmd->data.str, "hmac") == 0)
+    {
+        fs_conf->capability_mode = PINT_CAP_MODE_HMAC;
+    }
+    else
+    {
+        return("CapabilityMode value must be 'publickey' or 'hmac'.\n");
+    }
+    return NULL;
+}
+
+DOTCONF_CB(get_capability_secret_file)
+{
+    struct server_configuration_s *config_s =
+        (struct server_configuration_s *)cmd->context;
+    struct filesystem_configuration_s *fs_conf = NULL;
+
+    fs_conf = (struct filesystem_configuration_s *)
+        PINT_llist_head(config_s->file_systems);
+    assert(fs_conf);
+
+    if (fs_conf->capability_secret_file)
+    {
+        free(fs_conf->capability_secret_file);
+    }
+    fs_conf->capability_secret_file = strdup(cmd->data.str);
+    return NULL;
+}
+
 DOTCONF_CB(get_immediate_completion)
 {
     struct server_configuration_s *config_s =
@@ -3923,6 +4208,27 @@ DOTCONF_CB(tree_threshold)
     return NULL;
 }
 
+DOTCONF_CB(tree_adaptive)
+{
+    struct server_configuration_s *config_s =
+        (struct server_configuration_s *)cmd->context;
+
+    if (strcasecmp(cmd->data.str, "yes") == 0)
+    {
+        config_s->tree_adaptive = 1;
+    }
+    else if (strcasecmp(cmd->data.str, "no") == 0)
+    {
+        config_s->tree_adaptive = 0;
+    }
+    else
+    {
+        return("TreeAdaptive value must be 'yes' or 'no'.\n");
+    }
+
+    return NULL;
+}
+
 DOTCONF_CB(distr_dir_servers_initial)
 {
     struct server_configuration_s *config_s =
@@ -4017,6 +4323,12 @@ void PINT_config_release(struct server_configuration_s *config_s)
             config_s->logfile = NULL;
         }
 
+        if (config_s->sm_trace_dir)
+        {
+            free(config_s->sm_trace_dir);
+            config_s->sm_trace_dir = NULL;
+        }
+
         if (config_s->logtype)
         {
             free(config_s->logtype);
@@ -4315,6 +4627,11 @@ static void free_filesystem(void *ptr)
         {
             free(fs->secret_key);
         }
+        if (fs->capability_secret_file)
+        {
+            free(fs->capability_secret_file);
+            fs->capability_secret_file = NULL;
+        }
         /* free all ro_hosts specifications */
         if (fs->ro_hosts)
         {
@@ -4380,6 +4697,9 @@ static void copy_filesystem(struct filesystem_configuration_s *dest_fs,
         dest_fs->coll_id = src_fs->coll_id;
         dest_fs->root_handle = src_fs->root_handle;
         dest_fs->default_num_dfiles = src_fs->default_num_dfiles;
+        dest_fs->data_placement = src_fs->data_placement;
+        dest_fs->data_placement_refresh_secs =
+            src_fs->data_placement_refresh_secs;
 
         dest_fs->flowproto = src_fs->flowproto;
         dest_fs->encoding = src_fs->encoding;
@@ -4392,6 +4712,13 @@ static void copy_filesystem(struct filesystem_configuration_s *dest_fs,
             dest_fs->secret_key = strdup(src_fs->secret_key);
         }
 
+        dest_fs->capability_mode = src_fs->capability_mode;
+        if (src_fs->capability_secret_file)
+        {
+            dest_fs->capability_secret_file =
+                strdup(src_fs->capability_secret_file);
+        }
+
         assert(dest_fs->meta_handle_ranges);
         assert(dest_fs->data_handle_ranges);
 
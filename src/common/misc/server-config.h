@@ -48,6 +48,20 @@ typedef struct host_alias_s
     char *bmi_address;
 } host_alias_s;
 
+/* how capabilities for a file system are signed and verified */
+enum PINT_capability_mode
+{
+    PINT_CAP_MODE_PUBKEY = 0,  /* public-key signature by issuing server */
+    PINT_CAP_MODE_HMAC   = 1,  /* HMAC with secret shared among servers */
+};
+
+/* how servers are chosen for the datafiles of new files */
+enum PINT_data_placement
+{
+    PINT_DATA_PLACEMENT_ROUND_ROBIN = 0, /* static server list order */
+    PINT_DATA_PLACEMENT_LOAD_AWARE  = 1, /* by free space and server load */
+};
+
 typedef struct host_handle_mapping_s
 {
     struct host_alias_s *alias_mapping;
@@ -93,8 +107,18 @@ typedef struct filesystem_configuration_s
     int coalescing_low_watermark;
     int file_stuffing;
 
+    /* datafile placement policy, and how often the server statistics
+     * it relies on are refreshed */
+    enum PINT_data_placement data_placement;
+    int data_placement_refresh_secs;
+
     char *secret_key;
 
+    /* capability signing mode and, for HMAC mode, path to the secret
+     * shared by all servers of the file system */
+    enum PINT_capability_mode capability_mode;
+    char *capability_secret_file;
+
     int fp_buffer_size;
     int fp_buffers_per_flow;
 
@@ -176,6 +200,10 @@ typedef struct server_configuration_s
     char *logfile;                  /* what log file to write to */
     char *logtype;                  /* "file" or "syslog" destination */
     enum gossip_logstamp logstamp_type; /* how to timestamp logs */
+    int async_log_buffer_size;      /* per-thread async log ring; 0 = sync */
+    int async_log_wait_msecs;       /* wait on a full ring; 0 = drop */
+    int sm_trace_records;           /* per-thread sm trace ring; 0 = off */
+    char *sm_trace_dir;             /* where sm trace dumps are written */
     char *event_logging;
     int enable_events;
     char *bmi_modules;              /* BMI modules                      */
@@ -257,6 +285,7 @@ typedef struct server_configuration_s
     void *private_data;
     int32_t tree_width;
     int32_t tree_threshold;
+    int32_t tree_adaptive;           /* plan tree fan-out from peer timings */
 
     int32_t distr_dir_servers_initial;
     int32_t distr_dir_servers_max;
@@ -16,6 +16,7 @@
 #include "pvfs2-debug.h"
 #include "state-machine.h"
 #include "client-state-machine.h"
+#include "pint-sm-trace.h"
 
 struct PINT_frame_s
 {
@@ -54,6 +55,9 @@ int PINT_state_machine_terminate(struct PINT_smcb *smcb, job_status_s *r)
     void *my_frame;
     job_id_t id;
 
+    PINT_SM_TRACE(PINT_SM_TRACE_TERM, smcb, (int64_t) r->error_code,
+                  smcb->op, 0);
+
     /* notify parent */
     if (smcb->parent_smcb)
     {
@@ -123,6 +127,7 @@ PINT_sm_action PINT_state_machine_invoke(struct PINT_smcb *smcb,
     PINT_sm_action retval;
     const char * state_name;
     const char * machine_name;
+    struct PINT_state_s *state;
     int children_started = 0;
 
     if (!(smcb) || !(smcb->current_state) ||
@@ -147,9 +152,14 @@ PINT_sm_action PINT_state_machine_invoke(struct PINT_smcb *smcb,
                  state_name,
                  (int32_t)r->status_user_tag);
 //}
+
+    state = smcb->current_state;
+    PINT_SM_TRACE(PINT_SM_TRACE_STATE, smcb, state, smcb->op, 0);
      
     /* call state action function */
     retval = (smcb->current_state->action.func)(smcb,r);
+
+    PINT_SM_TRACE(PINT_SM_TRACE_ACTION, smcb, state, smcb->op, retval);
     /* process return code */
     switch (retval)
     {
@@ -217,6 +227,15 @@ PINT_sm_action PINT_state_machine_start(struct PINT_smcb *smcb, job_status_s *r)
     /* set the base frame to be the current TOS, which should be 0 */
     smcb->base_frame = smcb->frame_count - 1;
 
+    PINT_SM_TRACE(PINT_SM_TRACE_START, smcb,
+                  smcb->stackptr ? smcb->state_stack[0].state :
+                  smcb->current_state, smcb->op, 0);
+    if (smcb->parent_smcb)
+    {
+        PINT_SM_TRACE(PINT_SM_TRACE_CHILD, smcb, smcb->parent_smcb,
+                      smcb->op, 0);
+    }
+
     /* run the current state action function */
     ret = PINT_state_machine_invoke(smcb, r);
     if (ret == SM_ACTION_COMPLETE || ret == SM_ACTION_TERMINATE)
@@ -419,8 +438,20 @@ int PINT_state_machine_locate(struct PINT_smcb *smcb)
  */
 int PINT_smcb_set_op(struct PINT_smcb *smcb, int op)
 {
+    int ret;
+
     smcb->op = op;
-    return PINT_state_machine_locate(smcb);
+    ret = PINT_state_machine_locate(smcb);
+    /* a running machine (the server's unexpected machine, for one) may
+     * switch to a new op, which then starts from here
+     */
+    if (ret == 1)
+    {
+        PINT_SM_TRACE(PINT_SM_TRACE_START, smcb,
+                      smcb->stackptr ? smcb->state_stack[0].state :
+                      smcb->current_state, smcb->op, 0);
+    }
+    return ret;
 }
 
 int PINT_smcb_immediate_completion(struct PINT_smcb *smcb)
@@ -512,7 +543,8 @@ int PINT_smcb_cancelled(struct PINT_smcb *smcb)
             (int), pinter to function to locate SM
    Returns: nothing, but fills in pointer argument
    Synopsis: this allocates an smcb struct, including its frame stack
-             and sets the op code so you can start the state machine
+             and sets the op code so you can start the state machine.
+             The smcb and its base frame come from the slab caches.
  */
 int PINT_smcb_alloc(
         struct PINT_smcb **smcb,
@@ -522,7 +554,7 @@ int PINT_smcb_alloc(
         int (*term_fn)(struct PINT_smcb *, job_status_s *),
         job_context_id context_id)
 {
-    *smcb = (struct PINT_smcb *)malloc(sizeof(struct PINT_smcb));
+    *smcb = (struct PINT_smcb *)PINT_slab_alloc(sizeof(struct PINT_smcb));
     if (!(*smcb))
     {
         return -PVFS_ENOMEM;
@@ -537,15 +569,13 @@ int PINT_smcb_alloc(
     /* if frame_size given, allocate a frame */
     if (frame_size > 0)
     {
-        void *new_frame = malloc(frame_size);
+        void *new_frame = PINT_sm_frame_alloc(frame_size);
         if (!new_frame)
         {
-            free(*smcb);
+            PINT_slab_free(*smcb);
             *smcb = NULL;
             return -PVFS_ENOMEM;
         }
-        /* zero out all members */
-        memset(new_frame, 0, frame_size);
         PINT_sm_push_frame(*smcb, 0, new_frame);
         (*smcb)->base_frame = 0;
     }
@@ -564,6 +594,7 @@ int PINT_smcb_alloc(
  * Returns: nothing, but sets the pointer to NULL
  * Synopsis: this frees an smcb struct, including
  * anything on the frame stack with a zero task_id
+ * and everything allocated from its arena
  */
 void PINT_smcb_free(struct PINT_smcb *smcb)
 {
@@ -594,12 +625,47 @@ void PINT_smcb_free(struct PINT_smcb *smcb)
         if (frame_entry->frame && frame_entry->task_id == 0)
         {
             /* only free if task_id is 0 */
-            free(frame_entry->frame);
+            PINT_sm_frame_free(frame_entry->frame);
         } 
         qlist_del(&frame_entry->link);
-        free(frame_entry);
+        PINT_slab_free(frame_entry);
     }
-    free(smcb);
+    PINT_slab_arena_release(&smcb->arena);
+    PINT_slab_free(smcb);
+}
+
+/* Function: PINT_smcb_arena_alloc
+ * Params: pointer to an smcb, size in bytes
+ * Returns: pointer to zeroed memory, or NULL
+ * Synopsis: allocates a temporary buffer for the state machine.
+ * It must not be freed; everything allocated this way is released
+ * at once by PINT_smcb_free.
+ */
+void *PINT_smcb_arena_alloc(struct PINT_smcb *smcb, size_t size)
+{
+    return PINT_slab_arena_alloc(&smcb->arena, size);
+}
+
+/* Function: PINT_sm_frame_alloc
+ * Params: size of frame
+ * Returns: pointer to zeroed frame, or NULL
+ * Synopsis: allocates a frame from the slab caches.  A frame pushed
+ * with a zero task_id is freed by PINT_smcb_free; any other must be
+ * released with PINT_sm_frame_free once it is popped.
+ */
+void *PINT_sm_frame_alloc(size_t size)
+{
+    return PINT_slab_zalloc(size);
+}
+
+/* Function: PINT_sm_frame_free
+ * Params: pointer to frame
+ * Returns: nothing
+ * Synopsis: frees a frame from PINT_sm_frame_alloc or malloc
+ */
+void PINT_sm_frame_free(void *frame)
+{
+    PINT_slab_free(frame);
 }
 
 /* Function: PINT_pop_state
@@ -708,7 +774,7 @@ int PINT_sm_push_frame(struct PINT_smcb *smcb, int task_id, void *frame_p)
     gossip_debug(GOSSIP_STATE_MACHINE_DEBUG,
                  "[SM Frame PUSH]: (%p) frame: %p\n",
                  smcb, frame_p);
-    newframe = malloc(sizeof(struct PINT_frame_s));
+    newframe = PINT_slab_alloc(sizeof(struct PINT_frame_s));
     if(!newframe)
     {
         return -PVFS_ENOMEM;
@@ -755,7 +821,7 @@ void *PINT_sm_pop_frame(struct PINT_smcb *smcb,
     *error_code = frame_entry->error;
     *task_id = frame_entry->task_id;
 
-    free(frame_entry);
+    PINT_slab_free(frame_entry);
 
     gossip_debug(GOSSIP_STATE_MACHINE_DEBUG,
             "[SM Frame POP]: (%p) frame: %p\n",
@@ -11,6 +11,7 @@
 #include "job.h"
 #include "quicklist.h"
 #include "server-config-mgr.h"
+#include "pint-slab.h"
 
 /* STATE-MACHINE.H
  *
@@ -115,6 +116,7 @@ typedef struct PINT_smcb
     int (*terminate_fn)(struct PINT_smcb *, job_status_s *);
     void *user_ptr; /* external user pointer */
     int immediate; /* specifies immediate completion of the state machine */
+    struct PINT_slab_arena *arena; /* see PINT_smcb_arena_alloc() */
 } PINT_smcb;
 
 #define PINT_SET_OP_COMPLETE do{PINT_smcb_set_complete(smcb);} while (0)
@@ -223,7 +225,10 @@ int PINT_smcb_alloc(struct PINT_smcb **, int, int,
         int (*term_fn)(struct PINT_smcb *, job_status_s *),
         job_context_id context_id);
 void PINT_smcb_free(struct PINT_smcb *);
+void *PINT_smcb_arena_alloc(struct PINT_smcb *smcb, size_t size);
 void *PINT_sm_frame(struct PINT_smcb *, int);
+void *PINT_sm_frame_alloc(size_t size);
+void PINT_sm_frame_free(void *frame);
 int PINT_sm_push_frame(struct PINT_smcb *smcb, int task_id, void *frame_p);
 void *PINT_sm_pop_frame(struct PINT_smcb *smcb,
                         int *task_id,
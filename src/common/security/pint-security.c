@@ -14,11 +14,14 @@
 #include <grp.h>
 #include <regex.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 
 #include <openssl/conf.h>
 #include <openssl/crypto.h>
 #include <openssl/err.h>
 #include <openssl/evp.h>
+#include <openssl/hmac.h>
 #include <openssl/pem.h>
 #include <openssl/x509.h>
 
@@ -77,6 +80,67 @@ struct CRYPTO_dynlock_value
 #   define PVFS_EVP_MD_CTX_FREE(ctx) EVP_MD_CTX_cleanup((ctx))
 #endif
 
+/* OpenSSL 3 deprecates the HMAC_* interface in favor of EVP_MAC; both
+ * are hidden behind PVFS_HMAC_CTX so the capability code reads the same.
+ */
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#   include <openssl/core_names.h>
+#   define PVFS_USE_EVP_MAC
+typedef EVP_MAC_CTX PVFS_HMAC_CTX;
+#   define PVFS_HMAC_CTX_FREE(ctx) EVP_MAC_CTX_free((ctx))
+#else
+typedef HMAC_CTX PVFS_HMAC_CTX;
+#   ifdef HAVE_OPENSSL_1_1
+#       define PVFS_HMAC_CTX_NEW() HMAC_CTX_new()
+#       define PVFS_HMAC_CTX_FREE(ctx) HMAC_CTX_free((ctx))
+#   else
+static HMAC_CTX *PVFS_HMAC_CTX_NEW(void)
+{
+    HMAC_CTX *ctx = malloc(sizeof(HMAC_CTX));
+    if (ctx)
+    {
+        HMAC_CTX_init(ctx);
+    }
+    return ctx;
+}
+#       define PVFS_HMAC_CTX_FREE(ctx) do { HMAC_CTX_cleanup((ctx)); \
+                                            free((ctx)); } while (0)
+#   endif
+#endif
+
+/* shared secrets shorter than this are refused for HMAC capabilities */
+#define CAP_HMAC_SECRET_MIN 16
+#define CAP_HMAC_SECRET_MAX 1024
+
+/* HMAC capability key for one file system in PINT_CAP_MODE_HMAC.  The
+ * context is keyed once at startup; signing and verifying copy it, so the
+ * key schedule is never recomputed on the request path.
+ */
+typedef struct cap_hmac_key_s
+{
+    PVFS_fs_id fsid;
+    PVFS_HMAC_CTX *key_ctx;
+} cap_hmac_key_t;
+
+static cap_hmac_key_t *cap_hmac_keys = NULL;
+static int cap_hmac_key_count = 0;
+
+static int load_capability_secrets(
+    const struct server_configuration_s *config);
+static void free_capability_secrets(void);
+static PVFS_HMAC_CTX *new_capability_key(const unsigned char *secret,
+                                         size_t len);
+static PVFS_HMAC_CTX *lookup_capability_secret(PVFS_fs_id fsid);
+static PVFS_HMAC_CTX *dup_capability_key(PVFS_HMAC_CTX *key_ctx);
+static int hmac_capability(PVFS_HMAC_CTX *key_ctx,
+                           PVFS_HMAC_CTX *work_ctx,
+                           const PVFS_capability *cap,
+                           unsigned char *md,
+                           unsigned int *md_len);
+static int verify_capability_hmac(PVFS_HMAC_CTX *key_ctx,
+                                  PVFS_HMAC_CTX *work_ctx,
+                                  const PVFS_capability *cap);
+
 
 /* thread-safe OpenSSL helper functions */
 static int setup_threading(void);
@@ -254,10 +318,16 @@ int PINT_security_initialize(void)
 
 #endif /* ENABLE_SECURITY_CERT */
 
+    ret = load_capability_secrets(config);
+    PINT_SECURITY_CHECK(ret, init_error, "could not load capability "
+                        "secrets\n");
+
     goto init_exit;
 
 init_error:
 
+    free_capability_secrets();
+
 #ifdef ENABLE_SECURITY_CERT
     PINT_cleanup_trust_store();
 
@@ -303,6 +373,8 @@ int PINT_security_finalize(void)
 
     SECURITY_hash_finalize();
 
+    free_capability_secrets();
+
     EVP_PKEY_free(security_privkey);
     EVP_cleanup();
     ERR_free_strings();
@@ -442,6 +514,7 @@ int PINT_sign_capability(PVFS_capability *cap, PVFS_time *force_timeout)
     tmp_mdctx = &mdctx;
 #endif
     const EVP_MD *md = NULL;
+    PVFS_HMAC_CTX *key_ctx;
 #if 0
     char mdstr[2*SHA_DIGEST_LENGTH+1];
 #endif
@@ -474,6 +547,27 @@ int PINT_sign_capability(PVFS_capability *cap, PVFS_time *force_timeout)
        cap->timeout = PINT_util_get_current_time() + config->capability_timeout;
     }
 
+    /* file systems in HMAC mode sign with the shared secret */
+    key_ctx = lookup_capability_secret(cap->fsid);
+    if (key_ctx)
+    {
+        unsigned char md[EVP_MAX_MD_SIZE];
+        unsigned int md_len = 0;
+
+        PVFS_EVP_MD_CTX_FREE(tmp_mdctx);
+
+        ret = hmac_capability(key_ctx, NULL, cap, md, &md_len);
+        if (!ret || md_len > (unsigned int) EVP_PKEY_size(security_privkey))
+        {
+            PINT_security_error(__func__, -PVFS_ESECURITY);
+            return -1;
+        }
+        memcpy(cap->signature, md, md_len);
+        cap->sig_size = md_len;
+
+        return 0;
+    }
+
 //    if (EVP_PKEY_type(security_privkey->type) == EVP_PKEY_RSA)
     if ( EVP_PKEY_base_id(security_privkey) == EVP_PKEY_RSA )
     {
@@ -605,6 +699,7 @@ int PINT_verify_capability(const PVFS_capability *cap)
 
     const EVP_MD *md = NULL;
     EVP_PKEY *pubkey;
+    PVFS_HMAC_CTX *key_ctx;
     int ret;
     
     if (cap == NULL || cap->issuer == NULL || cap->signature == NULL ||
@@ -644,6 +739,15 @@ int PINT_verify_capability(const PVFS_capability *cap)
     gossip_debug(GOSSIP_SECURITY_DEBUG, "CAPVRFY: %s\n", mdstr);
 #endif
 
+    /* file systems in HMAC mode verify against the shared secret */
+    key_ctx = lookup_capability_secret(cap->fsid);
+    if (key_ctx)
+    {
+        PVFS_EVP_MD_CTX_FREE(tmp_mdctx);
+
+        return verify_capability_hmac(key_ctx, NULL, cap);
+    }
+
 #ifdef ENABLE_SECURITY_CERT
     /* get CA certificate public key */
     pubkey = X509_get_pubkey(ca_cert);
@@ -720,6 +824,87 @@ int PINT_verify_capability(const PVFS_capability *cap)
     return (ret == 1);
 }
 
+/*  PINT_verify_capability_batch
+ *
+ *  Verifies count capabilities, storing 1 (verified) or 0 in results[i]
+ *  exactly as PINT_verify_capability would.  HMAC capabilities share one
+ *  clock read, and consecutive ones for the same file system share one
+ *  working context, so their per-capability cost is a context reset and
+ *  two short digests; public-key capabilities fall back to
+ *  PINT_verify_capability.
+ *
+ *  returns the number of capabilities verified
+ */
+int PINT_verify_capability_batch(const PVFS_capability * const *caps,
+                                 int count,
+                                 int *results)
+{
+    struct server_configuration_s *config = PINT_server_config_mgr_get_config();
+    PVFS_HMAC_CTX *work_ctx = NULL;
+    PVFS_HMAC_CTX *work_key = NULL;
+    PVFS_HMAC_CTX *key_ctx;
+    const PVFS_capability *cap;
+    PVFS_time now;
+    int verified = 0;
+    int i;
+
+    if (caps == NULL || results == NULL || count <= 0)
+    {
+        return 0;
+    }
+
+    now = PINT_util_get_current_time();
+
+    for (i = 0; i < count; i++)
+    {
+        cap = caps[i];
+        results[i] = 0;
+
+        key_ctx = (cap && cap->issuer && cap->signature &&
+                   !PINT_capability_is_null(cap)) ?
+                  lookup_capability_secret(cap->fsid) : NULL;
+        if (key_ctx == NULL)
+        {
+            results[i] = PINT_verify_capability(cap);
+            verified += results[i];
+            continue;
+        }
+
+        if (cap->num_handles != 0 && cap->handle_array == NULL)
+        {
+            PINT_security_error(__func__, -1);
+            continue;
+        }
+
+        if (!config->bypass_timeout_check && now > cap->timeout)
+        {
+            gossip_debug(GOSSIP_SECURITY_DEBUG, "Capability expired "
+                         "(timeout %llu)\n", llu(cap->timeout));
+            continue;
+        }
+
+        if (key_ctx != work_key)
+        {
+            if (work_ctx)
+            {
+                PVFS_HMAC_CTX_FREE(work_ctx);
+            }
+            work_ctx = dup_capability_key(key_ctx);
+            work_key = work_ctx ? key_ctx : NULL;
+        }
+
+        results[i] = verify_capability_hmac(key_ctx, work_ctx, cap);
+        verified += results[i];
+    }
+
+    if (work_ctx)
+    {
+        PVFS_HMAC_CTX_FREE(work_ctx);
+    }
+
+    return verified;
+}
+
 /* PINT_init_credential
  *
  * Initializes a credential and allocates memory for its internal members.
@@ -1409,6 +1594,337 @@ static int load_public_keys(const char *path)
 }
 #endif
 
+/* load_capability_secrets
+ *
+ * Keys an HMAC context for every file system configured with
+ * CapabilityMode hmac.  The secret is read from CapabilitySecretFile and
+ * is not kept in memory outside of the keyed context.
+ *
+ * returns -PVFS_ESECURITY on error
+ * returns 0 on success
+ */
+static int load_capability_secrets(
+    const struct server_configuration_s *config)
+{
+    struct filesystem_configuration_s *fs_conf;
+    PINT_llist *cur;
+    unsigned char secret[CAP_HMAC_SECRET_MAX];
+    struct stat statbuf;
+    ssize_t len;
+    int fd, count = 0;
+
+    for (cur = config->file_systems; cur; cur = PINT_llist_next(cur))
+    {
+        fs_conf = PINT_llist_head(cur);
+        if (fs_conf && fs_conf->capability_mode == PINT_CAP_MODE_HMAC)
+        {
+            count++;
+        }
+    }
+
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    cap_hmac_keys = calloc(count, sizeof(cap_hmac_key_t));
+    if (cap_hmac_keys == NULL)
+    {
+        return -PVFS_ENOMEM;
+    }
+
+    for (cur = config->file_systems; cur; cur = PINT_llist_next(cur))
+    {
+        fs_conf = PINT_llist_head(cur);
+        if (!fs_conf || fs_conf->capability_mode != PINT_CAP_MODE_HMAC)
+        {
+            continue;
+        }
+
+        if (fs_conf->capability_secret_file == NULL)
+        {
+            gossip_err("Error: file system %s uses HMAC capabilities but "
+                       "CapabilitySecretFile is not set\n",
+                       fs_conf->file_system_name);
+            return -PVFS_ESECURITY;
+        }
+
+        fd = open(fs_conf->capability_secret_file, O_RDONLY);
+        if (fd < 0)
+        {
+            gossip_err("Error loading capability secret: %s: %s\n",
+                       fs_conf->capability_secret_file, strerror(errno));
+            return -PVFS_ESECURITY;
+        }
+
+        if (fstat(fd, &statbuf) == 0 && (statbuf.st_mode & (S_IRWXG|S_IRWXO)))
+        {
+            gossip_err("Warning: capability secret %s is accessible by "
+                       "group or other users\n",
+                       fs_conf->capability_secret_file);
+        }
+
+        len = read(fd, secret, sizeof(secret));
+        close(fd);
+        if (len < CAP_HMAC_SECRET_MIN)
+        {
+            gossip_err("Error loading capability secret: %s: secret must be "
+                       "at least %d bytes\n",
+                       fs_conf->capability_secret_file, CAP_HMAC_SECRET_MIN);
+            memset(secret, 0, sizeof(secret));
+            return -PVFS_ESECURITY;
+        }
+
+        cap_hmac_keys[cap_hmac_key_count].key_ctx =
+            new_capability_key(secret, (size_t) len);
+        memset(secret, 0, sizeof(secret));
+        if (cap_hmac_keys[cap_hmac_key_count].key_ctx == NULL)
+        {
+            PINT_security_error(__func__, -PVFS_ESECURITY);
+            return -PVFS_ESECURITY;
+        }
+
+        cap_hmac_keys[cap_hmac_key_count].fsid = fs_conf->coll_id;
+        cap_hmac_key_count++;
+
+        gossip_debug(GOSSIP_SECURITY_DEBUG, "Using HMAC capabilities for "
+                     "file system %s\n", fs_conf->file_system_name);
+    }
+
+    return 0;
+}
+
+static void free_capability_secrets(void)
+{
+    int i;
+
+    if (cap_hmac_keys == NULL)
+    {
+        return;
+    }
+
+    for (i = 0; i < cap_hmac_key_count; i++)
+    {
+        if (cap_hmac_keys[i].key_ctx)
+        {
+            PVFS_HMAC_CTX_FREE(cap_hmac_keys[i].key_ctx);
+        }
+    }
+    free(cap_hmac_keys);
+    cap_hmac_keys = NULL;
+    cap_hmac_key_count = 0;
+}
+
+/* new_capability_key
+ *
+ * returns an HMAC-SHA256 context keyed with secret, or NULL on error
+ */
+static PVFS_HMAC_CTX *new_capability_key(const unsigned char *secret,
+                                         size_t len)
+{
+#ifdef PVFS_USE_EVP_MAC
+    OSSL_PARAM params[2];
+    EVP_MAC *mac;
+    EVP_MAC_CTX *ctx;
+
+    mac = EVP_MAC_fetch(NULL, "HMAC", NULL);
+    if (mac == NULL)
+    {
+        return NULL;
+    }
+    /* the context holds its own reference to mac */
+    ctx = EVP_MAC_CTX_new(mac);
+    EVP_MAC_free(mac);
+    if (ctx == NULL)
+    {
+        return NULL;
+    }
+
+    params[0] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST,
+                                                 "SHA256", 0);
+    params[1] = OSSL_PARAM_construct_end();
+    if (!EVP_MAC_init(ctx, secret, len, params))
+    {
+        EVP_MAC_CTX_free(ctx);
+        return NULL;
+    }
+
+    return ctx;
+#else
+    HMAC_CTX *ctx;
+
+    ctx = PVFS_HMAC_CTX_NEW();
+    if (ctx == NULL)
+    {
+        return NULL;
+    }
+    if (!HMAC_Init_ex(ctx, secret, (int) len, EVP_sha256(), NULL))
+    {
+        PVFS_HMAC_CTX_FREE(ctx);
+        return NULL;
+    }
+
+    return ctx;
+#endif
+}
+
+/* lookup_capability_secret
+ *
+ * returns the keyed HMAC context for fsid, or NULL if the file system
+ * uses public-key capabilities
+ */
+static PVFS_HMAC_CTX *lookup_capability_secret(PVFS_fs_id fsid)
+{
+    int i;
+
+    for (i = 0; i < cap_hmac_key_count; i++)
+    {
+        if (cap_hmac_keys[i].fsid == fsid)
+        {
+            return cap_hmac_keys[i].key_ctx;
+        }
+    }
+
+    return NULL;
+}
+
+/* dup_capability_key
+ *
+ * returns a working copy of key_ctx for hmac_capability(), or NULL on
+ * error
+ */
+static PVFS_HMAC_CTX *dup_capability_key(PVFS_HMAC_CTX *key_ctx)
+{
+#ifdef PVFS_USE_EVP_MAC
+    return EVP_MAC_CTX_dup(key_ctx);
+#else
+    HMAC_CTX *work_ctx;
+
+    work_ctx = PVFS_HMAC_CTX_NEW();
+    if (work_ctx == NULL)
+    {
+        return NULL;
+    }
+    if (!HMAC_CTX_copy(work_ctx, key_ctx))
+    {
+        PVFS_HMAC_CTX_FREE(work_ctx);
+        return NULL;
+    }
+
+    return work_ctx;
+#endif
+}
+
+/* hmac_capability
+ *
+ * Computes the HMAC of the signed capability fields, in the same order
+ * used by the public-key signature.  key_ctx is shared by all threads
+ * and is never updated itself.  work_ctx, if not NULL, is a copy of
+ * key_ctx from dup_capability_key() that is re-initialized and reused;
+ * otherwise a copy is made for this call.
+ *
+ * returns 1 on success
+ * returns 0 on error
+ */
+static int hmac_capability(PVFS_HMAC_CTX *key_ctx,
+                           PVFS_HMAC_CTX *work_ctx,
+                           const PVFS_capability *cap,
+                           unsigned char *md,
+                           unsigned int *md_len)
+{
+    PVFS_HMAC_CTX *own_ctx = NULL;
+    int ret;
+#ifdef PVFS_USE_EVP_MAC
+#   define PVFS_HMAC_UPDATE(ctx, data, len) EVP_MAC_update((ctx), (data), (len))
+    size_t out_len = 0;
+#else
+#   define PVFS_HMAC_UPDATE(ctx, data, len) HMAC_Update((ctx), (data), (len))
+#endif
+
+    if (work_ctx == NULL)
+    {
+        own_ctx = work_ctx = dup_capability_key(key_ctx);
+        if (work_ctx == NULL)
+        {
+            return 0;
+        }
+        ret = 1;
+    }
+    else
+    {
+        /* a NULL key restarts the digest with the key already set */
+#ifdef PVFS_USE_EVP_MAC
+        ret = EVP_MAC_init(work_ctx, NULL, 0, NULL);
+#else
+        ret = HMAC_Init_ex(work_ctx, NULL, 0, NULL, NULL);
+#endif
+    }
+
+    ret &= PVFS_HMAC_UPDATE(work_ctx, (const unsigned char *) cap->issuer,
+                            strlen(cap->issuer) * sizeof(char));
+    ret &= PVFS_HMAC_UPDATE(work_ctx, (const unsigned char *) &cap->fsid,
+                            sizeof(PVFS_fs_id));
+    ret &= PVFS_HMAC_UPDATE(work_ctx, (const unsigned char *) &cap->timeout,
+                            sizeof(PVFS_time));
+    ret &= PVFS_HMAC_UPDATE(work_ctx, (const unsigned char *) &cap->op_mask,
+                            sizeof(uint32_t));
+    ret &= PVFS_HMAC_UPDATE(work_ctx,
+                            (const unsigned char *) &cap->num_handles,
+                            sizeof(uint32_t));
+    if (cap->num_handles)
+    {
+        ret &= PVFS_HMAC_UPDATE(work_ctx,
+                                (const unsigned char *) cap->handle_array,
+                                cap->num_handles * sizeof(PVFS_handle));
+    }
+#undef PVFS_HMAC_UPDATE
+    if (ret)
+    {
+#ifdef PVFS_USE_EVP_MAC
+        ret = EVP_MAC_final(work_ctx, md, &out_len, EVP_MAX_MD_SIZE);
+        *md_len = (unsigned int) out_len;
+#else
+        ret = HMAC_Final(work_ctx, md, md_len);
+#endif
+    }
+
+    if (own_ctx)
+    {
+        PVFS_HMAC_CTX_FREE(own_ctx);
+    }
+
+    return ret;
+}
+
+/* verify_capability_hmac
+ *
+ * returns 1 if the capability signature matches its HMAC
+ * returns 0 otherwise
+ */
+static int verify_capability_hmac(PVFS_HMAC_CTX *key_ctx,
+                                  PVFS_HMAC_CTX *work_ctx,
+                                  const PVFS_capability *cap)
+{
+    unsigned char md[EVP_MAX_MD_SIZE];
+    unsigned int md_len = 0;
+
+    if (!hmac_capability(key_ctx, work_ctx, cap, md, &md_len))
+    {
+        PINT_security_error(__func__, -PVFS_ESECURITY);
+        return 0;
+    }
+
+    if (md_len != cap->sig_size ||
+        CRYPTO_memcmp(md, cap->signature, md_len) != 0)
+    {
+        gossip_debug(GOSSIP_SECURITY_DEBUG, "HMAC capability from %s does "
+                     "not verify\n", cap->issuer);
+        return 0;
+    }
+
+    return 1;
+}
+
 /* PINT_security_error 
  * Log security errors to gossip, (usually OpenSSL errors)
  */
@@ -136,6 +136,9 @@ int PINT_security_cache_ca_cert(void);
 int PINT_init_capability(PVFS_capability *cap);
 int PINT_sign_capability(PVFS_capability *cap,PVFS_time *force_timeout);
 int PINT_verify_capability(const PVFS_capability *cap);
+int PINT_verify_capability_batch(const PVFS_capability * const *caps,
+                                 int count,
+                                 int *results);
 int PINT_server_to_server_capability(PVFS_capability *capability,
                                      PVFS_fs_id fs_id,
                                      int num_handles,
@@ -127,6 +127,22 @@ int PINT_verify_capability(const PVFS_capability *cap)
     return 1;
 }
 
+int PINT_verify_capability_batch(const PVFS_capability * const *caps,
+                                 int count,
+                                 int *results)
+{
+    int verified = 0;
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        results[i] = PINT_verify_capability(caps[i]);
+        verified += results[i];
+    }
+
+    return verified;
+}
+
 int PINT_init_credential(PVFS_credential *cred)
 {
     memset(cred, 0, sizeof(*cred));
@@ -200,7 +200,8 @@ struct method_op
     int mode;		/* operation mode */
     bmi_context_id context_id;  /* context */
     struct qlist_head op_list_entry;	/* op_list link */
-    struct qlist_head hash_link;	/* hash table link */
+    struct qlist_head hash_link;	/* op_list index link, by addr and tag */
+    struct qlist_head addr_link;	/* op_list index link, by addr */
     void *method_data;		/* for use by individual methods */
 
 	/************************************************************
@@ -29,6 +29,9 @@
  */
 #define BMI_TCP_HEADER_WAIT_SECONDS 10
 
+/* size of encoded message header */
+#define TCP_ENC_HDR_SIZE 24
+
 /* peer name types */
 #define BMI_TCP_PEER_IP 1
 #define BMI_TCP_PEER_HOSTNAME 2
@@ -73,10 +76,41 @@ struct tcp_addr
     int zero_read_limit;
     /* timer for how long we wait on incomplete headers to arrive */
     int short_header_timer;
+    /* bytes read ahead of the operations they belong to; the stream
+     * continues at rx_buf + rx_off, and rx_link queues the address when
+     * whole messages are staged that no poll will report
+     */
+    char *rx_buf;
+    int rx_off;
+    int rx_len;
+    struct qlist_head rx_link;
+    /* small sends held in the queue to be written together: how many,
+     * and since when, in microseconds
+     */
+    int coalesce_count;
+    uint64_t coalesce_since;
     /* flag used to determine if we can reconnect this address after failure */
     int dont_reconnect;
     char* peer;
     int peer_type;
+    /* striping: the primary connection to a peer holds the extra
+     * connections that large messages are spread across
+     */
+    struct bmi_method_addr **stripes;   /* stripe_count - 1 of them */
+    int stripe_count;                   /* connections, with the primary */
+    int stripes_ready;                  /* extra connections set up */
+    int stripe_failing;
+    uint64_t stripe_cookie;
+    struct qlist_head stripe_link;
+    /* on an extra connection, the primary and our place in its list */
+    struct bmi_method_addr *stripe_primary;
+    int stripe_index;
+    /* MSG_ZEROCOPY: 1 if the socket sends with it, -1 if it stopped;
+     * sends numbered below zc_done have been released by the kernel
+     */
+    int zc_state;
+    uint32_t zc_next;
+    uint32_t zc_done;
 };
 
 
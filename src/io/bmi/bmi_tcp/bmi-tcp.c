@@ -10,6 +10,7 @@
 
 #include "pvfs2-internal.h"
 
+#include <ctype.h>
 #include <errno.h>
 #include <string.h>
 #include <unistd.h>
@@ -19,6 +20,7 @@
 #include <assert.h>
 #include <sys/uio.h>
 #include <time.h>
+#include <sched.h>
 #include <sys/time.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -28,6 +30,15 @@
 #ifdef HAVE_NETDB_H
 #include <netdb.h>
 #endif
+#ifdef __linux__
+#include <linux/errqueue.h>
+#endif
+
+/* MSG_ZEROCOPY sends need Linux 4.14 headers or later */
+#if defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY) && \
+    defined(SO_EE_ORIGIN_ZEROCOPY)
+#define BMI_TCP_ZEROCOPY
+#endif
 
 #include "bmi-method-support.h"
 #include "bmi-method-callback.h"
@@ -51,6 +62,7 @@
 #include "gen-locks.h"
 #include "pint-hint.h"
 #include "pint-event.h"
+#include "pint-mem-pool.h"
 
 static gen_mutex_t interface_mutex = GEN_MUTEX_INITIALIZER;
 static gen_cond_t interface_cond = GEN_COND_INITIALIZER;
@@ -196,9 +208,6 @@ int BMI_tcp_cancel(bmi_op_id_t id,
 
 char BMI_tcp_method_name[] = "bmi_tcp";
 
-/* size of encoded message header */
-#define TCP_ENC_HDR_SIZE 24
-
 /* structure internal to tcp for use as a message header */
 struct tcp_msg_header
 {
@@ -258,6 +267,24 @@ struct tcp_op
      */
     void *buffer_list_stub;
     bmi_size_t size_list_stub;
+    /* a message striped across the connections to a peer counts its
+     * pieces still moving, its own included; each piece points back
+     */
+    method_op_p stripe_parent;
+    int stripe_pending;
+    bmi_size_t stripe_done;
+    bmi_error_code_t stripe_error;
+    void **stripe_buffers;
+    bmi_size_t *stripe_sizes;
+    /* internal message that sets up the extra connections */
+    int stripe_ctl;
+    /* a send written with MSG_ZEROCOPY is not complete until the
+     * kernel releases its zc_seq - 1 numbered send
+     */
+    int zc_used;
+    uint32_t zc_seq;
+    /* held on a tcp_zc_drain after its connection failed */
+    int zc_draining;
 };
 
 /* static io vector for use with readv and writev; we can only use
@@ -266,6 +293,20 @@ struct tcp_op
 #define BMI_TCP_IOV_COUNT 10
 static struct iovec stat_io_vector[BMI_TCP_IOV_COUNT + 1];
 
+/* queued small sends written together take at most this many vectors
+ * and bytes in one writev, and a post writes the queue out once this
+ * many are waiting
+ */
+#define BMI_TCP_COALESCE_IOV 64
+#define BMI_TCP_COALESCE_BYTES (64*1024)
+#define BMI_TCP_COALESCE_OPS 32
+static struct iovec coalesce_io_vector[BMI_TCP_COALESCE_IOV];
+
+/* size of the buffer each connection stages incoming bytes in; one
+ * read can bring in many small messages at once
+ */
+#define BMI_TCP_RX_BUF_SIZE (16*1024)
+
 /* internal utility functions */
 static int tcp_server_init(void);
 
@@ -305,6 +346,16 @@ static int tcp_do_work_recv(bmi_method_addr_p map,
 static int tcp_do_work_send(bmi_method_addr_p map, 
                             int *stall_flag);
 
+static int tcp_recv_staged(bmi_method_addr_p map,
+                           int *stall_flag);
+static int tcp_recv_header(bmi_method_addr_p map,
+                           struct tcp_msg_header new_header);
+static int tcp_recv_payload(method_op_p op);
+static void tcp_do_work_staged(void);
+static int tcp_send_coalesced(method_op_p first_op,
+                              int *blocked_flag,
+                              int *stall_flag);
+static void tcp_coalesce_check(bmi_method_addr_p map);
 static int work_on_recv_op(method_op_p my_method_op,
 			   int *stall_flag);
 
@@ -345,6 +396,36 @@ static int tcp_post_recv_generic(bmi_op_id_t *id,
                                  bmi_context_id context_id,
                                  PVFS_hint hints);
 
+static void tcp_op_done(method_op_p op);
+
+static int tcp_stripe_request(bmi_method_addr_p map);
+
+static void tcp_stripe_ctl(bmi_method_addr_p map,
+                           struct tcp_msg_header *ctl_header);
+
+static void tcp_stripe_fail(bmi_method_addr_p primary,
+                            int error_code);
+
+static int tcp_post_send_striped(bmi_op_id_t *id,
+                                 bmi_method_addr_p dest,
+                                 const void *const *buffer_list,
+                                 const bmi_size_t *size_list,
+                                 int list_count,
+                                 struct tcp_msg_header my_header,
+                                 void *user_ptr,
+                                 bmi_context_id context_id,
+                                 PINT_event_id eid);
+
+static void tcp_stripe_recv_start(method_op_p op);
+
+static void tcp_sock_modes(struct tcp_addr *tcp_addr_data);
+static int tcp_zc_hold(method_op_p op);
+static int tcp_zc_reap(bmi_method_addr_p map);
+static int tcp_zc_notices(int s, uint32_t *zc_done, int *zc_state);
+static void tcp_zc_drain(bmi_method_addr_p map, int error_code);
+static void tcp_zc_drain_work(void);
+static void tcp_zc_drain_cleanup(void);
+
 static int payload_progress(int s,
                             void *const *buffer_list,
                             const bmi_size_t *size_list,
@@ -354,7 +435,8 @@ static int payload_progress(int s,
                             bmi_size_t *current_index_complete,
                             enum bmi_op_type send_recv,
                             char *enc_hdr,
-                            bmi_size_t *env_amt_complete);
+                            bmi_size_t *env_amt_complete,
+                            uint32_t *zc_next);
 
 #if defined(USE_TRUSTED) && defined(__PVFS2_CLIENT__)
 static int tcp_enable_trusted(struct tcp_addr *tcp_addr_data);
@@ -411,12 +493,13 @@ static int check_unexpected = 1;
 /* op_list_array indices */
 enum
 {
-    NUM_INDICES = 5,
+    NUM_INDICES = 6,
     IND_SEND = 0,
     IND_RECV = 1,
     IND_RECV_INFLIGHT = 2,
     IND_RECV_EAGER_DONE_BUFFERING = 3,
-    IND_COMPLETE_RECV_UNEXP = 4,	/* MAKE SURE THIS COMES LAST */
+    IND_SEND_ZEROCOPY = 4,	/* written, buffers still held by the kernel */
+    IND_COMPLETE_RECV_UNEXP = 5,	/* MAKE SURE THIS COMES LAST */
 };
 
 /* internal operation lists */
@@ -446,9 +529,26 @@ enum
     TCP_MODE_IMMED = 1,		/* not used for TCP/IP */
     TCP_MODE_UNEXP = 2,
     TCP_MODE_EAGER = 4,
-    TCP_MODE_REND = 8
+    TCP_MODE_REND = 8,
+    TCP_MODE_STRIPED = 16,	/* first piece of a striped message */
+    TCP_MODE_STRIPE_CTL = 32	/* striping setup, no payload */
+};
+
+/* striping setup messages carry the type and a connection index in the
+ * tag and a cookie naming the group in the size field.  The connecting
+ * side asks for a group on its first connection, is handed a cookie,
+ * then opens the rest, each of which joins with the cookie.
+ */
+enum
+{
+    TCP_STRIPE_REQ = 1,		/* index: connections wanted in all */
+    TCP_STRIPE_COOKIE = 2,	/* cookie for joining the group */
+    TCP_STRIPE_JOIN = 3,	/* on connection <index> of the group */
+    TCP_STRIPE_ACK = 4		/* connection <index> has joined */
 };
 
+#define TCP_STRIPE_MAX 16
+
 /* Allowable sizes for each mode */
 enum
 {
@@ -476,12 +576,107 @@ static int tcp_zone_len = 0;
 static int tcp_buffer_size_receive = 0;
 static int tcp_buffer_size_send = 0;
 
+/* connections per peer, and the smallest message spread across them;
+ * set with the tcp_stripes and tcp_stripe_min BMI options
+ */
+static int tcp_stripes = 1;
+static bmi_size_t tcp_stripe_min = 1048576;
+
+/* the smallest send written with MSG_ZEROCOPY (0 for none), and how
+ * long to spin on the sockets before sleeping in them, in microseconds;
+ * set with the tcp_zerocopy and tcp_busy_poll BMI options
+ */
+static bmi_size_t tcp_zerocopy = 0;
+static int tcp_busy_poll = 0;
+
+/* whether a send of size bytes is written with MSG_ZEROCOPY, and the
+ * counter that numbers such writes, or NULL if it is copied as usual
+ */
+#define TCP_ZC_WANTED(__addr_data, __size)                             \
+    (tcp_zerocopy && (__addr_data)->zc_state > 0 &&                     \
+     (__size) >= tcp_zerocopy)
+#define TCP_ZC_NEXT(__addr_data, __size)                               \
+    (TCP_ZC_WANTED(__addr_data, __size) ? &(__addr_data)->zc_next : NULL)
+
+/* how long a small send may wait in the queue for others to the same
+ * peer, in microseconds (0 to write each at once); set with the
+ * tcp_coalesce BMI option
+ */
+static int tcp_coalesce = 0;
+
+/* whether a send of size bytes may wait to be written with others */
+#define TCP_COALESCE_OK(__addr_data, __size)                            \
+    (tcp_coalesce && (__size) <= TCP_MODE_EAGER_LIMIT &&                \
+     !TCP_ZC_WANTED(__addr_data, __size))
+
+/* addresses with whole messages staged behind one a recv post took */
+static QLIST_HEAD(tcp_rx_staged);
+
+/* primaries of the groups peers have asked for, found by cookie */
+static QLIST_HEAD(tcp_stripe_groups);
+
+/* a failed connection with MSG_ZEROCOPY sends the kernel still reads
+ * from.  The notices that release them come on the socket error queue,
+ * which close() would throw away, so the socket is only shut down and
+ * kept here with the sends until the last notice arrives.
+ */
+struct tcp_zc_drain
+{
+    int socket;
+    uint32_t zc_done;
+    op_list_p ops;
+    struct qlist_head link;
+};
+static QLIST_HEAD(tcp_zc_drains);
+
+/* a drained socket whose peer stops acknowledging is reset after this
+ * long, which frees the pages it still had queued
+ */
+#define TCP_ZC_DRAIN_TIMEOUT_MSECS 10000
+static uint32_t tcp_stripe_cookie_next = 0;
+
 static PINT_event_type bmi_tcp_send_event_id;
 static PINT_event_type bmi_tcp_recv_event_id;
 
 static PINT_event_group bmi_tcp_event_group;
 static pid_t bmi_tcp_pid;
 
+/* tcp_parse_option()
+ *
+ * looks for name=<integer> in a comma separated BMI options string
+ *
+ * returns 1 and fills in value if the option is given, 0 otherwise
+ */
+static int tcp_parse_option(const char *options,
+                            const char *name,
+                            long *value)
+{
+    const char *cp;
+    char *end_ptr;
+
+    if (!options || !(cp = strstr(options, name)))
+    {
+        return (0);
+    }
+
+    cp += strlen(name);
+    for (; isspace(*cp); cp++);
+    if (*cp != '=')
+    {
+        gossip_err("Warning: malformed %s option; ignoring it.\n", name);
+        return (0);
+    }
+    for (++cp; isspace(*cp); cp++);
+
+    *value = strtol(cp, &end_ptr, 10);
+    if (end_ptr == cp || (*end_ptr != '\0' && *end_ptr != ','))
+    {
+        gossip_err("Warning: malformed %s option; ignoring it.\n", name);
+        return (0);
+    }
+    return (1);
+}
+
 /*************************************************************************
  * Visible Interface 
  */
@@ -502,6 +697,7 @@ int BMI_tcp_initialize(bmi_method_addr_p listen_addr,
     int tmp_errno = bmi_tcp_errno_to_pvfs(-ENOSYS);
     struct tcp_addr *tcp_addr_data = NULL;
     int i = 0;
+    long value;
 
     gossip_debug(GOSSIP_BMI_DEBUG_TCP, "Initializing TCP/IP module.\n");
 
@@ -520,6 +716,50 @@ int BMI_tcp_initialize(bmi_method_addr_p listen_addr,
     tcp_method_params.connect_test = 1;
     tcp_method_params.method_flags = init_flags;
 
+    tcp_stripes = 1;
+    tcp_stripe_min = 1048576;
+    INIT_QLIST_HEAD(&tcp_stripe_groups);
+    if (tcp_parse_option(options, "tcp_stripes", &value))
+    {
+        if (value < 1 || value > TCP_STRIPE_MAX)
+        {
+            gossip_err("Warning: tcp_stripes must be between 1 and %d; "
+                       "not striping.\n", TCP_STRIPE_MAX);
+        }
+        else
+        {
+            tcp_stripes = value;
+        }
+    }
+    if (tcp_parse_option(options, "tcp_stripe_min", &value))
+    {
+        /* pieces below the eager limit would buy nothing */
+        tcp_stripe_min = (value < TCP_MODE_EAGER_LIMIT) ?
+            TCP_MODE_EAGER_LIMIT : value;
+    }
+    tcp_zerocopy = 0;
+    if (tcp_parse_option(options, "tcp_zerocopy", &value) && value > 0)
+    {
+#ifdef BMI_TCP_ZEROCOPY
+        /* pinning pages only pays off well above the eager limit */
+        tcp_zerocopy = (value < TCP_MODE_EAGER_LIMIT) ?
+            TCP_MODE_EAGER_LIMIT : value;
+#else
+        gossip_err("Warning: tcp_zerocopy is not supported on this "
+                   "platform; ignored.\n");
+#endif
+    }
+    tcp_busy_poll = 0;
+    if (tcp_parse_option(options, "tcp_busy_poll", &value) && value > 0)
+    {
+        tcp_busy_poll = value;
+    }
+    tcp_coalesce = 0;
+    if (tcp_parse_option(options, "tcp_coalesce", &value) && value > 0)
+    {
+        tcp_coalesce = value;
+    }
+
     if (init_flags & BMI_INIT_SERVER)
     {
         /* hang on to our local listening address if needed */
@@ -534,10 +774,19 @@ int BMI_tcp_initialize(bmi_method_addr_p listen_addr,
         }
     }
 
-    /* set up the operation lists */
+    /* set up the operation lists; all but the unexpected completion
+     * list are searched by address or by address and tag
+     */
     for (i = 0; i < NUM_INDICES; i++)
     {
-        op_list_array[i] = op_list_new();
+        if (i == IND_COMPLETE_RECV_UNEXP)
+        {
+            op_list_array[i] = op_list_new();
+        }
+        else
+        {
+            op_list_array[i] = op_list_new_indexed();
+        }
         if (!op_list_array[i])
         {
             tmp_errno = bmi_tcp_errno_to_pvfs(-ENOMEM);
@@ -646,6 +895,7 @@ int BMI_tcp_finalize(void)
             op_list_array[i] = NULL;
         }
     }
+    tcp_zc_drain_cleanup();
 
     /* get rid of socket collection */
     if (tcp_socket_collection_p)
@@ -869,20 +1119,13 @@ errorout:
 void *BMI_tcp_memalloc(bmi_size_t size,
 		       enum bmi_op_type send_recv)
 {
-    void *ptr;
     /* we really don't care what flags the caller uses, TCP/IP has no
-     * preferences about how the memory should be configured.
-     */
-
-    /* return (calloc(1,(size_t) size)); */
-    /* return PINT_mem_aligned_alloc(size, 4096); */
-    /* all malloc related calls go through src/common/misc/pint-malloc.c
-     * these are redefined as neede to stadard calls - posix_memalign
-     * is implemented in terms of malloc thus it should work on all
-     * platforms
+     * preferences about how the memory should be configured.  The flow
+     * buffers come through here, so draw on the shared I/O buffer pool
+     * (posix_memalign unless the process enabled it, as servers do).
+     * Buffers below a page are not page aligned.
      */
-    posix_memalign(&ptr, 4096, size);
-    return ptr;
+    return PINT_mem_pool_alloc((size_t) size);
 }
 
 
@@ -896,8 +1139,7 @@ int BMI_tcp_memfree(void *buffer,
 		    bmi_size_t size,
 		    enum bmi_op_type send_recv)
 {
-    /*PINT_mem_aligned_free(buffer);*/
-    free(buffer);
+    PINT_mem_pool_free(buffer);
     return (0);
 }
 
@@ -909,10 +1151,7 @@ int BMI_tcp_memfree(void *buffer,
  */
 int BMI_tcp_unexpected_free(void *buffer)
 {
-    if (buffer)
-    {
-	free(buffer);
-    }
+    PINT_mem_pool_free(buffer);
     return (0);
 }
 
@@ -1879,6 +2118,15 @@ int BMI_tcp_cancel(bmi_op_id_t id,
         return (0);
     }
 
+    /* its connection is gone already; it completes with the error once
+     * the kernel lets go of its buffers
+     */
+    if (((struct tcp_op *) (query_op->method_data))->zc_draining)
+    {
+        gen_mutex_unlock(&interface_mutex);
+        return (0);
+    }
+
     /* easy case: is the operation already completed? */
     if (((struct tcp_op *) (query_op->method_data))->tcp_op_state ==
 	    BMI_TCP_COMPLETE)
@@ -1894,8 +2142,11 @@ int BMI_tcp_cancel(bmi_op_id_t id,
 	return (0);
     }
 
-    /* has the operation started moving data yet? */
-    if (query_op->env_amt_complete)
+    /* has the operation started moving data yet?  The pieces of a
+     * striped message may be moving on other connections.
+     */
+    if (query_op->env_amt_complete ||
+        ((struct tcp_op *) (query_op->method_data))->stripe_pending)
     {
 	/* be pessimistic and kill the socket, even if not in forceful
 	 * cancel mode */
@@ -2266,18 +2517,30 @@ void tcp_forget_addr(bmi_method_addr_p map,
         }
     }
 
+    tcp_zc_drain(map, error_code);
     tcp_shutdown_addr(map);
     tcp_cleanse_addr(map, error_code);
     tcp_addr_data->addr_error = error_code;
+
+    /* the rest of a striped group goes with any one connection of it */
+    if (tcp_addr_data->stripe_primary)
+    {
+        tcp_stripe_fail(tcp_addr_data->stripe_primary, error_code);
+    }
+    else if (tcp_addr_data->stripes)
+    {
+        tcp_stripe_fail(map, error_code);
+    }
     
     if (dealloc_flag)
     {
 	dealloc_tcp_method_addr(map);
     }
-    else
+    else if (bmi_addr)
     {
         /* this will cause the bmi control layer to check to see if 
-         * this address can be completely forgotten
+         * this address can be completely forgotten; extra connections
+         * we opened ourselves were never registered with it
          */
         bmi_method_addr_forget_callback(bmi_addr);
     }
@@ -2301,14 +2564,50 @@ void tcp_forget_addr(bmi_method_addr_p map,
 static void dealloc_tcp_method_addr(bmi_method_addr_p map)
 {
     struct tcp_addr *tcp_addr_data = NULL;
+    struct tcp_addr *stripe_data = NULL;
+    int i;
 
     tcp_addr_data = map->method_data;
 
+    /* let go of a striped group.  Extra connections we opened belong to
+     * the primary; those a peer opened are registered addresses of their
+     * own and are only unhooked.
+     */
+    if (tcp_addr_data->stripe_primary)
+    {
+        stripe_data = tcp_addr_data->stripe_primary->method_data;
+        stripe_data->stripes[tcp_addr_data->stripe_index - 1] = NULL;
+        stripe_data->stripes_ready = 0;
+    }
+    if (tcp_addr_data->stripes)
+    {
+        for (i = 0; i < tcp_addr_data->stripe_count - 1; i++)
+        {
+            if (!tcp_addr_data->stripes[i])
+            {
+                continue;
+            }
+            stripe_data = tcp_addr_data->stripes[i]->method_data;
+            stripe_data->stripe_primary = NULL;
+            if (!stripe_data->dont_reconnect)
+            {
+                tcp_forget_addr(tcp_addr_data->stripes[i], 1,
+                                bmi_tcp_errno_to_pvfs(-EPIPE));
+            }
+        }
+        free(tcp_addr_data->stripes);
+    }
+    qlist_del_init(&tcp_addr_data->stripe_link);
+    qlist_del_init(&tcp_addr_data->rx_link);
+    free(tcp_addr_data->rx_buf);
+
     /* close the socket, as long as it is not the one we are listening on
      * as a server.
      */
     if (!tcp_addr_data->server_port)
     {
+        /* zero-copy sends still parked keep the socket alive */
+        tcp_zc_drain(map, bmi_tcp_errno_to_pvfs(-EPIPE));
 	if (tcp_addr_data->socket > -1)
 	{
 	    close(tcp_addr_data->socket);
@@ -2362,6 +2661,8 @@ bmi_method_addr_p alloc_tcp_method_addr(void)
     tcp_addr_data->port = -1;
     tcp_addr_data->map = my_method_addr;
     tcp_addr_data->sc_index = -1;
+    INIT_QLIST_HEAD(&tcp_addr_data->stripe_link);
+    INIT_QLIST_HEAD(&tcp_addr_data->rx_link);
 
     return (my_method_addr);
 }
@@ -2573,6 +2874,7 @@ static int tcp_sock_init(bmi_method_addr_p my_method_addr)
     }
 
     bmi_set_sock_buffers(tcp_addr_data->socket);
+    tcp_sock_modes(tcp_addr_data);
 
     if (tcp_addr_data->hostname)
     {
@@ -2612,6 +2914,16 @@ static int tcp_sock_init(bmi_method_addr_p my_method_addr)
 	}
     }
 
+    /* ask for the extra connections as soon as the first is on its way */
+    if (tcp_stripes > 1 && !tcp_addr_data->stripe_primary)
+    {
+        ret = tcp_stripe_request(my_method_addr);
+        if (ret < 0)
+        {
+            PVFS_perror_gossip("Warning: not striping", ret);
+        }
+    }
+
     return (0);
 }
 
@@ -2861,7 +3173,7 @@ static int tcp_post_recv_generic(bmi_op_id_t *id,
 
         /* copy out to correct memory regions */
         (*actual_size) = query_op->actual_size;
-        free(query_op->buffer);
+        PINT_mem_pool_free(query_op->buffer);
         *id = 0;
         op_list_remove(query_op);
         dealloc_tcp_method_op(query_op);
@@ -2928,7 +3240,7 @@ static int tcp_post_recv_generic(bmi_op_id_t *id,
         /* release the old buffer */
         if (query_op->buffer)
         {
-            free(query_op->buffer);
+            PINT_mem_pool_free(query_op->buffer);
         }
 
         *id = query_op->op_id;
@@ -2938,6 +3250,7 @@ static int tcp_post_recv_generic(bmi_op_id_t *id,
         query_op->list_count = list_count;
         query_op->user_ptr = user_ptr;
         query_op->context_id = context_id;
+        query_op->expected_size = expected_size;
 
         /* if there is only one item in the list, then keep the list stored
          * in the op structure.  This allows us to use the same code for send
@@ -2957,20 +3270,23 @@ static int tcp_post_recv_generic(bmi_op_id_t *id,
             query_op->size_list = size_list;
         }
 
+        if (query_op->mode == TCP_MODE_STRIPED)
+        {
+            /* the first piece of a striped message; the rest follow on
+             * the other connections and it completes along with them
+             */
+            tcp_stripe_recv_start(query_op);
+            if (tcp_addr_data->addr_error)
+            {
+                return (0);
+            }
+        }
+
         if (query_op->amt_complete < query_op->actual_size)
         {
             /* try to recv some more data */
             tcp_addr_data = query_op->addr->method_data;
-            ret = payload_progress(tcp_addr_data->socket,
-                                   query_op->buffer_list,
-                                   query_op->size_list,
-                                   query_op->list_count,
-                                   query_op->actual_size,
-                                   &(query_op->list_index),
-                                   &(query_op->cur_index_complete),
-                                   BMI_RECV,
-                                   NULL,
-                                   0);
+            ret = tcp_recv_payload(query_op);
             if (ret < 0)
             {
                 PVFS_perror_gossip("Error: payload_progress", ret);
@@ -2980,11 +3296,26 @@ static int tcp_post_recv_generic(bmi_op_id_t *id,
             }
 
             query_op->amt_complete += ret;
+            if (tcp_addr_data->rx_off < tcp_addr_data->rx_len)
+            {
+                /* more was staged behind this message than the socket
+                 * will ever report again
+                 */
+                qlist_del(&tcp_addr_data->rx_link);
+                qlist_add_tail(&tcp_addr_data->rx_link, &tcp_rx_staged);
+            }
         }
 
         assert(query_op->amt_complete <= query_op->actual_size);
 
-        if (query_op->amt_complete == query_op->actual_size)
+        if (query_op->amt_complete == query_op->actual_size &&
+            tcp_op_data->stripe_pending)
+        {
+            op_list_remove(query_op);
+            tcp_op_done(query_op);
+            return (0);
+        }
+        else if (query_op->amt_complete == query_op->actual_size)
         {
             /* we are done */
             op_list_remove(query_op);
@@ -3103,10 +3434,7 @@ static int tcp_cleanse_addr(bmi_method_addr_p map,
 		}
 		else
 		{
-		    ((struct tcp_op *)(query_op->method_data))->tcp_op_state = 
-			    BMI_TCP_COMPLETE;
-		    op_list_add(completion_array[query_op->context_id], 
-                                query_op);
+		    tcp_op_done(query_op);
 		}
 	    }
 	}
@@ -3132,6 +3460,11 @@ static int tcp_shutdown_addr(bmi_method_addr_p map)
     }
     tcp_addr_data->socket = -1;
     tcp_addr_data->not_connected = 1;
+    tcp_addr_data->rx_off = 0;
+    tcp_addr_data->rx_len = 0;
+    qlist_del_init(&tcp_addr_data->rx_link);
+    tcp_addr_data->short_header_timer = 0;
+    tcp_addr_data->coalesce_count = 0;
 
     return (0);
 }
@@ -3158,6 +3491,21 @@ static int tcp_do_work(int max_idle_time)
     struct tcp_addr *tcp_addr_data = NULL;
     struct timespec wait_time;
     struct timeval start;
+    struct timeval now;
+
+    /* staged messages need no poll, and we should not sleep in one
+     * while they wait
+     */
+    if (!qlist_empty(&tcp_rx_staged))
+    {
+        tcp_do_work_staged();
+        max_idle_time = 0;
+    }
+
+    if (!qlist_empty(&tcp_zc_drains))
+    {
+        tcp_zc_drain_work();
+    }
 
     if (sc_test_busy)
     {
@@ -3193,13 +3541,42 @@ static int tcp_do_work(int max_idle_time)
     sc_test_busy = 1;
     gen_mutex_unlock(&interface_mutex);
 
+    /* in busy-poll mode, spin on the sockets for up to tcp_busy_poll
+     * microseconds before sleeping in them
+     */
+    ret = 0;
+    if (tcp_busy_poll && max_idle_time > 0)
+    {
+        gettimeofday(&start, NULL);
+        do
+        {
+            ret = BMI_socket_collection_testglobal(tcp_socket_collection_p,
+                                                   TCP_WORK_METRIC,
+                                                   &socket_count,
+                                                   addr_array,
+                                                   status_array,
+                                                   0);
+            if (ret < 0 || socket_count)
+            {
+                break;
+            }
+            /* the peer may be waiting for this CPU to answer us */
+            sched_yield();
+            gettimeofday(&now, NULL);
+        } while ((now.tv_sec - start.tv_sec) * 1000000 +
+                 (now.tv_usec - start.tv_usec) < tcp_busy_poll);
+    }
+
     /* our turn to look at the socket collection */
-    ret = BMI_socket_collection_testglobal(tcp_socket_collection_p,
-                                           TCP_WORK_METRIC,
-                                           &socket_count,
-                                           addr_array, 
-                                           status_array,
-                                           max_idle_time);
+    if (ret == 0 && socket_count == 0)
+    {
+        ret = BMI_socket_collection_testglobal(tcp_socket_collection_p,
+                                               TCP_WORK_METRIC,
+                                               &socket_count,
+                                               addr_array,
+                                               status_array,
+                                               max_idle_time);
+    }
 
     gen_mutex_lock(&interface_mutex);
     sc_test_busy = 0;
@@ -3230,6 +3607,13 @@ static int tcp_do_work(int max_idle_time)
 	    continue;
 	}
 
+	/* zero-copy completion notices also show up as socket errors */
+	if ((status_array[i] & SC_ERROR_BIT) && tcp_addr_data->zc_state &&
+	    tcp_zc_reap(addr_array[i]) > 0)
+	{
+	    status_array[i] &= ~SC_ERROR_BIT;
+	}
+
 	if (status_array[i] & SC_ERROR_BIT)
 	{
 	    ret = tcp_do_work_error(addr_array[i]);
@@ -3294,6 +3678,38 @@ static int tcp_do_work(int max_idle_time)
 }
 
 
+/* tcp_do_work_staged()
+ *
+ * starts on messages that were staged behind one a recv post has since
+ * received; the socket will not report them again
+ *
+ * no return value
+ */
+static void tcp_do_work_staged(void)
+{
+    struct tcp_addr *tcp_addr_data = NULL;
+    int stall_flag;
+    int ret;
+
+    while (!qlist_empty(&tcp_rx_staged))
+    {
+        tcp_addr_data = qlist_entry(tcp_rx_staged.next, struct tcp_addr,
+                                    rx_link);
+        qlist_del_init(&tcp_addr_data->rx_link);
+        if (tcp_addr_data->addr_error ||
+            find_recv_inflight(tcp_addr_data->map))
+        {
+            continue;
+        }
+        ret = tcp_recv_staged(tcp_addr_data->map, &stall_flag);
+        if (ret < 0)
+        {
+            PVFS_perror_gossip("Warning: BMI recv error, continuing", ret);
+        }
+    }
+}
+
+
 /* tcp_do_work_send()
  *
  * does work on a TCP address that is ready to send data.
@@ -3305,6 +3721,7 @@ static int tcp_do_work_send(bmi_method_addr_p map,
 {
     method_op_p active_method_op = NULL;
     struct op_list_search_key key;
+    struct tcp_addr *tcp_addr_data = NULL;
     int blocked_flag = 0;
     int ret = 0;
     int tmp_stall_flag;
@@ -3326,7 +3743,18 @@ static int tcp_do_work_send(bmi_method_addr_p map,
 	    return (0);
 	}
 
-	ret = work_on_send_op(active_method_op, &blocked_flag, &tmp_stall_flag);
+	tcp_addr_data = map->method_data;
+	if (TCP_COALESCE_OK(tcp_addr_data, active_method_op->actual_size) &&
+	    !tcp_addr_data->not_connected)
+	{
+	    ret = tcp_send_coalesced(active_method_op, &blocked_flag,
+	                             &tmp_stall_flag);
+	}
+	else
+	{
+	    ret = work_on_send_op(active_method_op, &blocked_flag,
+	                          &tmp_stall_flag);
+	}
 	if (!tmp_stall_flag)
         {
 	    *stall_flag = 0;
@@ -3382,6 +3810,7 @@ static int handle_new_connection(bmi_method_addr_p map)
     tcp_addr_data = new_addr->method_data;
     tcp_addr_data->socket = accepted_socket;
     tcp_addr_data->peer = tmp_peer;
+    tcp_sock_modes(tcp_addr_data);
     tcp_addr_data->peer_type = BMI_TCP_PEER_IP;
 
     /* set a flag to make sure that we never try to reconnect this address
@@ -3417,15 +3846,9 @@ static int tcp_do_work_recv(bmi_method_addr_p map,
 {
     method_op_p active_method_op = NULL;
     int ret = -1;
-    void *new_buffer = NULL;
-    struct op_list_search_key key;
-    struct tcp_msg_header new_header;
     struct tcp_addr *tcp_addr_data = map->method_data;
     struct tcp_op *tcp_op_data = NULL;
-    int tmp_errno;
-    int tmp;
     bmi_size_t old_amt_complete = 0;
-    time_t current_time;
 
     *stall_flag = 1;
 
@@ -3443,7 +3866,8 @@ static int tcp_do_work_recv(bmi_method_addr_p map,
     if (active_method_op)
     {
 	tcp_op_data = active_method_op->method_data;
-	if (active_method_op->mode == TCP_MODE_REND 
+	if ((active_method_op->mode == TCP_MODE_REND ||
+             active_method_op->mode == TCP_MODE_STRIPED)
                 && tcp_op_data->tcp_op_state == BMI_TCP_BUFFERING)
 	{
 	    /* we must wait for recv post */
@@ -3482,84 +3906,157 @@ static int tcp_do_work_recv(bmi_method_addr_p map,
                 tcp_addr_data->zero_read_limit = 0;
             }
 
-	    return (ret);
+	    if (ret < 0 || tcp_addr_data->addr_error ||
+	        find_recv_inflight(map))
+	    {
+	        return (ret);
+	    }
+	    /* finished; more may have been staged behind it */
+	    return (tcp_recv_staged(map, stall_flag));
 	}
     }
 
-    /* let's see if the entire header is ready to be received.  If so
-     * we will go ahead and pull it.  Otherwise, we will try again later.
-     * It isn't worth the complication of reading only a partial message
-     * header - we really want it atomically
+    /* pull in as much as the staging buffer takes: the next header,
+     * and often the payload and more messages behind it.  A partial
+     * header is kept there until the rest arrives; leaving it in the
+     * socket instead can hold the receive window shut, since the kernel
+     * charges the buffer for the whole segment the bytes came in.
      */
-    ret = BMI_sockio_nbpeek(tcp_addr_data->socket,
-                            new_header.enc_hdr, 
-                            TCP_ENC_HDR_SIZE);
-    if (ret < 0)
+    if (tcp_addr_data->rx_len - tcp_addr_data->rx_off < TCP_ENC_HDR_SIZE)
     {
-	tcp_forget_addr(map, 0, bmi_tcp_errno_to_pvfs(-errno));
-	return (0);
-    }
+        if (!tcp_addr_data->rx_buf)
+        {
+            tcp_addr_data->rx_buf = malloc(BMI_TCP_RX_BUF_SIZE);
+            if (!tcp_addr_data->rx_buf)
+            {
+                tcp_forget_addr(map, 0, bmi_tcp_errno_to_pvfs(-ENOMEM));
+                return (bmi_tcp_errno_to_pvfs(-ENOMEM));
+            }
+        }
+        if (tcp_addr_data->rx_off)
+        {
+            memmove(tcp_addr_data->rx_buf,
+                    tcp_addr_data->rx_buf + tcp_addr_data->rx_off,
+                    tcp_addr_data->rx_len - tcp_addr_data->rx_off);
+            tcp_addr_data->rx_len -= tcp_addr_data->rx_off;
+            tcp_addr_data->rx_off = 0;
+        }
 
-    if (ret == 0)
-    {
-        gossip_debug(GOSSIP_BMI_DEBUG_TCP, 
-                     "Warning: bmi_tcp unable "
-                     "to recv any data reported by poll(). [2]\n");
+        ret = BMI_sockio_nbrecv_once(tcp_addr_data->socket,
+                                     tcp_addr_data->rx_buf +
+                                     tcp_addr_data->rx_len,
+                                     BMI_TCP_RX_BUF_SIZE -
+                                     tcp_addr_data->rx_len);
+        if (ret < 0)
+        {
+            tcp_forget_addr(map, 0, bmi_tcp_errno_to_pvfs(-errno));
+            return (0);
+        }
 
-        if (tcp_addr_data->zero_read_limit++ == BMI_TCP_ZERO_READ_LIMIT)
+        if (ret == 0)
         {
-            gossip_debug(GOSSIP_BMI_DEBUG_TCP,
-                         "...dropping connection.\n");
-            tcp_forget_addr(map, 0, bmi_tcp_errno_to_pvfs(-EPIPE));
+            gossip_debug(GOSSIP_BMI_DEBUG_TCP, 
+                         "Warning: bmi_tcp unable "
+                         "to recv any data reported by poll(). [2]\n");
+
+            if (tcp_addr_data->zero_read_limit++ == BMI_TCP_ZERO_READ_LIMIT)
+            {
+                gossip_debug(GOSSIP_BMI_DEBUG_TCP,
+                             "...dropping connection.\n");
+                tcp_forget_addr(map, 0, bmi_tcp_errno_to_pvfs(-EPIPE));
+            }
+            return (0);
         }
-	return (0);
-    }
-    else
-    {
         tcp_addr_data->zero_read_limit = 0;
+        tcp_addr_data->rx_len += ret;
     }
 
-    if (ret < TCP_ENC_HDR_SIZE)
+    return (tcp_recv_staged(map, stall_flag));
+}
+
+
+/* tcp_recv_staged()
+ *
+ * starts on the messages whose headers are staged for an address, until
+ * one of them needs more than was staged or waits for a recv post
+ *
+ * returns 0 on success, -errno on failure
+ */
+static int tcp_recv_staged(bmi_method_addr_p map,
+                           int *stall_flag)
+{
+    struct tcp_addr *tcp_addr_data = map->method_data;
+    struct tcp_msg_header new_header;
+    time_t current_time;
+    int ret;
+
+    while (tcp_addr_data->rx_len - tcp_addr_data->rx_off >= TCP_ENC_HDR_SIZE)
     {
-        current_time = time(NULL);
-        if (!tcp_addr_data->short_header_timer)
-        {
-            tcp_addr_data->short_header_timer = current_time;
-        }
-        else if ((current_time - tcp_addr_data->short_header_timer) > 
-                 BMI_TCP_HEADER_WAIT_SECONDS)
+        tcp_addr_data->short_header_timer = 0;
+        *stall_flag = 0;
+        gossip_ldebug(GOSSIP_BMI_DEBUG_TCP, "Read header for new op.\n");
+        memcpy(new_header.enc_hdr,
+               tcp_addr_data->rx_buf + tcp_addr_data->rx_off,
+               TCP_ENC_HDR_SIZE);
+        tcp_addr_data->rx_off += TCP_ENC_HDR_SIZE;
+
+        ret = tcp_recv_header(map, new_header);
+        if (ret < 0 || tcp_addr_data->addr_error || find_recv_inflight(map))
         {
-	    gossip_err("Error: incomplete BMI TCP header after %d seconds, "
-                       "closing connection.\n",
-                       BMI_TCP_HEADER_WAIT_SECONDS);
-            tcp_forget_addr(map, 0, bmi_tcp_errno_to_pvfs(-EPIPE));
-            return (0);
+            /* anything behind it waits for this message */
+            return (ret);
         }
+    }
 
-	/* header not ready yet, but we will keep hoping */
-	return (0);
+    if (tcp_addr_data->rx_off == tcp_addr_data->rx_len)
+    {
+        tcp_addr_data->rx_off = 0;
+        tcp_addr_data->rx_len = 0;
+        return (0);
     }
 
-    tcp_addr_data->short_header_timer = 0;
-    *stall_flag = 0;
-    gossip_ldebug(GOSSIP_BMI_DEBUG_TCP, "Reading header for new op.\n");
-    ret = BMI_sockio_nbrecv(tcp_addr_data->socket,
-                            new_header.enc_hdr, 
-                            TCP_ENC_HDR_SIZE);
-    if (ret < TCP_ENC_HDR_SIZE)
+    current_time = time(NULL);
+    if (!tcp_addr_data->short_header_timer)
     {
-	tmp_errno = errno;
-	gossip_err("Error: BMI_sockio_nbrecv: %s\n", strerror(tmp_errno));
-	tcp_forget_addr(map, 0, bmi_tcp_errno_to_pvfs(-tmp_errno));
-	return (0);
+        tcp_addr_data->short_header_timer = current_time;
+    }
+    else if ((current_time - tcp_addr_data->short_header_timer) > 
+             BMI_TCP_HEADER_WAIT_SECONDS)
+    {
+        gossip_err("Error: incomplete BMI TCP header after %d seconds, "
+                   "closing connection.\n",
+                   BMI_TCP_HEADER_WAIT_SECONDS);
+        tcp_forget_addr(map, 0, bmi_tcp_errno_to_pvfs(-EPIPE));
+        return (0);
     }
 
-    /* decode the header */
-    BMI_TCP_DEC_HDR(new_header);
+    /* header not ready yet, but we will keep hoping */
+    return (0);
+}
 
-    /* so we have the header. now what?  These are the possible
-     * scenarios:
-     * a) unexpected message
+
+/* tcp_recv_header()
+ *
+ * starts the operation for a message whose header has been read
+ *
+ * returns 0 on success, -errno on failure
+ */
+static int tcp_recv_header(bmi_method_addr_p map,
+                           struct tcp_msg_header new_header)
+{
+    method_op_p active_method_op = NULL;
+    void *new_buffer = NULL;
+    struct op_list_search_key key;
+    struct tcp_addr *tcp_addr_data = map->method_data;
+    struct tcp_op *tcp_op_data = NULL;
+    int tmp;
+
+    /* decode the header */
+    BMI_TCP_DEC_HDR(new_header);
+
+    /* so we have the header. now what?  These are the possible
+     * scenarios:
+     * a) unexpected message
      * b) eager message for which a recv has been posted
      * c) eager message for which a recv has not been posted
      * d) rendezvous messsage for which a recv has been posted
@@ -3579,6 +4076,12 @@ static int tcp_do_work_recv(bmi_method_addr_p map,
 		  (int) new_header.mode);
     gossip_ldebug(GOSSIP_BMI_DEBUG_TCP, "tag: %d\n", (int) new_header.tag);
 
+    if (new_header.mode == TCP_MODE_STRIPE_CTL)
+    {
+        tcp_stripe_ctl(map, &new_header);
+        return (0);
+    }
+
     if (new_header.mode == TCP_MODE_UNEXP)
     {
 	/* allocate the operation structure */
@@ -3590,7 +4093,7 @@ static int tcp_do_work_recv(bmi_method_addr_p map,
 	}
 
 	/* create data buffer */
-	new_buffer = malloc(new_header.size);
+	new_buffer = PINT_mem_pool_alloc(new_header.size);
 	if (!new_buffer)
 	{
 	    dealloc_tcp_method_op(active_method_op);
@@ -3649,6 +4152,17 @@ static int tcp_do_work_recv(bmi_method_addr_p map,
 	active_method_op->env_amt_complete = TCP_ENC_HDR_SIZE;
 	active_method_op->actual_size = new_header.size;
 	op_list_add(op_list_array[IND_RECV_INFLIGHT], active_method_op);
+	if (new_header.mode == TCP_MODE_STRIPED)
+	{
+	    /* this is the first piece; the rest follow on the other
+	     * connections
+	     */
+	    tcp_stripe_recv_start(active_method_op);
+	    if (tcp_addr_data->addr_error)
+	    {
+		return (0);
+	    }
+	}
 	return (work_on_recv_op(active_method_op, &tmp));
     }
 
@@ -3664,7 +4178,7 @@ static int tcp_do_work_recv(bmi_method_addr_p map,
     if (new_header.mode == TCP_MODE_EAGER)
     {
 	/* create data buffer for eager messages */
-	new_buffer = malloc(new_header.size);
+	new_buffer = PINT_mem_pool_alloc(new_header.size);
 	if (!new_buffer)
 	{
 	    dealloc_tcp_method_op(active_method_op);
@@ -3722,6 +4236,7 @@ static int work_on_send_op(method_op_p my_method_op,
     int ret = -1;
     struct tcp_addr *tcp_addr_data = my_method_op->addr->method_data;
     struct tcp_op *tcp_op_data = my_method_op->method_data;
+    uint32_t zc_next;
 
     *blocked_flag = 1;
     *stall_flag = 0;
@@ -3746,6 +4261,7 @@ static int work_on_send_op(method_op_p my_method_op,
 	}
     }
 
+    zc_next = tcp_addr_data->zc_next;
     ret = payload_progress(tcp_addr_data->socket,
 	                   my_method_op->buffer_list,
 	                   my_method_op->size_list,
@@ -3755,7 +4271,15 @@ static int work_on_send_op(method_op_p my_method_op,
 	                   &(my_method_op->cur_index_complete),
 	                   BMI_SEND,
 	                   tcp_op_data->env.enc_hdr,
-	                   &my_method_op->env_amt_complete);
+	                   &my_method_op->env_amt_complete,
+	                   TCP_ZC_NEXT(tcp_addr_data,
+	                               my_method_op->actual_size));
+    if (tcp_addr_data->zc_next != zc_next)
+    {
+	/* the buffers stay with the kernel until it releases this send */
+	tcp_op_data->zc_used = 1;
+	tcp_op_data->zc_seq = tcp_addr_data->zc_next;
+    }
     if (ret < 0)
     {
         PVFS_perror_gossip("Error: payload_progress", ret);
@@ -3776,14 +4300,15 @@ static int work_on_send_op(method_op_p my_method_op,
     if (my_method_op->amt_complete == my_method_op->actual_size 
             && my_method_op->env_amt_complete == TCP_ENC_HDR_SIZE)
     {
-	/* we are done */
+	/* we are done, once the kernel lets go of the buffers */
 	my_method_op->error_code = 0;
 	BMI_socket_collection_remove_write_bit(tcp_socket_collection_p,
 					       my_method_op->addr);
 	op_list_remove(my_method_op);
-	((struct tcp_op *) (my_method_op->method_data))->tcp_op_state = 
-	        BMI_TCP_COMPLETE;
-	op_list_add(completion_array[my_method_op->context_id], my_method_op);
+	if (!tcp_zc_hold(my_method_op))
+	{
+	    tcp_op_done(my_method_op);
+	}
 	*blocked_flag = 0;
     }
     else
@@ -3796,6 +4321,221 @@ static int work_on_send_op(method_op_p my_method_op,
 }
 
 
+/* tcp_send_coalesced()
+ *
+ * writes the run of small sends queued for an address, starting with
+ * first_op, in a single call.  this is called by the poll function.
+ *
+ * sets blocked_flag if no more work can be done on socket without
+ * blocking
+ * returns 0 on success, -errno on failure.
+ */
+static int tcp_send_coalesced(method_op_p first_op,
+                              int *blocked_flag,
+                              int *stall_flag)
+{
+    bmi_method_addr_p map = first_op->addr;
+    struct tcp_addr *tcp_addr_data = map->method_data;
+    struct tcp_op *tcp_op_data = NULL;
+    struct op_list_search_key key;
+    method_op_p op = NULL;
+    method_op_p next_op = NULL;
+    bmi_size_t bytes = 0;
+    bmi_size_t op_bytes;
+    bmi_size_t remaining;
+    bmi_size_t offset;
+    bmi_size_t len;
+    int count = 0;
+    int op_count;
+    int done = 0;
+    int index;
+    int ret;
+
+    *blocked_flag = 1;
+    *stall_flag = 0;
+
+    memset(&key, 0, sizeof(struct op_list_search_key));
+    key.method_addr = map;
+    key.method_addr_yes = 1;
+
+    /* gather what is left of each send, in queue order, until one is
+     * not small or the vector or byte limit is reached
+     */
+    for (op = first_op; op && bytes < BMI_TCP_COALESCE_BYTES;
+         op = op_list_search_next(op_list_array[IND_SEND], &key, op))
+    {
+        if (!TCP_COALESCE_OK(tcp_addr_data, op->actual_size) ||
+            count == BMI_TCP_COALESCE_IOV)
+        {
+            break;
+        }
+        tcp_op_data = op->method_data;
+        op_count = 0;
+        op_bytes = 0;
+        if (op->env_amt_complete < TCP_ENC_HDR_SIZE)
+        {
+            coalesce_io_vector[count].iov_base =
+                &tcp_op_data->env.enc_hdr[op->env_amt_complete];
+            coalesce_io_vector[count].iov_len =
+                TCP_ENC_HDR_SIZE - op->env_amt_complete;
+            op_bytes += coalesce_io_vector[count].iov_len;
+            op_count++;
+        }
+        remaining = op->actual_size - op->amt_complete;
+        index = op->list_index;
+        offset = op->cur_index_complete;
+        while (remaining > 0 && count + op_count < BMI_TCP_COALESCE_IOV)
+        {
+            len = op->size_list[index] - offset;
+            if (len > remaining)
+            {
+                len = remaining;
+            }
+            coalesce_io_vector[count + op_count].iov_base =
+                (char *) op->buffer_list[index] + offset;
+            coalesce_io_vector[count + op_count].iov_len = len;
+            op_bytes += len;
+            op_count++;
+            remaining -= len;
+            index++;
+            offset = 0;
+        }
+        if (remaining > 0)
+        {
+            /* does not fit; it goes in the next write */
+            break;
+        }
+        count += op_count;
+        bytes += op_bytes;
+    }
+
+    if (count == 0)
+    {
+        /* too many pieces to go with others */
+        return (work_on_send_op(first_op, blocked_flag, stall_flag));
+    }
+
+    ret = BMI_sockio_nbvector(tcp_addr_data->socket, coalesce_io_vector,
+                              count, 0);
+    if (ret < 0)
+    {
+        ret = bmi_tcp_errno_to_pvfs(-errno);
+        PVFS_perror_gossip("Error: BMI_sockio_nbvector", ret);
+        tcp_forget_addr(map, 0, ret);
+        return (0);
+    }
+    if (ret == 0)
+    {
+        *stall_flag = 1;
+        return (0);
+    }
+
+    gossip_ldebug(GOSSIP_BMI_DEBUG_TCP, "Sent: %d bytes of data "
+                  "in %d vectors.\n", ret, count);
+    tcp_addr_data->coalesce_count = 0;
+    if (ret == bytes)
+    {
+        *blocked_flag = 0;
+    }
+
+    /* credit what was written to the sends in order */
+    for (op = first_op; op && ret > 0; op = next_op)
+    {
+        next_op = op_list_search_next(op_list_array[IND_SEND], &key, op);
+        tcp_op_data = op->method_data;
+        if (op->env_amt_complete < TCP_ENC_HDR_SIZE)
+        {
+            len = TCP_ENC_HDR_SIZE - op->env_amt_complete;
+            if (len > ret)
+            {
+                len = ret;
+            }
+            op->env_amt_complete += len;
+            ret -= len;
+        }
+        while (ret > 0 && op->amt_complete < op->actual_size)
+        {
+            len = op->size_list[op->list_index] - op->cur_index_complete;
+            if (len > op->actual_size - op->amt_complete)
+            {
+                len = op->actual_size - op->amt_complete;
+            }
+            if (len > ret)
+            {
+                len = ret;
+            }
+            op->cur_index_complete += len;
+            op->amt_complete += len;
+            ret -= len;
+            if (op->cur_index_complete == op->size_list[op->list_index])
+            {
+                op->list_index++;
+                op->cur_index_complete = 0;
+            }
+        }
+
+        if (op->amt_complete == op->actual_size &&
+            op->env_amt_complete == TCP_ENC_HDR_SIZE)
+        {
+            /* we are done */
+            op->error_code = 0;
+            op_list_remove(op);
+            tcp_op_done(op);
+            done++;
+        }
+        else
+        {
+            /* there is still more work to do */
+            tcp_op_data->tcp_op_state = BMI_TCP_INPROGRESS;
+        }
+    }
+
+    if (done)
+    {
+        BMI_socket_collection_remove_write_bits(tcp_socket_collection_p,
+                                                map, done);
+    }
+
+    return (0);
+}
+
+
+/* tcp_coalesce_check()
+ *
+ * counts a small send left in the queue to be written with others, and
+ * writes the queue for its address once enough are waiting or the
+ * first has waited tcp_coalesce microseconds
+ *
+ * no return value
+ */
+static void tcp_coalesce_check(bmi_method_addr_p map)
+{
+    struct tcp_addr *tcp_addr_data = map->method_data;
+    struct timeval now;
+    uint64_t now_us;
+    int stall_flag;
+    int ret;
+
+    gettimeofday(&now, NULL);
+    now_us = (uint64_t) now.tv_sec * 1000000 + now.tv_usec;
+    if (tcp_addr_data->coalesce_count++ == 0)
+    {
+        tcp_addr_data->coalesce_since = now_us;
+    }
+
+    if (!tcp_addr_data->not_connected &&
+        (tcp_addr_data->coalesce_count >= BMI_TCP_COALESCE_OPS ||
+         now_us - tcp_addr_data->coalesce_since >= tcp_coalesce))
+    {
+        ret = tcp_do_work_send(map, &stall_flag);
+        if (ret < 0)
+        {
+            PVFS_perror_gossip("Warning: BMI send error, continuing", ret);
+        }
+    }
+}
+
+
 /* work_on_recv_op()
  *
  * used to perform work on a recv operation.  this is called by the poll
@@ -3808,7 +4548,6 @@ static int work_on_recv_op(method_op_p my_method_op,
                            int *stall_flag)
 {
     int ret = -1;
-    struct tcp_addr *tcp_addr_data = my_method_op->addr->method_data;
     struct tcp_op *tcp_op_data = my_method_op->method_data;
 
     *stall_flag = 1;
@@ -3816,16 +4555,7 @@ static int work_on_recv_op(method_op_p my_method_op,
     if (my_method_op->actual_size != 0)
     {
 	/* now let's try to recv some actual data */
-	ret = payload_progress(tcp_addr_data->socket,
-	                       my_method_op->buffer_list,
-	                       my_method_op->size_list,
-	                       my_method_op->list_count,
-	                       my_method_op->actual_size,
-	                       &(my_method_op->list_index),
-	                       &(my_method_op->cur_index_complete),
-	                       BMI_RECV,
-	                       NULL,
-	                       0);
+	ret = tcp_recv_payload(my_method_op);
 	if (ret < 0)
 	{
             PVFS_perror_gossip("Error: payload_progress", ret);
@@ -3867,10 +4597,7 @@ static int work_on_recv_op(method_op_p my_method_op,
 	    }
 	    else
 	    {
-		((struct tcp_op *)(my_method_op->method_data))->tcp_op_state = 
-		        BMI_TCP_COMPLETE;
-		op_list_add(completion_array[my_method_op->context_id], 
-                            my_method_op);
+		tcp_op_done(my_method_op);
 	    }
 	}
     }
@@ -4213,116 +4940,709 @@ static method_op_p alloc_tcp_method_op(void)
  */
 static void dealloc_tcp_method_op(method_op_p old_op)
 {
+    struct tcp_op *tcp_op_data = old_op->method_data;
+
+    if (tcp_op_data->stripe_buffers)
+    {
+        free(tcp_op_data->stripe_buffers);
+        free(tcp_op_data->stripe_sizes);
+    }
     bmi_dealloc_method_op(old_op);
     return;
 }
 
 
-/* tcp_post_send_generic()
- * 
- * Submits send operations (low level).
+/* tcp_op_done()
  *
- * returns 0 on success that requires later poll, returns 1 on instant
- * completion, -errno on failure
+ * hands a finished operation to its context.  A piece of a striped
+ * message is counted against the message instead, which completes with
+ * its last piece; striping setup messages are simply released.
+ *
+ * no return value
  */
-static int tcp_post_send_generic(bmi_op_id_t *id,
-                                 bmi_method_addr_p dest,
-                                 const void *const *buffer_list,
-                                 const bmi_size_t *size_list,
-                                 int list_count,
-                                 enum bmi_buffer_type buffer_type,
-                                 struct tcp_msg_header my_header,
-                                 void *user_ptr,
-                                 bmi_context_id context_id,
-                                 PVFS_hint hints)
+static void tcp_op_done(method_op_p op)
 {
-    struct tcp_addr *tcp_addr_data = dest->method_data;
-    method_op_p query_op = NULL;
-    int ret = -1;
-    bmi_size_t amt_complete = 0;
-    bmi_size_t env_amt_complete = 0;
-    struct op_list_search_key key;
-    int list_index = 0;
-    bmi_size_t cur_index_complete = 0;
-    PINT_event_id eid = 0;
+    struct tcp_op *tcp_op_data = op->method_data;
+    method_op_p piece = op;
 
-#if PINT_EVENT_ENABLED
-    int i = 0;
-    for (; i < list_count; ++i)
+    if (tcp_op_data->stripe_ctl)
     {
-        total_size += size_list[i];
+        dealloc_tcp_method_op(op);
+        return;
     }
-#endif
 
-    PINT_EVENT_START(bmi_tcp_send_event_id, 
-                     bmi_tcp_pid, 
-                     NULL, 
-                     &eid,
-                     PINT_HINT_GET_CLIENT_ID(hints),
-                     PINT_HINT_GET_REQUEST_ID(hints),
-                     PINT_HINT_GET_RANK(hints),
-                     PINT_HINT_GET_HANDLE(hints),
-                     PINT_HINT_GET_OP_ID(hints),
-                     total_size);
+    if (tcp_op_data->stripe_parent)
+    {
+        op = tcp_op_data->stripe_parent;
+        tcp_op_data = op->method_data;
+    }
 
-    /* Three things can happen here:
-     * a) another op is already in queue for the address, so we just
-     * queue up
-     * b) we can send the whole message and return
-     * c) we send part of the message and queue the rest
-     */
+    if (tcp_op_data->stripe_pending)
+    {
+        if (piece->error_code && !tcp_op_data->stripe_error)
+        {
+            tcp_op_data->stripe_error = piece->error_code;
+        }
+        tcp_op_data->stripe_done += piece->amt_complete;
+        if (piece != op)
+        {
+            dealloc_tcp_method_op(piece);
+        }
+        if (--tcp_op_data->stripe_pending > 0)
+        {
+            return;
+        }
+        op->actual_size = tcp_op_data->stripe_done;
+        op->error_code = tcp_op_data->stripe_error;
+    }
 
-    /* NOTE: on the post_send side of an operation, it doesn't really
-     * matter whether the op is going to be eager or rendezvous.  It is
-     * handled the same way (except for how the header is filled in).
-     * The difference is in the recv processing for TCP.
-     */
+    tcp_op_data->tcp_op_state = BMI_TCP_COMPLETE;
+    op_list_add(completion_array[op->context_id], op);
+}
 
-    /* NOTE: we also don't care what the buffer_type says, TCP could care
-     * less what buffers it is using.
-     */
 
-    /* encode the message header */
-    BMI_TCP_ENC_HDR(my_header);
+/* tcp_stripe_slice()
+ *
+ * fills in buffer and size lists for length bytes at offset within a
+ * message's lists
+ *
+ * returns the number of list entries used
+ */
+static int tcp_stripe_slice(void *const *buffer_list,
+                            const bmi_size_t *size_list,
+                            int list_count,
+                            bmi_size_t offset,
+                            bmi_size_t length,
+                            void **slice_buffers,
+                            bmi_size_t *slice_sizes)
+{
+    int i;
+    int count = 0;
+    bmi_size_t piece;
 
-    /* the first thing we must do is find out if another send is queued
-     * up for this address so that we don't mess up our ordering.    */
-    memset(&key, 0, sizeof(struct op_list_search_key));
-    key.method_addr = dest;
-    key.method_addr_yes = 1;
-    query_op = op_list_search(op_list_array[IND_SEND], &key);
-    if (query_op)
+    for (i = 0; i < list_count && length > 0; i++)
     {
-        /* queue up operation */
-        ret = enqueue_operation(op_list_array[IND_SEND], 
-                                BMI_SEND,
-                                dest, 
-                                (void **) buffer_list,
-                                size_list, 
-                                list_count, 
-                                0, 
-                                0,
-                                id, 
-                                BMI_TCP_INPROGRESS, 
-                                my_header, 
-                                user_ptr,
-                                my_header.size, 
-                                0,
-                                context_id,
-                                eid);
+        if (offset >= size_list[i])
+        {
+            offset -= size_list[i];
+            continue;
+        }
+        piece = size_list[i] - offset;
+        if (piece > length)
+        {
+            piece = length;
+        }
+        slice_buffers[count] = (char *) buffer_list[i] + offset;
+        slice_sizes[count] = piece;
+        count++;
+        length -= piece;
+        offset = 0;
+    }
+    return (count);
+}
 
-        /* TODO: is this causing deadlocks?  See similar call in recv
-         * path for another example.  This particular one seems to be an
-         * issue under a heavy bonnie++ load that Neill has been
-         * debugging.  Comment out for now to see if the problem goes
-         * away.
-         */
-#if 0
-	if (ret >= 0)
-	{
-	    /* go ahead and try to do some work while we are in this
-	     * function since we appear to be backlogged.  Make sure that
-	     * we do not wait in the poll, however.
+
+/* tcp_stripe_send_ctl()
+ *
+ * queues a striping setup message to an address
+ *
+ * returns 0 on success, -errno on failure
+ */
+static int tcp_stripe_send_ctl(bmi_method_addr_p map,
+                               int type,
+                               int index,
+                               uint64_t cookie)
+{
+    struct tcp_msg_header ctl_header;
+    method_op_p ctl_op = NULL;
+    bmi_op_id_t ctl_id;
+    void *no_buffer = NULL;
+    bmi_size_t no_size = 0;
+    int ret;
+
+    memset(&ctl_header, 0, sizeof(ctl_header));
+    ctl_header.magic_nr = BMI_MAGIC_NR;
+    ctl_header.mode = TCP_MODE_STRIPE_CTL;
+    ctl_header.tag = type | (index << 8);
+    ctl_header.size = (bmi_size_t) cookie;
+    BMI_TCP_ENC_HDR(ctl_header);
+
+    ret = enqueue_operation(op_list_array[IND_SEND], BMI_SEND, map,
+                            &no_buffer, &no_size, 1, 0, 0, &ctl_id,
+                            BMI_TCP_INPROGRESS, ctl_header, NULL, 0, 0,
+                            0, 0);
+    if (ret < 0)
+    {
+        return (ret);
+    }
+    ctl_op = id_gen_fast_lookup(ctl_id);
+    ((struct tcp_op *) ctl_op->method_data)->stripe_ctl = 1;
+    return (0);
+}
+
+
+/* tcp_stripe_request()
+ *
+ * asks the peer on a new connection for a group of tcp_stripes
+ * connections; anything sent before the group is set up goes on this
+ * one alone
+ *
+ * returns 0 on success, -errno on failure
+ */
+static int tcp_stripe_request(bmi_method_addr_p map)
+{
+    struct tcp_addr *tcp_addr_data = map->method_data;
+
+    if (!tcp_addr_data->stripes)
+    {
+        tcp_addr_data->stripes = (bmi_method_addr_p *)
+            calloc(tcp_stripes - 1, sizeof(bmi_method_addr_p));
+        if (!tcp_addr_data->stripes)
+        {
+            return (bmi_tcp_errno_to_pvfs(-ENOMEM));
+        }
+        tcp_addr_data->stripe_count = tcp_stripes;
+    }
+    tcp_addr_data->stripes_ready = 0;
+    tcp_addr_data->stripe_failing = 0;
+
+    return (tcp_stripe_send_ctl(map, TCP_STRIPE_REQ,
+                                tcp_addr_data->stripe_count, 0));
+}
+
+
+/* tcp_stripe_connect()
+ *
+ * opens extra connection <index> of a group we asked for and joins it
+ * to the group
+ *
+ * returns 0 on success, -errno on failure
+ */
+static int tcp_stripe_connect(bmi_method_addr_p primary,
+                              int index)
+{
+    struct tcp_addr *primary_data = primary->method_data;
+    struct tcp_addr *stripe_data = NULL;
+    bmi_method_addr_p stripe = primary_data->stripes[index - 1];
+    int ret;
+
+    if (!stripe)
+    {
+        stripe = alloc_tcp_method_addr();
+        if (!stripe)
+        {
+            return (bmi_tcp_errno_to_pvfs(-ENOMEM));
+        }
+        stripe_data = stripe->method_data;
+        stripe_data->hostname = (char *)
+            malloc(strlen(primary_data->hostname) + 1);
+        if (!stripe_data->hostname)
+        {
+            dealloc_tcp_method_addr(stripe);
+            return (bmi_tcp_errno_to_pvfs(-ENOMEM));
+        }
+        strcpy(stripe_data->hostname, primary_data->hostname);
+        stripe_data->port = primary_data->port;
+        stripe_data->stripe_primary = primary;
+        stripe_data->stripe_index = index;
+        primary_data->stripes[index - 1] = stripe;
+    }
+
+    ret = tcp_sock_init(stripe);
+    if (ret < 0)
+    {
+        return (ret);
+    }
+    return (tcp_stripe_send_ctl(stripe, TCP_STRIPE_JOIN, index,
+                                primary_data->stripe_cookie));
+}
+
+
+/* tcp_stripe_ctl()
+ *
+ * handles a striping setup message
+ *
+ * no return value
+ */
+static void tcp_stripe_ctl(bmi_method_addr_p map,
+                           struct tcp_msg_header *ctl_header)
+{
+    struct tcp_addr *tcp_addr_data = map->method_data;
+    struct tcp_addr *primary_data = NULL;
+    struct qlist_head *iterator = NULL;
+    int type = ctl_header->tag & 0xff;
+    int index = (ctl_header->tag >> 8) & 0xffff;
+    uint64_t cookie = (uint64_t) ctl_header->size;
+    int ret = 0;
+    int i;
+
+    gossip_debug(GOSSIP_BMI_DEBUG_TCP, "Striping setup message %d, "
+                 "connection %d.\n", type, index);
+
+    switch (type)
+    {
+    case TCP_STRIPE_REQ:
+        /* a request we cannot meet goes unanswered, and the peer keeps
+         * to the one connection
+         */
+        if (index < 2 || index > TCP_STRIPE_MAX || tcp_addr_data->stripes)
+        {
+            break;
+        }
+        tcp_addr_data->stripes = (bmi_method_addr_p *)
+            calloc(index - 1, sizeof(bmi_method_addr_p));
+        if (!tcp_addr_data->stripes)
+        {
+            break;
+        }
+        tcp_addr_data->stripe_count = index;
+        tcp_addr_data->stripe_cookie =
+            ((uint64_t) ++tcp_stripe_cookie_next << 32) | (uint32_t) random();
+        qlist_add_tail(&tcp_addr_data->stripe_link, &tcp_stripe_groups);
+        ret = tcp_stripe_send_ctl(map, TCP_STRIPE_COOKIE, index,
+                                  tcp_addr_data->stripe_cookie);
+        break;
+
+    case TCP_STRIPE_COOKIE:
+        if (!tcp_addr_data->stripes || index != tcp_addr_data->stripe_count)
+        {
+            break;
+        }
+        tcp_addr_data->stripe_cookie = cookie;
+        for (i = 1; i < index && ret == 0; i++)
+        {
+            ret = tcp_stripe_connect(map, i);
+        }
+        if (ret < 0)
+        {
+            /* the group never fills, so this connection is used alone */
+            PVFS_perror_gossip("Warning: not striping", ret);
+            ret = 0;
+        }
+        break;
+
+    case TCP_STRIPE_JOIN:
+        qlist_for_each(iterator, &tcp_stripe_groups)
+        {
+            primary_data = qlist_entry(iterator, struct tcp_addr,
+                                       stripe_link);
+            if (primary_data->stripe_cookie == cookie)
+            {
+                break;
+            }
+        }
+        if (iterator == &tcp_stripe_groups || index < 1 ||
+            index >= primary_data->stripe_count ||
+            primary_data->stripes[index - 1] || primary_data->addr_error)
+        {
+            gossip_err("Error: bad request to join a striped "
+                       "connection.\n");
+            ret = bmi_tcp_errno_to_pvfs(-EPROTO);
+            break;
+        }
+        primary_data->stripes[index - 1] = map;
+        primary_data->stripes_ready++;
+        tcp_addr_data->stripe_primary = primary_data->map;
+        tcp_addr_data->stripe_index = index;
+        ret = tcp_stripe_send_ctl(map, TCP_STRIPE_ACK, index, cookie);
+        break;
+
+    case TCP_STRIPE_ACK:
+        if (tcp_addr_data->stripe_primary)
+        {
+            primary_data = tcp_addr_data->stripe_primary->method_data;
+            primary_data->stripes_ready++;
+        }
+        break;
+    }
+
+    if (ret < 0)
+    {
+        PVFS_perror_gossip("Error: striped connection setup", ret);
+        tcp_forget_addr(map, 0, ret);
+    }
+}
+
+
+/* tcp_stripe_fail()
+ *
+ * shuts down a striped group: a message spread across it cannot finish
+ * once any of its connections is gone
+ *
+ * no return value
+ */
+static void tcp_stripe_fail(bmi_method_addr_p primary,
+                            int error_code)
+{
+    struct tcp_addr *primary_data = primary->method_data;
+    struct tcp_addr *stripe_data = NULL;
+    int i;
+
+    if (primary_data->stripe_failing)
+    {
+        return;
+    }
+    primary_data->stripe_failing = 1;
+    primary_data->stripes_ready = 0;
+    if (!error_code)
+    {
+        error_code = bmi_tcp_errno_to_pvfs(-EPIPE);
+    }
+
+    if (!primary_data->addr_error)
+    {
+        tcp_forget_addr(primary, 0, error_code);
+    }
+    for (i = 0; i < primary_data->stripe_count - 1; i++)
+    {
+        if (!primary_data->stripes[i])
+        {
+            continue;
+        }
+        stripe_data = primary_data->stripes[i]->method_data;
+        if (!stripe_data->addr_error)
+        {
+            tcp_forget_addr(primary_data->stripes[i], 0, error_code);
+        }
+    }
+}
+
+
+/* tcp_post_send_striped()
+ *
+ * splits a send into one piece per connection of the destination's
+ * group.  The first piece goes on the primary connection and tells the
+ * receiver the piece size; the others are ordinary messages with the
+ * same tag on the extra connections, each in its own order.
+ *
+ * returns 0 on success that requires later poll, -errno on failure
+ */
+static int tcp_post_send_striped(bmi_op_id_t *id,
+                                 bmi_method_addr_p dest,
+                                 const void *const *buffer_list,
+                                 const bmi_size_t *size_list,
+                                 int list_count,
+                                 struct tcp_msg_header my_header,
+                                 void *user_ptr,
+                                 bmi_context_id context_id,
+                                 PINT_event_id eid)
+{
+    struct tcp_addr *tcp_addr_data = dest->method_data;
+    struct tcp_op *tcp_op_data = NULL;
+    struct tcp_msg_header piece_header = my_header;
+    int pieces = tcp_addr_data->stripe_count;
+    bmi_size_t chunk = (my_header.size + pieces - 1) / pieces;
+    bmi_size_t length;
+    void **piece_buffers;
+    bmi_size_t *piece_sizes;
+    method_op_p parent = NULL;
+    method_op_p piece = NULL;
+    bmi_op_id_t piece_id;
+    int count;
+    int ret;
+    int i;
+
+    piece_buffers = (void **) malloc(pieces * list_count * sizeof(void *));
+    piece_sizes = (bmi_size_t *)
+        malloc(pieces * list_count * sizeof(bmi_size_t));
+    if (!piece_buffers || !piece_sizes)
+    {
+        free(piece_buffers);
+        free(piece_sizes);
+        return (bmi_tcp_errno_to_pvfs(-ENOMEM));
+    }
+
+    /* a message of at least pieces^2 bytes, which tcp_stripe_min
+     * guarantees, leaves every piece something to carry
+     */
+    for (i = 0; i < pieces; i++)
+    {
+        length = my_header.size - i * chunk;
+        if (length > chunk)
+        {
+            length = chunk;
+        }
+        count = tcp_stripe_slice((void *const *) buffer_list, size_list,
+                                 list_count, i * chunk, length,
+                                 &piece_buffers[i * list_count],
+                                 &piece_sizes[i * list_count]);
+        piece_header.size = length;
+        if (i == 0)
+        {
+            piece_header.mode = TCP_MODE_STRIPED;
+        }
+        else
+        {
+            piece_header.mode = (length <= TCP_MODE_EAGER_LIMIT) ?
+                TCP_MODE_EAGER : TCP_MODE_REND;
+        }
+        BMI_TCP_ENC_HDR(piece_header);
+
+        ret = enqueue_operation(op_list_array[IND_SEND], BMI_SEND,
+                                i ? tcp_addr_data->stripes[i - 1] : dest,
+                                &piece_buffers[i * list_count],
+                                &piece_sizes[i * list_count], count,
+                                0, 0, i ? &piece_id : id,
+                                BMI_TCP_INPROGRESS, piece_header,
+                                i ? NULL : user_ptr, length, 0,
+                                context_id, i ? 0 : eid);
+        if (ret < 0 && i == 0)
+        {
+            free(piece_buffers);
+            free(piece_sizes);
+            return (ret);
+        }
+        if (i == 0)
+        {
+            parent = id_gen_fast_lookup(*id);
+            tcp_op_data = parent->method_data;
+            tcp_op_data->stripe_pending = pieces;
+            tcp_op_data->stripe_buffers = piece_buffers;
+            tcp_op_data->stripe_sizes = piece_sizes;
+        }
+        else if (ret < 0)
+        {
+            /* the pieces that will never be sent fail the message */
+            tcp_op_data->stripe_error = ret;
+            tcp_op_data->stripe_pending -= pieces - i;
+            break;
+        }
+        else
+        {
+            piece = id_gen_fast_lookup(piece_id);
+            ((struct tcp_op *) piece->method_data)->stripe_parent = parent;
+        }
+    }
+
+    return (0);
+}
+
+
+/* tcp_stripe_recv_start()
+ *
+ * posts receives on the extra connections for the rest of a striped
+ * message whose first piece has matched op.  The first piece's size is
+ * the piece size, so piece <i> lands at i times it.
+ *
+ * no return value
+ */
+static void tcp_stripe_recv_start(method_op_p op)
+{
+    struct tcp_addr *tcp_addr_data = op->addr->method_data;
+    struct tcp_op *tcp_op_data = op->method_data;
+    int pieces = tcp_addr_data->stripe_count;
+    bmi_size_t chunk = op->actual_size;
+    bmi_size_t length;
+    bmi_size_t piece_size;
+    bmi_op_id_t piece_id;
+    method_op_p piece = NULL;
+    void **piece_buffers;
+    bmi_size_t *piece_sizes;
+    int count;
+    int ret;
+    int i;
+
+    /* the message's own piece, and a hold while the others are posted
+     * in case one of them fails the group and finishes the rest
+     */
+    tcp_op_data->stripe_pending = 2;
+
+    if (pieces < 2 || !tcp_addr_data->stripes)
+    {
+        gossip_err("Error: striped message on a connection without "
+                   "a group.\n");
+        tcp_op_data->stripe_error = bmi_tcp_errno_to_pvfs(-EPROTO);
+        tcp_op_data->stripe_pending--;
+        return;
+    }
+
+    piece_buffers = (void **)
+        malloc(pieces * op->list_count * sizeof(void *));
+    piece_sizes = (bmi_size_t *)
+        malloc(pieces * op->list_count * sizeof(bmi_size_t));
+    if (!piece_buffers || !piece_sizes)
+    {
+        free(piece_buffers);
+        free(piece_sizes);
+        tcp_op_data->stripe_error = bmi_tcp_errno_to_pvfs(-ENOMEM);
+        tcp_op_data->stripe_pending--;
+        return;
+    }
+    tcp_op_data->stripe_buffers = piece_buffers;
+    tcp_op_data->stripe_sizes = piece_sizes;
+
+    for (i = 1; i < pieces; i++)
+    {
+        length = op->expected_size - i * chunk;
+        if (length > chunk)
+        {
+            length = chunk;
+        }
+        if (length <= 0 || !tcp_addr_data->stripes[i - 1])
+        {
+            tcp_op_data->stripe_error = bmi_tcp_errno_to_pvfs(-EPROTO);
+            continue;
+        }
+        count = tcp_stripe_slice(op->buffer_list, op->size_list,
+                                 op->list_count, i * chunk, length,
+                                 &piece_buffers[i * op->list_count],
+                                 &piece_sizes[i * op->list_count]);
+        ret = tcp_post_recv_generic(&piece_id, tcp_addr_data->stripes[i - 1],
+                                    &piece_buffers[i * op->list_count],
+                                    &piece_sizes[i * op->list_count],
+                                    count, length, &piece_size,
+                                    BMI_EXT_ALLOC, op->msg_tag, NULL,
+                                    op->context_id, NULL);
+        if (ret == 1)
+        {
+            tcp_op_data->stripe_done += piece_size;
+        }
+        else if (ret == 0)
+        {
+            piece = id_gen_fast_lookup(piece_id);
+            ((struct tcp_op *) piece->method_data)->stripe_parent = op;
+            tcp_op_data->stripe_pending++;
+        }
+        else if (!tcp_op_data->stripe_error)
+        {
+            tcp_op_data->stripe_error = ret;
+        }
+    }
+
+    /* let go of the hold */
+    if (--tcp_op_data->stripe_pending == 0)
+    {
+        op->actual_size = tcp_op_data->stripe_done;
+        op->error_code = tcp_op_data->stripe_error;
+        tcp_op_data->tcp_op_state = BMI_TCP_COMPLETE;
+        op_list_add(completion_array[op->context_id], op);
+    }
+}
+
+
+/* tcp_post_send_generic()
+ * 
+ * Submits send operations (low level).
+ *
+ * returns 0 on success that requires later poll, returns 1 on instant
+ * completion, -errno on failure
+ */
+static int tcp_post_send_generic(bmi_op_id_t *id,
+                                 bmi_method_addr_p dest,
+                                 const void *const *buffer_list,
+                                 const bmi_size_t *size_list,
+                                 int list_count,
+                                 enum bmi_buffer_type buffer_type,
+                                 struct tcp_msg_header my_header,
+                                 void *user_ptr,
+                                 bmi_context_id context_id,
+                                 PVFS_hint hints)
+{
+    struct tcp_addr *tcp_addr_data = dest->method_data;
+    method_op_p query_op = NULL;
+    int ret = -1;
+    bmi_size_t amt_complete = 0;
+    bmi_size_t env_amt_complete = 0;
+    struct op_list_search_key key;
+    int list_index = 0;
+    bmi_size_t cur_index_complete = 0;
+    PINT_event_id eid = 0;
+
+#if PINT_EVENT_ENABLED
+    int i = 0;
+    for (; i < list_count; ++i)
+    {
+        total_size += size_list[i];
+    }
+#endif
+
+    PINT_EVENT_START(bmi_tcp_send_event_id, 
+                     bmi_tcp_pid, 
+                     NULL, 
+                     &eid,
+                     PINT_HINT_GET_CLIENT_ID(hints),
+                     PINT_HINT_GET_REQUEST_ID(hints),
+                     PINT_HINT_GET_RANK(hints),
+                     PINT_HINT_GET_HANDLE(hints),
+                     PINT_HINT_GET_OP_ID(hints),
+                     total_size);
+
+    /* Three things can happen here:
+     * a) another op is already in queue for the address, so we just
+     * queue up
+     * b) we can send the whole message and return
+     * c) we send part of the message and queue the rest
+     */
+
+    /* NOTE: on the post_send side of an operation, it doesn't really
+     * matter whether the op is going to be eager or rendezvous.  It is
+     * handled the same way (except for how the header is filled in).
+     * The difference is in the recv processing for TCP.
+     */
+
+    /* NOTE: we also don't care what the buffer_type says, TCP could care
+     * less what buffers it is using.
+     */
+
+    /* large messages to a peer with extra connections are spread
+     * across all of them
+     */
+    if (my_header.mode != TCP_MODE_UNEXP &&
+        my_header.size >= tcp_stripe_min &&
+        tcp_addr_data->stripe_count > 1 &&
+        tcp_addr_data->stripes_ready == tcp_addr_data->stripe_count - 1 &&
+        !tcp_addr_data->addr_error)
+    {
+        return (tcp_post_send_striped(id, dest, buffer_list, size_list,
+                                      list_count, my_header, user_ptr,
+                                      context_id, eid));
+    }
+
+    /* encode the message header */
+    BMI_TCP_ENC_HDR(my_header);
+
+    /* the first thing we must do is find out if another send is queued
+     * up for this address so that we don't mess up our ordering.    */
+    memset(&key, 0, sizeof(struct op_list_search_key));
+    key.method_addr = dest;
+    key.method_addr_yes = 1;
+    query_op = op_list_search(op_list_array[IND_SEND], &key);
+    if (query_op)
+    {
+        /* queue up operation */
+        ret = enqueue_operation(op_list_array[IND_SEND], 
+                                BMI_SEND,
+                                dest, 
+                                (void **) buffer_list,
+                                size_list, 
+                                list_count, 
+                                0, 
+                                0,
+                                id, 
+                                BMI_TCP_INPROGRESS, 
+                                my_header, 
+                                user_ptr,
+                                my_header.size, 
+                                0,
+                                context_id,
+                                eid);
+        if (ret == 0 && TCP_COALESCE_OK(tcp_addr_data, my_header.size))
+        {
+            tcp_coalesce_check(dest);
+        }
+
+        /* TODO: is this causing deadlocks?  See similar call in recv
+         * path for another example.  This particular one seems to be an
+         * issue under a heavy bonnie++ load that Neill has been
+         * debugging.  Comment out for now to see if the problem goes
+         * away.
+         */
+#if 0
+	if (ret >= 0)
+	{
+	    /* go ahead and try to do some work while we are in this
+	     * function since we appear to be backlogged.  Make sure that
+	     * we do not wait in the poll, however.
 	     */
 	    ret = tcp_do_work(0);
 	}
@@ -4359,7 +5679,15 @@ static int tcp_post_send_generic(bmi_op_id_t *id,
     return(ret);
 #endif
 
-    if (tcp_addr_data->not_connected)
+    /* a new connection may have queued a striping request ahead of us;
+     * a zero-copy send must not point the kernel at the header on our
+     * stack, so it goes out from the queued op, and a small send may
+     * wait there for others to go with it
+     */
+    if (tcp_addr_data->not_connected ||
+        op_list_search(op_list_array[IND_SEND], &key) ||
+        TCP_ZC_WANTED(tcp_addr_data, my_header.size) ||
+        TCP_COALESCE_OK(tcp_addr_data, my_header.size))
     {
 	/* if the connection is not completed, queue up for later work */
 	ret = enqueue_operation(op_list_array[IND_SEND], 
@@ -4396,7 +5724,8 @@ static int tcp_post_send_generic(bmi_op_id_t *id,
                            &cur_index_complete, 
                            BMI_SEND, 
                            my_header.enc_hdr, 
-                           &env_amt_complete);
+                           &env_amt_complete,
+                           NULL);
     if (ret < 0)
     {
         PVFS_perror_gossip("Error: payload_progress", ret);
@@ -4447,6 +5776,74 @@ static int tcp_post_send_generic(bmi_op_id_t *id,
 }
 
 
+/* tcp_recv_payload()
+ *
+ * receives payload for an operation, first out of what is staged for
+ * its address and then from the socket
+ *
+ * returns amount completed on success, -errno on failure
+ */
+static int tcp_recv_payload(method_op_p op)
+{
+    struct tcp_addr *tcp_addr_data = op->addr->method_data;
+    bmi_size_t wanted = op->actual_size - op->amt_complete;
+    bmi_size_t copied = 0;
+    bmi_size_t len;
+    int ret;
+
+    while (tcp_addr_data->rx_off < tcp_addr_data->rx_len && copied < wanted)
+    {
+        len = op->size_list[op->list_index] - op->cur_index_complete;
+        if (len > tcp_addr_data->rx_len - tcp_addr_data->rx_off)
+        {
+            len = tcp_addr_data->rx_len - tcp_addr_data->rx_off;
+        }
+        if (len > wanted - copied)
+        {
+            len = wanted - copied;
+        }
+        memcpy((char *) op->buffer_list[op->list_index] +
+               op->cur_index_complete,
+               tcp_addr_data->rx_buf + tcp_addr_data->rx_off, len);
+        tcp_addr_data->rx_off += len;
+        copied += len;
+        op->cur_index_complete += len;
+        if (op->cur_index_complete == op->size_list[op->list_index])
+        {
+            op->list_index++;
+            op->cur_index_complete = 0;
+        }
+    }
+    if (tcp_addr_data->rx_off == tcp_addr_data->rx_len)
+    {
+        tcp_addr_data->rx_off = 0;
+        tcp_addr_data->rx_len = 0;
+    }
+
+    if (copied == wanted)
+    {
+        return (copied);
+    }
+
+    ret = payload_progress(tcp_addr_data->socket,
+                           op->buffer_list,
+                           op->size_list,
+                           op->list_count,
+                           op->actual_size,
+                           &(op->list_index),
+                           &(op->cur_index_complete),
+                           BMI_RECV,
+                           NULL,
+                           0,
+                           NULL);
+    if (ret < 0)
+    {
+        return (ret);
+    }
+    return (copied + ret);
+}
+
+
 /* payload_progress()
  *
  * makes progress on sending/recving data payload portion of a message
@@ -4462,7 +5859,8 @@ static int payload_progress(int s,
                             bmi_size_t *current_index_complete, 
                             enum bmi_op_type send_recv, 
                             char *enc_hdr, 
-                            bmi_size_t *env_amt_complete)
+                            bmi_size_t *env_amt_complete,
+                            uint32_t *zc_next)
 {
     int i;
     int count = 0;
@@ -4514,7 +5912,7 @@ static int payload_progress(int s,
     stat_io_vector[vector_index].iov_base = (char *) buffer_list[*list_index] +
                                             *current_index_complete;
     count++;
-    if (final_index == 0)
+    if (*list_index == final_index)
     {
 	stat_io_vector[vector_index].iov_len = final_size - 
                                                *current_index_complete;
@@ -4546,6 +5944,23 @@ static int payload_progress(int s,
     {
 	ret = BMI_sockio_nbvector(s, stat_io_vector, count, 1);
     }
+#ifdef BMI_TCP_ZEROCOPY
+    else if (zc_next)
+    {
+	/* the kernel numbers each zero-copy send that moves data; out of
+	 * option memory it refuses, and we copy this part instead
+	 */
+	ret = BMI_sockio_nbsendmsg(s, stat_io_vector, count, MSG_ZEROCOPY);
+	if (ret > 0)
+	{
+	    (*zc_next)++;
+	}
+	else if (ret < 0 && errno == ENOBUFS)
+	{
+	    ret = BMI_sockio_nbvector(s, stat_io_vector, count, 0);
+	}
+    }
+#endif
     else
     {
 	ret = BMI_sockio_nbvector(s, stat_io_vector, count, 0);
@@ -4624,6 +6039,340 @@ static void bmi_set_sock_buffers(int socket)
                  GET_RECVBUFSIZE(socket));
 }
 
+/* tcp_sock_modes()
+ *
+ * applies the tcp_busy_poll and tcp_zerocopy options to a new socket
+ */
+static void tcp_sock_modes(struct tcp_addr *tcp_addr_data)
+{
+    tcp_addr_data->zc_state = 0;
+    tcp_addr_data->zc_next = 0;
+    tcp_addr_data->zc_done = 0;
+
+#ifdef SO_BUSY_POLL
+    /* lets a blocking poll spin on the device queue first */
+    if (tcp_busy_poll &&
+        BMI_sockio_set_sockopt(tcp_addr_data->socket, SO_BUSY_POLL,
+                               tcp_busy_poll) < 0)
+    {
+        gossip_debug(GOSSIP_BMI_DEBUG_TCP, "Warning: SO_BUSY_POLL: %s\n",
+                     strerror(errno));
+    }
+#endif
+
+#ifdef BMI_TCP_ZEROCOPY
+    if (tcp_zerocopy)
+    {
+        if (BMI_sockio_set_sockopt(tcp_addr_data->socket, SO_ZEROCOPY,
+                                   1) < 0)
+        {
+            gossip_debug(GOSSIP_BMI_DEBUG_TCP, "Warning: SO_ZEROCOPY: %s\n",
+                         strerror(errno));
+            tcp_addr_data->zc_state = -1;
+        }
+        else
+        {
+            tcp_addr_data->zc_state = 1;
+        }
+    }
+#endif
+}
+
+/* tcp_zc_hold()
+ *
+ * parks a send whose bytes are all written but whose buffers the kernel
+ * may still be reading from, until tcp_zc_reap() hears they are free
+ *
+ * returns 1 if the op was parked, 0 if it can complete now
+ */
+static int tcp_zc_hold(method_op_p op)
+{
+    struct tcp_op *tcp_op_data = op->method_data;
+    struct tcp_addr *tcp_addr_data = op->addr->method_data;
+
+    if (!tcp_op_data->zc_used ||
+        (int32_t)(tcp_addr_data->zc_done - tcp_op_data->zc_seq) >= 0)
+    {
+        return (0);
+    }
+    tcp_op_data->tcp_op_state = BMI_TCP_INPROGRESS;
+    op_list_add(op_list_array[IND_SEND_ZEROCOPY], op);
+    return (1);
+}
+
+/* tcp_zc_reap()
+ *
+ * reads the zero-copy completion notices of an address and completes
+ * the parked sends that they release.  The notices raise an error on
+ * the socket when polled.
+ *
+ * returns the number of notices read, or -errno on failure
+ */
+static int tcp_zc_reap(bmi_method_addr_p map)
+{
+    struct tcp_addr *tcp_addr_data = map->method_data;
+    struct op_list_search_key key;
+    struct tcp_op *tcp_op_data;
+    method_op_p query_op;
+    int count;
+
+    count = tcp_zc_notices(tcp_addr_data->socket, &tcp_addr_data->zc_done,
+                           &tcp_addr_data->zc_state);
+    if (count < 0)
+    {
+        return (count);
+    }
+
+    /* sends to one address are released in the order they were made */
+    memset(&key, 0, sizeof(struct op_list_search_key));
+    key.method_addr = map;
+    key.method_addr_yes = 1;
+    while ((query_op = op_list_search(op_list_array[IND_SEND_ZEROCOPY],
+                                      &key)))
+    {
+        tcp_op_data = query_op->method_data;
+        if ((int32_t)(tcp_addr_data->zc_done - tcp_op_data->zc_seq) < 0)
+        {
+            break;
+        }
+        op_list_remove(query_op);
+        tcp_op_done(query_op);
+    }
+    return (count);
+}
+
+/* tcp_zc_notices()
+ *
+ * reads the zero-copy completion notices off the error queue of socket
+ * s, advancing *zc_done past the sends they release, and clears
+ * *zc_state if the kernel says it copied instead
+ *
+ * returns the number of notices read, or -errno on failure
+ */
+static int tcp_zc_notices(int s, uint32_t *zc_done, int *zc_state)
+{
+#ifdef BMI_TCP_ZEROCOPY
+    struct sock_extended_err *serr;
+    struct cmsghdr *cm;
+    struct msghdr msg;
+    char control[128];
+    int count = 0;
+    int ret;
+
+    for (;;)
+    {
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        ret = recvmsg(s, &msg, MSG_ERRQUEUE);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                break;
+            }
+            return (bmi_tcp_errno_to_pvfs(-errno));
+        }
+
+        for (cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm))
+        {
+            if (!(cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) &&
+                !(cm->cmsg_level == SOL_IPV6 &&
+                  cm->cmsg_type == IPV6_RECVERR))
+            {
+                continue;
+            }
+            serr = (struct sock_extended_err *) CMSG_DATA(cm);
+            if (serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY ||
+                serr->ee_errno != 0)
+            {
+                continue;
+            }
+            count++;
+
+            /* sends ee_info through ee_data are done */
+            if ((int32_t)(serr->ee_data + 1 - *zc_done) > 0)
+            {
+                *zc_done = serr->ee_data + 1;
+            }
+
+            /* the kernel had to copy after all (loopback, or a device
+             * without scatter-gather); stop paying for page pinning
+             */
+            if ((serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) &&
+                zc_state && *zc_state > 0)
+            {
+                gossip_debug(GOSSIP_BMI_DEBUG_TCP,
+                             "MSG_ZEROCOPY sends were copied; copying "
+                             "instead on socket %d.\n", s);
+                *zc_state = -1;
+            }
+        }
+    }
+    return (count);
+#else
+    return (0);
+#endif
+}
+
+/* tcp_zc_drain()
+ *
+ * called as the connection of map fails: sends on it that the kernel
+ * may still be reading from (parked ones, and ones partly written with
+ * MSG_ZEROCOPY) move to a tcp_zc_drain with the socket, marked with
+ * error_code, and the address lets go of the socket without closing
+ * it.  The sends complete from tcp_zc_drain_work() once the kernel
+ * releases their buffers.
+ */
+static void tcp_zc_drain(bmi_method_addr_p map, int error_code)
+{
+    static const int indices[] = {IND_SEND_ZEROCOPY, IND_SEND};
+    struct tcp_addr *tcp_addr_data = map->method_data;
+    struct op_list_search_key key;
+    struct tcp_zc_drain *drain = NULL;
+    struct tcp_op *tcp_op_data;
+    method_op_p query_op, next_op;
+    int i;
+#ifdef TCP_USER_TIMEOUT
+    unsigned int timeout = TCP_ZC_DRAIN_TIMEOUT_MSECS;
+#endif
+
+    if (tcp_addr_data->socket < 0)
+    {
+        return;
+    }
+
+    memset(&key, 0, sizeof(struct op_list_search_key));
+    key.method_addr = map;
+    key.method_addr_yes = 1;
+    for (i = 0; i < (int) (sizeof(indices) / sizeof(indices[0])); i++)
+    {
+        if (!op_list_array[indices[i]])
+        {
+            continue;
+        }
+        for (query_op = op_list_search(op_list_array[indices[i]], &key);
+             query_op; query_op = next_op)
+        {
+            next_op = op_list_search_next(op_list_array[indices[i]], &key,
+                                          query_op);
+            tcp_op_data = query_op->method_data;
+            if (!tcp_op_data->zc_used ||
+                (int32_t)(tcp_addr_data->zc_done - tcp_op_data->zc_seq) >= 0)
+            {
+                continue;
+            }
+            if (!drain)
+            {
+                drain = malloc(sizeof(*drain));
+                if (drain && !(drain->ops = op_list_new()))
+                {
+                    free(drain);
+                    drain = NULL;
+                }
+                if (!drain)
+                {
+                    /* the sends fail with the rest, their buffers at
+                     * risk as if zero-copy had not been asked for
+                     */
+                    gossip_err("Error: bmi_tcp: no memory to hold "
+                               "zero-copy sends on socket %d.\n",
+                               tcp_addr_data->socket);
+                    return;
+                }
+                drain->socket = tcp_addr_data->socket;
+                drain->zc_done = tcp_addr_data->zc_done;
+            }
+            op_list_remove(query_op);
+            query_op->error_code = error_code;
+            tcp_op_data->zc_draining = 1;
+            op_list_add(drain->ops, query_op);
+        }
+    }
+    if (!drain)
+    {
+        return;
+    }
+
+    /* stop all traffic but keep the error queue */
+    shutdown(drain->socket, SHUT_RDWR);
+#ifdef TCP_USER_TIMEOUT
+    setsockopt(drain->socket, IPPROTO_TCP, TCP_USER_TIMEOUT,
+               &timeout, sizeof(timeout));
+#endif
+    qlist_add_tail(&drain->link, &tcp_zc_drains);
+
+    gossip_debug(GOSSIP_BMI_DEBUG_TCP,
+                 "Holding socket %d until its zero-copy sends are "
+                 "released.\n", drain->socket);
+    tcp_addr_data->socket = -1;
+}
+
+/* tcp_zc_drain_work()
+ *
+ * completes the sends of failed connections that the kernel has since
+ * released, and closes each socket once none are left
+ */
+static void tcp_zc_drain_work(void)
+{
+    struct tcp_zc_drain *drain, *tmp;
+    struct tcp_op *tcp_op_data;
+    method_op_p query_op;
+    op_list_p iterator, scratch;
+    int ret;
+
+    qlist_for_each_entry_safe(drain, tmp, &tcp_zc_drains, link)
+    {
+        ret = tcp_zc_notices(drain->socket, &drain->zc_done, NULL);
+        qlist_for_each_safe(iterator, scratch, drain->ops)
+        {
+            query_op = qlist_entry(iterator, struct method_op,
+                                   op_list_entry);
+            tcp_op_data = query_op->method_data;
+            /* if the error queue itself fails, nothing more will come
+             * from it; give up the sends rather than hold them forever
+             */
+            if (ret >= 0 &&
+                (int32_t)(drain->zc_done - tcp_op_data->zc_seq) < 0)
+            {
+                continue;
+            }
+            op_list_remove(query_op);
+            tcp_op_data->zc_draining = 0;
+            tcp_op_done(query_op);
+        }
+        if (op_list_empty(drain->ops))
+        {
+            qlist_del(&drain->link);
+            close(drain->socket);
+            op_list_cleanup(drain->ops);
+            free(drain);
+        }
+    }
+}
+
+/* tcp_zc_drain_cleanup()
+ *
+ * at finalize, closes the sockets still held for zero-copy sends; the
+ * sends go with the rest of the operations
+ */
+static void tcp_zc_drain_cleanup(void)
+{
+    struct tcp_zc_drain *drain, *tmp;
+
+    qlist_for_each_entry_safe(drain, tmp, &tcp_zc_drains, link)
+    {
+        qlist_del(&drain->link);
+        close(drain->socket);
+        op_list_cleanup(drain->ops);
+        free(drain);
+    }
+}
+
 /*
  * Local variables:
  *  c-indent-level: 4
@@ -97,22 +97,25 @@ do { \
     } \
 } while(0)
 
-/* we _must_ have a valid socket at this point if we want to write data */
+/* we _must_ have a valid socket at this point if we want to write data;
+ * the write bit is already set if other sends hold references to it
+ */
 #define BMI_socket_collection_add_write_bit(s, m) \
 do { \
-    int rc; \
     struct tcp_addr* tcp_data = (m)->method_data; \
     struct epoll_event event;\
     assert(tcp_data->socket > -1); \
-    tcp_data->write_ref_count++; \
-    memset(&event, 0, sizeof(event));\
-    event.events = EPOLLIN|EPOLLERR|EPOLLHUP|EPOLLOUT;\
-    event.data.ptr = tcp_data->map;\
-    rc = epoll_ctl(s->epfd, EPOLL_CTL_MOD, tcp_data->socket, &event);\
-    if (rc == -1) \
-    { \
-        gossip_err("BMI_socket_collection_add_write_bit returns error\n"); \
-    } \
+    if (tcp_data->write_ref_count++ == 0) { \
+        int rc; \
+        memset(&event, 0, sizeof(event));\
+        event.events = EPOLLIN|EPOLLERR|EPOLLHUP|EPOLLOUT;\
+        event.data.ptr = tcp_data->map;\
+        rc = epoll_ctl(s->epfd, EPOLL_CTL_MOD, tcp_data->socket, &event);\
+        if (rc == -1) \
+        { \
+            gossip_err("BMI_socket_collection_add_write_bit returns error\n"); \
+        } \
+    }\
 } while(0)
 
 #define BMI_socket_collection_remove_write_bit(s, m) \
@@ -134,6 +137,26 @@ do { \
     }\
 } while(0)
 
+/* drops the write references of several finished sends at once */
+#define BMI_socket_collection_remove_write_bits(s, m, n) \
+do { \
+    struct tcp_addr* tcp_data = (m)->method_data; \
+    struct epoll_event event;\
+    tcp_data->write_ref_count -= (n); \
+    assert(tcp_data->write_ref_count > -1); \
+    if (tcp_data->write_ref_count == 0) { \
+        int rc; \
+        memset(&event, 0, sizeof(event));\
+        event.events = EPOLLIN|EPOLLERR|EPOLLHUP;\
+        event.data.ptr = tcp_data->map;\
+        rc = epoll_ctl(s->epfd, EPOLL_CTL_MOD, tcp_data->socket, &event);\
+        if (rc == -1) \
+        { \
+            gossip_err("BMI_socket_collection_remove_write_bits returns error\n"); \
+        } \
+    }\
+} while(0)
+
 void BMI_socket_collection_finalize(socket_collection_p scp);
 int BMI_socket_collection_testglobal(socket_collection_p scp,
 				 int incount,
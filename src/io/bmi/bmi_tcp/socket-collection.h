@@ -101,6 +101,19 @@ do { \
     write(s->pipe_fd[1], &c, 1);\
 } while(0)
 
+/* drops the write references of several finished sends at once */
+#define BMI_socket_collection_remove_write_bits(s, m, n) \
+do { \
+    char c;\
+    struct tcp_addr* tcp_data = (m)->method_data; \
+    gen_mutex_lock(&((s)->queue_mutex)); \
+    tcp_data->write_ref_count -= (n); \
+    assert(tcp_data->write_ref_count > -1); \
+    BMI_socket_collection_queue((s),(m), &((s)->add_queue)); \
+    gen_mutex_unlock(&((s)->queue_mutex)); \
+    write(s->pipe_fd[1], &c, 1);\
+} while(0)
+
 void BMI_socket_collection_finalize(socket_collection_p scp);
 int BMI_socket_collection_testglobal(socket_collection_p scp,
 				 int incount,
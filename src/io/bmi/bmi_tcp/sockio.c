@@ -215,6 +215,35 @@ int BMI_sockio_nbrecv(int s,
     return (len - comp);
 }
 
+/* nonblocking receive of whatever is ready, up to len bytes; gives up
+ * after one call like BMI_sockio_nbvector(), so that bytes already read
+ * are not lost to a close that follows them
+ */
+int BMI_sockio_nbrecv_once(int s,
+	   void *buf,
+	   int len)
+{
+    int ret;
+
+    assert(fcntl(s, F_GETFL, 0) & O_NONBLOCK);
+
+    do
+    {
+	ret = recv(s, buf, len, DEFAULT_MSG_FLAGS);
+    }while(ret == -1 && errno == EINTR);
+
+    if (ret == 0) /* socket closed */
+    {
+	errno = EPIPE;
+	return (-1);
+    }
+    if (ret == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+	return (0);
+    }
+    return (ret);
+}
+
 /* BMI_sockio_nbpeek()
  *
  * performs a nonblocking check to see if the amount of data requested
@@ -312,6 +341,32 @@ int BMI_sockio_nbvector(int s,
     return(ret);
 }
 
+/* nonblocking vector send with extra sendmsg() flags, such as
+ * MSG_ZEROCOPY; gives up after one call like BMI_sockio_nbvector()
+ */
+int BMI_sockio_nbsendmsg(int s,
+	    struct iovec* vector,
+	    int count,
+	    int flags)
+{
+    struct msghdr msg;
+    int ret;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = vector;
+    msg.msg_iovlen = count;
+
+    do
+    {
+	ret = sendmsg(s, &msg, flags | DEFAULT_MSG_FLAGS);
+    }while(ret == -1 && errno == EINTR);
+
+    if(ret == -1 && errno == EWOULDBLOCK)
+	return(0);
+
+    return(ret);
+}
+
 #ifdef __USE_SENDFILE__
 /* NBSENDFILE() - nonblocking (on the socket) send from file
  *
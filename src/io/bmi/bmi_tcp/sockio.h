@@ -44,6 +44,9 @@ int BMI_sockio_init_sock(struct sockaddr *,
 int BMI_sockio_nbrecv(int s,
 		      void *buf,
 		      int len);
+int BMI_sockio_nbrecv_once(int s,
+			   void *buf,
+			   int len);
 int BMI_sockio_nbsend(int s,
 		      void *buf,
 		      int len);
@@ -51,6 +54,10 @@ int BMI_sockio_nbvector(int s,
 			struct iovec* vector,
 			int count,
 			int recv_flag);
+int BMI_sockio_nbsendmsg(int s,
+			 struct iovec* vector,
+			 int count,
+			 int flags);
 int BMI_sockio_get_sockopt(int s,
 			   int optname);
 int BMI_sockio_set_tcpopt(int s,
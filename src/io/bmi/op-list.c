@@ -18,6 +18,7 @@
  */
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <errno.h>
 
 #include "bmi-method-support.h"
@@ -26,6 +27,19 @@
 #include "gossip.h"
 
 
+/* the op_list_p handed out points at ops; by_addr and by_addr_tag are
+ * NULL unless the list is indexed
+ */
+struct op_list
+{
+    struct qlist_head ops;
+    struct qlist_head *by_addr;		/* ops linked by addr_link */
+    struct qlist_head *by_addr_tag;	/* ops linked by hash_link */
+};
+
+#define OP_LIST_INDEX_BITS 10
+#define OP_LIST_INDEX_BUCKETS (1 << OP_LIST_INDEX_BITS)
+
 /***************************************************************
  * Function prototypes
  */
@@ -33,6 +47,8 @@
 static void gossip_print_op(method_op_p print_op);
 static int op_list_cmp_key(struct op_list_search_key *my_key,
 			   method_op_p my_op);
+static unsigned int op_list_hash(bmi_method_addr_p addr,
+				 bmi_msg_tag_t tag);
 
 /***************************************************************
  * Visible functions
@@ -86,15 +102,52 @@ int op_list_count(op_list_p olp)
  */
 op_list_p op_list_new(void)
 {
-    struct qlist_head *tmp_op_list = NULL;
+    struct op_list *tmp_op_list = NULL;
 
-    tmp_op_list = (struct qlist_head *) malloc(sizeof(struct qlist_head));
-    if (tmp_op_list)
+    tmp_op_list = (struct op_list *) malloc(sizeof(struct op_list));
+    if (!tmp_op_list)
     {
-	INIT_QLIST_HEAD(tmp_op_list);
+	return (NULL);
     }
+    INIT_QLIST_HEAD(&tmp_op_list->ops);
+    tmp_op_list->by_addr = NULL;
+    tmp_op_list->by_addr_tag = NULL;
 
-    return (tmp_op_list);
+    return (&tmp_op_list->ops);
+}
+
+/*
+ * op_list_new_indexed()
+ *
+ * creates a new operation list that is indexed by address and by
+ * address and tag for op_list_search().
+ *
+ * returns pointer to an empty list or NULL on failure.
+ */
+op_list_p op_list_new_indexed(void)
+{
+    struct op_list *tmp_op_list = NULL;
+    int i;
+
+    tmp_op_list = (struct op_list *) op_list_new();
+    if (!tmp_op_list)
+    {
+	return (NULL);
+    }
+    tmp_op_list->by_addr = (struct qlist_head *)
+	malloc(2 * OP_LIST_INDEX_BUCKETS * sizeof(struct qlist_head));
+    if (!tmp_op_list->by_addr)
+    {
+	free(tmp_op_list);
+	return (NULL);
+    }
+    tmp_op_list->by_addr_tag = tmp_op_list->by_addr + OP_LIST_INDEX_BUCKETS;
+    for (i = 0; i < 2 * OP_LIST_INDEX_BUCKETS; i++)
+    {
+	INIT_QLIST_HEAD(&tmp_op_list->by_addr[i]);
+    }
+
+    return (&tmp_op_list->ops);
 }
 
 /*
@@ -111,7 +164,17 @@ void op_list_add(op_list_p olp,
      * most modules will want to preserve FIFO ordering when searching
      * through op_lists for work to do.
      */
+    struct op_list *list = (struct op_list *) olp;
+
     qlist_add_tail(&(oip->op_list_entry), olp);
+    if (list->by_addr)
+    {
+	qlist_add_tail(&(oip->addr_link),
+		       &list->by_addr[op_list_hash(oip->addr, 0)]);
+	qlist_add_tail(&(oip->hash_link),
+		       &list->by_addr_tag[op_list_hash(oip->addr,
+						       oip->msg_tag)]);
+    }
 }
 
 /*
@@ -133,6 +196,7 @@ void op_list_cleanup(op_list_p olp)
 				    op_list_entry);
 	bmi_dealloc_method_op(tmp_method_op);
     }
+    free(((struct op_list *) olp)->by_addr);
     free(olp);
     olp = NULL;
 }
@@ -160,6 +224,13 @@ int op_list_empty(op_list_p olp)
 void op_list_remove(method_op_p oip)
 {
     qlist_del(&(oip->op_list_entry));
+    if (oip->addr_link.next)
+    {
+	/* it was on an indexed list */
+	qlist_del(&(oip->addr_link));
+	qlist_del(&(oip->hash_link));
+	oip->addr_link.next = NULL;
+    }
 }
 
 
@@ -173,7 +244,44 @@ void op_list_remove(method_op_p oip)
 method_op_p op_list_search(op_list_p olp,
 			   struct op_list_search_key *key)
 {
+    struct op_list *list = (struct op_list *) olp;
     op_list_p tmp_entry = NULL;
+    op_list_p bucket = NULL;
+    method_op_p tmp_op = NULL;
+
+    if (list->by_addr && key->method_addr_yes)
+    {
+	/* the bucket holds the same ops in the same order as the list,
+	 * along with some that merely hash alike
+	 */
+	if (key->msg_tag_yes)
+	{
+	    bucket = &list->by_addr_tag[op_list_hash(key->method_addr,
+						     key->msg_tag)];
+	    qlist_for_each(tmp_entry, bucket)
+	    {
+		tmp_op = qlist_entry(tmp_entry, struct method_op, hash_link);
+		if (!op_list_cmp_key(key, tmp_op))
+		{
+		    return (tmp_op);
+		}
+	    }
+	}
+	else
+	{
+	    bucket = &list->by_addr[op_list_hash(key->method_addr, 0)];
+	    qlist_for_each(tmp_entry, bucket)
+	    {
+		tmp_op = qlist_entry(tmp_entry, struct method_op, addr_link);
+		if (!op_list_cmp_key(key, tmp_op))
+		{
+		    return (tmp_op);
+		}
+	    }
+	}
+	return (NULL);
+    }
+
     qlist_for_each(tmp_entry, olp)
     {
 	if (!(op_list_cmp_key(key, qlist_entry(tmp_entry, struct method_op,
@@ -186,6 +294,67 @@ method_op_p op_list_search(op_list_p olp,
 }
 
 
+/* op_list_search_next()
+ *
+ * continues an op_list_search() from an earlier match, returning the
+ * next operation that matches the same key, in list order
+ *
+ * returns pointer to operation on success, NULL on failure.
+ */
+method_op_p op_list_search_next(op_list_p olp,
+				struct op_list_search_key *key,
+				method_op_p prev)
+{
+    struct op_list *list = (struct op_list *) olp;
+    op_list_p tmp_entry = NULL;
+    op_list_p bucket = NULL;
+    method_op_p tmp_op = NULL;
+
+    if (list->by_addr && key->method_addr_yes)
+    {
+	if (key->msg_tag_yes)
+	{
+	    bucket = &list->by_addr_tag[op_list_hash(key->method_addr,
+						     key->msg_tag)];
+	    for (tmp_entry = prev->hash_link.next; tmp_entry != bucket;
+		 tmp_entry = tmp_entry->next)
+	    {
+		tmp_op = qlist_entry(tmp_entry, struct method_op, hash_link);
+		if (!op_list_cmp_key(key, tmp_op))
+		{
+		    return (tmp_op);
+		}
+	    }
+	}
+	else
+	{
+	    bucket = &list->by_addr[op_list_hash(key->method_addr, 0)];
+	    for (tmp_entry = prev->addr_link.next; tmp_entry != bucket;
+		 tmp_entry = tmp_entry->next)
+	    {
+		tmp_op = qlist_entry(tmp_entry, struct method_op, addr_link);
+		if (!op_list_cmp_key(key, tmp_op))
+		{
+		    return (tmp_op);
+		}
+	    }
+	}
+	return (NULL);
+    }
+
+    for (tmp_entry = prev->op_list_entry.next; tmp_entry != olp;
+	 tmp_entry = tmp_entry->next)
+    {
+	tmp_op = qlist_entry(tmp_entry, struct method_op, op_list_entry);
+	if (!op_list_cmp_key(key, tmp_op))
+	{
+	    return (tmp_op);
+	}
+    }
+    return (NULL);
+}
+
+
 /* op_list_shownext()
  *
  * shows the next entry in an op list; does not remove the entry
@@ -233,6 +402,26 @@ static int op_list_cmp_key(struct op_list_search_key *my_key,
 }
 
 
+/*
+ * op_list_hash()
+ *
+ * picks the index bucket for an address and tag; lists indexed by
+ * address alone pass a tag of 0.
+ *
+ * returns bucket number
+ */
+static unsigned int op_list_hash(bmi_method_addr_p addr,
+				 bmi_msg_tag_t tag)
+{
+    uint32_t h;
+
+    /* addresses are at least 16 byte aligned */
+    h = (uint32_t) ((uintptr_t) addr >> 4) ^ ((uint32_t) tag * 0x9e3779b1u);
+    h *= 0x9e3779b1u;
+    return (h >> (32 - OP_LIST_INDEX_BITS));
+}
+
+
 static void gossip_print_op(method_op_p print_op)
 {
 
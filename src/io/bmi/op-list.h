@@ -35,8 +35,15 @@ struct op_list_search_key
     int op_id_yes;
 };
 
+/* An indexed op list also hashes its ops by address and by address and
+ * tag, so that op_list_search() with method_addr_yes only looks at ops
+ * that hash alike instead of walking the whole list.  Ops with equal
+ * keys stay in the order they were added, so the first match is the
+ * same one a walk would find.
+ */
 int op_list_count(op_list_p olp);
 op_list_p op_list_new(void);
+op_list_p op_list_new_indexed(void);
 void op_list_add(op_list_p olp,
 		 method_op_p oip);
 void op_list_cleanup(op_list_p olp);
@@ -46,6 +53,9 @@ int op_list_empty(op_list_p olp);
 method_op_p op_list_shownext(op_list_p olp);
 method_op_p op_list_search(op_list_p olp,
 			   struct op_list_search_key *key);
+method_op_p op_list_search_next(op_list_p olp,
+				struct op_list_search_key *key,
+				method_op_p prev);
 
 #endif /* __OP_LIST_H */
 
@@ -0,0 +1,464 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* progressive stripe: the start of a file lives on a few datafiles with
+ * small strips, and each later region widens to more datafiles with
+ * larger strips, until the file is striped over all of its datafiles
+ * at max_strip_size.  Small files then touch one or two servers while
+ * large files still get the full width.  Within a region data is
+ * striped round robin as in simple_stripe, over datafiles 0 to width-1.
+ *
+ * The regions follow from the parameters and the datafile count alone,
+ * so every mapping walks them from the start of the file; there are
+ * only a handful before the last one.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#define __PINT_REQPROTO_ENCODE_FUNCS_C
+#include "pint-distribution.h"
+#include "pint-dist-utils.h"
+#include "pvfs2-types.h"
+#include "pvfs2-dist-progressive.h"
+#include "pvfs2-util.h"
+#include "gossip.h"
+#include "pvfs2-internal.h"
+
+/* one region of the file as seen from one datafile */
+struct progressive_region
+{
+    PVFS_offset logical_start;  /* first logical offset of the region */
+    PVFS_offset physical_start; /* where the region starts in the datafile */
+    PVFS_size strip_size;
+    PVFS_size length;           /* logical length, 0 for the last region */
+    uint32_t width;             /* datafiles the region is striped over */
+};
+
+/* copies the parameters, replacing any that could not lay out a file */
+static void get_params(void *params, PVFS_progressive_params *p)
+{
+    *p = *(PVFS_progressive_params *)params;
+
+    if(p->strip_size <= 0)
+    {
+        p->strip_size = PVFS_DIST_PROGRESSIVE_DEFAULT_STRIP_SIZE;
+    }
+    if(p->max_strip_size < p->strip_size)
+    {
+        p->max_strip_size = p->strip_size;
+    }
+    if(p->initial_servers < 1)
+    {
+        p->initial_servers = 1;
+    }
+    if(p->growth_factor < 2)
+    {
+        p->growth_factor = 2;
+    }
+    if(p->region_stripes < 1)
+    {
+        p->region_stripes = 1;
+    }
+}
+
+static void region_set_length(const PVFS_progressive_params *p,
+                              uint32_t server_ct,
+                              struct progressive_region *r)
+{
+    if(r->width >= server_ct && r->strip_size >= p->max_strip_size)
+    {
+        /* the layout stops growing here */
+        r->length = 0;
+    }
+    else
+    {
+        r->length = r->strip_size * r->width * p->region_stripes;
+    }
+}
+
+static void region_first(const PVFS_progressive_params *p,
+                         uint32_t server_ct,
+                         struct progressive_region *r)
+{
+    r->logical_start = 0;
+    r->physical_start = 0;
+    r->strip_size = p->strip_size;
+    r->width = p->initial_servers < server_ct ?
+               p->initial_servers : server_ct;
+    region_set_length(p, server_ct, r);
+}
+
+/* moves r to the region after it; server_nr decides whether the old
+ * region took up space in the datafile
+ */
+static void region_next(const PVFS_progressive_params *p,
+                        uint32_t server_ct,
+                        uint32_t server_nr,
+                        struct progressive_region *r)
+{
+    uint64_t width;
+
+    if(server_nr < r->width)
+    {
+        r->physical_start += r->strip_size * p->region_stripes;
+    }
+    r->logical_start += r->length;
+
+    width = (uint64_t)r->width * p->growth_factor;
+    r->width = width < server_ct ? (uint32_t)width : server_ct;
+    if(r->strip_size < p->max_strip_size / p->growth_factor)
+    {
+        r->strip_size *= p->growth_factor;
+    }
+    else
+    {
+        r->strip_size = p->max_strip_size;
+    }
+    region_set_length(p, server_ct, r);
+}
+
+/* finds the region holding logical_offset */
+static void find_logical_region(const PVFS_progressive_params *p,
+                                PINT_request_file_data *fd,
+                                PVFS_offset logical_offset,
+                                struct progressive_region *r)
+{
+    uint32_t server_ct = fd->server_ct ? fd->server_ct : 1;
+
+    region_first(p, server_ct, r);
+    while(r->length && logical_offset >= r->logical_start + r->length)
+    {
+        region_next(p, server_ct, fd->server_nr, r);
+    }
+}
+
+/* finds the region holding physical_offset of this datafile */
+static void find_physical_region(const PVFS_progressive_params *p,
+                                 PINT_request_file_data *fd,
+                                 PVFS_offset physical_offset,
+                                 struct progressive_region *r)
+{
+    uint32_t server_ct = fd->server_ct ? fd->server_ct : 1;
+
+    region_first(p, server_ct, r);
+    while(r->length &&
+          (fd->server_nr >= r->width ||
+           physical_offset >= r->physical_start +
+                              r->strip_size * p->region_stripes))
+    {
+        region_next(p, server_ct, fd->server_nr, r);
+    }
+}
+
+static PVFS_offset logical_to_physical_offset(void* params,
+                                              PINT_request_file_data* fd,
+                                              PVFS_offset logical_offset)
+{
+    PVFS_progressive_params p;
+    struct progressive_region r;
+    PVFS_size stripe_size, full_stripes;
+    PVFS_offset local, leftover;
+    PVFS_offset ret_offset;
+    uint32_t server_nr = fd->server_nr;
+
+    get_params(params, &p);
+    find_logical_region(&p, fd, logical_offset, &r);
+
+    /* a datafile outside the region holds nothing in it, so the next
+     * byte it holds is where its next region starts
+     */
+    ret_offset = r.physical_start;
+    if(server_nr >= r.width)
+    {
+        return ret_offset;
+    }
+
+    /* the same as simple stripe, within the region */
+    local = logical_offset - r.logical_start;
+    stripe_size = r.strip_size * r.width;
+    full_stripes = local / stripe_size;
+    ret_offset += full_stripes * r.strip_size;
+
+    leftover = local - full_stripes * stripe_size;
+    if(leftover >= server_nr * r.strip_size)
+    {
+        if(leftover < (server_nr + 1) * r.strip_size)
+        {
+            ret_offset += leftover - server_nr * r.strip_size;
+        }
+        else
+        {
+            ret_offset += r.strip_size;
+        }
+    }
+    return ret_offset;
+}
+
+static PVFS_offset physical_to_logical_offset(void* params,
+                                              PINT_request_file_data* fd,
+                                              PVFS_offset physical_offset)
+{
+    PVFS_progressive_params p;
+    struct progressive_region r;
+    PVFS_offset local;
+
+    get_params(params, &p);
+    find_physical_region(&p, fd, physical_offset, &r);
+
+    local = physical_offset - r.physical_start;
+    return r.logical_start +
+           (local / r.strip_size) * r.strip_size * r.width +
+           fd->server_nr * r.strip_size +
+           local % r.strip_size;
+}
+
+static PVFS_offset next_mapped_offset(void* params,
+                                      PINT_request_file_data* fd,
+                                      PVFS_offset logical_offset)
+{
+    /* the first byte at or after logical_offset held by this datafile */
+    return physical_to_logical_offset(
+        params, fd, logical_to_physical_offset(params, fd, logical_offset));
+}
+
+static PVFS_size contiguous_length(void* params,
+                                   PINT_request_file_data* fd,
+                                   PVFS_offset physical_offset)
+{
+    PVFS_progressive_params p;
+    struct progressive_region r;
+    PVFS_offset local;
+
+    get_params(params, &p);
+    find_physical_region(&p, fd, physical_offset, &r);
+
+    local = physical_offset - r.physical_start;
+    if(r.width == 1 && r.length)
+    {
+        /* a region on one datafile is contiguous to its end */
+        return r.length - local;
+    }
+    return r.strip_size - (local % r.strip_size);
+}
+
+static PVFS_size logical_file_size(void* params,
+                                   uint32_t server_ct,
+                                   PVFS_size *psizes)
+{
+    /* take the max of the max offset on each server */
+    PVFS_size max = 0;
+    PVFS_size tmp_max = 0;
+    PINT_request_file_data file_data;
+    int s = 0;
+
+    if(!psizes)
+    {
+        return -1;
+    }
+
+    memset(&file_data, 0, sizeof(file_data));
+    file_data.server_ct = server_ct;
+
+    for(s = 0; s < server_ct; s++)
+    {
+        file_data.server_nr = s;
+        if(psizes[s])
+        {
+            tmp_max = physical_to_logical_offset(params, &file_data,
+                                                 psizes[s] - 1) + 1;
+            if(tmp_max > max)
+            {
+                max = tmp_max;
+            }
+        }
+    }
+
+    gossip_debug(GOSSIP_DIST_DEBUG,
+                 "%s: server_ct: %u log_size: %llu\n",
+                 __func__, server_ct, llu(max));
+    return max;
+}
+
+static int set_param(const char* dist_name, void* params,
+                     const char* param_name, void* value)
+{
+    PVFS_progressive_params* dparam = (PVFS_progressive_params*)params;
+    int64_t val = *(int64_t*)value;
+
+    if(strcmp(param_name, "strip_size") == 0)
+    {
+        if(val <= 0)
+        {
+            gossip_err("ERROR: strip_size param <= 0!\n");
+            return -PVFS_EINVAL;
+        }
+        dparam->strip_size = val;
+    }
+    else if(strcmp(param_name, "max_strip_size") == 0)
+    {
+        if(val <= 0)
+        {
+            gossip_err("ERROR: max_strip_size param <= 0!\n");
+            return -PVFS_EINVAL;
+        }
+        dparam->max_strip_size = val;
+    }
+    else if(strcmp(param_name, "initial_servers") == 0)
+    {
+        if(val <= 0 || val > UINT32_MAX)
+        {
+            gossip_err("ERROR: initial_servers param out of range!\n");
+            return -PVFS_EINVAL;
+        }
+        dparam->initial_servers = (uint32_t)val;
+    }
+    else if(strcmp(param_name, "growth_factor") == 0)
+    {
+        if(val < 2 || val > UINT32_MAX)
+        {
+            gossip_err("ERROR: growth_factor param < 2!\n");
+            return -PVFS_EINVAL;
+        }
+        dparam->growth_factor = (uint32_t)val;
+    }
+    else if(strcmp(param_name, "region_stripes") == 0)
+    {
+        if(val <= 0 || val > UINT32_MAX)
+        {
+            gossip_err("ERROR: region_stripes param out of range!\n");
+            return -PVFS_EINVAL;
+        }
+        dparam->region_stripes = (uint32_t)val;
+    }
+    else
+    {
+        return -PVFS_EINVAL;
+    }
+
+    gossip_debug(GOSSIP_DIST_DEBUG, "%s: %s: %lld\n",
+                 __func__, param_name, lld(val));
+    return 0;
+}
+
+static void encode_params(char **pptr, void* params)
+{
+    PVFS_progressive_params* dparam = (PVFS_progressive_params*)params;
+    encode_PVFS_size(pptr, &dparam->strip_size);
+    encode_PVFS_size(pptr, &dparam->max_strip_size);
+    encode_uint32_t(pptr, &dparam->initial_servers);
+    encode_uint32_t(pptr, &dparam->growth_factor);
+    encode_uint32_t(pptr, &dparam->region_stripes);
+}
+
+static void decode_params(char **pptr, void* params)
+{
+    PVFS_progressive_params* dparam = (PVFS_progressive_params*)params;
+    decode_PVFS_size(pptr, &dparam->strip_size);
+    decode_PVFS_size(pptr, &dparam->max_strip_size);
+    decode_uint32_t(pptr, &dparam->initial_servers);
+    decode_uint32_t(pptr, &dparam->growth_factor);
+    decode_uint32_t(pptr, &dparam->region_stripes);
+}
+
+static void registration_init(void* params)
+{
+    PINT_dist_register_param(PVFS_DIST_PROGRESSIVE_NAME, "strip_size",
+                             PVFS_progressive_params, strip_size);
+    PINT_dist_register_param(PVFS_DIST_PROGRESSIVE_NAME, "max_strip_size",
+                             PVFS_progressive_params, max_strip_size);
+    PINT_dist_register_param(PVFS_DIST_PROGRESSIVE_NAME, "initial_servers",
+                             PVFS_progressive_params, initial_servers);
+    PINT_dist_register_param(PVFS_DIST_PROGRESSIVE_NAME, "growth_factor",
+                             PVFS_progressive_params, growth_factor);
+    PINT_dist_register_param(PVFS_DIST_PROGRESSIVE_NAME, "region_stripes",
+                             PVFS_progressive_params, region_stripes);
+}
+
+static void unregister(void)
+{
+    PINT_dist_unregister_param(PVFS_DIST_PROGRESSIVE_NAME, "strip_size");
+    PINT_dist_unregister_param(PVFS_DIST_PROGRESSIVE_NAME, "max_strip_size");
+    PINT_dist_unregister_param(PVFS_DIST_PROGRESSIVE_NAME, "initial_servers");
+    PINT_dist_unregister_param(PVFS_DIST_PROGRESSIVE_NAME, "growth_factor");
+    PINT_dist_unregister_param(PVFS_DIST_PROGRESSIVE_NAME, "region_stripes");
+}
+
+static char *params_string(void *params)
+{
+    char param_string[1024];
+    PVFS_progressive_params* dparam = (PVFS_progressive_params*)params;
+
+    sprintf(param_string, "strip_size:%llu,max_strip_size:%llu,"
+            "initial_servers:%u,growth_factor:%u,region_stripes:%u\n",
+            llu(dparam->strip_size), llu(dparam->max_strip_size),
+            dparam->initial_servers, dparam->growth_factor,
+            dparam->region_stripes);
+    return strdup(param_string);
+}
+
+static PVFS_size get_blksize(void* params, int dfile_count)
+{
+    PVFS_progressive_params* dparam = (PVFS_progressive_params*)params;
+    /* report the first strip size as the block size, as simple_stripe
+     * does; small files never see the larger ones
+     */
+    return(dparam->strip_size * dfile_count);
+}
+
+/* default progressive_params */
+static PVFS_progressive_params progressive_params = {
+    PVFS_DIST_PROGRESSIVE_DEFAULT_STRIP_SIZE,
+    PVFS_DIST_PROGRESSIVE_DEFAULT_MAX_STRIP_SIZE,
+    PVFS_DIST_PROGRESSIVE_DEFAULT_INITIAL_SERVERS,
+    PVFS_DIST_PROGRESSIVE_DEFAULT_GROWTH_FACTOR,
+    PVFS_DIST_PROGRESSIVE_DEFAULT_REGION_STRIPES
+};
+
+static PINT_dist_methods progressive_methods = {
+    logical_to_physical_offset,
+    physical_to_logical_offset,
+    next_mapped_offset,
+    contiguous_length,
+    logical_file_size,
+    PINT_dist_default_get_num_dfiles,
+    set_param,
+    get_blksize,
+    encode_params,
+    decode_params,
+    registration_init,
+    unregister,
+    params_string
+};
+
+#ifdef WIN32
+PINT_dist progressive_dist = {
+    PVFS_DIST_PROGRESSIVE_NAME,
+    roundup8(PVFS_DIST_PROGRESSIVE_NAME_SIZE), /* name size */
+    roundup8(sizeof(PVFS_progressive_params)), /* param size */
+    &progressive_params,
+    &progressive_methods
+};
+#else
+PINT_dist progressive_dist = {
+    .dist_name = PVFS_DIST_PROGRESSIVE_NAME,
+    .name_size = roundup8(PVFS_DIST_PROGRESSIVE_NAME_SIZE), /* name size */
+    .param_size = roundup8(sizeof(PVFS_progressive_params)), /* param size */
+    .params = &progressive_params,
+    .methods = &progressive_methods
+};
+#endif
+
+/*
+ * Local variables:
+ *  mode: c
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ft=c ts=8 sts=4 sw=4 expandtab
+ */
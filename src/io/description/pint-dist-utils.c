@@ -10,6 +10,7 @@
 #include "pvfs2-dist-simple-stripe.h"
 #include "pvfs2-dist-varstrip.h"
 #include "pvfs2-dist-twod-stripe.h"
+#include "pvfs2-dist-progressive.h"
 #include "pint-dist-utils.h"
 #include "pvfs2-internal.h"
 
@@ -18,6 +19,7 @@ extern PINT_dist basic_dist;
 extern PINT_dist simple_stripe_dist;
 extern PINT_dist varstrip_dist;
 extern PINT_dist twod_stripe_dist;
+extern PINT_dist progressive_dist;
 
 /* Struct for determining how to set a distribution parameter by name */
 typedef struct PINT_dist_param_offset_s
@@ -74,6 +76,9 @@ int PINT_dist_initialize(server_configuration_s* server_config)
     /* Register the twod stripe distribution */
     PINT_register_distribution(&twod_stripe_dist);
 
+    /* Register the progressive stripe distribution */
+    PINT_register_distribution(&progressive_dist);
+
     /* add an associated unregister to any new distributions */
     return ret;
 }
@@ -85,6 +90,7 @@ void PINT_dist_finalize(void)
     PINT_unregister_distribution(varstrip_dist.dist_name);
     PINT_unregister_distribution(simple_stripe_dist.dist_name);
     PINT_unregister_distribution(twod_stripe_dist.dist_name);
+    PINT_unregister_distribution(progressive_dist.dist_name);
 
     free(PINT_dist_param_table);
     PINT_dist_param_table = 0;
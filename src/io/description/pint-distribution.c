@@ -219,6 +219,27 @@ void PINT_dist_decode(PINT_dist **dist, void *buffer)
     decode_PINT_dist(&tmpbuf, dist);
 }
 
+/* first logical offset that does not map to the first datafile; a stuffed
+ * file can hold this many bytes before it has to be unstuffed
+ */
+PVFS_offset PINT_dist_stuffed_limit(PINT_dist *dist)
+{
+    PINT_request_file_data fake_file_data;
+
+    /* find the first offset (above zero) that hits the second of two
+     * servers
+     */
+    memset(&fake_file_data, 0, sizeof(fake_file_data));
+    fake_file_data.dist = dist;
+    fake_file_data.server_ct = 2;
+    fake_file_data.extend_flag = 1;
+    fake_file_data.fsize = 0;
+    fake_file_data.server_nr = 1;
+
+    return dist->methods->next_mapped_offset(dist->params,
+                                             &fake_file_data, 0);
+}
+
 void PINT_dist_dump(PINT_dist *dist)
 {
     gossip_debug(GOSSIP_DIST_DEBUG,"******************************\n");
@@ -142,6 +142,9 @@ void PINT_dist_encode(void *buffer, PINT_dist *dist);
 /* unpack dist struct after receiving from storage */
 void PINT_dist_decode(PINT_dist **dist, void *buffer);
 
+/* Return the number of bytes a stuffed file can hold */
+PVFS_offset PINT_dist_stuffed_limit(PINT_dist *dist);
+
 /* Print dist state to debug system */
 void PINT_dist_dump(PINT_dist *dist);
 
@@ -282,7 +282,8 @@ void PINT_dev_finalize(void)
 /* PINT_dev_get_mapped_regions()
  *
  * creates a set of memory buffers that are shared between user space and 
- * kernel space
+ * kernel space.  if the device has not been opened (e.g. when replaying
+ * a recorded upcall stream) the buffers are only set up locally
  *
  * returns 0 on success, -PVFS_error on failure
  */
@@ -335,7 +336,7 @@ int PINT_dev_get_mapped_regions(int ndesc, struct PVFS_dev_map_desc *desc,
         /* fixes a corruption issue on linux 2.4 kernels where the buffers are
          * not being pinned in memory properly 
          */
-        if(mlock( (const char *) ptr, total_size) != 0)
+        if(pdev_fd > -1 && mlock( (const char *) ptr, total_size) != 0)
         { 
            gossip_err("Error: FAILED to mlock shared buffer\n");
            break;
@@ -355,7 +356,7 @@ int PINT_dev_get_mapped_regions(int ndesc, struct PVFS_dev_map_desc *desc,
         /* ioctl to ask driver to map pages if needed */
         if (ioctl_cmd[i] != 0)
         {
-            ret = ioctl(pdev_fd, ioctl_cmd[i], &desc[i]);
+            ret = (pdev_fd > -1) ? ioctl(pdev_fd, ioctl_cmd[i], &desc[i]) : 0;
             if (ret < 0)
             {
                 gossip_err("Error: ioctl FAILED returned %d\n", errno);
@@ -700,8 +701,8 @@ int PINT_dev_release_unexpected(
     if (info && info->buffer)
     {
         /* index backwards header size off of the buffer before freeing */
-        buffer = (void *)((unsigned long)info->buffer - 2 * sizeof(int32_t) - 
-                         sizeof(uint64_t));
+        buffer = (void *)((unsigned long)info->buffer -
+                          PINT_DEV_UNEXP_HEADER_SIZE);
         free(buffer);
 
         ret = 0;
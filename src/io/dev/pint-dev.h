@@ -47,6 +47,33 @@ struct PINT_dev_unexp_info
     PVFS_id_gen_t tag;
 };
 
+/* size of the header in front of every unexpected message buffer; see
+ * PINT_dev_release_unexpected()
+ */
+#define PINT_DEV_UNEXP_HEADER_SIZE (2 * sizeof(int32_t) + sizeof(uint64_t))
+
+/*
+ * upcall streams recorded by pvfs2-client-core (--record-upcalls) start
+ * with a PINT_dev_upcall_stream header, followed by a
+ * PINT_dev_upcall_record and size bytes of message for every upcall
+ */
+#define PINT_DEV_UPCALL_STREAM_MAGIC   "PVFS2UPC"
+#define PINT_DEV_UPCALL_STREAM_VERSION 1
+
+struct PINT_dev_upcall_stream
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t upcall_size;
+};
+
+struct PINT_dev_upcall_record
+{
+    uint64_t tag;
+    uint32_t size;
+    uint32_t __pad1;
+};
+
 /* types of memory buffers accepted in the write calls */
 enum PINT_dev_buffer_type
 {
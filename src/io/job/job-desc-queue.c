@@ -18,6 +18,8 @@
 #include "id-generator.h"
 #include "pint-util.h"
 #include "pvfs2-internal.h"
+#include "pint-sm-trace.h"
+#include "pint-slab.h"
 
 #ifdef WIN32
 typedef enum job_type job_type_t;
@@ -37,7 +39,7 @@ struct job_desc *alloc_job_desc(int type)
 {
     struct job_desc *jd = NULL;
 
-    jd = (struct job_desc *) malloc(sizeof(struct job_desc));
+    jd = (struct job_desc *) PINT_slab_alloc(sizeof(struct job_desc));
     if (!jd)
     {
 	return (NULL);
@@ -52,6 +54,11 @@ struct job_desc *alloc_job_desc(int type)
     jd->type = type;
 #endif
 
+    if (PINT_sm_trace_on)
+    {
+        jd->trace_ns = PINT_sm_trace_now();
+    }
+
     return (jd);
 };
 
@@ -64,7 +71,7 @@ struct job_desc *alloc_job_desc(int type)
 void dealloc_job_desc(struct job_desc *jd)
 {
     id_gen_safe_unregister(jd->job_id);
-    free(jd);
+    PINT_slab_free(jd);
 }
 
 /* job_desc_q_new()
@@ -106,7 +113,7 @@ void job_desc_q_cleanup(job_desc_q_p jdqp)
                         job_desc_q_link);
                 /* qlist_for_each_safe lets us iterate and remove nodes.  no
                  * need to adjust pointers as we are freeing everything */
-                free(tmp_job_desc);
+                PINT_slab_free(tmp_job_desc);
             }
 
             free(jdqp);
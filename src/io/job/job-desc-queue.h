@@ -126,6 +126,7 @@ struct job_desc
     struct PINT_thread_mgr_bmi_callback bmi_callback;  /* callback information */
     struct PINT_thread_mgr_trove_callback trove_callback;  /* callback information */
     PVFS_hint hints;
+    uint64_t trace_ns;          /* post time, when tracing state machines */
 
     /* union of information for lower level interfaces */
     union
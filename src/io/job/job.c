@@ -27,6 +27,7 @@
 #include "id-generator.h"
 #include "job-time-mgr.h"
 #include "pvfs2-internal.h"
+#include "pint-sm-trace.h"
 
 /* contexts for use within the job interface */
 static bmi_context_id global_bmi_context = -1;
@@ -142,7 +143,8 @@ static void trove_thread_mgr_callback(void* data,
 static void flow_callback(flow_descriptor* flow_d, int cancel_path);
 #ifndef __PVFS2_JOB_THREADED__
 static gen_mutex_t work_cycle_mutex = GEN_MUTEX_INITIALIZER;
-static void do_one_work_cycle_all(int idle_time_ms);
+static void do_one_work_cycle_all(int idle_time_ms,
+                                  job_context_id context_id);
 #endif
 #ifdef __PVFS2_TROVE_SUPPORT__
 static void precreate_pool_get_thread_mgr_callback(
@@ -4124,11 +4126,11 @@ int job_testsome(job_id_t * id_array,
 
         if (timeout_ms)
         {
-            do_one_work_cycle_all(10);
+            do_one_work_cycle_all(10, -1);
         }
         else
         {
-            do_one_work_cycle_all(0);
+            do_one_work_cycle_all(0, -1);
         }
 
         /* check queue now to see if anything is done */
@@ -4362,11 +4364,11 @@ int job_testcontext(job_id_t * out_id_array_p,
 
         if (timeout_ms)
         {
-            do_one_work_cycle_all(10);
+            do_one_work_cycle_all(10, context_id);
         }
         else
         {
-            do_one_work_cycle_all(0);
+            do_one_work_cycle_all(0, context_id);
         }
 
         /* check queue now to see if anything is done */
@@ -5051,6 +5053,9 @@ static void fill_status(struct job_desc *jd,
 
     status->status_user_tag = jd->status_user_tag;
 
+    PINT_SM_TRACE(PINT_SM_TRACE_JOB, jd->job_user_ptr, jd->trace_ns, -1,
+                  jd->type);
+
     if (returned_user_ptr_p)
     {
         *returned_user_ptr_p = jd->job_user_ptr;
@@ -5316,16 +5321,34 @@ static int completion_query_context(job_id_t * out_id_array_p,
 #ifndef __PVFS2_JOB_THREADED__
 /* do_one_work_cycle_all()
  *
- * makes progress when threads are not used
+ * makes progress when threads are not used.  If context_id is valid
+ * and another caller already completed work for that context while we
+ * waited for the work cycle lock, returns without idling so the caller
+ * can collect it.
  *
  * no return value
  */
-static void do_one_work_cycle_all(int idle_time_ms)
+static void do_one_work_cycle_all(int idle_time_ms,
+                                  job_context_id context_id)
 {
     int total_pending_count = 0;
+    int ready = 0;
     
     gen_mutex_lock(&work_cycle_mutex);
 
+    if (context_id >= 0 && context_id < JOB_MAX_CONTEXTS)
+    {
+        gen_mutex_lock(&completion_mutex);
+        ready = (completion_queue_array[context_id] &&
+                 !job_desc_q_empty(completion_queue_array[context_id]));
+        gen_mutex_unlock(&completion_mutex);
+        if (ready)
+        {
+            gen_mutex_unlock(&work_cycle_mutex);
+            return;
+        }
+    }
+
     total_pending_count = bmi_pending_count + bmi_unexp_pending_count
         + flow_pending_count + dev_unexp_pending_count + trove_pending_count;
 
@@ -17,10 +17,24 @@
 
 enum PVFS_coll_getinfo_options_e
 {
-    PVFS_COLLECTION_STATFS = 1
+    PVFS_COLLECTION_STATFS = 1,
+    PVFS_COLLECTION_ATTR_CACHE_STATS = 2
 };
 typedef enum PVFS_coll_getinfo_options_e PVFS_coll_getinfo_options;
 
+/* attribute cache counters, summed over all collections */
+struct PVFS_ds_attr_cache_stats_s
+{
+    uint64_t hits;          /* dspace attributes served from the cache */
+    uint64_t misses;
+    uint64_t keyval_hits;   /* keyval values served from the cache */
+    uint64_t keyval_misses;
+    uint64_t negative_hits; /* keyval reads answered by a cached absence */
+    uint64_t evictions;
+    uint32_t num_elems;
+};
+typedef struct PVFS_ds_attr_cache_stats_s PVFS_ds_attr_cache_stats;
+
 struct PVFS_vtag_s
 {
     /* undefined */
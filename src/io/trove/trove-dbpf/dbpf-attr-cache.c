@@ -12,23 +12,58 @@
 #include "str-utils.h"
 #include "pvfs2-internal.h"
 
-/* public mutex lock */
+/* serializes the setinfo hooks, initialize and finalize */
 gen_mutex_t dbpf_attr_cache_mutex = GEN_MUTEX_INITIALIZER;
 
 /* these are based on code from src/server/request-scheduler.c */
 static int hash_key(const void *key, int table_size);
 static int hash_key_compare(const void *key, struct qlist_head *link);
 
+/*
+  one slice of the cache.  each shard is a self-contained cache for
+  the handles that map to it: the lock covers the table, the clock
+  list, the element count and the counters.
+*/
+struct dbpf_attr_cache_shard
+{
+    gen_mutex_t mutex;
+    struct qhash_table *table;
+    /* every element, in clock order; the hand is the list head */
+    struct qlist_head clock;
+    int num_elems;
+    int max_num_elems;
+    /* source of keyval_generation values for this shard's elements */
+    uint32_t generation;
+
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t keyval_hits;
+    uint64_t keyval_misses;
+    uint64_t negative_hits;
+    uint64_t evictions;
+};
+
 static int s_cache_size = DBPF_ATTR_CACHE_DEFAULT_SIZE;
 static int s_max_num_cache_elems = 
 DBPF_ATTR_CACHE_DEFAULT_MAX_NUM_CACHE_ELEMS;
-static struct qhash_table *s_key_to_attr_table = NULL;
+static struct dbpf_attr_cache_shard s_shards[DBPF_ATTR_CACHE_NUM_SHARDS];
+static int s_shard_mutexes_ready = 0;
+static int s_initialized = 0;
 static char **s_cacheable_keyword_array = NULL;
 static int s_cacheable_keyword_array_size = 0;
-static int s_current_num_cache_elems = 0;
 
 #define DBPF_ATTR_CACHE_INITIALIZED() \
-(s_key_to_attr_table)
+(s_initialized)
+
+static struct dbpf_attr_cache_shard *shard_lock(TROVE_object_ref key);
+static dbpf_attr_cache_elem_t *shard_lookup(
+    struct dbpf_attr_cache_shard *shard, TROVE_object_ref key);
+static dbpf_keyval_pair_cache_elem_t *elem_keyval_pair(
+    dbpf_attr_cache_elem_t *cache_elem, char *key_str);
+static void elem_keyval_pair_clear(dbpf_keyval_pair_cache_elem_t *pair);
+static void shard_remove_elem(
+    struct dbpf_attr_cache_shard *shard, dbpf_attr_cache_elem_t *cache_elem);
+static void shard_evict_one(struct dbpf_attr_cache_shard *shard);
 
 int dbpf_attr_cache_set_keywords(char *keywords)
 {
@@ -79,8 +114,10 @@ int dbpf_attr_cache_initialize(
     int num_cacheable_keywords)
 {
     int ret = -1, i = 0;
+    int shard_table_size = 0, shard_max_num_elems = 0;
+    struct dbpf_attr_cache_shard *shard = NULL;
 
-    if (s_key_to_attr_table == NULL)
+    if (!DBPF_ATTR_CACHE_INITIALIZED())
     {
         if (cacheable_keywords)
         {
@@ -112,19 +149,60 @@ int dbpf_attr_cache_initialize(
             }
         }
 
-        s_current_num_cache_elems = 0;
-        s_max_num_cache_elems = cache_max_num_elems;
-        s_key_to_attr_table = qhash_init(
-            hash_key_compare, hash_key, table_size);
-        if (!s_key_to_attr_table)
+        /*
+          split the table and the element limit across the shards,
+          giving every shard at least one bucket and one element
+        */
+        shard_table_size = table_size / DBPF_ATTR_CACHE_NUM_SHARDS;
+        if (shard_table_size < 1)
+        {
+            shard_table_size = 1;
+        }
+        shard_max_num_elems =
+            cache_max_num_elems / DBPF_ATTR_CACHE_NUM_SHARDS;
+        if (shard_max_num_elems < 1)
         {
-            goto return_error;
+            shard_max_num_elems = 1;
         }
 
-        srand((unsigned int)time(NULL));
+        s_max_num_cache_elems = cache_max_num_elems;
+        for(i = 0; i < DBPF_ATTR_CACHE_NUM_SHARDS; i++)
+        {
+            shard = &s_shards[i];
+            if (!s_shard_mutexes_ready)
+            {
+                gen_mutex_init(&shard->mutex);
+            }
+            shard->table = qhash_init(
+                hash_key_compare, hash_key, shard_table_size);
+            if (!shard->table)
+            {
+                while(--i >= 0)
+                {
+                    qhash_finalize(s_shards[i].table);
+                    s_shards[i].table = NULL;
+                }
+                goto return_error;
+            }
+            INIT_QLIST_HEAD(&shard->clock);
+            shard->num_elems = 0;
+            shard->max_num_elems = shard_max_num_elems;
+            shard->generation = 0;
+            shard->hits = 0;
+            shard->misses = 0;
+            shard->keyval_hits = 0;
+            shard->keyval_misses = 0;
+            shard->negative_hits = 0;
+            shard->evictions = 0;
+        }
+        s_shard_mutexes_ready = 1;
+        s_initialized = 1;
 
         gossip_debug(GOSSIP_DBPF_ATTRCACHE_DEBUG,
-                     "dbpf_attr_cache_initialize: initialized\n");
+                     "dbpf_attr_cache_initialize: initialized %d shards "
+                     "of %d buckets and %d elements\n",
+                     DBPF_ATTR_CACHE_NUM_SHARDS, shard_table_size,
+                     shard_max_num_elems);
         ret = 0;
     }
     else
@@ -140,40 +218,39 @@ int dbpf_attr_cache_initialize(
 
 int dbpf_attr_cache_finalize(void)
 {
-    int ret = -1, i = 0, j = 0;
-    struct qlist_head *hash_link = NULL;
+    int i = 0;
+    struct dbpf_attr_cache_shard *shard = NULL;
     dbpf_attr_cache_elem_t *cache_elem = NULL;
+    TROVE_attr_cache_stats stats;
 
     if (DBPF_ATTR_CACHE_INITIALIZED())
     {
-        for(i = 0; i < s_key_to_attr_table->table_size; i++)
+        dbpf_attr_cache_get_stats(&stats);
+        gossip_debug(GOSSIP_DBPF_ATTRCACHE_DEBUG,
+                     "dbpf_attr_cache: %llu hits, %llu misses, "
+                     "%llu keyval hits, %llu keyval misses, "
+                     "%llu negative hits, %llu evictions\n",
+                     llu(stats.hits), llu(stats.misses),
+                     llu(stats.keyval_hits), llu(stats.keyval_misses),
+                     llu(stats.negative_hits), llu(stats.evictions));
+
+        s_initialized = 0;
+        for(i = 0; i < DBPF_ATTR_CACHE_NUM_SHARDS; i++)
         {
-            do
+            shard = &s_shards[i];
+            gen_mutex_lock(&shard->mutex);
+            while(!qlist_empty(&shard->clock))
             {
-                hash_link = qhash_search_and_remove_at_index(
-                    s_key_to_attr_table,i);
-                if (hash_link)
-                {
-                    cache_elem = qhash_entry(
-                        hash_link, dbpf_attr_cache_elem_t, hash_link);
-                    for( j = 0; j < cache_elem->num_keyval_pairs; j++ )
-                    {
-                        /* any elements still existing need their keyval pairs
-                         * data pointer free'd before the element is free'd */
-                        if( cache_elem->keyval_pairs[j].data )
-                            free(cache_elem->keyval_pairs[j].data);
-                    }
-                    free(cache_elem);
-                    s_current_num_cache_elems--;
-                }
-            } while(hash_link);
+                cache_elem = qlist_entry(shard->clock.next,
+                                         dbpf_attr_cache_elem_t, clock_link);
+                shard_remove_elem(shard, cache_elem);
+            }
+            assert(shard->num_elems == 0);
+            qhash_finalize(shard->table);
+            shard->table = NULL;
+            gen_mutex_unlock(&shard->mutex);
         }
 
-        assert(s_current_num_cache_elems == 0);
-        ret = ((i == s_key_to_attr_table->table_size) ? 0 : -1);
-        qhash_finalize(s_key_to_attr_table);
-        s_key_to_attr_table = NULL;
-
         gossip_debug(GOSSIP_DBPF_ATTRCACHE_DEBUG,
                      "dbpf_attr_cache_finalized\n");
     }
@@ -185,51 +262,58 @@ int dbpf_attr_cache_finalize(void)
         s_cacheable_keyword_array = NULL;
         s_cacheable_keyword_array_size = 0;
     }
-    return ret;
+    return 0;
 }
 
-dbpf_attr_cache_elem_t *dbpf_attr_cache_elem_lookup(TROVE_object_ref key)
+void dbpf_attr_cache_get_stats(TROVE_attr_cache_stats *stats)
 {
-    struct qlist_head *hash_link = NULL;
-    dbpf_attr_cache_elem_t *cache_elem = NULL;
+    int i = 0;
+    struct dbpf_attr_cache_shard *shard = NULL;
 
-    if (DBPF_ATTR_CACHE_INITIALIZED())
+    memset(stats, 0, sizeof(*stats));
+    if (!DBPF_ATTR_CACHE_INITIALIZED())
     {
-        hash_link = qhash_search(s_key_to_attr_table,&(key));
-        if (hash_link)
-        {
-            cache_elem = qhash_entry(
-                hash_link, dbpf_attr_cache_elem_t, hash_link);
-            assert(cache_elem);
-            gossip_debug(
-                GOSSIP_DBPF_ATTRCACHE_DEBUG,
-                "dbpf_cache_elem_lookup: cache "
-                "elem matching %llu returned (num_elems=%d)\n",
-                llu(key.handle), s_current_num_cache_elems);
-        }
+        return;
+    }
+
+    for(i = 0; i < DBPF_ATTR_CACHE_NUM_SHARDS; i++)
+    {
+        shard = &s_shards[i];
+        gen_mutex_lock(&shard->mutex);
+        stats->hits += shard->hits;
+        stats->misses += shard->misses;
+        stats->keyval_hits += shard->keyval_hits;
+        stats->keyval_misses += shard->keyval_misses;
+        stats->negative_hits += shard->negative_hits;
+        stats->evictions += shard->evictions;
+        stats->num_elems += shard->num_elems;
+        gen_mutex_unlock(&shard->mutex);
     }
-    return cache_elem;
 }
 
 int dbpf_attr_cache_ds_attr_update_cached_data(
     TROVE_object_ref key, TROVE_ds_attributes *src_ds_attr)
 {
     int ret = -1;
+    struct dbpf_attr_cache_shard *shard = NULL;
     dbpf_attr_cache_elem_t *cache_elem = NULL;
 
-    cache_elem = dbpf_attr_cache_elem_lookup(key);
+    shard = shard_lock(key);
+    if (!shard)
+    {
+        return ret;
+    }
+    cache_elem = shard_lookup(shard, key);
     if (cache_elem && src_ds_attr)
     {
-        if (cache_elem && src_ds_attr)
-        {
-            memcpy(&cache_elem->attr, src_ds_attr,
-                   sizeof(TROVE_ds_attributes));
-            gossip_debug(GOSSIP_DBPF_ATTRCACHE_DEBUG, "Updating "
-                         "cached attributes for key %llu\n",
-                         llu(key.handle));
-            ret = 0;
-        }
+        memcpy(&cache_elem->attr, src_ds_attr,
+               sizeof(TROVE_ds_attributes));
+        gossip_debug(GOSSIP_DBPF_ATTRCACHE_DEBUG, "Updating "
+                     "cached attributes for key %llu\n",
+                     llu(key.handle));
+        ret = 0;
     }
+    gen_mutex_unlock(&shard->mutex);
     return ret;
 }
 
@@ -237,20 +321,24 @@ int dbpf_attr_cache_ds_attr_update_cached_data_bsize(
     TROVE_object_ref key, PVFS_size b_size)
 {
     int ret = -1;
+    struct dbpf_attr_cache_shard *shard = NULL;
     dbpf_attr_cache_elem_t *cache_elem = NULL;
 
-    cache_elem = dbpf_attr_cache_elem_lookup(key);
+    shard = shard_lock(key);
+    if (!shard)
+    {
+        return ret;
+    }
+    cache_elem = shard_lookup(shard, key);
     if (cache_elem)
     {
-        if (cache_elem)
-        {
-            cache_elem->attr.u.datafile.b_size = b_size;
-            gossip_debug(GOSSIP_DBPF_ATTRCACHE_DEBUG, "Updating "
-                         "cached b_size for key %llu\n",
-                         llu(key.handle));
-            ret = 0;
-        }
+        cache_elem->attr.u.datafile.b_size = b_size;
+        gossip_debug(GOSSIP_DBPF_ATTRCACHE_DEBUG, "Updating "
+                     "cached b_size for key %llu\n",
+                     llu(key.handle));
+        ret = 0;
     }
+    gen_mutex_unlock(&shard->mutex);
     return ret;
 }
 
@@ -258,112 +346,227 @@ int dbpf_attr_cache_ds_attr_fetch_cached_data(
     TROVE_object_ref key, TROVE_ds_attributes *target_ds_attr)
 {
     int ret = -1;
-    struct qlist_head *hash_link = NULL;
+    struct dbpf_attr_cache_shard *shard = NULL;
+    dbpf_attr_cache_elem_t *cache_elem = NULL;
+
+    if (!target_ds_attr)
+    {
+        return ret;
+    }
+    shard = shard_lock(key);
+    if (!shard)
+    {
+        return ret;
+    }
+    cache_elem = shard_lookup(shard, key);
+    if (cache_elem)
+    {
+        memcpy(target_ds_attr, &cache_elem->attr,
+               sizeof(TROVE_ds_attributes));
+        cache_elem->referenced = 1;
+        shard->hits++;
+        ret = 0;
+    }
+    else
+    {
+        shard->misses++;
+    }
+    gen_mutex_unlock(&shard->mutex);
+    return ret;
+}
+
+int dbpf_attr_cache_elem_set_data_based_on_key(
+    TROVE_object_ref key, char *key_str, void *data, int data_sz)
+{
+    int ret = -1;
+    struct dbpf_attr_cache_shard *shard = NULL;
     dbpf_attr_cache_elem_t *cache_elem = NULL;
+    dbpf_keyval_pair_cache_elem_t *pair = NULL;
 
-    if (DBPF_ATTR_CACHE_INITIALIZED() && target_ds_attr)
+    if (!key_str)
+    {
+        return ret;
+    }
+    shard = shard_lock(key);
+    if (!shard)
     {
-        hash_link = qhash_search(s_key_to_attr_table,&(key));
-        if (hash_link)
+        return ret;
+    }
+    cache_elem = shard_lookup(shard, key);
+    pair = elem_keyval_pair(cache_elem, key_str);
+    if (pair)
+    {
+        gossip_debug(
+            GOSSIP_DBPF_ATTRCACHE_DEBUG,
+            "Setting data %p based on key "
+            "%llu and key_str %s (data_sz=%d)\n", data,
+            llu(key.handle), key_str, data_sz);
+
+        elem_keyval_pair_clear(pair);
+        pair->data = malloc(data_sz);
+        assert(pair->data);
+        memcpy(pair->data, data, data_sz);
+        pair->data_sz = data_sz;
+        cache_elem->keyval_generation = ++shard->generation;
+        ret = 0;
+    }
+    gen_mutex_unlock(&shard->mutex);
+    return ret;
+}
+
+int dbpf_attr_cache_keyval_fetch_cached_data(
+    TROVE_object_ref key, char *key_str,
+    void *target_data, int *target_data_sz)
+{
+    int ret = -1;
+    struct dbpf_attr_cache_shard *shard = NULL;
+    dbpf_attr_cache_elem_t *cache_elem = NULL;
+    dbpf_keyval_pair_cache_elem_t *pair = NULL;
+
+    if (!key_str || !target_data || !target_data_sz)
+    {
+        return ret;
+    }
+    shard = shard_lock(key);
+    if (!shard)
+    {
+        return ret;
+    }
+    cache_elem = shard_lookup(shard, key);
+    pair = elem_keyval_pair(cache_elem, key_str);
+    if (!pair)
+    {
+        /* not a cacheable keyword, or no cached attributes for key */
+    }
+    else if (pair->negative)
+    {
+        gossip_debug(GOSSIP_DBPF_ATTRCACHE_DEBUG, "key_str %s is cached "
+                     "as absent on %llu\n", key_str, llu(key.handle));
+        cache_elem->referenced = 1;
+        shard->negative_hits++;
+        ret = -TROVE_ENOENT;
+    }
+    else if (pair->data)
+    {
+        gossip_debug(
+            GOSSIP_DBPF_ATTRCACHE_DEBUG, "Returning data %p "
+            "based on key %llu and key_str %s (data_sz=%d)\n",
+            pair->data, llu(key.handle), key_str, pair->data_sz);
+        cache_elem->referenced = 1;
+        shard->keyval_hits++;
+        if(*target_data_sz < pair->data_sz)
+        {
+            /* cached value is too big for buffer */
+            ret = -TROVE_EINVAL;
+        }
+        else
         {
-            cache_elem = qhash_entry(
-                hash_link, dbpf_attr_cache_elem_t, hash_link);
-            assert(cache_elem);
-            memcpy(target_ds_attr, &cache_elem->attr,
-                   sizeof(TROVE_ds_attributes));
+            memcpy(target_data, pair->data, pair->data_sz);
+            *target_data_sz = pair->data_sz;
             ret = 0;
         }
     }
+    else
+    {
+        shard->keyval_misses++;
+    }
+    gen_mutex_unlock(&shard->mutex);
     return ret;
 }
 
-dbpf_keyval_pair_cache_elem_t *dbpf_attr_cache_elem_get_data_based_on_key(
-    dbpf_attr_cache_elem_t *cache_elem, char *key)
+uint32_t dbpf_attr_cache_keyval_fill_token(TROVE_object_ref key)
 {
-    int i = 0;
+    uint32_t token = 0;
+    struct dbpf_attr_cache_shard *shard = NULL;
+    dbpf_attr_cache_elem_t *cache_elem = NULL;
 
-    if (DBPF_ATTR_CACHE_INITIALIZED() &&
-        (cache_elem && key && cache_elem->num_keyval_pairs))
+    shard = shard_lock(key);
+    if (!shard)
     {
-        for(i = 0; i < cache_elem->num_keyval_pairs; i++)
-        {
-            if ((strcmp(cache_elem->keyval_pairs[i].key, key) == 0) &&
-                (cache_elem->keyval_pairs[i].data != NULL))
-            {
-                gossip_debug(
-                    GOSSIP_DBPF_ATTRCACHE_DEBUG, "Returning data %p "
-                    "based on key %llu and key_str %s (data_sz=%d)\n",
-                    cache_elem->keyval_pairs[i].data,
-                    llu(cache_elem->key.handle), key,
-                    cache_elem->keyval_pairs[i].data_sz);
-                return &cache_elem->keyval_pairs[i];
-            }
-        }
+        return token;
     }
-    return NULL;
+    cache_elem = shard_lookup(shard, key);
+    if (cache_elem)
+    {
+        token = cache_elem->keyval_generation;
+    }
+    gen_mutex_unlock(&shard->mutex);
+    return token;
 }
 
-int dbpf_attr_cache_elem_set_data_based_on_key(
-    TROVE_object_ref key, char *key_str, void *data, int data_sz)
+int dbpf_attr_cache_keyval_fill(
+    TROVE_object_ref key, char *key_str, void *data, int data_sz,
+    uint32_t token)
 {
-    int ret = - 1, i = 0;
+    int ret = -1;
+    struct dbpf_attr_cache_shard *shard = NULL;
     dbpf_attr_cache_elem_t *cache_elem = NULL;
+    dbpf_keyval_pair_cache_elem_t *pair = NULL;
 
-    cache_elem = dbpf_attr_cache_elem_lookup(key);
-    if (cache_elem && key_str && cache_elem->num_keyval_pairs)
+    if (!key_str)
+    {
+        return ret;
+    }
+    shard = shard_lock(key);
+    if (!shard)
+    {
+        return ret;
+    }
+    cache_elem = shard_lookup(shard, key);
+    pair = elem_keyval_pair(cache_elem, key_str);
+    if (pair && (cache_elem->keyval_generation == token))
     {
-        if (!cache_elem || !cache_elem->num_keyval_pairs)
+        elem_keyval_pair_clear(pair);
+        if (data)
         {
-            return ret;
+            pair->data = malloc(data_sz);
+            assert(pair->data);
+            memcpy(pair->data, data, data_sz);
+            pair->data_sz = data_sz;
         }
-        for(i = 0; i < cache_elem->num_keyval_pairs; i++)
+        else
         {
-            if (strcmp(cache_elem->keyval_pairs[i].key, key_str) == 0)
-            {
-                gossip_debug(
-                    GOSSIP_DBPF_ATTRCACHE_DEBUG,
-                    "Setting data %p based on key "
-                    "%llu and key_str %s (data_sz=%d)\n", data,
-                    llu(key.handle), key_str, data_sz);
-
-                if (cache_elem->keyval_pairs[i].data)
-                {
-                    free(cache_elem->keyval_pairs[i].data);
-                }
-                cache_elem->keyval_pairs[i].data = malloc(data_sz);
-                assert(cache_elem->keyval_pairs[i].data);
-                memcpy(cache_elem->keyval_pairs[i].data, data, data_sz);
-                cache_elem->keyval_pairs[i].data_sz = data_sz;
-                ret = 0;
-                break;
-            }
+            pair->negative = 1;
         }
+        gossip_debug(GOSSIP_DBPF_ATTRCACHE_DEBUG, "Filled key_str %s on "
+                     "%llu (%s)\n", key_str, llu(key.handle),
+                     (data ? "present" : "absent"));
+        ret = 0;
     }
+    gen_mutex_unlock(&shard->mutex);
     return ret;
 }
 
-int dbpf_attr_cache_keyval_pair_fetch_cached_data(
-    dbpf_attr_cache_elem_t *cache_elem,
-    dbpf_keyval_pair_cache_elem_t *keyval_pair,
-    void *target_data, int *target_data_sz)
+int dbpf_attr_cache_keyval_invalidate(
+    TROVE_object_ref key, char *key_str)
 {
-    int ret = -1;
+    int ret = -1, i = 0;
+    struct dbpf_attr_cache_shard *shard = NULL;
+    dbpf_attr_cache_elem_t *cache_elem = NULL;
+    dbpf_keyval_pair_cache_elem_t *pair = NULL;
 
-    if (DBPF_ATTR_CACHE_INITIALIZED() &&
-        (keyval_pair && target_data && target_data_sz))
+    shard = shard_lock(key);
+    if (!shard)
+    {
+        return ret;
+    }
+    cache_elem = shard_lookup(shard, key);
+    if (cache_elem && !key_str)
     {
-        if (cache_elem && keyval_pair)
+        for(i = 0; i < cache_elem->num_keyval_pairs; i++)
         {
-            if(*target_data_sz < keyval_pair->data_sz)
-            {
-                /* cached value is too big for buffer */
-                return(-TROVE_EINVAL);
-            }
-            memcpy(target_data, keyval_pair->data, keyval_pair->data_sz);
-            *target_data_sz = keyval_pair->data_sz;
-            ret = 0;
+            elem_keyval_pair_clear(&cache_elem->keyval_pairs[i]);
         }
+        cache_elem->keyval_generation = ++shard->generation;
+        ret = 0;
     }
+    else if ((pair = elem_keyval_pair(cache_elem, key_str)) != NULL)
+    {
+        elem_keyval_pair_clear(pair);
+        cache_elem->keyval_generation = ++shard->generation;
+        ret = 0;
+    }
+    gen_mutex_unlock(&shard->mutex);
     return ret;
 }
 
@@ -371,152 +574,210 @@ int dbpf_attr_cache_insert(
     TROVE_object_ref key,
     TROVE_ds_attributes *attr)
 {
-    int ret = -1, i = 0, already_exists = 0;
+    int ret = -1, i = 0;
+    struct dbpf_attr_cache_shard *shard = NULL;
     dbpf_attr_cache_elem_t *cache_elem = NULL;
-    struct qlist_head *hash_link = NULL;
 
-    if (DBPF_ATTR_CACHE_INITIALIZED())
+    shard = shard_lock(key);
+    if (!shard)
     {
-        if ((s_current_num_cache_elems + 1) > s_max_num_cache_elems)
-        {
-            TROVE_object_ref sacrificial_lamb_key =
-                {TROVE_HANDLE_NULL, TROVE_COLL_ID_NULL};
-            /*
-              we have the lock, so we can safely remove
-              any element in this cache at this point;
-              since our hashtable isn't sorted, and a hit/age
-              count would be too costly in a linear search
-              here, just remove the first element at an arbitrary
-              hashed index that we can find in the hash table
-            */
-            i = (rand() % s_key_to_attr_table->table_size);
-          hashtable_linear_scan:
-            for(; i < s_key_to_attr_table->table_size; i++)
-            {
-                hash_link =
-                    qhash_search_at_index(s_key_to_attr_table,i);
-                if (hash_link)
-                {
-                    cache_elem = qhash_entry(
-                        hash_link, dbpf_attr_cache_elem_t, hash_link);
-                    sacrificial_lamb_key = cache_elem->key;
-                    break;
-                }
-            }
-
-            /*
-              handle a special case where the random index
-              yields a completely empty linked list; start again
-              at 0, as *something* must be in the hash table
-            */
-            if ((i == s_key_to_attr_table->table_size) &&
-                (sacrificial_lamb_key.handle == TROVE_HANDLE_NULL))
-            {
-                i = 0;
-                goto hashtable_linear_scan;
-            }
-            assert(sacrificial_lamb_key.handle != TROVE_HANDLE_NULL);
-            gossip_debug(
-                GOSSIP_DBPF_ATTRCACHE_DEBUG, "*** Cache is full -- "
-                "removing key %llu to insert key %llu\n",
-                llu(sacrificial_lamb_key.handle), llu(key.handle));
-            dbpf_attr_cache_remove(sacrificial_lamb_key);
-        }
+        return ret;
+    }
 
-        hash_link = qhash_search(s_key_to_attr_table,&(key));
-        if (!hash_link)
-        {
-            cache_elem = (dbpf_attr_cache_elem_t *)
-                malloc(sizeof(dbpf_attr_cache_elem_t));
-        }
-        else
-        {
-            cache_elem = qhash_entry(
-                hash_link, dbpf_attr_cache_elem_t, hash_link);
-            already_exists = 1;
-        }
+    cache_elem = shard_lookup(shard, key);
+    if (cache_elem)
+    {
+        /*
+          refresh the attributes only; cached keyvals are kept
+          coherent by the keyval paths and stay valid
+        */
+        memcpy(&(cache_elem->attr), attr, sizeof(TROVE_ds_attributes));
+        cache_elem->referenced = 1;
+        gen_mutex_unlock(&shard->mutex);
+        return 0;
+    }
 
-        if (cache_elem)
-        {
-            if (!already_exists)
-            {
-                memset(cache_elem, 0, sizeof(dbpf_attr_cache_elem_t));
-            }
+    if ((shard->num_elems + 1) > shard->max_num_elems)
+    {
+        shard_evict_one(shard);
+    }
 
-            if (s_cacheable_keyword_array)
-            {
-                /* initialize all of the keyvals we're able to cache */
-                for(i = 0; i < s_cacheable_keyword_array_size; i++)
-                {
-                    cache_elem->keyval_pairs[i].key =
-                        s_cacheable_keyword_array[i];
-                    cache_elem->keyval_pairs[i].data = NULL;
-                }
-                cache_elem->num_keyval_pairs =
-                    s_cacheable_keyword_array_size;
-            }
+    cache_elem = (dbpf_attr_cache_elem_t *)
+        malloc(sizeof(dbpf_attr_cache_elem_t));
+    if (cache_elem)
+    {
+        memset(cache_elem, 0, sizeof(dbpf_attr_cache_elem_t));
 
-            cache_elem->key = key;
-            memcpy(&(cache_elem->attr), attr,
-                   sizeof(TROVE_ds_attributes));
-            if (!already_exists)
+        if (s_cacheable_keyword_array)
+        {
+            /* initialize all of the keyvals we're able to cache */
+            for(i = 0; i < s_cacheable_keyword_array_size; i++)
             {
-                qhash_add(
-                    s_key_to_attr_table,&(key),&(cache_elem->hash_link));
-                s_current_num_cache_elems++;
-                gossip_debug(
-                    GOSSIP_DBPF_ATTRCACHE_DEBUG,
-                    "dbpf_attr_cache_insert: inserting %llu "
-                    "(b_size is %llu)\n", llu(key.handle),
-                    llu(cache_elem->attr.u.datafile.b_size));
+                cache_elem->keyval_pairs[i].key =
+                    s_cacheable_keyword_array[i];
             }
-            ret = 0;
+            cache_elem->num_keyval_pairs =
+                s_cacheable_keyword_array_size;
         }
+
+        cache_elem->key = key;
+        memcpy(&(cache_elem->attr), attr, sizeof(TROVE_ds_attributes));
+        cache_elem->referenced = 1;
+        cache_elem->keyval_generation = ++shard->generation;
+
+        qhash_add(shard->table, &(key), &(cache_elem->hash_link));
+        qlist_add_tail(&cache_elem->clock_link, &shard->clock);
+        shard->num_elems++;
+        gossip_debug(
+            GOSSIP_DBPF_ATTRCACHE_DEBUG,
+            "dbpf_attr_cache_insert: inserting %llu "
+            "(b_size is %llu)\n", llu(key.handle),
+            llu(cache_elem->attr.u.datafile.b_size));
+        ret = 0;
     }
+    gen_mutex_unlock(&shard->mutex);
     return ret;
 }
 
 int dbpf_attr_cache_remove(TROVE_object_ref key)
 {
-    int ret = -1, i = 0;
-    struct qlist_head *hash_link = NULL;
+    int ret = -1;
+    struct dbpf_attr_cache_shard *shard = NULL;
     dbpf_attr_cache_elem_t *cache_elem = NULL;
 
-    if (DBPF_ATTR_CACHE_INITIALIZED())
+    shard = shard_lock(key);
+    if (!shard)
     {
-        hash_link = qhash_search_and_remove(s_key_to_attr_table,&(key));
-        if (hash_link)
-        {
-            cache_elem = qhash_entry(
-                hash_link, dbpf_attr_cache_elem_t, hash_link);
-            assert(cache_elem);
+        return ret;
+    }
+    cache_elem = shard_lookup(shard, key);
+    if (cache_elem)
+    {
+        gossip_debug(
+            GOSSIP_DBPF_ATTRCACHE_DEBUG, "dbpf_attr_cache_remove: "
+            "removing %llu\n", llu(key.handle));
+        shard_remove_elem(shard, cache_elem);
+        ret = 0;
+    }
+    gen_mutex_unlock(&shard->mutex);
+    return ret;
+}
+
+/* shard_lock()
+ *
+ * picks the shard for a key and locks it.  handles are handed out in
+ * runs, so they are mixed before taking the shard index to keep a
+ * run from landing on one shard.
+ *
+ * returns the locked shard, or NULL if the cache is not initialized
+ */
+static struct dbpf_attr_cache_shard *shard_lock(TROVE_object_ref key)
+{
+    uint64_t mix = 0;
+    struct dbpf_attr_cache_shard *shard = NULL;
+
+    if (!DBPF_ATTR_CACHE_INITIALIZED())
+    {
+        return NULL;
+    }
 
-            gossip_debug(
-                GOSSIP_DBPF_ATTRCACHE_DEBUG, "dbpf_attr_cache_remove: "
-                "removing %llu\n", llu(key.handle));
+    mix = (uint64_t)key.handle ^ ((uint64_t)key.fs_id << 32);
+    mix *= 0x9e3779b97f4a7c15ULL;
+    shard = &s_shards[(mix >> 32) % DBPF_ATTR_CACHE_NUM_SHARDS];
+    gen_mutex_lock(&shard->mutex);
+    return shard;
+}
 
-            /* free any keyval data cached as well */
-            if (s_cacheable_keyword_array)
+static dbpf_attr_cache_elem_t *shard_lookup(
+    struct dbpf_attr_cache_shard *shard, TROVE_object_ref key)
+{
+    struct qlist_head *hash_link = NULL;
+
+    hash_link = qhash_search(shard->table, &(key));
+    if (hash_link)
+    {
+        return qhash_entry(hash_link, dbpf_attr_cache_elem_t, hash_link);
+    }
+    return NULL;
+}
+
+/* returns the slot for key_str in cache_elem, or NULL if not cacheable */
+static dbpf_keyval_pair_cache_elem_t *elem_keyval_pair(
+    dbpf_attr_cache_elem_t *cache_elem, char *key_str)
+{
+    int i = 0;
+
+    if (cache_elem && key_str)
+    {
+        for(i = 0; i < cache_elem->num_keyval_pairs; i++)
+        {
+            if (strcmp(cache_elem->keyval_pairs[i].key, key_str) == 0)
             {
-                /* free all of the keyvals we've cached */
-                assert(s_cacheable_keyword_array_size ==
-                       cache_elem->num_keyval_pairs);
-                for(i = 0; i < cache_elem->num_keyval_pairs; i++)
-                {
-                    cache_elem->keyval_pairs[i].key = NULL;
-                    if (cache_elem->keyval_pairs[i].data)
-                    {
-                        free(cache_elem->keyval_pairs[i].data);
-                        cache_elem->keyval_pairs[i].data = NULL;
-                    }
-                }
+                return &cache_elem->keyval_pairs[i];
             }
-            free(cache_elem);
-            s_current_num_cache_elems--;
-            ret = 0;
         }
     }
-    return ret;
+    return NULL;
+}
+
+static void elem_keyval_pair_clear(dbpf_keyval_pair_cache_elem_t *pair)
+{
+    if (pair->data)
+    {
+        free(pair->data);
+        pair->data = NULL;
+    }
+    pair->data_sz = 0;
+    pair->negative = 0;
+}
+
+static void shard_remove_elem(
+    struct dbpf_attr_cache_shard *shard, dbpf_attr_cache_elem_t *cache_elem)
+{
+    int i = 0;
+
+    qhash_del(&cache_elem->hash_link);
+    qlist_del(&cache_elem->clock_link);
+
+    /* free any keyval data cached as well */
+    for(i = 0; i < cache_elem->num_keyval_pairs; i++)
+    {
+        elem_keyval_pair_clear(&cache_elem->keyval_pairs[i]);
+    }
+    free(cache_elem);
+    shard->num_elems--;
+}
+
+/* shard_evict_one()
+ *
+ * CLOCK replacement: the element under the hand is evicted unless it
+ * was referenced since the hand last passed, in which case it loses
+ * its reference bit and the hand moves on.  the hand is the head of
+ * the clock list, so passing an element moves it to the tail.
+ */
+static void shard_evict_one(struct dbpf_attr_cache_shard *shard)
+{
+    dbpf_attr_cache_elem_t *cache_elem = NULL;
+
+    while(!qlist_empty(&shard->clock))
+    {
+        cache_elem = qlist_entry(shard->clock.next,
+                                 dbpf_attr_cache_elem_t, clock_link);
+        if (cache_elem->referenced)
+        {
+            cache_elem->referenced = 0;
+            qlist_del(&cache_elem->clock_link);
+            qlist_add_tail(&cache_elem->clock_link, &shard->clock);
+            continue;
+        }
+
+        gossip_debug(
+            GOSSIP_DBPF_ATTRCACHE_DEBUG, "*** Cache shard is full -- "
+            "evicting key %llu\n", llu(cache_elem->key.handle));
+        shard_remove_elem(shard, cache_elem);
+        shard->evictions++;
+        return;
+    }
 }
 
 /* hash_key()
@@ -21,11 +21,20 @@
 #define DBPF_ATTR_CACHE_DEFAULT_SIZE                  511
 #define DBPF_ATTR_CACHE_DEFAULT_MAX_NUM_CACHE_ELEMS  1024
 
+/*
+  the cache is split by handle into this many shards, each with its
+  own lock, hash table and eviction clock.  the configured table size
+  and element limit are divided evenly among the shards.
+*/
+#define DBPF_ATTR_CACHE_NUM_SHARDS                     16
+
 typedef struct
 {
     char *key;
     void *data;
     int data_sz;
+    /* set when a read found no such keyval on disk */
+    int negative;
 } dbpf_keyval_pair_cache_elem_t;
 
 /*
@@ -35,12 +44,18 @@ typedef struct
 typedef struct
 {
     struct qlist_head hash_link;
+    struct qlist_head clock_link;
 
     TROVE_object_ref key;
     TROVE_ds_attributes attr;
     dbpf_keyval_pair_cache_elem_t keyval_pairs[
         DBPF_ATTR_CACHE_MAX_NUM_KEYVALS];
     int num_keyval_pairs;
+
+    /* CLOCK reference bit; set on every hit, cleared as the hand passes */
+    int referenced;
+    /* bumped on every keyval update; see keyval_fill_token below */
+    uint32_t keyval_generation;
 } dbpf_attr_cache_elem_t;
 
 
@@ -50,6 +65,11 @@ typedef struct
  * all methods return 0 on success; -1 on failure
  * (unless noted)
  *
+ * each method takes the lock of the shard its key maps to, so
+ * callers need no locking of their own.  dbpf_attr_cache_mutex
+ * only serializes the setinfo hooks, initialize and finalize,
+ * which must not run while trove operations are in flight.
+ *
  ***********************************************/
 
 /*
@@ -68,10 +88,6 @@ int dbpf_attr_cache_initialize(
     char **cacheable_keywords,
     int num_cacheable_keywords);
 
-/* returns the cached element object on success; NULL on failure */
-dbpf_attr_cache_elem_t *dbpf_attr_cache_elem_lookup(
-    TROVE_object_ref key);
-
 /* do an atomic update of the attributes in the cache for this key */
 int dbpf_attr_cache_ds_attr_update_cached_data(
     TROVE_object_ref key, TROVE_ds_attributes *src_ds_attr);
@@ -95,37 +111,51 @@ int dbpf_attr_cache_remove(
     TROVE_object_ref key);
 int dbpf_attr_cache_finalize(void);
 
+/* sums the per-shard counters into stats */
+void dbpf_attr_cache_get_stats(TROVE_attr_cache_stats *stats);
+
 
 /***********************************************
  * dbpf-attr-cache keyval related methods
  ***********************************************/
 
 /*
-  given a cached elem and a keyval key, return associated
-  data if cached; NULL otherwise
+  map data to key_str, based on specified key's attr cache entry.
+  this is the write path: it replaces whatever was cached, including
+  a negative entry.
 */
-dbpf_keyval_pair_cache_elem_t *dbpf_attr_cache_elem_get_data_based_on_key(
-    dbpf_attr_cache_elem_t *cache_elem, char *key);
-
-/* map data to key_str, based on specified key's attr cache entry */
 int dbpf_attr_cache_elem_set_data_based_on_key(
     TROVE_object_ref key, char *key_str, void *data, int data_sz);
 
-/* do an atomic update of the data in the cache for this keyval */
-int dbpf_attr_cache_keyval_pair_update_cached_data(
-    dbpf_attr_cache_elem_t *cache_elem,
-    dbpf_keyval_pair_cache_elem_t *keyval_pair,
-    void *src_data, int src_data_sz);
 /*
-  do an atomic copy of the cached data into the provided
-  buffer; assumes target buffer is large enough to store all
-  data.  the size of the data is stored in target_data_sz.
+  do an atomic copy of the cached data for key_str into the provided
+  buffer.  returns 0 and sets target_data_sz on a hit, -TROVE_ENOENT
+  if the keyval is cached as absent, -TROVE_EINVAL if the buffer is
+  too small for the cached value, and -1 if nothing is cached.
 */
-int dbpf_attr_cache_keyval_pair_fetch_cached_data(
-    dbpf_attr_cache_elem_t *cache_elem,
-    dbpf_keyval_pair_cache_elem_t *keyval_pair,
+int dbpf_attr_cache_keyval_fetch_cached_data(
+    TROVE_object_ref key, char *key_str,
     void *target_data, int *target_data_sz);
 
+/*
+  the read path caches what it found on disk in two steps: take a
+  token before reading, then fill with the result.  the fill is
+  dropped if a write or invalidate touched the entry in between, so a
+  read racing with a write can never leave the older value (or a
+  stale absence) in the cache.  a NULL data fills a negative entry.
+*/
+uint32_t dbpf_attr_cache_keyval_fill_token(TROVE_object_ref key);
+int dbpf_attr_cache_keyval_fill(
+    TROVE_object_ref key, char *key_str, void *data, int data_sz,
+    uint32_t token);
+
+/*
+  forget what is cached for key_str (or for every keyword if key_str
+  is NULL) without removing the cached attributes
+*/
+int dbpf_attr_cache_keyval_invalidate(
+    TROVE_object_ref key, char *key_str);
+
 
 /***********************************************
  * dbpf-attr-cache to trove setinfo hooks
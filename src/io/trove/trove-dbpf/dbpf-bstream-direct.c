@@ -9,6 +9,7 @@
 #include <stdio.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <fcntl.h>
 #include <stdlib.h>
 #ifdef HAVE_MALLOC_H
@@ -28,15 +29,13 @@
 #include "dbpf-op-queue.h"
 #include "dbpf-attr-cache.h"
 #include "dbpf-bstream.h"
+#include "dbpf-bstream-direct.h"
 #include "dbpf-sync.h"
-/* #include "pint-mem.h" obsolete */
+#include "pint-mem-pool.h"
 #include "pint-mgmt.h"
 #include "pint-context.h"
 #include "pint-op.h"
 
-static gen_mutex_t dbpf_update_size_lock = GEN_MUTEX_INITIALIZER;
-static gen_mutex_t grow_bstream_table_lock = GEN_MUTEX_INITIALIZER;
-
 typedef struct
 {
     char *buffer;
@@ -44,17 +43,83 @@ typedef struct
     TROVE_offset offset;
 } dbpf_stream_extents_t;
 
-struct qhash_table *grow_bstream_table = NULL;
+/* In-memory bstream sizes.
+ *
+ * Each bstream written through this method has a size record.  Writes
+ * that extend the bstream raise the recorded size with an atomic max
+ * rather than rewriting the dspace attributes, and put the record on its
+ * shard's dirty list.  The dbpf thread writes dirty sizes back to the
+ * dspace attributes every DBPF_BSTREAM_SIZE_PERSIST_MSECS; flush writes
+ * back and syncs one handle, and finalize writes back everything.
+ *
+ * Two kinds of write do not wait for the write back.  A TROVE_SYNC
+ * write stores and syncs the size it reaches before it completes.  A
+ * write that ends inside a block past the stored size stores its end
+ * before its data goes out, since direct I/O pads the bstream out to
+ * the end of that block and the padding must never count as data.
+ *
+ * A record is created whenever a datafile's attributes are read from the
+ * dspace db.  If the bstream on disk extends past the stored size rounded
+ * up to BLOCK_SIZE, the server stopped before the size was written back,
+ * and the size is recovered from the bstream length.  By the above only
+ * writes ending on a block boundary can have put the length there, so it
+ * is the exact size.
+ */
+#define DBPF_BSTREAM_SIZE_SHARDS 16
+#define DBPF_BSTREAM_SIZE_TABLE_SIZE 127
+#define DBPF_BSTREAM_SIZE_MAX_PER_SHARD 1024
+#define DBPF_BSTREAM_SIZE_PERSIST_MSECS 1000
+
+/* writes that cover only part of a block read-modify-write it, and two
+ * of those on the same block must not interleave.  fcntl locks do not
+ * exclude the io threads of one process from each other, so these
+ * striped locks serialize them instead.
+ */
+#define DBPF_BSTREAM_BLOCK_LOCKS 64
 
-struct grow_bstream_handle
+struct dbpf_bstream_size
 {
     struct qlist_head hash_link;
-    gen_mutex_t handle_lock;
-    gen_mutex_t refcount_lock;
-    PVFS_handle handle;
-    int refcount;
+    struct qlist_head dirty_link;   /* protected by the shard mutex */
+    TROVE_object_ref ref;
+    PVFS_size size;                 /* current size; atomic */
+    PVFS_size stored_size;          /* size in the dspace attributes */
+    PVFS_size synced_size;          /* stored size known to be on disk */
+    int dirty;                      /* atomic; set while grown past stored */
+    int on_dirty_list;              /* protected by the shard mutex */
+    int refcount;                   /* protected by the shard mutex */
+    int removed;                    /* handle is gone; never write back */
+    gen_mutex_t store_mutex;        /* serializes write back and resize */
 };
 
+struct dbpf_bstream_size_shard
+{
+    gen_mutex_t mutex;
+    struct qhash_table *table;
+    struct qlist_head dirty_list;
+    int dirty_count;
+    int count;
+};
+
+static struct dbpf_bstream_size_shard size_shards[DBPF_BSTREAM_SIZE_SHARDS];
+static gen_mutex_t block_locks[DBPF_BSTREAM_BLOCK_LOCKS];
+static gen_mutex_t size_persist_mutex = GEN_MUTEX_INITIALIZER;
+static int size_table_ready = 0;
+static uint64_t size_last_persist_ms = 0;
+
+extern TROVE_method_callback global_trove_method_callback;
+
+static int bstream_size_get(struct dbpf_collection *coll_p,
+                            TROVE_object_ref ref,
+                            struct dbpf_bstream_size **rec_p);
+static void bstream_size_put(struct dbpf_bstream_size *rec);
+static void bstream_size_extend(struct dbpf_bstream_size *rec,
+                                PVFS_size eor);
+static int bstream_size_store(struct dbpf_bstream_size *rec, int sync);
+static int bstream_size_store_eor(struct dbpf_bstream_size *rec,
+                                  PVFS_size eor, PVFS_size sync_to);
+static void bstream_size_write_back_dirty(int sync);
+
 static int dbpf_bstream_get_extents(
     char **mem_offset_array,
     TROVE_size *mem_size_array,
@@ -65,18 +130,6 @@ static int dbpf_bstream_get_extents(
     int *ext_count,
     dbpf_stream_extents_t *extents);
 
-static int hash_handle_compare(
-    const void *key,
-    struct qlist_head *link);
-
-static int hash_handle(
-    const void *handle,
-    int table_size);
-
-static int grow_bstream_handle_table_init( int size );
-static int grow_bstream_handle_acquire_lock( TROVE_object_ref ref );
-static int grow_bstream_handle_release_lock( TROVE_object_ref ref );
-
 static size_t direct_aligned_write(int fd, 
                                     void *buf,
                                     off_t buf_offset,
@@ -85,20 +138,11 @@ static size_t direct_aligned_write(int fd,
                                     off_t stream_size);
 
 static size_t direct_locked_write(int fd,
+                            struct dbpf_bstream_size *size_rec,
                             void * buf,
                             off_t buf_offset,
                             size_t size,
-                            off_t write_offset,
-                            off_t stream_size);
-
-#if 0
-static size_t new_direct_write(int fd,
-                               void * buf,
-                               off_t buf_offset,
-                               size_t size,
-                               off_t write_offset,
-                               off_t stream_size);
-#endif
+                            off_t write_offset);
 
 static size_t direct_write(int fd,
                            void * buf,
@@ -154,25 +198,6 @@ extern PINT_manager_t io_thread_mgr;
 extern PINT_worker_id io_worker_id;
 extern PINT_queue_id io_queue_id;
 
-#if 0
-struct aligned_block
-{
-    void *ptr;
-    struct qlist_head link;
-};
-static struct aligned_block *blocks;
-static void *aligned_blocks_buffer;
-static QLIST_HEAD(aligned_blocks_unused);
-static QLIST_HEAD(aligned_blocks_used);
-static gen_mutex_t aligned_blocks_mutex = GEN_MUTEX_INITIALIZER;
-static int used_count;
-
-int dbpf_aligned_blocks_init(void);
-void * dbpf_aligned_block_get(void);
-int dbpf_aligned_block_put(void *ptr);
-int dbpf_aligned_blocks_finalize(void);
-#endif
-
 /**
  * Perform an write in direct mode (no buffering).
  *
@@ -249,14 +274,16 @@ static size_t direct_aligned_write(int fd,
 gen_mutex_t writes_lock = GEN_MUTEX_INITIALIZER; */
 
 static size_t direct_locked_write(int fd,
+                            struct dbpf_bstream_size *size_rec,
                             void * buf,
                             off_t buf_offset,
                             size_t size,
-                            off_t write_offset,
-                            off_t stream_size)
+                            off_t write_offset)
 {
     struct flock writelock;
     int ret, write_ret;
+    int first_lock = -1, last_lock = -1;
+    off_t end_offset = write_offset + size;
 /*	struct timeval start, end; */
 
     writelock.l_type = F_WRLCK;
@@ -271,156 +298,66 @@ static size_t direct_locked_write(int fd,
     }
     writelock.l_type = F_UNLCK;
 
-    write_ret = direct_write(
-        fd, buf, buf_offset, size, write_offset, stream_size);
-
-    ret = fcntl(fd, F_SETLK, &writelock);
-    if (ret < 0)
+    /* a partial block at either end is read-modify-written below, based
+     * on the size of the bstream.  Hold its block lock from before the
+     * size is read until the size has been raised past this write, so
+     * another write into the same block sees our data.
+     */
+    if(ALIGNED_OFFSET(write_offset) != write_offset)
     {
-        gossip_err("%s: failed to unlock flock after writing\n", __func__);
-        return -trove_errno_to_trove_error (errno);
+        first_lock = (size_rec->ref.handle + write_offset / BLOCK_SIZE) %
+            DBPF_BSTREAM_BLOCK_LOCKS;
     }
-
-#if 0
-    if(write_ret > 0)
+    if(ALIGNED_OFFSET(end_offset) != end_offset)
     {
-        if((write_offset + size) > stream_size)
-	{
-            ret = ftruncate(fd, (write_offset + size));
-	    if(ret < 0)
-	    {
-		gossip_err("failed ftruncate of O_DIRECT fd to size: %d\n",
-			   (write_offset + size));
-		return -trove_errno_to_trove_error(errno);
-	    }
-	}
+        last_lock = (size_rec->ref.handle + end_offset / BLOCK_SIZE) %
+            DBPF_BSTREAM_BLOCK_LOCKS;
+        if(last_lock == first_lock)
+        {
+            last_lock = -1;
+        }
+        else if(last_lock < first_lock)
+        {
+            int tmp = first_lock;
+            first_lock = last_lock;
+            last_lock = tmp;
+        }
     }
-#endif
-
-    return write_ret;
-}
-
-#if 0
-static size_t new_direct_write(int fd,
-                               void * buf,
-                               off_t buf_offset,
-                               size_t size,
-                               off_t write_offset,
-                               off_t stream_size)
-{
-    size_t ret;
-    void *aligned_buf;
-    size_t aligned_size;
-    off_t aligned_offset, end_offset, aligned_end_offset;
-
-    aligned_size = ALIGNED_SIZE(write_offset, size);
-    aligned_offset = ALIGNED_OFFSET(write_offset);
-
-    /* if the buffer passed in, the offsets, and the size are all
-     * aligned properly, just pass through directly
-     */
-    if(IS_ALIGNED_PTR(buf) && 
-       ALIGNED_OFFSET(buf_offset) == buf_offset &&
-       aligned_size == size)
+    if(first_lock >= 0)
     {
-        return direct_aligned_write(fd, buf, buf_offset,
-                                   size, write_offset, stream_size);
+        gen_mutex_lock(&block_locks[first_lock]);
     }
-
-    gossip_debug(GOSSIP_DIRECTIO_DEBUG, 
-                 "requested write is not aligned, doing memcpy:\n\t"
-                 "buf: %p, "
-                 "buf_offset: %llu, "
-                 "size: %zu, \n\t"
-                 "write_offset: %llu, "
-                 "stream_size: %zu\n",
-                 buf, 
-                 llu(buf_offset), 
-                 size,
-                 llu(write_offset),
-                 stream_size);
-
-    aligned_buf = dbpf_aligned_block_get();
-    if(!aligned_buf)
+    if(last_lock >= 0)
     {
-        return -ENOMEM;
+        gen_mutex_lock(&block_locks[last_lock]);
     }
 
-    /* Do read-modify-write on the ends of the buffer if
-     * the offsets and sizes aren't aligned properly
-     */
-    if(aligned_offset < write_offset)
+    write_ret = direct_write(
+        fd, buf, buf_offset, size, write_offset,
+        __atomic_load_n(&size_rec->size, __ATOMIC_ACQUIRE));
+    if(write_ret > 0)
     {
-        ret = 0;
-        if(ALIGNED_SIZE(0, stream_size) > aligned_offset)
-        {
-            gossip_debug(GOSSIP_DIRECTIO_DEBUG, "Doing RMW at front\n");
-            /* read the first block */
-            ret = dbpf_pread(fd, aligned_buf, BLOCK_SIZE, aligned_offset);
-            if(ret < 0)
-            {
-                int pread_errno = errno;
-                gossip_err(
-                    "direct_memcpy_write: RMW failed at "
-                    "beginning of request\n");
-		dbpf_aligned_block_put(aligned_buf);
-
-                return -trove_errno_to_trove_error(pread_errno);
-            }
-        }
-        else
-        {
-            memset(aligned_buf, 0, BLOCK_SIZE);
-        }
-
-        memcpy(((char *)buf) - (write_offset - aligned_offset),
-               aligned_buf, (write_offset - aligned_offset));
+        bstream_size_extend(size_rec, write_offset + write_ret);
     }
 
-    end_offset = write_offset + size;
-    aligned_end_offset = aligned_offset + aligned_size;
-
-    if(aligned_end_offset > end_offset)
+    if(last_lock >= 0)
     {
-        ret = 0;
-        if(ALIGNED_SIZE(0, stream_size) >= aligned_end_offset)
-        {
-            gossip_debug(GOSSIP_DIRECTIO_DEBUG, "Doing RMW at end\n");
-            ret = dbpf_pread(fd,
-                             aligned_buf,
-                             BLOCK_SIZE,
-                             aligned_end_offset - BLOCK_SIZE);
-            if(ret < 0)
-            {
-                int pread_errno = errno;
-                gossip_err(
-                    "direct_memcpy_write: RMW failed at end of request\n");
-                dbpf_aligned_block_put(aligned_buf);
-
-                return -trove_errno_to_trove_error(pread_errno);
-            }
-        }
-        else
-        {
-            memset(aligned_buf, 0, BLOCK_SIZE);
-        }
-
-        memcpy(((char *)buf) + size,
-               ((char *)aligned_buf) + (end_offset % BLOCK_SIZE),
-               (aligned_end_offset - end_offset));
+        gen_mutex_unlock(&block_locks[last_lock]);
+    }
+    if(first_lock >= 0)
+    {
+        gen_mutex_unlock(&block_locks[first_lock]);
     }
 
-    ret = direct_aligned_write(
-        fd,
-        ((char *)buf) - (write_offset - aligned_offset), 0,
-        aligned_size, aligned_offset, stream_size);
-
-    dbpf_aligned_block_put(aligned_buf);
+    ret = fcntl(fd, F_SETLK, &writelock);
+    if (ret < 0)
+    {
+        gossip_err("%s: failed to unlock flock after writing\n", __func__);
+        return -trove_errno_to_trove_error (errno);
+    }
 
-    return size;
+    return write_ret;
 }
-#endif
-
 static size_t direct_write(int fd,
                            void * buf,
                            off_t buf_offset,
@@ -460,8 +397,7 @@ static size_t direct_write(int fd,
                  llu(write_offset),
                  llu(stream_size));
 
-    /* aligned_buf = PINT_mem_aligned_alloc(aligned_size, BLOCK_SIZE); */
-    posix_memalign(&aligned_buf, BLOCK_SIZE, aligned_size);
+    aligned_buf = PINT_mem_pool_alloc(aligned_size);
     if(!aligned_buf)
     {
         return -ENOMEM;
@@ -484,8 +420,7 @@ static size_t direct_write(int fd,
                 gossip_err(
                     "direct_memcpy_write: RMW failed at "
                     "beginning of request\n");
-                /* PINT_mem_aligned_free(aligned_buf); */
-                free(aligned_buf);
+                PINT_mem_pool_free(aligned_buf);
 
                 return -trove_errno_to_trove_error(pread_errno);
             }
@@ -515,8 +450,7 @@ static size_t direct_write(int fd,
                 int pread_errno = errno;
                 gossip_err(
                     "direct_memcpy_write: RMW failed at end of request\n");
-                /* PINT_mem_aligned_free(aligned_buf); */
-                free(aligned_buf);
+                PINT_mem_pool_free(aligned_buf);
 
                 return -trove_errno_to_trove_error(pread_errno);
             }
@@ -537,8 +471,7 @@ static size_t direct_write(int fd,
     ret = direct_aligned_write(fd, aligned_buf, 0,
                                 aligned_size, aligned_offset, stream_size);
 
-    /* PINT_mem_aligned_free(aligned_buf); */
-    free(aligned_buf);
+    PINT_mem_pool_free(aligned_buf);
 
     return (ret < 0) ? ret : size;
 }
@@ -680,8 +613,7 @@ static size_t direct_read(int fd,
                                    file_offset, stream_size);
     }
 
-    /* aligned_buf = PINT_mem_aligned_alloc(aligned_size, BLOCK_SIZE); */
-    posix_memalign(&aligned_buf, BLOCK_SIZE, aligned_size);
+    aligned_buf = PINT_mem_pool_alloc(aligned_size);
     if(!aligned_buf)
     {
         return -ENOMEM;
@@ -691,8 +623,7 @@ static size_t direct_read(int fd,
                                aligned_offset, stream_size);
     if(ret < 0)
     {
-        /* PINT_mem_aligned_free(aligned_buf); */
-        free(aligned_buf);
+        PINT_mem_pool_free(aligned_buf);
 
         return ret;
     }
@@ -701,8 +632,7 @@ static size_t direct_read(int fd,
            ((char *)aligned_buf) + (file_offset - aligned_offset),
            read_size);
 
-    /* PINT_mem_aligned_free(aligned_buf); */
-    free(aligned_buf);
+    PINT_mem_pool_free(aligned_buf);
 
     return ret;
 }
@@ -711,7 +641,8 @@ static int dbpf_bstream_direct_read_op_svc(void *ptr, PVFS_hint hint)
 {
     int ret = -TROVE_EINVAL;
     TROVE_object_ref ref;
-    TROVE_ds_attributes attr;
+    struct dbpf_bstream_size *size_rec = NULL;
+    PVFS_size stream_size;
     dbpf_queued_op_t *qop_p;
     struct dbpf_bstream_rw_list_op *rw_op;
     dbpf_stream_extents_t *stream_extents = NULL;
@@ -723,14 +654,14 @@ static int dbpf_bstream_direct_read_op_svc(void *ptr, PVFS_hint hint)
     ref.fs_id = qop_p->op.coll_p->coll_id;
     ref.handle = qop_p->op.handle;
 
-    /* not in attribute cache.  get the size from dspace */
-    ret = dbpf_dspace_attr_get(qop_p->op.coll_p, ref, &attr);
+    ret = bstream_size_get(qop_p->op.coll_p, ref, &size_rec);
     if(ret != 0)
     {
-        gossip_err("%s: failed to get size in dspace attr: (error=%d)\n", 
+        gossip_err("%s: failed to get bstream size: (error=%d)\n",
                    __func__, ret);
         goto done;
     }
+    stream_size = __atomic_load_n(&size_rec->size, __ATOMIC_ACQUIRE);
 
     ret = dbpf_bstream_get_extents(
         rw_op->mem_offset_array,
@@ -777,7 +708,7 @@ static int dbpf_bstream_direct_read_op_svc(void *ptr, PVFS_hint hint)
                           0,
                           stream_extents[i].size,
                           stream_extents[i].offset,
-                          attr.u.datafile.b_size);
+                          stream_size);
         if(ret < 0)
         {
             ret = -trove_errno_to_trove_error(-ret);
@@ -790,6 +721,10 @@ static int dbpf_bstream_direct_read_op_svc(void *ptr, PVFS_hint hint)
     ret = DBPF_OP_COMPLETE;
 
 done:
+    if(size_rec)
+    {
+        bstream_size_put(size_rec);
+    }
     if(stream_extents)
     {
         free(stream_extents);
@@ -802,13 +737,12 @@ static int dbpf_bstream_direct_write_op_svc(void *ptr, PVFS_hint hint)
 {
     int ret = -TROVE_EINVAL;
     TROVE_object_ref ref;
-    TROVE_ds_attributes attr;
+    struct dbpf_bstream_size *size_rec = NULL;
     dbpf_stream_extents_t *stream_extents = NULL;
     int i, extent_count;
     struct dbpf_bstream_rw_list_op *rw_op;
     dbpf_queued_op_t *qop_p;
-    PVFS_size eor = -1;
-    int sync_required = 0;
+    PVFS_size end, eor = 0, unaligned_eor = 0;
 
     rw_op = (struct dbpf_bstream_rw_list_op *)ptr;
     qop_p = (dbpf_queued_op_t *)rw_op->queued_op_ptr;
@@ -855,171 +789,82 @@ static int dbpf_bstream_direct_write_op_svc(void *ptr, PVFS_hint hint)
         goto cache_put;
     }
 
-    if( grow_bstream_table == NULL )
-    {
-        ret = grow_bstream_handle_table_init( 1021 );
-        if( ret != 0 )
-        {
-            gossip_err("%s: failed to create grow_bstream_handle_table\n",
-                       __func__);
-            goto cache_put;
-        }
-    } 
-
-    /* acquire a lock on this handle prior to getting the size to prevent
-     * a race condition between multiple writes getting the wrong size */
-    grow_bstream_handle_acquire_lock( ref );
-
-    ret = dbpf_dspace_attr_get(qop_p->op.coll_p, ref, &attr);
+    /* writes that extend the bstream raise its in-memory size as they
+     * go; the dspace attributes catch up later (see bstream_size_store) */
+    ret = bstream_size_get(qop_p->op.coll_p, ref, &size_rec);
     if(ret != 0)
     {
-        gossip_err("%s: failed to get dspace attr for bstream: (error=%d)\n",
+        gossip_err("%s: failed to get bstream size: (error=%d)\n",
                     __func__, ret);
-        grow_bstream_handle_release_lock( ref );
         goto cache_put;
     }
 
-    /* prior to writes see if we are growing the file, if not, release the
-     * lock for growing file size since we won't be updating the file size
-     * below */
     for(i = 0; i < extent_count; ++ i)
     {
-        if(eor < stream_extents[i].offset + stream_extents[i].size)
+        end = stream_extents[i].offset + stream_extents[i].size;
+        if(end > eor)
         {
-            eor = stream_extents[i].offset + stream_extents[i].size;
+            eor = end;
+        }
+        if(ALIGNED_OFFSET(end) != end && end > unaligned_eor)
+        {
+            unaligned_eor = end;
         }
     }
-    if(eor <= attr.u.datafile.b_size)
+
+    /* the last block of a write ending inside it goes out padded, so
+     * its end is stored first.  The dspace db flushes asynchronously, so
+     * unless a synced size already reaches into that block (recovery
+     * trusts st_size only past the block of the stored size), the store
+     * is synced before the padding can reach the disk; sequential
+     * appends pay that once per block. */
+    if(unaligned_eor > 0)
     {
-        /* file size is not growing so we do not need to hold the lock
-         * since we won't update the size attribute below */
-        grow_bstream_handle_release_lock( ref );
+        ret = bstream_size_store_eor(
+            size_rec, unaligned_eor,
+            ALIGNED_SIZE(0, unaligned_eor) - BLOCK_SIZE + 1);
+        if(ret < 0)
+        {
+            goto cache_put;
+        }
     }
-    
+
     *rw_op->out_size_p = 0;
 
     for(i = 0; i < extent_count; ++ i)
     {
         ret = direct_locked_write(rw_op->open_ref.fd,
+                                  size_rec,
                                   stream_extents[i].buffer,
                                   0,
                                   stream_extents[i].size,
-                                  stream_extents[i].offset,
-                                  attr.u.datafile.b_size);
+                                  stream_extents[i].offset);
         if(ret < 0)
         {
             gossip_err("%s: failed to perform direct locked write: "
                        "(error=%d)\n", __func__, ret);
-            if(eor > attr.u.datafile.b_size)
-            {
-                grow_bstream_handle_release_lock( ref );
-            }
             goto cache_put;
         }
-        /* did this calculation above
-         * if(eor < stream_extents[i].offset + stream_extents[i].size)
-         * {
-         *    eor = stream_extents[i].offset + stream_extents[i].size;
-         * }
-         */
         *rw_op->out_size_p += ret;
     }
 
-    if(eor > attr.u.datafile.b_size)
+    if(qop_p->op.flags & TROVE_SYNC)
     {
-        int outcount;
-
-        gen_mutex_lock(&dbpf_update_size_lock);
-        ret = dbpf_dspace_attr_get(qop_p->op.coll_p, ref, &attr);
-        if(ret != 0)
+        ret = bstream_size_store_eor(size_rec, eor, eor);
+        if(ret < 0)
         {
-            gossip_err("%s: failed to get size from dspace attr: (error=%d)\n",
-                       __func__, ret);
-            gen_mutex_unlock(&dbpf_update_size_lock);
-            grow_bstream_handle_release_lock( ref );
             goto cache_put;
         }
-
-        if(eor > attr.u.datafile.b_size)
-        {
-            /* set the size of the file */
-            attr.u.datafile.b_size = eor;
-            ret = dbpf_dspace_attr_set(qop_p->op.coll_p, ref, &attr);
-            if(ret != 0)
-            {
-                gossip_err("%s: failed to update size in dspace attr: "
-                           "(error=%d)\n", __func__, ret);
-                gen_mutex_unlock(&dbpf_update_size_lock);
-                grow_bstream_handle_release_lock( ref );
-                goto cache_put;
-            }
-            sync_required = 1;
-        }
-        gen_mutex_unlock(&dbpf_update_size_lock);
-
-        if(sync_required == 1)
-        {
-            gossip_debug(GOSSIP_DIRECTIO_DEBUG, 
-                "directio updating size for handle %llu\n", llu(ref.handle));
-
-            dbpf_open_cache_put(&rw_op->open_ref);
-
-            /* If we updated the size, then convert cur_op into a setattr.
-             * Note that we are not actually going to perform a setattr.
-             * We just want the coalescing path to treat it like a setattr
-             * so that the size update is synced before we complete.
-             */
-            dbpf_queued_op_init(qop_p,
-                                DSPACE_SETATTR,
-                                ref.handle,
-                                qop_p->op.coll_p,
-                                dbpf_dspace_setattr_op_svc,
-                                qop_p->op.user_ptr,
-                                TROVE_SYNC,
-                                qop_p->op.context_id);
-            qop_p->op.state = OP_IN_SERVICE;
-            ret = dbpf_sync_coalesce(qop_p, 0, &outcount);
-            if(ret < 0)
-            {
-                gossip_err("%s: failed to coalesce size update in dspace "
-                           "attr: (error=%d)\n", __func__, ret);
-                grow_bstream_handle_release_lock( ref );
-                goto done;
-            }
-
-            ret = grow_bstream_handle_release_lock( ref );
-            if( ret != 0 )
-            {
-                gossip_debug(GOSSIP_DIRECTIO_DEBUG, "%s: failed to release "
-                             "grow_bstream_handle lock when not updating "
-                             "file size\n", __func__ );
-            }
-
-            ret = PINT_MGMT_OP_CONTINUE;
-            goto done;
-        }
-        else
-        {
-            /* still need to release the lock even thought we didn't update
-             * the size because the size calc prior to doing the writes told
-             * use we would */
-            ret = grow_bstream_handle_release_lock( ref );
-            if( ret != 0 )
-            {
-                gossip_debug(GOSSIP_DIRECTIO_DEBUG, "%s: failed to release "
-                             "grow_bstream_handle lock when not updating "
-                             "file size\n", __func__ );
-            }
-        }
     }
-    /* if we don't try to update the size then we already released the 
-     * handle grow lock above */
 
-   ret = PINT_MGMT_OP_COMPLETED;
+    ret = PINT_MGMT_OP_COMPLETED;
 
 cache_put:
+    if(size_rec)
+    {
+        bstream_size_put(size_rec);
+    }
     dbpf_open_cache_put(&rw_op->open_ref);
-done:
     if(stream_extents)
     {
         free(stream_extents);
@@ -1231,17 +1076,28 @@ static int dbpf_bstream_direct_resize_op_svc(struct dbpf_op *op_p)
     TROVE_object_ref ref;
     dbpf_queued_op_t *q_op_p;
     struct open_cache_ref open_ref;
+    struct dbpf_bstream_size *size_rec;
     PVFS_size tmpsize;
 
     q_op_p = (dbpf_queued_op_t *)op_p->u.b_resize.queued_op_ptr;
     ref.fs_id = op_p->coll_p->coll_id;
     ref.handle = op_p->handle;
 
-    gen_mutex_lock(&dbpf_update_size_lock);
+    ret = bstream_size_get(op_p->coll_p, ref, &size_rec);
+    if(ret != 0)
+    {
+        return ret;
+    }
+
+    /* a resize may shrink the bstream, so it replaces the in-memory size
+     * outright and stores it right away rather than leaving it to the
+     * write back */
+    gen_mutex_lock(&size_rec->store_mutex);
     ret = dbpf_dspace_attr_get(op_p->coll_p, ref, &attr);
     if(ret != 0)
     {
-        gen_mutex_unlock(&dbpf_update_size_lock);
+        gen_mutex_unlock(&size_rec->store_mutex);
+        bstream_size_put(size_rec);
         return ret;
     }
 
@@ -1251,10 +1107,18 @@ static int dbpf_bstream_direct_resize_op_svc(struct dbpf_op *op_p)
     ret = dbpf_dspace_attr_set(op_p->coll_p, ref, &attr);
     if(ret < 0)
     {
-        gen_mutex_unlock(&dbpf_update_size_lock);
+        gen_mutex_unlock(&size_rec->store_mutex);
+        bstream_size_put(size_rec);
         return ret;
     }
-    gen_mutex_unlock(&dbpf_update_size_lock);
+    __atomic_store_n(&size_rec->size, tmpsize, __ATOMIC_RELEASE);
+    size_rec->stored_size = tmpsize;
+    if(size_rec->synced_size > tmpsize)
+    {
+        size_rec->synced_size = tmpsize;
+    }
+    gen_mutex_unlock(&size_rec->store_mutex);
+    bstream_size_put(size_rec);
 
     /* setup op for sync coalescing */
     dbpf_queued_op_init(q_op_p,
@@ -1343,6 +1207,33 @@ static int dbpf_bstream_direct_validate(TROVE_coll_id coll_id,
     return -TROVE_ENOSYS;
 }
 
+/* writes are not buffered, so all a flush has left to do is make the
+ * bstream size durable */
+static int dbpf_bstream_direct_flush_op_svc(struct dbpf_op *op_p)
+{
+    int ret;
+    TROVE_object_ref ref;
+    struct dbpf_bstream_size *size_rec;
+
+    ref.fs_id = op_p->coll_p->coll_id;
+    ref.handle = op_p->handle;
+
+    ret = bstream_size_get(op_p->coll_p, ref, &size_rec);
+    if(ret != 0)
+    {
+        return ret;
+    }
+
+    ret = bstream_size_store(size_rec, 1);
+    bstream_size_put(size_rec);
+    if(ret < 0)
+    {
+        return ret;
+    }
+
+    return DBPF_OP_COMPLETE;
+}
+
 static int dbpf_bstream_direct_flush(TROVE_coll_id coll_id,
                                      TROVE_handle handle,
                                      TROVE_ds_flags flags,
@@ -1351,7 +1242,33 @@ static int dbpf_bstream_direct_flush(TROVE_coll_id coll_id,
                                      TROVE_op_id *out_op_id_p,
                                      PVFS_hint hints)
 {
-    return DBPF_OP_COMPLETE;
+    dbpf_queued_op_t *q_op_p = NULL;
+    struct dbpf_collection *coll_p = NULL;
+
+    coll_p = dbpf_collection_find_registered(coll_id);
+    if (coll_p == NULL)
+    {
+        return -TROVE_EINVAL;
+    }
+
+    q_op_p = dbpf_queued_op_alloc();
+    if (q_op_p == NULL)
+    {
+        return -TROVE_ENOMEM;
+    }
+
+    dbpf_queued_op_init(q_op_p,
+                        BSTREAM_FLUSH,
+                        handle,
+                        coll_p,
+                        dbpf_bstream_direct_flush_op_svc,
+                        user_ptr,
+                        flags,
+                        context_id);
+    q_op_p->op.hints = hints;
+    *out_op_id_p = dbpf_queued_op_queue(q_op_p);
+
+    return 0;
 }
 
 static int dbpf_bstream_direct_cancel(
@@ -1511,249 +1428,550 @@ static int dbpf_bstream_get_extents(
     return 0;
 }
 
-/* grow_bstream_handle_table_init()
- * 
- * initialize the grow_bstream_table
- *
- * size: prime number of hash table size
- */
-static int grow_bstream_handle_table_init( int size )
+static int bstream_size_compare(const void *key, struct qhash_head *link)
+{
+    const TROVE_object_ref *ref = (const TROVE_object_ref *)key;
+    struct dbpf_bstream_size *rec;
+
+    rec = qhash_entry(link, struct dbpf_bstream_size, hash_link);
+    return (rec->ref.handle == ref->handle && rec->ref.fs_id == ref->fs_id);
+}
+
+static int bstream_size_hash(const void *key, int table_size)
+{
+    const TROVE_object_ref *ref = (const TROVE_object_ref *)key;
+
+    return (int)((ref->handle ^ (uint64_t)ref->fs_id) % table_size);
+}
+
+static struct dbpf_bstream_size_shard *bstream_size_shard(
+    TROVE_object_ref ref)
+{
+    uint64_t h = ((uint64_t)ref.handle ^ ((uint64_t)ref.fs_id << 32)) *
+        0x9e3779b97f4a7c15ULL;
+
+    return &size_shards[(h >> 32) % DBPF_BSTREAM_SIZE_SHARDS];
+}
+
+static void bstream_size_free(struct dbpf_bstream_size *rec)
 {
-    gen_mutex_lock( &grow_bstream_table_lock );
-    if( grow_bstream_table == NULL )
+    gen_mutex_destroy(&rec->store_mutex);
+    free(rec);
+}
+
+/* queues the record for write back unless it already is */
+static void bstream_size_mark_dirty(struct dbpf_bstream_size *rec)
+{
+    struct dbpf_bstream_size_shard *shard;
+    int clean = 0;
+
+    if(!__atomic_compare_exchange_n(&rec->dirty, &clean, 1, 0,
+                                    __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+    {
+        return;
+    }
+
+    shard = bstream_size_shard(rec->ref);
+    gen_mutex_lock(&shard->mutex);
+    if(!rec->on_dirty_list)
+    {
+        /* the dirty list holds a reference */
+        rec->on_dirty_list = 1;
+        rec->refcount++;
+        qlist_add_tail(&rec->dirty_link, &shard->dirty_list);
+        shard->dirty_count++;
+    }
+    gen_mutex_unlock(&shard->mutex);
+}
+
+/* raises the size to eor if that is larger; never lowers it */
+static void bstream_size_extend(struct dbpf_bstream_size *rec,
+                                PVFS_size eor)
+{
+    PVFS_size cur = __atomic_load_n(&rec->size, __ATOMIC_ACQUIRE);
+
+    do
     {
-        grow_bstream_table = qhash_init(hash_handle_compare, hash_handle, size);
-        if( grow_bstream_table == NULL )
+        if(eor <= cur)
         {
-            return -PVFS_ENOMEM;
-        } 
+            return;
+        }
+    } while(!__atomic_compare_exchange_n(&rec->size, &cur, eor, 0,
+                                         __ATOMIC_SEQ_CST, __ATOMIC_ACQUIRE));
+
+    bstream_size_mark_dirty(rec);
+}
+
+/* returns the record with a reference held, or NULL if there is none */
+static struct dbpf_bstream_size *bstream_size_lookup(TROVE_object_ref ref)
+{
+    struct dbpf_bstream_size_shard *shard;
+    struct qhash_head *link;
+    struct dbpf_bstream_size *rec = NULL;
+
+    if(!__atomic_load_n(&size_table_ready, __ATOMIC_ACQUIRE))
+    {
+        return NULL;
     }
-    gen_mutex_unlock( &grow_bstream_table_lock );
-    return 0;
+
+    shard = bstream_size_shard(ref);
+    gen_mutex_lock(&shard->mutex);
+    link = qhash_search(shard->table, &ref);
+    if(link)
+    {
+        rec = qhash_entry(link, struct dbpf_bstream_size, hash_link);
+        rec->refcount++;
+    }
+    gen_mutex_unlock(&shard->mutex);
+    return rec;
 }
 
-/* obtains a per-handle lock by locking an existing entry in the 
- * grow_bstream_table or creating an entry and grabbing the lock.
- * 
- * returns 0 on success and the handle lock held or an error
+/* creates the record for a bstream whose dspace attributes store
+ * stored_size, recovering the size from the bstream on disk if a write
+ * back was lost.  Returns 0 with a reference held on the (possibly
+ * preexisting) record.
  */
-static int grow_bstream_handle_acquire_lock( TROVE_object_ref ref )
+static int bstream_size_load(TROVE_object_ref ref,
+                             PVFS_size stored_size,
+                             struct dbpf_bstream_size **rec_p)
+{
+    struct dbpf_bstream_size_shard *shard;
+    struct dbpf_bstream_size *rec;
+    struct qhash_head *link;
+    char filename[PATH_MAX] = {0};
+    struct stat statbuf;
+    PVFS_size size = stored_size;
+
+    if(!__atomic_load_n(&size_table_ready, __ATOMIC_ACQUIRE))
+    {
+        return -TROVE_EINVAL;
+    }
+
+    DBPF_GET_BSTREAM_FILENAME(filename, PATH_MAX, my_storage_p->data_path,
+                              ref.fs_id, llu(ref.handle));
+    if(stat(filename, &statbuf) == 0 &&
+       statbuf.st_size > (PVFS_size)ALIGNED_SIZE(0, stored_size))
+    {
+        gossip_debug(GOSSIP_DIRECTIO_DEBUG, "%s: recovered size %lld of "
+                     "handle %llu from bstream (stored size %lld)\n",
+                     __func__, lld(statbuf.st_size), llu(ref.handle),
+                     lld(stored_size));
+        size = statbuf.st_size;
+    }
+
+    rec = calloc(1, sizeof(*rec));
+    if(!rec)
+    {
+        return -TROVE_ENOMEM;
+    }
+    rec->ref = ref;
+    rec->size = size;
+    rec->stored_size = stored_size;
+    /* the stored size may still be only in the page cache; the first
+     * store that needs it on disk syncs */
+    rec->synced_size = 0;
+    rec->refcount = 1;
+    gen_mutex_init(&rec->store_mutex);
+
+    shard = bstream_size_shard(ref);
+    gen_mutex_lock(&shard->mutex);
+    link = qhash_search(shard->table, &ref);
+    if(link)
+    {
+        /* lost a race with another loader */
+        bstream_size_free(rec);
+        rec = qhash_entry(link, struct dbpf_bstream_size, hash_link);
+        rec->refcount++;
+        gen_mutex_unlock(&shard->mutex);
+        *rec_p = rec;
+        return 0;
+    }
+    qhash_add(shard->table, &rec->ref, &rec->hash_link);
+    shard->count++;
+    gen_mutex_unlock(&shard->mutex);
+
+    if(size != stored_size)
+    {
+        bstream_size_mark_dirty(rec);
+    }
+
+    *rec_p = rec;
+    return 0;
+}
+
+/* returns the size record of a bstream with a reference held, creating
+ * it from the dspace attributes if needed */
+static int bstream_size_get(struct dbpf_collection *coll_p,
+                            TROVE_object_ref ref,
+                            struct dbpf_bstream_size **rec_p)
 {
-    struct qlist_head *hash_link = NULL;
-    struct grow_bstream_handle *grow_handle = NULL;
+    TROVE_ds_attributes attr;
+    int ret;
 
-    gen_mutex_lock( &grow_bstream_table_lock );
-    if( grow_bstream_table == NULL )
+    *rec_p = bstream_size_lookup(ref);
+    if(*rec_p)
     {
-        gen_mutex_unlock( &grow_bstream_table_lock );
-        return -PVFS_EINVAL;
-    } 
+        return 0;
+    }
 
-    hash_link = qhash_search(grow_bstream_table, &(ref.handle) );
-    if( hash_link )
+    ret = dbpf_dspace_attr_get(coll_p, ref, &attr);
+    if(ret != 0)
     {
-        grow_handle = qlist_entry( hash_link, struct grow_bstream_handle, 
-                                  hash_link);
+        return ret;
     }
-    else
+
+    /* reading the attributes normally created the record already, and
+     * then attr holds its size rather than the stored one.  If it did
+     * not, or the record was dropped again as clean, the two agree. */
+    return bstream_size_load(ref, attr.u.datafile.b_size, rec_p);
+}
+
+static void bstream_size_put(struct dbpf_bstream_size *rec)
+{
+    struct dbpf_bstream_size_shard *shard = bstream_size_shard(rec->ref);
+    int release = 0;
+
+    gen_mutex_lock(&shard->mutex);
+    if(--rec->refcount == 0)
     {
-        grow_handle = calloc( 1, sizeof( struct grow_bstream_handle ));
-        if( grow_handle == NULL )
+        if(__atomic_load_n(&rec->removed, __ATOMIC_ACQUIRE))
+        {
+            release = 1;
+        }
+        else if(shard->count > DBPF_BSTREAM_SIZE_MAX_PER_SHARD &&
+                !__atomic_load_n(&rec->dirty, __ATOMIC_ACQUIRE))
         {
-            gen_mutex_unlock( &grow_bstream_table_lock );
-            gossip_err( "%s: failed to alloc memory\n", __func__);
-            return -PVFS_ENOMEM;
+            /* clean; the dspace attributes have the size */
+            qhash_del(&rec->hash_link);
+            shard->count--;
+            release = 1;
         }
-        grow_handle->handle = ref.handle;
-        gen_mutex_init( &(grow_handle->handle_lock) );
-        gen_mutex_init( &(grow_handle->refcount_lock) );
+    }
+    gen_mutex_unlock(&shard->mutex);
 
-        /* we're safe adding it and waiting on grabbing the lock because
-         * we still have the lock on the table so no one else
-         * should access this new member */
-        qhash_add( grow_bstream_table, &(grow_handle->handle), 
-                   &(grow_handle->hash_link) );
+    if(release)
+    {
+        bstream_size_free(rec);
     }
+}
 
-    /* increment the number of things using the hash member */
-    gen_mutex_lock( &(grow_handle->refcount_lock) );
-    grow_handle->refcount++;
-    gen_mutex_unlock( &(grow_handle->refcount_lock) );
+/* writes the size back to the dspace attributes if it has grown since
+ * the last store, and syncs the dspace db if sync is set.  The stored
+ * size may run ahead of the in-memory one (see bstream_size_store_eor);
+ * only a resize lowers it. */
+static int bstream_size_store(struct dbpf_bstream_size *rec, int sync)
+{
+    struct dbpf_collection *coll_p;
+    TROVE_ds_attributes attr;
+    PVFS_size size;
+    int ret = 0;
 
-    gen_mutex_unlock( &grow_bstream_table_lock );
+    coll_p = dbpf_collection_find_registered(rec->ref.fs_id);
+    if(coll_p == NULL)
+    {
+        return -TROVE_EINVAL;
+    }
 
-    gen_mutex_lock( &(grow_handle->handle_lock));
+    gen_mutex_lock(&rec->store_mutex);
+    if(__atomic_load_n(&rec->removed, __ATOMIC_ACQUIRE))
+    {
+        gen_mutex_unlock(&rec->store_mutex);
+        return 0;
+    }
 
-    return 0;
+    /* clear the flag before reading the size, so that a write raising the
+     * size after the read marks the record dirty again */
+    __atomic_store_n(&rec->dirty, 0, __ATOMIC_SEQ_CST);
+    size = __atomic_load_n(&rec->size, __ATOMIC_SEQ_CST);
+    if(size > rec->stored_size)
+    {
+        ret = dbpf_dspace_attr_get(coll_p, rec->ref, &attr);
+        if(ret == 0)
+        {
+            attr.u.datafile.b_size = size;
+            ret = dbpf_dspace_attr_set(coll_p, rec->ref, &attr);
+        }
+        if(ret == 0)
+        {
+            rec->stored_size = size;
+        }
+        else
+        {
+            gossip_err("%s: failed to store size of handle %llu: "
+                       "(error=%d)\n", __func__, llu(rec->ref.handle), ret);
+        }
+    }
+    if(ret == 0 && sync)
+    {
+        ret = dbpf_db_sync_durable(coll_p->ds_db);
+        if(ret != 0)
+        {
+            ret = -ret;
+        }
+        else
+        {
+            rec->synced_size = rec->stored_size;
+        }
+    }
+    gen_mutex_unlock(&rec->store_mutex);
+
+    return ret;
 }
 
-static int grow_bstream_handle_release_lock( TROVE_object_ref ref )
+/* makes the size in the dspace attributes at least eor before a write
+ * reaching eor goes on, without waiting for the write back, and syncs
+ * the dspace db unless a size of at least sync_to is synced already
+ * (0 never syncs) */
+static int bstream_size_store_eor(struct dbpf_bstream_size *rec,
+                                  PVFS_size eor, PVFS_size sync_to)
 {
-    struct qlist_head *hash_link = NULL;
-    struct grow_bstream_handle *grow_handle = NULL;
-    int rcount = 0;
+    struct dbpf_collection *coll_p;
+    TROVE_ds_attributes attr;
+    int ret = 0;
 
-    gen_mutex_lock( &grow_bstream_table_lock );
-    if( grow_bstream_table == NULL )
+    coll_p = dbpf_collection_find_registered(rec->ref.fs_id);
+    if(coll_p == NULL)
     {
-        gen_mutex_unlock( &grow_bstream_table_lock );
-        return -PVFS_EINVAL;
-    } 
+        return -TROVE_EINVAL;
+    }
 
-    hash_link = qhash_search(grow_bstream_table, &(ref.handle) );
-    if( hash_link )
+    gen_mutex_lock(&rec->store_mutex);
+    if(__atomic_load_n(&rec->removed, __ATOMIC_ACQUIRE))
     {
-        grow_handle = qlist_entry(hash_link, struct grow_bstream_handle, 
-                                  hash_link);
-
-        gen_mutex_lock( &(grow_handle->refcount_lock) );
-        rcount = --grow_handle->refcount;
-        gen_mutex_unlock( &(grow_handle->refcount_lock) );
+        gen_mutex_unlock(&rec->store_mutex);
+        return 0;
+    }
 
-        /* if we're the last reference remove it from the hash and free the
-         * memory. may want to optimize this so we aren't continuously 
-         * alloc/free for each read */
-        if( rcount == 0 )
+    if(eor > rec->stored_size)
+    {
+        ret = dbpf_dspace_attr_get(coll_p, rec->ref, &attr);
+        if(ret == 0)
         {
-            gen_mutex_unlock( &(grow_handle->handle_lock));
-            qhash_del(hash_link);
-            gen_mutex_destroy( &(grow_handle->handle_lock) );
-            gen_mutex_destroy( &(grow_handle->refcount_lock) );
-            free( grow_handle );
+            attr.u.datafile.b_size = eor;
+            ret = dbpf_dspace_attr_set(coll_p, rec->ref, &attr);
+        }
+        if(ret == 0)
+        {
+            rec->stored_size = eor;
         }
         else
         {
-            gen_mutex_unlock( &(grow_handle->handle_lock));
+            gossip_err("%s: failed to store size of handle %llu: "
+                       "(error=%d)\n", __func__, llu(rec->ref.handle), ret);
         }
     }
-    else
+    if(ret == 0 && sync_to > rec->synced_size)
     {
-       /* should have an entry, but if not just report it for debugging */
-       gossip_debug(GOSSIP_DIRECTIO_DEBUG, "%s: no grow_handle entry when "
-                    "trying to remove with refcount %d\n", __func__, rcount);
+        ret = dbpf_db_sync_durable(coll_p->ds_db);
+        if(ret != 0)
+        {
+            ret = -ret;
+        }
+        else
+        {
+            rec->synced_size = rec->stored_size;
+        }
     }
-    gen_mutex_unlock( &grow_bstream_table_lock );
-    return 0;
+    gen_mutex_unlock(&rec->store_mutex);
+
+    return ret;
 }
 
-/* hash_handle()
- *
- * hash function for handles added to table
- * taken from src/server/request-scheduler/request-scheduler.c
- *
- * returns integer offset into table
- */
-static int hash_handle(
-    const void *handle,
-    int table_size)
+/* stores every record that is on a dirty list.  Records dirtied again
+ * while this runs wait for the next pass. */
+static void bstream_size_write_back_dirty(int sync)
 {
-    /* TODO: update this later with a better hash function,
-     * depending on what handles look like, for now just modding
-     *
-     */
-    unsigned long tmp = 0;
-    const PVFS_handle *real_handle = (const PVFS_handle *)handle;
+    struct dbpf_bstream_size_shard *shard;
+    struct dbpf_bstream_size *rec;
+    int i, count;
+
+    for(i = 0; i < DBPF_BSTREAM_SIZE_SHARDS; i++)
+    {
+        shard = &size_shards[i];
 
-    tmp += (*(real_handle));
-    tmp = tmp % table_size;
+        gen_mutex_lock(&shard->mutex);
+        count = shard->dirty_count;
+        gen_mutex_unlock(&shard->mutex);
 
-    return ((int) tmp);
+        while(count-- > 0)
+        {
+            gen_mutex_lock(&shard->mutex);
+            if(qlist_empty(&shard->dirty_list))
+            {
+                gen_mutex_unlock(&shard->mutex);
+                break;
+            }
+            rec = qlist_entry(shard->dirty_list.next,
+                              struct dbpf_bstream_size, dirty_link);
+            qlist_del(&rec->dirty_link);
+            rec->on_dirty_list = 0;
+            shard->dirty_count--;
+            gen_mutex_unlock(&shard->mutex);
+
+            /* the reference the list held is ours now */
+            bstream_size_store(rec, sync);
+            bstream_size_put(rec);
+        }
+    }
 }
 
-/* hash_handle_compare()
- *
- * performs a comparison of a hash table entro to a given key
- * (used for searching)
- * taken from src/server/request-scheduler/request-scheduler.c
- *
- * returns 1 if match found, 0 otherwise
- */
-static int hash_handle_compare(
-    const void *key,
-    struct qlist_head *link)
+int dbpf_bstream_direct_size_initialize(void)
 {
-    struct grow_bstream_handle *my_handle;
-    const PVFS_handle *real_handle = (const PVFS_handle *)key;
+    int i;
 
-    my_handle = qlist_entry(link, struct grow_bstream_handle, hash_link);
-    if (my_handle->handle == *real_handle)
+    if(__atomic_load_n(&size_table_ready, __ATOMIC_ACQUIRE))
+    {
+        return 0;
+    }
+
+    for(i = 0; i < DBPF_BSTREAM_SIZE_SHARDS; i++)
+    {
+        gen_mutex_init(&size_shards[i].mutex);
+        INIT_QLIST_HEAD(&size_shards[i].dirty_list);
+        size_shards[i].dirty_count = 0;
+        size_shards[i].count = 0;
+        size_shards[i].table = qhash_init(bstream_size_compare,
+                                          bstream_size_hash,
+                                          DBPF_BSTREAM_SIZE_TABLE_SIZE);
+        if(size_shards[i].table == NULL)
+        {
+            while(--i >= 0)
+            {
+                qhash_finalize(size_shards[i].table);
+                size_shards[i].table = NULL;
+            }
+            return -TROVE_ENOMEM;
+        }
+    }
+    for(i = 0; i < DBPF_BSTREAM_BLOCK_LOCKS; i++)
     {
-        return (1);
+        gen_mutex_init(&block_locks[i]);
     }
 
-    return (0);
+    size_last_persist_ms = 0;
+    __atomic_store_n(&size_table_ready, 1, __ATOMIC_RELEASE);
+    return 0;
 }
 
-#if 0
-int dbpf_aligned_blocks_init(void)
+void dbpf_bstream_direct_size_finalize(void)
 {
+    struct qhash_table *table;
     int i;
 
-    aligned_blocks_buffer = PINT_mem_aligned_alloc(BLOCK_SIZE*256, BLOCK_SIZE);
-    blocks = malloc(sizeof(*blocks) * 256);
-    used_count = 0;
-    gen_mutex_lock(&aligned_blocks_mutex);
-    for(i = 0; i < 256; ++i)
+    gen_mutex_lock(&size_persist_mutex);
+    if(!size_table_ready)
     {
-        blocks[i].ptr = ((char *)aligned_blocks_buffer) + (i*BLOCK_SIZE);
-        qlist_add_tail(&(blocks[i].link), &aligned_blocks_unused);
+        gen_mutex_unlock(&size_persist_mutex);
+        return;
     }
-    gen_mutex_unlock(&aligned_blocks_mutex);
-    return 0;
+
+    bstream_size_write_back_dirty(1);
+    __atomic_store_n(&size_table_ready, 0, __ATOMIC_RELEASE);
+
+    for(i = 0; i < DBPF_BSTREAM_SIZE_SHARDS; i++)
+    {
+        /* the macro has its own i */
+        table = size_shards[i].table;
+        qhash_destroy_and_finalize(table, struct dbpf_bstream_size,
+                                   hash_link, bstream_size_free);
+        size_shards[i].table = NULL;
+    }
+    gen_mutex_unlock(&size_persist_mutex);
 }
 
-int dbpf_aligned_blocks_finalize(void)
+/* called from the dbpf thread loop; writes dirty sizes back once every
+ * DBPF_BSTREAM_SIZE_PERSIST_MSECS */
+void dbpf_bstream_direct_size_write_back(void)
 {
-    free(blocks);
-    PINT_mem_aligned_free(aligned_blocks_buffer);
-    return 0;
+    struct timeval now;
+    uint64_t now_ms;
+
+    if(!__atomic_load_n(&size_table_ready, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    gettimeofday(&now, NULL);
+    now_ms = (uint64_t)now.tv_sec * 1000 + now.tv_usec / 1000;
+    if(now_ms - size_last_persist_ms < DBPF_BSTREAM_SIZE_PERSIST_MSECS)
+    {
+        return;
+    }
+    size_last_persist_ms = now_ms;
+
+    gen_mutex_lock(&size_persist_mutex);
+    if(size_table_ready)
+    {
+        bstream_size_write_back_dirty(0);
+    }
+    gen_mutex_unlock(&size_persist_mutex);
 }
 
-void *dbpf_aligned_block_get(void)
+/* replaces the bstream size in datafile attributes with the in-memory
+ * size.  from_disk is set when attr was just read from the dspace db, in
+ * which case a missing record is created.
+ */
+void dbpf_bstream_direct_size_fixup(TROVE_object_ref ref,
+                                    TROVE_ds_attributes *attr,
+                                    int from_disk)
 {
-    void *ptr;
-    struct aligned_block *ablock;
-    gen_mutex_lock(&aligned_blocks_mutex);
-    if(used_count > 255)
-    {
-        gossip_debug(GOSSIP_DIRECTIO_DEBUG, "ran out of aligned blocks: %d\n",
-                     used_count);
-        gen_mutex_unlock(&aligned_blocks_mutex);
-        return NULL;
+    struct dbpf_bstream_size *rec;
+
+    if(attr->type != PVFS_TYPE_DATAFILE ||
+       !__atomic_load_n(&size_table_ready, __ATOMIC_ACQUIRE))
+    {
+        return;
     }
-    if(qlist_empty(&aligned_blocks_unused))
+
+    rec = bstream_size_lookup(ref);
+    if(!rec)
     {
-	gossip_debug(GOSSIP_DIRECTIO_DEBUG,
-                     "aligned_block_get: unused list empty.\n");
-        gen_mutex_unlock(&aligned_blocks_mutex);
-        return NULL;
+        if(!from_disk ||
+           global_trove_method_callback(ref.fs_id) !=
+               TROVE_METHOD_DBPF_DIRECTIO ||
+           bstream_size_load(ref, attr->u.datafile.b_size, &rec) != 0)
+        {
+            return;
+        }
     }
 
-    ablock = qlist_entry(aligned_blocks_unused.next, struct aligned_block, 
-                         link);
-    qlist_del(&ablock->link);
-    ptr = ablock->ptr;
-    ablock->ptr = NULL;
-    qlist_add_tail(&ablock->link, &aligned_blocks_used);
-    ++used_count;
-    gen_mutex_unlock(&aligned_blocks_mutex);
-    return ptr;
+    attr->u.datafile.b_size = __atomic_load_n(&rec->size, __ATOMIC_ACQUIRE);
+    bstream_size_put(rec);
 }
 
-int dbpf_aligned_block_put(void *ptr)
+/* drops the record of a handle being removed.  Returns once any write
+ * back of it in progress is done, so it cannot recreate the dspace entry.
+ */
+void dbpf_bstream_direct_size_forget(TROVE_object_ref ref)
 {
-    struct aligned_block *ablock;
-
-    gen_mutex_lock(&aligned_blocks_mutex);
-    ablock = qlist_entry(aligned_blocks_used.next, struct aligned_block, link);
-    qlist_del(&ablock->link);
-    ablock->ptr = ptr;
-    qlist_add_tail((&(ablock->link)), &aligned_blocks_unused);
-    --used_count;
-    gen_mutex_unlock(&aligned_blocks_mutex);
-    return 0;
+    struct dbpf_bstream_size_shard *shard;
+    struct dbpf_bstream_size *rec;
+    struct qhash_head *link;
+
+    if(!__atomic_load_n(&size_table_ready, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    shard = bstream_size_shard(ref);
+    gen_mutex_lock(&shard->mutex);
+    link = qhash_search(shard->table, &ref);
+    if(!link)
+    {
+        gen_mutex_unlock(&shard->mutex);
+        return;
+    }
+    rec = qhash_entry(link, struct dbpf_bstream_size, hash_link);
+    qhash_del(link);
+    shard->count--;
+    __atomic_store_n(&rec->removed, 1, __ATOMIC_RELEASE);
+    rec->refcount++;
+    gen_mutex_unlock(&shard->mutex);
+
+    gen_mutex_lock(&rec->store_mutex);
+    gen_mutex_unlock(&rec->store_mutex);
+    bstream_size_put(rec);
 }
-#endif
 
 /*
  * Local variables:
@@ -10,7 +10,14 @@
 #include "pvfs2-internal.h"
 #include "trove-types.h"
 
-int dbpf_bstream_direct_read_op_svc(void *ptr, TROVE_hint *hints);
-int dbpf_bstream_direct_write_op_svc(void *ptr, TROVE_hint *hints);
+/* in-memory bstream sizes of the direct I/O method; see
+ * dbpf-bstream-direct.c */
+int dbpf_bstream_direct_size_initialize(void);
+void dbpf_bstream_direct_size_finalize(void);
+void dbpf_bstream_direct_size_write_back(void);
+void dbpf_bstream_direct_size_fixup(TROVE_object_ref ref,
+                                    TROVE_ds_attributes *attr,
+                                    int from_disk);
+void dbpf_bstream_direct_size_forget(TROVE_object_ref ref);
 
 #endif
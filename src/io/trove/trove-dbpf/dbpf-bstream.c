@@ -30,7 +30,6 @@
 
 #include "dbpf-alt-aio.h"
 
-extern gen_mutex_t dbpf_attr_cache_mutex;
 
 #define AIOCB_ARRAY_SZ 64
 
@@ -881,9 +880,7 @@ inline int dbpf_bstream_rw_list(TROVE_coll_id coll_id,
     if (opcode == LIO_WRITE)
     {
         TROVE_object_ref ref = {handle, coll_id};
-        gen_mutex_lock(&dbpf_attr_cache_mutex);
         dbpf_attr_cache_remove(ref);
-        gen_mutex_unlock(&dbpf_attr_cache_mutex);
     }
 
 #ifndef __PVFS2_TROVE_AIO_THREADED__
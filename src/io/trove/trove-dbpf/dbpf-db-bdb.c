@@ -179,6 +179,35 @@ int dbpf_db_sync(struct dbpf_db *db)
     return db_error(db->db->sync(db->db, 0));
 }
 
+int dbpf_db_sync_durable(struct dbpf_db *db)
+{
+    /* DB->sync already writes through to disk */
+    return dbpf_db_sync(db);
+}
+
+/* Berkeley DB writes are not batched. */
+void dbpf_db_batch_begin(void (*lost)(void *, int))
+{
+}
+
+void dbpf_db_batch_tag(void *tag)
+{
+}
+
+int dbpf_db_batch_pending(void)
+{
+    return 0;
+}
+
+int dbpf_db_batch_flush(int all)
+{
+    return 0;
+}
+
+void dbpf_db_batch_end(void)
+{
+}
+
 int dbpf_db_get(struct dbpf_db *db, struct dbpf_data *key,
     struct dbpf_data *val)
 {
@@ -5,6 +5,7 @@
  */
 
 #include <errno.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <sys/stat.h>
 
@@ -13,21 +14,105 @@
 #include <lmdb.h>
 
 #include "dbpf.h"
+#include "pint-util.h"
 
 #include "server-config.h"
 
 extern filesystem_configuration_s *cfg_fs;
 
+/* Group commit.
+ *
+ * Committing an LMDB write transaction copies every page it touched and
+ * rewrites the meta page, so a transaction per put or delete costs far
+ * more than the update itself.  The keyval database instead lets the
+ * dbpf service thread (see dbpf_db_batch_begin()) batch its writes: the
+ * first write opens a transaction that the following writes of all the
+ * ops it services join, and the batch is committed when it holds
+ * DBPF_DB_BATCH_OPS writes or DBPF_DB_BATCH_BYTES of keys and values,
+ * when it is DBPF_DB_BATCH_USECS old, when the thread runs out of
+ * queued ops, before a read-only cursor is opened, and in
+ * dbpf_db_sync().  The last means that ops held back by the sync
+ * coalescing for TroveSyncMeta still complete only after their writes
+ * are committed and synced.  Gets on the service thread read through
+ * the open batch so they see its writes.
+ *
+ * An LMDB write transaction belongs to the thread that began it, so no
+ * other thread joins a batch.  One that needs the database while a
+ * batch is open asks for the batch to be committed and waits for it.
+ * The dspace database is not batched because the I/O threads update
+ * sizes in it while holding locks the service thread may also take.
+ *
+ * The service thread holds back the ops it finishes while a batch has
+ * writes that are not committed, and completes them once it is.  Each
+ * write is kept in the batch's redo list, tagged with the op that made
+ * it (see dbpf_db_batch_tag()).  If a later write fails in a way that
+ * leaves the transaction unusable (the map filling up) the batch is
+ * aborted and redone without it, and if the commit fails the writes are
+ * retried a transaction apiece.  A write that still cannot be committed
+ * is reported to the thread with its tag, so that its op completes with
+ * the error.
+ *
+ * Gets outside a batch use a read-only transaction kept per thread and
+ * per database, reset after each get and renewed for the next instead
+ * of being created and destroyed every time.
+ */
+#define DBPF_DB_BATCH_OPS 256
+#define DBPF_DB_BATCH_BYTES (1024 * 1024)
+#define DBPF_DB_BATCH_USECS 10000
+
+struct dbpf_db_redo {
+    struct dbpf_db_redo *next;
+    void *tag;
+    int del;
+    unsigned int flags;
+    size_t key_len;
+    size_t data_len;
+    /* key followed by data */
+};
+
+struct dbpf_db_reader {
+    MDB_txn *txn;
+    struct dbpf_db *db;
+    struct dbpf_db_reader *next;
+};
+
 struct dbpf_db {
     MDB_env *env;
     MDB_dbi dbi;
+    int batching;
+
+    /* protects the batch and the readers list */
+    gen_mutex_t mutex;
+    pthread_cond_t flushed;
+    MDB_txn *batch;
+    int batch_ops;
+    size_t batch_bytes;
+    PVFS_time batch_start;
+    int batch_cursors;
+    int flush_wanted;
+    struct dbpf_db_redo *redo;
+    struct dbpf_db_redo **redo_tail;
+
+    pthread_key_t reader_key;
+    struct dbpf_db_reader *readers;
+
+    struct dbpf_db *next_batching;
 };
 
 struct dbpf_cursor {
     MDB_cursor *cursor;
     MDB_txn *txn;
+    struct dbpf_db *db;
+    int batched;
 };
 
+static gen_mutex_t batching_dbs_mutex = GEN_MUTEX_INITIALIZER;
+static struct dbpf_db *batching_dbs = NULL;
+static pthread_t batch_thread;
+static int batch_thread_active = 0;
+static void (*batch_lost)(void *, int);
+static void *batch_tag;
+
 static int db_error(int e)
 {
     /* values greater than zero are errno values */
@@ -55,6 +140,434 @@ static int db_error(int e)
     return DBPF_ERROR_UNKNOWN;
 }
 
+static int batch_owner(void)
+{
+    return batch_thread_active && pthread_equal(batch_thread, pthread_self());
+}
+
+/* batch_enter()
+ *
+ * returns 1 with the mutex held if the caller owns the batches and is
+ * to work in db->batch.  otherwise waits until db has no open batch and
+ * returns 0; the caller then uses a transaction of its own.
+ */
+static int batch_enter(struct dbpf_db *db)
+{
+    if (!db->batching)
+    {
+        return 0;
+    }
+    gen_mutex_lock(&db->mutex);
+    if (batch_owner())
+    {
+        return 1;
+    }
+    while (db->batch)
+    {
+        db->flush_wanted = 1;
+        pthread_cond_wait(&db->flushed, &db->mutex);
+    }
+    gen_mutex_unlock(&db->mutex);
+    return 0;
+}
+
+static int batch_due(struct dbpf_db *db)
+{
+    return db->flush_wanted ||
+        db->batch_ops >= DBPF_DB_BATCH_OPS ||
+        db->batch_bytes >= DBPF_DB_BATCH_BYTES ||
+        PINT_util_get_time_us() - db->batch_start >= DBPF_DB_BATCH_USECS;
+}
+
+static struct dbpf_db_redo *redo_alloc(int del, unsigned int flags,
+    MDB_val *key, MDB_val *data)
+{
+    struct dbpf_db_redo *redo;
+
+    redo = malloc(sizeof(*redo) + key->mv_size + (data ? data->mv_size : 0));
+    if (!redo)
+    {
+        return NULL;
+    }
+    redo->next = NULL;
+    redo->tag = batch_tag;
+    redo->del = del;
+    redo->flags = flags;
+    redo->key_len = key->mv_size;
+    redo->data_len = data ? data->mv_size : 0;
+    memcpy(redo + 1, key->mv_data, key->mv_size);
+    if (data)
+    {
+        memcpy((char *)(redo + 1) + key->mv_size, data->mv_data,
+               data->mv_size);
+    }
+    return redo;
+}
+
+static int redo_apply(struct dbpf_db *db, MDB_txn *txn,
+    struct dbpf_db_redo *redo)
+{
+    MDB_val key, data;
+
+    key.mv_size = redo->key_len;
+    key.mv_data = redo + 1;
+    if (redo->del)
+    {
+        return mdb_del(txn, db->dbi, &key, NULL);
+    }
+    data.mv_size = redo->data_len;
+    data.mv_data = (char *)(redo + 1) + redo->key_len;
+    return mdb_put(txn, db->dbi, &key, &data, redo->flags);
+}
+
+/* records a write that has gone into the batch; mutex held */
+static void batch_logged(struct dbpf_db *db, struct dbpf_db_redo *redo)
+{
+    *db->redo_tail = redo;
+    db->redo_tail = &redo->next;
+    db->batch_ops++;
+    db->batch_bytes += redo->key_len + redo->data_len;
+}
+
+/* forgets the batch once it is committed or given up on; mutex held */
+static void batch_reset(struct dbpf_db *db)
+{
+    struct dbpf_db_redo *redo;
+
+    while ((redo = db->redo))
+    {
+        db->redo = redo->next;
+        free(redo);
+    }
+    db->redo_tail = &db->redo;
+    db->batch = NULL;
+    db->batch_ops = 0;
+    db->batch_bytes = 0;
+    db->flush_wanted = 0;
+    pthread_cond_broadcast(&db->flushed);
+}
+
+/* batch_commit()
+ *
+ * commits the open batch; mutex held, no cursors open in it.  if the
+ * commit fails each write is retried in a transaction of its own.
+ *
+ * returns 0 if every write of the batch is committed, an error otherwise
+ */
+static int batch_commit(struct dbpf_db *db)
+{
+    struct dbpf_db_redo *redo;
+    MDB_txn *txn;
+    int r, ret = 0, lost = 0;
+
+    if (db->batch_ops == 0)
+    {
+        /* opened for a cursor that wrote nothing */
+        mdb_txn_abort(db->batch);
+        batch_reset(db);
+        return 0;
+    }
+    gossip_debug(GOSSIP_DBPF_COALESCE_DEBUG,
+                 "lmdb batch: committing %d writes, %llu bytes\n",
+                 db->batch_ops, llu(db->batch_bytes));
+    r = mdb_txn_commit(db->batch);
+    if (r)
+    {
+        gossip_err("lmdb batch commit of %d writes failed (%d), "
+                   "retrying them one by one\n", db->batch_ops, r);
+        ret = db_error(r);
+        for (redo = db->redo; redo; redo = redo->next)
+        {
+            r = mdb_txn_begin(db->env, NULL, 0, &txn);
+            if (r == 0)
+            {
+                r = redo_apply(db, txn, redo);
+                if (r == 0)
+                {
+                    r = mdb_txn_commit(txn);
+                }
+                else
+                {
+                    mdb_txn_abort(txn);
+                }
+            }
+            if (r && r != MDB_KEYEXIST && r != MDB_NOTFOUND)
+            {
+                lost++;
+                batch_lost(redo->tag, db_error(r));
+            }
+        }
+        if (lost)
+        {
+            gossip_err("lmdb batch: %d writes could not be committed\n",
+                       lost);
+        }
+        else
+        {
+            ret = 0;
+        }
+    }
+    batch_reset(db);
+    return ret;
+}
+
+/* batch_redo()
+ *
+ * a write has left the batch unusable: aborts it and applies the writes
+ * that went before again in a new transaction, which is committed.
+ * mutex held, no cursors open in the batch.
+ */
+static void batch_redo(struct dbpf_db *db)
+{
+    struct dbpf_db_redo *redo;
+    int r;
+
+    mdb_txn_abort(db->batch);
+    db->batch = NULL;
+    if (db->redo == NULL)
+    {
+        batch_reset(db);
+        return;
+    }
+    r = mdb_txn_begin(db->env, NULL, 0, &db->batch);
+    for (redo = db->redo; r == 0 && redo; redo = redo->next)
+    {
+        r = redo_apply(db, db->batch, redo);
+    }
+    if (r)
+    {
+        gossip_err("lmdb batch: redoing %d writes failed (%d)\n",
+                   db->batch_ops, r);
+        if (db->batch)
+        {
+            mdb_txn_abort(db->batch);
+        }
+        for (redo = db->redo; redo; redo = redo->next)
+        {
+            batch_lost(redo->tag, db_error(r));
+        }
+        batch_reset(db);
+        return;
+    }
+    batch_commit(db);
+}
+
+/* batch_write()
+ *
+ * puts (or with del, deletes) key in the batch, opening one if needed;
+ * mutex held.  cursor, if given, is a cursor in the batch to delete the
+ * current item with.
+ */
+static int batch_write(struct dbpf_db *db, int del, unsigned int flags,
+    MDB_val *key, MDB_val *data, MDB_cursor *cursor)
+{
+    struct dbpf_db_redo *redo;
+    int r;
+
+    redo = redo_alloc(del, flags, key, data);
+    if (!redo)
+    {
+        return TROVE_ENOMEM;
+    }
+    if (!db->batch)
+    {
+        r = mdb_txn_begin(db->env, NULL, 0, &db->batch);
+        if (r)
+        {
+            db->batch = NULL;
+            free(redo);
+            return db_error(r);
+        }
+        db->batch_start = PINT_util_get_time_us();
+    }
+
+    if (cursor)
+    {
+        r = mdb_cursor_del(cursor, 0);
+    }
+    else if (del)
+    {
+        r = mdb_del(db->batch, db->dbi, key, NULL);
+    }
+    else
+    {
+        r = mdb_put(db->batch, db->dbi, key, data, flags);
+    }
+    if (r)
+    {
+        free(redo);
+        /* these leave the transaction as it was */
+        if (r != MDB_KEYEXIST && r != MDB_NOTFOUND && r != MDB_BAD_VALSIZE &&
+            db->batch_cursors == 0)
+        {
+            batch_redo(db);
+        }
+        else if (db->batch_ops == 0 && db->batch_cursors == 0)
+        {
+            mdb_txn_abort(db->batch);
+            batch_reset(db);
+        }
+        return db_error(r);
+    }
+
+    batch_logged(db, redo);
+    if (db->batch_cursors == 0 && batch_due(db))
+    {
+        /* writes that are lost go to batch_lost() with their op */
+        batch_commit(db);
+    }
+    return 0;
+}
+
+static void reader_destroy(void *arg)
+{
+    struct dbpf_db_reader *reader = arg;
+    struct dbpf_db_reader **pp;
+
+    gen_mutex_lock(&reader->db->mutex);
+    for (pp = &reader->db->readers; *pp; pp = &(*pp)->next)
+    {
+        if (*pp == reader)
+        {
+            *pp = reader->next;
+            break;
+        }
+    }
+    gen_mutex_unlock(&reader->db->mutex);
+    mdb_txn_abort(reader->txn);
+    free(reader);
+}
+
+/* reader_begin()
+ *
+ * starts the calling thread's read-only transaction on db, creating it
+ * the first time.  end it with mdb_txn_reset().
+ */
+static int reader_begin(struct dbpf_db *db, MDB_txn **txn)
+{
+    struct dbpf_db_reader *reader;
+    int r;
+
+    reader = pthread_getspecific(db->reader_key);
+    if (reader)
+    {
+        r = mdb_txn_renew(reader->txn);
+        if (r)
+        {
+            return r;
+        }
+        *txn = reader->txn;
+        return 0;
+    }
+
+    reader = malloc(sizeof(*reader));
+    if (!reader)
+    {
+        return ENOMEM;
+    }
+    r = mdb_txn_begin(db->env, NULL, MDB_RDONLY, &reader->txn);
+    if (r)
+    {
+        free(reader);
+        return r;
+    }
+    reader->db = db;
+    if (pthread_setspecific(db->reader_key, reader))
+    {
+        /* works, just without keeping the transaction */
+        *txn = reader->txn;
+        free(reader);
+        return 0;
+    }
+    gen_mutex_lock(&db->mutex);
+    reader->next = db->readers;
+    db->readers = reader;
+    gen_mutex_unlock(&db->mutex);
+    *txn = reader->txn;
+    return 0;
+}
+
+static void reader_end(struct dbpf_db *db, MDB_txn *txn)
+{
+    if (pthread_getspecific(db->reader_key))
+    {
+        mdb_txn_reset(txn);
+    }
+    else
+    {
+        mdb_txn_abort(txn);
+    }
+}
+
+void dbpf_db_batch_begin(void (*lost)(void *, int))
+{
+    batch_lost = lost;
+    batch_tag = NULL;
+    batch_thread = pthread_self();
+    batch_thread_active = 1;
+}
+
+void dbpf_db_batch_tag(void *tag)
+{
+    batch_tag = tag;
+}
+
+int dbpf_db_batch_pending(void)
+{
+    struct dbpf_db *db;
+    int pending = 0;
+
+    if (!batch_owner())
+    {
+        return 0;
+    }
+    gen_mutex_lock(&batching_dbs_mutex);
+    for (db = batching_dbs; db && !pending; db = db->next_batching)
+    {
+        gen_mutex_lock(&db->mutex);
+        pending = db->batch_ops > 0;
+        gen_mutex_unlock(&db->mutex);
+    }
+    gen_mutex_unlock(&batching_dbs_mutex);
+    return pending;
+}
+
+int dbpf_db_batch_flush(int all)
+{
+    struct dbpf_db *db;
+    int r, ret = 0;
+
+    if (!batch_owner())
+    {
+        return 0;
+    }
+    gen_mutex_lock(&batching_dbs_mutex);
+    for (db = batching_dbs; db; db = db->next_batching)
+    {
+        gen_mutex_lock(&db->mutex);
+        if (db->batch && db->batch_cursors == 0 && (all || batch_due(db)))
+        {
+            r = batch_commit(db);
+            if (r && !ret)
+            {
+                ret = r;
+            }
+        }
+        gen_mutex_unlock(&db->mutex);
+    }
+    gen_mutex_unlock(&batching_dbs_mutex);
+    return ret;
+}
+
+void dbpf_db_batch_end(void)
+{
+    if (batch_owner())
+    {
+        dbpf_db_batch_flush(1);
+        batch_thread_active = 0;
+    }
+}
+
 static int ds_attr_compare(const MDB_val *a, const MDB_val *b)
 {
     TROVE_handle *handle_a = (TROVE_handle *)a->mv_data;
@@ -172,7 +685,10 @@ int dbpf_db_open(char *name, int compare, struct dbpf_db **db,
             return db_error(errno);
         }
     }
-    r = mdb_env_open((*db)->env, name, MDB_MAPASYNC|MDB_WRITEMAP,
+    /* MDB_NOTLS because read-only cursors parked by keyval iteration
+     * keep their transactions open while the same thread starts others,
+     * and may be picked up again by another thread. */
+    r = mdb_env_open((*db)->env, name, MDB_MAPASYNC|MDB_WRITEMAP|MDB_NOTLS,
             TROVE_DB_MODE);
     if (r)
     {
@@ -222,19 +738,121 @@ int dbpf_db_open(char *name, int compare, struct dbpf_db **db,
         return db_error(errno);
     }
 
+    r = pthread_key_create(&(*db)->reader_key, reader_destroy);
+    if (r)
+    {
+        mdb_env_close((*db)->env);
+        free(*db);
+        return db_error(r);
+    }
+    (*db)->readers = NULL;
+    gen_mutex_init(&(*db)->mutex);
+    pthread_cond_init(&(*db)->flushed, NULL);
+    (*db)->batch = NULL;
+    (*db)->batch_ops = 0;
+    (*db)->batch_bytes = 0;
+    (*db)->batch_start = 0;
+    (*db)->batch_cursors = 0;
+    (*db)->flush_wanted = 0;
+    (*db)->redo = NULL;
+    (*db)->redo_tail = &(*db)->redo;
+    (*db)->batching = (compare == DBPF_DB_COMPARE_KEYVAL);
+    if ((*db)->batching)
+    {
+        gen_mutex_lock(&batching_dbs_mutex);
+        (*db)->next_batching = batching_dbs;
+        batching_dbs = *db;
+        gen_mutex_unlock(&batching_dbs_mutex);
+    }
+
     return 0;
 }
 
 int dbpf_db_close(struct dbpf_db *db)
 {
+    struct dbpf_db **pp;
+    struct dbpf_db_reader *reader;
+    int r = 0;
+
+    if (batch_enter(db))
+    {
+        /* committing would free the transaction of the write cursors
+         * still open in the batch; their owners must close them first */
+        if (db->batch_cursors > 0)
+        {
+            gossip_err("%s: %d cursors still open in the write batch\n",
+                       __func__, db->batch_cursors);
+            gen_mutex_unlock(&db->mutex);
+            return TROVE_EBUSY;
+        }
+        if (db->batch)
+        {
+            r = batch_commit(db);
+        }
+        gen_mutex_unlock(&db->mutex);
+    }
+    if (db->batching)
+    {
+        gen_mutex_lock(&batching_dbs_mutex);
+        for (pp = &batching_dbs; *pp; pp = &(*pp)->next_batching)
+        {
+            if (*pp == db)
+            {
+                *pp = db->next_batching;
+                break;
+            }
+        }
+        gen_mutex_unlock(&batching_dbs_mutex);
+    }
+
+    /* no destructor may run once the readers are gone */
+    pthread_key_delete(db->reader_key);
+    while ((reader = db->readers))
+    {
+        db->readers = reader->next;
+        mdb_txn_abort(reader->txn);
+        free(reader);
+    }
+    pthread_cond_destroy(&db->flushed);
+    gen_mutex_destroy(&db->mutex);
+
     mdb_env_close(db->env);
     free(db);
-    return 0;
+    return r;
+}
+
+/* db_sync()
+ *
+ * commits any open batch of db and flushes the map.  The env is opened
+ * with MDB_MAPASYNC, so without force the flush is only scheduled.
+ */
+static int db_sync(struct dbpf_db *db, int force)
+{
+    int r = 0;
+
+    if (batch_enter(db))
+    {
+        if (db->batch && db->batch_cursors == 0)
+        {
+            r = batch_commit(db);
+        }
+        gen_mutex_unlock(&db->mutex);
+        if (r)
+        {
+            return r;
+        }
+    }
+    return db_error(mdb_env_sync(db->env, force));
 }
 
 int dbpf_db_sync(struct dbpf_db *db)
 {
-    return db_error(mdb_env_sync(db->env, 0));
+    return db_sync(db, 0);
+}
+
+int dbpf_db_sync_durable(struct dbpf_db *db)
+{
+    return db_sync(db, 1);
 }
 
 int dbpf_db_get(struct dbpf_db *db, struct dbpf_data *key,
@@ -247,26 +865,35 @@ int dbpf_db_get(struct dbpf_db *db, struct dbpf_data *key,
     db_key.mv_size = key->len;
     db_key.mv_data = key->data;
 
-    r = mdb_txn_begin(db->env, NULL, MDB_RDONLY, &txn);
-    if (r)
+    if (batch_enter(db))
     {
-        return db_error(r);
+        if (db->batch)
+        {
+            r = mdb_get(db->batch, db->dbi, &db_key, &db_data);
+            if (r == 0)
+            {
+                memcpy(val->data, db_data.mv_data, val->len);
+                val->len = db_data.mv_size;
+            }
+            gen_mutex_unlock(&db->mutex);
+            return db_error(r);
+        }
+        gen_mutex_unlock(&db->mutex);
     }
-    r = mdb_get(txn, db->dbi, &db_key, &db_data);
+
+    r = reader_begin(db, &txn);
     if (r)
     {
-        mdb_txn_abort(txn);
         return db_error(r);
     }
-    r = mdb_txn_commit(txn);
-    if (r)
+    r = mdb_get(txn, db->dbi, &db_key, &db_data);
+    if (r == 0)
     {
-        return db_error(r);
+        memcpy(val->data, db_data.mv_data, val->len);
+        val->len = db_data.mv_size;
     }
-
-    memcpy(val->data, db_data.mv_data, val->len);
-    val->len = db_data.mv_size;
-    return 0;
+    reader_end(db, txn);
+    return db_error(r);
 }
 
 int dbpf_db_put(struct dbpf_db *db, struct dbpf_data *key,
@@ -281,6 +908,13 @@ int dbpf_db_put(struct dbpf_db *db, struct dbpf_data *key,
     db_data.mv_size = val->len;
     db_data.mv_data = val->data;
 
+    if (batch_enter(db))
+    {
+        r = batch_write(db, 0, 0, &db_key, &db_data, NULL);
+        gen_mutex_unlock(&db->mutex);
+        return r;
+    }
+
     r = mdb_txn_begin(db->env, NULL, 0, &txn);
     if (r)
     {
@@ -312,6 +946,13 @@ int dbpf_db_putonce(struct dbpf_db *db, struct dbpf_data *key,
     db_data.mv_size = val->len;
     db_data.mv_data = val->data;
 
+    if (batch_enter(db))
+    {
+        r = batch_write(db, 0, MDB_NOOVERWRITE, &db_key, &db_data, NULL);
+        gen_mutex_unlock(&db->mutex);
+        return r;
+    }
+
     r = mdb_txn_begin(db->env, NULL, 0, &txn);
     if (r)
     {
@@ -340,6 +981,13 @@ int dbpf_db_del(struct dbpf_db *db, struct dbpf_data *key)
     db_key.mv_size = key->len;
     db_key.mv_data = key->data;
 
+    if (batch_enter(db))
+    {
+        r = batch_write(db, 1, 0, &db_key, NULL, NULL);
+        gen_mutex_unlock(&db->mutex);
+        return r;
+    }
+
     r = mdb_txn_begin(db->env, NULL, 0, &txn);
     if (r)
     {
@@ -367,6 +1015,47 @@ int dbpf_db_cursor(struct dbpf_db *db, struct dbpf_cursor **dbc, int rdonly)
     {
         return db_error(errno);
     }
+    (*dbc)->db = db;
+    (*dbc)->batched = 0;
+
+    if (batch_enter(db))
+    {
+        if (!rdonly)
+        {
+            /* a write cursor works in the batch */
+            if (!db->batch)
+            {
+                r = mdb_txn_begin(db->env, NULL, 0, &db->batch);
+                if (r)
+                {
+                    db->batch = NULL;
+                    gen_mutex_unlock(&db->mutex);
+                    free(*dbc);
+                    return db_error(r);
+                }
+                db->batch_start = PINT_util_get_time_us();
+            }
+            r = mdb_cursor_open(db->batch, db->dbi, &(*dbc)->cursor);
+            if (r)
+            {
+                gen_mutex_unlock(&db->mutex);
+                free(*dbc);
+                return db_error(r);
+            }
+            (*dbc)->txn = db->batch;
+            (*dbc)->batched = 1;
+            db->batch_cursors++;
+            gen_mutex_unlock(&db->mutex);
+            return 0;
+        }
+        /* a read-only cursor may be parked and outlive the batch, so it
+         * gets its own snapshot of everything written so far */
+        if (db->batch && db->batch_cursors == 0)
+        {
+            batch_commit(db);
+        }
+        gen_mutex_unlock(&db->mutex);
+    }
 
     r = mdb_txn_begin(db->env, NULL, rdonly ? MDB_RDONLY : 0, &(*dbc)->txn);
     if (r)
@@ -386,8 +1075,21 @@ int dbpf_db_cursor(struct dbpf_db *db, struct dbpf_cursor **dbc, int rdonly)
 
 int dbpf_db_cursor_close(struct dbpf_cursor *dbc)
 {
+    struct dbpf_db *db = dbc->db;
     int r;
     mdb_cursor_close(dbc->cursor);
+    if (dbc->batched)
+    {
+        gen_mutex_lock(&db->mutex);
+        if (--db->batch_cursors == 0 && batch_due(db))
+        {
+            /* writes that are lost go to batch_lost() with their op */
+            batch_commit(db);
+        }
+        gen_mutex_unlock(&db->mutex);
+        free(dbc);
+        return 0;
+    }
     r = mdb_txn_commit(dbc->txn);
     if (r)
     {
@@ -441,5 +1143,20 @@ int dbpf_db_cursor_get(struct dbpf_cursor *dbc, struct dbpf_data *key,
 
 int dbpf_db_cursor_del(struct dbpf_cursor *dbc)
 {
+    MDB_val db_key, db_data;
+    int r;
+    if (dbc->batched)
+    {
+        /* the redo list needs the key being deleted */
+        r = mdb_cursor_get(dbc->cursor, &db_key, &db_data, MDB_GET_CURRENT);
+        if (r)
+        {
+            return db_error(r);
+        }
+        gen_mutex_lock(&dbc->db->mutex);
+        r = batch_write(dbc->db, 1, 0, &db_key, NULL, dbc->cursor);
+        gen_mutex_unlock(&dbc->db->mutex);
+        return r;
+    }
     return db_error(mdb_cursor_del(dbc->cursor, 0));
 }
@@ -49,6 +49,11 @@ int dbpf_db_close(dbpf_db *);
 /* dbpf_db_sync(db): Update the on-disk copy of database *db*. */
 int dbpf_db_sync(dbpf_db *);
 
+/* dbpf_db_sync_durable(db): Update the on-disk copy of database *db*
+ * and wait until it would survive a crash, which dbpf_db_sync need not
+ * do. */
+int dbpf_db_sync_durable(dbpf_db *);
+
 /* dbpf_db_get(db, key, val): Retrieve value for *key* in *db* into
  * *val*. */
 int dbpf_db_get(dbpf_db *, struct dbpf_data *, struct dbpf_data *);
@@ -82,3 +87,25 @@ int dbpf_db_cursor_get(struct dbpf_cursor *, struct dbpf_data *,
 /* dbpf_db_cursor_del(dbc): Delete the current (last returned from get)
  * key from *dbc*. */
 int dbpf_db_cursor_del(dbpf_cursor *);
+
+/* dbpf_db_batch_begin(lost): Let the calling thread batch its writes
+ * to the databases that allow it, committing several at a time. Only
+ * one thread batches. A batched write that cannot be committed is
+ * passed to *lost* as its tag and a positive error. */
+void dbpf_db_batch_begin(void (*)(void *, int));
+
+/* dbpf_db_batch_tag(tag): Tag the calling thread's following batched
+ * writes with *tag*. */
+void dbpf_db_batch_tag(void *);
+
+/* dbpf_db_batch_pending(): Return nonzero if the calling thread has
+ * batched writes that are not committed yet. */
+int dbpf_db_batch_pending(void);
+
+/* dbpf_db_batch_flush(all): Commit the calling thread's batches that
+ * are due, or all of them if *all*. */
+int dbpf_db_batch_flush(int);
+
+/* dbpf_db_batch_end(): Commit the calling thread's batches and stop
+ * batching. */
+void dbpf_db_batch_end(void);
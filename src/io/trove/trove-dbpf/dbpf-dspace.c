@@ -28,6 +28,7 @@
 #include "dbpf-op.h"
 #include "dbpf-thread.h"
 #include "dbpf-bstream.h"
+#include "dbpf-bstream-direct.h"
 #include "dbpf-op-queue.h"
 #include "dbpf-attr-cache.h"
 #include "dbpf-open-cache.h"
@@ -49,7 +50,6 @@ extern gen_mutex_t dbpf_completion_queue_array_mutex[TROVE_MAX_CONTEXTS];
 extern struct qlist_head dbpf_op_queue;
 extern gen_mutex_t dbpf_op_queue_mutex;
 #endif
-extern gen_mutex_t dbpf_attr_cache_mutex;
 
 int64_t s_dbpf_metadata_writes = 0, s_dbpf_metadata_reads = 0;
 
@@ -512,6 +512,10 @@ static int remove_one_handle(TROVE_object_ref ref,
     key.data = &ref.handle;
     key.len = sizeof(TROVE_handle);
 
+    /* first, so that no pending bstream size write back can recreate the
+     * dspace entry */
+    dbpf_bstream_direct_size_forget(ref);
+
     ret = dbpf_db_del(coll_p->ds_db, &key);
     if (ret == TROVE_ENOENT)
     {
@@ -530,9 +534,7 @@ static int remove_one_handle(TROVE_object_ref ref,
     }
 
     /* if this attr is in the dbpf attr cache, remove it */
-    gen_mutex_lock(&dbpf_attr_cache_mutex);
     dbpf_attr_cache_remove(ref);
-    gen_mutex_unlock(&dbpf_attr_cache_mutex);
 
     /* remove bstream if it exists.  Not a fatal
      * error if this fails (may not have ever been created)
@@ -545,15 +547,18 @@ static int remove_one_handle(TROVE_object_ref ref,
      * the trove keyval interfaces.  It does allow us to perform the cleanup
      * of a handle without having to post more operations though.
      */
+    PINT_dbpf_keyval_session_invalidate(coll_p->sessions, ref.handle);
     ret = PINT_dbpf_keyval_iterate(coll_p->keyval_db,
                                    ref.handle,
                                    DBPF_ATTRIBUTE_TYPE,
                                    coll_p->pcache,
                                    NULL,
                                    NULL,
+                                   NULL,
                                    &count,
                                    TROVE_ITERATE_START,
-                                   PINT_dbpf_dspace_remove_keyval);
+                                   PINT_dbpf_dspace_remove_keyval,
+                                   NULL);
     if(ret != 0 && ret != -TROVE_ENOENT)
     {
         goto return_error;
@@ -958,9 +963,9 @@ static int dbpf_dspace_getattr(TROVE_coll_id coll_id,
     PINT_event_type event_type;
 
     /* fast path cache hit; skips queueing */
-    gen_mutex_lock(&dbpf_attr_cache_mutex);
     if (dbpf_attr_cache_ds_attr_fetch_cached_data(ref, ds_attr_p) == 0)
     {
+        dbpf_bstream_direct_size_fixup(ref, ds_attr_p, 0);
 #if 0
         gossip_debug(
             GOSSIP_TROVE_DEBUG, "ATTRIB: retrieved "
@@ -993,10 +998,8 @@ static int dbpf_dspace_getattr(TROVE_coll_id coll_id,
         }
 
         UPDATE_PERF_METADATA_READ();
-        gen_mutex_unlock(&dbpf_attr_cache_mutex);
         return 1;
     }
-    gen_mutex_unlock(&dbpf_attr_cache_mutex);
 
     coll_p = dbpf_collection_find_registered(coll_id);
     if (coll_p == NULL)
@@ -1057,7 +1060,6 @@ static int dbpf_dspace_getattr_list(TROVE_coll_id coll_id,
     int i;
     int cache_hits = 0; 
 
-    gen_mutex_lock(&dbpf_attr_cache_mutex);
     /* go ahead and try to hit attr cache for all handles up front */ 
     for (i = 0; i < nhandles; i++) 
     {
@@ -1066,6 +1068,7 @@ static int dbpf_dspace_getattr_list(TROVE_coll_id coll_id,
 
         if (dbpf_attr_cache_ds_attr_fetch_cached_data(ref, &ds_attr_p[i]) == 0)
         {
+            dbpf_bstream_direct_size_fixup(ref, &ds_attr_p[i], 0);
 #if 0
             gossip_debug(
                 GOSSIP_TROVE_DEBUG, "ATTRIB: retrieved "
@@ -1112,7 +1115,6 @@ static int dbpf_dspace_getattr_list(TROVE_coll_id coll_id,
             ds_attr_p[i].type = PVFS_TYPE_NONE;
         }
     }
-    gen_mutex_unlock(&dbpf_attr_cache_mutex);
 
     /* All handles hit in the cache, return */
     if (cache_hits == nhandles) 
@@ -1233,9 +1235,7 @@ int dbpf_dspace_attr_set(struct dbpf_collection *coll_p,
     }
 
     /* now that the disk is updated, update the cache if necessary */
-    gen_mutex_lock(&dbpf_attr_cache_mutex);
     dbpf_attr_cache_ds_attr_update_cached_data(ref, attr);
-    gen_mutex_unlock(&dbpf_attr_cache_mutex);
 
     return 0;
 }
@@ -1305,9 +1305,10 @@ int dbpf_dspace_attr_get(struct dbpf_collection *coll_p,
     }
 
     /* add retrieved ds_attr to dbpf_attr cache here */
-    gen_mutex_lock(&dbpf_attr_cache_mutex);
     dbpf_attr_cache_insert(ref, attr);
-    gen_mutex_unlock(&dbpf_attr_cache_mutex);
+
+    /* the bstream may have grown past the stored size */
+    dbpf_bstream_direct_size_fixup(ref, attr, 1);
 
     return 0;
 }
@@ -1976,9 +1977,7 @@ static int dbpf_dspace_create_store_handle(
 
     /* add retrieved ds_attr to dbpf_attr cache here */
     ref.handle = new_handle;
-    gen_mutex_lock(&dbpf_attr_cache_mutex);
     dbpf_attr_cache_insert(ref, &attr);
-    gen_mutex_unlock(&dbpf_attr_cache_mutex);
 
     return(0);
 }
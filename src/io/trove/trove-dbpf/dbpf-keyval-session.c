@@ -0,0 +1,262 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "dbpf.h"
+#include "dbpf-keyval-session.h"
+#include "gossip.h"
+#include "pint-util.h"
+#include "pvfs2-internal.h"
+
+struct dbpf_keyval_session
+{
+    TROVE_handle handle;
+    char type;
+    TROVE_ds_position pos;
+    dbpf_cursor *dbc;
+    PVFS_time stamp;
+    struct dbpf_keyval_session *next;
+};
+
+static struct PINT_perf_key dbpf_keyval_session_keys[] =
+{
+    {"KEYVAL_ITERATE_START", PERF_KEYVAL_ITERATE_START, 0},
+    {"KEYVAL_ITERATE_CONTINUE", PERF_KEYVAL_ITERATE_CONTINUE, 0},
+    {"KEYVAL_ITERATE_SEEK", PERF_KEYVAL_ITERATE_SEEK, 0},
+    {"KEYVAL_ITERATE_STEP", PERF_KEYVAL_ITERATE_STEP, 0},
+    {"KEYVAL_SESSION_DROPPED", PERF_KEYVAL_SESSION_DROPPED, 0},
+    {"KEYVAL_SESSION_OPEN", PERF_KEYVAL_SESSION_OPEN, PINT_PERF_PRESERVE},
+    {NULL, 0, 0},
+};
+
+/* unlinks *pp and closes its cursor; call with the mutex held */
+static void dbpf_keyval_session_drop(PINT_dbpf_keyval_session *cache,
+                                     struct dbpf_keyval_session **pp)
+{
+    struct dbpf_keyval_session *s = *pp;
+
+    *pp = s->next;
+    cache->count--;
+    dbpf_db_cursor_close(s->dbc);
+    free(s);
+    PINT_perf_count(cache->pc, PERF_KEYVAL_SESSION_DROPPED, 1,
+                    PINT_PERF_ADD);
+    PINT_perf_count(cache->pc, PERF_KEYVAL_SESSION_OPEN, cache->count,
+                    PINT_PERF_SET);
+}
+
+/* closes sessions older than the timeout; call with the mutex held */
+static void dbpf_keyval_session_expire(PINT_dbpf_keyval_session *cache,
+                                       PVFS_time now)
+{
+    struct dbpf_keyval_session **pp = &cache->sessions;
+
+    while (*pp)
+    {
+        if (now - (*pp)->stamp > DBPF_KEYVAL_SESSION_TIMEOUT_MSECS)
+        {
+            dbpf_keyval_session_drop(cache, pp);
+        }
+        else
+        {
+            pp = &(*pp)->next;
+        }
+    }
+}
+
+PINT_dbpf_keyval_session *PINT_dbpf_keyval_session_initialize(void)
+{
+    PINT_dbpf_keyval_session *cache;
+
+    cache = calloc(1, sizeof(PINT_dbpf_keyval_session));
+    if (!cache)
+    {
+        return NULL;
+    }
+    gen_mutex_init(&cache->mutex);
+
+    /* the counters are only instrumentation; go on without them */
+    cache->pc = PINT_perf_initialize(PINT_PERF_COUNTER,
+                                     dbpf_keyval_session_keys, NULL);
+    if (!cache->pc)
+    {
+        gossip_err("%s: Error: PINT_perf_initialize failure.\n", __func__);
+    }
+    return cache;
+}
+
+/* must be called before the keyval db the cursors belong to is closed */
+void PINT_dbpf_keyval_session_finalize(PINT_dbpf_keyval_session *cache)
+{
+    char *text;
+
+    if (!cache)
+    {
+        return;
+    }
+
+    gen_mutex_lock(&cache->mutex);
+    while (cache->sessions)
+    {
+        dbpf_keyval_session_drop(cache, &cache->sessions);
+    }
+    gen_mutex_unlock(&cache->mutex);
+
+    if (cache->pc)
+    {
+        text = PINT_perf_generate_text(cache->pc, 4096);
+        if (text)
+        {
+            gossip_debug(GOSSIP_DBPF_KEYVAL_DEBUG,
+                         "keyval iteration counters:\n%s", text);
+            free(text);
+        }
+        PINT_perf_finalize(cache->pc);
+    }
+    gen_mutex_destroy(&cache->mutex);
+    free(cache);
+}
+
+/* PINT_dbpf_keyval_session_take()
+ *
+ * removes and returns the cursor parked for the iteration of handle that
+ * stopped at pos.  The cursor is on the last entry that was returned.
+ *
+ * returns the cursor, or NULL if there is none
+ */
+dbpf_cursor *PINT_dbpf_keyval_session_take(
+    PINT_dbpf_keyval_session *cache,
+    TROVE_handle handle,
+    char type,
+    TROVE_ds_position pos)
+{
+    struct dbpf_keyval_session **pp, *s;
+    dbpf_cursor *dbc = NULL;
+
+    if (!cache)
+    {
+        return NULL;
+    }
+
+    gen_mutex_lock(&cache->mutex);
+    dbpf_keyval_session_expire(cache, PINT_util_get_time_ms());
+    for (pp = &cache->sessions; *pp; pp = &(*pp)->next)
+    {
+        s = *pp;
+        if (s->handle == handle && s->type == type && s->pos == pos)
+        {
+            *pp = s->next;
+            cache->count--;
+            dbc = s->dbc;
+            free(s);
+            PINT_perf_count(cache->pc, PERF_KEYVAL_SESSION_OPEN,
+                            cache->count, PINT_PERF_SET);
+            break;
+        }
+    }
+    gen_mutex_unlock(&cache->mutex);
+    return dbc;
+}
+
+/* PINT_dbpf_keyval_session_put()
+ *
+ * parks dbc for a later iteration of handle from pos.  The cache takes
+ * the cursor over even on failure, closing it if it cannot be kept.
+ *
+ * returns 0 if the cursor was kept, -TROVE_ENOMEM otherwise
+ */
+int PINT_dbpf_keyval_session_put(
+    PINT_dbpf_keyval_session *cache,
+    TROVE_handle handle,
+    char type,
+    TROVE_ds_position pos,
+    dbpf_cursor *dbc)
+{
+    struct dbpf_keyval_session **pp, **oldest;
+    struct dbpf_keyval_session *s;
+    PVFS_time now = PINT_util_get_time_ms();
+
+    s = malloc(sizeof(*s));
+    if (!s)
+    {
+        dbpf_db_cursor_close(dbc);
+        return -TROVE_ENOMEM;
+    }
+    s->handle = handle;
+    s->type = type;
+    s->pos = pos;
+    s->dbc = dbc;
+    s->stamp = now;
+
+    gen_mutex_lock(&cache->mutex);
+    dbpf_keyval_session_expire(cache, now);
+    if (cache->count >= DBPF_KEYVAL_SESSION_MAX)
+    {
+        oldest = &cache->sessions;
+        for (pp = &cache->sessions; *pp; pp = &(*pp)->next)
+        {
+            if ((*pp)->stamp < (*oldest)->stamp)
+            {
+                oldest = pp;
+            }
+        }
+        dbpf_keyval_session_drop(cache, oldest);
+    }
+    s->next = cache->sessions;
+    cache->sessions = s;
+    cache->count++;
+    PINT_perf_count(cache->pc, PERF_KEYVAL_SESSION_OPEN, cache->count,
+                    PINT_PERF_SET);
+    gen_mutex_unlock(&cache->mutex);
+    return 0;
+}
+
+/* PINT_dbpf_keyval_session_invalidate()
+ *
+ * closes the sessions of a handle whose keyvals are changing, along with
+ * any that have timed out
+ */
+void PINT_dbpf_keyval_session_invalidate(
+    PINT_dbpf_keyval_session *cache,
+    TROVE_handle handle)
+{
+    struct dbpf_keyval_session **pp;
+
+    if (!cache)
+    {
+        return;
+    }
+
+    gen_mutex_lock(&cache->mutex);
+    if (cache->sessions)
+    {
+        dbpf_keyval_session_expire(cache, PINT_util_get_time_ms());
+        pp = &cache->sessions;
+        while (*pp)
+        {
+            if ((*pp)->handle == handle)
+            {
+                dbpf_keyval_session_drop(cache, pp);
+            }
+            else
+            {
+                pp = &(*pp)->next;
+            }
+        }
+    }
+    gen_mutex_unlock(&cache->mutex);
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
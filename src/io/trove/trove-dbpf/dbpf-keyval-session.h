@@ -0,0 +1,91 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+#ifndef __DBPF_KEYVAL_SESSION_H
+#define __DBPF_KEYVAL_SESSION_H
+
+#include "pvfs2-internal.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include "gen-locks.h"
+#include "trove.h"
+#include "pint-perf-counter.h"
+
+/* Open cursors left behind by keyval iterations.
+ *
+ * An iteration that stops short of the end parks its cursor here,
+ * still on the last entry returned, keyed by the handle, the keyval
+ * type and the position token handed back to the caller.  When the
+ * caller asks for the next page with that token the iteration carries
+ * on from the cursor instead of seeking to the position through the
+ * pcache or stepping to it from the start.  With LMDB the cursor holds
+ * a read transaction, so sessions are dropped after
+ * DBPF_KEYVAL_SESSION_TIMEOUT_MSECS and whenever the handle's keyvals
+ * are written or removed; a continued page therefore never misses a
+ * change that a seek would have seen.
+ */
+
+#define DBPF_KEYVAL_SESSION_MAX 32
+#define DBPF_KEYVAL_SESSION_TIMEOUT_MSECS 5000
+
+enum
+{
+    PERF_KEYVAL_ITERATE_START = 0,    /* iterations from the start */
+    PERF_KEYVAL_ITERATE_CONTINUE = 1, /* resumed on a parked cursor */
+    PERF_KEYVAL_ITERATE_SEEK = 2,     /* repositioned through the pcache */
+    PERF_KEYVAL_ITERATE_STEP = 3,     /* stepped from the first entry */
+    PERF_KEYVAL_SESSION_DROPPED = 4,  /* parked cursors closed unused */
+    PERF_KEYVAL_SESSION_OPEN = 5      /* parked cursors right now */
+};
+
+struct dbpf_keyval_session;
+struct dbpf_cursor;
+
+typedef struct PINT_dbpf_keyval_session_s
+{
+    struct dbpf_keyval_session *sessions;
+    int count;
+    gen_mutex_t mutex;
+    struct PINT_perf_counter *pc;
+} PINT_dbpf_keyval_session;
+
+PINT_dbpf_keyval_session *PINT_dbpf_keyval_session_initialize(void);
+void PINT_dbpf_keyval_session_finalize(PINT_dbpf_keyval_session *cache);
+
+struct dbpf_cursor *PINT_dbpf_keyval_session_take(
+    PINT_dbpf_keyval_session *cache,
+    TROVE_handle handle,
+    char type,
+    TROVE_ds_position pos);
+
+int PINT_dbpf_keyval_session_put(
+    PINT_dbpf_keyval_session *cache,
+    TROVE_handle handle,
+    char type,
+    TROVE_ds_position pos,
+    struct dbpf_cursor *dbc);
+
+void PINT_dbpf_keyval_session_invalidate(
+    PINT_dbpf_keyval_session *cache,
+    TROVE_handle handle);
+
+#if defined(__cplusplus)
+} /* extern C */
+#endif
+
+#endif /* __DBPF_KEYVAL_SESSION_H */
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
@@ -44,7 +44,27 @@ static uint16_t readdir_session = 0;
 
 extern int synccount;
 
-extern gen_mutex_t dbpf_attr_cache_mutex;
+/*
+ * only string attribute keys go through the attribute cache.  directory
+ * entries share their key space with file names, which could collide
+ * with the cacheable keywords.
+ */
+#define DBPF_KEYVAL_ATTR_CACHEABLE(__flags) \
+    (!((__flags) & (TROVE_BINARY_KEY | TROVE_KEYVAL_DIRECTORY_ENTRY)))
+
+/*
+ * the cache matches keys as C strings, so a key is only looked up or
+ * filled if its buffer is exactly one string with its terminator;
+ * otherwise "nd" and "nd\0" would share an entry.
+ */
+static inline int dbpf_keyval_attr_cacheable(TROVE_ds_flags flags,
+                                             TROVE_keyval_s *key)
+{
+    return (DBPF_KEYVAL_ATTR_CACHEABLE(flags) &&
+            key->buffer_sz > 0 &&
+            memchr(key->buffer, '\0', key->buffer_sz) ==
+                (char *)key->buffer + key->buffer_sz - 1);
+}
 
 static int dbpf_keyval_do_remove(
     dbpf_db *db_p, TROVE_handle handle, char type,
@@ -79,6 +99,7 @@ static int dbpf_keyval_iterate_skip_to_position(
     char type,
     TROVE_ds_position pos, 
     PINT_dbpf_keyval_pcache *pcache,
+    PINT_dbpf_keyval_session *sessions,
     dbpf_cursor *dbc);
 
 static int dbpf_keyval_iterate_cursor_get(
@@ -114,39 +135,30 @@ static int dbpf_keyval_read(TROVE_coll_id coll_id,
     struct dbpf_op op;
     struct dbpf_op *op_p;
     struct dbpf_collection *coll_p = NULL;
-    dbpf_attr_cache_elem_t *cache_elem = NULL;
     TROVE_object_ref ref = {handle, coll_id};
     PINT_event_id event_id = 0;
     PINT_event_type event_type;
+    int read_sz;
 
     gossip_debug(GOSSIP_DBPF_KEYVAL_DEBUG, "*** Trove KeyVal Read "
                  "of %s\n", (char *)key_p->buffer);
 
-    gen_mutex_lock(&dbpf_attr_cache_mutex);
-    cache_elem = dbpf_attr_cache_elem_lookup(ref);
-    if (cache_elem && (!(flags & TROVE_BINARY_KEY)))
+    if (dbpf_keyval_attr_cacheable(flags, key_p))
     {
-        dbpf_keyval_pair_cache_elem_t *keyval_pair =
-            dbpf_attr_cache_elem_get_data_based_on_key(
-                cache_elem, key_p->buffer);
-        if (keyval_pair)
+        read_sz = val_p->buffer_sz;
+        ret = dbpf_attr_cache_keyval_fetch_cached_data(
+            ref, key_p->buffer, val_p->buffer, &read_sz);
+        if (ret == 0)
         {
-            val_p->read_sz = val_p->buffer_sz;
-            /* note: dbpf_attr_cache_keyval_pair_fetch_cached_data() will
-             * update read_sz appropriately
-             */
-            ret = dbpf_attr_cache_keyval_pair_fetch_cached_data(
-                cache_elem, keyval_pair, val_p->buffer,
-                &val_p->read_sz);
-            gen_mutex_unlock(&dbpf_attr_cache_mutex);
-            if(ret < 0)
-            {
-                return ret;
-            }
+            val_p->read_sz = read_sz;
             return 1;
         }
+        if (ret == -TROVE_ENOENT || ret == -TROVE_EINVAL)
+        {
+            /* cached as absent, or cached value too big for buffer */
+            return ret;
+        }
     }
-    gen_mutex_unlock(&dbpf_attr_cache_mutex);
 
     coll_p = dbpf_collection_find_registered(coll_id);
     if (coll_p == NULL)
@@ -192,6 +204,7 @@ static int dbpf_keyval_read_op_svc(struct dbpf_op *op_p)
     TROVE_object_ref ref = {op_p->handle, op_p->coll_p->coll_id};
     struct dbpf_keyval_db_entry key_entry;
     struct dbpf_data key, data;
+    uint32_t token = 0;
     int ret;
 
     key_entry.handle = op_p->handle;
@@ -212,7 +225,18 @@ static int dbpf_keyval_read_op_svc(struct dbpf_op *op_p)
     data.data = op_p->u.k_read.val->buffer;
     data.len = op_p->u.k_read.val->buffer_sz;
 
+    if (DBPF_KEYVAL_ATTR_CACHEABLE(op_p->flags))
+    {
+        token = dbpf_attr_cache_keyval_fill_token(ref);
+    }
+
     ret = dbpf_db_get(op_p->coll_p->keyval_db, &key, &data);
+    if (ret == TROVE_ENOENT &&
+        dbpf_keyval_attr_cacheable(op_p->flags, op_p->u.k_read.key))
+    {
+        /* remember the absence so the next read skips the database */
+        dbpf_attr_cache_keyval_fill(ref, key_entry.key, NULL, 0, token);
+    }
     if (ret != 0)
     {
         gossip_debug(GOSSIP_DBPF_KEYVAL_DEBUG,
@@ -239,16 +263,16 @@ static int dbpf_keyval_read_op_svc(struct dbpf_op *op_p)
     op_p->u.k_read.val->read_sz = data.len;
 
     /* cache this data in the attr cache if we can */
-    if(!(op_p->flags & TROVE_BINARY_KEY))
+    if (dbpf_keyval_attr_cacheable(op_p->flags, op_p->u.k_read.key))
     {
-        gen_mutex_lock(&dbpf_attr_cache_mutex);
-        if (dbpf_attr_cache_elem_set_data_based_on_key(
+        if (dbpf_attr_cache_keyval_fill(
                 ref, key_entry.key,
-                op_p->u.k_read.val->buffer, data.len))
+                op_p->u.k_read.val->buffer, data.len, token))
         {
             /*
-             * NOTE: this can happen if the keyword isn't registered, or if
-             * there is no associated cache_elem for this key
+             * NOTE: this can happen if the keyword isn't registered, if
+             * there is no associated cache_elem for this key, or if a
+             * write to it raced with this read
              */
             gossip_debug(
                 GOSSIP_DBPF_ATTRCACHE_DEBUG,"** CANNOT cache data retrieved "
@@ -261,7 +285,6 @@ static int dbpf_keyval_read_op_svc(struct dbpf_op *op_p)
                 "retrieved (key is %s)\n",
                 (char *)key_entry.key);
         }
-        gen_mutex_unlock(&dbpf_attr_cache_mutex);
     }
 
     return 1;
@@ -347,6 +370,9 @@ static int dbpf_keyval_write_op_svc(struct dbpf_op *op_p)
                      (char *)op_p->u.k_write.key.buffer);
     }
 
+    PINT_dbpf_keyval_session_invalidate(op_p->coll_p->sessions,
+                                        op_p->handle);
+
     key_entry.handle = op_p->handle;
     if (op_p->flags & TROVE_KEYVAL_DIRECTORY_ENTRY)
     {
@@ -454,34 +480,27 @@ static int dbpf_keyval_write_op_svc(struct dbpf_op *op_p)
      * now that the data is written to disk, update the cache if it's
      * an attr keyval we manage.
      */
-    if(!(op_p->flags & TROVE_BINARY_KEY))
+    if (dbpf_keyval_attr_cacheable(op_p->flags, &op_p->u.k_write.key))
     {
-        dbpf_attr_cache_elem_t *cache_elem;
-        gen_mutex_lock(&dbpf_attr_cache_mutex);
-        cache_elem = dbpf_attr_cache_elem_lookup(ref);
-        if (cache_elem)
+        if (dbpf_attr_cache_elem_set_data_based_on_key(
+                ref, key_entry.key,
+                op_p->u.k_write.val.buffer, data.len))
         {
-            if (dbpf_attr_cache_elem_set_data_based_on_key(
-                    ref, key_entry.key,
-                    op_p->u.k_write.val.buffer, data.len))
-            {
-                /*
-                 * NOTE: this can happen if the keyword isn't registered,
-                 * or if there is no associated cache_elem for this key
-                 */
-                gossip_debug(
-                    GOSSIP_DBPF_ATTRCACHE_DEBUG,"** CANNOT cache data written "
-                    "(key is %s)\n", (char *)key_entry.key);
-            }
-            else
-            {
-                gossip_debug(
-                    GOSSIP_DBPF_ATTRCACHE_DEBUG,"*** cached keyval data "
-                    "written (key is %s)\n",
-                    (char *)key_entry.key);
-            }
+            /*
+             * NOTE: this can happen if the keyword isn't registered,
+             * or if there is no associated cache_elem for this key
+             */
+            gossip_debug(
+                GOSSIP_DBPF_ATTRCACHE_DEBUG,"** CANNOT cache data written "
+                "(key is %s)\n", (char *)key_entry.key);
+        }
+        else
+        {
+            gossip_debug(
+                GOSSIP_DBPF_ATTRCACHE_DEBUG,"*** cached keyval data "
+                "written (key is %s)\n",
+                (char *)key_entry.key);
         }
-        gen_mutex_unlock(&dbpf_attr_cache_mutex);
     }
 
     ret = DBPF_OP_COMPLETE;
@@ -552,6 +571,7 @@ static int dbpf_keyval_remove(TROVE_coll_id coll_id,
 static int dbpf_keyval_remove_op_svc(struct dbpf_op *op_p)
 {
     int ret = -TROVE_EINVAL;
+    TROVE_object_ref ref = {op_p->handle, op_p->coll_p->coll_id};
 
     if(!(op_p->flags & TROVE_BINARY_KEY))
     {
@@ -561,7 +581,10 @@ static int dbpf_keyval_remove_op_svc(struct dbpf_op *op_p)
                      op_p->u.k_remove.key.buffer_sz,
                      (char *)op_p->u.k_remove.key.buffer);
     }
-                 
+
+    PINT_dbpf_keyval_session_invalidate(op_p->coll_p->sessions,
+                                        op_p->handle);
+
     ret = dbpf_keyval_do_remove(op_p->coll_p->keyval_db, 
                                 op_p->handle,
                                 (op_p->flags & TROVE_KEYVAL_DIRECTORY_ENTRY ?
@@ -574,6 +597,11 @@ static int dbpf_keyval_remove_op_svc(struct dbpf_op *op_p)
         goto return_error;
     }
 
+    if (dbpf_keyval_attr_cacheable(op_p->flags, &op_p->u.k_remove.key))
+    {
+        dbpf_attr_cache_keyval_invalidate(ref, op_p->u.k_remove.key.buffer);
+    }
+
     ret = dbpf_keyval_handle_info_ops(op_p, DBPF_KEYVAL_HANDLE_COUNT_DECREMENT);
     if(ret != 0)
     {
@@ -645,9 +673,13 @@ static int dbpf_keyval_remove_list_op_svc(struct dbpf_op *op_p)
 {
     struct dbpf_keyval_db_entry key_entry;
     TROVE_keyval_handle_info info;
+    TROVE_object_ref ref = {op_p->handle, op_p->coll_p->coll_id};
     int remove_count = 0, ret, k;
     struct dbpf_data key, data;
 
+    PINT_dbpf_keyval_session_invalidate(op_p->coll_p->sessions,
+                                        op_p->handle);
+
     /* read each key to see if it is present */
     for (k = 0; k < op_p->u.k_remove_list.count; k++)
     {
@@ -665,6 +697,12 @@ static int dbpf_keyval_remove_list_op_svc(struct dbpf_op *op_p)
         else
         {
             remove_count++;
+            if (dbpf_keyval_attr_cacheable(
+                    op_p->flags, &op_p->u.k_remove_list.key_array[k]))
+            {
+                dbpf_attr_cache_keyval_invalidate(
+                    ref, op_p->u.k_remove_list.key_array[k].buffer);
+            }
         }
     }
 
@@ -798,6 +836,7 @@ static int dbpf_keyval_iterate_op_svc(struct dbpf_op *op_p)
     int count, ret;
     uint64_t tmp_pos = 0;
     PINT_dbpf_keyval_iterate_callback tmp_callback = NULL;
+    dbpf_cursor *dbc = NULL;
     int i;
 
     assert(*op_p->u.k_iterate.count_p > 0);
@@ -824,6 +863,8 @@ static int dbpf_keyval_iterate_op_svc(struct dbpf_op *op_p)
     if(op_p->flags & TROVE_KEYVAL_ITERATE_REMOVE)
     {
         tmp_callback = PINT_dbpf_dspace_remove_keyval;
+        PINT_dbpf_keyval_session_invalidate(op_p->coll_p->sessions,
+                                            op_p->handle);
     }
 
     ret = PINT_dbpf_keyval_iterate(op_p->coll_p->keyval_db,
@@ -832,11 +873,13 @@ static int dbpf_keyval_iterate_op_svc(struct dbpf_op *op_p)
                                        DBPF_DIRECTORY_ENTRY_TYPE :
                                        DBPF_ATTRIBUTE_TYPE),
                                    op_p->coll_p->pcache,
+                                   op_p->coll_p->sessions,
                                    op_p->u.k_iterate.key_array,
                                    op_p->u.k_iterate.val_array,
                                    &count,
                                    *op_p->u.k_iterate.position_p,
-                                   tmp_callback);
+                                   tmp_callback,
+                                   tmp_callback ? NULL : &dbc);
     if (ret == -TROVE_ENOENT)
     {
         *op_p->u.k_iterate.position_p = TROVE_ITERATE_END;
@@ -878,6 +921,19 @@ static int dbpf_keyval_iterate_op_svc(struct dbpf_op *op_p)
                 op_p->u.k_iterate.key_array[count-1].read_sz);
         }
 
+        if(dbc)
+        {
+            /* the next page can carry on from here */
+            PINT_dbpf_keyval_session_put(
+                op_p->coll_p->sessions,
+                op_p->handle,
+                (op_p->flags & TROVE_KEYVAL_DIRECTORY_ENTRY ?
+                    DBPF_DIRECTORY_ENTRY_TYPE :
+                    DBPF_ATTRIBUTE_TYPE),
+                *op_p->u.k_iterate.position_p,
+                dbc);
+        }
+
         if(op_p->flags & TROVE_KEYVAL_ITERATE_REMOVE)
         {
             for(i=0; i<count; i++)
@@ -893,6 +949,14 @@ static int dbpf_keyval_iterate_op_svc(struct dbpf_op *op_p)
     
     *op_p->u.k_iterate.count_p = count;
 
+    if((op_p->flags & TROVE_KEYVAL_ITERATE_REMOVE) &&
+       DBPF_KEYVAL_ATTR_CACHEABLE(op_p->flags))
+    {
+        /* whatever was removed is no longer what the cache holds */
+        TROVE_object_ref ref = {op_p->handle, op_p->coll_p->coll_id};
+        dbpf_attr_cache_keyval_invalidate(ref, NULL);
+    }
+
     gossip_debug(GOSSIP_DBPF_KEYVAL_DEBUG, 
                  "dbpf_keyval_iterate_op_svc: finished: "
                  "position: %llu, count: %d\n", 
@@ -974,6 +1038,7 @@ static int dbpf_keyval_iterate_keys_op_svc(struct dbpf_op *op_p)
 {
     int count, ret;
     PINT_dbpf_keyval_iterate_callback tmp_callback = NULL;
+    dbpf_cursor *dbc = NULL;
     int i;
     char type;
 
@@ -992,6 +1057,8 @@ static int dbpf_keyval_iterate_keys_op_svc(struct dbpf_op *op_p)
     if(op_p->flags & TROVE_KEYVAL_ITERATE_REMOVE)
     {
         tmp_callback = PINT_dbpf_dspace_remove_keyval;
+        PINT_dbpf_keyval_session_invalidate(op_p->coll_p->sessions,
+                                            op_p->handle);
     }
 
     /* set type */
@@ -1008,12 +1075,14 @@ static int dbpf_keyval_iterate_keys_op_svc(struct dbpf_op *op_p)
                                    op_p->handle,
                                    type,
                                    op_p->coll_p->pcache,
+                                   op_p->coll_p->sessions,
                                    (count != 0) ?
                                    op_p->u.k_iterate_keys.key_array : NULL,
                                    NULL,
                                    &count,
                                    *op_p->u.k_iterate_keys.position_p,
-                                   tmp_callback);
+                                   tmp_callback,
+                                   tmp_callback ? NULL : &dbc);
     if (ret == -TROVE_ENOENT)
     {
         *op_p->u.k_iterate_keys.position_p = TROVE_ITERATE_END;
@@ -1047,6 +1116,14 @@ static int dbpf_keyval_iterate_keys_op_svc(struct dbpf_op *op_p)
                 op_p->u.k_iterate_keys.key_array[count-1].buffer,
                 op_p->u.k_iterate_keys.key_array[count-1].read_sz);
         }
+        if(dbc)
+        {
+            PINT_dbpf_keyval_session_put(op_p->coll_p->sessions,
+                                         op_p->handle,
+                                         type,
+                                         *op_p->u.k_iterate_keys.position_p,
+                                         dbc);
+        }
         if(op_p->flags & TROVE_KEYVAL_ITERATE_REMOVE)
         {
             for(i=0; i<count; i++)
@@ -1061,6 +1138,14 @@ static int dbpf_keyval_iterate_keys_op_svc(struct dbpf_op *op_p)
     }
 
     *op_p->u.k_iterate_keys.count_p = count;
+
+    if((op_p->flags & TROVE_KEYVAL_ITERATE_REMOVE) &&
+       DBPF_KEYVAL_ATTR_CACHEABLE(op_p->flags))
+    {
+        /* whatever was removed is no longer what the cache holds */
+        TROVE_object_ref ref = {op_p->handle, op_p->coll_p->coll_id};
+        dbpf_attr_cache_keyval_invalidate(ref, NULL);
+    }
     return 1;
 }
 
@@ -1082,7 +1167,46 @@ static int dbpf_keyval_read_list(TROVE_coll_id coll_id,
     struct dbpf_op op;
     struct dbpf_op *op_p;
     struct dbpf_collection *coll_p = NULL;
-    int ret;
+    TROVE_object_ref ref = {handle, coll_id};
+    int ret, i, read_sz;
+    int success_count = 0;
+
+    /*
+     * fast path: if the cache knows every key, either its value or that
+     * it is absent, complete here the same way the service routine would
+     */
+    if (DBPF_KEYVAL_ATTR_CACHEABLE(flags))
+    {
+        for(i = 0; i < count; i++)
+        {
+            if (!dbpf_keyval_attr_cacheable(flags, &key_array[i]))
+            {
+                break;
+            }
+            read_sz = val_array[i].buffer_sz;
+            ret = dbpf_attr_cache_keyval_fetch_cached_data(
+                ref, key_array[i].buffer, val_array[i].buffer, &read_sz);
+            if (ret == 0)
+            {
+                val_array[i].read_sz = read_sz;
+                err_array[i] = 0;
+                success_count++;
+            }
+            else if (ret == -TROVE_ENOENT)
+            {
+                val_array[i].read_sz = 0;
+                err_array[i] = -TROVE_ENOENT;
+            }
+            else
+            {
+                break;
+            }
+        }
+        if (i == count && count > 0)
+        {
+            return (success_count ? 1 : err_array[0]);
+        }
+    }
 
     coll_p = dbpf_collection_find_registered(coll_id);
     if (coll_p == NULL)
@@ -1121,8 +1245,15 @@ static int dbpf_keyval_read_list_op_svc(struct dbpf_op *op_p)
     int ret, i = 0;
     struct dbpf_keyval_db_entry key_entry;
     struct dbpf_data key, data;
+    TROVE_object_ref ref = {op_p->handle, op_p->coll_p->coll_id};
+    uint32_t token = 0;
     int success_count = 0;
 
+    if (DBPF_KEYVAL_ATTR_CACHEABLE(op_p->flags))
+    {
+        token = dbpf_attr_cache_keyval_fill_token(ref);
+    }
+
     for(i = 0; i < op_p->u.k_read_list.count; i++)
     {
         key_entry.handle = op_p->handle;
@@ -1172,12 +1303,27 @@ static int dbpf_keyval_read_list_op_svc(struct dbpf_op *op_p)
             gossip_debug(GOSSIP_DBPF_KEYVAL_DEBUG,
                     "Trove error set to %d\n",
                     op_p->u.k_read_list.err_array[i]);
+
+            if (ret == TROVE_ENOENT &&
+                dbpf_keyval_attr_cacheable(
+                    op_p->flags, &op_p->u.k_read_list.key_array[i]))
+            {
+                dbpf_attr_cache_keyval_fill(
+                    ref, key_entry.key, NULL, 0, token);
+            }
         }
         else
         {
             success_count++;
             op_p->u.k_read_list.err_array[i] = 0;
             op_p->u.k_read_list.val_array[i].read_sz = data.len;
+
+            if (dbpf_keyval_attr_cacheable(
+                    op_p->flags, &op_p->u.k_read_list.key_array[i]))
+            {
+                dbpf_attr_cache_keyval_fill(
+                    ref, key_entry.key, data.data, data.len, token);
+            }
         }
     }
 
@@ -1251,10 +1397,13 @@ static int dbpf_keyval_write_list_op_svc(struct dbpf_op *op_p)
     int ret = -TROVE_EINVAL;
     struct dbpf_keyval_db_entry key_entry;
     struct dbpf_data key, data;
-    dbpf_attr_cache_elem_t *cache_elem = NULL;
     TROVE_object_ref ref = {op_p->handle, op_p->coll_p->coll_id};
     int k;
     char tmpdata[PVFS_NAME_MAX];
+
+    PINT_dbpf_keyval_session_invalidate(op_p->coll_p->sessions,
+                                        op_p->handle);
+
     key_entry.handle = op_p->handle;
     if (op_p->flags & TROVE_KEYVAL_DIRECTORY_ENTRY)
     {
@@ -1362,34 +1511,29 @@ static int dbpf_keyval_write_list_op_svc(struct dbpf_op *op_p)
            now that the data is written to disk, update the cache if it's
            an attr keyval we manage.
            */
-        if(!(op_p->flags & TROVE_BINARY_KEY))
+        if (dbpf_keyval_attr_cacheable(
+                op_p->flags, &op_p->u.k_write_list.key_array[k]))
         {
-            gen_mutex_lock(&dbpf_attr_cache_mutex);
-            cache_elem = dbpf_attr_cache_elem_lookup(ref);
-            if (cache_elem)
+            if (dbpf_attr_cache_elem_set_data_based_on_key(
+                    ref, key_entry.key,
+                    data.data, data.len))
             {
-                if (dbpf_attr_cache_elem_set_data_based_on_key(
-                        ref, key_entry.key,
-                        data.data, data.len))
-                {
-                    /*
-                     * NOTE: this can happen if the keyword isn't registered,
-                     * or if there is no associated cache_elem for this key
-                     */
-                    gossip_debug(
-                        GOSSIP_DBPF_ATTRCACHE_DEBUG,"** CANNOT cache data written "
-                        "(key is %s)\n", 
-                        (char *)key_entry.key);
-                }
-                else
-                {
-                    gossip_debug(
-                        GOSSIP_DBPF_ATTRCACHE_DEBUG,"*** cached keyval data "
-                        "written (key is %s)\n",
-                        (char *)key_entry.key);
-                }
+                /*
+                 * NOTE: this can happen if the keyword isn't registered,
+                 * or if there is no associated cache_elem for this key
+                 */
+                gossip_debug(
+                    GOSSIP_DBPF_ATTRCACHE_DEBUG,"** CANNOT cache data written "
+                    "(key is %s)\n", 
+                    (char *)key_entry.key);
+            }
+            else
+            {
+                gossip_debug(
+                    GOSSIP_DBPF_ATTRCACHE_DEBUG,"*** cached keyval data "
+                    "written (key is %s)\n",
+                    (char *)key_entry.key);
             }
-            gen_mutex_unlock(&dbpf_attr_cache_mutex);
         }
     }
 
@@ -1458,19 +1602,31 @@ return_error:
     return ret;
 }    
 
+/* PINT_dbpf_keyval_iterate()
+ *
+ * reads up to *count keyvals of handle starting after pos.  An
+ * iteration that continues one parked in sessions resumes on its
+ * cursor; otherwise the cursor is moved to pos through the pcache.
+ *
+ * If keep_dbc is not NULL and a full page was read, the cursor is
+ * left open on the last entry read and returned in *keep_dbc, for the
+ * caller to park under the position it hands back.
+ */
 int PINT_dbpf_keyval_iterate(dbpf_db *db,
                              TROVE_handle handle,
                              char type,
                              PINT_dbpf_keyval_pcache *pcache,    
+                             PINT_dbpf_keyval_session *sessions,
                              TROVE_keyval_s *keys_array,
                              TROVE_keyval_s *values_array,
                              int *count,
                              TROVE_ds_position pos,
-                             PINT_dbpf_keyval_iterate_callback callback)
+                             PINT_dbpf_keyval_iterate_callback callback,
+                             dbpf_cursor **keep_dbc)
 {
 
     int ret = -TROVE_EINVAL, i=0, get_key_count=0;
-    dbpf_cursor *dbc;
+    dbpf_cursor *dbc = NULL;
     char keybuffer[PVFS_NAME_MAX];
     TROVE_keyval_s skey;
     TROVE_keyval_s *key;
@@ -1483,7 +1639,29 @@ int PINT_dbpf_keyval_iterate(dbpf_db *db,
     skey.buffer_sz = PVFS_NAME_MAX;
     key = &skey;
 
-    ret = dbpf_db_cursor(db, &dbc, 0);
+    if (keep_dbc)
+    {
+        *keep_dbc = NULL;
+        if (pos != TROVE_ITERATE_START && *count > 0)
+        {
+            dbc = PINT_dbpf_keyval_session_take(sessions, handle, type, pos);
+        }
+    }
+
+    if (dbc)
+    {
+        /* the cursor is still on the last entry of the previous page */
+        gossip_debug(GOSSIP_DBPF_KEYVAL_DEBUG,
+                     "PINT_dbpf_keyval_iterate: continuing %llu at %llu\n",
+                     llu(handle), llu(pos));
+        PINT_perf_count(sessions->pc, PERF_KEYVAL_ITERATE_CONTINUE,
+                        1, PINT_PERF_ADD);
+        ret = 0;
+        goto cursor_ready;
+    }
+
+    /* only an iteration that removes entries needs a writable cursor */
+    ret = dbpf_db_cursor(db, &dbc, callback ? 0 : 1);
     if (ret != 0)
     {
         gossip_debug(GOSSIP_DBPF_KEYVAL_DEBUG,
@@ -1496,6 +1674,11 @@ int PINT_dbpf_keyval_iterate(dbpf_db *db,
 
     if(pos == TROVE_ITERATE_START)
     {
+        if (sessions)
+        {
+            PINT_perf_count(sessions->pc, PERF_KEYVAL_ITERATE_START,
+                            1, PINT_PERF_ADD);
+        }
         ret = dbpf_keyval_iterate_get_first_entry(handle, type, dbc);
         if(ret != 0)
         {
@@ -1510,6 +1693,7 @@ int PINT_dbpf_keyval_iterate(dbpf_db *db,
                                                    type,
                                                    pos,
                                                    pcache,
+                                                   sessions,
                                                    dbc);
         if(ret != 0 && ret != DBPF_ITERATE_CURRENT_POSITION)
         {
@@ -1517,6 +1701,7 @@ int PINT_dbpf_keyval_iterate(dbpf_db *db,
         }
     }
 
+cursor_ready:
     if (*count == 0)
     {
         get_key_count = 1;
@@ -1604,10 +1789,17 @@ int PINT_dbpf_keyval_iterate(dbpf_db *db,
 
 return_error:
 
-    *count = i;
+    if (keep_dbc && ret == 0 && i == *count && i > 0)
+    {
+        *keep_dbc = dbc;
+    }
+    else
+    {
+        /* free the cursor */
+        dbpf_db_cursor_close(dbc);
+    }
 
-    /* free the cursor */
-    dbpf_db_cursor_close(dbc);
+    *count = i;
 
     gossip_debug(GOSSIP_DBPF_KEYVAL_DEBUG,
                  "Exited: PINT_dpbf_keyval_iterate\n");
@@ -1705,6 +1897,7 @@ static int dbpf_keyval_iterate_skip_to_position(
     char type,
     TROVE_ds_position pos,
     PINT_dbpf_keyval_pcache *pcache,
+    PINT_dbpf_keyval_session *sessions,
     dbpf_cursor *dbc)
 {
     int ret = 0;
@@ -1727,9 +1920,20 @@ static int dbpf_keyval_iterate_skip_to_position(
          * integer offset if we get past the cache
          */
         pos = pos & 0xffffffff;
+        if (sessions)
+        {
+            PINT_perf_count(sessions->pc, PERF_KEYVAL_ITERATE_STEP,
+                            1, PINT_PERF_ADD);
+        }
         return dbpf_keyval_iterate_step_to_position(handle, type, pos, dbc);
     }
 
+    if (sessions)
+    {
+        PINT_perf_count(sessions->pc, PERF_KEYVAL_ITERATE_SEEK,
+                        1, PINT_PERF_ADD);
+    }
+
     ret = dbpf_keyval_iterate_cursor_get(
         handle, type, dbc, &key, NULL, DBPF_DB_CURSOR_SET);
     if(ret == -TROVE_ENOENT)
@@ -33,6 +33,7 @@
 #include "dbpf.h"
 #include "dbpf-op-queue.h"
 #include "dbpf-bstream.h"
+#include "dbpf-bstream-direct.h"
 #include "dbpf-thread.h"
 #include "dbpf-attr-cache.h"
 #include "trove-ledger.h"
@@ -144,6 +145,9 @@ both so that the client can properly compute all values.
 
                 return 1;
             }
+        case PVFS_COLLECTION_ATTR_CACHE_STATS:
+            dbpf_attr_cache_get_stats((TROVE_attr_cache_stats *)parameter);
+            return 1;
     }
     return ret;
 }
@@ -557,6 +561,15 @@ static int start_directio_threads(void)
         return(0);
     }
 
+    /* the size table stays up until dbpf_finalize, across restarts of the
+     * threads by collection clear and lookup */
+    ret = dbpf_bstream_direct_size_initialize();
+    if(ret < 0)
+    {
+        dbpf_finalize();
+        return ret;
+    }
+
     ret = PINT_open_context(&io_ctx, PINT_dbpf_io_completion_callback);
     if(ret < 0)
     {
@@ -659,6 +672,9 @@ int dbpf_finalize(void)
     int ret = -TROVE_EINVAL;
 
     dbpf_thread_finalize();
+    /* with no writes left, store the direct I/O sizes still waiting for
+     * write back */
+    dbpf_bstream_direct_size_finalize();
     dbpf_open_cache_finalize();
     gen_mutex_lock(&dbpf_attr_cache_mutex);
     dbpf_attr_cache_finalize();
@@ -1141,6 +1157,7 @@ int dbpf_collection_remove(char *collname,
     }
     else {
         /* Clean up properly by closing all db handles */
+        PINT_dbpf_keyval_session_finalize(db_collection->sessions);
         dbpf_db_close(db_collection->coll_attr_db);
         dbpf_db_close(db_collection->ds_db);
         dbpf_db_close(db_collection->keyval_db);
@@ -1399,6 +1416,9 @@ int dbpf_collection_clear(TROVE_coll_id coll_id)
         gossip_err("db_sync(coll_keyval_db): %s\n", strerror(ret));
     }
 
+    /* parked cursors must go before their database */
+    PINT_dbpf_keyval_session_finalize(coll_p->sessions);
+
     if ( (coll_p->keyval_db != NULL ) &&
          (ret = dbpf_db_close(coll_p->keyval_db)) != 0) 
     {
@@ -1655,6 +1675,20 @@ int dbpf_collection_lookup(char *collname,
         return -TROVE_ENOMEM;
     }
 
+    coll_p->sessions = PINT_dbpf_keyval_session_initialize();
+    if(!coll_p->sessions)
+    {
+        PINT_dbpf_keyval_pcache_finalize(coll_p->pcache);
+        dbpf_db_close(coll_p->coll_attr_db);
+        dbpf_db_close(coll_p->keyval_db);
+        dbpf_db_close(coll_p->ds_db);
+        free(coll_p->meta_path);
+        free(coll_p->data_path);
+        free(coll_p->name);
+        free(coll_p);
+        return -TROVE_ENOMEM;
+    }
+
     coll_p->next_p = NULL;
 
     /*
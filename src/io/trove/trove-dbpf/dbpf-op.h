@@ -61,6 +61,9 @@ typedef struct
     /* the operation return code after being services */
     TROVE_ds_state state;
 
+    /* error committing a batched database write the op made */
+    int batch_error;
+
     PINT_event_type event_type;
     PINT_event_id event_id;
 
@@ -16,6 +16,8 @@
 #include "dbpf.h"
 #include "dbpf-thread.h"
 #include "dbpf-bstream.h"
+#include "dbpf-bstream-direct.h"
+#include "dbpf-attr-cache.h"
 #include "dbpf-op-queue.h"
 #include "dbpf-sync.h"
 #include "pint-context.h"
@@ -31,6 +33,10 @@ static pthread_t dbpf_thread;
 static int dbpf_thread_running = 0;
 pthread_cond_t dbpf_op_incoming_cond = PTHREAD_COND_INITIALIZER;
 pthread_cond_t dbpf_op_completed_cond = PTHREAD_COND_INITIALIZER;
+
+/* ops finished while a database batch had uncommitted writes, which
+ * they may have made or read; completed once the batch is committed */
+static QLIST_HEAD(dbpf_batch_held_ops);
 #endif
 
 extern int TROVE_max_concurrent_io;
@@ -79,6 +85,72 @@ int dbpf_thread_finalize(void)
 
 int synccount = 0;
 
+#ifdef __PVFS2_TROVE_THREADED__
+/* dbpf_batch_lost()
+ *
+ * called by the database for a batched write of op that could not be
+ * committed; the op completes with the error.  the keyval writers
+ * already put the values in the attr cache when the write was queued,
+ * so the cached keyvals of the handle are dropped; the cache never
+ * calls into the database, so this is safe under the database mutex.
+ */
+static void dbpf_batch_lost(void *op, int error)
+{
+    dbpf_queued_op_t *qop_p = op;
+    TROVE_object_ref ref;
+
+    if (qop_p && qop_p->batch_error == 0)
+    {
+        qop_p->batch_error = -error;
+    }
+    if (qop_p && qop_p->op.coll_p)
+    {
+        ref.handle = qop_p->op.handle;
+        ref.fs_id = qop_p->op.coll_p->coll_id;
+        dbpf_attr_cache_keyval_invalidate(ref, NULL);
+    }
+}
+
+/* dbpf_op_finished()
+ *
+ * passes qop_p, which its service routine is done with, on to the sync
+ * coalescing, unless a database batch has uncommitted writes; then it
+ * is held until the batch is committed.  with a NULL qop_p just
+ * completes the held ops if the batches are committed.
+ */
+static int dbpf_op_finished(dbpf_queued_op_t *qop_p, int retcode,
+                            int *out_count)
+{
+    int ret;
+
+    if (qop_p)
+    {
+        qop_p->state = retcode;
+        dbpf_op_queue_add(&dbpf_batch_held_ops, qop_p);
+    }
+    if (dbpf_db_batch_pending())
+    {
+        return 0;
+    }
+    while (!dbpf_op_queue_empty(&dbpf_batch_held_ops))
+    {
+        qop_p = dbpf_op_queue_shownext(&dbpf_batch_held_ops);
+        dbpf_op_queue_remove(qop_p);
+        retcode = qop_p->state;
+        if (retcode == 0 && qop_p->batch_error)
+        {
+            retcode = qop_p->batch_error;
+        }
+        ret = dbpf_sync_coalesce(qop_p, retcode, out_count);
+        if (ret < 0)
+        {
+            return ret;
+        }
+    }
+    return 0;
+}
+#endif
+
 void *dbpf_thread_function(void *ptr)
 {
 #ifdef __PVFS2_TROVE_THREADED__
@@ -89,16 +161,33 @@ void *dbpf_thread_function(void *ptr)
     gossip_debug(GOSSIP_TROVE_DEBUG, "dbpf_thread_function started\n");
 
     PINT_event_thread_start("TROVE-DBPF");
+    /* the ops serviced here share database write transactions, which
+     * are committed as they fill up or age and before going idle */
+    dbpf_db_batch_begin(dbpf_batch_lost);
     while(dbpf_thread_running)
     {
+        /* direct I/O bstream sizes are written back on a timer */
+        dbpf_bstream_direct_size_write_back();
+
         /* check if we any have ops to service in our work queue */
         gen_mutex_lock(&dbpf_op_queue_mutex);
         op_queued_empty = qlist_empty(&dbpf_op_queue);
 
+        if (op_queued_empty)
+        {
+            gen_mutex_unlock(&dbpf_op_queue_mutex);
+            dbpf_db_batch_flush(1);
+            dbpf_op_finished(NULL, 0, &out_count);
+            gen_mutex_lock(&dbpf_op_queue_mutex);
+            op_queued_empty = qlist_empty(&dbpf_op_queue);
+        }
+
         if (!op_queued_empty)
         {
             gen_mutex_unlock(&dbpf_op_queue_mutex);
             dbpf_do_one_work_cycle(&out_count);
+            dbpf_db_batch_flush(0);
+            dbpf_op_finished(NULL, 0, &out_count);
 #ifndef __PVFS2_TROVE_AIO_THREADED__
             if(out_count == 0)
             {
@@ -148,6 +237,8 @@ void *dbpf_thread_function(void *ptr)
         }
     }
 
+    dbpf_db_batch_end();
+    dbpf_op_finished(NULL, 0, &out_count);
     gossip_debug(GOSSIP_TROVE_DEBUG, "dbpf_thread_function ending\n");
     PINT_event_thread_stop();
 #endif
@@ -204,7 +295,9 @@ int dbpf_do_one_work_cycle(int *out_count)
                      "SERVICE ROUTINE (%s)\n",
                      dbpf_op_type_to_str(cur_op->op.type));
 
+        dbpf_db_batch_tag(cur_op);
         ret = cur_op->op.svc_fn(&(cur_op->op));
+        dbpf_db_batch_tag(NULL);
 
         gossip_debug(GOSSIP_TROVE_OP_DEBUG,"[DBPF THREAD]: FINISHED TROVE "
                      "SERVICE ROUTINE (%s) (ret: %d)\n",
@@ -219,7 +312,7 @@ int dbpf_do_one_work_cycle(int *out_count)
              * and move _all_ the ready-to-be-synced operations to the
              * completion queue.
              */
-            ret = dbpf_sync_coalesce(cur_op, (ret == 1 ? 0 : ret), out_count);
+            ret = dbpf_op_finished(cur_op, (ret == 1 ? 0 : ret), out_count);
             if(ret < 0)
             {
                 return ret; /* not sure how to recover from failure here */
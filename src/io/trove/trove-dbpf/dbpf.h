@@ -21,6 +21,7 @@ extern "C" {
 #include "dbpf-open-cache.h"
 #include "pint-event.h"
 #include "dbpf-db.h"
+#include "dbpf-keyval-session.h"
 
 /* For unknown Berkeley DB errors, we return some large value
  */
@@ -175,11 +176,13 @@ int PINT_dbpf_keyval_iterate(
     TROVE_handle handle,
     char type,
     PINT_dbpf_keyval_pcache *pcache,    
+    PINT_dbpf_keyval_session *sessions,
     TROVE_keyval_s *keys_array,
     TROVE_keyval_s *values_array,
     int *count,
     TROVE_ds_position pos,
-    PINT_dbpf_keyval_iterate_callback callback);
+    PINT_dbpf_keyval_iterate_callback callback,
+    dbpf_cursor **keep_dbc);
 
 int PINT_dbpf_dspace_remove_keyval(
     dbpf_cursor *, TROVE_handle handle, TROVE_keyval_s *, TROVE_keyval_s *);
@@ -279,6 +282,7 @@ struct dbpf_collection
     struct dbpf_storage *storage;
     struct handle_ledger *free_handles;
     PINT_dbpf_keyval_pcache * pcache; /* the position cache for iterators */
+    PINT_dbpf_keyval_session *sessions; /* cursors of unfinished iterators */
 
     /* used by dbpf_collection.c calls to maintain list of collections */
     struct dbpf_collection *next_p;
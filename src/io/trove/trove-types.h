@@ -46,6 +46,7 @@ typedef PVFS_error                 TROVE_ds_state;
 typedef PVFS_context_id            TROVE_context_id;
 typedef PVFS_statfs		   TROVE_statfs;
 typedef PVFS_coll_getinfo_options  TROVE_coll_getinfo_options;
+typedef PVFS_ds_attr_cache_stats   TROVE_attr_cache_stats;
 typedef PVFS_object_ref            TROVE_object_ref;
 
 typedef enum
@@ -107,6 +107,7 @@ static void lebf_initialize(void)
             case PVFS_SERV_INVALID:
             case PVFS_SERV_PERF_UPDATE:
             case PVFS_SERV_PRECREATE_POOL_REFILLER:
+            case PVFS_SERV_PLACEMENT_STATS:
             case PVFS_SERV_JOB_TIMER:
                 /* never used, skip initialization */
                 continue;
@@ -359,6 +360,14 @@ static void lebf_initialize(void)
                 req.u.mgmt_get_user_cert_keyreq.fs_id = 0;
                 respsize = extra_size_PVFS_servresp_mgmt_get_user_cert_keyreq;
                 break;
+            case PVFS_SERV_CREATE_FILE:
+                zero_credential(&req.u.create_file.credential);
+                req.u.create_file.name = tmp_name;
+                req.u.create_file.data_size = 0;
+                zero_capability(&resp.u.create_file.metafile_attrs.capability);
+                reqsize = extra_size_PVFS_servreq_create_file;
+                respsize = extra_size_PVFS_servresp_create_file;
+                break;
             case PVFS_SERV_NUM_OPS:  /* sentinel, should not hit */
                 assert(0);
                 break;
@@ -488,6 +497,10 @@ static int lebf_encode_req(
         goto out;
     gossip_debug(GOSSIP_ENDECODE_DEBUG,"lebf_encode_req\n");
 
+    /* requests carry the minor version of their op, not ours */
+    *((int32_t *)target_msg->buffer_list[0]) = htobmi32(
+        (PVFS2_PROTO_MAJOR * 1000) + PVFS2_PROTO_REQ_MINOR(req->op));
+
     /* every request has these fields */
     p = &target_msg->ptr_current;
     encode_PVFS_server_req(p, req);
@@ -541,6 +554,7 @@ static int lebf_encode_req(
         CASE(PVFS_SERV_MGMT_SPLIT_DIRENT, mgmt_split_dirent);
         CASE(PVFS_SERV_MGMT_GET_USER_CERT, mgmt_get_user_cert);
         CASE(PVFS_SERV_MGMT_GET_USER_CERT_KEYREQ, mgmt_get_user_cert_keyreq);
+        CASE(PVFS_SERV_CREATE_FILE, create_file);
         case PVFS_SERV_GETCONFIG:
         case PVFS_SERV_MGMT_NOOP:
         case PVFS_SERV_PROTO_ERROR:
@@ -552,6 +566,7 @@ static int lebf_encode_req(
         case PVFS_SERV_WRITE_COMPLETION:
         case PVFS_SERV_PERF_UPDATE:
         case PVFS_SERV_PRECREATE_POOL_REFILLER:
+        case PVFS_SERV_PLACEMENT_STATS:
         case PVFS_SERV_JOB_TIMER:
         case PVFS_SERV_NUM_OPS:  /* sentinel */
             gossip_err("%s: invalid operation %d\n", __func__, req->op);
@@ -646,6 +661,7 @@ static int lebf_encode_resp(
         CASE(PVFS_SERV_MGMT_GET_DIRENT, mgmt_get_dirent);
         CASE(PVFS_SERV_MGMT_GET_USER_CERT, mgmt_get_user_cert);
         CASE(PVFS_SERV_MGMT_GET_USER_CERT_KEYREQ, mgmt_get_user_cert_keyreq);
+        CASE(PVFS_SERV_CREATE_FILE, create_file);
         case PVFS_SERV_REMOVE:
         case PVFS_SERV_MGMT_REMOVE_OBJECT:
         case PVFS_SERV_MGMT_REMOVE_DIRENT:
@@ -668,6 +684,7 @@ static int lebf_encode_resp(
         case PVFS_SERV_INVALID:
         case PVFS_SERV_PERF_UPDATE:
         case PVFS_SERV_PRECREATE_POOL_REFILLER:
+        case PVFS_SERV_PLACEMENT_STATS:
         case PVFS_SERV_JOB_TIMER:
         case PVFS_SERV_NUM_OPS:  /* sentinel */
             gossip_err("%s: invalid operation %d\n", __func__, resp->op);
@@ -769,6 +786,7 @@ static int lebf_decode_req(
         CASE(PVFS_SERV_MGMT_SPLIT_DIRENT, mgmt_split_dirent);
         CASE(PVFS_SERV_MGMT_GET_USER_CERT, mgmt_get_user_cert);
         CASE(PVFS_SERV_MGMT_GET_USER_CERT_KEYREQ, mgmt_get_user_cert_keyreq);
+        CASE(PVFS_SERV_CREATE_FILE, create_file);
         case PVFS_SERV_GETCONFIG:
         case PVFS_SERV_MGMT_NOOP:
         case PVFS_SERV_IMM_COPIES:
@@ -779,6 +797,7 @@ static int lebf_decode_req(
         case PVFS_SERV_WRITE_COMPLETION:
         case PVFS_SERV_PERF_UPDATE:
         case PVFS_SERV_PRECREATE_POOL_REFILLER:
+        case PVFS_SERV_PLACEMENT_STATS:
         case PVFS_SERV_JOB_TIMER:
         case PVFS_SERV_PROTO_ERROR:
         case PVFS_SERV_NUM_OPS:  /* sentinel */
@@ -864,6 +883,7 @@ static int lebf_decode_resp(
         CASE(PVFS_SERV_MGMT_GET_DIRENT, mgmt_get_dirent);
         CASE(PVFS_SERV_MGMT_GET_USER_CERT, mgmt_get_user_cert);
         CASE(PVFS_SERV_MGMT_GET_USER_CERT_KEYREQ, mgmt_get_user_cert_keyreq);
+        CASE(PVFS_SERV_CREATE_FILE, create_file);
         case PVFS_SERV_REMOVE:
         case PVFS_SERV_BATCH_REMOVE:
         case PVFS_SERV_MGMT_REMOVE_OBJECT:
@@ -886,6 +906,7 @@ static int lebf_decode_resp(
         case PVFS_SERV_INVALID:
         case PVFS_SERV_PERF_UPDATE:
         case PVFS_SERV_PRECREATE_POOL_REFILLER:
+        case PVFS_SERV_PLACEMENT_STATS:
         case PVFS_SERV_JOB_TIMER:
         case PVFS_SERV_NUM_OPS:  /* sentinel */
             gossip_lerr("%s: invalid operation %d.\n", __func__, resp->op);
@@ -961,6 +982,18 @@ static void lebf_decode_rel(struct PINT_decoded_msg *msg,
                     req->u.batch_create.handle_extent_array.extent_array);
                 break;
 
+            case PVFS_SERV_CREATE_FILE:
+                decode_free(req->u.create_file.credential.group_array);
+                decode_free(req->u.create_file.credential.signature);
+#ifdef ENABLE_SECURITY_CERT
+                decode_free(req->u.create_file.credential.certificate.buf);
+#endif
+                if (req->u.create_file.attr.mask & PVFS_ATTR_META_DIST)
+                    decode_free(req->u.create_file.attr.u.meta.dist);
+                if (req->u.create_file.layout.server_list.servers)
+                    decode_free(req->u.create_file.layout.server_list.servers);
+                break;
+
             case PVFS_SERV_IO:
                 decode_free(req->u.io.io_dist);
                 decode_free(req->u.io.file_req);
@@ -1160,6 +1193,7 @@ static void lebf_decode_rel(struct PINT_decoded_msg *msg,
             case PVFS_SERV_WRITE_COMPLETION:
             case PVFS_SERV_PERF_UPDATE:
             case PVFS_SERV_PRECREATE_POOL_REFILLER:
+            case PVFS_SERV_PLACEMENT_STATS:
             case PVFS_SERV_JOB_TIMER:
             case PVFS_SERV_PROTO_ERROR:            
             case PVFS_SERV_NUM_OPS:  /* sentinel */
@@ -1211,6 +1245,18 @@ static void lebf_decode_rel(struct PINT_decoded_msg *msg,
                        }
                     break;
 
+                case PVFS_SERV_CREATE_FILE:
+                       if ( resp->u.create_file.metafile_attrs.mask & PVFS_ATTR_CAPABILITY )
+                       {
+                          decode_free(resp->u.create_file.metafile_attrs.capability.signature);
+                          decode_free(resp->u.create_file.metafile_attrs.capability.handle_array);
+                       }
+                       if ( resp->u.create_file.metafile_attrs.mask & PVFS_ATTR_META_DFILES )
+                       {
+                          decode_free(resp->u.create_file.metafile_attrs.u.meta.dfile_array);
+                       }
+                    break;
+
                 case PVFS_SERV_MGMT_DSPACE_INFO_LIST:
                     decode_free(resp->u.mgmt_dspace_info_list.dspace_info_array);
                     break;
@@ -1396,6 +1442,7 @@ static void lebf_decode_rel(struct PINT_decoded_msg *msg,
                 case PVFS_SERV_INVALID:
                 case PVFS_SERV_PERF_UPDATE:
                 case PVFS_SERV_PRECREATE_POOL_REFILLER:
+                case PVFS_SERV_PLACEMENT_STATS:
                 case PVFS_SERV_JOB_TIMER:
                 case PVFS_SERV_NUM_OPS:  /* sentinel */
                     gossip_lerr("%s: invalid response operation %d.\n",
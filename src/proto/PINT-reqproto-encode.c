@@ -218,18 +218,9 @@ int PINT_decode(void* input_buffer,
         return(-PVFS_EPROTONOSUPPORT);
     }
 
-    if((input_type == PINT_DECODE_RESP) && 
-        (proto_minor_recved < PVFS2_PROTO_MINOR))
-    {
-        gossip_err("Error: poorly formatted protocol message received.\n");
-	gossip_err("   Protocol version mismatch: request has minor version %d when "
-	    "expecting %d or higher.\n", (int)proto_minor_recved,
-	    PVFS2_PROTO_MINOR);
-        gossip_err("   Server is too old for client.\n");
-	gossip_err("   Please verify your OrangeFS installation\n");
-        gossip_err("   and make sure that the version is consistent.\n");
-        return(-PVFS_EPROTONOSUPPORT);
-    }
+    /* responses from servers with an older minor version are fine; a
+     * request they cannot serve comes back as PVFS_SERV_PROTO_ERROR
+     */
 
     for(i=0; i<ENCODING_TABLE_SIZE; i++)
     {
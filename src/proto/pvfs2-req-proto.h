@@ -29,13 +29,20 @@
 #define PVFS2_PROTO_MAJOR 7
 /* update PVFS2_PROTO_MINOR on wire protocol changes that preserve backwards
  * compatibility (such as adding a new request type)
- * NOTE: Incrementing this will make clients unable to talk to older servers.
- * Do not change until we have a new version policy.
+ * NOTE: requests do not carry PVFS2_PROTO_MINOR; each carries the minor
+ * version that introduced its op (see PVFS2_PROTO_REQ_MINOR), so older
+ * servers keep serving every op they know and answer new ones with
+ * PVFS_SERV_PROTO_ERROR.  Responses of any minor version are accepted.
+ * Give each new request type the new minor in PVFS2_PROTO_REQ_MINOR.
  */
-#define PVFS2_PROTO_MINOR 0
+#define PVFS2_PROTO_MINOR 1
 
 #define PVFS2_PROTO_VERSION ((PVFS2_PROTO_MAJOR*1000)+(PVFS2_PROTO_MINOR))
 
+/* minor version a request of type __op is sent with */
+#define PVFS2_PROTO_REQ_MINOR(__op) \
+    ((__op) == PVFS_SERV_CREATE_FILE ? 1 : 0)
+
 /* we set the maximum possible size of a small I/O packed message as 64K.  This
  * is an upper limit that is used to allocate the request and response encoded
  * buffers, and is independent of the max unexpected message size of the specific
@@ -98,6 +105,8 @@ enum PVFS_server_op
     PVFS_SERV_TREE_GETATTR = 49,
     PVFS_SERV_MGMT_GET_USER_CERT = 50,
     PVFS_SERV_MGMT_GET_USER_CERT_KEYREQ = 51,
+    PVFS_SERV_CREATE_FILE = 52,
+    PVFS_SERV_PLACEMENT_STATS = 53, /* not a real protocol request */
 
     /* leave this entry last */
     PVFS_SERV_NUM_OPS
@@ -271,6 +280,122 @@ endecode_fields_3_struct(PVFS_servresp_create,        \
 #define extra_size_PVFS_servresp_create \
    (extra_size_PVFS_object_attr)
 
+/* create_file ****************************************************/
+/* - creates a stuffed file, writes its initial data and inserts the
+ * directory entry in one request.  It is sent to the server holding the
+ * dirdata handle the entry belongs in; that server also becomes the
+ * metadata server of the new file.  The data must fit in the first strip
+ * of the file, or the server answers -PVFS_EOPNOTSUPP and the client
+ * falls back to the create/crdirent/small_io sequence.
+ */
+
+struct PVFS_servreq_create_file
+{
+    PVFS_fs_id fs_id;
+    PVFS_credential credential;
+    char *name;                 /* name of new entry */
+    PVFS_handle parent_handle;  /* handle of directory */
+    PVFS_handle dirent_handle;  /* handle of directory entries */
+    PVFS_object_attr attr;
+    int32_t num_dfiles_req;
+    PVFS_size data_size;
+    PVFS_sys_layout layout;
+    char *data;                 /* not copied on decode, see small_io */
+};
+
+#ifdef __PINT_REQPROTO_ENCODE_FUNCS_C
+#define encode_PVFS_servreq_create_file(pptr,x) do {        \
+    encode_PVFS_fs_id(pptr, &(x)->fs_id);                   \
+    encode_skip4(pptr,);                                    \
+    encode_PVFS_credential(pptr, &(x)->credential);         \
+    encode_string(pptr, &(x)->name);                        \
+    encode_PVFS_handle(pptr, &(x)->parent_handle);          \
+    encode_PVFS_handle(pptr, &(x)->dirent_handle);          \
+    encode_PVFS_object_attr(pptr, &(x)->attr);              \
+    encode_int32_t(pptr, &(x)->num_dfiles_req);             \
+    encode_skip4(pptr,);                                    \
+    encode_PVFS_size(pptr, &(x)->data_size);                \
+    encode_PVFS_sys_layout(pptr, &(x)->layout);             \
+    if ((x)->data_size > 0)                                 \
+    {                                                       \
+        memcpy((*pptr), (x)->data, (x)->data_size);         \
+        (*pptr) += (x)->data_size;                          \
+    }                                                       \
+} while (0)
+
+#define decode_PVFS_servreq_create_file(pptr,x) do {        \
+    decode_PVFS_fs_id(pptr, &(x)->fs_id);                   \
+    decode_skip4(pptr,);                                    \
+    decode_PVFS_credential(pptr, &(x)->credential);         \
+    decode_string(pptr, &(x)->name);                        \
+    decode_PVFS_handle(pptr, &(x)->parent_handle);          \
+    decode_PVFS_handle(pptr, &(x)->dirent_handle);          \
+    decode_PVFS_object_attr(pptr, &(x)->attr);              \
+    decode_int32_t(pptr, &(x)->num_dfiles_req);             \
+    decode_skip4(pptr,);                                    \
+    decode_PVFS_size(pptr, &(x)->data_size);                \
+    decode_PVFS_sys_layout(pptr, &(x)->layout);             \
+    (x)->data = NULL;                                       \
+    if ((x)->data_size > 0)                                 \
+    {                                                       \
+        (x)->data = (*pptr);                                \
+        (*pptr) += (x)->data_size;                          \
+    }                                                       \
+} while (0)
+#endif
+
+#define extra_size_PVFS_servreq_create_file                     \
+    (roundup8(PVFS_REQ_LIMIT_SEGMENT_BYTES + 1) +               \
+     extra_size_PVFS_object_attr + extra_size_PVFS_sys_layout + \
+     extra_size_PVFS_credential + PINT_SMALL_IO_MAXSIZE)
+
+#define PINT_SERVREQ_CREATE_FILE_FILL(__req,                       \
+                                      __cap,                       \
+                                      __cred,                      \
+                                      __fsid,                      \
+                                      __name,                      \
+                                      __parent_handle,             \
+                                      __dirent_handle,             \
+                                      __attr,                      \
+                                      __num_dfiles_req,            \
+                                      __layout,                    \
+                                      __data,                      \
+                                      __data_size,                 \
+                                      __hints)                     \
+do {                                                               \
+    int mask;                                                      \
+    memset(&(__req), 0, sizeof(__req));                            \
+    (__req).op = PVFS_SERV_CREATE_FILE;                            \
+    PVFS_REQ_COPY_CAPABILITY((__cap), (__req));                    \
+    (__req).hints = (__hints);                                     \
+    (__req).u.create_file.fs_id = (__fsid);                        \
+    (__req).u.create_file.credential = (__cred);                   \
+    (__req).u.create_file.name = (__name);                         \
+    (__req).u.create_file.parent_handle = (__parent_handle);       \
+    (__req).u.create_file.dirent_handle = (__dirent_handle);       \
+    (__req).u.create_file.num_dfiles_req = (__num_dfiles_req);     \
+    (__attr).objtype = PVFS_TYPE_METAFILE;                         \
+    mask = (__attr).mask;                                          \
+    (__attr).mask = PVFS_ATTR_COMMON_ALL;                          \
+    (__attr).mask |= PVFS_ATTR_SYS_TYPE;                           \
+    PINT_copy_object_attr(&(__req).u.create_file.attr, &(__attr)); \
+    (__req).u.create_file.attr.mask |= mask;                       \
+    (__req).u.create_file.layout = __layout;                       \
+    (__req).u.create_file.data = (__data);                         \
+    (__req).u.create_file.data_size = (__data_size);               \
+} while (0)
+
+struct PVFS_servresp_create_file
+{
+   PVFS_handle metafile_handle;
+   PVFS_object_attr metafile_attrs;
+};
+endecode_fields_2_struct(PVFS_servresp_create_file,        \
+                         PVFS_handle,metafile_handle,      \
+                         PVFS_object_attr,metafile_attrs);
+#define extra_size_PVFS_servresp_create_file \
+   (extra_size_PVFS_object_attr)
+
 /* batch_create *********************************************************/
 /* - used to create new multiple metafile and datafile objects */
 
@@ -2603,6 +2728,7 @@ struct PVFS_server_req
         struct PVFS_servreq_mgmt_split_dirent mgmt_split_dirent;
         struct PVFS_servreq_mgmt_get_user_cert mgmt_get_user_cert;
         struct PVFS_servreq_mgmt_get_user_cert_keyreq mgmt_get_user_cert_keyreq;
+        struct PVFS_servreq_create_file create_file;
     } u;
 };
 #ifdef __PINT_REQPROTO_ENCODE_FUNCS_C
@@ -2667,6 +2793,7 @@ struct PVFS_server_resp
         struct PVFS_servresp_mgmt_get_dirent mgmt_get_dirent;
         struct PVFS_servresp_mgmt_get_user_cert mgmt_get_user_cert;
         struct PVFS_servresp_mgmt_get_user_cert_keyreq mgmt_get_user_cert_keyreq;
+        struct PVFS_servresp_create_file create_file;
     } u;
 };
 endecode_fields_2_struct(
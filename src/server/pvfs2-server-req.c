@@ -61,6 +61,8 @@ extern struct PINT_server_req_params pvfs2_mgmt_get_dirent_params;
 extern struct PINT_server_req_params pvfs2_mgmt_create_root_dir_params;
 extern struct PINT_server_req_params pvfs2_mgmt_split_dirent_params;
 extern struct PINT_server_req_params pvfs2_tree_getattr_params;
+extern struct PINT_server_req_params pvfs2_create_file_params;
+extern struct PINT_server_req_params pvfs2_placement_stats_params;
 #ifdef ENABLE_SECURITY_CERT
 extern struct PINT_server_req_params pvfs2_get_user_cert_params;
 extern struct PINT_server_req_params pvfs2_get_user_cert_keyreq_params;
@@ -121,11 +123,13 @@ struct PINT_server_req_entry PINT_server_req_table[] =
     /* 49 */ {PVFS_SERV_TREE_GETATTR, &pvfs2_tree_getattr_params},
 #ifdef ENABLE_SECURITY_CERT    
     /* 50 */ {PVFS_SERV_MGMT_GET_USER_CERT, &pvfs2_get_user_cert_params},
-    /* 51 */ {PVFS_SERV_MGMT_GET_USER_CERT_KEYREQ, &pvfs2_get_user_cert_keyreq_params}
+    /* 51 */ {PVFS_SERV_MGMT_GET_USER_CERT_KEYREQ, &pvfs2_get_user_cert_keyreq_params},
 #else
     /* 50 */ {PVFS_SERV_MGMT_GET_USER_CERT, NULL},
     /* 51 */ {PVFS_SERV_MGMT_GET_USER_CERT_KEYREQ, NULL},
 #endif
+    /* 52 */ {PVFS_SERV_CREATE_FILE, &pvfs2_create_file_params},
+    /* 53 */ {PVFS_SERV_PLACEMENT_STATS, &pvfs2_placement_stats_params}
 };
 
 #define CHECK_OP(_op_) assert(_op_ == PINT_server_req_table[_op_].op_type)
@@ -46,7 +46,11 @@
 /* #include "pvfs2-internal.h" */
 #include "src/server/request-scheduler/request-scheduler.h"
 #include "pint-event.h"
+#include "pint-sm-trace.h"
+#include "tree-fanout.h"
+#include "readdir-stream.h"
 #include "pint-util.h"
+#include "pint-mem-pool.h"
 #include "client-state-machine.h"
 /* #include "pint-malloc.h" */
 #include "pint-uid-mgmt.h"
@@ -175,6 +179,7 @@ static int server_initialize_subsystems(
 static int server_setup_signal_handlers(void);
 static int server_check_if_root_directory_created(void);
 static int server_purge_unexpected_recv_machines(void);
+static void server_verify_unexpected_batch(int comp_ct);
 static int server_setup_process_environment(int background);
 static int server_shutdown(
     PINT_server_status_flag status,
@@ -200,6 +205,7 @@ static int precreate_pool_launch_refiller(const char* host, PVFS_ds_type type,
     PVFS_BMI_addr_t addr, PVFS_fs_id fsid, PVFS_handle pool_handle);
 static int precreate_pool_count(
     PVFS_fs_id fsid, PVFS_handle pool_handle, int* count);
+static int placement_stats_initialize(void);
 
 static TROVE_method_id trove_coll_to_method_callback(TROVE_coll_id);
 
@@ -452,6 +458,8 @@ int main(int argc, char **argv)
             goto server_shutdown;
         }
 
+        server_verify_unexpected_batch(comp_ct);
+
         /*
           Loop through the completed jobs and handle whatever comes
           next
@@ -605,6 +613,17 @@ static int server_initialize(
         return ret;
     }
 
+    /* the async log writer is a thread, so start it after any fork */
+    if (server_config.async_log_buffer_size > 0)
+    {
+        ret = gossip_enable_async(server_config.async_log_buffer_size,
+                                  server_config.async_log_wait_msecs);
+        if (ret < 0)
+        {
+            gossip_err("Warning: could not enable async logging: %d\n", ret);
+        }
+    }
+
     /* initialize the security module */
     ret = PINT_security_initialize();
     if (ret < 0)
@@ -672,6 +691,16 @@ static int server_initialize(
 
     *server_status_flag |= SERVER_STATE_MACHINE_INIT;
 
+    if (server_config.sm_trace_records > 0)
+    {
+        ret = PINT_sm_trace_enable(server_config.sm_trace_records);
+        if (ret < 0)
+        {
+            gossip_err("Warning: could not enable state machine "
+                       "tracing: %d\n", ret);
+        }
+    }
+
     /* Post starting set of BMI unexpected msg buffers */
     for (i = 0; i < server_config.initial_unexpected_requests; i++)
     {
@@ -831,6 +860,9 @@ static int server_initialize_subsystems(
 
     *server_status_flag |= SERVER_ENCODER_INIT;
 
+    /* BMI and direct I/O buffers come from the I/O buffer pool */
+    PINT_mem_pool_enable();
+
     gossip_debug(GOSSIP_SERVER_DEBUG,
                  "Passing %s as BMI listen address.\n",
                  server_config.host_id);
@@ -1348,6 +1380,13 @@ static int server_initialize_subsystems(
 
     *server_status_flag |= SERVER_PRECREATE_INIT;
 
+    ret = placement_stats_initialize();
+    if (ret < 0)
+    {
+        gossip_err("Error starting data placement statistics.\n");
+        return (ret);
+    }
+
     return ret;
 }
 
@@ -1792,6 +1831,8 @@ static int server_shutdown(PINT_server_status_flag status,
                            int ret,
                            int siglevel)
 {
+    struct PINT_mem_pool_stats pool_stats;
+
     if (siglevel == SIGSEGV)
     {
         gossip_err("SIGSEGV: skipping cleanup; exit now!\n");
@@ -1801,6 +1842,15 @@ static int server_shutdown(PINT_server_status_flag status,
     gossip_debug(GOSSIP_SERVER_DEBUG,
                  "*** server shutdown in progress ***\n");
 
+    PINT_mem_pool_get_stats(&pool_stats);
+    gossip_debug(GOSSIP_SERVER_DEBUG, "I/O buffer pool: %llu hits, "
+                 "%llu carves, %llu fallbacks, %llu frees, %llu regions "
+                 "(%llu released), %llu bytes mapped\n",
+                 llu(pool_stats.hits), llu(pool_stats.carves),
+                 llu(pool_stats.fallbacks), llu(pool_stats.frees),
+                 llu(pool_stats.regions), llu(pool_stats.regions_released),
+                 llu(pool_stats.bytes_mapped));
+
     free(s_server_options.server_alias);
 
     if (status & SERVER_PRECREATE_INIT)
@@ -1862,6 +1912,13 @@ static int server_shutdown(PINT_server_status_flag status,
                      "interface             [ stopped ]\n");
     }
 
+    if (status & SERVER_STATE_MACHINE_INIT)
+    {
+        PINT_sm_trace_finalize();
+        PINT_tree_fanout_finalize();
+        PINT_readdir_stream_finalize();
+    }
+
     if (status & SERVER_JOB_TIME_MGR_INIT)
     {
         gossip_debug(GOSSIP_SERVER_DEBUG, "[+] halting job time "
@@ -2349,6 +2406,80 @@ static int server_purge_unexpected_recv_machines(void)
     return 0;
 }
 
+/* server_verify_unexpected_batch()
+ *
+ * decodes the unexpected requests among the comp_ct jobs just returned
+ * by job_testcontext() and, when there are several, verifies their
+ * capabilities together with PINT_verify_capability_batch().  The
+ * result is left in s_op->cap_verified for the prelude, so the
+ * capability is checked against the clock when the request arrives.
+ * Anything that fails to decode is left for server_state_machine_start()
+ * to report.
+ */
+static void server_verify_unexpected_batch(int comp_ct)
+{
+    const PVFS_capability *caps[PVFS_SERVER_TEST_COUNT];
+    PINT_server_op *s_ops[PVFS_SERVER_TEST_COUNT];
+    int results[PVFS_SERVER_TEST_COUNT];
+    struct PINT_smcb *smcb;
+    PINT_server_op *s_op;
+    int count = 0;
+    int i, ret;
+
+    for (i = 0; i < comp_ct; i++)
+    {
+        smcb = server_completed_job_p_array[i];
+        if (smcb->op != BMI_UNEXPECTED_OP ||
+            server_job_status_array[i].error_code != 0)
+        {
+            continue;
+        }
+        s_op = PINT_sm_frame(smcb, PINT_FRAME_CURRENT);
+        if (s_op->op_cancelled || s_op->req != NULL)
+        {
+            continue;
+        }
+
+        if (PINT_decode(s_op->unexp_bmi_buff.buffer,
+                        PINT_DECODE_REQ,
+                        &s_op->decoded,
+                        s_op->unexp_bmi_buff.addr,
+                        s_op->unexp_bmi_buff.size) != 0)
+        {
+            continue;
+        }
+        s_op->req = (struct PVFS_server_req *)s_op->decoded.buffer;
+
+        if (PINT_capability_is_null(&s_op->req->capability))
+        {
+            continue;
+        }
+#ifdef ENABLE_CAPCACHE
+        if (PINT_capcache_lookup(&s_op->req->capability) != NULL)
+        {
+            continue;
+        }
+#endif
+        caps[count] = &s_op->req->capability;
+        s_ops[count] = s_op;
+        count++;
+    }
+
+    /* a lone request is verified by its prelude as before */
+    if (count < 2)
+    {
+        return;
+    }
+
+    ret = PINT_verify_capability_batch(caps, count, results);
+    gossip_debug(GOSSIP_SECURITY_DEBUG, "%s: %d of %d capabilities "
+                 "verified\n", __func__, ret, count);
+    for (i = 0; i < count; i++)
+    {
+        s_ops[i]->cap_verified = results[i] ? 1 : -1;
+    }
+}
+
 /* server_state_machine_start()
  *
  * initializes fields in the s_op structure and begins execution of
@@ -2367,11 +2498,16 @@ int server_state_machine_start(
     gossip_debug(GOSSIP_SERVER_DEBUG,
             "server_state_machine_start %p\n",smcb);
 
-    ret = PINT_decode(s_op->unexp_bmi_buff.buffer,
-                      PINT_DECODE_REQ,
-                      &s_op->decoded,
-                      s_op->unexp_bmi_buff.addr,
-                      s_op->unexp_bmi_buff.size);
+    /* server_verify_unexpected_batch() may have decoded it already */
+    ret = 0;
+    if (s_op->req == NULL)
+    {
+        ret = PINT_decode(s_op->unexp_bmi_buff.buffer,
+                          PINT_DECODE_REQ,
+                          &s_op->decoded,
+                          s_op->unexp_bmi_buff.addr,
+                          s_op->unexp_bmi_buff.size);
+    }
 
     /* acknowledge that the unexpected buffer has been used up.
      * If *someone* decides to do in-place decoding, then we will have to move
@@ -3269,6 +3405,71 @@ static int precreate_pool_launch_refiller(const char* host, PVFS_ds_type type,
     return(0);
 }
 
+/* placement_stats_initialize()
+ *
+ * starts a state machine that keeps the I/O server statistics current
+ * for each file system this server creates files in with load-aware
+ * data placement
+ *
+ * returns 0 on success, -PVFS_error on failure
+ */
+static int placement_stats_initialize(void)
+{
+    PINT_llist *cur_f = server_config.file_systems;
+    struct filesystem_configuration_s *cur_fs;
+    struct PINT_smcb *tmp_smcb = NULL;
+    struct PINT_server_op *s_op;
+    int server_type;
+    int ret;
+
+    while(cur_f)
+    {
+        cur_fs = PINT_llist_head(cur_f);
+        if (!cur_fs)
+        {
+            break;
+        }
+        cur_f = PINT_llist_next(cur_f);
+
+        if (cur_fs->data_placement != PINT_DATA_PLACEMENT_LOAD_AWARE)
+        {
+            continue;
+        }
+
+        /* only metadata servers place datafiles */
+        ret = PINT_cached_config_check_type(
+            cur_fs->coll_id, server_config.host_id, &server_type);
+        if (ret < 0 || !(server_type & PINT_SERVER_TYPE_META))
+        {
+            continue;
+        }
+
+        ret = server_state_machine_alloc_noreq(PVFS_SERV_PLACEMENT_STATS,
+                                               &tmp_smcb);
+        if (ret < 0)
+        {
+            return(ret);
+        }
+        s_op = PINT_sm_frame(tmp_smcb, PINT_FRAME_CURRENT);
+        s_op->u.placement_stats.fsid = cur_fs->coll_id;
+        s_op->u.placement_stats.refresh_secs =
+                                    cur_fs->data_placement_refresh_secs;
+
+        gossip_debug(GOSSIP_SERVER_DEBUG, "%s: load-aware data placement "
+                     "for fsid %d, refreshing every %d seconds\n", __func__,
+                     (int)cur_fs->coll_id, cur_fs->data_placement_refresh_secs);
+
+        ret = server_state_machine_start_noreq(tmp_smcb);
+        if (ret < 0)
+        {
+            PINT_smcb_free(tmp_smcb);
+            return(ret);
+        }
+    }
+
+    return(0);
+}
+
 /* THese functions are for managing the keyval buffers in the state
  * machines.  They use the generic field "free_val" to record which
  * buffers do NOT need to be freed - presumable because they are freed
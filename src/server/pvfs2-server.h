@@ -180,6 +180,16 @@ struct PINT_server_create_op
     int handle_index;
 };
 
+struct PINT_server_create_file_op
+{
+    PVFS_handle handles[2];        /* metafile and stuffed datafile */
+    PVFS_error remove_errors[2];
+    PVFS_offset offset;
+    PVFS_size size;
+    PVFS_size result_size;
+    PVFS_error saved_error_code;
+};
+
 /*MIRROR structures*/
 typedef struct 
 {
@@ -365,6 +375,8 @@ struct PINT_server_readdir_op
     PVFS_handle dirent_handle;  /* holds handle of dirdata dspace from
                                    which entries are read */
     PVFS_size dirdata_size;
+    void *stream_buffer;        /* page taken from the read-ahead table */
+    struct PINT_readdir_stream_page *stream_page; /* page being read ahead */
 };
 
 typedef struct
@@ -486,6 +498,12 @@ struct PINT_server_precreate_pool_refiller_op
     PVFS_capability capability;
 };
 
+struct PINT_server_placement_stats_op
+{
+    PVFS_fs_id fsid;
+    int refresh_secs;
+};
+
 struct PINT_server_batch_create_op
 {
     int saved_error_code;
@@ -603,6 +621,11 @@ struct PINT_server_tree_communicate_op
     int handle_array_local_count;
     int handle_array_remote_count;
     int handle_index;
+    int adaptive;               /* partitions planned by tree-fanout.c */
+    int *partition_servers;     /* servers covered by each partition */
+    uint32_t *reroute_index;    /* remote handles to resend directly */
+    int reroute_count;
+    int rerouted;
 };
 
 struct PINT_server_mgmt_get_dirent_op
@@ -680,6 +703,11 @@ typedef struct PINT_server_op
 
     /* decoded request and response structures */
     struct PVFS_server_req *req; 
+    /* 1 or -1 once the request capability was verified or rejected on
+     * arrival by server_verify_unexpected_batch(); 0 leaves it to the
+     * prelude
+     */
+    int cap_verified;
     struct PVFS_server_resp resp; 
     /* encoded request and response structures */
     struct PINT_encoded_msg encoded;
@@ -702,6 +730,7 @@ typedef struct PINT_server_op
     {
         /* request-specific scratch spaces for use during processing */
         struct PINT_server_create_op create;
+        struct PINT_server_create_file_op create_file;
         struct PINT_server_eattr_op eattr;
         struct PINT_server_getattr_op getattr;
         struct PINT_server_listattr_op listattr;
@@ -722,6 +751,7 @@ typedef struct PINT_server_op
         struct PINT_server_mgmt_get_dirdata_op mgmt_get_dirdata_handle;
         struct PINT_server_precreate_pool_refiller_op
                                                precreate_pool_refiller;
+        struct PINT_server_placement_stats_op placement_stats;
         struct PINT_server_batch_create_op batch_create;
         struct PINT_server_batch_remove_op batch_remove;
         struct PINT_server_unstuff_op unstuff;
@@ -739,9 +769,8 @@ typedef struct PINT_server_op
     do { \
       char server_name[1024]; \
       struct server_configuration_s *server_config = PINT_server_config_mgr_get_config(); \
-      __s_op = malloc(sizeof(struct PINT_server_op)); \
+      __s_op = PINT_sm_frame_alloc(sizeof(struct PINT_server_op)); \
       if(!__s_op) { return -PVFS_ENOMEM; } \
-      memset(__s_op, 0, sizeof(struct PINT_server_op)); \
       __s_op->req = &__s_op->decoded.stub_dec.req; \
       PINT_sm_push_frame(__smcb, __task_id, __s_op); \
       if (__location != LOCAL_OPERATION && __location != REMOTE_OPERATION && __handle) { \
@@ -760,7 +789,7 @@ typedef struct PINT_server_op
 #define PINT_CLEANUP_SUBORDINATE_SERVER_FRAME(__s_op) \
     do { \
         PINT_cleanup_capability(&__s_op->req->capability); \
-        free(__s_op); \
+        PINT_sm_frame_free(__s_op); \
     } while (0)
 
 /* state machine permission function */
@@ -914,6 +943,7 @@ extern struct PINT_state_machine_s pvfs2_remove_work_sm;
 extern struct PINT_state_machine_s pvfs2_remove_with_prelude_sm;
 extern struct PINT_state_machine_s pvfs2_mkdir_work_sm;
 extern struct PINT_state_machine_s pvfs2_crdirent_work_sm;
+extern struct PINT_state_machine_s pvfs2_create_work_sm;
 extern struct PINT_state_machine_s pvfs2_unexpected_sm;
 extern struct PINT_state_machine_s pvfs2_create_immutable_copies_sm;
 extern struct PINT_state_machine_s pvfs2_mirror_work_sm;
@@ -927,6 +957,11 @@ extern void tree_getattr_free(PINT_server_op *s_op);
 extern void tree_setattr_free(PINT_server_op *s_op);
 extern void tree_remove_free(PINT_server_op *s_op);
 extern void mkdir_free(struct PINT_server_op *s_op);
+extern void crdirent_free(struct PINT_server_op *s_op);
+extern void create_free(struct PINT_server_op *s_op);
+extern int create_stuffing_possible(PVFS_fs_id fs_id,
+                                    const PVFS_sys_layout *layout,
+                                    int32_t num_dfiles_req);
 extern void getattr_free(struct PINT_server_op *s_op);
 
 /* Exported Prototypes */
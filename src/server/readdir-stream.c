@@ -0,0 +1,271 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* Table of directory pages read ahead for streaming readdir; see
+ * readdir-stream.h.
+ *
+ * The table is small (READDIR_STREAM_MAX_PAGES) so it is a plain list.
+ * A stream's pages are chained through their tokens: the page read
+ * from position p ends at next_token, which is where the following
+ * page starts.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "pvfs2-internal.h"
+#include "pvfs2-debug.h"
+#include "gossip.h"
+#include "gen-locks.h"
+#include "pint-util.h"
+#include "readdir-stream.h"
+
+static gen_mutex_t readdir_stream_mutex = GEN_MUTEX_INITIALIZER;
+static struct PINT_readdir_stream_page *readdir_stream_pages = NULL;
+static int readdir_stream_page_count = 0;
+
+static void readdir_stream_unlink(struct PINT_readdir_stream_page *page)
+{
+    struct PINT_readdir_stream_page **pp;
+
+    for (pp = &readdir_stream_pages; *pp; pp = &(*pp)->next)
+    {
+        if (*pp == page)
+        {
+            *pp = page->next;
+            readdir_stream_page_count--;
+            return;
+        }
+    }
+}
+
+static void readdir_stream_destroy(struct PINT_readdir_stream_page *page)
+{
+    readdir_stream_unlink(page);
+    free(page->buffer);
+    free(page);
+}
+
+static struct PINT_readdir_stream_page *readdir_stream_find(
+    PVFS_fs_id fs_id,
+    PVFS_handle handle,
+    PVFS_ds_position position)
+{
+    struct PINT_readdir_stream_page *page;
+
+    for (page = readdir_stream_pages; page; page = page->next)
+    {
+        if (page->fs_id == fs_id && page->handle == handle &&
+            page->position == position)
+        {
+            return page;
+        }
+    }
+    return NULL;
+}
+
+/* drops ready pages nobody came back for */
+static void readdir_stream_expire(PVFS_time now)
+{
+    struct PINT_readdir_stream_page *page, *next;
+
+    for (page = readdir_stream_pages; page; page = next)
+    {
+        next = page->next;
+        if (page->ready &&
+            now - page->stamp > READDIR_STREAM_TIMEOUT_MSECS)
+        {
+            gossip_debug(GOSSIP_READDIR_DEBUG,
+                         "readdir stream: dropping page %llu at %llu\n",
+                         llu(page->handle), llu(page->position));
+            readdir_stream_destroy(page);
+        }
+    }
+}
+
+/* PINT_readdir_stream_take()
+ *
+ * hands over the page read ahead at position if there is one and the
+ * directory has not changed since.  the caller frees *buffer.
+ *
+ * returns 0 on a hit, -PVFS_ENOENT otherwise
+ */
+int PINT_readdir_stream_take(PVFS_fs_id fs_id,
+                             PVFS_handle handle,
+                             PVFS_ds_position position,
+                             uint64_t version,
+                             int32_t requested,
+                             void **buffer,
+                             PVFS_dirent **dirents,
+                             int32_t *count,
+                             PVFS_ds_position *next_token)
+{
+    struct PINT_readdir_stream_page *page;
+    int ret = -PVFS_ENOENT;
+
+    gen_mutex_lock(&readdir_stream_mutex);
+    page = readdir_stream_find(fs_id, handle, position);
+    if (page && page->ready)
+    {
+        if (page->version == version && page->requested == requested)
+        {
+            *buffer = page->buffer;
+            *dirents = page->dirents;
+            *count = page->count;
+            *next_token = page->next_token;
+            page->buffer = NULL;
+            ret = 0;
+        }
+        readdir_stream_destroy(page);
+    }
+    gen_mutex_unlock(&readdir_stream_mutex);
+
+    gossip_debug(GOSSIP_READDIR_DEBUG,
+                 "readdir stream: %s for %llu at %llu\n",
+                 ret ? "miss" : "hit", llu(handle), llu(position));
+    return ret;
+}
+
+/* PINT_readdir_stream_reserve()
+ *
+ * finds the end of the pages already read ahead from position and, if
+ * fewer than window of them are ready and the directory has not run
+ * out, adds an empty page there for the caller to read into.
+ *
+ * returns the page, or NULL if nothing should be read ahead now
+ */
+struct PINT_readdir_stream_page *PINT_readdir_stream_reserve(
+    PVFS_fs_id fs_id,
+    PVFS_handle handle,
+    PVFS_ds_position position,
+    uint64_t version,
+    int32_t requested,
+    uint32_t window)
+{
+    struct PINT_readdir_stream_page *page, *oldest;
+    PVFS_time now;
+    uint32_t ahead = 0;
+
+    if (window > READDIR_STREAM_MAX_WINDOW)
+    {
+        window = READDIR_STREAM_MAX_WINDOW;
+    }
+    if (window == 0 || requested <= 0 || position == PVFS_ITERATE_END)
+    {
+        return NULL;
+    }
+
+    now = PINT_util_get_time_ms();
+    gen_mutex_lock(&readdir_stream_mutex);
+    readdir_stream_expire(now);
+
+    while ((page = readdir_stream_find(fs_id, handle, position)))
+    {
+        /* a page still being read, or from an older version of the
+         * directory, ends the chain; so does the end of the directory
+         */
+        if (!page->ready || page->version != version ||
+            page->requested != requested ||
+            page->count < page->requested ||
+            page->next_token == PVFS_ITERATE_END ||
+            ++ahead >= window)
+        {
+            gen_mutex_unlock(&readdir_stream_mutex);
+            return NULL;
+        }
+        position = page->next_token;
+    }
+
+    if (readdir_stream_page_count >= READDIR_STREAM_MAX_PAGES)
+    {
+        /* make room by dropping the oldest page that is ready */
+        oldest = NULL;
+        for (page = readdir_stream_pages; page; page = page->next)
+        {
+            if (page->ready && (!oldest || page->stamp < oldest->stamp))
+            {
+                oldest = page;
+            }
+        }
+        if (!oldest)
+        {
+            gen_mutex_unlock(&readdir_stream_mutex);
+            return NULL;
+        }
+        readdir_stream_destroy(oldest);
+    }
+
+    page = (struct PINT_readdir_stream_page *)calloc(1, sizeof(*page));
+    if (page)
+    {
+        page->fs_id = fs_id;
+        page->handle = handle;
+        page->position = position;
+        page->version = version;
+        page->requested = requested;
+        page->stamp = now;
+        page->next = readdir_stream_pages;
+        readdir_stream_pages = page;
+        readdir_stream_page_count++;
+    }
+    gen_mutex_unlock(&readdir_stream_mutex);
+    return page;
+}
+
+/* PINT_readdir_stream_fill()
+ *
+ * stores the result of reading a reserved page; the table takes
+ * ownership of buffer
+ */
+void PINT_readdir_stream_fill(struct PINT_readdir_stream_page *page,
+                              void *buffer,
+                              PVFS_dirent *dirents,
+                              int32_t count,
+                              PVFS_ds_position next_token)
+{
+    gen_mutex_lock(&readdir_stream_mutex);
+    page->buffer = buffer;
+    page->dirents = dirents;
+    page->count = count;
+    page->next_token = next_token;
+    page->ready = 1;
+    page->stamp = PINT_util_get_time_ms();
+    gen_mutex_unlock(&readdir_stream_mutex);
+
+    gossip_debug(GOSSIP_READDIR_DEBUG,
+                 "readdir stream: read ahead %d entries of %llu at %llu\n",
+                 count, llu(page->handle), llu(page->position));
+}
+
+/* PINT_readdir_stream_abandon()
+ *
+ * removes a reserved page whose read failed
+ */
+void PINT_readdir_stream_abandon(struct PINT_readdir_stream_page *page)
+{
+    gen_mutex_lock(&readdir_stream_mutex);
+    readdir_stream_destroy(page);
+    gen_mutex_unlock(&readdir_stream_mutex);
+}
+
+void PINT_readdir_stream_finalize(void)
+{
+    gen_mutex_lock(&readdir_stream_mutex);
+    while (readdir_stream_pages)
+    {
+        readdir_stream_destroy(readdir_stream_pages);
+    }
+    gen_mutex_unlock(&readdir_stream_mutex);
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
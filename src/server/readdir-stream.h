@@ -0,0 +1,85 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* Read-ahead of directory pages for streaming readdir.
+ *
+ * A client that lists a whole directory marks its readdir requests
+ * with the PVFS_HINT_READDIR_STREAM hint, whose value is the number of
+ * pages it allows the server to read ahead of it.  After answering such
+ * a request readdir.sm keeps iterating, one page at a time, and parks
+ * the pages here keyed by the position token the client will send
+ * next.  The client's next request is its acknowledgement: it takes
+ * its page from the table without touching trove, and that frees a
+ * slot for the server to read one more page ahead.  A server never
+ * holds more than the window of unacknowledged pages for one stream,
+ * nor more than READDIR_STREAM_MAX_PAGES in total; pages that are not
+ * collected within READDIR_STREAM_TIMEOUT_MSECS are dropped.
+ */
+
+#ifndef __READDIR_STREAM_H
+#define __READDIR_STREAM_H
+
+#include "pvfs2-types.h"
+
+#define READDIR_STREAM_MAX_WINDOW 8
+#define READDIR_STREAM_MAX_PAGES 64
+#define READDIR_STREAM_TIMEOUT_MSECS 30000
+
+/* one page read ahead, or being read ahead (ready == 0) */
+struct PINT_readdir_stream_page
+{
+    PVFS_fs_id fs_id;
+    PVFS_handle handle;         /* dirdata handle */
+    PVFS_ds_position position;  /* token the page was read from */
+    uint64_t version;           /* directory version when read */
+    int32_t requested;
+    int32_t count;
+    PVFS_ds_position next_token;
+    void *buffer;               /* memory holding dirents, owned here */
+    PVFS_dirent *dirents;
+    int ready;
+    PVFS_time stamp;
+    struct PINT_readdir_stream_page *next;
+};
+
+int PINT_readdir_stream_take(PVFS_fs_id fs_id,
+                             PVFS_handle handle,
+                             PVFS_ds_position position,
+                             uint64_t version,
+                             int32_t requested,
+                             void **buffer,
+                             PVFS_dirent **dirents,
+                             int32_t *count,
+                             PVFS_ds_position *next_token);
+
+struct PINT_readdir_stream_page *PINT_readdir_stream_reserve(
+    PVFS_fs_id fs_id,
+    PVFS_handle handle,
+    PVFS_ds_position position,
+    uint64_t version,
+    int32_t requested,
+    uint32_t window);
+
+void PINT_readdir_stream_fill(struct PINT_readdir_stream_page *page,
+                              void *buffer,
+                              PVFS_dirent *dirents,
+                              int32_t count,
+                              PVFS_ds_position next_token);
+
+void PINT_readdir_stream_abandon(struct PINT_readdir_stream_page *page);
+
+void PINT_readdir_stream_finalize(void);
+
+#endif /* __READDIR_STREAM_H */
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
@@ -38,6 +38,7 @@
 #include "gossip.h"
 #include "id-generator.h"
 #include "pvfs2-internal.h"
+#include "pint-slab.h"
 
 /* we need the server header because it defines the operations that
  * we use to determine whether to schedule or queue.  
@@ -160,7 +161,7 @@ int PINT_timer_queue_finalize(void)
        element = qlist_entry(iterator,struct req_sched_element,list_link);
        qlist_del(&(element->list_link));
        if (element && element->user_ptr)
-          free(element->user_ptr);
+          PINT_slab_free(element->user_ptr); /* a job descriptor */
        if (element)
           free(element);
        element=NULL;
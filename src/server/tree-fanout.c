@@ -0,0 +1,461 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* Peer statistics and fan-out planning for tree-communicate.sm; see
+ * tree-fanout.h.
+ *
+ * The cost model: a node sending to n servers with width w spends
+ * issue_us per child it sends to, then waits one level (the round trip
+ * to its slowest child) for the children, each of which repeats the
+ * process for its own share of the servers:
+ *
+ *     T(0) = 0
+ *     T(n) = issue_us * min(w, n) + level_us + T(ceil(n / w) - 1)
+ *
+ * level_us is the median of the per-server level costs, where a server's
+ * level cost is its smoothed round trip time inflated by the number of
+ * tree requests already outstanding to it.  Wide trees pay for issuing,
+ * deep trees pay for round trips; the planner picks the w that
+ * minimizes T(n).
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "pvfs2-internal.h"
+#include "pvfs2-debug.h"
+#include "gossip.h"
+#include "gen-locks.h"
+#include "tree-fanout.h"
+
+/* defaults until the first samples arrive */
+#define TREE_FANOUT_DEFAULT_RTT_US 500
+#define TREE_FANOUT_DEFAULT_ISSUE_US 20
+
+/* weight of a new sample in the moving averages is 1/2^SHIFT */
+#define TREE_FANOUT_EWMA_SHIFT 3
+
+/* outstanding requests a server is assumed to overlap before each
+ * additional one adds a full round trip of queueing
+ */
+#define TREE_FANOUT_QUEUE_SLOTS 4
+
+/* widths above this are only considered as a single flat level */
+#define TREE_FANOUT_MAX_WIDTH 256
+
+/* a subtree is stalled once it takes this many times its prediction */
+#define TREE_FANOUT_STALL_FACTOR 8
+
+#define TREE_FANOUT_TABLE_SIZE 1024
+
+struct tree_fanout_peer
+{
+    PVFS_BMI_addr_t addr;
+    PVFS_time rtt_us;
+    int inflight;
+    uint64_t samples;
+    uint64_t stalls;
+    int failed;             /* rtt_us came from a failed request */
+    struct tree_fanout_peer *next;
+};
+
+static gen_mutex_t tree_fanout_mutex = GEN_MUTEX_INITIALIZER;
+static struct tree_fanout_peer *tree_fanout_table[TREE_FANOUT_TABLE_SIZE];
+static PVFS_time tree_fanout_rtt_us = TREE_FANOUT_DEFAULT_RTT_US;
+static PVFS_time tree_fanout_issue_us = TREE_FANOUT_DEFAULT_ISSUE_US;
+
+struct tree_fanout_rank
+{
+    int index;
+    PVFS_time cost;
+};
+
+static struct tree_fanout_peer *tree_fanout_lookup(PVFS_BMI_addr_t addr,
+                                                   int create)
+{
+    struct tree_fanout_peer *peer;
+    unsigned int bucket;
+
+    bucket = (unsigned int)
+        (((uint64_t) addr * 0x9E3779B97F4A7C15ULL) >> 32) %
+        TREE_FANOUT_TABLE_SIZE;
+
+    for (peer = tree_fanout_table[bucket]; peer; peer = peer->next)
+    {
+        if (peer->addr == addr)
+        {
+            return peer;
+        }
+    }
+
+    if (!create)
+    {
+        return NULL;
+    }
+
+    peer = calloc(1, sizeof(*peer));
+    if (!peer)
+    {
+        return NULL;
+    }
+    peer->addr = addr;
+    peer->rtt_us = tree_fanout_rtt_us;
+    peer->next = tree_fanout_table[bucket];
+    tree_fanout_table[bucket] = peer;
+    return peer;
+}
+
+/* PVFS_time is unsigned; the difference has to be taken signed */
+static PVFS_time tree_fanout_ewma(PVFS_time avg, PVFS_time sample)
+{
+    return (PVFS_time) ((int64_t) avg +
+        ((int64_t) sample - (int64_t) avg) / (1 << TREE_FANOUT_EWMA_SHIFT));
+}
+
+/* caller holds tree_fanout_mutex */
+static PVFS_time tree_fanout_peer_cost(PVFS_BMI_addr_t addr)
+{
+    struct tree_fanout_peer *peer = tree_fanout_lookup(addr, 0);
+
+    if (!peer)
+    {
+        return tree_fanout_rtt_us;
+    }
+    return peer->rtt_us +
+        (peer->rtt_us * peer->inflight) / TREE_FANOUT_QUEUE_SLOTS;
+}
+
+PVFS_time PINT_tree_fanout_cost(PVFS_BMI_addr_t addr)
+{
+    PVFS_time cost;
+
+    gen_mutex_lock(&tree_fanout_mutex);
+    cost = tree_fanout_peer_cost(addr);
+    gen_mutex_unlock(&tree_fanout_mutex);
+    return cost;
+}
+
+/* PINT_tree_fanout_post()
+ *
+ * notes that a tree request has been sent to addr
+ */
+void PINT_tree_fanout_post(PVFS_BMI_addr_t addr)
+{
+    struct tree_fanout_peer *peer;
+
+    gen_mutex_lock(&tree_fanout_mutex);
+    peer = tree_fanout_lookup(addr, 1);
+    if (peer)
+    {
+        peer->inflight++;
+    }
+    gen_mutex_unlock(&tree_fanout_mutex);
+}
+
+/* PINT_tree_fanout_complete()
+ *
+ * notes that a tree request to addr finished after elapsed_us.  The
+ * request covered nservers servers (1 for a leaf), which its head will
+ * have fanned out to with about width partitions per level; the time
+ * spent issuing requests at each level is taken out before the rest is
+ * spread over the levels.  Requests that failed (including those
+ * cancelled as stalled) only ever raise the estimate for the peer.
+ */
+void PINT_tree_fanout_complete(PVFS_BMI_addr_t addr, PVFS_time elapsed_us,
+                               int nservers, int width, int error)
+{
+    struct tree_fanout_peer *peer;
+    int64_t sample;
+    int levels;
+
+    if (nservers < 1)
+    {
+        nservers = 1;
+    }
+    levels = 1 + PINT_tree_fanout_levels(nservers - 1, width);
+
+    gen_mutex_lock(&tree_fanout_mutex);
+    sample = (int64_t) elapsed_us -
+        (int64_t) PINT_tree_fanout_predict(nservers - 1, width, 0,
+                                           tree_fanout_issue_us);
+    sample /= levels;
+    if (sample < 1)
+    {
+        sample = 1;
+    }
+
+    peer = tree_fanout_lookup(addr, 1);
+    if (peer)
+    {
+        if (peer->inflight > 0)
+        {
+            peer->inflight--;
+        }
+        if (error)
+        {
+            peer->stalls++;
+            peer->failed = 1;
+            if (elapsed_us > peer->rtt_us)
+            {
+                peer->rtt_us = elapsed_us;
+            }
+        }
+        else if (elapsed_us > 0)
+        {
+            /* start over once a peer that failed answers again */
+            peer->rtt_us = (peer->samples && !peer->failed) ?
+                tree_fanout_ewma(peer->rtt_us, sample) : sample;
+            peer->failed = 0;
+            peer->samples++;
+            tree_fanout_rtt_us = tree_fanout_ewma(tree_fanout_rtt_us, sample);
+        }
+    }
+    gen_mutex_unlock(&tree_fanout_mutex);
+}
+
+/* PINT_tree_fanout_issue()
+ *
+ * records the measured cost of issuing one request of a fan-out
+ */
+void PINT_tree_fanout_issue(PVFS_time issue_us)
+{
+    gen_mutex_lock(&tree_fanout_mutex);
+    tree_fanout_issue_us = tree_fanout_ewma(tree_fanout_issue_us, issue_us);
+    gen_mutex_unlock(&tree_fanout_mutex);
+}
+
+PVFS_time PINT_tree_fanout_predict(int nservers, int width,
+                                   PVFS_time level_us, PVFS_time issue_us)
+{
+    PVFS_time total = 0;
+    int n = nservers;
+
+    if (width < 2)
+    {
+        width = 2;
+    }
+    while (n > 0)
+    {
+        total += issue_us * (n < width ? n : width) + level_us;
+        n = (n + width - 1) / width - 1;
+    }
+    return total;
+}
+
+int PINT_tree_fanout_levels(int nservers, int width)
+{
+    int levels = 0;
+    int n = nservers;
+
+    if (width < 2)
+    {
+        width = 2;
+    }
+    while (n > 0)
+    {
+        levels++;
+        n = (n + width - 1) / width - 1;
+    }
+    return levels;
+}
+
+/* PINT_tree_fanout_width()
+ *
+ * returns the width that minimizes the predicted completion time of a
+ * fan-out to nservers servers
+ */
+int PINT_tree_fanout_width(int nservers, PVFS_time level_us,
+                           PVFS_time issue_us)
+{
+    int w, best;
+    int max_width;
+    PVFS_time t, best_t;
+
+    if (nservers <= 2)
+    {
+        return (nservers > 0 ? nservers : 1);
+    }
+
+    /* flat is the baseline; a tree has to beat it */
+    best = nservers;
+    best_t = PINT_tree_fanout_predict(nservers, nservers, level_us, issue_us);
+
+    max_width = nservers - 1;
+    if (max_width > TREE_FANOUT_MAX_WIDTH)
+    {
+        max_width = TREE_FANOUT_MAX_WIDTH;
+    }
+    for (w = 2; w <= max_width; w++)
+    {
+        t = PINT_tree_fanout_predict(nservers, w, level_us, issue_us);
+        if (t < best_t)
+        {
+            best_t = t;
+            best = w;
+        }
+    }
+    return best;
+}
+
+static int tree_fanout_rank_cmp(const void *a, const void *b)
+{
+    const struct tree_fanout_rank *ra = a;
+    const struct tree_fanout_rank *rb = b;
+
+    if (ra->cost != rb->cost)
+    {
+        return (ra->cost < rb->cost ? -1 : 1);
+    }
+    return ra->index - rb->index;
+}
+
+/* PINT_tree_fanout_plan()
+ *
+ * plans a fan-out to nservers distinct servers.  The fastest, least
+ * loaded servers head the partitions; the remaining servers are dealt
+ * to the partitions in order of cost so that every subtree gets a
+ * similar mix of fast and slow servers.
+ *
+ * returns 0 on success, -PVFS_error on failure
+ */
+int PINT_tree_fanout_plan(const PVFS_BMI_addr_t *servers,
+                          int nservers,
+                          struct PINT_tree_fanout_plan *plan)
+{
+    struct tree_fanout_rank *rank;
+    PVFS_time level_us, issue_us;
+    int *count;
+    int *fill;
+    int i, p, width;
+
+    memset(plan, 0, sizeof(*plan));
+    if (nservers < 1)
+    {
+        return -PVFS_EINVAL;
+    }
+
+    rank = malloc(nservers * sizeof(*rank));
+    plan->order = malloc(nservers * sizeof(*plan->order));
+    if (!rank || !plan->order)
+    {
+        free(rank);
+        free(plan->order);
+        plan->order = NULL;
+        return -PVFS_ENOMEM;
+    }
+
+    gen_mutex_lock(&tree_fanout_mutex);
+    for (i = 0; i < nservers; i++)
+    {
+        rank[i].index = i;
+        rank[i].cost = tree_fanout_peer_cost(servers[i]);
+    }
+    issue_us = tree_fanout_issue_us;
+    gen_mutex_unlock(&tree_fanout_mutex);
+
+    /* the median keeps a few dead or overloaded servers, which end up at
+     * the leaves anyway, from skewing the shape of the whole tree
+     */
+    qsort(rank, nservers, sizeof(*rank), tree_fanout_rank_cmp);
+    level_us = rank[nservers / 2].cost;
+
+    width = PINT_tree_fanout_width(nservers, level_us, issue_us);
+    if (width > nservers)
+    {
+        width = nservers;
+    }
+
+    plan->part_start = malloc((width + 1) * sizeof(*plan->part_start));
+    count = calloc(2 * width, sizeof(*count));
+    if (!plan->part_start || !count)
+    {
+        free(rank);
+        free(count);
+        PINT_tree_fanout_plan_free(plan);
+        return -PVFS_ENOMEM;
+    }
+    fill = count + width;
+
+    /* rank[0..width) head the partitions, rank[width + k] goes to
+     * partition k % width
+     */
+    for (i = 0; i < nservers; i++)
+    {
+        count[i < width ? i : (i - width) % width]++;
+    }
+    plan->part_start[0] = 0;
+    for (p = 0; p < width; p++)
+    {
+        plan->part_start[p + 1] = plan->part_start[p] + count[p];
+    }
+    for (i = 0; i < nservers; i++)
+    {
+        p = (i < width ? i : (i - width) % width);
+        plan->order[plan->part_start[p] + fill[p]] = rank[i].index;
+        fill[p]++;
+    }
+
+    plan->width = width;
+    plan->nservers = nservers;
+    plan->predicted_us = PINT_tree_fanout_predict(nservers, width,
+                                                  level_us, issue_us);
+
+    gossip_debug(GOSSIP_SERVER_DEBUG,
+                 "%s: %d servers: width %d, level %lld us, issue %lld us, "
+                 "predicted %lld us\n", __func__, nservers, width,
+                 lld(level_us), lld(issue_us), lld(plan->predicted_us));
+
+    free(count);
+    free(rank);
+    return 0;
+}
+
+void PINT_tree_fanout_plan_free(struct PINT_tree_fanout_plan *plan)
+{
+    free(plan->order);
+    free(plan->part_start);
+    plan->order = NULL;
+    plan->part_start = NULL;
+}
+
+/* PINT_tree_fanout_deadline()
+ *
+ * returns how long the planned fan-out may take before its subtrees
+ * are treated as stalled
+ */
+PVFS_time PINT_tree_fanout_deadline(const struct PINT_tree_fanout_plan *plan)
+{
+    return plan->predicted_us * TREE_FANOUT_STALL_FACTOR;
+}
+
+void PINT_tree_fanout_finalize(void)
+{
+    struct tree_fanout_peer *peer, *next;
+    int i;
+
+    gen_mutex_lock(&tree_fanout_mutex);
+    for (i = 0; i < TREE_FANOUT_TABLE_SIZE; i++)
+    {
+        for (peer = tree_fanout_table[i]; peer; peer = next)
+        {
+            next = peer->next;
+            free(peer);
+        }
+        tree_fanout_table[i] = NULL;
+    }
+    tree_fanout_rtt_us = TREE_FANOUT_DEFAULT_RTT_US;
+    tree_fanout_issue_us = TREE_FANOUT_DEFAULT_ISSUE_US;
+    gen_mutex_unlock(&tree_fanout_mutex);
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
@@ -0,0 +1,68 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* Adaptive fan-out for tree communication.
+ *
+ * The server keeps a running estimate of the round trip time of every
+ * peer it sends tree requests to, and counts the tree requests it has
+ * outstanding to each peer.  PINT_tree_fanout_plan() uses those numbers
+ * to decide how many partitions to split a set of target servers into,
+ * which server heads each partition, and how long the whole operation
+ * should take.  A subtree that runs well past that prediction is
+ * considered stalled; tree-communicate.sm then reissues its handles
+ * directly to the servers that own them.
+ */
+
+#ifndef __TREE_FANOUT_H
+#define __TREE_FANOUT_H
+
+#include "pvfs2-types.h"
+
+/* a plan for sending to nservers distinct servers.  order[] lists the
+ * servers (as indexes into the array given to PINT_tree_fanout_plan) in
+ * send order; partition i covers order[part_start[i]] up to but not
+ * including order[part_start[i + 1]], and its first server is the one
+ * the partition's request is sent to.
+ */
+struct PINT_tree_fanout_plan
+{
+    int width;
+    int nservers;
+    int *order;
+    int *part_start;
+    PVFS_time predicted_us;     /* predicted completion time */
+};
+
+int PINT_tree_fanout_plan(const PVFS_BMI_addr_t *servers,
+                          int nservers,
+                          struct PINT_tree_fanout_plan *plan);
+void PINT_tree_fanout_plan_free(struct PINT_tree_fanout_plan *plan);
+
+int PINT_tree_fanout_width(int nservers, PVFS_time level_us,
+                           PVFS_time issue_us);
+int PINT_tree_fanout_levels(int nservers, int width);
+PVFS_time PINT_tree_fanout_predict(int nservers, int width,
+                                   PVFS_time level_us, PVFS_time issue_us);
+PVFS_time PINT_tree_fanout_deadline(const struct PINT_tree_fanout_plan *plan);
+
+void PINT_tree_fanout_post(PVFS_BMI_addr_t addr);
+void PINT_tree_fanout_complete(PVFS_BMI_addr_t addr, PVFS_time elapsed_us,
+                               int nservers, int width, int error);
+void PINT_tree_fanout_issue(PVFS_time issue_us);
+
+PVFS_time PINT_tree_fanout_cost(PVFS_BMI_addr_t addr);
+void PINT_tree_fanout_finalize(void);
+
+#endif /* __TREE_FANOUT_H */
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
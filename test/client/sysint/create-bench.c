@@ -0,0 +1,282 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* Measures the metadata create rate.
+ *
+ * A new directory is made and <count> empty files are created in it
+ * with PVFS_isys_create(), keeping up to <in flight> creates
+ * outstanding so that the server sees concurrent metadata updates.
+ * The files are then removed the same way.  Both rates are printed.
+ *
+ * <new directory> may be a path under any mount point in the pvfstab,
+ * so the same run can be repeated against file systems configured with
+ * different CapabilityMode settings; otherwise it is taken relative to
+ * the root of the default file system.
+ */
+
+#include <time.h>
+#include "client.h"
+#include <sys/time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "pvfs2-util.h"
+#include "pvfs2-internal.h"
+#include "client-state-machine.h"
+
+#define DEFAULT_COUNT 2000
+#define DEFAULT_IN_FLIGHT 16
+#define MAX_IN_FLIGHT 256
+
+struct slot
+{
+    PVFS_sys_op_id op_id;
+    int busy;
+    char name[64];
+    PVFS_sysresp_create resp;
+};
+
+static double wtime(void)
+{
+    struct timeval t;
+
+    gettimeofday(&t, NULL);
+    return((double)t.tv_sec + (double)t.tv_usec / 1000000);
+}
+
+/* posts the create or remove of file i into slot s */
+static int post(int remove,
+                int i,
+                struct slot *s,
+                PVFS_object_ref dir,
+                PVFS_sys_attr *attr,
+                PVFS_credential *credentials)
+{
+    int ret;
+
+    snprintf(s->name, sizeof(s->name), "file-%09d", i);
+    if (remove)
+    {
+        ret = PVFS_isys_remove(s->name, dir, credentials, &s->op_id,
+                               NULL, s);
+        if (ret < 0)
+        {
+            PVFS_perror("PVFS_isys_remove", ret);
+        }
+    }
+    else
+    {
+        ret = PVFS_isys_create(s->name, dir, *attr, credentials, NULL,
+                               NULL, &s->resp, &s->op_id, NULL, s);
+        if (ret < 0)
+        {
+            PVFS_perror("PVFS_isys_create", ret);
+        }
+    }
+    return ret;
+}
+
+/* fills op_ids with the operations outstanding in slots */
+static int outstanding(struct slot *slots,
+                       int in_flight,
+                       PVFS_sys_op_id *op_ids)
+{
+    int i, n = 0;
+
+    for (i = 0; i < in_flight; i++)
+    {
+        if (slots[i].busy)
+        {
+            op_ids[n++] = slots[i].op_id;
+        }
+    }
+    return n;
+}
+
+static int run(int remove,
+               PVFS_object_ref dir,
+               PVFS_sys_attr *attr,
+               PVFS_credential *credentials,
+               int count,
+               int in_flight)
+{
+    struct slot *slots, *s;
+    PVFS_sys_op_id op_ids[MAX_IN_FLIGHT];
+    void *user_ptrs[MAX_IN_FLIGHT];
+    int errors[MAX_IN_FLIGHT];
+    int posted = 0, n, i, ret = 0, err;
+
+    slots = calloc(in_flight, sizeof(struct slot));
+    if (!slots)
+    {
+        return -PVFS_ENOMEM;
+    }
+
+    for (;;)
+    {
+        for (i = 0; i < in_flight && posted < count && ret == 0; i++)
+        {
+            if (!slots[i].busy)
+            {
+                ret = post(remove, posted++, &slots[i], dir, attr,
+                           credentials);
+                slots[i].busy = (ret == 0);
+            }
+        }
+
+        /* testsome() only reports on the op ids it is handed */
+        n = outstanding(slots, in_flight, op_ids);
+        if (n == 0)
+        {
+            break;
+        }
+        err = PVFS_sys_testsome(op_ids, &n, user_ptrs, errors, 10);
+        if (err < 0)
+        {
+            PVFS_perror("PVFS_sys_testsome", err);
+            ret = err;
+            break;
+        }
+        for (i = 0; i < n; i++)
+        {
+            s = (struct slot *)user_ptrs[i];
+            PINT_sys_release(s->op_id);
+            s->busy = 0;
+            if (errors[i] < 0)
+            {
+                PVFS_perror(remove ? "remove" : "create", errors[i]);
+                ret = errors[i];
+            }
+        }
+    }
+
+    free(slots);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    int ret = -1;
+    char name[512] = {0};
+    char *entry_name;
+    int count = DEFAULT_COUNT, in_flight = DEFAULT_IN_FLIGHT, pass;
+    double t0, elapsed;
+    PVFS_fs_id fs_id;
+    PVFS_sysresp_getparent gp_resp;
+    PVFS_sysresp_mkdir resp_mk;
+    PVFS_credential credentials;
+    PVFS_sys_attr attr;
+
+    if (argc < 2 || argc > 4)
+    {
+        fprintf(stderr, "Usage: %s <new directory> [count] [in flight]\n",
+                argv[0]);
+        return -1;
+    }
+    if (argc > 2)
+    {
+        count = atoi(argv[2]);
+    }
+    if (argc > 3)
+    {
+        in_flight = atoi(argv[3]);
+    }
+    if (count <= 0 || in_flight <= 0 || in_flight > MAX_IN_FLIGHT)
+    {
+        fprintf(stderr, "Error: count must be positive and in flight "
+                "between 1 and %d\n", MAX_IN_FLIGHT);
+        return -1;
+    }
+
+    ret = PVFS_util_init_defaults();
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_util_init_defaults", ret);
+        return -1;
+    }
+
+    if (PVFS_util_resolve(argv[1], &fs_id, name, sizeof(name)) != 0)
+    {
+        ret = PVFS_util_get_default_fsid(&fs_id);
+        if (ret < 0)
+        {
+            PVFS_perror("PVFS_util_get_default_fsid", ret);
+            goto out;
+        }
+
+        if (argv[1][0] == '/')
+        {
+            snprintf(name, 512, "%s", argv[1]);
+        }
+        else
+        {
+            snprintf(name, 512, "/%s", argv[1]);
+        }
+    }
+
+    PVFS_util_gen_credential_defaults(&credentials);
+
+    memset(&gp_resp, 0, sizeof(gp_resp));
+    ret = PVFS_sys_getparent(fs_id, name, &credentials, &gp_resp, NULL);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_getparent", ret);
+        goto out;
+    }
+    entry_name = rindex(name, '/') + 1;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.owner = credentials.userid;
+    attr.group = credentials.group_array[0];
+    attr.perms = PVFS_U_WRITE | PVFS_U_READ | PVFS_U_EXECUTE;
+    attr.atime = attr.ctime = attr.mtime = time(NULL);
+    attr.mask = PVFS_ATTR_SYS_ALL_SETABLE;
+
+    ret = PVFS_sys_mkdir(entry_name, gp_resp.parent_ref, attr, &credentials,
+                         &resp_mk, NULL);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_mkdir", ret);
+        goto out;
+    }
+    attr.perms = PVFS_U_WRITE | PVFS_U_READ;
+
+    printf("# %d files, %d in flight\n", count, in_flight);
+    printf("# %-8s %10s %12s\n", "op", "seconds", "ops/s");
+    for (pass = 0; pass < 2; pass++)
+    {
+        t0 = wtime();
+        ret = run(pass, resp_mk.ref, &attr, &credentials, count, in_flight);
+        elapsed = wtime() - t0;
+        if (ret < 0)
+        {
+            goto out;
+        }
+        printf("  %-8s %10.4f %12.0f\n", pass ? "remove" : "create",
+               elapsed, count / elapsed);
+    }
+
+    ret = PVFS_sys_remove(entry_name, gp_resp.parent_ref, &credentials,
+                          NULL);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_remove", ret);
+    }
+
+out:
+    PVFS_sys_finalize();
+    return (ret < 0) ? -1 : 0;
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
@@ -0,0 +1,338 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* Compares distributions across file sizes, in the manner of IOR.
+ *
+ * For each file size and each distribution (simple_stripe and
+ * progressive_stripe with their default parameters) it creates <files>
+ * files in <directory>, writes each in transfer-size pieces, reads it
+ * back and checks it, then removes it.  Reports create+write and read
+ * bandwidth and how many datafiles ended up holding data, as the
+ * distribution maps the file onto its datafiles.
+ */
+
+#include <time.h>
+#include "client.h"
+#include <sys/time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "pvfs2-util.h"
+#include "pvfs2-internal.h"
+#include "pint-distribution.h"
+#include "pvfs2-dist-simple-stripe.h"
+#include "pvfs2-dist-progressive.h"
+
+#define TRANSFER_SIZE (1024 * 1024)
+#define DEFAULT_FILES 8
+
+static PVFS_size default_sizes[] =
+{
+    4 * 1024,
+    64 * 1024,
+    1024 * 1024,
+    16 * 1024 * 1024,
+    128 * 1024 * 1024
+};
+
+static const char *dist_names[] =
+{
+    PVFS_DIST_SIMPLE_STRIPE_NAME,
+    PVFS_DIST_PROGRESSIVE_NAME
+};
+
+struct bench_result
+{
+    double write_seconds;       /* create, write and flush */
+    double read_seconds;
+    double datafiles;           /* holding data, summed over files */
+    double dfile_count;         /* allocated, summed over files */
+};
+
+static double wtime(void)
+{
+    struct timeval t;
+
+    gettimeofday(&t, NULL);
+    return((double)t.tv_sec + (double)t.tv_usec / 1000000);
+}
+
+/* how many of the file's datafiles hold part of its size bytes */
+static int datafiles_used(const char *dist_name, int dfile_count,
+                          PVFS_size size)
+{
+    PINT_request_file_data fd;
+    PINT_dist *dist;
+    int i, used = 0;
+
+    dist = PINT_dist_create(dist_name);
+    if (!dist)
+    {
+        return -1;
+    }
+    memset(&fd, 0, sizeof(fd));
+    fd.server_ct = dfile_count;
+    fd.dist = dist;
+    for (i = 0; i < dfile_count; i++)
+    {
+        fd.server_nr = i;
+        if (dist->methods->logical_to_physical_offset(dist->params,
+                                                      &fd, size) > 0)
+        {
+            used++;
+        }
+    }
+    PINT_dist_free(dist);
+    return used;
+}
+
+static int run_file(PVFS_object_ref parent,
+                    PVFS_credential *credentials,
+                    const char *dist_name,
+                    const char *entry_name,
+                    PVFS_size size,
+                    char *buf,
+                    char *check,
+                    struct bench_result *result)
+{
+    PVFS_sysresp_create resp_cr;
+    PVFS_sysresp_getattr resp_ga;
+    PVFS_sysresp_io resp_io;
+    PVFS_sys_dist *dist = NULL;
+    PVFS_sys_attr attr;
+    PVFS_Request mem_req;
+    PVFS_offset off;
+    PVFS_size len;
+    double t0;
+    int ret, used;
+
+    dist = PVFS_sys_dist_lookup(dist_name);
+    if (!dist)
+    {
+        fprintf(stderr, "Error: no distribution %s\n", dist_name);
+        return -PVFS_EINVAL;
+    }
+
+    memset(&attr, 0, sizeof(attr));
+    attr.owner = credentials->userid;
+    attr.group = credentials->group_array[0];
+    attr.perms = PVFS_U_WRITE | PVFS_U_READ;
+    attr.atime = attr.ctime = attr.mtime = time(NULL);
+    attr.mask = PVFS_ATTR_SYS_ALL_SETABLE;
+
+    t0 = wtime();
+    ret = PVFS_sys_create((char *)entry_name, parent, attr, credentials,
+                          dist, &resp_cr, NULL, NULL);
+    PVFS_sys_dist_free(dist);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_create", ret);
+        return ret;
+    }
+
+    for (off = 0; off < size; off += len)
+    {
+        len = (size - off < TRANSFER_SIZE) ? size - off : TRANSFER_SIZE;
+        memset(buf, (int)((off / TRANSFER_SIZE) * 13 + size) & 0xff, len);
+        PVFS_Request_contiguous(len, PVFS_BYTE, &mem_req);
+        ret = PVFS_sys_write(resp_cr.ref, PVFS_BYTE, off, buf, mem_req,
+                             credentials, &resp_io, NULL);
+        PVFS_Request_free(&mem_req);
+        if (ret < 0 || resp_io.total_completed != len)
+        {
+            PVFS_perror("PVFS_sys_write", ret);
+            ret = (ret < 0) ? ret : -PVFS_EIO;
+            goto out;
+        }
+    }
+    ret = PVFS_sys_flush(resp_cr.ref, credentials, NULL);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_flush", ret);
+        goto out;
+    }
+    result->write_seconds += wtime() - t0;
+
+    t0 = wtime();
+    for (off = 0; off < size; off += len)
+    {
+        len = (size - off < TRANSFER_SIZE) ? size - off : TRANSFER_SIZE;
+        PVFS_Request_contiguous(len, PVFS_BYTE, &mem_req);
+        ret = PVFS_sys_read(resp_cr.ref, PVFS_BYTE, off, check, mem_req,
+                            credentials, &resp_io, NULL);
+        PVFS_Request_free(&mem_req);
+        if (ret < 0 || resp_io.total_completed != len)
+        {
+            PVFS_perror("PVFS_sys_read", ret);
+            ret = (ret < 0) ? ret : -PVFS_EIO;
+            goto out;
+        }
+        memset(buf, (int)((off / TRANSFER_SIZE) * 13 + size) & 0xff, len);
+        if (memcmp(buf, check, len))
+        {
+            fprintf(stderr, "Error: %s: mismatch in %lld bytes at %lld\n",
+                    entry_name, lld(len), lld(off));
+            ret = -PVFS_EIO;
+            goto out;
+        }
+    }
+    result->read_seconds += wtime() - t0;
+
+    ret = PVFS_sys_getattr(resp_cr.ref, PVFS_ATTR_SYS_DFILE_COUNT,
+                           credentials, &resp_ga, NULL);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_getattr", ret);
+        goto out;
+    }
+    used = datafiles_used(dist_name, resp_ga.attr.dfile_count, size);
+    result->datafiles += used;
+    result->dfile_count += resp_ga.attr.dfile_count;
+
+out:
+    PVFS_sys_remove((char *)entry_name, parent, credentials, NULL);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    int ret = -1;
+    char name[512] = {0};
+    char entry_name[64];
+    char *buf = NULL, *check = NULL;
+    int files = DEFAULT_FILES;
+    PVFS_size *sizes = default_sizes;
+    int size_count = sizeof(default_sizes) / sizeof(default_sizes[0]);
+    int s, d, f;
+    PVFS_fs_id fs_id;
+    PVFS_sysresp_lookup resp_lk;
+    PVFS_credential credentials;
+    struct bench_result result;
+    double mb;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <directory> [files] [sizes...]\n",
+                argv[0]);
+        return -1;
+    }
+    if (argc > 2)
+    {
+        files = atoi(argv[2]);
+    }
+    if (argc > 3)
+    {
+        size_count = argc - 3;
+        sizes = malloc(size_count * sizeof(*sizes));
+        if (!sizes)
+        {
+            return -1;
+        }
+        for (s = 0; s < size_count; s++)
+        {
+            sizes[s] = strtoll(argv[3 + s], NULL, 0);
+            if (sizes[s] <= 0)
+            {
+                fprintf(stderr, "Error: sizes must be positive\n");
+                return -1;
+            }
+        }
+    }
+    if (files <= 0)
+    {
+        fprintf(stderr, "Error: files must be positive\n");
+        return -1;
+    }
+
+    ret = PVFS_util_init_defaults();
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_util_init_defaults", ret);
+        return -1;
+    }
+
+    ret = PVFS_util_get_default_fsid(&fs_id);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_util_get_default_fsid", ret);
+        return -1;
+    }
+
+    if (argv[1][0] == '/')
+    {
+        snprintf(name, 512, "%s", argv[1]);
+    }
+    else
+    {
+        snprintf(name, 512, "/%s", argv[1]);
+    }
+
+    PVFS_util_gen_credential_defaults(&credentials);
+    ret = PVFS_sys_lookup(fs_id, name, &credentials,
+                          &resp_lk, PVFS2_LOOKUP_LINK_FOLLOW, NULL);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_lookup", ret);
+        return -1;
+    }
+
+    buf = malloc(TRANSFER_SIZE);
+    check = malloc(TRANSFER_SIZE);
+    if (!buf || !check)
+    {
+        ret = -PVFS_ENOMEM;
+        goto out;
+    }
+
+    printf("# %d files per size, %d byte transfers\n", files,
+           TRANSFER_SIZE);
+    printf("# %-20s %12s %12s %12s %10s\n", "distribution", "file size",
+           "write MB/s", "read MB/s", "datafiles");
+
+    for (s = 0; s < size_count; s++)
+    {
+        for (d = 0; d < sizeof(dist_names) / sizeof(dist_names[0]); d++)
+        {
+            memset(&result, 0, sizeof(result));
+            for (f = 0; f < files; f++)
+            {
+                snprintf(entry_name, sizeof(entry_name),
+                         "dist-size-bench.%d.%d.%d", (int)getpid(), d, f);
+                ret = run_file(resp_lk.ref, &credentials, dist_names[d],
+                               entry_name, sizes[s], buf, check, &result);
+                if (ret < 0)
+                {
+                    goto out;
+                }
+            }
+            mb = (double)sizes[s] * files / (1024 * 1024);
+            printf("  %-20s %12lld %12.2f %12.2f %5.1f/%-4.1f\n",
+                   dist_names[d], lld(sizes[s]),
+                   mb / result.write_seconds, mb / result.read_seconds,
+                   result.datafiles / files, result.dfile_count / files);
+        }
+    }
+
+out:
+    free(buf);
+    free(check);
+    if (sizes != default_sizes)
+    {
+        free(sizes);
+    }
+    PVFS_sys_finalize();
+    return (ret < 0) ? -1 : 0;
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
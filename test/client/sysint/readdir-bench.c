@@ -0,0 +1,279 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* Times a full listing of a directory three ways: paging through it with
+ * PVFS_sys_readdir(), streaming it from all dirdata servers at once
+ * without read-ahead, and streaming it with server read-ahead.  The
+ * three entry counts must agree.
+ *
+ * With a count, the directory is created and filled first.  The entries
+ * are added with PVFS_mgmt_create_dirent() and all name the same file,
+ * so that directories of millions of entries can be set up quickly;
+ * such a directory is only good for listing.
+ */
+
+#include <time.h>
+#include "client.h"
+#include <sys/time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "pvfs2-util.h"
+#include "pvfs2-mgmt.h"
+#include "pvfs2-internal.h"
+
+#define DEFAULT_WINDOW 4
+#define PAGE_ENTRIES 512 /* PVFS_REQ_LIMIT_DIRENT_COUNT */
+
+static double wtime(void)
+{
+    struct timeval t;
+
+    gettimeofday(&t, NULL);
+    return((double)t.tv_sec + (double)t.tv_usec / 1000000);
+}
+
+static int populate(PVFS_fs_id fs_id,
+                    char *name,
+                    int count,
+                    PVFS_credential *credentials,
+                    PVFS_object_ref *dir)
+{
+    PVFS_sysresp_getparent gp_resp;
+    PVFS_sysresp_mkdir resp_mk;
+    PVFS_sysresp_create resp_cr;
+    PVFS_sys_attr attr;
+    char entry[64];
+    char *entry_name;
+    int ret, i;
+
+    memset(&gp_resp, 0, sizeof(gp_resp));
+    ret = PVFS_sys_getparent(fs_id, name, credentials, &gp_resp, NULL);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_getparent", ret);
+        return ret;
+    }
+    entry_name = rindex(name, '/') + 1;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.owner = credentials->userid;
+    attr.group = credentials->group_array[0];
+    attr.perms = PVFS_U_WRITE | PVFS_U_READ | PVFS_U_EXECUTE;
+    attr.atime = attr.ctime = attr.mtime = time(NULL);
+    attr.mask = PVFS_ATTR_SYS_ALL_SETABLE;
+
+    ret = PVFS_sys_mkdir(entry_name, gp_resp.parent_ref, attr, credentials,
+                         &resp_mk, NULL);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_mkdir", ret);
+        return ret;
+    }
+    *dir = resp_mk.ref;
+
+    attr.perms = PVFS_U_WRITE | PVFS_U_READ;
+    ret = PVFS_sys_create("target", *dir, attr, credentials, NULL,
+                          &resp_cr, NULL, NULL);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_create", ret);
+        return ret;
+    }
+
+    for (i = 1; i < count; i++)
+    {
+        snprintf(entry, sizeof(entry), "entry-%09d", i);
+        ret = PVFS_mgmt_create_dirent(*dir, entry, resp_cr.ref.handle,
+                                      credentials, NULL);
+        if (ret < 0)
+        {
+            PVFS_perror("PVFS_mgmt_create_dirent", ret);
+            return ret;
+        }
+        if (i % 100000 == 0)
+        {
+            printf("# %d entries\n", i);
+        }
+    }
+    return 0;
+}
+
+static int list_paged(PVFS_object_ref dir,
+                      PVFS_credential *credentials,
+                      long long *entries)
+{
+    PVFS_sysresp_readdir resp;
+    PVFS_ds_position token = PVFS_READDIR_START;
+    int ret;
+
+    *entries = 0;
+    do
+    {
+        memset(&resp, 0, sizeof(resp));
+        ret = PVFS_sys_readdir(dir, token, PAGE_ENTRIES,
+                               credentials, &resp, NULL);
+        if (ret < 0)
+        {
+            PVFS_perror("PVFS_sys_readdir", ret);
+            return ret;
+        }
+        *entries += resp.pvfs_dirent_outcount;
+        token = resp.token;
+        free(resp.dirent_array);
+    } while (resp.pvfs_dirent_outcount && token != PVFS_READDIR_END);
+    return 0;
+}
+
+static int list_stream(PVFS_object_ref dir,
+                       PVFS_credential *credentials,
+                       int window,
+                       long long *entries)
+{
+    PVFS_sys_readdir_stream stream;
+    PVFS_sysresp_readdir resp;
+    int ret;
+
+    *entries = 0;
+    ret = PVFS_sys_readdir_stream_open(dir, credentials, window, &stream);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_readdir_stream_open", ret);
+        return ret;
+    }
+    do
+    {
+        ret = PVFS_sys_readdir_stream_next(stream, &resp, NULL);
+        if (ret < 0)
+        {
+            PVFS_perror("PVFS_sys_readdir_stream_next", ret);
+            break;
+        }
+        *entries += resp.pvfs_dirent_outcount;
+        free(resp.dirent_array);
+    } while (resp.token != PVFS_READDIR_END);
+    PVFS_sys_readdir_stream_close(stream);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    int ret = -1;
+    char name[512] = {0};
+    int count = 0, window = DEFAULT_WINDOW, run;
+    long long entries[3];
+    double t0, elapsed;
+    PVFS_fs_id fs_id;
+    PVFS_sysresp_lookup resp_lk;
+    PVFS_credential credentials;
+    PVFS_object_ref dir;
+    static const char *names[3] = {"paged", "stream", "stream+ra"};
+
+    if (argc < 2 || argc > 4)
+    {
+        fprintf(stderr, "Usage: %s <directory> [create count] [window]\n",
+                argv[0]);
+        return -1;
+    }
+    if (argc > 2)
+    {
+        count = atoi(argv[2]);
+    }
+    if (argc > 3)
+    {
+        window = atoi(argv[3]);
+    }
+
+    ret = PVFS_util_init_defaults();
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_util_init_defaults", ret);
+        return -1;
+    }
+
+    ret = PVFS_util_get_default_fsid(&fs_id);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_util_get_default_fsid", ret);
+        return -1;
+    }
+
+    if (argv[1][0] == '/')
+    {
+        snprintf(name, 512, "%s", argv[1]);
+    }
+    else
+    {
+        snprintf(name, 512, "/%s", argv[1]);
+    }
+
+    PVFS_util_gen_credential_defaults(&credentials);
+    if (count > 0)
+    {
+        t0 = wtime();
+        ret = populate(fs_id, name, count, &credentials, &dir);
+        if (ret < 0)
+        {
+            goto out;
+        }
+        printf("# created %d entries in %.2f seconds\n", count,
+               wtime() - t0);
+    }
+    else
+    {
+        ret = PVFS_sys_lookup(fs_id, name, &credentials,
+                              &resp_lk, PVFS2_LOOKUP_LINK_FOLLOW, NULL);
+        if (ret < 0)
+        {
+            PVFS_perror("PVFS_sys_lookup", ret);
+            goto out;
+        }
+        dir = resp_lk.ref;
+    }
+
+    printf("# %-10s %12s %10s %12s\n", "listing", "entries", "seconds",
+           "entries/s");
+    for (run = 0; run < 3; run++)
+    {
+        t0 = wtime();
+        if (run == 0)
+        {
+            ret = list_paged(dir, &credentials, &entries[run]);
+        }
+        else
+        {
+            ret = list_stream(dir, &credentials, (run == 2) ? window : 0,
+                              &entries[run]);
+        }
+        elapsed = wtime() - t0;
+        if (ret < 0)
+        {
+            goto out;
+        }
+        printf("  %-10s %12lld %10.4f %12.0f\n", names[run], entries[run],
+               elapsed, entries[run] / elapsed);
+    }
+
+    if (entries[1] != entries[0] || entries[2] != entries[0])
+    {
+        fprintf(stderr, "Error: listings returned different counts\n");
+        ret = -PVFS_EIO;
+    }
+
+out:
+    PVFS_sys_finalize();
+    return (ret < 0) ? -1 : 0;
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
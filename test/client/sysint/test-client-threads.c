@@ -0,0 +1,327 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* Measures how the client library scales with the number of threads
+ * issuing independent operations.  Each thread repeatedly creates a
+ * file of its own, writes and reads back a small buffer, gets its
+ * attributes and removes it; the aggregate operation rate is reported
+ * for 1, 2, 4, ... threads up to the requested maximum.  Run it with
+ * PVFS2_CLIENT_SM_CONTEXTS unset and then set to the thread count to
+ * compare one shared job context against one context per thread.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "client.h"
+#include "pvfs2-util.h"
+#include "str-utils.h"
+#include "pint-sysint-utils.h"
+
+/* create, write, read, getattr and remove */
+#define OPS_PER_ITERATION 5
+
+struct thread_args
+{
+    int id;
+    int iterations;
+    int size;
+    char *base;
+    PVFS_object_ref parent;
+    PVFS_credential *cred;
+    int ret;
+};
+
+static double Wtime(void)
+{
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    return((double)t.tv_sec + (double)(t.tv_usec) / 1000000);
+}
+
+static int one_iteration(struct thread_args *args, int i,
+                         char *buf, char *check)
+{
+    char entry_name[256];
+    PVFS_sys_attr attr;
+    PVFS_sysresp_create resp_create;
+    PVFS_sysresp_getattr resp_getattr;
+    PVFS_sysresp_io resp_io;
+    PVFS_Request mem_req;
+    int ret;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.mask = PVFS_ATTR_SYS_ALL_SETABLE;
+    attr.owner = args->cred->userid;
+    attr.group = args->cred->group_array[0];
+    attr.perms = 0644;
+    attr.atime = attr.ctime = attr.mtime = time(NULL);
+
+    sprintf(entry_name, "%s.%d.%d", args->base, args->id, i);
+    ret = PVFS_sys_create(entry_name, args->parent, attr, args->cred,
+                          NULL, &resp_create, NULL, NULL);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_create", ret);
+        return ret;
+    }
+
+    ret = PVFS_Request_contiguous(args->size, PVFS_BYTE, &mem_req);
+    if (ret < 0)
+    {
+        return ret;
+    }
+    memset(buf, 'a' + (args->id + i) % 26, args->size);
+    ret = PVFS_sys_write(resp_create.ref, PVFS_BYTE, 0, buf, mem_req,
+                         args->cred, &resp_io, NULL);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_write", ret);
+        PVFS_Request_free(&mem_req);
+        return ret;
+    }
+    memset(check, 0, args->size);
+    ret = PVFS_sys_read(resp_create.ref, PVFS_BYTE, 0, check, mem_req,
+                        args->cred, &resp_io, NULL);
+    PVFS_Request_free(&mem_req);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_read", ret);
+        return ret;
+    }
+    if (resp_io.total_completed != args->size ||
+        memcmp(buf, check, args->size))
+    {
+        fprintf(stderr, "Error: thread %d read back wrong data\n",
+                args->id);
+        return -1;
+    }
+
+    ret = PVFS_sys_getattr(resp_create.ref, PVFS_ATTR_SYS_ALL_NOHINT,
+                           args->cred, &resp_getattr, NULL);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_getattr", ret);
+        return ret;
+    }
+    PVFS_util_release_sys_attr(&resp_getattr.attr);
+
+    ret = PVFS_sys_remove(entry_name, args->parent, args->cred, NULL);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_remove", ret);
+    }
+    return ret;
+}
+
+static void *thread_fn(void *ptr)
+{
+    struct thread_args *args = ptr;
+    char *buf;
+    char *check;
+    int i;
+
+    buf = malloc(args->size);
+    check = malloc(args->size);
+    if (!buf || !check)
+    {
+        args->ret = -1;
+        return NULL;
+    }
+    for (i = 0; i < args->iterations; i++)
+    {
+        args->ret = one_iteration(args, i, buf, check);
+        if (args->ret < 0)
+        {
+            break;
+        }
+    }
+    free(check);
+    free(buf);
+    return NULL;
+}
+
+static int run_threads(struct thread_args *args, int nthreads,
+                       double *elapsed)
+{
+    pthread_t *threads;
+    double start_time;
+    int ret = 0;
+    int i;
+
+    threads = malloc(nthreads * sizeof(*threads));
+    if (!threads)
+    {
+        return -1;
+    }
+
+    start_time = Wtime();
+    for (i = 0; i < nthreads; i++)
+    {
+        if (pthread_create(&threads[i], NULL, thread_fn, &args[i]) != 0)
+        {
+            fprintf(stderr, "Error: pthread_create failed\n");
+            nthreads = i;
+            ret = -1;
+            break;
+        }
+    }
+    for (i = 0; i < nthreads; i++)
+    {
+        pthread_join(threads[i], NULL);
+        if (args[i].ret < 0)
+        {
+            ret = args[i].ret;
+        }
+    }
+    *elapsed = Wtime() - start_time;
+
+    free(threads);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    int ret = -1;
+    char str_buf[256] = {0};
+    char *basename;
+    char *contexts;
+    PVFS_fs_id cur_fs;
+    PVFS_object_ref parent_refn;
+    PVFS_credential credentials;
+    struct thread_args *args;
+    int max_threads = 0;
+    int iterations = 0;
+    int size = 0;
+    int nthreads;
+    double elapsed;
+    double rate;
+    double base_rate = 0;
+    int i;
+
+    if (argc != 5)
+    {
+        fprintf(stderr, "Usage: %s <filename (base)> <max threads> "
+                "<iterations per thread> <bytes>\n", argv[0]);
+        return ret;
+    }
+    basename = argv[1];
+    if (sscanf(argv[2], "%d", &max_threads) != 1 ||
+        sscanf(argv[3], "%d", &iterations) != 1 ||
+        sscanf(argv[4], "%d", &size) != 1 ||
+        max_threads < 1 || iterations < 1 || size < 1)
+    {
+        fprintf(stderr, "Error: could not parse args.\n");
+        return(-1);
+    }
+
+    args = malloc(max_threads * sizeof(*args));
+    if (!args)
+    {
+        return(-1);
+    }
+
+    ret = PVFS_util_init_defaults();
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_util_init_defaults", ret);
+        return (-1);
+    }
+    ret = PVFS_util_get_default_fsid(&cur_fs);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_util_get_default_fsid", ret);
+        return (-1);
+    }
+
+    if (PINT_remove_base_dir(basename, str_buf, 256))
+    {
+        if (basename[0] != '/')
+        {
+            printf("You forgot the leading '/'\n");
+        }
+        printf("Cannot retrieve entry name for creation on %s\n",
+               basename);
+        return(-1);
+    }
+
+    PVFS_util_gen_credential_defaults(&credentials);
+
+    ret = PINT_lookup_parent(basename, cur_fs, &credentials,
+                             &parent_refn.handle);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_util_lookup_parent", ret);
+        return(-1);
+    }
+    parent_refn.fs_id = cur_fs;
+
+    for (i = 0; i < max_threads; i++)
+    {
+        args[i].id = i;
+        args[i].size = size;
+        args[i].base = str_buf;
+        args[i].parent = parent_refn;
+        args[i].cred = &credentials;
+        args[i].ret = 0;
+    }
+
+    /* one pass to prime connections and caches */
+    args[0].iterations = 1;
+    if (run_threads(args, 1, &elapsed) < 0)
+    {
+        return(-1);
+    }
+
+    contexts = getenv("PVFS2_CLIENT_SM_CONTEXTS");
+    printf("%d iterations per thread of %d ops, %d bytes, "
+           "PVFS2_CLIENT_SM_CONTEXTS=%s\n", iterations, OPS_PER_ITERATION,
+           size, contexts ? contexts : "(unset)");
+    printf("%8s %14s %10s\n", "threads", "ops/sec", "speedup");
+
+    for (nthreads = 1; ; nthreads *= 2)
+    {
+        if (nthreads > max_threads)
+        {
+            nthreads = max_threads;
+        }
+        for (i = 0; i < nthreads; i++)
+        {
+            args[i].iterations = iterations;
+        }
+        if (run_threads(args, nthreads, &elapsed) < 0)
+        {
+            return(-1);
+        }
+        rate = (double)nthreads * iterations * OPS_PER_ITERATION / elapsed;
+        if (nthreads == 1)
+        {
+            base_rate = rate;
+        }
+        printf("%8d %14.1f %10.2f\n", nthreads, rate, rate / base_rate);
+        if (nthreads == max_threads)
+        {
+            break;
+        }
+    }
+
+    PVFS_sys_finalize();
+    free(args);
+    return 0;
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
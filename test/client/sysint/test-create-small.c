@@ -0,0 +1,283 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* Measures files per second for creating, writing and closing many small
+ * files, once with PVFS_sys_create() followed by PVFS_sys_write() and
+ * once with PVFS_sys_create_with_data(), and checks that the data of
+ * every file written the second way reads back.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include "client.h"
+#include "pvfs2-util.h"
+#include "str-utils.h"
+#include "pint-sysint-utils.h"
+
+static double Wtime(void)
+{
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    return((double)t.tv_sec + (double)(t.tv_usec) / 1000000);
+}
+
+static int write_separately(char *name, PVFS_object_ref parent,
+                            PVFS_sys_attr attr, PVFS_credential *cred,
+                            char *buf, int size, PVFS_sysresp_create *resp)
+{
+    PVFS_sysresp_io resp_io;
+    PVFS_Request mem_req;
+    int ret;
+
+    ret = PVFS_sys_create(name, parent, attr, cred, NULL, resp, NULL, NULL);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_create", ret);
+        return ret;
+    }
+    ret = PVFS_Request_contiguous(size, PVFS_BYTE, &mem_req);
+    if (ret < 0)
+    {
+        return ret;
+    }
+    ret = PVFS_sys_write(resp->ref, PVFS_BYTE, 0, buf, mem_req, cred,
+                         &resp_io, NULL);
+    PVFS_Request_free(&mem_req);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_write", ret);
+    }
+    return ret;
+}
+
+static int check_file(PVFS_object_ref ref, PVFS_credential *cred,
+                      char *buf, char *check, int size)
+{
+    PVFS_sysresp_getattr resp_getattr;
+    PVFS_sysresp_io resp_io;
+    PVFS_Request mem_req;
+    int ret;
+
+    ret = PVFS_sys_getattr(ref, PVFS_ATTR_SYS_ALL_NOHINT, cred,
+                           &resp_getattr, NULL);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_getattr", ret);
+        return ret;
+    }
+    PVFS_util_release_sys_attr(&resp_getattr.attr);
+    if (resp_getattr.attr.size != size)
+    {
+        fprintf(stderr, "Error: file size %lld, expected %d\n",
+                lld(resp_getattr.attr.size), size);
+        return -1;
+    }
+
+    memset(check, 0, size);
+    ret = PVFS_Request_contiguous(size, PVFS_BYTE, &mem_req);
+    if (ret < 0)
+    {
+        return ret;
+    }
+    ret = PVFS_sys_read(ref, PVFS_BYTE, 0, check, mem_req, cred,
+                        &resp_io, NULL);
+    PVFS_Request_free(&mem_req);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_read", ret);
+        return ret;
+    }
+    if (resp_io.total_completed != size || memcmp(buf, check, size))
+    {
+        fprintf(stderr, "Error: data read back does not match\n");
+        return -1;
+    }
+    return 0;
+}
+
+static int remove_all(char *base, PVFS_object_ref parent,
+                      PVFS_credential *cred, int files)
+{
+    char entry_name[256];
+    int ret;
+    int i;
+
+    for (i = 0; i < files; i++)
+    {
+        sprintf(entry_name, "%s%d", base, i);
+        ret = PVFS_sys_remove(entry_name, parent, cred, NULL);
+        if (ret < 0)
+        {
+            PVFS_perror("PVFS_sys_remove", ret);
+            return ret;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int ret = -1;
+    char str_buf[256] = {0};
+    char *basename;
+    PVFS_fs_id cur_fs;
+    PVFS_sysresp_create resp_create;
+    PVFS_object_ref *refs;
+    char entry_name[256];
+    PVFS_object_ref parent_refn;
+    PVFS_sys_attr attr;
+    PVFS_credential credentials;
+    int files = 0;
+    int size = 0;
+    char *buf;
+    char *check;
+    double start_time;
+    double separate_time;
+    double compound_time;
+    int i;
+
+    if (argc != 4)
+    {
+        fprintf(stderr, "Usage: %s <filename (base)> <files> <bytes>\n",
+                argv[0]);
+        return ret;
+    }
+    basename = argv[1];
+    if (sscanf(argv[2], "%d", &files) != 1 ||
+        sscanf(argv[3], "%d", &size) != 1 || files < 1 || size < 1)
+    {
+        fprintf(stderr, "Error: could not parse args.\n");
+        return(-1);
+    }
+
+    buf = malloc(size);
+    check = malloc(size);
+    refs = malloc(files * sizeof(*refs));
+    if (!buf || !check || !refs)
+    {
+        return(-1);
+    }
+
+    ret = PVFS_util_init_defaults();
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_util_init_defaults", ret);
+        return (-1);
+    }
+    ret = PVFS_util_get_default_fsid(&cur_fs);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_util_get_default_fsid", ret);
+        return (-1);
+    }
+
+    if (PINT_remove_base_dir(basename, str_buf, 256))
+    {
+        if (basename[0] != '/')
+        {
+            printf("You forgot the leading '/'\n");
+        }
+        printf("Cannot retrieve entry name for creation on %s\n",
+               basename);
+        return(-1);
+    }
+
+    PVFS_util_gen_credential_defaults(&credentials);
+
+    attr.mask = PVFS_ATTR_SYS_ALL_SETABLE;
+    attr.owner = credentials.userid;
+    attr.group = credentials.group_array[0];
+    attr.perms = 0644;
+    attr.atime = attr.ctime = attr.mtime = time(NULL);
+
+    ret = PINT_lookup_parent(basename, cur_fs, &credentials,
+                             &parent_refn.handle);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_util_lookup_parent", ret);
+        return(-1);
+    }
+    parent_refn.fs_id = cur_fs;
+
+    /* one of each to prime connections and caches */
+    sprintf(entry_name, "%s%d", str_buf, 0);
+    if (write_separately(entry_name, parent_refn, attr, &credentials,
+                         buf, size, &resp_create) < 0 ||
+        remove_all(str_buf, parent_refn, &credentials, 1) < 0)
+    {
+        return(-1);
+    }
+
+    start_time = Wtime();
+    for (i = 0; i < files; i++)
+    {
+        memset(buf, 'a' + i % 26, size);
+        sprintf(entry_name, "%s%d", str_buf, i);
+        if (write_separately(entry_name, parent_refn, attr, &credentials,
+                             buf, size, &resp_create) < 0)
+        {
+            return(-1);
+        }
+    }
+    separate_time = Wtime() - start_time;
+    if (remove_all(str_buf, parent_refn, &credentials, files) < 0)
+    {
+        return(-1);
+    }
+
+    start_time = Wtime();
+    for (i = 0; i < files; i++)
+    {
+        memset(buf, 'a' + i % 26, size);
+        sprintf(entry_name, "%s%d", str_buf, i);
+        ret = PVFS_sys_create_with_data(entry_name, parent_refn, attr,
+                                        &credentials, NULL, NULL, buf, size,
+                                        &resp_create, NULL);
+        if (ret < 0)
+        {
+            PVFS_perror("PVFS_sys_create_with_data", ret);
+            return(-1);
+        }
+        refs[i] = resp_create.ref;
+    }
+    compound_time = Wtime() - start_time;
+
+    for (i = 0; i < files; i++)
+    {
+        memset(buf, 'a' + i % 26, size);
+        if (check_file(refs[i], &credentials, buf, check, size) < 0)
+        {
+            return(-1);
+        }
+    }
+    if (remove_all(str_buf, parent_refn, &credentials, files) < 0)
+    {
+        return(-1);
+    }
+
+    printf("%d files of %d bytes\n", files, size);
+    printf("create + write:    %10.1f files/sec\n", files / separate_time);
+    printf("create_with_data:  %10.1f files/sec\n", files / compound_time);
+
+    PVFS_sys_finalize();
+    free(refs);
+    free(check);
+    free(buf);
+    return 0;
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
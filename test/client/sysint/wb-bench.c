@@ -0,0 +1,291 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* Times small writes with and without the sysint write-behind cache.
+ *
+ * Each run writes <count> blocks of 1 KiB, either in order or at
+ * shuffled block offsets, then calls PVFS_sys_flush() so the buffered
+ * runs are charged for writing out their data.  Every run is read back
+ * and checked.  The wbcache counters are printed at the end.
+ */
+
+#include <time.h>
+#include "client.h"
+#include <sys/time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+#include "pvfs2-util.h"
+#include "pvfs2-internal.h"
+#include "pint-perf-counter.h"
+#include "wbcache.h"
+
+#define BLOCK_SIZE 1024
+#define DEFAULT_COUNT 4096
+#define DEFAULT_CACHE_SIZE (1024 * 1024)
+
+static double wtime(void)
+{
+    struct timeval t;
+
+    gettimeofday(&t, NULL);
+    return((double)t.tv_sec + (double)t.tv_usec / 1000000);
+}
+
+static int run(PVFS_object_ref refn,
+               PVFS_credential *credentials,
+               int *order,
+               int count,
+               int pass,
+               double *elapsed)
+{
+    PVFS_Request mem_req;
+    PVFS_sysresp_io resp_io;
+    char buf[BLOCK_SIZE];
+    char *check = NULL;
+    double t0;
+    int ret, i;
+
+    ret = PVFS_Request_contiguous(BLOCK_SIZE, PVFS_BYTE, &mem_req);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_Request_contiguous", ret);
+        return ret;
+    }
+
+    t0 = wtime();
+    for (i = 0; i < count; i++)
+    {
+        memset(buf, (order[i] * 7 + pass) & 0xff, BLOCK_SIZE);
+        ret = PVFS_sys_write(refn, PVFS_BYTE,
+                             (PVFS_offset)order[i] * BLOCK_SIZE,
+                             buf, mem_req, credentials, &resp_io, NULL);
+        if (ret < 0 || resp_io.total_completed != BLOCK_SIZE)
+        {
+            PVFS_perror("PVFS_sys_write", ret);
+            goto out;
+        }
+    }
+    ret = PVFS_sys_flush(refn, credentials, NULL);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_flush", ret);
+        goto out;
+    }
+    *elapsed = wtime() - t0;
+
+    /* read everything back in one request */
+    PVFS_Request_free(&mem_req);
+    ret = PVFS_Request_contiguous(count * BLOCK_SIZE, PVFS_BYTE, &mem_req);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_Request_contiguous", ret);
+        return ret;
+    }
+    check = malloc(count * BLOCK_SIZE);
+    if (!check)
+    {
+        ret = -PVFS_ENOMEM;
+        goto out;
+    }
+    ret = PVFS_sys_read(refn, PVFS_BYTE, 0, check, mem_req, credentials,
+                        &resp_io, NULL);
+    if (ret < 0 || resp_io.total_completed != (PVFS_size)count * BLOCK_SIZE)
+    {
+        PVFS_perror("PVFS_sys_read", ret);
+        ret = (ret < 0) ? ret : -PVFS_EIO;
+        goto out;
+    }
+    for (i = 0; i < count * BLOCK_SIZE; i++)
+    {
+        if ((unsigned char)check[i] !=
+            (unsigned char)(((i / BLOCK_SIZE) * 7 + pass) & 0xff))
+        {
+            fprintf(stderr, "Error: mismatch at offset %d\n", i);
+            ret = -PVFS_EIO;
+            goto out;
+        }
+    }
+
+out:
+    free(check);
+    PVFS_Request_free(&mem_req);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    int ret = -1;
+    char name[512] = {0};
+    char *entry_name = NULL;
+    char *text = NULL;
+    int count = DEFAULT_COUNT;
+    unsigned int cache_size = DEFAULT_CACHE_SIZE;
+    int *order = NULL;
+    int i, j, tmp, pass = 0, cached, random;
+    double elapsed = 0;
+    PVFS_fs_id fs_id;
+    PVFS_sysresp_lookup resp_lk;
+    PVFS_sysresp_create resp_cr;
+    PVFS_credential credentials;
+    PVFS_sys_attr attr;
+    PVFS_object_ref refn;
+
+    if (argc < 2 || argc > 4)
+    {
+        fprintf(stderr, "Usage: %s <filename> [writes] [cache bytes]\n",
+                argv[0]);
+        return -1;
+    }
+    if (argc > 2)
+    {
+        count = atoi(argv[2]);
+    }
+    if (argc > 3)
+    {
+        cache_size = (unsigned int)strtoul(argv[3], NULL, 0);
+    }
+    if (count <= 0 || cache_size == 0)
+    {
+        fprintf(stderr, "Error: writes and cache bytes must be positive\n");
+        return -1;
+    }
+
+    ret = PVFS_util_init_defaults();
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_util_init_defaults", ret);
+        return -1;
+    }
+
+    ret = PVFS_util_get_default_fsid(&fs_id);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_util_get_default_fsid", ret);
+        return -1;
+    }
+
+    if (argv[1][0] == '/')
+    {
+        snprintf(name, 512, "%s", argv[1]);
+    }
+    else
+    {
+        snprintf(name, 512, "/%s", argv[1]);
+    }
+
+    PVFS_util_gen_credential_defaults(&credentials);
+    ret = PVFS_sys_lookup(fs_id, name, &credentials,
+                          &resp_lk, PVFS2_LOOKUP_LINK_FOLLOW, NULL);
+    if (ret == -PVFS_ENOENT)
+    {
+        PVFS_sysresp_getparent gp_resp;
+
+        memset(&gp_resp, 0, sizeof(PVFS_sysresp_getparent));
+        ret = PVFS_sys_getparent(fs_id, name, &credentials, &gp_resp, NULL);
+        if (ret < 0)
+        {
+            PVFS_perror("PVFS_sys_getparent failed", ret);
+            return ret;
+        }
+
+        attr.owner = credentials.userid;
+        attr.group = credentials.group_array[0];
+        attr.perms = PVFS_U_WRITE | PVFS_U_READ;
+        attr.atime = attr.ctime = attr.mtime = time(NULL);
+        attr.mask = PVFS_ATTR_SYS_ALL_SETABLE;
+
+        entry_name = rindex(name, (int)'/');
+        assert(entry_name);
+        entry_name++;
+
+        ret = PVFS_sys_create(entry_name, gp_resp.parent_ref, attr,
+                              &credentials, NULL, &resp_cr, NULL, NULL);
+        if (ret < 0)
+        {
+            PVFS_perror("PVFS_sys_create() failure", ret);
+            return -1;
+        }
+        refn = resp_cr.ref;
+    }
+    else if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_lookup", ret);
+        return -1;
+    }
+    else
+    {
+        refn = resp_lk.ref;
+    }
+
+    order = malloc(count * sizeof(int));
+    if (!order)
+    {
+        return -1;
+    }
+
+    printf("# %d writes of %d bytes, %u byte write-behind buffer\n",
+           count, BLOCK_SIZE, cache_size);
+    printf("# %-10s %-8s %10s %10s\n", "pattern", "wbcache", "seconds",
+           "MB/s");
+
+    for (random = 0; random < 2; random++)
+    {
+        for (i = 0; i < count; i++)
+        {
+            order[i] = i;
+        }
+        if (random)
+        {
+            srand(count);
+            for (i = count - 1; i > 0; i--)
+            {
+                j = rand() % (i + 1);
+                tmp = order[i];
+                order[i] = order[j];
+                order[j] = tmp;
+            }
+        }
+        for (cached = 0; cached < 2; cached++)
+        {
+            PINT_wbcache_set_info(WBCACHE_BUFFER_SIZE,
+                                  cached ? cache_size : 0);
+            ret = run(refn, &credentials, order, count, pass++, &elapsed);
+            if (ret < 0)
+            {
+                goto out;
+            }
+            printf("  %-10s %-8s %10.4f %10.2f\n",
+                   random ? "random" : "sequential",
+                   cached ? "on" : "off", elapsed,
+                   ((double)count * BLOCK_SIZE) / (elapsed * 1024 * 1024));
+        }
+    }
+    PINT_wbcache_set_info(WBCACHE_BUFFER_SIZE, 0);
+
+    text = PINT_perf_generate_text(PINT_wbcache_get_pc(), 4096);
+    if (text)
+    {
+        printf("%s", text);
+        free(text);
+    }
+
+out:
+    free(order);
+    PVFS_sys_finalize();
+    return (ret < 0) ? -1 : 0;
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
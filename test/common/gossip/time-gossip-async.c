@@ -0,0 +1,175 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* Times enabled gossip_debug() calls from several threads logging to a
+ * file, first synchronously and then through the async ring writer, and
+ * reports how many async messages were dropped.  Every message that was
+ * not dropped must be in the log file.  Arguments are [threads]
+ * [messages per thread] [log file] [full-ring wait in msecs].
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "gossip.h"
+
+enum
+{
+    DEBUG_SOME_STUFF = 1,
+};
+
+#define MESSAGE_TEXT "some state machine did something"
+
+static unsigned int iter = 200000;
+
+static double Wtime(void);
+static double run_threads(int nthreads);
+static uint64_t count_messages(const char *logfile);
+
+static void *log_thread(void *arg)
+{
+    unsigned int i;
+    long id = (long) arg;
+
+    for (i = 0; i < iter; i++)
+    {
+        gossip_debug(DEBUG_SOME_STUFF, "thread %ld message %u of %u: %s\n",
+                     id, i, iter, MESSAGE_TEXT);
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    const char *logfile = "/tmp/time-gossip-async.log";
+    int nthreads = 4;
+    int wait_msecs = 0;
+    double sync_time, async_time;
+    uint64_t drops, total, logged;
+
+    if (argc > 1)
+    {
+        nthreads = atoi(argv[1]);
+    }
+    if (argc > 2)
+    {
+        iter = atoi(argv[2]);
+    }
+    if (argc > 3)
+    {
+        logfile = argv[3];
+    }
+    if (argc > 4)
+    {
+        wait_msecs = atoi(argv[4]);
+    }
+
+    if (gossip_enable_file(logfile, "w") < 0)
+    {
+        fprintf(stderr, "could not open %s\n", logfile);
+        return 1;
+    }
+    gossip_set_debug_mask(1, DEBUG_SOME_STUFF);
+
+    sync_time = run_threads(nthreads);
+
+    if (gossip_enable_async(0, wait_msecs) < 0)
+    {
+        fprintf(stderr, "async logging not available\n");
+        return 1;
+    }
+    async_time = run_threads(nthreads);
+    gossip_disable_async();
+    drops = gossip_get_async_drops();
+    total = (uint64_t) nthreads * iter;
+
+    printf("%d threads x %u messages to %s\n", nthreads, iter, logfile);
+    printf("sync:  %.3f seconds, %.0f ns per call\n", sync_time,
+           sync_time * 1e9 / iter);
+    printf("async: %.3f seconds, %.0f ns per call, %llu of %llu dropped "
+           "(%.2f%%)\n",
+           async_time, async_time * 1e9 / iter,
+           (unsigned long long) drops, (unsigned long long) total,
+           100.0 * drops / total);
+
+    gossip_disable();
+
+    /* both runs wrote total messages; only counted drops may be missing */
+    logged = count_messages(logfile);
+    if (logged != 2 * total - drops)
+    {
+        fprintf(stderr, "Error: %llu messages in %s, expected %llu\n",
+                (unsigned long long) logged, logfile,
+                (unsigned long long) (2 * total - drops));
+        return 1;
+    }
+    return 0;
+}
+
+static uint64_t count_messages(const char *logfile)
+{
+    char line[512];
+    uint64_t count = 0;
+    FILE *fp;
+
+    fp = fopen(logfile, "r");
+    if (!fp)
+    {
+        return 0;
+    }
+    while (fgets(line, sizeof(line), fp))
+    {
+        if (strstr(line, MESSAGE_TEXT))
+        {
+            count++;
+        }
+    }
+    fclose(fp);
+
+    return count;
+}
+
+static double run_threads(int nthreads)
+{
+    pthread_t *threads;
+    double start;
+    long i;
+
+    threads = malloc(nthreads * sizeof(*threads));
+    start = Wtime();
+    for (i = 0; i < nthreads; i++)
+    {
+        pthread_create(&threads[i], NULL, log_thread, (void *) i);
+    }
+    for (i = 0; i < nthreads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+
+    return Wtime() - start;
+}
+
+static double Wtime(void)
+{
+    struct timeval t;
+
+    gettimeofday(&t, NULL);
+    return((double)t.tv_sec + (double)t.tv_usec / 1000000);
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
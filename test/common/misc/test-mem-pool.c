@@ -0,0 +1,260 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* test-mem-pool: runs a mix of I/O sized allocations the way a server
+ * makes them (flow buffers, direct I/O bounce buffers, small eager and
+ * unexpected messages) from several threads, first with posix_memalign
+ * and free, then with the I/O buffer pool.  Each buffer is filled as
+ * if data moved through it.  Reports time, page faults and allocator
+ * time for both, and checks that buffers are aligned as
+ * PINT_mem_pool_alignment() says, never handed out twice, and that the
+ * pool counters add up.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "pvfs2.h"
+#include "pvfs2-internal.h"
+#include "pint-mem-pool.h"
+
+#define DEPTH 8
+
+struct test_thread
+{
+    pthread_t thread;
+    int index;
+    int use_pool;
+    long iterations;
+    double alloc_seconds;
+    long errors;
+};
+
+static double Wtime(void)
+{
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    return((double)t.tv_sec + (double)(t.tv_usec) / 1000000);
+}
+
+static double tv_seconds(struct timeval *tv)
+{
+    return((double)tv->tv_sec + (double)tv->tv_usec / 1000000);
+}
+
+/* the size mix of a server moving file data */
+static size_t pick_size(unsigned int *seed)
+{
+    int r = rand_r(seed) % 100;
+
+    if(r < 40)
+    {
+        return 256 * 1024;                      /* flow buffers */
+    }
+    if(r < 60)
+    {
+        return 64 * 1024;
+    }
+    if(r < 70)
+    {
+        return 16 + rand_r(seed) % 2048;        /* headers, eager messages */
+    }
+    if(r < 80)
+    {
+        return 512 + rand_r(seed) % 16384;      /* messages, RMW blocks */
+    }
+    if(r < 95)
+    {
+        return 1024 * 1024;
+    }
+    if(r < 99)
+    {
+        return 4 * 1024 * 1024;
+    }
+    return 6 * 1024 * 1024;                     /* past the largest class */
+}
+
+static void *test_thread_fn(void *arg)
+{
+    struct test_thread *tt = (struct test_thread *)arg;
+    unsigned int seed = 31 + tt->index;
+    void *bufs[DEPTH] = {NULL};
+    size_t sizes[DEPTH] = {0};
+    uint64_t tags[DEPTH] = {0};
+    uint64_t tag;
+    double start;
+    long i;
+    int slot;
+
+    for(i = 0; i < tt->iterations; i++)
+    {
+        slot = i % DEPTH;
+        if(bufs[slot])
+        {
+            /* a buffer shared with another holder would be overwritten */
+            if(memcmp(bufs[slot], &tags[slot], sizeof(tag)) ||
+               memcmp((char *)bufs[slot] + sizes[slot] - sizeof(tag),
+                      &tags[slot], sizeof(tag)))
+            {
+                tt->errors++;
+            }
+            start = Wtime();
+            if(tt->use_pool)
+            {
+                PINT_mem_pool_free(bufs[slot]);
+            }
+            else
+            {
+                free(bufs[slot]);
+            }
+            tt->alloc_seconds += Wtime() - start;
+        }
+
+        sizes[slot] = pick_size(&seed);
+        start = Wtime();
+        if(tt->use_pool)
+        {
+            bufs[slot] = PINT_mem_pool_alloc(sizes[slot]);
+        }
+        else if(posix_memalign(&bufs[slot],
+                               PINT_mem_pool_alignment(sizes[slot]),
+                               sizes[slot]) != 0)
+        {
+            bufs[slot] = NULL;
+        }
+        tt->alloc_seconds += Wtime() - start;
+        if(!bufs[slot] ||
+           ((uintptr_t)bufs[slot] %
+            PINT_mem_pool_alignment(sizes[slot])) != 0)
+        {
+            tt->errors++;
+            bufs[slot] = NULL;
+            continue;
+        }
+
+        memset(bufs[slot], i & 0xff, sizes[slot]);
+        tag = ((uint64_t)tt->index << 48) | (uint64_t)i;
+        tags[slot] = tag;
+        memcpy(bufs[slot], &tag, sizeof(tag));
+        memcpy((char *)bufs[slot] + sizes[slot] - sizeof(tag), &tag,
+               sizeof(tag));
+    }
+
+    for(slot = 0; slot < DEPTH; slot++)
+    {
+        if(tt->use_pool)
+        {
+            PINT_mem_pool_free(bufs[slot]);
+        }
+        else
+        {
+            free(bufs[slot]);
+        }
+    }
+    return(NULL);
+}
+
+static long run(int use_pool, int thread_count, long iterations)
+{
+    struct test_thread *threads;
+    struct rusage ru_start, ru_end;
+    double start_tm, end_tm, alloc_seconds = 0;
+    long errors = 0;
+    int i;
+
+    threads = calloc(thread_count, sizeof(*threads));
+    if(!threads)
+    {
+        perror("calloc");
+        return(1);
+    }
+
+    getrusage(RUSAGE_SELF, &ru_start);
+    start_tm = Wtime();
+    for(i = 0; i < thread_count; i++)
+    {
+        threads[i].index = i;
+        threads[i].use_pool = use_pool;
+        threads[i].iterations = iterations;
+        pthread_create(&threads[i].thread, NULL, test_thread_fn,
+                       &threads[i]);
+    }
+    for(i = 0; i < thread_count; i++)
+    {
+        pthread_join(threads[i].thread, NULL);
+        alloc_seconds += threads[i].alloc_seconds;
+        errors += threads[i].errors;
+    }
+    end_tm = Wtime();
+    getrusage(RUSAGE_SELF, &ru_end);
+
+    printf("%-14s %8.3f s  %8.3f s sys  %9ld faults  %7.0f ns/alloc+free  "
+           "%ld errors\n",
+           use_pool ? "pool" : "posix_memalign",
+           end_tm - start_tm,
+           tv_seconds(&ru_end.ru_stime) - tv_seconds(&ru_start.ru_stime),
+           ru_end.ru_minflt - ru_start.ru_minflt,
+           alloc_seconds * 1e9 / ((double)thread_count * iterations),
+           errors);
+
+    free(threads);
+    return(errors);
+}
+
+int main(int argc, char *argv[])
+{
+    struct PINT_mem_pool_stats stats;
+    int thread_count = 4;
+    long iterations = 20000;
+    long errors = 0;
+
+    if((argc > 1 && (sscanf(argv[1], "%d", &thread_count) != 1 ||
+                     thread_count < 1)) ||
+       (argc > 2 && (sscanf(argv[2], "%ld", &iterations) != 1 ||
+                     iterations < DEPTH)))
+    {
+        fprintf(stderr, "Usage: test-mem-pool [threads] [iterations]\n");
+        return(-1);
+    }
+
+    printf("# %d threads, %ld allocations each, %d held per thread\n",
+           thread_count, iterations, DEPTH);
+    errors += run(0, thread_count, iterations);
+    PINT_mem_pool_enable();
+    errors += run(1, thread_count, iterations);
+
+    PINT_mem_pool_get_stats(&stats);
+    printf("# pool: %llu hits, %llu carves, %llu fallbacks, %llu frees, "
+           "%llu regions (%llu released), %llu bytes mapped\n",
+           llu(stats.hits), llu(stats.carves), llu(stats.fallbacks),
+           llu(stats.frees), llu(stats.regions),
+           llu(stats.regions_released), llu(stats.bytes_mapped));
+
+    /* every pooled buffer was freed, and nothing else used the pool */
+    if(stats.hits + stats.carves + stats.fallbacks !=
+       (uint64_t)thread_count * iterations ||
+       stats.frees != stats.hits + stats.carves)
+    {
+        fprintf(stderr, "Error: pool counters do not add up\n");
+        errors++;
+    }
+
+    return(errors ? 1 : 0);
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
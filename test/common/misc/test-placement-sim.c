@@ -0,0 +1,244 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* test-placement-sim: simulates filling a file system whose I/O servers
+ * differ: two have half the capacity of the rest, one starts out mostly
+ * full and one is busy with I/O from elsewhere.  Files of mixed sizes
+ * are striped over a few servers each, placed first round robin the way
+ * the default layout does, then with the load-aware policy working from
+ * statistics refreshed every so many files, as a metadata server sees
+ * them.  Reports how full each server ends up, how much data did not
+ * fit, and how much of the new data went to the busy server.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pvfs2.h"
+#include "pvfs2-internal.h"
+#include "pint-cached-config.h"
+
+#define SERVERS 8
+#define STRIPE 4
+#define MB (1024 * 1024LL)
+#define GB (1024 * MB)
+
+/* files are created one a second */
+#define CREATE_MS 1000
+
+/* server 3 starts 85% full, server 5 serves heavy I/O for other files */
+#define FULL_SERVER 3
+#define BUSY_SERVER 5
+
+struct sim_server
+{
+    PVFS_size capacity;
+    PVFS_size used;
+    PVFS_size placed;           /* new data this run put here */
+    PVFS_size window_bytes;     /* new data since the last refresh */
+    double base_rate;           /* bytes/s of I/O not from this run */
+};
+
+struct sim_result
+{
+    double fill[SERVERS];
+    PVFS_size lost;             /* bytes that found their server full */
+    int lost_files;
+    double busy_share;
+};
+
+static void sim_reset(struct sim_server *servers)
+{
+    int i;
+
+    memset(servers, 0, SERVERS * sizeof(*servers));
+    for(i = 0; i < SERVERS; i++)
+    {
+        servers[i].capacity = (i == 6 || i == 7) ? 500 * GB : 1000 * GB;
+        servers[i].base_rate = 50.0 * MB;
+    }
+    servers[FULL_SERVER].used = servers[FULL_SERVER].capacity * 85 / 100;
+    servers[BUSY_SERVER].base_rate = 400.0 * MB;
+}
+
+/* mostly small files, a good share of medium ones, a few large */
+static PVFS_size pick_file_size(unsigned int *seed)
+{
+    int r = rand_r(seed) % 100;
+
+    if(r < 60)
+    {
+        return (1 + rand_r(seed) % 64) * MB;
+    }
+    if(r < 95)
+    {
+        return (256 + rand_r(seed) % 768) * MB;
+    }
+    return (8 + rand_r(seed) % 24) * GB;
+}
+
+/* what a metadata server would have cached at the last refresh */
+static void sim_refresh(struct sim_server *servers,
+                        struct PINT_server_load_stats *stats,
+                        uint64_t now_ms, uint64_t window_ms)
+{
+    int i;
+
+    for(i = 0; i < SERVERS; i++)
+    {
+        stats[i].bytes_total = servers[i].capacity;
+        stats[i].bytes_available = servers[i].capacity - servers[i].used;
+        stats[i].load_1 = 0;
+        stats[i].space_time_ms = now_ms;
+
+        stats[i].io_rate = servers[i].base_rate +
+            (double)servers[i].window_bytes * 1000.0 / (double)window_ms;
+        stats[i].io_bytes += (int64_t)(stats[i].io_rate * window_ms / 1000);
+        stats[i].active_requests = (int64_t)(stats[i].io_rate / (10 * MB));
+        stats[i].perf_time_ms = now_ms;
+        servers[i].window_bytes = 0;
+    }
+}
+
+static void sim_run(int load_aware, int files, int refresh_every,
+                    struct sim_result *result)
+{
+    struct sim_server servers[SERVERS];
+    struct PINT_server_load_stats stats[SERVERS];
+    unsigned int seed = 7;
+    uint64_t now_ms = 1000;
+    PVFS_size size, dfile_size, placed = 0;
+    int picks[STRIPE];
+    int f, d, i, lost, ret;
+
+    sim_reset(servers);
+    memset(stats, 0, sizeof(stats));
+    memset(result, 0, sizeof(*result));
+    srand(11);
+
+    for(f = 0; f < files; f++)
+    {
+        now_ms += CREATE_MS;
+        if(f % refresh_every == 0)
+        {
+            sim_refresh(servers, stats, now_ms, CREATE_MS * refresh_every);
+        }
+
+        ret = -PVFS_EAGAIN;
+        if(load_aware)
+        {
+            ret = PINT_cached_config_pick_load_aware(SERVERS, stats, now_ms,
+                3 * CREATE_MS * refresh_every, STRIPE, picks);
+        }
+        if(ret < 0)
+        {
+            /* round robin from a random start, as the default layout */
+            i = rand() % SERVERS;
+            for(d = 0; d < STRIPE; d++)
+            {
+                picks[d] = (i + d) % SERVERS;
+            }
+        }
+
+        size = pick_file_size(&seed);
+        dfile_size = size / STRIPE;
+        lost = 0;
+        for(d = 0; d < STRIPE; d++)
+        {
+            i = picks[d];
+            if(servers[i].used + dfile_size > servers[i].capacity)
+            {
+                result->lost += dfile_size;
+                lost = 1;
+                continue;
+            }
+            servers[i].used += dfile_size;
+            servers[i].placed += dfile_size;
+            servers[i].window_bytes += dfile_size;
+            placed += dfile_size;
+        }
+        result->lost_files += lost;
+    }
+
+    for(i = 0; i < SERVERS; i++)
+    {
+        result->fill[i] = 100.0 * servers[i].used / servers[i].capacity;
+    }
+    result->busy_share = placed ?
+        (double)servers[BUSY_SERVER].placed / placed : 0;
+}
+
+static void sim_report(const char *name, struct sim_result *result)
+{
+    double min = 100, max = 0;
+    int i;
+
+    printf("%-10s fill %%:", name);
+    for(i = 0; i < SERVERS; i++)
+    {
+        printf(" %5.1f", result->fill[i]);
+        min = result->fill[i] < min ? result->fill[i] : min;
+        max = result->fill[i] > max ? result->fill[i] : max;
+    }
+    printf("\n%-10s spread %.1f%%, %lld GB in %d files did not fit, "
+           "busy server got %.1f%% of new data\n", "",
+           max - min, lld(result->lost / GB),
+           result->lost_files, 100.0 * result->busy_share);
+}
+
+int main(int argc, char *argv[])
+{
+    struct sim_result rr, la;
+    int files = 3500;
+    int refresh_every = 10;
+    int errors = 0;
+
+    if((argc > 1 && (sscanf(argv[1], "%d", &files) != 1 || files < 1)) ||
+       (argc > 2 && (sscanf(argv[2], "%d", &refresh_every) != 1 ||
+                     refresh_every < 1)))
+    {
+        fprintf(stderr, "Usage: test-placement-sim [files] "
+                "[files per refresh]\n");
+        return(-1);
+    }
+
+    printf("# %d servers, %d datafiles per file, %d files, statistics "
+           "refreshed every %d files\n", SERVERS, STRIPE, files,
+           refresh_every);
+    printf("# servers 6 and 7 are half size, %d starts 85%% full, "
+           "%d is busy\n", FULL_SERVER, BUSY_SERVER);
+
+    sim_run(0, files, refresh_every, &rr);
+    sim_run(1, files, refresh_every, &la);
+    sim_report("roundrobin", &rr);
+    sim_report("loadaware", &la);
+
+    /* the policy must not run servers out of space that round robin
+     * leaves room on, and must keep new data off the busy server
+     */
+    if(la.lost > rr.lost)
+    {
+        fprintf(stderr, "Error: load-aware placement lost more data\n");
+        errors++;
+    }
+    if(la.busy_share >= 1.0 / SERVERS)
+    {
+        fprintf(stderr, "Error: busy server got at least its even share\n");
+        errors++;
+    }
+
+    return(errors ? 1 : 0);
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
@@ -0,0 +1,318 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* test-slab: runs the allocations of a metadata request the way the
+ * server makes them (an smcb with a server op as its base frame, a
+ * nested frame with a msgpair array, two job descriptors and a few
+ * temporary buffers) from several threads.  It does so first with the
+ * slab caches off, which sends everything to malloc and frees the
+ * temporary buffers one by one as state actions used to, then with the
+ * caches on and the temporary buffers taken from the smcb arena.
+ * Reports allocator calls and time per request for both, and checks
+ * that nothing is handed out twice, that arena buffers are zeroed and
+ * aligned, and that the slab counters add up.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "pvfs2.h"
+#include "pvfs2-internal.h"
+#include "pvfs2-server.h"
+#include "job-desc-queue.h"
+#include "id-generator.h"
+#include "pint-slab.h"
+
+/* requests each thread has in progress at once */
+#define DEPTH 8
+#define TEMP_BUFFERS 3
+
+static size_t temp_sizes[TEMP_BUFFERS] = {96, 512, 2000};
+
+struct test_request
+{
+    struct PINT_smcb *smcb;
+    struct PINT_server_op *nested;
+    struct job_desc *jd[2];
+    char *temp[TEMP_BUFFERS];
+    uint64_t tag;
+};
+
+struct test_thread
+{
+    pthread_t thread;
+    int index;
+    int use_slab;
+    long requests;
+    long errors;
+};
+
+static double Wtime(void)
+{
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    return((double)t.tv_sec + (double)(t.tv_usec) / 1000000);
+}
+
+static uint64_t allocator_calls(void)
+{
+    struct PINT_slab_stats stats;
+
+    PINT_slab_get_stats(&stats);
+    return(stats.fallbacks + stats.fallback_frees + stats.regions);
+}
+
+static int start_request(struct test_request *r, int use_slab, uint64_t tag)
+{
+    struct PINT_server_op *s_op;
+    int i;
+
+    if(PINT_smcb_alloc(&r->smcb, PVFS_SERV_LISTEATTR,
+                       sizeof(struct PINT_server_op), NULL, NULL, 0) < 0)
+    {
+        return(-1);
+    }
+    s_op = PINT_sm_frame(r->smcb, PINT_FRAME_CURRENT);
+    s_op->target_handle = tag;
+
+    r->nested = PINT_sm_frame_alloc(sizeof(struct PINT_server_op));
+    if(!r->nested)
+    {
+        return(-1);
+    }
+    r->nested->target_handle = tag;
+    PINT_sm_push_frame(r->smcb, 0, r->nested);
+    if(PINT_msgpairarray_init(&r->nested->msgarray_op, 2) < 0)
+    {
+        return(-1);
+    }
+    r->nested->msgarray_op.msgarray[1].fs_id = (PVFS_fs_id)tag;
+
+    r->jd[0] = alloc_job_desc(JOB_TROVE);
+    r->jd[1] = alloc_job_desc(JOB_BMI);
+    if(!r->jd[0] || !r->jd[1])
+    {
+        return(-1);
+    }
+    r->jd[0]->job_user_ptr = (void *)(uintptr_t)tag;
+    r->jd[1]->job_user_ptr = (void *)(uintptr_t)tag;
+
+    for(i = 0; i < TEMP_BUFFERS; i++)
+    {
+        if(use_slab)
+        {
+            r->temp[i] = PINT_smcb_arena_alloc(r->smcb, temp_sizes[i]);
+        }
+        else
+        {
+            r->temp[i] = PINT_slab_zalloc(temp_sizes[i]);
+        }
+        if(!r->temp[i] || ((uintptr_t)r->temp[i] % 16) != 0 ||
+           r->temp[i][0] != 0 || r->temp[i][temp_sizes[i] - 1] != 0)
+        {
+            return(-1);
+        }
+        memcpy(r->temp[i], &tag, sizeof(tag));
+        memcpy(r->temp[i] + temp_sizes[i] - sizeof(tag), &tag, sizeof(tag));
+    }
+    r->tag = tag;
+    return(0);
+}
+
+/* checks that nothing the request holds was handed to another one */
+static int finish_request(struct test_request *r, int use_slab)
+{
+    struct PINT_server_op *s_op, *nested;
+    int task_id, error_code, remaining;
+    int i, errors = 0;
+
+    s_op = PINT_sm_frame(r->smcb, PINT_FRAME_CURRENT);
+    nested = PINT_sm_pop_frame(r->smcb, &task_id, &error_code, &remaining);
+    if(!s_op || s_op->target_handle != r->tag || nested != r->nested ||
+       nested->target_handle != r->tag || remaining != 1 ||
+       nested->msgarray_op.msgarray[1].fs_id != (PVFS_fs_id)r->tag ||
+       r->jd[0]->job_user_ptr != (void *)(uintptr_t)r->tag ||
+       r->jd[1]->job_user_ptr != (void *)(uintptr_t)r->tag)
+    {
+        errors++;
+    }
+    for(i = 0; i < TEMP_BUFFERS; i++)
+    {
+        if(memcmp(r->temp[i], &r->tag, sizeof(r->tag)) ||
+           memcmp(r->temp[i] + temp_sizes[i] - sizeof(r->tag), &r->tag,
+                  sizeof(r->tag)))
+        {
+            errors++;
+        }
+        if(!use_slab)
+        {
+            PINT_slab_free(r->temp[i]);
+        }
+    }
+
+    dealloc_job_desc(r->jd[0]);
+    dealloc_job_desc(r->jd[1]);
+    PINT_msgpairarray_destroy(&nested->msgarray_op);
+    PINT_sm_frame_free(nested);
+    PINT_smcb_free(r->smcb);
+    memset(r, 0, sizeof(*r));
+    return(errors);
+}
+
+static void *test_thread_fn(void *arg)
+{
+    struct test_thread *tt = (struct test_thread *)arg;
+    struct test_request reqs[DEPTH];
+    long i;
+    int slot;
+
+    memset(reqs, 0, sizeof(reqs));
+    for(i = 0; i < tt->requests; i++)
+    {
+        slot = i % DEPTH;
+        if(reqs[slot].smcb)
+        {
+            tt->errors += finish_request(&reqs[slot], tt->use_slab);
+        }
+        if(start_request(&reqs[slot], tt->use_slab,
+                         ((uint64_t)tt->index << 48) | (uint64_t)(i + 1)))
+        {
+            tt->errors++;
+            break;
+        }
+    }
+    for(slot = 0; slot < DEPTH; slot++)
+    {
+        if(reqs[slot].smcb)
+        {
+            tt->errors += finish_request(&reqs[slot], tt->use_slab);
+        }
+    }
+    return(NULL);
+}
+
+static long run(int use_slab, int thread_count, long requests,
+                double *calls_per_request)
+{
+    struct test_thread *threads;
+    double start_tm, end_tm;
+    uint64_t calls;
+    long errors = 0;
+    int i;
+
+    threads = calloc(thread_count, sizeof(*threads));
+    if(!threads)
+    {
+        perror("calloc");
+        return(1);
+    }
+
+    PINT_slab_enable(use_slab);
+    calls = allocator_calls();
+    start_tm = Wtime();
+    for(i = 0; i < thread_count; i++)
+    {
+        threads[i].index = i;
+        threads[i].use_slab = use_slab;
+        threads[i].requests = requests;
+        pthread_create(&threads[i].thread, NULL, test_thread_fn,
+                       &threads[i]);
+    }
+    for(i = 0; i < thread_count; i++)
+    {
+        pthread_join(threads[i].thread, NULL);
+        errors += threads[i].errors;
+    }
+    end_tm = Wtime();
+    calls = allocator_calls() - calls;
+    *calls_per_request = (double)calls / ((double)thread_count * requests);
+
+    printf("%-8s %8.3f s  %7.0f ns/request  %6.2f allocator calls/request  "
+           "%ld errors\n",
+           use_slab ? "slab" : "malloc",
+           end_tm - start_tm,
+           (end_tm - start_tm) * 1e9 / ((double)thread_count * requests),
+           *calls_per_request, errors);
+
+    free(threads);
+    return(errors);
+}
+
+int main(int argc, char *argv[])
+{
+    struct PINT_slab_stats stats;
+    double before, after;
+    int thread_count = 4;
+    long requests = 20000;
+    long errors = 0;
+    void *big, *plain;
+
+    if((argc > 1 && (sscanf(argv[1], "%d", &thread_count) != 1 ||
+                     thread_count < 1)) ||
+       (argc > 2 && (sscanf(argv[2], "%ld", &requests) != 1 ||
+                     requests < DEPTH)))
+    {
+        fprintf(stderr, "Usage: test-slab [threads] [requests]\n");
+        return(-1);
+    }
+
+    if(id_gen_safe_initialize() < 0)
+    {
+        fprintf(stderr, "Error: id_gen_safe_initialize failed\n");
+        return(-1);
+    }
+
+    printf("# %d threads, %ld requests each, %d in progress per thread\n",
+           thread_count, requests, DEPTH);
+    errors += run(0, thread_count, requests, &before);
+    errors += run(1, thread_count, requests, &after);
+
+    /* requests too large for a class, and memory from malloc, both go
+     * back through PINT_slab_free */
+    big = PINT_slab_alloc(PINT_SLAB_MAX_SIZE + 1);
+    plain = malloc(100);
+    PINT_slab_free(big);
+    PINT_slab_free(plain);
+
+    PINT_slab_get_stats(&stats);
+    printf("# slab: %llu allocs, %llu frees, %llu refills, %llu drains, "
+           "%llu blocks, %llu regions, %llu bytes mapped\n",
+           llu(stats.allocs), llu(stats.frees), llu(stats.refills),
+           llu(stats.drains), llu(stats.blocks), llu(stats.regions),
+           llu(stats.bytes_mapped));
+    printf("# malloc: %llu allocations, %llu frees\n",
+           llu(stats.fallbacks), llu(stats.fallback_frees));
+
+    /* every object was freed, and the one malloc pointer went to free */
+    if(stats.allocs != stats.frees ||
+       stats.fallbacks + 1 != stats.fallback_frees)
+    {
+        fprintf(stderr, "Error: slab counters do not add up\n");
+        errors++;
+    }
+    if(after * 10 > before)
+    {
+        fprintf(stderr, "Error: slab caches saved too few allocator "
+                "calls\n");
+        errors++;
+    }
+
+    id_gen_safe_finalize();
+    return(errors ? 1 : 0);
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
@@ -28,7 +28,7 @@ int bench_args(
 #ifdef WIN32
     int argi = 1;
 #else
-    char flags[] = "L:pm:t:l:s:r";
+    char flags[] = "L:pm:t:l:s:ro:";
     int one_opt = ' ';
 #endif
     int got_method = 0;
@@ -40,6 +40,7 @@ int bench_args(
     user_opts->total_len = user_opts->message_len * 8;
     user_opts->flags = 0;
     user_opts->method_name[0] = '\0';
+    user_opts->bmi_opts[0] = '\0';
     user_opts->num_servers = 1;
     user_opts->list_io_factor = 1;
 
@@ -77,6 +78,10 @@ int bench_args(
         {
             user_opts->flags |= REUSE_BUFFERS;
         }
+        else if (strcmp(argv[argi], "-o") == 0)
+        {
+            ret = sscanf(argv[++argi], "%255s", user_opts->bmi_opts);
+        }
 
         if (ret < 1)
         {
@@ -134,6 +139,13 @@ int bench_args(
 	case ('r'):
 	    user_opts->flags |= REUSE_BUFFERS;
 	    break;
+	case ('o'):
+	    ret = sscanf(optarg, "%255s", user_opts->bmi_opts);
+	    if (ret < 1)
+	    {
+		return -1;
+	    }
+	    break;
 	default:
 	    break;
 	}
@@ -164,6 +176,7 @@ void bench_args_dump(
     printf("total length: %d\n", opts->total_len);
     printf("number of servers: %d\n", opts->num_servers);
     printf("method name: %s\n", opts->method_name);
+    printf("BMI options: %s\n", opts->bmi_opts);
     printf("count of each list io message: %d\n", opts->list_io_factor);
 
     return;
@@ -24,6 +24,7 @@ struct bench_options
     int total_len;
     int num_servers;
     char method_name[256];
+    char bmi_opts[256];
 };
 
 enum
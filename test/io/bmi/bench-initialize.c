@@ -78,6 +78,7 @@ int bench_init(
 	    (*mpi_peer_array)[i] = i + opts->num_servers;
 	}
 	ret = bench_initialize_bmi_interface(opts->method_name,
+					     opts->bmi_opts,
 					     BMI_INIT_SERVER, context);
     }
     else
@@ -94,7 +95,8 @@ int bench_init(
 	{
 	    (*mpi_peer_array)[i] = i;
 	}
-	ret = bench_initialize_bmi_interface(opts->method_name, 0, context);
+	ret = bench_initialize_bmi_interface(opts->method_name,
+					     opts->bmi_opts, 0, context);
     }
     if (ret < 0)
     {
@@ -118,6 +120,7 @@ int bench_init(
 						    *num_clients,
 						    *bmi_peer_array,
 						    opts->method_name,
+						    opts->bmi_opts,
 						    *context);
     }
     if (ret < 0)
@@ -131,6 +134,7 @@ int bench_init(
 
 int bench_initialize_bmi_interface(
     char *method,
+    char *bmi_opts,
     int flags,
     bmi_context_id * context)
 {
@@ -175,7 +179,7 @@ int bench_initialize_bmi_interface(
 
     if (flags & BMI_INIT_SERVER)
     {
-	ret = BMI_initialize(method, local_address, flags, NULL);
+	ret = BMI_initialize(method, local_address, flags, bmi_opts);
     }
     else
     {
@@ -303,6 +307,7 @@ int bench_initialize_bmi_addresses_client(
     int num_clients,
     PVFS_BMI_addr_t * server_array,
     char *method_name,
+    char *bmi_opts,
     bmi_context_id context)
 {
     int i = 0;
@@ -345,7 +350,7 @@ int bench_initialize_bmi_addresses_client(
 	{
 	    return (-1);
 	}
-	ret = BMI_addr_lookup(&server_array[i], bmi_server_name, NULL);
+	ret = BMI_addr_lookup(&server_array[i], bmi_server_name, bmi_opts);
 	if (ret < 0)
 	{
 	    return (-1);
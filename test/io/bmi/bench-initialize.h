@@ -25,6 +25,7 @@
 
 int bench_initialize_bmi_interface(
     char *method,
+    char *bmi_opts,
     int flags,
     bmi_context_id * context);
 int bench_initialize_mpi_params(
@@ -45,6 +46,7 @@ int bench_initialize_bmi_addresses_client(
     int num_clients,
     PVFS_BMI_addr_t * client_array,
     char *method_name,
+    char *bmi_opts,
     bmi_context_id context);
 int bench_init(
     struct bench_options *opts,
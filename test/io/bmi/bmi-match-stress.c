@@ -0,0 +1,527 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* Measures how BMI matches messages to operations when many operations
+ * are outstanding on one address.
+ *
+ * expected: the server posts <count> receives with distinct tags, then
+ *           the client sends them in the opposite order, so every
+ *           incoming message has to be matched against the posted
+ *           receives.
+ * buffered: the client sends <count> eager messages that the server has
+ *           not asked for yet, then the server posts the receives for
+ *           them in the opposite order, so every receive has to be
+ *           matched against the buffered messages.
+ * cancel:   the server posts <count> receives that will never be
+ *           satisfied and cancels them all.
+ *
+ * Each message carries its own tag, which the server checks.  The server
+ * prints the matches per second of each phase.  The messages are small,
+ * so run with BMI options such as tcp_coalesce to see how many of them
+ * one connection moves.
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+
+#include "pvfs2.h"
+#include "bmi.h"
+#include "gossip.h"
+#include "test-bmi.h"
+#include <src/common/misc/pvfs2-internal.h>
+
+#define DEFAULT_COUNT 10000
+#define TEST_BATCH 64
+#define CTRL_TAG 0x7ffffff0
+
+struct options
+{
+    char *hostid;
+    char *method;
+    char *bmi_opts;
+    int server;
+    int count;
+};
+
+/* the unexpected message that starts the test and the marker that
+ * follows the buffered messages
+ */
+struct ctrl_msg
+{
+    int32_t count;
+};
+
+static double wtime(void)
+{
+    struct timeval t;
+
+    gettimeofday(&t, NULL);
+    return((double)t.tv_sec + (double)t.tv_usec / 1000000);
+}
+
+static void print_usage(void)
+{
+    fprintf(stderr, "usage: bmi-match-stress -h HOST_URI -s|-c "
+            "[-o OPTIONS] [-n count]\n");
+    fprintf(stderr, "       HOST_URI is tcp://host:port\n");
+    fprintf(stderr, "       -s is server and -c is client\n");
+    fprintf(stderr, "       -o passes OPTIONS to BMI on both sides\n");
+    fprintf(stderr, "       -n is the number of outstanding operations "
+            "(default %d)\n", DEFAULT_COUNT);
+}
+
+static int parse_args(int argc, char *argv[], struct options *opts)
+{
+    int c;
+
+    memset(opts, 0, sizeof(*opts));
+    opts->server = -1;
+    opts->count = DEFAULT_COUNT;
+    while ((c = getopt(argc, argv, "h:sco:n:")) != -1)
+    {
+        switch (c)
+        {
+        case 'h':
+            opts->hostid = optarg;
+            break;
+        case 's':
+            opts->server = 1;
+            break;
+        case 'c':
+            opts->server = 0;
+            break;
+        case 'o':
+            opts->bmi_opts = optarg;
+            break;
+        case 'n':
+            opts->count = atoi(optarg);
+            break;
+        default:
+            return -1;
+        }
+    }
+    if (!opts->hostid || opts->server < 0 || opts->count <= 0 ||
+        opts->count >= CTRL_TAG / 3)
+    {
+        return -1;
+    }
+    if (strncmp(opts->hostid, "tcp://", 6) != 0)
+    {
+        fprintf(stderr, "only tcp:// addresses are supported\n");
+        return -1;
+    }
+    opts->method = "bmi_tcp";
+    return 0;
+}
+
+/* waits for n operations to complete, every one with want_error.
+ * Receives posted by post_recv() carry their slot of buffer as the user
+ * pointer, and the message that landed there is checked against the tag.
+ */
+static int wait_ops(bmi_context_id context,
+                    int n,
+                    int32_t *buffer,
+                    int want_error)
+{
+    bmi_op_id_t ids[TEST_BATCH];
+    bmi_error_code_t errs[TEST_BATCH];
+    bmi_size_t sizes[TEST_BATCH];
+    void *user_ptrs[TEST_BATCH];
+    int32_t *slot;
+    int outcount, ret, i;
+
+    while (n > 0)
+    {
+        ret = BMI_testcontext(TEST_BATCH, ids, &outcount, errs, sizes,
+                              user_ptrs, 10, context);
+        if (ret < 0)
+        {
+            fprintf(stderr, "BMI_testcontext: %d\n", ret);
+            return ret;
+        }
+        for (i = 0; i < outcount; i++)
+        {
+            if (errs[i] != want_error)
+            {
+                fprintf(stderr, "operation finished with %d, not %d\n",
+                        errs[i], want_error);
+                return -1;
+            }
+            slot = user_ptrs[i];
+            if (slot && (sizes[i] != sizeof(int32_t) ||
+                         *slot != slot - buffer))
+            {
+                fprintf(stderr, "receive for tag %d got the wrong "
+                        "message\n", (int)(slot - buffer));
+                return -1;
+            }
+        }
+        n -= outcount;
+    }
+    return 0;
+}
+
+static int post_recv(bmi_context_id context,
+                     PVFS_BMI_addr_t addr,
+                     int32_t *buffer,
+                     int tag,
+                     int *pending)
+{
+    bmi_op_id_t id;
+    bmi_size_t actual;
+    int ret;
+
+    buffer[tag] = -1;
+    ret = BMI_post_recv(&id, addr, &buffer[tag], sizeof(int32_t), &actual,
+                        BMI_PRE_ALLOC, tag, &buffer[tag], context,
+                        NULL);
+    if (ret < 0)
+    {
+        fprintf(stderr, "BMI_post_recv: %d\n", ret);
+        return ret;
+    }
+    if (ret == 0)
+    {
+        (*pending)++;
+    }
+    else if (buffer[tag] != tag)
+    {
+        fprintf(stderr, "receive for tag %d got the wrong message\n", tag);
+        return -1;
+    }
+    return 0;
+}
+
+static int post_send(bmi_context_id context,
+                     PVFS_BMI_addr_t addr,
+                     int32_t *buffer,
+                     int tag,
+                     int *pending)
+{
+    bmi_op_id_t id;
+    int ret;
+
+    buffer[tag] = tag;
+    ret = BMI_post_send(&id, addr, &buffer[tag], sizeof(int32_t),
+                        BMI_PRE_ALLOC, tag, NULL, context, NULL);
+    if (ret < 0)
+    {
+        fprintf(stderr, "BMI_post_send: %d\n", ret);
+        return ret;
+    }
+    if (ret == 0)
+    {
+        (*pending)++;
+    }
+    return 0;
+}
+
+static int wait_unexpected(struct BMI_unexpected_info *info)
+{
+    int outcount = 0, ret;
+
+    do
+    {
+        ret = BMI_testunexpected(1, &outcount, info, 10);
+    } while (ret == 0 && outcount == 0);
+    if (ret < 0 || info->error_code != 0 ||
+        info->size != sizeof(struct ctrl_msg))
+    {
+        fprintf(stderr, "unexpected receive failed\n");
+        return -1;
+    }
+    return 0;
+}
+
+static void report(const char *phase, int count, double elapsed)
+{
+    printf("  %-10s %10d %10.4f %12.0f\n", phase, count, elapsed,
+           count / elapsed);
+}
+
+static int do_server(struct options *opts, bmi_context_id context)
+{
+    struct BMI_unexpected_info info;
+    PVFS_BMI_addr_t peer;
+    int32_t *buffer;
+    struct ctrl_msg *ctrl;
+    bmi_op_id_t *ids;
+    bmi_size_t actual;
+    int count, pending, i, ret = -1;
+    double t0;
+
+    if (wait_unexpected(&info) < 0)
+    {
+        return -1;
+    }
+    peer = info.addr;
+    count = ntohl(((struct ctrl_msg *)info.buffer)->count);
+    BMI_unexpected_free(peer, info.buffer);
+
+    /* tags [0, count) are for the expected phase, [count, 2 * count)
+     * for the buffered one and [2 * count, 3 * count) for cancel
+     */
+    buffer = BMI_memalloc(peer, 3 * count * sizeof(int32_t), BMI_RECV);
+    ctrl = BMI_memalloc(peer, sizeof(*ctrl), BMI_SEND);
+    ids = malloc(count * sizeof(*ids));
+    if (!buffer || !ctrl || !ids)
+    {
+        fprintf(stderr, "out of memory\n");
+        goto out;
+    }
+
+    printf("# %d outstanding operations\n", count);
+    printf("# %-10s %10s %10s %12s\n", "phase", "matches", "seconds",
+           "matches/s");
+
+    pending = 0;
+    for (i = 0; i < count; i++)
+    {
+        if (post_recv(context, peer, buffer, i, &pending) < 0)
+        {
+            goto out;
+        }
+    }
+    ctrl->count = htonl(count);
+    t0 = wtime();
+    pending++;
+    ret = BMI_post_send(&ids[0], peer, ctrl, sizeof(*ctrl), BMI_PRE_ALLOC,
+                        CTRL_TAG, NULL, context, NULL);
+    if (ret < 0)
+    {
+        fprintf(stderr, "BMI_post_send: %d\n", ret);
+        goto out;
+    }
+    pending -= ret;
+    ret = wait_ops(context, pending, buffer, 0);
+    if (ret < 0)
+    {
+        goto out;
+    }
+    report("expected", count, wtime() - t0);
+
+    /* the marker is behind the buffered messages on the same socket */
+    ret = wait_unexpected(&info);
+    if (ret < 0)
+    {
+        goto out;
+    }
+    BMI_unexpected_free(peer, info.buffer);
+    pending = 0;
+    t0 = wtime();
+    for (i = 2 * count - 1; i >= count; i--)
+    {
+        ret = post_recv(context, peer, buffer, i, &pending);
+        if (ret < 0)
+        {
+            goto out;
+        }
+    }
+    ret = wait_ops(context, pending, buffer, 0);
+    if (ret < 0)
+    {
+        goto out;
+    }
+    report("buffered", count, wtime() - t0);
+
+    t0 = wtime();
+    for (i = 0; i < count; i++)
+    {
+        ret = BMI_post_recv(&ids[i], peer, &buffer[2 * count + i],
+                            sizeof(int32_t), &actual, BMI_PRE_ALLOC,
+                            2 * count + i, NULL, context, NULL);
+        if (ret != 0)
+        {
+            fprintf(stderr, "BMI_post_recv: %d\n", ret);
+            ret = -1;
+            goto out;
+        }
+    }
+    for (i = count - 1; i >= 0; i--)
+    {
+        BMI_cancel(ids[i], context);
+    }
+    ret = wait_ops(context, count, NULL, -BMI_ECANCEL);
+    if (ret < 0)
+    {
+        goto out;
+    }
+    report("cancel", count, wtime() - t0);
+
+    /* let the client go */
+    pending = 0;
+    ret = post_send(context, peer, buffer, 0, &pending);
+    if (ret == 0)
+    {
+        ret = wait_ops(context, pending, NULL, 0);
+    }
+
+out:
+    if (buffer)
+    {
+        BMI_memfree(peer, buffer, 3 * count * sizeof(int32_t), BMI_RECV);
+    }
+    if (ctrl)
+    {
+        BMI_memfree(peer, ctrl, sizeof(*ctrl), BMI_SEND);
+    }
+    free(ids);
+    return ret;
+}
+
+static int do_client(struct options *opts, bmi_context_id context)
+{
+    PVFS_BMI_addr_t peer;
+    int32_t *buffer;
+    struct ctrl_msg *ctrl;
+    bmi_op_id_t id;
+    bmi_size_t actual;
+    int count = opts->count, pending, i, ret;
+
+    ret = BMI_addr_lookup(&peer, opts->hostid, opts->bmi_opts);
+    if (ret < 0)
+    {
+        fprintf(stderr, "BMI_addr_lookup: %d\n", ret);
+        return ret;
+    }
+    buffer = BMI_memalloc(peer, 2 * count * sizeof(int32_t), BMI_SEND);
+    ctrl = BMI_memalloc(peer, sizeof(*ctrl), BMI_RECV);
+    if (!buffer || !ctrl)
+    {
+        fprintf(stderr, "out of memory\n");
+        return -1;
+    }
+
+    pending = 0;
+    ctrl->count = htonl(count);
+    ret = BMI_post_sendunexpected(&id, peer, ctrl, sizeof(*ctrl),
+                                  BMI_PRE_ALLOC, 0, NULL, context, NULL);
+    if (ret < 0)
+    {
+        fprintf(stderr, "BMI_post_sendunexpected: %d\n", ret);
+        goto out;
+    }
+    pending += !ret;
+    ret = BMI_post_recv(&id, peer, ctrl, sizeof(*ctrl), &actual,
+                        BMI_PRE_ALLOC, CTRL_TAG, NULL, context, NULL);
+    if (ret < 0)
+    {
+        fprintf(stderr, "BMI_post_recv: %d\n", ret);
+        goto out;
+    }
+    pending += !ret;
+    ret = wait_ops(context, pending, NULL, 0);
+    if (ret < 0)
+    {
+        goto out;
+    }
+
+    /* the server's receives are all posted; send in reverse */
+    pending = 0;
+    for (i = count - 1; i >= 0; i--)
+    {
+        ret = post_send(context, peer, buffer, i, &pending);
+        if (ret < 0)
+        {
+            goto out;
+        }
+    }
+    for (i = count; i < 2 * count; i++)
+    {
+        ret = post_send(context, peer, buffer, i, &pending);
+        if (ret < 0)
+        {
+            goto out;
+        }
+    }
+    ret = BMI_post_sendunexpected(&id, peer, ctrl, sizeof(*ctrl),
+                                  BMI_PRE_ALLOC, 0, NULL, context, NULL);
+    if (ret < 0)
+    {
+        fprintf(stderr, "BMI_post_sendunexpected: %d\n", ret);
+        goto out;
+    }
+    pending += !ret;
+
+    /* and wait for the server to be done with them */
+    ret = BMI_post_recv(&id, peer, ctrl, sizeof(*ctrl), &actual,
+                        BMI_PRE_ALLOC, 0, NULL, context, NULL);
+    if (ret < 0)
+    {
+        fprintf(stderr, "BMI_post_recv: %d\n", ret);
+        goto out;
+    }
+    pending += !ret;
+    ret = wait_ops(context, pending, NULL, 0);
+
+out:
+    BMI_memfree(peer, buffer, 2 * count * sizeof(int32_t), BMI_SEND);
+    BMI_memfree(peer, ctrl, sizeof(*ctrl), BMI_RECV);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    struct options opts;
+    bmi_context_id context;
+    int ret;
+
+    if (parse_args(argc, argv, &opts) < 0)
+    {
+        print_usage();
+        return -1;
+    }
+
+    if (opts.server)
+    {
+        ret = BMI_initialize(opts.method, opts.hostid, BMI_INIT_SERVER,
+                             opts.bmi_opts);
+    }
+    else
+    {
+        ret = BMI_initialize(NULL, NULL, 0, NULL);
+    }
+    if (ret < 0)
+    {
+        fprintf(stderr, "BMI_initialize: %d\n", ret);
+        return -1;
+    }
+    ret = BMI_open_context(&context);
+    if (ret < 0)
+    {
+        fprintf(stderr, "BMI_open_context: %d\n", ret);
+        BMI_finalize();
+        return -1;
+    }
+
+    if (opts.server)
+    {
+        ret = do_server(&opts, context);
+    }
+    else
+    {
+        ret = do_client(&opts, context);
+    }
+
+    BMI_close_context(context);
+    BMI_finalize();
+    return (ret < 0) ? -1 : 0;
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
@@ -0,0 +1,509 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* Checks large messages moved between a client and a server, meant to be
+ * run with BMI options that stripe them across several connections, such
+ * as "-o tcp_stripes=4,tcp_stripe_min=65536".
+ *
+ * posted:   the server posts its receives first, then the client sends.
+ * buffered: the client sends first and the server posts its receives a
+ *           little later, in the opposite order.
+ *
+ * The client sends each message from two buffers of uneven size and the
+ * server receives it into three, with room to spare.  Every byte is
+ * checked.  The server prints the rate of each phase.
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+
+#include "pvfs2.h"
+#include "bmi.h"
+#include "gossip.h"
+#include "test-bmi.h"
+#include <src/common/misc/pvfs2-internal.h>
+
+#define DEFAULT_COUNT 8
+#define DEFAULT_LENGTH (4 * 1024 * 1024)
+#define SPARE 4096
+/* the receive is posted with SPARE bytes over, within the 16M limit */
+#define MAX_LENGTH (16 * 1024 * 1024 - SPARE)
+#define START_TAG 1
+
+struct options
+{
+    char *hostid;
+    char *method;
+    char *bmi_opts;
+    int server;
+    int count;
+    int length;
+};
+
+/* BMI holds on to the buffer and size lists until the operation is
+ * done, so each message keeps its own
+ */
+struct msg_list
+{
+    void *buffers[3];
+    bmi_size_t sizes[3];
+    bmi_size_t actual;
+};
+
+struct ctrl_msg
+{
+    int32_t count;
+    int32_t length;
+};
+
+static double wtime(void)
+{
+    struct timeval t;
+
+    gettimeofday(&t, NULL);
+    return((double)t.tv_sec + (double)t.tv_usec / 1000000);
+}
+
+static void print_usage(void)
+{
+    fprintf(stderr, "usage: bmi-stripe-check -h HOST_URI -s|-c "
+            "[-o OPTIONS] [-n count] [-l length]\n");
+    fprintf(stderr, "       HOST_URI is tcp://host:port\n");
+    fprintf(stderr, "       -s is server and -c is client\n");
+    fprintf(stderr, "       -o passes OPTIONS to BMI on both sides\n");
+    fprintf(stderr, "       -n is the messages per phase (default %d)\n",
+            DEFAULT_COUNT);
+    fprintf(stderr, "       -l is the message length (default %d)\n",
+            DEFAULT_LENGTH);
+}
+
+static int parse_args(int argc, char *argv[], struct options *opts)
+{
+    int c;
+
+    memset(opts, 0, sizeof(*opts));
+    opts->server = -1;
+    opts->count = DEFAULT_COUNT;
+    opts->length = DEFAULT_LENGTH;
+    while ((c = getopt(argc, argv, "h:sco:n:l:")) != -1)
+    {
+        switch (c)
+        {
+        case 'h':
+            opts->hostid = optarg;
+            break;
+        case 's':
+            opts->server = 1;
+            break;
+        case 'c':
+            opts->server = 0;
+            break;
+        case 'o':
+            opts->bmi_opts = optarg;
+            break;
+        case 'n':
+            opts->count = atoi(optarg);
+            break;
+        case 'l':
+            opts->length = atoi(optarg);
+            break;
+        default:
+            return -1;
+        }
+    }
+    if (!opts->hostid || opts->server < 0 || opts->count <= 0 ||
+        opts->length < 16)
+    {
+        return -1;
+    }
+    if (opts->length > MAX_LENGTH)
+    {
+        fprintf(stderr, "the length can be at most %d\n", MAX_LENGTH);
+        return -1;
+    }
+    if (strncmp(opts->hostid, "tcp://", 6) != 0)
+    {
+        fprintf(stderr, "only tcp:// addresses are supported\n");
+        return -1;
+    }
+    opts->method = "bmi_tcp";
+    return 0;
+}
+
+static unsigned char pattern(int msg, int64_t offset)
+{
+    return (unsigned char)(msg * 131 + offset * 7 + (offset >> 12));
+}
+
+static int wait_ops(bmi_context_id context, int n, int length)
+{
+    bmi_op_id_t id;
+    bmi_error_code_t err;
+    bmi_size_t size;
+    void *user_ptr;
+    int outcount, ret;
+
+    while (n > 0)
+    {
+        ret = BMI_testcontext(1, &id, &outcount, &err, &size, &user_ptr,
+                              10, context);
+        if (ret < 0 || (outcount && err != 0))
+        {
+            fprintf(stderr, "operation failed: %d %d\n", ret, err);
+            return -1;
+        }
+        if (outcount && user_ptr && size != length)
+        {
+            fprintf(stderr, "received %lld bytes, not %d\n",
+                    (long long)size, length);
+            return -1;
+        }
+        n -= outcount;
+    }
+    return 0;
+}
+
+static int check(unsigned char *buf, int msg, int length)
+{
+    int64_t i;
+
+    for (i = 0; i < length; i++)
+    {
+        if (buf[i] != pattern(msg, i))
+        {
+            fprintf(stderr, "message %d: bad byte at offset %lld\n", msg,
+                    (long long)i);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int post_recv(bmi_context_id context, PVFS_BMI_addr_t peer,
+                     unsigned char *buf, struct msg_list *l, int msg,
+                     int length, int *pending)
+{
+    bmi_op_id_t id;
+    int ret;
+
+    /* three pieces, none lined up with the stripes */
+    l->sizes[0] = length / 3 + 17;
+    l->sizes[1] = length / 3 - 5;
+    l->sizes[2] = length + SPARE - l->sizes[0] - l->sizes[1];
+    l->buffers[0] = buf;
+    l->buffers[1] = buf + l->sizes[0];
+    l->buffers[2] = buf + l->sizes[0] + l->sizes[1];
+    memset(buf, 0, length + SPARE);
+
+    ret = BMI_post_recv_list(&id, peer, l->buffers, l->sizes, 3,
+                             length + SPARE, &l->actual, BMI_EXT_ALLOC,
+                             START_TAG + msg, buf, context, NULL);
+    if (ret < 0)
+    {
+        fprintf(stderr, "BMI_post_recv_list: %d\n", ret);
+        return ret;
+    }
+    if (ret == 1 && l->actual != length)
+    {
+        fprintf(stderr, "received %lld bytes, not %d\n",
+                (long long)l->actual, length);
+        return -1;
+    }
+    *pending += !ret;
+    return 0;
+}
+
+static int do_server(struct options *opts, bmi_context_id context)
+{
+    struct BMI_unexpected_info info;
+    PVFS_BMI_addr_t peer;
+    unsigned char **bufs;
+    struct msg_list *lists = NULL;
+    int count, length, phase, pending, i, outcount = 0, ret = -1;
+    double t0;
+
+    do
+    {
+        ret = BMI_testunexpected(1, &outcount, &info, 10);
+    } while (ret == 0 && outcount == 0);
+    if (ret < 0 || info.error_code != 0 ||
+        info.size != sizeof(struct ctrl_msg))
+    {
+        fprintf(stderr, "unexpected receive failed\n");
+        return -1;
+    }
+    peer = info.addr;
+    count = ntohl(((struct ctrl_msg *)info.buffer)->count);
+    length = ntohl(((struct ctrl_msg *)info.buffer)->length);
+    BMI_unexpected_free(peer, info.buffer);
+
+    bufs = calloc(count, sizeof(*bufs));
+    lists = calloc(count, sizeof(*lists));
+    for (i = 0; bufs && i < count; i++)
+    {
+        bufs[i] = malloc(length + SPARE);
+        if (!bufs[i])
+        {
+            break;
+        }
+    }
+    if (!bufs || !lists || i < count)
+    {
+        fprintf(stderr, "out of memory\n");
+        goto out;
+    }
+
+    printf("# %d messages of %d bytes\n", count, length);
+    printf("# %-10s %10s %12s\n", "phase", "seconds", "MB/s");
+    for (phase = 0; phase < 2; phase++)
+    {
+        pending = 0;
+        if (phase == 0)
+        {
+            for (i = 0; i < count; i++)
+            {
+                ret = post_recv(context, peer, bufs[i], &lists[i], i,
+                                length, &pending);
+                if (ret < 0)
+                {
+                    goto out;
+                }
+            }
+            /* tell the client to go ahead */
+            ret = BMI_post_send(&info.addr, peer, &count, sizeof(count),
+                                BMI_EXT_ALLOC, 0, NULL, context, NULL);
+            if (ret < 0)
+            {
+                goto out;
+            }
+            pending += !ret;
+            t0 = wtime();
+        }
+        else
+        {
+            usleep(200000);
+            t0 = wtime();
+            for (i = count - 1; i >= 0; i--)
+            {
+                ret = post_recv(context, peer, bufs[i], &lists[i], i,
+                                length, &pending);
+                if (ret < 0)
+                {
+                    goto out;
+                }
+            }
+        }
+        ret = wait_ops(context, pending, length);
+        if (ret < 0)
+        {
+            goto out;
+        }
+        printf("  %-10s %10.4f %12.1f\n", phase ? "buffered" : "posted",
+               wtime() - t0,
+               (double)count * length / (wtime() - t0) / (1024 * 1024));
+        for (i = 0; i < count; i++)
+        {
+            ret = check(bufs[i], i, length);
+            if (ret < 0)
+            {
+                goto out;
+            }
+        }
+    }
+
+    /* let the client go */
+    ret = BMI_post_send(&info.addr, peer, &count, sizeof(count),
+                        BMI_EXT_ALLOC, 0, NULL, context, NULL);
+    if (ret == 0)
+    {
+        ret = wait_ops(context, 1, 0);
+    }
+
+out:
+    for (i = 0; bufs && i < count; i++)
+    {
+        free(bufs[i]);
+    }
+    free(bufs);
+    free(lists);
+    return ret;
+}
+
+static int send_phase(bmi_context_id context, PVFS_BMI_addr_t peer,
+                      unsigned char *buf, struct msg_list *lists,
+                      int count, int length)
+{
+    struct msg_list *l;
+    bmi_op_id_t id;
+    int i, pending = 0, ret;
+
+    for (i = 0; i < count; i++)
+    {
+        l = &lists[i];
+        l->sizes[0] = length / 2 + 3;
+        l->sizes[1] = length - l->sizes[0];
+        l->buffers[0] = buf + (int64_t)i * length;
+        l->buffers[1] = buf + (int64_t)i * length + l->sizes[0];
+        ret = BMI_post_send_list(&id, peer, (const void **)l->buffers,
+                                 l->sizes, 2, length, BMI_EXT_ALLOC,
+                                 START_TAG + i, NULL, context, NULL);
+        if (ret < 0)
+        {
+            fprintf(stderr, "BMI_post_send_list: %d\n", ret);
+            return ret;
+        }
+        pending += !ret;
+    }
+    return wait_ops(context, pending, 0);
+}
+
+static int do_client(struct options *opts, bmi_context_id context)
+{
+    PVFS_BMI_addr_t peer;
+    struct ctrl_msg ctrl;
+    unsigned char *buf;
+    struct msg_list *lists;
+    bmi_op_id_t id;
+    bmi_size_t actual;
+    int32_t go;
+    int64_t j;
+    int i, ret;
+
+    ret = BMI_addr_lookup(&peer, opts->hostid, opts->bmi_opts);
+    if (ret < 0)
+    {
+        fprintf(stderr, "BMI_addr_lookup: %d\n", ret);
+        return ret;
+    }
+    buf = malloc((int64_t)opts->count * opts->length);
+    lists = calloc(opts->count, sizeof(*lists));
+    if (!buf || !lists)
+    {
+        fprintf(stderr, "out of memory\n");
+        free(buf);
+        free(lists);
+        return -1;
+    }
+    for (i = 0; i < opts->count; i++)
+    {
+        for (j = 0; j < opts->length; j++)
+        {
+            buf[(int64_t)i * opts->length + j] = pattern(i, j);
+        }
+    }
+
+    ctrl.count = htonl(opts->count);
+    ctrl.length = htonl(opts->length);
+    ret = BMI_post_sendunexpected(&id, peer, &ctrl, sizeof(ctrl),
+                                  BMI_EXT_ALLOC, 0, NULL, context, NULL);
+    if (ret == 0)
+    {
+        ret = wait_ops(context, 1, 0);
+    }
+    if (ret < 0)
+    {
+        goto out;
+    }
+
+    /* posted phase: wait for the go-ahead; buffered phase: don't */
+    ret = BMI_post_recv(&id, peer, &go, sizeof(go), &actual,
+                        BMI_EXT_ALLOC, 0, NULL, context, NULL);
+    if (ret == 0)
+    {
+        ret = wait_ops(context, 1, 0);
+    }
+    if (ret < 0)
+    {
+        goto out;
+    }
+    ret = send_phase(context, peer, buf, lists, opts->count,
+                     opts->length);
+    if (ret < 0)
+    {
+        goto out;
+    }
+    ret = send_phase(context, peer, buf, lists, opts->count,
+                     opts->length);
+    if (ret < 0)
+    {
+        goto out;
+    }
+
+    ret = BMI_post_recv(&id, peer, &go, sizeof(go), &actual,
+                        BMI_EXT_ALLOC, 0, NULL, context, NULL);
+    if (ret == 0)
+    {
+        ret = wait_ops(context, 1, 0);
+    }
+
+out:
+    free(buf);
+    free(lists);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    struct options opts;
+    bmi_context_id context;
+    int ret;
+
+    if (parse_args(argc, argv, &opts) < 0)
+    {
+        print_usage();
+        return -1;
+    }
+
+    if (opts.server)
+    {
+        ret = BMI_initialize(opts.method, opts.hostid, BMI_INIT_SERVER,
+                             opts.bmi_opts);
+    }
+    else
+    {
+        ret = BMI_initialize(NULL, NULL, 0, NULL);
+    }
+    if (ret < 0)
+    {
+        fprintf(stderr, "BMI_initialize: %d\n", ret);
+        return -1;
+    }
+    ret = BMI_open_context(&context);
+    if (ret < 0)
+    {
+        fprintf(stderr, "BMI_open_context: %d\n", ret);
+        BMI_finalize();
+        return -1;
+    }
+
+    if (opts.server)
+    {
+        ret = do_server(&opts, context);
+    }
+    else
+    {
+        ret = do_client(&opts, context);
+    }
+
+    BMI_close_context(context);
+    BMI_finalize();
+    return (ret < 0) ? -1 : 0;
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
@@ -70,6 +70,7 @@ struct options
         int  which;
         int  test;
         int  crc;
+        char *bmi_opts;         /* BMI options string */
 };
 
 #ifdef WIN32
@@ -86,12 +87,13 @@ static int do_client(struct options *opts, bmi_context_id *context);
 
 static void print_usage(void)
 {
-        fprintf(stderr, "usage: pingpong -h HOST_URI -s|-c [-u] [-r]\n");
+        fprintf(stderr, "usage: pingpong -h HOST_URI -s|-c [-u] [-r] [-o OPTIONS]\n");
         fprintf(stderr, "       where:\n");
         fprintf(stderr, "       HOST_URI is tcp://host:port, mx://host:board:endpoint, etc\n");
         fprintf(stderr, "       -s is server and -c is client\n");
         fprintf(stderr, "       -u will use unexpected messages (pass to client only)\n");
         fprintf(stderr, "       -r will calculate and verify checksums (adler32)\n");
+        fprintf(stderr, "       -o passes OPTIONS to BMI, e.g. tcp_stripes=4\n");
         return;
 }
 
@@ -121,7 +123,8 @@ int main(int argc, char **argv)
 
         /* initialize local interface (default options) */
         if (opts->which == SERVER)
-            ret = BMI_initialize(opts->method, opts->hostid, BMI_INIT_SERVER, NULL);
+            ret = BMI_initialize(opts->method, opts->hostid, BMI_INIT_SERVER,
+                                 opts->bmi_opts);
         else
             ret = BMI_initialize(NULL, NULL, 0, NULL);
 
@@ -236,7 +239,8 @@ static int do_server(struct options *opts, bmi_context_id *context)
         if (max_bytes > MAX_BYTES) max_bytes = MAX_BYTES;
 
         if (opts->test == UNEXPECTED) {
-                ret = BMI_addr_lookup(&server_addr, opts->hostid, NULL);
+                ret = BMI_addr_lookup(&server_addr, opts->hostid,
+                                      opts->bmi_opts);
                 if (ret < 0) {
                         errno = -ret;
                         perror("BMI_addr_lookup");
@@ -431,7 +435,7 @@ static int do_client(struct options *opts, bmi_context_id *context)
 #endif
 
         /* get a bmi_addr for the server */
-        ret = BMI_addr_lookup(&peer_addr, opts->hostid, NULL);
+        ret = BMI_addr_lookup(&peer_addr, opts->hostid, opts->bmi_opts);
         if (ret < 0) {
                 errno = -ret;
                 perror("BMI_addr_lookup");
@@ -774,6 +778,11 @@ static struct options *parse_args(int argc, char *argv[])
                         opts->crc = 1;
                         argi++;
                 }
+                else if (strcmp(argv[argi], "-o") == 0)
+                {
+                        opts->bmi_opts = argv[++argi];
+                        argi++;
+                }
                 else 
                 {
                         break;
@@ -814,7 +823,7 @@ static struct options *parse_args(int argc, char *argv[])
 
         /* getopt stuff */
         extern char *optarg;
-        char flags[] = "h:scur";
+        char flags[] = "h:scuro:";
         int one_opt = 0;
 
         struct options *opts = NULL;
@@ -855,6 +864,9 @@ static struct options *parse_args(int argc, char *argv[])
                 case ('r'):
                         opts->crc = 1;
                         break;
+                case ('o'):
+                        opts->bmi_opts = optarg;
+                        break;
                 default:
                         break;
                 }
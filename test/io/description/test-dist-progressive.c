@@ -0,0 +1,484 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* test-dist-progressive: checks the progressive_stripe distribution
+ * against a reference layout built strip by strip.  For several
+ * parameter sets and datafile counts it compares
+ * logical_to_physical_offset, physical_to_logical_offset,
+ * next_mapped_offset, contiguous_length and logical_file_size at every
+ * strip boundary and at random offsets, then runs file requests through
+ * the request processor for every datafile and checks that the pieces
+ * land where the reference puts them and add up to the request.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pvfs2-types.h>
+#include <gossip.h>
+#include <pvfs2-debug.h>
+
+#include <pint-distribution.h>
+#include <pint-dist-utils.h>
+#include <pvfs2-request.h>
+#include <pint-request.h>
+#include "pvfs2-dist-progressive.h"
+#include "pvfs2-internal.h"
+
+#define SEGMAX 64
+#define BYTEMAX (64*1024*1024)
+#define RANDOM_OFFSETS 2000
+
+/* one strip of the reference layout */
+struct ref_strip
+{
+    PVFS_offset loff;
+    PVFS_offset poff;
+    PVFS_size size;
+    uint32_t server;
+};
+
+struct ref_layout
+{
+    struct ref_strip *strips;
+    int count;
+    int alloc;
+    PVFS_size limit;            /* logical bytes covered */
+    PVFS_offset last_start;     /* where the last region begins */
+};
+
+static int errors = 0;
+
+#define CHECK(cond, ...)                                \
+do {                                                    \
+    if(!(cond))                                         \
+    {                                                   \
+        if(errors++ < 20)                               \
+        {                                               \
+            printf("FAILED: " __VA_ARGS__);             \
+        }                                               \
+    }                                                   \
+} while(0)
+
+static void ref_add(struct ref_layout *ref, PVFS_offset loff,
+                    PVFS_offset poff, PVFS_size size, uint32_t server)
+{
+    if(ref->count == ref->alloc)
+    {
+        ref->alloc = ref->alloc ? ref->alloc * 2 : 1024;
+        ref->strips = realloc(ref->strips,
+                              ref->alloc * sizeof(*ref->strips));
+        if(!ref->strips)
+        {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    ref->strips[ref->count].loff = loff;
+    ref->strips[ref->count].poff = poff;
+    ref->strips[ref->count].size = size;
+    ref->strips[ref->count].server = server;
+    ref->count++;
+}
+
+/* lays the file out one strip at a time, the way the parameters
+ * describe it, until final_stripes stripes past the start of the last
+ * region
+ */
+static void ref_build(struct ref_layout *ref, PVFS_progressive_params *p,
+                      uint32_t server_ct, int final_stripes)
+{
+    PVFS_offset *phys;
+    PVFS_offset loff = 0;
+    PVFS_size strip = p->strip_size;
+    uint32_t width = p->initial_servers < server_ct ?
+                     p->initial_servers : server_ct;
+    uint32_t s, k, stripes;
+    int last;
+
+    phys = calloc(server_ct, sizeof(*phys));
+    memset(ref, 0, sizeof(*ref));
+    for(;;)
+    {
+        last = (width == server_ct && strip >= p->max_strip_size);
+        stripes = last ? final_stripes : p->region_stripes;
+        if(last)
+        {
+            ref->last_start = loff;
+        }
+        for(k = 0; k < stripes; k++)
+        {
+            for(s = 0; s < width; s++)
+            {
+                ref_add(ref, loff, phys[s], strip, s);
+                phys[s] += strip;
+                loff += strip;
+            }
+        }
+        if(last)
+        {
+            break;
+        }
+        width = (width * p->growth_factor < server_ct) ?
+                width * p->growth_factor : server_ct;
+        strip = (strip * p->growth_factor < p->max_strip_size) ?
+                strip * p->growth_factor : p->max_strip_size;
+    }
+    ref->limit = loff;
+    free(phys);
+}
+
+/* index of the strip holding logical offset loff */
+static int ref_find(struct ref_layout *ref, PVFS_offset loff)
+{
+    int lo = 0, hi = ref->count - 1, mid;
+
+    while(lo < hi)
+    {
+        mid = (lo + hi + 1) / 2;
+        if(ref->strips[mid].loff <= loff)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid - 1;
+        }
+    }
+    return lo;
+}
+
+/* first strip of server at or after strip i, or -1 */
+static int ref_next_on(struct ref_layout *ref, int i, uint32_t server)
+{
+    for(; i < ref->count; i++)
+    {
+        if(ref->strips[i].server == server)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* bytes of server below logical offset loff */
+static PVFS_offset ref_l2p(struct ref_layout *ref, uint32_t server,
+                           PVFS_offset loff)
+{
+    int i = ref_find(ref, loff);
+
+    if(ref->strips[i].server == server)
+    {
+        return ref->strips[i].poff + (loff - ref->strips[i].loff);
+    }
+    i = ref_next_on(ref, i, server);
+    return (i < 0) ? -1 : ref->strips[i].poff;
+}
+
+/* bytes of server below logical offset loff, wherever loff is */
+static PVFS_size ref_bytes_below(struct ref_layout *ref, uint32_t server,
+                                 PVFS_offset loff)
+{
+    PVFS_size bytes = 0;
+    int i;
+
+    for(i = 0; i < ref->count && ref->strips[i].loff < loff; i++)
+    {
+        if(ref->strips[i].server == server)
+        {
+            bytes += (loff - ref->strips[i].loff < ref->strips[i].size) ?
+                     loff - ref->strips[i].loff : ref->strips[i].size;
+        }
+    }
+    return bytes;
+}
+
+static void check_offset(struct ref_layout *ref, PINT_dist *dist,
+                         uint32_t server_ct, PVFS_offset loff)
+{
+    PINT_request_file_data fd;
+    PVFS_offset exp_poff, poff, exp_next, next, back;
+    PVFS_size len, run;
+    int i, j;
+    uint32_t s;
+
+    memset(&fd, 0, sizeof(fd));
+    fd.server_ct = server_ct;
+    fd.dist = dist;
+
+    for(s = 0; s < server_ct; s++)
+    {
+        fd.server_nr = s;
+        exp_poff = ref_l2p(ref, s, loff);
+        if(exp_poff < 0)
+        {
+            /* beyond the reference for this server */
+            continue;
+        }
+        poff = dist->methods->logical_to_physical_offset(dist->params,
+                                                         &fd, loff);
+        CHECK(poff == exp_poff,
+              "servers %u server %u l2p(%lld) = %lld, expected %lld\n",
+              server_ct, s, lld(loff), lld(poff), lld(exp_poff));
+
+        i = ref_find(ref, loff);
+        if(ref->strips[i].server == s)
+        {
+            exp_next = loff;
+        }
+        else
+        {
+            j = ref_next_on(ref, i, s);
+            exp_next = ref->strips[j].loff;
+        }
+        next = dist->methods->next_mapped_offset(dist->params, &fd, loff);
+        CHECK(next == exp_next,
+              "servers %u server %u next_mapped(%lld) = %lld, "
+              "expected %lld\n",
+              server_ct, s, lld(loff), lld(next), lld(exp_next));
+
+        back = dist->methods->physical_to_logical_offset(dist->params,
+                                                         &fd, exp_poff);
+        CHECK(back == exp_next,
+              "servers %u server %u p2l(%lld) = %lld, expected %lld\n",
+              server_ct, s, lld(exp_poff), lld(back), lld(exp_next));
+
+        /* contiguous_length must reach the end of the strip and not run
+         * past the logically contiguous bytes of this server
+         */
+        i = ref_find(ref, exp_next);
+        run = ref->strips[i].loff + ref->strips[i].size - exp_next;
+        len = run;
+        for(j = i + 1; j < ref->count &&
+                       ref->strips[j].server == s &&
+                       ref->strips[j].loff == ref->strips[j - 1].loff +
+                                              ref->strips[j - 1].size; j++)
+        {
+            run += ref->strips[j].size;
+        }
+        if(j == ref->count && server_ct > 1)
+        {
+            /* the reference ends; the last region goes on */
+            run = len;
+        }
+        len = dist->methods->contiguous_length(dist->params, &fd, exp_poff);
+        CHECK(len >= ref->strips[i].loff + ref->strips[i].size - exp_next &&
+              len <= run,
+              "servers %u server %u contiguous_length(%lld) = %lld, "
+              "strip left %lld, run %lld\n",
+              server_ct, s, lld(exp_poff), lld(len),
+              lld(ref->strips[i].loff + ref->strips[i].size - exp_next),
+              lld(run));
+    }
+}
+
+static void check_file_size(struct ref_layout *ref, PINT_dist *dist,
+                            uint32_t server_ct, PVFS_size fsize)
+{
+    PVFS_size *psizes;
+    PVFS_size lsize;
+    uint32_t s;
+
+    psizes = calloc(server_ct, sizeof(*psizes));
+    for(s = 0; s < server_ct; s++)
+    {
+        psizes[s] = ref_bytes_below(ref, s, fsize);
+    }
+    lsize = dist->methods->logical_file_size(dist->params, server_ct,
+                                             psizes);
+    CHECK(lsize == fsize,
+          "servers %u logical_file_size = %lld, expected %lld\n",
+          server_ct, lld(lsize), lld(fsize));
+    free(psizes);
+}
+
+/* runs a contiguous file request of size bytes at offset through the
+ * request processor on every datafile, as a server would, and checks
+ * each segment against the reference
+ */
+static void check_request(struct ref_layout *ref, PINT_dist *dist,
+                          uint32_t server_ct, PVFS_offset offset,
+                          PVFS_size size)
+{
+    PINT_Request_state *file_state;
+    PINT_request_file_data rf;
+    PINT_Request_result seg;
+    PVFS_offset offsets[SEGMAX];
+    PVFS_size sizes[SEGMAX];
+    PVFS_size total = 0, server_bytes, expected;
+    PVFS_offset loff;
+    int retval, i, k;
+    uint32_t s;
+
+    for(s = 0; s < server_ct; s++)
+    {
+        memset(&rf, 0, sizeof(rf));
+        rf.server_nr = s;
+        rf.server_ct = server_ct;
+        rf.fsize = 0;
+        rf.dist = dist;
+        rf.extend_flag = 1;
+
+        file_state = PINT_new_request_state(PVFS_BYTE);
+        PINT_REQUEST_STATE_SET_TARGET(file_state, offset);
+        PINT_REQUEST_STATE_SET_FINAL(file_state, offset + size);
+
+        seg.offset_array = offsets;
+        seg.size_array = sizes;
+        seg.segmax = SEGMAX;
+        seg.bytemax = BYTEMAX;
+        server_bytes = 0;
+        do
+        {
+            seg.bytes = 0;
+            seg.segs = 0;
+            retval = PINT_process_request(file_state, NULL, &rf, &seg,
+                                          PINT_SERVER);
+            if(retval < 0)
+            {
+                CHECK(0, "PINT_process_request() failed: %d\n", retval);
+                break;
+            }
+            for(i = 0; i < seg.segs; i++)
+            {
+                /* every byte must be this server's and in the request */
+                loff = dist->methods->physical_to_logical_offset(
+                    dist->params, &rf, offsets[i]);
+                k = ref_find(ref, loff);
+                CHECK(ref->strips[k].server == s &&
+                      ref->strips[k].poff + (loff - ref->strips[k].loff) ==
+                          offsets[i] &&
+                      loff >= offset &&
+                      loff + sizes[i] <= offset + size,
+                      "servers %u server %u segment %lld+%lld maps to "
+                      "logical %lld outside the request\n",
+                      server_ct, s, lld(offsets[i]), lld(sizes[i]),
+                      lld(loff));
+                server_bytes += sizes[i];
+            }
+        } while(!PINT_REQUEST_DONE(file_state) && retval >= 0);
+        PINT_free_request_state(file_state);
+
+        expected = ref_bytes_below(ref, s, offset + size) -
+                   ref_bytes_below(ref, s, offset);
+        CHECK(server_bytes == expected,
+              "servers %u server %u request %lld+%lld: %lld bytes, "
+              "expected %lld\n",
+              server_ct, s, lld(offset), lld(size), lld(server_bytes),
+              lld(expected));
+        total += server_bytes;
+    }
+    CHECK(total == size,
+          "servers %u request %lld+%lld: %lld bytes in all\n",
+          server_ct, lld(offset), lld(size), lld(total));
+}
+
+static void run_case(PVFS_progressive_params *p, uint32_t server_ct)
+{
+    struct ref_layout ref;
+    PINT_dist *dist;
+    unsigned int seed = 17 + server_ct;
+    PVFS_offset loff;
+    PVFS_size size;
+    int i, before = errors;
+
+    dist = PINT_dist_create(PVFS_DIST_PROGRESSIVE_NAME);
+    if(!dist)
+    {
+        CHECK(0, "could not create %s\n", PVFS_DIST_PROGRESSIVE_NAME);
+        return;
+    }
+    memcpy(dist->params, p, sizeof(*p));
+
+    ref_build(&ref, p, server_ct, 3);
+
+    for(i = 0; i < ref.count; i++)
+    {
+        check_offset(&ref, dist, server_ct, ref.strips[i].loff);
+        check_offset(&ref, dist, server_ct, ref.strips[i].loff + 1);
+        if(ref.strips[i].loff > 0)
+        {
+            check_offset(&ref, dist, server_ct, ref.strips[i].loff - 1);
+        }
+    }
+    for(i = 0; i < RANDOM_OFFSETS; i++)
+    {
+        loff = ((PVFS_offset)rand_r(&seed) << 16 | rand_r(&seed)) %
+               ref.limit;
+        check_offset(&ref, dist, server_ct, loff);
+        check_file_size(&ref, dist, server_ct, loff + 1);
+    }
+    check_file_size(&ref, dist, server_ct, 1);
+    check_file_size(&ref, dist, server_ct, ref.limit);
+
+    /* requests from the first strip, across region boundaries and
+     * inside the last region
+     */
+    check_request(&ref, dist, server_ct, 0, ref.limit);
+    check_request(&ref, dist, server_ct, 0, 1);
+    for(i = 0; i < 20; i++)
+    {
+        loff = ((PVFS_offset)rand_r(&seed) << 16 | rand_r(&seed)) %
+               ref.limit;
+        size = 1 + (((PVFS_offset)rand_r(&seed) << 16 | rand_r(&seed)) %
+                    (ref.limit - loff));
+        check_request(&ref, dist, server_ct, loff, size);
+    }
+
+    printf("%-7s strip %7lld max %8lld initial %u growth %u stripes %u, "
+           "%3u datafiles: %d strips, last region at %lld\n",
+           errors == before ? "ok" : "FAILED",
+           lld(p->strip_size), lld(p->max_strip_size), p->initial_servers,
+           p->growth_factor, p->region_stripes, server_ct, ref.count,
+           lld(ref.last_start));
+
+    free(ref.strips);
+    PINT_dist_free(dist);
+}
+
+int main(int argc, char **argv)
+{
+    PVFS_progressive_params cases[] =
+    {
+        /* strip, max, initial, growth, stripes */
+        {65536, 1048576, 1, 2, 4},
+        {4096, 65536, 2, 3, 1},
+        {8192, 8192, 1, 2, 2},          /* strips never grow */
+        {1000, 7000, 3, 4, 5},          /* sizes that are not powers */
+        {65536, 4194304, 16, 2, 2},     /* wider than some file systems */
+    };
+    uint32_t server_cts[] = {1, 2, 3, 8, 13, 32};
+    unsigned int c, n;
+
+    PINT_dist_initialize(NULL);
+
+    for(c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+    {
+        for(n = 0; n < sizeof(server_cts) / sizeof(server_cts[0]); n++)
+        {
+            run_case(&cases[c], server_cts[n]);
+        }
+    }
+
+    PINT_dist_finalize();
+
+    if(errors)
+    {
+        printf("%d checks failed\n", errors);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
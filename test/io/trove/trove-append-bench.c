@@ -0,0 +1,386 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* trove-append-bench: appends to bstreams through the direct I/O method
+ * from several threads at once, either each thread to its own bstream or
+ * all of them to one shared bstream.  Reports the aggregate append rate,
+ * then checks that the bstream sizes match what was written and that no
+ * record was damaged by a neighbouring write.
+ */
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "trove.h"
+#include "trove-types.h"
+#include "pvfs2-internal.h"
+#include "id-generator.h"
+
+#define BENCH_COLL_ID 1
+#define BENCH_FIRST_HANDLE 8192
+#define BENCH_VERIFY_MAX (256 * 1024 * 1024)
+
+struct bench_thread
+{
+    pthread_t thread;
+    int index;
+    TROVE_context_id context;
+    TROVE_handle handle;
+    PVFS_size *tail;
+    long ops;
+    long errors;
+};
+
+static int record_size;
+static volatile int stop = 0;
+
+static double Wtime(void)
+{
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    return((double)t.tv_sec + (double)(t.tv_usec) / 1000000);
+}
+
+static TROVE_method_id trove_method_callback(TROVE_coll_id id)
+{
+    return(TROVE_METHOD_DBPF_DIRECTIO);
+}
+
+/* every byte of a record holds a value derived from its offset */
+static char record_byte(PVFS_size offset)
+{
+    return (char)((offset / record_size) % 251 + 1);
+}
+
+/* waits for a posted op; returns the op's state, or < 0 if test fails */
+static int wait_op(TROVE_op_id op_id, TROVE_context_id context)
+{
+    int ret, count;
+    TROVE_ds_state state = 0;
+
+    do
+    {
+        count = 0;
+        ret = trove_dspace_test(BENCH_COLL_ID, op_id, context, &count,
+                                NULL, NULL, &state, 10);
+    } while(ret == 0);
+    if(ret < 0)
+    {
+        return(ret);
+    }
+    return(state);
+}
+
+static void *bench_thread_fn(void *arg)
+{
+    struct bench_thread *bt = (struct bench_thread *)arg;
+    TROVE_op_id op_id;
+    TROVE_size out_size;
+    TROVE_size size = record_size;
+    TROVE_offset offset;
+    char *buf;
+    int ret;
+
+    buf = malloc(record_size);
+    if(!buf)
+    {
+        bt->errors++;
+        return(NULL);
+    }
+
+    while(!stop)
+    {
+        offset = __atomic_fetch_add(bt->tail, record_size, __ATOMIC_RELAXED);
+        memset(buf, record_byte(offset), record_size);
+
+        ret = trove_bstream_write_list(BENCH_COLL_ID, bt->handle,
+            &buf, &size, 1, &offset, &size, 1, &out_size, 0, NULL,
+            NULL, bt->context, &op_id, NULL);
+        if(ret == 0)
+        {
+            ret = wait_op(op_id, bt->context);
+        }
+        if(ret < 0 || out_size != size)
+        {
+            bt->errors++;
+        }
+        bt->ops++;
+    }
+
+    free(buf);
+    return(NULL);
+}
+
+static int create_handle(TROVE_handle handle, TROVE_context_id context,
+                         PVFS_size *size)
+{
+    int ret;
+    TROVE_op_id op_id;
+    TROVE_handle_extent_array extent_array;
+    TROVE_extent cur_extent;
+    TROVE_handle new_handle;
+    TROVE_ds_attributes_s attr;
+
+    extent_array.extent_count = 1;
+    extent_array.extent_array = &cur_extent;
+    cur_extent.first = cur_extent.last = handle;
+    ret = trove_dspace_create(BENCH_COLL_ID, &extent_array, &new_handle,
+        PVFS_TYPE_DATAFILE, NULL, TROVE_FORCE_REQUESTED_HANDLE,
+        NULL, context, &op_id, NULL);
+    if(ret == 0)
+    {
+        ret = wait_op(op_id, context);
+    }
+    if(ret < 0 && ret != -TROVE_EEXIST)
+    {
+        fprintf(stderr, "Error: failed to create handle %llu (%d).\n",
+                llu(handle), ret);
+        return(-1);
+    }
+
+    ret = trove_dspace_getattr(BENCH_COLL_ID, handle, &attr, 0, NULL,
+                               context, &op_id, NULL);
+    if(ret == 0)
+    {
+        ret = wait_op(op_id, context);
+    }
+    if(ret < 0)
+    {
+        fprintf(stderr, "Error: failed to getattr handle %llu (%d).\n",
+                llu(handle), ret);
+        return(-1);
+    }
+    *size = attr.u.datafile.b_size;
+    return(0);
+}
+
+/* checks the size and the contents of one bstream; start is where this
+ * run's records begin */
+static long verify_handle(TROVE_handle handle, TROVE_context_id context,
+                          PVFS_size start, PVFS_size tail)
+{
+    int ret;
+    TROVE_op_id op_id;
+    TROVE_ds_attributes_s attr;
+    TROVE_size size, out_size = 0;
+    TROVE_offset offset = start;
+    PVFS_size i;
+    char *buf;
+    long errors = 0;
+
+    ret = trove_dspace_getattr(BENCH_COLL_ID, handle, &attr, 0, NULL,
+                               context, &op_id, NULL);
+    if(ret == 0)
+    {
+        ret = wait_op(op_id, context);
+    }
+    if(ret < 0 || attr.u.datafile.b_size != tail)
+    {
+        fprintf(stderr, "Error: handle %llu has size %lld, expected %lld\n",
+                llu(handle), lld(attr.u.datafile.b_size), lld(tail));
+        return(1);
+    }
+
+    size = tail - start;
+    if(size == 0 || size > BENCH_VERIFY_MAX)
+    {
+        return(0);
+    }
+    buf = malloc(size);
+    if(!buf)
+    {
+        return(0);
+    }
+    ret = trove_bstream_read_list(BENCH_COLL_ID, handle, &buf, &size, 1,
+        &offset, &size, 1, &out_size, 0, NULL, NULL, context, &op_id, NULL);
+    if(ret == 0)
+    {
+        ret = wait_op(op_id, context);
+    }
+    if(ret < 0)
+    {
+        fprintf(stderr, "Error: failed to read back handle %llu\n",
+                llu(handle));
+        free(buf);
+        return(1);
+    }
+    for(i = 0; i < size; i++)
+    {
+        if(buf[i] != record_byte(start + (i / record_size) * record_size))
+        {
+            fprintf(stderr, "Error: handle %llu: bad byte at offset %lld\n",
+                    llu(handle), lld(start + i));
+            errors++;
+            break;
+        }
+    }
+    free(buf);
+    return(errors);
+}
+
+int main(int argc, char *argv[])
+{
+    int ret, i;
+    int thread_count, file_count;
+    double run_seconds;
+    struct bench_thread *threads;
+    PVFS_size *tails, *starts;
+    TROVE_op_id op_id;
+    TROVE_context_id context;
+    TROVE_coll_id coll_id;
+    double start_tm, end_tm;
+    long ops = 0, errors = 0;
+    int meta_sync = 1;
+
+    if(argc != 6 ||
+       sscanf(argv[2], "%d", &thread_count) != 1 || thread_count < 1 ||
+       (strcmp(argv[3], "shared") && strcmp(argv[3], "private")) ||
+       sscanf(argv[4], "%d", &record_size) != 1 || record_size < 1 ||
+       sscanf(argv[5], "%lf", &run_seconds) != 1)
+    {
+        fprintf(stderr, "Usage: trove-append-bench <trove dir> <threads> "
+                "<shared|private> <record size> <seconds>\n");
+        return(-1);
+    }
+    file_count = strcmp(argv[3], "shared") ? thread_count : 1;
+
+    /* the direct I/O method registers its ops like BMI and job do */
+    id_gen_safe_initialize();
+
+    ret = trove_initialize(TROVE_METHOD_DBPF_DIRECTIO, trove_method_callback,
+                           argv[1], argv[1], 0);
+    if(ret < 0)
+    {
+        /* try to create new storage space */
+        ret = trove_storage_create(TROVE_METHOD_DBPF_DIRECTIO, argv[1],
+                                   argv[1], NULL, &op_id);
+        if(ret != 1)
+        {
+            fprintf(stderr, "Error: failed to create storage space at %s\n",
+                argv[1]);
+            return(-1);
+        }
+
+        ret = trove_initialize(TROVE_METHOD_DBPF_DIRECTIO,
+                               trove_method_callback, argv[1], argv[1], 0);
+        if(ret < 0)
+        {
+            fprintf(stderr, "Error: failed to initialize.\n");
+            return(-1);
+        }
+
+        ret = trove_collection_create("foo", BENCH_COLL_ID, NULL, &op_id);
+        if(ret != 1)
+        {
+            fprintf(stderr, "Error: failed to create collection.\n");
+            return(-1);
+        }
+    }
+
+    ret = trove_collection_lookup(TROVE_METHOD_DBPF_DIRECTIO, "foo",
+                                  &coll_id, NULL, &op_id);
+    if(ret != 1)
+    {
+        fprintf(stderr, "collection lookup failed.\n");
+        return(-1);
+    }
+
+    ret = trove_open_context(BENCH_COLL_ID, &context);
+    if(ret < 0)
+    {
+        fprintf(stderr, "Error: trove_open_context failed\n");
+        return(-1);
+    }
+
+    /* sync metadata as a server does by default (TroveSyncMeta) */
+    trove_collection_setinfo(BENCH_COLL_ID, context,
+        TROVE_COLLECTION_META_SYNC_MODE, (void *)&meta_sync);
+
+    threads = calloc(thread_count, sizeof(*threads));
+    tails = calloc(file_count, sizeof(*tails));
+    starts = calloc(file_count, sizeof(*starts));
+    if(!threads || !tails || !starts)
+    {
+        perror("calloc");
+        return(-1);
+    }
+    for(i = 0; i < file_count; i++)
+    {
+        if(create_handle(BENCH_FIRST_HANDLE + i, context, &tails[i]) < 0)
+        {
+            return(-1);
+        }
+        starts[i] = tails[i];
+    }
+
+    for(i = 0; i < thread_count; i++)
+    {
+        threads[i].index = i;
+        threads[i].handle = BENCH_FIRST_HANDLE + (i % file_count);
+        threads[i].tail = &tails[i % file_count];
+        ret = trove_open_context(BENCH_COLL_ID, &threads[i].context);
+        if(ret < 0)
+        {
+            fprintf(stderr, "Error: trove_open_context failed\n");
+            return(-1);
+        }
+    }
+
+    start_tm = Wtime();
+    for(i = 0; i < thread_count; i++)
+    {
+        pthread_create(&threads[i].thread, NULL, bench_thread_fn,
+                       &threads[i]);
+    }
+    usleep((useconds_t)(run_seconds * 1e6));
+    stop = 1;
+    for(i = 0; i < thread_count; i++)
+    {
+        pthread_join(threads[i].thread, NULL);
+        ops += threads[i].ops;
+        errors += threads[i].errors;
+    }
+    end_tm = Wtime();
+
+    printf("# %d threads, %s bstream%s, %d byte records\n",
+           thread_count, argv[3], file_count > 1 ? "s" : "", record_size);
+    printf("%f appends/s\n", ((double)ops) / (end_tm - start_tm));
+    printf("%f MB/s\n", ((double)ops) * record_size / 1e6 /
+           (end_tm - start_tm));
+
+    for(i = 0; i < file_count; i++)
+    {
+        errors += verify_handle(BENCH_FIRST_HANDLE + i, context,
+                                starts[i], tails[i]);
+    }
+    printf("%ld errors\n", errors);
+
+    for(i = 0; i < thread_count; i++)
+    {
+        trove_close_context(BENCH_COLL_ID, threads[i].context);
+    }
+    trove_close_context(BENCH_COLL_ID, context);
+    trove_finalize(TROVE_METHOD_DBPF_DIRECTIO);
+    id_gen_safe_finalize();
+    free(threads);
+    free(tails);
+    free(starts);
+
+    return(errors ? 1 : 0);
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ft=c ts=8 sts=4 sw=4 expandtab
+ */
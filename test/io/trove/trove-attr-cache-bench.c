@@ -0,0 +1,311 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* trove-attr-cache-bench: drives the dbpf attribute cache from several
+ * threads at once, without a server in the way.  Each thread runs a
+ * stream of dspace getattrs on random handles, each followed by a read
+ * of a keyval that does not exist, which is the pattern of a file
+ * getattr checking whether the file is stuffed.  Reports the aggregate
+ * rate and the cache counters.
+ */
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "trove.h"
+#include "trove-types.h"
+#include "pvfs2-internal.h"
+
+#define BENCH_COLL_ID 1
+#define BENCH_FIRST_HANDLE 4096
+#define BENCH_ABSENT_KEY NUM_DFILES_REQ_KEYSTR
+
+struct bench_thread
+{
+    pthread_t thread;
+    int index;
+    TROVE_context_id context;
+    long ops;
+    long errors;
+};
+
+static int handle_count;
+static double run_seconds;
+static volatile int stop = 0;
+
+static double Wtime(void)
+{
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    return((double)t.tv_sec + (double)(t.tv_usec) / 1000000);
+}
+
+static TROVE_method_id trove_method_callback(TROVE_coll_id id)
+{
+    return(TROVE_METHOD_DBPF);
+}
+
+/* waits for a posted op; returns the op's state, or < 0 if test fails */
+static int wait_op(TROVE_op_id op_id, TROVE_context_id context)
+{
+    int ret, count;
+    TROVE_ds_state state = 0;
+
+    do
+    {
+        count = 0;
+        ret = trove_dspace_test(BENCH_COLL_ID, op_id, context, &count,
+                                NULL, NULL, &state, 10);
+    } while(ret == 0);
+    if(ret < 0)
+    {
+        return(ret);
+    }
+    return(state);
+}
+
+static void *bench_thread_fn(void *arg)
+{
+    struct bench_thread *bt = (struct bench_thread *)arg;
+    unsigned int seed = 17 + bt->index;
+    TROVE_ds_attributes_s attr;
+    TROVE_keyval_s key, val;
+    TROVE_op_id op_id;
+    TROVE_handle handle;
+    char buf[64];
+    int ret;
+
+    key.buffer = BENCH_ABSENT_KEY;
+    key.buffer_sz = NUM_DFILES_REQ_KEYLEN;
+
+    while(!stop)
+    {
+        handle = BENCH_FIRST_HANDLE + (rand_r(&seed) % handle_count);
+
+        ret = trove_dspace_getattr(BENCH_COLL_ID, handle, &attr, 0, NULL,
+                                   bt->context, &op_id, NULL);
+        if(ret == 0)
+        {
+            ret = wait_op(op_id, bt->context);
+        }
+        if(ret < 0)
+        {
+            bt->errors++;
+        }
+
+        val.buffer = buf;
+        val.buffer_sz = sizeof(buf);
+        ret = trove_keyval_read(BENCH_COLL_ID, handle, &key, &val, 0, NULL,
+                                NULL, bt->context, &op_id, NULL);
+        if(ret == 0)
+        {
+            ret = wait_op(op_id, bt->context);
+        }
+        if(ret != -TROVE_ENOENT)
+        {
+            bt->errors++;
+        }
+
+        bt->ops++;
+    }
+    return(NULL);
+}
+
+static int setup(char *dir, int max_elems)
+{
+    int ret, i;
+    TROVE_op_id op_id;
+    TROVE_context_id context;
+    TROVE_coll_id coll_id;
+    TROVE_handle_extent_array extent_array;
+    TROVE_extent cur_extent;
+    TROVE_handle handle;
+    int table_size = 511;
+
+    ret = trove_initialize(TROVE_METHOD_DBPF, trove_method_callback,
+                           dir, dir, 0);
+    if(ret < 0)
+    {
+        /* try to create new storage space */
+        ret = trove_storage_create(TROVE_METHOD_DBPF, dir, dir, NULL,
+                                   &op_id);
+        if(ret != 1)
+        {
+            fprintf(stderr, "Error: failed to create storage space at %s\n",
+                dir);
+            return(-1);
+        }
+
+        ret = trove_initialize(TROVE_METHOD_DBPF, trove_method_callback,
+                               dir, dir, 0);
+        if(ret < 0)
+        {
+            fprintf(stderr, "Error: failed to initialize.\n");
+            return(-1);
+        }
+
+        ret = trove_collection_create("foo", BENCH_COLL_ID, NULL, &op_id);
+        if(ret != 1)
+        {
+            fprintf(stderr, "Error: failed to create collection.\n");
+            return(-1);
+        }
+    }
+
+    ret = trove_collection_lookup(TROVE_METHOD_DBPF, "foo", &coll_id,
+                                  NULL, &op_id);
+    if(ret != 1)
+    {
+        fprintf(stderr, "collection lookup failed.\n");
+        return(-1);
+    }
+
+    ret = trove_open_context(BENCH_COLL_ID, &context);
+    if(ret < 0)
+    {
+        fprintf(stderr, "Error: trove_open_context failed\n");
+        return(-1);
+    }
+
+    /* the same settings the server applies from its config file */
+    trove_collection_setinfo(BENCH_COLL_ID, context,
+        TROVE_COLLECTION_ATTR_CACHE_KEYWORDS, (void *)"dh,nd");
+    trove_collection_setinfo(BENCH_COLL_ID, context,
+        TROVE_COLLECTION_ATTR_CACHE_SIZE, (void *)&table_size);
+    trove_collection_setinfo(BENCH_COLL_ID, context,
+        TROVE_COLLECTION_ATTR_CACHE_MAX_NUM_ELEMS, (void *)&max_elems);
+    ret = trove_collection_setinfo(BENCH_COLL_ID, context,
+        TROVE_COLLECTION_ATTR_CACHE_INITIALIZE, NULL);
+    if(ret < 0)
+    {
+        fprintf(stderr, "Error: attr cache initialize failed\n");
+        return(-1);
+    }
+
+    extent_array.extent_count = 1;
+    extent_array.extent_array = &cur_extent;
+    for(i = 0; i < handle_count; i++)
+    {
+        cur_extent.first = cur_extent.last = BENCH_FIRST_HANDLE + i;
+        ret = trove_dspace_create(BENCH_COLL_ID, &extent_array, &handle,
+            PVFS_TYPE_METAFILE, NULL, TROVE_FORCE_REQUESTED_HANDLE,
+            NULL, context, &op_id, NULL);
+        if(ret == 0)
+        {
+            ret = wait_op(op_id, context);
+        }
+        if(ret < 0 && ret != -TROVE_EEXIST)
+        {
+            fprintf(stderr, "Error: failed to create handle %d (%d).\n",
+                BENCH_FIRST_HANDLE + i, ret);
+            return(-1);
+        }
+    }
+
+    trove_close_context(BENCH_COLL_ID, context);
+    return(0);
+}
+
+int main(int argc, char *argv[])
+{
+    int ret, i;
+    int thread_count, max_elems;
+    struct bench_thread *threads;
+    TROVE_context_id context;
+    TROVE_attr_cache_stats stats;
+    double start_tm, end_tm;
+    long ops = 0, errors = 0;
+
+    if(argc != 6 ||
+       sscanf(argv[2], "%d", &thread_count) != 1 || thread_count < 1 ||
+       sscanf(argv[3], "%d", &handle_count) != 1 || handle_count < 1 ||
+       sscanf(argv[4], "%lf", &run_seconds) != 1 ||
+       sscanf(argv[5], "%d", &max_elems) != 1 || max_elems < 1)
+    {
+        fprintf(stderr, "Usage: trove-attr-cache-bench <trove dir> "
+                "<threads> <handles> <seconds> <cache max elems>\n");
+        return(-1);
+    }
+
+    if(setup(argv[1], max_elems) < 0)
+    {
+        return(-1);
+    }
+
+    threads = calloc(thread_count, sizeof(*threads));
+    if(!threads)
+    {
+        perror("calloc");
+        return(-1);
+    }
+    for(i = 0; i < thread_count; i++)
+    {
+        threads[i].index = i;
+        ret = trove_open_context(BENCH_COLL_ID, &threads[i].context);
+        if(ret < 0)
+        {
+            fprintf(stderr, "Error: trove_open_context failed\n");
+            return(-1);
+        }
+    }
+
+    start_tm = Wtime();
+    for(i = 0; i < thread_count; i++)
+    {
+        pthread_create(&threads[i].thread, NULL, bench_thread_fn,
+                       &threads[i]);
+    }
+    usleep((useconds_t)(run_seconds * 1e6));
+    stop = 1;
+    for(i = 0; i < thread_count; i++)
+    {
+        pthread_join(threads[i].thread, NULL);
+        ops += threads[i].ops;
+        errors += threads[i].errors;
+    }
+    end_tm = Wtime();
+
+    printf("# %d threads, %d handles, cache limit %d\n",
+           thread_count, handle_count, max_elems);
+    printf("%f getattr+absent keyval reads/s\n",
+           ((double)ops) / (end_tm - start_tm));
+    printf("%ld errors\n", errors);
+
+    trove_open_context(BENCH_COLL_ID, &context);
+    ret = trove_collection_getinfo(BENCH_COLL_ID, context,
+                                   PVFS_COLLECTION_ATTR_CACHE_STATS, &stats);
+    if(ret == 1)
+    {
+        printf("# attr cache: %llu hits, %llu misses, %llu negative hits, "
+               "%llu keyval misses, %llu evictions, %u elems\n",
+               llu(stats.hits), llu(stats.misses), llu(stats.negative_hits),
+               llu(stats.keyval_misses), llu(stats.evictions),
+               stats.num_elems);
+    }
+
+    for(i = 0; i < thread_count; i++)
+    {
+        trove_close_context(BENCH_COLL_ID, threads[i].context);
+    }
+    trove_close_context(BENCH_COLL_ID, context);
+    trove_finalize(TROVE_METHOD_DBPF);
+    free(threads);
+
+    return(errors ? 1 : 0);
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ft=c ts=8 sts=4 sw=4 expandtab
+ */
@@ -0,0 +1,422 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* upcall-replay
+ *  Writes a stream of upcalls in the format pvfs2-client-core records
+ *  with --record-upcalls, so the client core can be driven through
+ *  --replay-upcalls without the kernel module.  The stream mounts the
+ *  first file system in the tab file, then repeats lookups, getattrs,
+ *  statfs calls and small and bulk reads of a test file, and ends with
+ *  an unmount.  If a client core is given, it is run on the stream.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <limits.h>
+#include <string.h>
+#include <getopt.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "pvfs2.h"
+#include "pvfs2-internal.h"
+#include "pvfs2-dev-proto.h"
+#include "pint-dev-shared.h"
+#include "pint-dev.h"
+#include "upcall.h"
+
+#define TEST_FILE_NAME "upcall-replay.dat"
+
+struct options
+{
+    char *stream;
+    char *client_core;
+    int rounds;
+    int small_size;
+    int bulk_size;
+    int write;
+    char **client_args;
+    int client_argc;
+};
+
+static struct options opts;
+static FILE *stream;
+static uint64_t next_tag = 1;
+static int upcall_count = 0;
+
+static void usage(char *prog)
+{
+    fprintf(stderr,
+            "usage: %s -f STREAM [-n ROUNDS] [-s SMALL_BYTES] "
+            "[-b BULK_BYTES] [-w]\n"
+            "          [-x CLIENT_CORE [-- CLIENT_CORE_ARGS]]\n", prog);
+    fprintf(stderr,
+            "  -w    issue writes instead of reads\n"
+            "  -x    run CLIENT_CORE --replay-upcalls=STREAM afterward\n");
+}
+
+static int parse_args(int argc, char **argv)
+{
+    int c;
+
+    opts.rounds = 100;
+    opts.small_size = 4096;
+    opts.bulk_size = PVFS2_BUFMAP_DEFAULT_DESC_SIZE;
+
+    while ((c = getopt(argc, argv, "f:n:s:b:wx:")) != -1)
+    {
+        switch (c)
+        {
+            case 'f':
+                opts.stream = optarg;
+                break;
+            case 'n':
+                opts.rounds = atoi(optarg);
+                break;
+            case 's':
+                opts.small_size = atoi(optarg);
+                break;
+            case 'b':
+                opts.bulk_size = atoi(optarg);
+                break;
+            case 'w':
+                opts.write = 1;
+                break;
+            case 'x':
+                opts.client_core = optarg;
+                break;
+            default:
+                return -1;
+        }
+    }
+
+    if (!opts.stream || opts.rounds < 1 ||
+        opts.small_size < 1 ||
+        opts.small_size > PVFS2_BUFMAP_DEFAULT_DESC_SIZE ||
+        opts.bulk_size < 1 ||
+        opts.bulk_size > PVFS2_BUFMAP_DEFAULT_DESC_SIZE)
+    {
+        return -1;
+    }
+
+    opts.client_args = &argv[optind];
+    opts.client_argc = argc - optind;
+    return 0;
+}
+
+/* same mapping pvfs2-client-core uses for handles it hands the kernel */
+static void khandle_from_handle(PVFS_handle handle, PVFS_khandle *khandle)
+{
+    struct ihash ihandle;
+
+    memset(khandle, 0, sizeof(*khandle));
+    ihandle.ino = handle;
+
+    khandle->u[0] = ihandle.u[0];
+    khandle->u[1] = ihandle.u[1];
+    khandle->u[2] = ihandle.u[2];
+    khandle->u[3] = ihandle.u[3];
+    khandle->u[12] = ihandle.u[4];
+    khandle->u[13] = ihandle.u[5];
+    khandle->u[14] = ihandle.u[6];
+    khandle->u[15] = ihandle.u[7];
+}
+
+static void init_upcall(pvfs2_upcall_t *upcall, int32_t type)
+{
+    memset(upcall, 0, sizeof(*upcall));
+    upcall->type = type;
+    upcall->uid = getuid();
+    upcall->gid = getgid();
+    upcall->pid = getpid();
+    upcall->tgid = getpid();
+}
+
+static int write_upcall(pvfs2_upcall_t *upcall)
+{
+    struct PINT_dev_upcall_record record;
+
+    memset(&record, 0, sizeof(record));
+    record.tag = next_tag++;
+    record.size = sizeof(*upcall);
+
+    if (fwrite(&record, sizeof(record), 1, stream) != 1 ||
+        fwrite(upcall, sizeof(*upcall), 1, stream) != 1)
+    {
+        perror("fwrite");
+        return -1;
+    }
+    upcall_count++;
+    return 0;
+}
+
+static int write_io(PVFS_object_kref *refn, int buf_index, int count,
+                    int64_t offset)
+{
+    pvfs2_upcall_t upcall;
+
+    init_upcall(&upcall, PVFS2_VFS_OP_FILE_IO);
+    upcall.req.io.io_type = opts.write ? PVFS_IO_WRITE : PVFS_IO_READ;
+    upcall.req.io.buf_index = buf_index;
+    upcall.req.io.count = count;
+    upcall.req.io.offset = offset;
+    upcall.req.io.refn = *refn;
+    return write_upcall(&upcall);
+}
+
+/* looks up the test file, creating it with enough data for the reads */
+static int get_test_file(PVFS_object_ref *root, PVFS_credential *cred,
+                         PVFS_object_ref *file)
+{
+    PVFS_sysresp_lookup lookup_resp;
+    PVFS_sysresp_create create_resp;
+    PVFS_sysresp_io io_resp;
+    PVFS_sys_attr attr;
+    PVFS_Request mem_req;
+    char *buf;
+    int ret;
+
+    ret = PVFS_sys_ref_lookup(root->fs_id, TEST_FILE_NAME, *root, cred,
+                              &lookup_resp, PVFS2_LOOKUP_LINK_NO_FOLLOW,
+                              NULL);
+    if (ret == 0)
+    {
+        *file = lookup_resp.ref;
+        return 0;
+    }
+
+    memset(&attr, 0, sizeof(attr));
+    attr.owner = cred->userid;
+    attr.group = cred->group_array[0];
+    attr.perms = 0644;
+    attr.mask = PVFS_ATTR_SYS_ALL_SETABLE;
+
+    ret = PVFS_sys_create(TEST_FILE_NAME, *root, attr, cred, NULL,
+                          &create_resp, NULL, NULL);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_create", ret);
+        return ret;
+    }
+    *file = create_resp.ref;
+
+    buf = malloc(opts.bulk_size);
+    if (!buf)
+    {
+        return -PVFS_ENOMEM;
+    }
+    memset(buf, 'r', opts.bulk_size);
+
+    ret = PVFS_Request_contiguous(opts.bulk_size, PVFS_BYTE, &mem_req);
+    if (ret == 0)
+    {
+        ret = PVFS_sys_write(*file, PVFS_BYTE, 0, buf, mem_req, cred,
+                             &io_resp, NULL);
+        PVFS_Request_free(&mem_req);
+    }
+    free(buf);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_write", ret);
+    }
+    return ret;
+}
+
+static int run_client_core(void)
+{
+    char replay_arg[PATH_MAX + 32];
+    char **argv;
+    pid_t pid;
+    int status, i;
+
+    argv = calloc(opts.client_argc + 3, sizeof(char *));
+    if (!argv)
+    {
+        return -1;
+    }
+    snprintf(replay_arg, sizeof(replay_arg), "--replay-upcalls=%s",
+             opts.stream);
+    argv[0] = opts.client_core;
+    argv[1] = replay_arg;
+    for (i = 0; i < opts.client_argc; i++)
+    {
+        argv[i + 2] = opts.client_args[i];
+    }
+
+    pid = fork();
+    if (pid < 0)
+    {
+        perror("fork");
+        free(argv);
+        return -1;
+    }
+    if (pid == 0)
+    {
+        execv(opts.client_core, argv);
+        perror("execv");
+        _exit(127);
+    }
+    free(argv);
+
+    if (waitpid(pid, &status, 0) < 0)
+    {
+        perror("waitpid");
+        return -1;
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        fprintf(stderr, "%s exited abnormally (status %d)\n",
+                opts.client_core, status);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    struct PVFS_sys_mntent mntent;
+    struct PINT_dev_upcall_stream header;
+    PVFS_credential cred;
+    PVFS_sysresp_lookup lookup_resp;
+    PVFS_object_ref root, file;
+    PVFS_object_kref root_kref, file_kref;
+    pvfs2_upcall_t upcall;
+    PVFS_fs_id fs_id;
+    char config_server[PVFS_MAX_SERVER_ADDR_LEN];
+    int ret, i;
+
+    if (parse_args(argc, argv))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    ret = PVFS_util_init_defaults();
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_util_init_defaults", ret);
+        return 1;
+    }
+
+    ret = PVFS_util_get_default_fsid(&fs_id);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_util_get_default_fsid", ret);
+        return 1;
+    }
+
+    ret = PVFS_util_get_mntent_copy(fs_id, &mntent);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_util_get_mntent_copy", ret);
+        return 1;
+    }
+    snprintf(config_server, sizeof(config_server), "%s/%s",
+             mntent.pvfs_config_servers[0], mntent.pvfs_fs_name);
+    PVFS_util_free_mntent(&mntent);
+
+    PVFS_util_gen_credential_defaults(&cred);
+
+    ret = PVFS_sys_lookup(fs_id, "/", &cred, &lookup_resp,
+                          PVFS2_LOOKUP_LINK_FOLLOW, NULL);
+    if (ret < 0)
+    {
+        PVFS_perror("PVFS_sys_lookup", ret);
+        return 1;
+    }
+    root = lookup_resp.ref;
+
+    ret = get_test_file(&root, &cred, &file);
+    if (ret < 0)
+    {
+        return 1;
+    }
+
+    memset(&root_kref, 0, sizeof(root_kref));
+    khandle_from_handle(root.handle, &root_kref.khandle);
+    root_kref.fs_id = fs_id;
+    memset(&file_kref, 0, sizeof(file_kref));
+    khandle_from_handle(file.handle, &file_kref.khandle);
+    file_kref.fs_id = fs_id;
+
+    stream = fopen(opts.stream, "w");
+    if (!stream)
+    {
+        perror(opts.stream);
+        return 1;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PINT_DEV_UPCALL_STREAM_MAGIC, sizeof(header.magic));
+    header.version = PINT_DEV_UPCALL_STREAM_VERSION;
+    header.upcall_size = sizeof(pvfs2_upcall_t);
+    if (fwrite(&header, sizeof(header), 1, stream) != 1)
+    {
+        perror("fwrite");
+        return 1;
+    }
+
+    init_upcall(&upcall, PVFS2_VFS_OP_FS_MOUNT);
+    memcpy(upcall.req.fs_mount.pvfs2_config_server, config_server,
+           sizeof(config_server));
+    ret = write_upcall(&upcall);
+
+    for (i = 0; ret == 0 && i < opts.rounds; i++)
+    {
+        init_upcall(&upcall, PVFS2_VFS_OP_LOOKUP);
+        upcall.req.lookup.sym_follow = PVFS2_LOOKUP_LINK_NO_FOLLOW;
+        upcall.req.lookup.parent_refn = root_kref;
+        strncpy(upcall.req.lookup.d_name, TEST_FILE_NAME,
+                PVFS2_NAME_LEN - 1);
+        ret = write_upcall(&upcall);
+
+        init_upcall(&upcall, PVFS2_VFS_OP_GETATTR);
+        upcall.req.getattr.refn = file_kref;
+        upcall.req.getattr.mask = PVFS_ATTR_SYS_ALL_NOHINT;
+        ret |= write_upcall(&upcall);
+
+        init_upcall(&upcall, PVFS2_VFS_OP_STATFS);
+        upcall.req.statfs.fs_id = fs_id;
+        ret |= write_upcall(&upcall);
+
+        ret |= write_io(&file_kref, i % PVFS2_BUFMAP_DEFAULT_DESC_COUNT,
+                        opts.small_size,
+                        ((int64_t)i * opts.small_size) % opts.bulk_size);
+        ret |= write_io(&file_kref,
+                        (i + 1) % PVFS2_BUFMAP_DEFAULT_DESC_COUNT,
+                        opts.bulk_size, 0);
+    }
+
+    init_upcall(&upcall, PVFS2_VFS_OP_FS_UMOUNT);
+    upcall.req.fs_umount.fs_id = fs_id;
+    memcpy(upcall.req.fs_umount.pvfs2_config_server, config_server,
+           sizeof(config_server));
+    ret |= write_upcall(&upcall);
+
+    if (fclose(stream) || ret)
+    {
+        fprintf(stderr, "Failed to write %s\n", opts.stream);
+        return 1;
+    }
+    printf("wrote %d upcalls to %s\n", upcall_count, opts.stream);
+
+    PVFS_sys_finalize();
+
+    if (opts.client_core)
+    {
+        return run_client_core() ? 1 : 0;
+    }
+    return 0;
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
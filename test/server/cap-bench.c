@@ -0,0 +1,171 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* Measures capability signing and verification cost for every file system
+ * in a server configuration, verifying both one capability at a time and
+ * in batches the size the server main loop hands to
+ * PINT_verify_capability_batch().  Configure one file system with
+ * "CapabilityMode publickey" and another with "CapabilityMode hmac" to
+ * compare the two modes in a single run; the small-file create rate of
+ * each is measured by running test/client/sysint/create-bench against
+ * the same file systems.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "pvfs2-internal.h"
+#include "server-config.h"
+#include "config-utils.h"
+#include "pint-security.h"
+#include "security-util.h"
+#include "gossip.h"
+
+/* matches PVFS_SERVER_TEST_COUNT in pvfs2-server.c */
+#define BATCH_SIZE 64
+
+static double Wtime(void);
+static void bench_fs(struct filesystem_configuration_s *fs,
+                     const char *alias, int iterations);
+
+int main(int argc, char **argv)
+{
+    struct server_configuration_s serverconfig;
+    struct filesystem_configuration_s *cur_fs;
+    PINT_llist *cur;
+    int iterations = 100000;
+    int ret;
+
+    if (argc < 3 || argc > 4)
+    {
+        printf("Usage: %s <fs.conf> <server-alias> [iterations]\n", argv[0]);
+        return 1;
+    }
+    if (argc == 4)
+    {
+        iterations = atoi(argv[3]);
+    }
+
+    gossip_enable_stderr();
+
+    memset(&serverconfig, 0, sizeof(serverconfig));
+    if (PINT_parse_config(&serverconfig, argv[1], argv[2], 1))
+    {
+        printf("Failed to parse config files\n");
+        return 1;
+    }
+    PINT_set_server_config(&serverconfig);
+
+    ret = PINT_security_initialize();
+    if (ret < 0)
+    {
+        printf("Failed to initialize security: %d\n", ret);
+        return 1;
+    }
+
+    printf("%-20s %-10s %12s %12s %12s\n", "file system", "mode",
+           "sign (us)", "verify (us)", "batch (us)");
+
+    for (cur = serverconfig.file_systems; cur; cur = PINT_llist_next(cur))
+    {
+        cur_fs = PINT_llist_head(cur);
+        if (cur_fs)
+        {
+            bench_fs(cur_fs, argv[2], iterations);
+        }
+    }
+
+    PINT_security_finalize();
+    PINT_config_release(&serverconfig);
+    gossip_disable();
+    return 0;
+}
+
+static void bench_fs(struct filesystem_configuration_s *fs,
+                     const char *alias, int iterations)
+{
+    PVFS_capability cap;
+    PVFS_handle handle = 1048576;
+    const PVFS_capability *caps[BATCH_SIZE];
+    int results[BATCH_SIZE];
+    double t1, t2, t3, t4;
+    int i, batches, failed = 0;
+
+    if (PINT_init_capability(&cap) < 0)
+    {
+        printf("%-20s failed to allocate capability\n", fs->file_system_name);
+        return;
+    }
+
+    cap.issuer = malloc(strlen(alias) + 3);
+    sprintf(cap.issuer, "S:%s", alias);
+    cap.fsid = fs->coll_id;
+    cap.op_mask = PINT_CAP_READ | PINT_CAP_WRITE | PINT_CAP_SETATTR;
+    cap.num_handles = 1;
+    cap.handle_array = &handle;
+
+    t1 = Wtime();
+    for (i = 0; i < iterations; i++)
+    {
+        if (PINT_sign_capability(&cap, NULL) < 0)
+        {
+            failed++;
+        }
+    }
+    t2 = Wtime();
+    for (i = 0; i < iterations; i++)
+    {
+        if (!PINT_verify_capability(&cap))
+        {
+            failed++;
+        }
+    }
+    t3 = Wtime();
+    for (i = 0; i < BATCH_SIZE; i++)
+    {
+        caps[i] = &cap;
+    }
+    batches = (iterations + BATCH_SIZE - 1) / BATCH_SIZE;
+    for (i = 0; i < batches; i++)
+    {
+        if (PINT_verify_capability_batch(caps, BATCH_SIZE, results) !=
+            BATCH_SIZE)
+        {
+            failed++;
+        }
+    }
+    t4 = Wtime();
+
+    printf("%-20s %-10s %12.3f %12.3f %12.3f%s\n", fs->file_system_name,
+           (fs->capability_mode == PINT_CAP_MODE_HMAC) ? "hmac" : "publickey",
+           (t2 - t1) * 1e6 / iterations,
+           (t3 - t2) * 1e6 / iterations,
+           (t4 - t3) * 1e6 / ((double) batches * BATCH_SIZE),
+           failed ? "  (verification failures)" : "");
+
+    cap.handle_array = NULL;
+    cap.num_handles = 0;
+    PINT_cleanup_capability(&cap);
+}
+
+static double Wtime(void)
+{
+    struct timeval t;
+
+    gettimeofday(&t, NULL);
+    return((double)t.tv_sec + (double)t.tv_usec / 1000000);
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */
@@ -0,0 +1,432 @@
+/*
+ * (C) 2026 Clemson University and Omnibond Systems, LLC
+ *
+ * See COPYING in top-level directory.
+ */
+
+/* Simulates tree communication across stand-in servers and reports how
+ * long an N-way operation (1000-way by default) takes with the static
+ * TreeWidth/TreeThreshold partitioning and with the adaptive planner in
+ * src/server/tree-fanout.c.
+ *
+ * Every stand-in server has a network round trip time, a queueing delay
+ * before it starts on a request, and a service time; a server can also
+ * be dead.  Each node of the tree pays a fixed cost per request it sends
+ * and answers once its local work and all of its subtrees are done,
+ * following tree-communicate.sm: the static mode retries a failed
+ * subtree on the same server and then gives up on every handle in it,
+ * the adaptive mode cancels a subtree at its deadline and resends the
+ * handles directly.  The "dead-rm" scenario models a remove, which the
+ * adaptive mode never resends and so handles like the static mode.  The
+ * stand-in servers share one statistics table, as if every server had
+ * already seen the same peers.
+ *
+ * A dead server still costs the full timeout and retries for its own
+ * handle in either mode, so the dead scenarios take as long adaptively
+ * as statically; what changes is how many handles fail with it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pvfs2-internal.h"
+#include "gossip.h"
+#include "tree-fanout.h"
+
+#define JOB_TIMEOUT_US (30 * 1000000.0)    /* ClientJobBMITimeoutSecs */
+#define RETRY_LIMIT 5                      /* ClientRetryLimit */
+
+struct sim_server
+{
+    double rtt_us;
+    double queue_us;
+    double service_us;
+    int dead;
+};
+
+struct sim_result
+{
+    double done_us;     /* when the answer is ready at the node */
+    int failed;         /* handles reported as failed */
+};
+
+static struct sim_server *servers;
+static int nservers = 1001;      /* the root plus one per handle */
+static int tree_width = 2;
+static int tree_threshold = 2;
+static double issue_us = 10.0;
+static int verbose = 0;
+static int reroute = 1;          /* the operation may be resent */
+static unsigned long long rnd_state = 88172645463325252ULL;
+
+static double rnd(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 7;
+    rnd_state ^= rnd_state << 17;
+    return (double) (rnd_state >> 11) / (double) (1ULL << 53);
+}
+
+static struct sim_result sim_static(int node, const int *targets, int n,
+                                    double arrive_us);
+static struct sim_result sim_adaptive(int node, const int *targets, int n,
+                                      double arrive_us);
+
+/* time until the node starts on a request, or a negative number if the
+ * node never answers
+ */
+static double sim_start(int node, double arrive_us)
+{
+    if (servers[node].dead)
+    {
+        return -1;
+    }
+    return arrive_us + servers[node].queue_us;
+}
+
+static struct sim_result sim_static(int node, const int *targets, int n,
+                                    double arrive_us)
+{
+    struct sim_result res = { 0, 0 }, sub;
+    int partitions, per, i, count;
+    double start, send_us, resp_us, max_us;
+
+    start = sim_start(node, arrive_us);
+    res.done_us = start + servers[node].service_us;
+
+    if (n > tree_threshold)
+    {
+        partitions = tree_width;
+        per = (n + tree_width - 1) / tree_width;
+    }
+    else
+    {
+        partitions = n;
+        per = 1;
+    }
+
+    for (i = 0; i < partitions && i * per < n; i++)
+    {
+        int head = targets[i * per];
+
+        count = (n - i * per < per ? n - i * per : per);
+        send_us = start + (i + 1) * issue_us;
+        sub = sim_static(head, &targets[i * per + 1], count - 1,
+                         send_us + servers[head].rtt_us / 2);
+
+        max_us = send_us + (RETRY_LIMIT + 1) * JOB_TIMEOUT_US;
+        if (servers[head].dead)
+        {
+            /* every retry times out, then the whole subtree fails */
+            resp_us = max_us;
+            res.failed += count;
+        }
+        else
+        {
+            resp_us = sub.done_us + servers[head].rtt_us / 2;
+            res.failed += sub.failed;
+        }
+        if (resp_us > res.done_us)
+        {
+            res.done_us = resp_us;
+        }
+    }
+    return res;
+}
+
+/* a single handle sent directly to its server with the normal timeout
+ * and retries, as in the second pass of the adaptive mode
+ */
+static struct sim_result sim_direct(int node, double send_us)
+{
+    struct sim_result res;
+
+    if (servers[node].dead)
+    {
+        res.done_us = send_us + (RETRY_LIMIT + 1) * JOB_TIMEOUT_US;
+        res.failed = 1;
+        PINT_tree_fanout_post(node + 1);
+        PINT_tree_fanout_complete(node + 1, JOB_TIMEOUT_US, 1, 1, 1);
+        return res;
+    }
+
+    res = sim_adaptive(node, NULL, 0, send_us + servers[node].rtt_us / 2);
+    res.done_us += servers[node].rtt_us / 2;
+    PINT_tree_fanout_post(node + 1);
+    PINT_tree_fanout_complete(node + 1, res.done_us - send_us, 1, 1, 0);
+    return res;
+}
+
+static struct sim_result sim_adaptive(int node, const int *targets, int n,
+                                      double arrive_us)
+{
+    struct sim_result res = { 0, 0 }, sub = { 0, 0 };
+    struct PINT_tree_fanout_plan plan;
+    PVFS_BMI_addr_t *addrs;
+    int *sub_targets;
+    int *stranded;
+    int nstranded = 0;
+    double start, send_us, resp_us, deadline_us, first_pass_us;
+    int p, k, head, count;
+
+    start = sim_start(node, arrive_us);
+    res.done_us = start + servers[node].service_us;
+    if (n == 0)
+    {
+        return res;
+    }
+
+    addrs = malloc(n * sizeof(*addrs));
+    sub_targets = malloc(n * sizeof(*sub_targets));
+    stranded = malloc(n * sizeof(*stranded));
+    for (k = 0; k < n; k++)
+    {
+        addrs[k] = targets[k] + 1;
+    }
+    if (PINT_tree_fanout_plan(addrs, n, &plan) < 0)
+    {
+        fprintf(stderr, "PINT_tree_fanout_plan failed\n");
+        exit(1);
+    }
+
+    /* job timeouts have a granularity of one second; an operation that
+     * is never resent keeps the normal timeout and retries
+     */
+    deadline_us = PINT_tree_fanout_deadline(&plan);
+    deadline_us = (double) ((long long) (deadline_us + 999999) / 1000000) *
+        1000000;
+    if (deadline_us < 1000000)
+    {
+        deadline_us = 1000000;
+    }
+    if (!reroute)
+    {
+        deadline_us = (RETRY_LIMIT + 1) * JOB_TIMEOUT_US;
+    }
+
+    if (verbose && node == 0)
+    {
+        printf("  root plan: width %d, predicted %lld us, deadline %.0f us\n",
+               plan.width, lld(plan.predicted_us), deadline_us);
+    }
+
+    first_pass_us = res.done_us;
+    for (p = 0; p < plan.width; p++)
+    {
+        head = targets[plan.order[plan.part_start[p]]];
+        count = plan.part_start[p + 1] - plan.part_start[p];
+        for (k = 1; k < count; k++)
+        {
+            sub_targets[k - 1] = targets[plan.order[plan.part_start[p] + k]];
+        }
+
+        send_us = start + (p + 1) * issue_us;
+        PINT_tree_fanout_post(head + 1);
+        if (servers[head].dead)
+        {
+            resp_us = send_us + deadline_us + 1;
+        }
+        else
+        {
+            sub = sim_adaptive(head, sub_targets, count - 1,
+                               send_us + servers[head].rtt_us / 2);
+            resp_us = sub.done_us + servers[head].rtt_us / 2;
+        }
+
+        if (resp_us - send_us > deadline_us && !reroute)
+        {
+            /* retried to the limit, then every handle of the subtree
+             * fails as in the static mode
+             */
+            PINT_tree_fanout_complete(head + 1, deadline_us, count,
+                                      plan.width, 1);
+            resp_us = send_us + deadline_us;
+            res.failed += count;
+        }
+        else if (resp_us - send_us > deadline_us)
+        {
+            /* stalled: cancelled at the deadline, every handle of the
+             * subtree is resent directly
+             */
+            PINT_tree_fanout_complete(head + 1, deadline_us, count,
+                                      plan.width, 1);
+            resp_us = send_us + deadline_us;
+            for (k = 0; k < count; k++)
+            {
+                stranded[nstranded++] =
+                    targets[plan.order[plan.part_start[p] + k]];
+            }
+        }
+        else
+        {
+            PINT_tree_fanout_complete(head + 1, resp_us - send_us, count,
+                                      plan.width, 0);
+            res.failed += sub.failed;
+        }
+        if (resp_us > first_pass_us)
+        {
+            first_pass_us = resp_us;
+        }
+    }
+    if (plan.width > 1)
+    {
+        PINT_tree_fanout_issue(issue_us);
+    }
+    res.done_us = first_pass_us;
+
+    /* the second pass starts once the whole first msgpair array is done */
+    for (k = 0; k < nstranded; k++)
+    {
+        sub = sim_direct(stranded[k], first_pass_us + (k + 1) * issue_us);
+        res.failed += sub.failed;
+        if (sub.done_us > res.done_us)
+        {
+            res.done_us = sub.done_us;
+        }
+    }
+
+    PINT_tree_fanout_plan_free(&plan);
+    free(stranded);
+    free(sub_targets);
+    free(addrs);
+    return res;
+}
+
+static void setup(const char *scenario)
+{
+    int i;
+
+    rnd_state = 88172645463325252ULL;
+    for (i = 0; i < nservers; i++)
+    {
+        servers[i].rtt_us = 80 + 40 * rnd();
+        servers[i].queue_us = 5 * rnd();
+        servers[i].service_us = 20 + 10 * rnd();
+        servers[i].dead = 0;
+
+        if (!strcmp(scenario, "loaded") && rnd() < 0.05)
+        {
+            /* a few servers with a long request queue */
+            servers[i].queue_us = 2000 + 3000 * rnd();
+        }
+    }
+    if (!strcmp(scenario, "dead") || !strcmp(scenario, "dead-rm"))
+    {
+        /* heads of large subtrees in the static mode */
+        servers[nservers / 2 + 1].dead = 1;
+        servers[nservers / 4 + 2].dead = 1;
+    }
+}
+
+static void run(const char *scenario, int ops)
+{
+    struct sim_result s_res, a_res;
+    double s_total = 0, a_total = 0;
+    int s_failed = 0, a_failed = 0;
+    int *targets;
+    int i;
+
+    setup(scenario);
+    reroute = strcmp(scenario, "dead-rm") != 0;
+    PINT_tree_fanout_finalize();
+
+    /* server 0 is the root; the rest hold one handle each */
+    targets = malloc(nservers * sizeof(*targets));
+    for (i = 0; i < nservers - 1; i++)
+    {
+        targets[i] = i + 1;
+    }
+
+    for (i = 0; i < ops; i++)
+    {
+        s_res = sim_static(0, targets, nservers - 1, 0);
+        a_res = sim_adaptive(0, targets, nservers - 1, 0);
+        s_total += s_res.done_us;
+        a_total += a_res.done_us;
+        s_failed += s_res.failed;
+        a_failed += a_res.failed;
+        if (i == 0)
+        {
+            printf("%-10s first op: static %10.3f ms %4d failed   "
+                   "adaptive %10.3f ms %4d failed\n", scenario,
+                   s_res.done_us / 1000, s_res.failed,
+                   a_res.done_us / 1000, a_res.failed);
+        }
+    }
+    printf("%-10s mean:     static %10.3f ms %4.0f failed   "
+           "adaptive %10.3f ms %4.0f failed\n", scenario,
+           s_total / ops / 1000, (double) s_failed / ops,
+           a_total / ops / 1000, (double) a_failed / ops);
+
+    free(targets);
+}
+
+int main(int argc, char **argv)
+{
+    int ops = 20;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:w:t:i:r:v")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                nservers = atoi(optarg) + 1;
+                break;
+            case 'w':
+                tree_width = atoi(optarg);
+                break;
+            case 't':
+                tree_threshold = atoi(optarg);
+                break;
+            case 'i':
+                issue_us = atof(optarg);
+                break;
+            case 'r':
+                ops = atoi(optarg);
+                break;
+            case 'v':
+                verbose = 1;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n ways] [-w TreeWidth] "
+                        "[-t TreeThreshold] [-i issue us] [-r ops] [-v]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    if (nservers < 2 || tree_width < 2 || ops < 1)
+    {
+        fprintf(stderr, "need at least 1 way, width 2 and 1 op\n");
+        return 1;
+    }
+
+    servers = calloc(nservers, sizeof(*servers));
+    if (!servers)
+    {
+        return 1;
+    }
+
+    printf("%d-way operation, TreeWidth %d, TreeThreshold %d, "
+           "%.0f us per request sent, %d ops per scenario\n",
+           nservers - 1, tree_width, tree_threshold, issue_us, ops);
+    run("uniform", ops);
+    run("loaded", ops);
+    run("dead", ops);
+    run("dead-rm", ops);
+
+    PINT_tree_fanout_finalize();
+    free(servers);
+    return 0;
+}
+
+/*
+ * Local variables:
+ *  c-indent-level: 4
+ *  c-basic-offset: 4
+ * End:
+ *
+ * vim: ts=8 sts=4 sw=4 expandtab
+ */